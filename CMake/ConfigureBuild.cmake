@@ -105,6 +105,7 @@ set(OGRE_STATIC_LIB 0)
 set(OGRE_SET_USE_BOOST 0)
 set(OGRE_SET_PROFILING 0)
 set(OGRE_SET_USE_SIMD 0)
+set(OGRE_SET_USE_AVX2 0)
 set(OGRE_SET_RESTRICT_ALIASING 0)
 if (OGRE_CONFIG_DOUBLE)
   set(OGRE_SET_DOUBLE 1)
@@ -175,6 +176,9 @@ endif()
 if (OGRE_SIMD_SSE2 OR OGRE_SIMD_NEON)
   set(OGRE_SET_USE_SIMD 1)
 endif()
+if (OGRE_SIMD_AVX2)
+  set(OGRE_SET_USE_AVX2 1)
+endif()
 if (OGRE_RESTRICT_ALIASING)
   set(OGRE_SET_RESTRICT_ALIASING 1)
 endif()
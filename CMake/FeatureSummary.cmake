@@ -81,6 +81,9 @@ endif ()
 if (OGRE_BUILD_RENDERSYSTEM_GLES2)
 	set(_rendersystems "${_rendersystems}  + OpenGL ES 2.x\n")
 endif ()
+if (OGRE_BUILD_RENDERSYSTEM_NULL)
+	set(_rendersystems "${_rendersystems}  + Null\n")
+endif ()
 
 if (DEFINED _rendersystems)
 	set(_features "${_features}Building rendersystems:\n${_rendersystems}")
@@ -189,6 +192,7 @@ var_to_string(OGRE_LEGACY_ANIMATIONS _use_legacy_animations)
 var_to_string(OGRE_USE_BOOST _boost)
 var_to_string(OGRE_SIMD_SSE2 _simdsse2)
 var_to_string(OGRE_SIMD_NEON _simdneon)
+var_to_string(OGRE_SIMD_AVX2 _simdavx2)
 # threading settings
 if (OGRE_CONFIG_THREADS EQUAL 0)
 	set(_threads "none")
@@ -217,6 +221,7 @@ set(_features "${_features}Use 1.x legacy animations:       ${_use_legacy_animat
 set(_features "${_features}Use Boost:                       ${_boost}\n")
 set(_features "${_features}Use SIMD (SSE2):                 ${_simdsse2}\n")
 set(_features "${_features}Use SIMD (NEON):                 ${_simdneon}\n")
+set(_features "${_features}Use SIMD (AVX2):                 ${_simdavx2}\n")
 
 
 set(_features "${_features}\n----------------------------------------------------------------------------\n")
@@ -87,6 +87,9 @@ endif ()
 if (NOT OGRE_BUILD_RENDERSYSTEM_GLES2)
   set(OGRE_COMMENT_RENDERSYSTEM_GLES2 "#")
 endif ()
+if (NOT OGRE_BUILD_RENDERSYSTEM_NULL)
+  set(OGRE_COMMENT_RENDERSYSTEM_NULL "#")
+endif ()
 if (NOT OGRE_BUILD_PLUGIN_PFX)
   set(OGRE_COMMENT_PLUGIN_PARTICLEFX "#")
 endif ()
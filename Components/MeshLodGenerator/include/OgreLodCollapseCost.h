@@ -41,8 +41,9 @@ public:
     virtual ~LodCollapseCost() {}
     /// This is called after the LodInputProvider has initialized LodData.
     virtual void initCollapseCosts(LodData* data);
-    /// Called from initCollapseCosts for every edge.
-    virtual void initVertexCollapseCost(LodData* data, LodData::Vertex* vertex);
+    /// Called from initCollapseCosts for every used vertex. Sets collapseTo and returns the cost of the vertex.
+    /// Called from several threads at once, unless LodConfig::Advanced::useParallelProcessing is disabled.
+    virtual Real initVertexCollapseCost(LodData* data, LodData::Vertex* vertex);
     /// Called when edge cost gets invalid.
     virtual void updateVertexCollapseCost(LodData* data, LodData::Vertex* vertex);
     /// Called by initVertexCollapseCost and updateVertexCollapseCost, when the vertex minimal cost needs to be updated.
@@ -54,6 +54,9 @@ protected:
     vector<Matrix4>::type mVertexQuadricList;
     void computeTrianglePlaneQuadric(LodData* data, size_t triangleID);
     void computeVertexQuadric(LodData* data, size_t vertexID);
+
+    class TrianglePlaneQuadricTask;
+    class VertexQuadricTask;
 };
 
 }
@@ -148,6 +148,14 @@ struct _OgreLodExport LodConfig {
         /// Use vertex normals to improve quality. Bit slower to generate, but it has better quality most of the time.
         /// (enabled by default)
         bool useVertexNormals;
+        /// Reorder the triangles of the generated LODs for the GPU vertex cache (see Ogre::MeshOptimiser).
+        /// Only supported when useCompression is disabled, since compressed LODs share their index buffers.
+        /// (disabled by default)
+        bool optimiseVertexCache;
+        /// Split the setup of the mesh data and the initial collapse costs across the WorkQueue threads.
+        /// Disable it, if a custom LodCollapseCost is not thread safe. It is not saved by LodConfigSerializer.
+        /// (enabled by default)
+        bool useParallelProcessing;
         /// Faces inside a house can't be seen from far away. Weightening outside allows to remove those internal faces.
         /// It makes generation smaller and it is not 100% accurate. Set it to 0.0 to disable.
         /// (disabled by default)
@@ -58,7 +58,6 @@ struct _OgreLodExport LodData {
     typedef vector<Vertex>::type VertexList;
     typedef vector<Triangle>::type TriangleList;
     typedef OGRE_HashSet<Vertex*, VertexHash, VertexEqual> UniqueVertexSet;
-    typedef multimap<Real, Vertex*>::type CollapseCostHeap;
 
     typedef VectorSet<Edge, 8> VEdges;
     typedef VectorSet<Triangle*, 7> VTriangles;
@@ -98,7 +97,7 @@ struct _OgreLodExport LodData {
         Vector3 normal;
         Vertex* collapseTo;
         bool seam;
-        CollapseCostHeap::iterator costHeapPosition; /// Iterator pointing to the position in the mCollapseCostSet, which allows fast remove.
+        size_t costHeapPosition; /// Index of the vertex in mCollapseCostHeap, which allows fast update and remove.
 
         void addEdge(const Edge& edge);
         void removeEdge(const Edge& edge);
@@ -132,6 +131,54 @@ struct _OgreLodExport LodData {
 
     typedef vector<IndexBufferInfo>::type IndexBufferInfoList;
 
+    /**
+     * @brief Indexed min-heap of the vertex collapse costs.
+     *
+     * The entries are stored in a single array as a 4-ary heap and every vertex knows
+     * its position (Vertex::costHeapPosition), so changing the cost of a vertex or removing it
+     * is O(log n) without touching the allocator. Equal costs are ordered by vertex address,
+     * which keeps the collapse order deterministic.
+     */
+    class _OgreLodExport CollapseCostHeap {
+    public:
+        static const size_t NOT_IN_HEAP = ~(size_t) 0;
+
+        struct Entry {
+            Real cost;
+            Vertex* vertex;
+        };
+        typedef vector<Entry>::type EntryList;
+
+        bool empty() const { return mEntries.empty(); }
+        size_t size() const { return mEntries.size(); }
+        void reserve(size_t count) { mEntries.reserve(count); }
+        void clear();
+        /// Returns the vertex with the smallest collapse cost. The heap must not be empty.
+        const Entry& top() const { return mEntries.front(); }
+
+        /// Inserts the vertex or changes its cost if it is already in the heap.
+        void update(Vertex* vertex, Real cost);
+        void erase(Vertex* vertex);
+        bool contains(const Vertex* vertex) const;
+        /// Returns the cost of a vertex in the heap.
+        Real getCost(const Vertex* vertex) const;
+
+        /// Appends a vertex without keeping the heap order. Call makeHeap() before using the heap.
+        void pushUnordered(Vertex* vertex, Real cost);
+        /// Restores the heap order in O(n) after pushUnordered calls.
+        void makeHeap();
+
+        /// Entries in heap order. Only top() is guaranteed to be the smallest.
+        const EntryList& getEntries() const { return mEntries; }
+    private:
+        EntryList mEntries;
+
+        static bool isLess(const Entry& a, const Entry& b);
+        void place(size_t pos, const Entry& entry);
+        void siftUp(size_t pos);
+        void siftDown(size_t pos);
+    };
+
     /// Provides position based vertex lookup. Position is the real identifier of a vertex.
     UniqueVertexSet mUniqueVertexSet;
 
@@ -151,6 +198,8 @@ struct _OgreLodExport LodData {
 #endif
     Real mMeshBoundingSphereRadius;
     bool mUseVertexNormals;
+    /// Whether the setup of the data and the collapse costs may be split across the WorkQueue threads.
+    bool mUseParallelProcessing;
 
     template<typename T, typename A>
     static size_t getVectorIDFromPointer(const std::vector<T, A>& vec, const T* pointer) {
@@ -163,7 +212,8 @@ struct _OgreLodExport LodData {
         mUniqueVertexSet((UniqueVertexSet::size_type) 0,
         (const UniqueVertexSet::hasher&) VertexHash(this)),
         mMeshBoundingSphereRadius(0.0f),
-        mUseVertexNormals(true)
+        mUseVertexNormals(true),
+        mUseParallelProcessing(true)
     {}
 };
 
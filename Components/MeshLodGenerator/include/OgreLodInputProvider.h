@@ -45,6 +45,9 @@ protected:
     // Helper functions
     void printTriangle(LodData::Triangle* triangle, stringstream& str);
     void addTriangleToEdges(LodData* data, LodData::Triangle* triangle);
+    /// Computes the triangle normals and connects the triangles to their vertices and edges.
+    /// Called once after all triangles are added to the data.
+    void connectTriangles(LodData* data);
     bool isDuplicateTriangle(LodData::Triangle* triangle, LodData::Triangle* triangle2);
     LodData::Triangle* isDuplicateTriangle(LodData::Triangle* triangle);
 };
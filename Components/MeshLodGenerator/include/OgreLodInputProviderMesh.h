@@ -63,7 +63,7 @@ protected:
                                                 VertexLookupList& lookup,
                                                 unsigned short submeshID)
     {
-        // Loop through all triangles and connect them to the vertices.
+        // Loop through all triangles. They are connected to the vertices by connectTriangles().
         for (; iPos < iEnd; iPos += 3) {
             // It should never reallocate or every pointer will be invalid.
             OgreAssert(data->mTriangleList.capacity() > data->mTriangleList.size(), "");
@@ -77,21 +77,6 @@ protected:
                 tri->vertexID[i] = iPos[i];
                 tri->vertex[i] = lookup[iPos[i]];
             }
-            if (tri->isMalformed()) {
-#if OGRE_DEBUG_MODE
-                stringstream str;
-                str << "In " << data->mMeshName << " malformed triangle found with ID: " << LodData::getVectorIDFromPointer(data->mTriangleList, tri) << ". " <<
-                std::endl;
-                printTriangle(tri, str);
-                str << "It will be excluded from Lod level calculations.";
-                LogManager::getSingleton().stream() << str.str();
-#endif
-                tri->isRemoved = true;
-                data->mIndexBufferInfoList[tri->submeshID].indexCount -= 3;
-                continue;
-            }
-            tri->computeNormal();
-            addTriangleToEdges(data, tri);
         }
     }
 };
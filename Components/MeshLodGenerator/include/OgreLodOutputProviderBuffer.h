@@ -41,7 +41,9 @@ class _OgreLodExport LodOutputProviderBuffer :
     public LodOutputProvider
 {
 public:
-    LodOutputProviderBuffer(MeshPtr mesh) : mMesh(mesh) {}
+    /// @param optimiseVertexCache Reorder the triangles of each LOD for the vertex cache.
+    LodOutputProviderBuffer(MeshPtr mesh, bool optimiseVertexCache = false) :
+        mMesh(mesh), mOptimiseVertexCache(optimiseVertexCache) {}
     virtual void prepare(LodData* data);
     virtual void finalize(LodData* data) {}
     virtual void bakeManualLodLevel(LodData* data, String& manualMeshName, int lodIndex);
@@ -50,6 +52,7 @@ public:
     LodOutputBuffer& getBuffer();
 protected:
     MeshPtr mMesh;
+    bool mOptimiseVertexCache;
     LodOutputBuffer mBuffer;
 };
 
@@ -41,13 +41,16 @@ class _OgreLodExport LodOutputProviderMesh :
     public LodOutputProvider
 {
 public:
-    LodOutputProviderMesh(MeshPtr mesh) : mMesh(mesh) {}
+    /// @param optimiseVertexCache Reorder the triangles of each LOD for the vertex cache.
+    LodOutputProviderMesh(MeshPtr mesh, bool optimiseVertexCache = false) :
+        mMesh(mesh), mOptimiseVertexCache(optimiseVertexCache) {}
     virtual void prepare(LodData* data);
     virtual void finalize(LodData* data) {}
     virtual void bakeManualLodLevel(LodData* data, String& manualMeshName, int lodIndex);
     virtual void bakeLodLevel(LodData* data, int lodIndex);
 protected:
     MeshPtr mMesh;
+    bool mOptimiseVertexCache;
 };
 
 }
@@ -28,29 +28,63 @@
 
 #include "OgreLodCollapseCost.h"
 
+#include "OgreWorkQueueParallelFor.h"
 #include "OgreLogManager.h"
 
 namespace Ogre
 {
+    namespace
+    {
+        /// Computes the initial collapse costs of a range of vertices.
+        class VertexCollapseCostTask : public WorkQueueParallelFor::Task
+        {
+        public:
+            VertexCollapseCostTask(LodCollapseCost* cost, LodData* data, vector<Real>::type& costs) :
+                mCost(cost), mData(data), mCosts(costs) {}
+
+            virtual void execute(size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; i++) {
+                    LodData::Vertex* vertex = &mData->mVertexList[i];
+                    if (!vertex->edges.empty()) {
+                        mCosts[i] = mCost->initVertexCollapseCost(mData, vertex);
+                    }
+                }
+            }
+        private:
+            LodCollapseCost* mCost;
+            LodData* mData;
+            vector<Real>::type& mCosts;
+        };
+    }
+
     void LodCollapseCost::initCollapseCosts( LodData* data )
     {
+        // Every vertex only writes its own collapseTo and edge costs, so they are computed in parallel.
+        size_t vertexCount = data->mVertexList.size();
+        vector<Real>::type costs(vertexCount, LodData::UNINITIALIZED_COLLAPSE_COST);
+        VertexCollapseCostTask task(this, data, costs);
+        WorkQueueParallelFor::run(task, vertexCount,
+            data->mUseParallelProcessing ? WorkQueueParallelFor::getRootWorkQueue() : 0, 256);
+
         data->mCollapseCostHeap.clear();
-        LodData::VertexList::iterator it = data->mVertexList.begin();
-        LodData::VertexList::iterator itEnd = data->mVertexList.end();
-        for (; it != itEnd; it++) {
-            if (!it->edges.empty()) {
-                initVertexCollapseCost(data, &*it);
+        data->mCollapseCostHeap.reserve(vertexCount);
+        for (size_t i = 0; i < vertexCount; i++) {
+            LodData::Vertex* vertex = &data->mVertexList[i];
+            if (!vertex->edges.empty()) {
+                data->mCollapseCostHeap.pushUnordered(vertex, costs[i]);
             } else {
 #if OGRE_DEBUG_MODE
                 LogManager::getSingleton().stream() << "In " << data->mMeshName << " never used vertex found with ID: " << data->mCollapseCostHeap.size() << ". "
                     << "Vertex position: ("
-                    << it->position.x << ", "
-                    << it->position.y << ", "
-                    << it->position.z << ") "
+                    << vertex->position.x << ", "
+                    << vertex->position.y << ", "
+                    << vertex->position.z << ") "
                     << "It will be excluded from Lod level calculations.";
 #endif
             }
         }
+        data->mCollapseCostHeap.makeHeap();
     }
 
     void LodCollapseCost::computeVertexCollapseCost( LodData* data, LodData::Vertex* vertex, Real& collapseCost, LodData::Vertex*& collapseTo )
@@ -64,7 +98,7 @@ namespace Ogre
             }
         }
     }
-    void LodCollapseCost::initVertexCollapseCost( LodData* data, LodData::Vertex* vertex )
+    Real LodCollapseCost::initVertexCollapseCost( LodData* data, LodData::Vertex* vertex )
     {
         OgreAssert(!vertex->edges.empty(), "");
 
@@ -73,7 +107,7 @@ namespace Ogre
         computeVertexCollapseCost(data, vertex, collapseCost, collapseTo);
 
         vertex->collapseTo = collapseTo;
-        vertex->costHeapPosition = data->mCollapseCostHeap.insert(LodData::CollapseCostHeap::value_type(collapseCost, vertex));
+        return collapseCost;
     }
 
     void LodCollapseCost::updateVertexCollapseCost( LodData* data, LodData::Vertex* vertex )
@@ -82,16 +116,14 @@ namespace Ogre
         LodData::Vertex* collapseTo = NULL;
         computeVertexCollapseCost(data, vertex, collapseCost, collapseTo);
 
-        if (vertex->collapseTo != collapseTo || collapseCost != vertex->costHeapPosition->first) {
-            OgreAssert(vertex->costHeapPosition != data->mCollapseCostHeap.end(), "");
-            data->mCollapseCostHeap.erase(vertex->costHeapPosition);
+        if (vertex->collapseTo != collapseTo || collapseCost != data->mCollapseCostHeap.getCost(vertex)) {
             if (collapseCost != LodData::UNINITIALIZED_COLLAPSE_COST) {
                 vertex->collapseTo = collapseTo;
-                vertex->costHeapPosition = data->mCollapseCostHeap.insert(LodData::CollapseCostHeap::value_type(collapseCost, vertex));
+                data->mCollapseCostHeap.update(vertex, collapseCost);
             } else {
+                data->mCollapseCostHeap.erase(vertex);
 #if OGRE_DEBUG_MODE
                 vertex->collapseTo = NULL;
-                vertex->costHeapPosition = data->mCollapseCostHeap.end();
 #endif
             }
         }
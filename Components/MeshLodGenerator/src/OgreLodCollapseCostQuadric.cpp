@@ -33,21 +33,60 @@
  */
 
 #include "OgreLodCollapseCostQuadric.h"
+#include "OgreWorkQueueParallelFor.h"
 #include "OgreVector3.h"
 
 namespace Ogre
 {
 
+    /// Computes the plane quadrics of a range of triangles.
+    class LodCollapseCostQuadric::TrianglePlaneQuadricTask : public WorkQueueParallelFor::Task
+    {
+    public:
+        TrianglePlaneQuadricTask(LodCollapseCostQuadric* cost, LodData* data) :
+            mCost(cost), mData(data) {}
+
+        virtual void execute(size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++) {
+                mCost->computeTrianglePlaneQuadric(mData, i);
+            }
+        }
+    private:
+        LodCollapseCostQuadric* mCost;
+        LodData* mData;
+    };
+
+    /// Sums the triangle quadrics of a range of vertices.
+    class LodCollapseCostQuadric::VertexQuadricTask : public WorkQueueParallelFor::Task
+    {
+    public:
+        VertexQuadricTask(LodCollapseCostQuadric* cost, LodData* data) :
+            mCost(cost), mData(data) {}
+
+        virtual void execute(size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++) {
+                mCost->computeVertexQuadric(mData, i);
+            }
+        }
+    private:
+        LodCollapseCostQuadric* mCost;
+        LodData* mData;
+    };
+
     void LodCollapseCostQuadric::initCollapseCosts( LodData* data )
     {
+        // Every quadric only depends on the triangles, so both passes are split across threads.
+        WorkQueue* workQueue = data->mUseParallelProcessing ? WorkQueueParallelFor::getRootWorkQueue() : 0;
         mTrianglePlaneQuadricList.resize(data->mTriangleList.size());
-        for(size_t i=0;i<mTrianglePlaneQuadricList.size();i++){
-            computeTrianglePlaneQuadric(data, i);
-        }
+        TrianglePlaneQuadricTask triangleTask(this, data);
+        WorkQueueParallelFor::run(triangleTask, mTrianglePlaneQuadricList.size(), workQueue, 1024);
+
         mVertexQuadricList.resize(data->mVertexList.size());
-        for (size_t i=0;i<mVertexQuadricList.size();i++) {
-            computeVertexQuadric(data, i);
-        }
+        VertexQuadricTask vertexTask(this, data);
+        WorkQueueParallelFor::run(vertexTask, mVertexQuadricList.size(), workQueue, 1024);
+
         LodCollapseCost::initCollapseCosts(data);
     }
 
@@ -35,6 +35,8 @@ LodConfig::Advanced::Advanced() :
     useBackgroundQueue(false),
             useCompression(true),
             useVertexNormals(true),
+            optimiseVertexCache(false),
+            useParallelProcessing(true),
             outsideWeight(0.0),
             outsideWalkAngle(0.0)
 {
@@ -133,4 +133,133 @@ bool LodData::Edge::operator== (const LodData::Edge& other) const
     return dst == other.dst;
 }
 
-}
\ No newline at end of file
+void LodData::CollapseCostHeap::clear()
+{
+    EntryList::iterator it = mEntries.begin();
+    EntryList::iterator itEnd = mEntries.end();
+    for (; it != itEnd; ++it) {
+        it->vertex->costHeapPosition = NOT_IN_HEAP;
+    }
+    mEntries.clear();
+}
+
+void LodData::CollapseCostHeap::update(LodData::Vertex* vertex, Real cost)
+{
+    size_t pos = vertex->costHeapPosition;
+    if (pos == NOT_IN_HEAP) {
+        pushUnordered(vertex, cost);
+        siftUp(mEntries.size() - 1);
+    } else {
+        OgreAssert(contains(vertex), "");
+        Real oldCost = mEntries[pos].cost;
+        mEntries[pos].cost = cost;
+        if (cost < oldCost) {
+            siftUp(pos);
+        } else {
+            siftDown(pos);
+        }
+    }
+}
+
+void LodData::CollapseCostHeap::erase(LodData::Vertex* vertex)
+{
+    OgreAssert(contains(vertex), "");
+    size_t pos = vertex->costHeapPosition;
+    vertex->costHeapPosition = NOT_IN_HEAP;
+    Entry last = mEntries.back();
+    mEntries.pop_back();
+    if (pos < mEntries.size()) {
+        // Move the last entry into the hole and restore the order in whichever direction it breaks.
+        place(pos, last);
+        if (pos > 0 && isLess(last, mEntries[(pos - 1) / 4])) {
+            siftUp(pos);
+        } else {
+            siftDown(pos);
+        }
+    }
+}
+
+bool LodData::CollapseCostHeap::contains(const LodData::Vertex* vertex) const
+{
+    size_t pos = vertex->costHeapPosition;
+    return pos < mEntries.size() && mEntries[pos].vertex == vertex;
+}
+
+Real LodData::CollapseCostHeap::getCost(const LodData::Vertex* vertex) const
+{
+    OgreAssert(contains(vertex), "");
+    return mEntries[vertex->costHeapPosition].cost;
+}
+
+void LodData::CollapseCostHeap::pushUnordered(LodData::Vertex* vertex, Real cost)
+{
+    OgreAssert(vertex->costHeapPosition == NOT_IN_HEAP, "");
+    Entry entry;
+    entry.cost = cost;
+    entry.vertex = vertex;
+    vertex->costHeapPosition = mEntries.size();
+    mEntries.push_back(entry);
+}
+
+void LodData::CollapseCostHeap::makeHeap()
+{
+    if (mEntries.size() > 1) {
+        // Sift down every entry having children, starting with the last one.
+        size_t pos = (mEntries.size() - 2) / 4 + 1;
+        while (pos-- > 0) {
+            siftDown(pos);
+        }
+    }
+}
+
+bool LodData::CollapseCostHeap::isLess(const Entry& a, const Entry& b)
+{
+    return a.cost < b.cost || (a.cost == b.cost && (size_t) a.vertex < (size_t) b.vertex);
+}
+
+void LodData::CollapseCostHeap::place(size_t pos, const Entry& entry)
+{
+    mEntries[pos] = entry;
+    entry.vertex->costHeapPosition = pos;
+}
+
+void LodData::CollapseCostHeap::siftUp(size_t pos)
+{
+    Entry entry = mEntries[pos];
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 4;
+        if (!isLess(entry, mEntries[parent])) {
+            break;
+        }
+        place(pos, mEntries[parent]);
+        pos = parent;
+    }
+    place(pos, entry);
+}
+
+void LodData::CollapseCostHeap::siftDown(size_t pos)
+{
+    Entry entry = mEntries[pos];
+    size_t count = mEntries.size();
+    for (;;) {
+        size_t child = pos * 4 + 1;
+        if (child >= count) {
+            break;
+        }
+        size_t childEnd = std::min(child + 4, count);
+        size_t smallest = child;
+        for (++child; child < childEnd; ++child) {
+            if (isLess(mEntries[child], mEntries[smallest])) {
+                smallest = child;
+            }
+        }
+        if (!isLess(mEntries[smallest], entry)) {
+            break;
+        }
+        place(pos, mEntries[smallest]);
+        pos = smallest;
+    }
+    place(pos, entry);
+}
+
+}
@@ -28,11 +28,66 @@
 
 #include "OgreLodInputProvider.h"
 #include "OgreLodData.h"
+#include "OgreWorkQueueParallelFor.h"
 
 #include "OgreLogManager.h"
 
 namespace Ogre
 {
+namespace
+{
+    /// Marks the malformed triangles of a range as removed and computes the normal of the others.
+    class TriangleNormalTask : public WorkQueueParallelFor::Task
+    {
+    public:
+        TriangleNormalTask(LodData* data) : mData(data) {}
+
+        virtual void execute(size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++) {
+                LodData::Triangle& tri = mData->mTriangleList[i];
+                if (tri.isMalformed()) {
+                    tri.isRemoved = true;
+                } else {
+                    tri.computeNormal();
+                }
+            }
+        }
+    private:
+        LodData* mData;
+    };
+
+    /// Adds the triangles and edges of a range of vertices.
+    /// Every vertex only writes its own lists, so ranges don't overlap.
+    class VertexConnectTask : public WorkQueueParallelFor::Task
+    {
+    public:
+        VertexConnectTask(LodData* data, const vector<size_t>::type& triangleOffsets, const vector<size_t>::type& triangleIDs) :
+            mData(data), mTriangleOffsets(triangleOffsets), mTriangleIDs(triangleIDs) {}
+
+        virtual void execute(size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++) {
+                LodData::Vertex* vertex = &mData->mVertexList[i];
+                // Same order as addTriangleToEdges() would use, so the result doesn't depend on threading.
+                for (size_t t = mTriangleOffsets[i]; t < mTriangleOffsets[i + 1]; t++) {
+                    LodData::Triangle* tri = &mData->mTriangleList[mTriangleIDs[t]];
+                    vertex->triangles.addNotExists(tri);
+                    for (int n = 0; n < 3; n++) {
+                        if (tri->vertex[n] != vertex) {
+                            vertex->addEdge(LodData::Edge(tri->vertex[n]));
+                        }
+                    }
+                }
+            }
+        }
+    private:
+        LodData* mData;
+        const vector<size_t>::type& mTriangleOffsets;
+        const vector<size_t>::type& mTriangleIDs;
+    };
+}
+
     
     void LodInputProvider::printTriangle(LodData::Triangle* triangle, stringstream& str)
 {
@@ -102,4 +157,70 @@ void LodInputProvider::addTriangleToEdges(LodData* data, LodData::Triangle* tria
     }
 }
 
-}
\ No newline at end of file
+void LodInputProvider::connectTriangles(LodData* data)
+{
+    WorkQueue* workQueue = data->mUseParallelProcessing ? WorkQueueParallelFor::getRootWorkQueue() : 0;
+    size_t triangleCount = data->mTriangleList.size();
+    TriangleNormalTask normalTask(data);
+    WorkQueueParallelFor::run(normalTask, triangleCount, workQueue, 1024);
+
+    for (size_t i = 0; i < triangleCount; i++) {
+        LodData::Triangle* tri = &data->mTriangleList[i];
+        if (tri->isRemoved) {
+#if OGRE_DEBUG_MODE
+            stringstream str;
+            str << "In " << data->mMeshName << " malformed triangle found with ID: " << i << ". " <<
+            std::endl;
+            printTriangle(tri, str);
+            str << "It will be excluded from Lod level calculations.";
+            LogManager::getSingleton().stream() << str.str();
+#endif
+            data->mIndexBufferInfoList[tri->submeshID].indexCount -= 3;
+        }
+    }
+
+    if(MESHLOD_QUALITY >= 3) {
+        // Duplicate triangle detection depends on the triangles connected before, so it stays serial.
+        for (size_t i = 0; i < triangleCount; i++) {
+            LodData::Triangle* tri = &data->mTriangleList[i];
+            if (!tri->isRemoved) {
+                addTriangleToEdges(data, tri);
+            }
+        }
+        return;
+    }
+
+    // Build the triangle list of every vertex (in triangle order), then connect the vertices in parallel.
+    size_t vertexCount = data->mVertexList.size();
+    if (vertexCount == 0) {
+        return;
+    }
+    const LodData::Vertex* firstVertex = &data->mVertexList[0];
+    vector<size_t>::type triangleOffsets(vertexCount + 1, 0);
+    for (size_t i = 0; i < triangleCount; i++) {
+        const LodData::Triangle& tri = data->mTriangleList[i];
+        if (!tri.isRemoved) {
+            for (int n = 0; n < 3; n++) {
+                triangleOffsets[tri.vertex[n] - firstVertex + 1]++;
+            }
+        }
+    }
+    for (size_t i = 0; i < vertexCount; i++) {
+        triangleOffsets[i + 1] += triangleOffsets[i];
+    }
+    vector<size_t>::type triangleIDs(triangleOffsets[vertexCount]);
+    vector<size_t>::type fillPosition(triangleOffsets.begin(), triangleOffsets.end() - 1);
+    for (size_t i = 0; i < triangleCount; i++) {
+        const LodData::Triangle& tri = data->mTriangleList[i];
+        if (!tri.isRemoved) {
+            for (int n = 0; n < 3; n++) {
+                triangleIDs[fillPosition[tri.vertex[n] - firstVertex]++] = i;
+            }
+        }
+    }
+
+    VertexConnectTask connectTask(data, triangleOffsets, triangleIDs);
+    WorkQueueParallelFor::run(connectTask, vertexCount, workQueue, 256);
+}
+
+}
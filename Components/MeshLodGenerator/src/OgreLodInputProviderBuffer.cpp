@@ -92,6 +92,7 @@ namespace Ogre
             addVertexData(data, vertexBuffer, submesh.useSharedVertexBuffer);
             addIndexData(data, submesh.indexBuffer, submesh.useSharedVertexBuffer, i);
         }
+        connectTriangles(data);
 
         // These were only needed for addIndexData() and addVertexData().
         mSharedVertexLookup.clear();
@@ -134,9 +135,7 @@ namespace Ogre
                     pNormalOut++;
                 }
             } else {
-#if OGRE_DEBUG_MODE
-                v->costHeapPosition = data->mCollapseCostHeap.end();
-#endif
+                v->costHeapPosition = LodData::CollapseCostHeap::NOT_IN_HEAP;
                 v->seam = false;
                 if(data->mUseVertexNormals){
                     v->normal = *pNormalOut;
@@ -91,6 +91,7 @@ namespace Ogre
             if(submesh->indexData->indexCount > 0)
                 addIndexData(data, submesh->indexData, submesh->useSharedVertices, i);
         }
+        connectTriangles(data);
 
         // These were only needed for addIndexData() and addVertexData().
         mSharedVertexLookup.clear();
@@ -156,10 +157,7 @@ namespace Ogre
                 v = *ret.first; // Point to the existing vertex.
                 v->seam = true;
             } else {
-#if OGRE_DEBUG_MODE
-                // Needed for an assert, don't remove it.
-                v->costHeapPosition = data->mCollapseCostHeap.end();
-#endif
+                v->costHeapPosition = LodData::CollapseCostHeap::NOT_IN_HEAP;
                 v->seam = false;
             }
             lookup.push_back(v);
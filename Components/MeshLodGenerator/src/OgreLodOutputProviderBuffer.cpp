@@ -30,6 +30,7 @@
 #include "OgreMesh.h"
 #include "OgreSubMesh.h"
 #include "OgreHardwareBufferManager.h"
+#include "OgreMeshOptimiser.h"
 
 namespace Ogre
 {
@@ -108,6 +109,14 @@ namespace Ogre
                 }
             }
         }
+
+        if (mOptimiseVertexCache) {
+            for (unsigned short i = 0; i < submeshCount; i++) {
+                LodIndexBuffer& curLod = mBuffer.submesh[i].genIndexBuffers[lodIndex];
+                MeshOptimiser::optimiseIndexBuffer(curLod.indexBuffer.get(),
+                                                   data->mIndexBufferInfoList[i].indexCount, curLod.indexSize);
+            }
+        }
     }
 
 void LodOutputProviderBuffer::inject()
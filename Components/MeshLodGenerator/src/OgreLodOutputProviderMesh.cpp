@@ -30,6 +30,7 @@
 #include "OgreMesh.h"
 #include "OgreSubMesh.h"
 #include "OgreHardwareBufferManager.h"
+#include "OgreMeshOptimiser.h"
 
 namespace Ogre
 {
@@ -113,6 +114,13 @@ namespace Ogre
         // Close buffers.
         for (unsigned short i = 0; i < submeshCount; i++) {
             SubMesh::LODFaceList& lods = mMesh->getSubMesh(i)->mLodFaceList;
+            if (mOptimiseVertexCache) {
+                // buf now points past the last index written.
+                size_t indexCount = data->mIndexBufferInfoList[i].indexCount;
+                size_t indexSize = data->mIndexBufferInfoList[i].indexSize;
+                unsigned char* pEnd = reinterpret_cast<unsigned char*>(data->mIndexBufferInfoList[i].buf.pshort);
+                MeshOptimiser::optimiseIndexBuffer(pEnd - indexCount * indexSize, indexCount, indexSize);
+            }
             lods[lodIndex]->indexBuffer->unlock();
         }
     }
@@ -171,7 +171,8 @@ void MeshLodGenerator::_resolveComponents(LodConfig& lodConfig,
             if(lodConfig.advanced.useCompression) {
                 output = LodOutputProviderPtr(new LodOutputProviderCompressedBuffer(lodConfig.mesh));
             } else {
-                output = LodOutputProviderPtr(new LodOutputProviderBuffer(lodConfig.mesh));
+                output = LodOutputProviderPtr(new LodOutputProviderBuffer(lodConfig.mesh,
+                                                                        lodConfig.advanced.optimiseVertexCache));
             }
         }
     } else {
@@ -182,7 +183,8 @@ void MeshLodGenerator::_resolveComponents(LodConfig& lodConfig,
             if(lodConfig.advanced.useCompression) {
                 output = LodOutputProviderPtr(new LodOutputProviderCompressedMesh(lodConfig.mesh));
             } else {
-                output = LodOutputProviderPtr(new LodOutputProviderMesh(lodConfig.mesh));
+                output = LodOutputProviderPtr(new LodOutputProviderMesh(lodConfig.mesh,
+                                                                      lodConfig.advanced.optimiseVertexCache));
             }
         }
     }
@@ -194,6 +196,7 @@ void MeshLodGenerator::_process(LodConfig& lodConfig,
                                 LodOutputProvider* output,
                                 LodCollapser* collapser)
 {
+    data->mUseParallelProcessing = lodConfig.advanced.useParallelProcessing;
     input->initData(data);
     data->mUseVertexNormals = data->mUseVertexNormals && lodConfig.advanced.useVertexNormals;
     cost->initCollapseCosts(data);
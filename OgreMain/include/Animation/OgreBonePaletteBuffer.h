@@ -0,0 +1,139 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __BonePaletteBuffer_H__
+#define __BonePaletteBuffer_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreHardwareUniformBuffer.h"
+#include "OgreFastArray.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    class Bone;
+    class BoneMemoryManager;
+    class SkeletonInstance;
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Animation
+    *  @{
+    */
+
+    /** GPU skinning palette holding the final transforms of all the bones managed by a
+        BoneMemoryManager (that is, of all the SkeletonInstances based on the same SkeletonDef).
+    @remarks
+        The final transforms already live in the BoneMemoryManager as a contiguous array of
+        SimpleMatrixAf4x3 per depth level, so upload copies each level straight into the
+        buffer, instead of building a matrix array per instance (SkeletonInstance::getTransforms)
+        which is then copied again into the GpuProgramParameters.
+    @par
+        The buffer holds all the slots of depth level 0, followed by all the slots of depth
+        level 1, etc. Each matrix is 3 rows of 4 floats (a 4x3 affine matrix in row major order).
+        Skinned renderables index into it with @see getPaletteIndices.
+    @par
+        The indices change when the BoneMemoryManager moves the bones around (i.e. after a
+        cleanup, or when it grows), in which case getLayoutVersion changes. Renderables
+        caching their indices should compare it against the version they were built with.
+    @par
+        The copy is deferred until a consumer asks for the buffer (@see getBuffer), so
+        frames in which nothing renders with the palette don't pay for the upload.
+    */
+    class _OgreExport BonePaletteBuffer : public AnimationAlloc
+    {
+        BoneMemoryManager   *mBoneMemoryManager;
+
+        HardwareUniformBufferSharedPtr  mBuffer;
+
+        /// Index of the first matrix of each depth level in mBuffer
+        FastArray<size_t>   mLevelOffsets;
+        /// Total number of matrices, the sum of the slots of all depth levels
+        size_t              mNumMatrices;
+        uint32              mLayoutVersion;
+        /// True when the transforms changed since the last upload
+        bool                mDirty;
+
+        /// Recalculates mLevelOffsets & mNumMatrices.
+        void updateLevelOffsets(void);
+
+        /// Copies the final transforms of all bones into the buffer, growing it if needed.
+        void upload(void);
+
+    public:
+        BonePaletteBuffer( BoneMemoryManager *boneMemoryManager );
+        ~BonePaletteBuffer();
+
+        /** Tells the palette the final transforms have changed. They're uploaded the next
+            time getBuffer is called. Must be called from the main thread, after the
+            animations have been updated.
+        */
+        void _notifyTransformsChanged(void);
+
+        /** Returns the buffer, uploading the final transforms first if they changed since
+            the last call. Must be called from the main thread.
+        @return
+            Null if there are no bones. The buffer may change between calls if it had to grow.
+        */
+        const HardwareUniformBufferSharedPtr& getBuffer(void);
+
+        /// True if the next call to getBuffer will upload the transforms.
+        bool isDirty(void) const                                        { return mDirty; }
+
+        /// Incremented every time the palette indices change. @see getPaletteIndices
+        uint32 getLayoutVersion(void) const                             { return mLayoutVersion; }
+
+        /// Index of the given bone's transform in the buffer.
+        uint32 getPaletteIndex( Bone *bone ) const;
+
+        /** Retrieves the indices in the buffer of the given bones of a SkeletonInstance.
+        @param skeletonInstance
+            Instance the bones belong to. Must have been created from the SkeletonDef
+            this palette was created for.
+        @param usedBones
+            Indices of the bones to retrieve (same as in SkeletonInstance::getTransforms).
+        @param outIndices [out]
+            Array to fill. Must hold at least usedBones.size() elements.
+        */
+        void getPaletteIndices( SkeletonInstance *skeletonInstance,
+                                const FastArray<unsigned short> &usedBones,
+                                uint32 * RESTRICT_ALIAS outIndices ) const;
+
+        /// Called when the bones have been moved in memory (i.e. cleanups)
+        void _notifyLayoutChanged(void)                                 { ++mLayoutVersion; }
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -31,7 +31,9 @@ THE SOFTWARE.
 
 #include "OgrePrerequisites.h"
 #include "OgreIdString.h"
+#include "OgreSharedPtr.h"
 #include "Math/Array/OgreBoneMemoryManager.h"
+#include "Animation/OgreBonePaletteBuffer.h"
 
 #include "OgreHeaderPrefix.h"
 
@@ -57,16 +59,28 @@ namespace Ogre
         FastArray<SkeletonInstance*>    skeletons;
 
         /** One per thread (plus one), tells where we should start from in each
-            thread. It's not exactly skeletons.size() / mNumWorkerThreads because
-            we need to account that instances that share the same memory block.
+            thread. The skeletons are split so that each thread gets roughly the
+            same amount of work (@see SkeletonInstance::_getLodUpdateCost) rather
+            than the same number of instances, and we need to account that instances
+            that share the same memory block go to the same thread.
         */
         FastArray<size_t>               threadStarts;
 
+        /// Optional. Uploaded every frame after the animations are updated.
+        /// @see SkeletonAnimManager::getBonePaletteBuffer
+        SharedPtr<BonePaletteBuffer>    bonePaletteBuffer;
+
         BySkeletonDef( const SkeletonDef *skeletonDef, size_t threadCount );
 
         void initializeMemoryManager(void);
 
         void updateThreadStarts(void);
+
+        /** Selects the animation LOD of all our instances for this frame, then rebalances
+            threadStarts based on the work each of them now needs.
+            @see SkeletonInstance::_updateLod
+        */
+        void _updateLods(void);
         void _updateBoneStartTransforms(void);
 
         bool operator == ( IdString name ) const { return skeletonDefName == name; }
@@ -108,6 +122,21 @@ namespace Ogre
         SkeletonInstance* createSkeletonInstance( const SkeletonDef *skeletonDef,
                                                     size_t numWorkerThreads );
         void destroySkeletonInstance( SkeletonInstance *skeletonInstance );
+
+        /** Returns the GPU skinning palette of all the instances of the given definition,
+            creating it the first time. @see BonePaletteBuffer
+        @remarks
+            At least one instance of the definition must have been created. Throws otherwise.
+        */
+        BonePaletteBuffer* getBonePaletteBuffer( const SkeletonDef *skeletonDef );
+
+        /// Flags the palettes created with getBonePaletteBuffer as out of date. Must be
+        /// called from the main thread, after the animations have been updated.
+        void _notifyBonePaletteBuffers(void);
+
+        /// Calls BySkeletonDef::_updateLods on all definitions. Must be called from the
+        /// main thread, before the instances are updated by the worker threads.
+        void _updateLods(void);
     };
 
     /** @} */
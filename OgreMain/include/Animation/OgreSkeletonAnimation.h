@@ -55,7 +55,9 @@ namespace Ogre
     {
         SkeletonAnimationDef const  *mDefinition;
     protected:
-        RawSimdUniquePtr<ArrayReal, MEMCATEGORY_ANIMATION> mBoneWeights;
+        /// One ArrayReal per track. Held as Reals because ArrayReal loses its
+        /// attributes when used as a template argument.
+        RawSimdUniquePtr<Real, MEMCATEGORY_ANIMATION> mBoneWeights;
         Real                    mCurrentFrame;
     public:
         Real                    mFrameRate;     // Playback framerate
@@ -149,7 +151,21 @@ namespace Ogre
         void setEnabled( bool bEnable );
         bool getEnabled(void) const                                 { return mEnabled; }
 
-        void _applyAnimation( const TransformArray &boneTransforms );
+        /** Applies the animation to the given bones.
+        @param numDepthLevels
+            Only the tracks of bones in the first numDepthLevels levels of the hierarchy
+            are applied. @see SkeletonDef::AnimationLod
+        @param weight
+            Multiplied against mWeight. Used by the blend tree. @see SkeletonAnimationLayer
+        @param boneMask
+            Optional. Mask of per-bone weights that is multiplied against ours, in the same
+            layout as the bones' SIMD blocks. Null to apply our weights only.
+        @param levelBlockStarts
+            The block of boneMask where each depth level starts. Ignored if boneMask is null.
+        */
+        void _applyAnimation( const TransformArray &boneTransforms, size_t numDepthLevels,
+                              Real weight, const ArrayReal *boneMask,
+                              const FastArray<size_t> *levelBlockStarts );
 
         const SkeletonAnimationDef* getDefinition(void) const       { return mDefinition; }
     };
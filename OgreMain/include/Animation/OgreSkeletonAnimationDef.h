@@ -79,6 +79,19 @@ namespace Ogre
 
         void build( const Skeleton *skeleton, const Animation *animation, Real frameRate );
 
+        /** Compresses all the tracks. @see SkeletonTrack::_compress
+        @remarks
+            SkeletonAnimations cache iterators to the keyframes, so this must be called
+            before any SkeletonInstance using this animation is created.
+            The memory of the uncompressed keyframes is released.
+        */
+        void compress( Real positionTolerance, Radian orientationTolerance, Real scaleTolerance );
+
+        bool isCompressed(void) const;
+
+        /// Bytes used by the transforms of the keyframes of all tracks
+        size_t getKeyFrameMemoryUsage(void) const;
+
         /// Dumps all the tracks in CSV format to the output string argument.
         /// Mostly for debugging purposes. (also easy example to show how to
         /// enumerate all the tracks and get the bones back from its block index)
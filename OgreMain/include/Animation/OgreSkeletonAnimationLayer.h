@@ -0,0 +1,333 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __SkeletonAnimationLayer_H__
+#define __SkeletonAnimationLayer_H__
+
+#include "OgreSkeletonTrack.h"
+#include "OgreIdString.h"
+#include "OgreRawPtr.h"
+#include "OgreVector2.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    class SkeletonAnimation;
+    class SkeletonInstance;
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Animation
+    *  @{
+    */
+
+    struct WeightedAnimation
+    {
+        SkeletonAnimation   *animation;
+        Real                weight;
+
+        WeightedAnimation( SkeletonAnimation *_animation, Real _weight ) :
+            animation( _animation ), weight( _weight ) {}
+    };
+
+    typedef vector<WeightedAnimation>::type WeightedAnimationVec;
+
+    /** Node of the blend tree of a SkeletonAnimationLayer. The tree decides which animations
+        are applied in each frame and with which weight; the animations themselves are applied
+        by the layer using the SIMD keyframe kernels, ARRAY_PACKED_REALS bones at a time.
+    @remarks
+        Nodes are created and owned by a SkeletonAnimationLayer.
+    */
+    class _OgreExport SkeletonBlendNode : public AnimationAlloc
+    {
+    public:
+        virtual ~SkeletonBlendNode() {}
+
+        /// Advances the playback of the animations below this node (and of its crossfades)
+        virtual void addTime( Real time ) = 0;
+
+        /** Appends the animations below this node, along with their weights, to outAnimations.
+            The weights of the appended animations add up to the given weight.
+        */
+        virtual void _collectAnimations( Real weight, WeightedAnimationVec &outAnimations ) const = 0;
+
+        /// Maximum number of animations _collectAnimations may append.
+        virtual size_t getMaxAnimations(void) const = 0;
+    };
+
+    /// Leaf of the blend tree, plays a single animation.
+    class _OgreExport SkeletonBlendClip : public SkeletonBlendNode
+    {
+        SkeletonAnimation   *mAnimation;
+
+    public:
+        SkeletonBlendClip( SkeletonAnimation *animation );
+
+        SkeletonAnimation* getAnimation(void) const         { return mAnimation; }
+
+        virtual void addTime( Real time );
+        virtual void _collectAnimations( Real weight, WeightedAnimationVec &outAnimations ) const;
+        virtual size_t getMaxAnimations(void) const         { return 1; }
+    };
+
+    /** Blends its children based on a parameter (i.e. speed to blend between idle, walk
+        and run). Each child sits at a position; the two children surrounding the parameter
+        are interpolated linearly. Beyond the first or last child, that child is used alone.
+    */
+    class _OgreExport SkeletonBlendSpace1D : public SkeletonBlendNode
+    {
+        struct Sample
+        {
+            Real                position;
+            SkeletonBlendNode   *node;
+
+            Sample( Real _position, SkeletonBlendNode *_node ) :
+                position( _position ), node( _node ) {}
+
+            bool operator < ( Real _position ) const { return position < _position; }
+        };
+        typedef vector<Sample>::type SampleVec;
+
+        SampleVec   mSamples;
+        Real        mParameter;
+
+    public:
+        SkeletonBlendSpace1D();
+
+        /// Adds a child at the given position. Children can be added in any order.
+        void addSample( SkeletonBlendNode *node, Real position );
+
+        void setParameter( Real parameter )                 { mParameter = parameter; }
+        Real getParameter(void) const                       { return mParameter; }
+
+        virtual void addTime( Real time );
+        virtual void _collectAnimations( Real weight, WeightedAnimationVec &outAnimations ) const;
+        virtual size_t getMaxAnimations(void) const;
+    };
+
+    /** Blends its children based on a 2D parameter (i.e. velocity on the ground plane, to
+        blend between strafing animations). Each child sits at a position; their weights are
+        inversely proportional to the squared distance between the parameter and them. A child
+        exactly at the parameter's position is used alone.
+    */
+    class _OgreExport SkeletonBlendSpace2D : public SkeletonBlendNode
+    {
+        struct Sample
+        {
+            Vector2             position;
+            SkeletonBlendNode   *node;
+
+            Sample( const Vector2 &_position, SkeletonBlendNode *_node ) :
+                position( _position ), node( _node ) {}
+        };
+        typedef vector<Sample>::type SampleVec;
+
+        SampleVec   mSamples;
+        Vector2     mParameter;
+
+    public:
+        SkeletonBlendSpace2D();
+
+        void addSample( SkeletonBlendNode *node, const Vector2 &position );
+
+        void setParameter( const Vector2 &parameter )       { mParameter = parameter; }
+        const Vector2& getParameter(void) const             { return mParameter; }
+
+        virtual void addTime( Real time );
+        virtual void _collectAnimations( Real weight, WeightedAnimationVec &outAnimations ) const;
+        virtual size_t getMaxAnimations(void) const;
+    };
+
+    /** Plays one of its children (states) at a time, and crossfades between them when
+        switching to another state.
+    @remarks
+        If crossfadeTo is called while a crossfade is still in progress, the new crossfade
+        starts from the weights every state has at that moment (all of them fade out
+        except the new one, which fades in from its weight), so the pose doesn't jump.
+    */
+    class _OgreExport SkeletonBlendStateMachine : public SkeletonBlendNode
+    {
+        struct State
+        {
+            IdString            name;
+            SkeletonBlendNode   *node;
+            /// Weight of the state when the last crossfade started
+            Real                startWeight;
+
+            State( IdString _name, SkeletonBlendNode *_node, Real _startWeight ) :
+                name( _name ), node( _node ), startWeight( _startWeight ) {}
+
+            bool operator == ( IdString _name ) const { return name == _name; }
+        };
+        typedef vector<State>::type StateVec;
+
+        StateVec    mStates;
+        size_t      mCurrentState;
+        Real        mCrossfadeTime;
+        /// 0 when not crossfading
+        Real        mCrossfadeDuration;
+
+        size_t findState( IdString name ) const;
+
+        /// Weight of the given state at the current point of the crossfade
+        Real getStateWeight( size_t stateIdx ) const;
+
+    public:
+        SkeletonBlendStateMachine();
+
+        /// Adds a new state. The first state that is added becomes the current one.
+        void addState( IdString name, SkeletonBlendNode *node );
+
+        /// Switches to the given state immediately. Throws if the state doesn't exist.
+        void setState( IdString name );
+
+        /** Switches to the given state, fading the current one out during the given
+            time in seconds. Throws if the state doesn't exist.
+        */
+        void crossfadeTo( IdString name, Real duration );
+
+        /// Returns the name of the current state (the one being faded in, if crossfading).
+        IdString getCurrentState(void) const;
+
+        bool isCrossfading(void) const;
+
+        /// Returns how much the given state contributes right now. Throws if it doesn't exist.
+        Real getStateWeight( IdString name ) const;
+
+        virtual void addTime( Real time );
+        virtual void _collectAnimations( Real weight, WeightedAnimationVec &outAnimations ) const;
+        virtual size_t getMaxAnimations(void) const;
+    };
+
+    /** A layer of animation on a SkeletonInstance, driven by a tree of SkeletonBlendNodes.
+        Layers are applied in the order they were created, after the animations enabled
+        through SkeletonAnimation::setEnabled (which act as the base layer).
+    @par
+        Override layers evaluate their tree into a temporary pose (starting from the binding
+        pose), which is then blended into the bones using the layer's weight and bone mask.
+        Additive layers apply their animations directly on top of the current pose, scaled
+        by the layer's weight and bone mask.
+    @par
+        The evaluation happens in SkeletonInstance::update, inside the worker threads, one
+        SIMD block of bones at a time, so complex rigs don't need per-bone code in the
+        application. Animations used by a layer should not be enabled with setEnabled,
+        otherwise they get applied twice; their time is advanced through addTime.
+    */
+    class _OgreExport SkeletonAnimationLayer : public AnimationAlloc
+    {
+    public:
+        enum BlendMode
+        {
+            /// Blends towards the layer's pose
+            BLEND_OVERRIDE,
+            /// Adds the layer's animations on top of the current pose
+            BLEND_ADDITIVE
+        };
+
+    protected:
+        typedef vector<SkeletonBlendNode*>::type SkeletonBlendNodeVec;
+
+        IdString                mName;
+        BlendMode               mBlendMode;
+        Real                    mWeight;
+        SkeletonInstance        *mOwner;
+
+        SkeletonBlendNode       *mRootNode;
+        SkeletonBlendNodeVec    mNodes;
+
+        /// Per-bone weights, in the same layout as the bones' SIMD blocks (one
+        /// ArrayReal per block), with 0 in the slots that don't belong to mOwner.
+        RawSimdUniquePtr<Real, MEMCATEGORY_ANIMATION> mBoneMask;
+        /// The block of mBoneMask where each depth level starts
+        FastArray<size_t>       mLevelBlockStarts;
+
+        /// Filled during _apply, kept to avoid allocating every frame
+        WeightedAnimationVec    mWeightedAnimations;
+
+        template <typename T> T* addNode( T *node );
+
+    public:
+        SkeletonAnimationLayer( IdString name, BlendMode blendMode, SkeletonInstance *owner );
+        ~SkeletonAnimationLayer();
+
+        IdString getName(void) const                        { return mName; }
+        BlendMode getBlendMode(void) const                  { return mBlendMode; }
+
+        /// Weight of the whole layer. Normal range is [0; 1]. A layer with no weight is skipped.
+        void setWeight( Real weight )                       { mWeight = weight; }
+        Real getWeight(void) const                          { return mWeight; }
+
+        /// Creates a leaf node playing the given animation of our owner. Throws if not found.
+        SkeletonBlendClip* createClip( IdString animationName );
+        SkeletonBlendSpace1D* createBlendSpace1D(void);
+        SkeletonBlendSpace2D* createBlendSpace2D(void);
+        SkeletonBlendStateMachine* createStateMachine(void);
+
+        /// Sets the node the layer is evaluated from. Must have been created by this layer.
+        void setRootNode( SkeletonBlendNode *rootNode );
+        SkeletonBlendNode* getRootNode(void) const          { return mRootNode; }
+
+        /// Advances the animations of the tree. @see SkeletonAnimation::addTime
+        void addTime( Real time );
+
+        /** Sets how much the layer affects a bone, to restrict the layer to part of the
+            body (i.e. upper body only). By default all bones have a weight of 1.
+        @param boneName
+            Name of the bone. Throws if not found.
+        @param weight
+            The weight. Normal range is [0; 1]
+        @param includeChildren
+            When true, all the bones below this bone in the hierarchy get the weight too.
+        */
+        void setBoneMask( IdString boneName, Real weight, bool includeChildren );
+        Real getBoneMask( IdString boneName ) const;
+
+        /// Upper bound of animations applied by _apply. Used to estimate the work to do.
+        size_t getMaxAnimations(void) const;
+
+        /** Evaluates the tree and applies it to the bones. @see SkeletonInstance::update
+        @param boneTransforms
+            Bones of our owner, at the start of each depth level.
+        @param layerPose
+            Temporary pose, in the same layout as boneTransforms. Only used by override layers.
+        @param numDepthLevels
+            Number of depth levels to update. @see SkeletonDef::AnimationLod
+        */
+        void _apply( const TransformArray &boneTransforms, const TransformArray &layerPose,
+                     size_t numDepthLevels );
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -78,6 +78,30 @@ namespace Ogre
 
         typedef vector<DepthLevelInfo>::type DepthLevelInfoVec;
 
+        /** Describes how the instances are animated when their LOD value reaches lodValue.
+            @see setAnimationLods
+        */
+        struct AnimationLod
+        {
+            /// LOD value (e.g. distance) at which this level starts to be used
+            Real    lodValue;
+            /// The animations are evaluated once every updateInterval frames. Must be >= 1
+            uint32  updateInterval;
+            /// Only the bones in the first numDepthLevels levels of the hierarchy are animated,
+            /// deeper ones (i.e. fingers) are left in the binding pose. Must be >= 1
+            size_t  numDepthLevels;
+
+            AnimationLod( Real _lodValue, uint32 _updateInterval,
+                          size_t _numDepthLevels=std::numeric_limits<size_t>::max() ) :
+                lodValue( _lodValue ),
+                updateInterval( _updateInterval ),
+                numDepthLevels( _numDepthLevels )
+            {
+            }
+        };
+
+        typedef vector<AnimationLod>::type AnimationLodVec;
+
         typedef map<uint32, uint32>::type IndexToIndexMap;
         typedef vector<uint32>::type BoneToSlotVec;
 
@@ -127,6 +151,9 @@ namespace Ogre
 
         vector<list<size_t>::type>::type mBonesPerDepth;
 
+        /// @see setAnimationLods
+        AnimationLodVec         mAnimationLods;
+
         String                  mName;
 
     public:
@@ -140,6 +167,34 @@ namespace Ogre
 
         const String& getName(void) const                               { return mName; }
 
+        /** Compresses the keyframes of all animations.
+            @see SkeletonAnimationDef::compress for the remarks.
+        */
+        void compressAnimations( Real positionTolerance, Radian orientationTolerance,
+                                 Real scaleTolerance );
+
+        /** Sets the animation LOD levels of all the instances based on this definition.
+            Instances whose LOD source (@see SkeletonInstance::setLodSource) has a LOD value
+            lower than the first level are animated every frame with all of their bones.
+        @remarks
+            When an instance skips a frame its bones keep the pose from the last update, but
+            their derived transforms are still updated, so the instance still follows its
+            parent node. The animations keep advancing normally (addTime is not affected),
+            the skipped frames just aren't evaluated.
+        @par
+            The LOD value of the source is only refreshed while it's visible, and comes from
+            the LOD camera of the last pass that saw it (@see MovableObject::getCurrentLodValue).
+            A culled instance keeps the level it had when it was last seen.
+        @param lods
+            The levels, sorted from highest to lowest detail. The lodValues are user values,
+            like mesh LOD values. Each instance transforms them with the LodStrategy that
+            calculated the LOD value of its source, so sources using different strategies
+            can share the definition as long as the order holds for all of them.
+            Pass an empty vector to disable animation LOD.
+        */
+        void setAnimationLods( const AnimationLodVec &lods );
+        const AnimationLodVec& getAnimationLods(void) const             { return mAnimationLods; }
+
         const BoneDataVec& getBones(void) const                         { return mBones; }
         const SkeletonAnimationDefVec& getAnimationDefs(void) const     { return mAnimationDefs; }
         const DepthLevelInfoVec& getDepthLevelInfo(void) const          { return mDepthLevelInfoVec; }
@@ -30,6 +30,7 @@ THE SOFTWARE.
 #define _SkeletonInstance2_H__
 
 #include "OgreSkeletonAnimation.h"
+#include "OgreSkeletonAnimationLayer.h"
 #include "Animation/OgreBone.h"
 
 namespace Ogre
@@ -37,6 +38,7 @@ namespace Ogre
     class SkeletonDef;
     typedef vector<SkeletonAnimation>::type SkeletonAnimationVec;
     typedef vector<SkeletonAnimation*>::type ActiveAnimationsVec;
+    typedef vector<SkeletonAnimationLayer*>::type SkeletonAnimationLayerVec;
 
     /** \addtogroup Core
     *  @{
@@ -77,13 +79,22 @@ namespace Ogre
         BoneVec             mBones;
         TransformArray      mBoneStartTransforms; /// The start of Transform at each depth level
 
-        RawSimdUniquePtr<ArrayReal, MEMCATEGORY_ANIMATION> mManualBones;
+        RawSimdUniquePtr<Real, MEMCATEGORY_ANIMATION> mManualBones;
 
         FastArray<size_t>       mSlotStarts;
 
         SkeletonAnimationVec    mAnimations;
         ActiveAnimationsVec     mActiveAnimations;
 
+        /// Applied in order after mActiveAnimations. @see SkeletonAnimationLayer
+        SkeletonAnimationLayerVec   mAnimationLayers;
+        /// Temporary pose override layers are evaluated into. Same layout as mBoneStartTransforms
+        /// but the memory is ours, allocated when the first override layer is created.
+        TransformArray              mLayerPose;
+        RawSimdUniquePtr<ArrayVector3, MEMCATEGORY_ANIMATION>       mLayerPosePositions;
+        RawSimdUniquePtr<ArrayQuaternion, MEMCATEGORY_ANIMATION>    mLayerPoseOrientations;
+        RawSimdUniquePtr<ArrayVector3, MEMCATEGORY_ANIMATION>       mLayerPoseScales;
+
         SkeletonDef const       *mDefinition;
 
         /** Unused slots for each parent depth level that had more bones
@@ -94,6 +105,21 @@ namespace Ogre
         /// Node this SkeletonInstance is attached to (so we can work in world space)
         Node                    *mParentNode;
 
+        /// Object whose LOD value selects our animation LOD. @see setLodSource
+        MovableObject const     *mLodSource;
+        /// Incremented every frame, starts at a different value in each instance so that
+        /// instances with the same update interval don't all animate in the same frame.
+        uint32                  mLodFrameCount;
+        /// Number of depth levels that get animated. @see SkeletonDef::AnimationLod
+        size_t                  mLodNumDepthLevels;
+        /// Whether update will evaluate the animations in this frame
+        bool                    mLodAnimateThisFrame;
+        /// Estimation of the work required to update this instance. @see _updateLod
+        size_t                  mLodUpdateCost;
+
+        /// Copies the binding pose into mLayerPose
+        void resetLayerPose(void);
+
     public:
         SkeletonInstance( const SkeletonDef *skeletonDef, BoneMemoryManager *boneMemoryManager );
         ~SkeletonInstance();
@@ -152,6 +178,26 @@ namespace Ogre
         /// Internal use. Disables given animation. Input should belong to us and already being animated.
         void _disableAnimation( SkeletonAnimation *animation );
 
+        /** Creates a new animation layer, applied on top of the enabled animations and
+            the layers created before it. @see SkeletonAnimationLayer
+        @param name
+            Name of the layer. Must be unique within this instance.
+        */
+        SkeletonAnimationLayer* createAnimationLayer( IdString name,
+                                                      SkeletonAnimationLayer::BlendMode blendMode );
+        /// Returns the requested layer. Throws if not found.
+        SkeletonAnimationLayer* getAnimationLayer( IdString name );
+        void destroyAnimationLayer( SkeletonAnimationLayer *layer );
+        const SkeletonAnimationLayerVec& getAnimationLayers(void) const { return mAnimationLayers; }
+
+        /** Fills a mask of per-bone weights laid out like our bones' SIMD blocks (one
+            ArrayReal per block, @see SkeletonDef::getNumberOfBoneBlocks), setting our
+            bones to the given value and the slots that don't belong to us to 0.
+        */
+        void _fillBoneMask( Real *outMask, Real value ) const;
+        /// Index of the given bone's weight in a mask filled by _fillBoneMask, in Reals.
+        size_t _getBoneMaskIndex( Bone *bone ) const;
+
         /** Sets our parent node so that our bones are in World space.
             Iterates through all our bones and sets the root bones
         */
@@ -160,6 +206,23 @@ namespace Ogre
         /// Returns our parent node. May be null.
         Node* getParentNode(void) const                                     { return mParentNode; }
 
+        /** Sets the object whose LOD value (@see MovableObject::getCurrentLodValue) selects
+            the animation LOD level from our definition (@see SkeletonDef::setAnimationLods).
+            Usually the object being skinned by this instance.
+        @param lodSource
+            The object. Null to always animate at full detail (default).
+        */
+        void setLodSource( const MovableObject *lodSource )                 { mLodSource = lodSource; }
+        const MovableObject* getLodSource(void) const                       { return mLodSource; }
+
+        /** Selects the animation LOD level for the current frame and estimates how much
+            work our update will take. Called once per frame before the animations are updated.
+        */
+        void _updateLod(void);
+
+        /// Returns the cost estimated by the last call to _updateLod, in bone blocks
+        size_t _getLodUpdateCost(void) const                                { return mLodUpdateCost; }
+
         void getTransforms( SimpleMatrixAf4x3 * RESTRICT_ALIAS outTransform,
                             const FastArray<unsigned short> &usedBones ) const;
 
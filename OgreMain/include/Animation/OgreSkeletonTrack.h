@@ -78,6 +78,22 @@ namespace Ogre
 
         KfTransformArrayMemoryManager *mLocalMemoryManager;
 
+        /** When the track is compressed (@see _compress) KeyFrameRig::mBoneTransform is null
+            and the transforms of keyframe i are stored here, starting at
+            i * OGRE_KF_TRANSFORM_NUM_REALS. Each component is quantized to 16 bits
+            within the range of values it takes along the track.
+        */
+        vector<uint16>::type    mCompressedKeyFrames;
+        /** OGRE_KF_TRANSFORM_NUM_REALS minimums followed by OGRE_KF_TRANSFORM_NUM_REALS
+            steps. The real value is minimum + step * quantized value.
+        */
+        vector<Real>::type      mQuantization;
+
+        /// Whether interpolating keyframes 'first' and 'last' reproduces all the keyframes
+        /// in between within the given tolerances
+        bool canInterpolate( size_t first, size_t last, Real positionTolerance,
+                             Radian orientationTolerance, Real scaleTolerance ) const;
+
     public:
         SkeletonTrack( uint32 boneBlockIdx, KfTransformArrayMemoryManager *kfTransformMemoryManager );
         ~SkeletonTrack();
@@ -126,6 +142,31 @@ namespace Ogre
             mUsedSlots <= (ARRAY_PACKED_REALS >> 1). Otherwise it does nothing.
         */
         void _bakeUnusedSlots(void);
+
+        /** Removes the keyframes that interpolating their neighbours reproduces within
+            the given tolerances (the first and last keyframes are always kept), then
+            quantizes the rest (@see mCompressedKeyFrames).
+        @remarks
+            Afterwards the track doesn't use the memory from the KfTransformArrayMemoryManager
+            anymore. SkeletonAnimations cache iterators to the keyframes, thus this must be
+            called before they're created. @see SkeletonAnimationDef::compress
+        @param positionTolerance
+            Maximum distance between the removed keyframes' position and the interpolated one.
+        @param orientationTolerance
+            Maximum angle between the removed keyframes' orientation and the interpolated one.
+        @param scaleTolerance
+            Maximum difference between each component of the removed keyframes' scale and
+            the interpolated one.
+        */
+        void _compress( Real positionTolerance, Radian orientationTolerance, Real scaleTolerance );
+
+        bool isCompressed(void) const                           { return !mQuantization.empty(); }
+
+        /// Bytes used by the transforms of the keyframes
+        size_t getKeyFrameMemoryUsage(void) const;
+
+        /// Copies the transforms of the given keyframe (decompressing them if needed)
+        void getKeyFrameTransform( size_t keyFrameIdx, KfTransform &outTransform ) const;
     };
 
     typedef vector<SkeletonTrack>::type SkeletonTrackVec;
@@ -65,6 +65,8 @@ namespace Ogre
         Camera                  *mCamera;
         Camera                  *mLodCamera;
         bool                    mUpdateShadowNode;
+        /// Pass executed right after us, if it's a scene pass. @See _scheduleCullPrefetch
+        CompositorPassScene     *mNextPassScene;
 
     public:
         /** Constructor
@@ -86,6 +88,16 @@ namespace Ogre
         Camera* getCamera() const                               { return mCamera; }
         void _setCustomCamera( Camera *camera )                 { mCamera = camera; }
         void _setUpdateShadowNode( bool update )                { mUpdateShadowNode = update; }
+        void _setNextPassScene( CompositorPassScene *nextPass ) { mNextPassScene = nextPass; }
+
+        /** Asks our SceneManager to start culling for this pass while the previous
+            one is being rendered, if cull prefetching is enabled and nothing in
+            execute() would change the camera before culling.
+            @See SceneManager::setCullPrefetch
+        @param lodCamera
+            Same value that will be passed to execute()
+        */
+        void _scheduleCullPrefetch( const Camera *lodCamera );
 
         virtual void notifyCleared(void);
 
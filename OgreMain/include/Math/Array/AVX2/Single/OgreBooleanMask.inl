@@ -0,0 +1,75 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+namespace Ogre
+{
+    inline ArrayReal BooleanMask4::getMask( bool b[8] )
+    {
+#if __cplusplus > 199711L //C++11
+        static_assert( sizeof(bool) == 1, "This code relies on correct casting!" );
+#else
+        assert( sizeof(bool) == 1 && "This code relies on correct casting!" );
+#endif
+        //Expand the 8 bytes into 8 dwords, then turn non-zeroes into 0xffffffff
+        __m256i bools = _mm256_cvtepu8_epi32( _mm_loadl_epi64( reinterpret_cast<__m128i*>( b ) ) );
+        return _mm256_castsi256_ps( _mm256_xor_si256(
+                                        _mm256_cmpeq_epi32( bools, _mm256_setzero_si256() ),
+                                        _mm256_set1_epi32( -1 ) ) );
+    }
+    //--------------------------------------------------------------------------------------
+    inline bool BooleanMask4::allBitsSet( bool mask0[8], bool mask1[8] )
+    {
+#if __cplusplus > 199711L //C++11
+        static_assert( sizeof(bool) == 1 && sizeof(uint64) == 8,
+                       "This code relies on correct casting!" );
+#else
+        assert( sizeof(bool) == 1 && sizeof(uint64) == 8 && "This code relies on correct casting!" );
+#endif
+        return ( *reinterpret_cast<uint64*>(mask0) & *reinterpret_cast<uint64*>(mask1) ) ==
+                0x0101010101010101ULL;
+    }
+    //--------------------------------------------------------------------------------------
+    inline uint32 BooleanMask4::getScalarMask( ArrayReal mask )
+    {
+        return static_cast<uint32>( _mm256_movemask_ps( mask ) );
+    }
+    //--------------------------------------------------------------------------------------
+    inline uint32 BooleanMask4::getScalarMask( ArrayInt mask )
+    {
+        return static_cast<uint32>( _mm256_movemask_ps( _mm256_castsi256_ps( mask ) ) );
+    }
+
+    #define IS_SET_MASK_X( intMask ) ((intMask & MASK_W) != 0)
+    #define IS_SET_MASK_Y( intMask ) ((intMask & MASK_Z) != 0)
+    #define IS_SET_MASK_Z( intMask ) ((intMask & MASK_Y) != 0)
+    #define IS_SET_MASK_W( intMask ) ((intMask & MASK_X) != 0)
+
+    #define MASK_ALL_BITS_SET 8
+
+    #define IS_BIT_SET( bit, intMask ) ( (intMask & (1 << bit) ) != 0)
+}
@@ -32,7 +32,53 @@ THE SOFTWARE.
 #include "OgrePlatformInformation.h"
 
 #if OGRE_USE_SIMD == 1
-    #if OGRE_CPU == OGRE_CPU_X86
+    #if OGRE_CPU == OGRE_CPU_X86 && __OGRE_HAVE_AVX2
+        //x86/x64 - AVX2 (+FMA3, every AVX2 capable CPU has it)
+        #include <immintrin.h>
+        #define ARRAY_PACKED_REALS 8
+        namespace Ogre {
+            typedef __m256 ArrayReal;
+            typedef __m256 ArrayMaskR;
+            typedef __m256i ArrayInt;
+            typedef __m256i ArrayMaskI;
+
+            #define ARRAY_REAL_ZERO _mm256_setzero_ps()
+            #define ARRAY_INT_ZERO _mm256_setzero_si256()
+
+            class ArrayRadian;
+        }
+
+        #define OGRE_PREFETCH_T0( x ) _mm_prefetch( x, _MM_HINT_T0 )
+        #define OGRE_PREFETCH_T1( x ) _mm_prefetch( x, _MM_HINT_T1 )
+        #define OGRE_PREFETCH_T2( x ) _mm_prefetch( x, _MM_HINT_T2 )
+        #define OGRE_PREFETCH_NTA( x ) _mm_prefetch( x, _MM_HINT_NTA )
+
+        //Distance (in ArrayMemoryManager's slots) used to keep fetching data. This also
+        //means the memory manager needs to allocate extra memory for them.
+        //Same distance in slots as SSE2 (each block is twice as big)
+        #define OGRE_PREFETCH_SLOT_DISTANCE     2*ARRAY_PACKED_REALS //Must be multiple of ARRAY_PACKED_REALS
+
+        ///r = (a * b) + c
+        #define _mm256_madd_ps( a, b, c )   _mm256_fmadd_ps( a, b, c )
+        ///r = -(a * b) + c
+        #define _mm256_nmsub_ps( a, b, c )  _mm256_fnmadd_ps( a, b, c )
+
+        //Scalar (AoS) helpers like SimpleMatrixAf4x3 still work on 128-bit registers
+        ///r = (a * b) + c
+        #define _mm_madd_ps( a, b, c )      _mm_fmadd_ps( a, b, c )
+        ///r = -(a * b) + c
+        #define _mm_nmsub_ps( a, b, c )     _mm_fnmadd_ps( a, b, c )
+
+        /// Builds a 256-bit register out of two 128-bit ones. lo goes to [0; 4), hi to [4; 8)
+        #define _mm256_combine_ps( lo, hi ) _mm256_insertf128_ps( _mm256_castps128_ps256( lo ), hi, 1 )
+
+        /// Does not convert, just cast ArrayReal to ArrayInt
+        #define CastRealToInt( x )          _mm256_castps_si256( x )
+        #define CastIntToReal( x )          _mm256_castsi256_ps( x )
+        /// Input must be 32-byte aligned
+        #define CastArrayToReal( outFloatPtr, arraySimd )       _mm256_store_ps( outFloatPtr, arraySimd )
+
+    #elif OGRE_CPU == OGRE_CPU_X86
         //x86/x64 - SSE2
         #if OGRE_DOUBLE_PRECISION == 1
             #include <emmintrin.h>
@@ -0,0 +1,135 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef _OgreArrayKernels_H_
+#define _OgreArrayKernels_H_
+
+#include "OgreMovableObject.h"
+#include "Math/Array/OgreTransform.h"
+#include "Math/Array/OgreKfTransform.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Math
+    *  @{
+    */
+    /** Table of the SoA loops that dominate the frame (transform & bound updates,
+        culling, keyframe blending).
+    @remarks
+        The memory layout (ARRAY_PACKED_REALS) is a compile time setting shared by all
+        memory managers, but the code that processes it doesn't have to be. The same
+        loops are built once per instruction set the compiler can emit, and the best
+        one the running CPU supports is picked at startup. That way a binary built
+        for the lowest common denominator (i.e. SSE2) still runs VEX encoded + FMA
+        code on machines that have AVX2.
+    @par
+        Each entry has exactly the same semantics as the function that forwards to it:
+        Node::updateAllTransforms, MovableObject::updateAllBounds,
+        MovableObject::cullFrustum, MovableObject::cullLights and
+        SkeletonTrack::applyKeyFrameRigAt.
+    @note
+        This class is supposed to be used by the engine internally only.
+    */
+    class _OgreExport ArrayKernels
+    {
+    public:
+        typedef void (*UpdateAllTransformsFunc)( const size_t numNodes, Transform t );
+        typedef void (*UpdateAllBoundsFunc)( const size_t numNodes, ObjectData objData );
+        typedef void (*CullFrustumFunc)( const size_t numNodes, ObjectData objData,
+                                         const Frustum *frustum, uint32 sceneVisibilityFlags,
+                                         MovableObject::MovableObjectArray &outCulledObjects,
+                                         const Camera *lodCamera );
+        typedef void (*CullLightsFunc)( const size_t numNodes, ObjectData objData,
+                                        LightListInfo &outGlobalLightList,
+                                        const FrustumVec &frustums,
+                                        const FrustumVec &cubemapFrustums );
+        /// Interpolates between two keyframes and blends the result into the
+        /// bone transforms. scalarW is in range [0; 1]
+        typedef void (*BlendKeyFrameRigFunc)( const KfTransform * RESTRICT_ALIAS prevTransf,
+                                              const KfTransform * RESTRICT_ALIAS nextTransf,
+                                              Real scalarW, ArrayReal animWeight,
+                                              const ArrayReal * RESTRICT_ALIAS perBoneWeights,
+                                              ArrayVector3 * RESTRICT_ALIAS finalPos,
+                                              ArrayVector3 * RESTRICT_ALIAS finalScale,
+                                              ArrayQuaternion * RESTRICT_ALIAS finalRot );
+        /// Same as BlendKeyFrameRigFunc, but the keyframes are quantized. Each of their
+        /// components is dequantized as minimum + step * value. @see SkeletonTrack::_compress
+        typedef void (*BlendCompressedKeyFrameRigFunc)( const uint16 * RESTRICT_ALIAS prevTransf,
+                                                        const uint16 * RESTRICT_ALIAS nextTransf,
+                                                        const Real * RESTRICT_ALIAS minimums,
+                                                        const Real * RESTRICT_ALIAS steps,
+                                                        Real scalarW, ArrayReal animWeight,
+                                                        const ArrayReal * RESTRICT_ALIAS perBoneWeights,
+                                                        ArrayVector3 * RESTRICT_ALIAS finalPos,
+                                                        ArrayVector3 * RESTRICT_ALIAS finalScale,
+                                                        ArrayQuaternion * RESTRICT_ALIAS finalRot );
+        /// Blends numBlocks blocks of a pose into the bone transforms:
+        /// final = lerp( final, src, weight * perBoneWeights ). Bones whose
+        /// weight is 0 are left untouched. @see SkeletonAnimationLayer
+        typedef void (*BlendPoseFunc)( const ArrayVector3 * RESTRICT_ALIAS srcPos,
+                                       const ArrayVector3 * RESTRICT_ALIAS srcScale,
+                                       const ArrayQuaternion * RESTRICT_ALIAS srcRot,
+                                       ArrayReal weight,
+                                       const ArrayReal * RESTRICT_ALIAS perBoneWeights,
+                                       size_t numBlocks,
+                                       ArrayVector3 * RESTRICT_ALIAS finalPos,
+                                       ArrayVector3 * RESTRICT_ALIAS finalScale,
+                                       ArrayQuaternion * RESTRICT_ALIAS finalRot );
+
+        /// Human readable name of the instruction set these kernels were built for
+        const char              *name;
+        UpdateAllTransformsFunc updateAllTransforms;
+        UpdateAllBoundsFunc     updateAllBounds;
+        CullFrustumFunc         cullFrustum;
+        CullLightsFunc          cullLights;
+        BlendKeyFrameRigFunc    blendKeyFrameRig;
+        BlendCompressedKeyFrameRigFunc blendCompressedKeyFrameRig;
+        BlendPoseFunc           blendPose;
+
+    protected:
+        /// Store a pointer to the implementation
+        static const ArrayKernels *msImplementation;
+
+        /// Detect best implementation based on run-time environment
+        static const ArrayKernels* _detectImplementation(void);
+
+    public:
+        /** Gets the implementation best suited for this CPU.
+        @note
+            Don't cache the pointer returned by this function, it'll change due
+            run-time environment detection to pick up the best implementation.
+        */
+        static const ArrayKernels* getImplementation(void) { return msImplementation; }
+    };
+    /** @} */
+    /** @} */
+}
+
+#endif
@@ -31,7 +31,9 @@ THE SOFTWARE.
 //This file is a proxy, it redirects to the proper file depending on platform
 #include "OgreArrayConfig.h"
 
-#if OGRE_CPU == OGRE_CPU_X86 && OGRE_USE_SIMD == 1
+#if OGRE_CPU == OGRE_CPU_X86 && OGRE_USE_SIMD == 1 && __OGRE_HAVE_AVX2
+    #include "AVX2/Single/OgreArrayMatrixAf4x3.h"
+#elif OGRE_CPU == OGRE_CPU_X86 && OGRE_USE_SIMD == 1
     #if OGRE_DOUBLE_PRECISION == 1
         #include "SSE2/Double/OgreArrayMatrixAf4x3.h"
     #else
@@ -165,6 +165,31 @@ namespace Ogre
                                          const MemoryPoolVec &basePtrs,
                                          size_t const *elementsMemSizes, size_t startInstance,
                                          size_t diffInstances ) = 0;
+
+            /** Called when a single slot was moved to a hole closer to the beginning of the
+                pool (see ArrayMemoryManager::defragment). The slot at dstInstance now
+                contains the data that belonged to the last slot, and its owner must be
+                updated to point to it.
+                @remarks
+                    The default implementation calls performCleanup from dstInstance onwards
+                    (which works, but updates more objects than necessary). Override it for
+                    a constant time update.
+                @param managerType
+                    The derived type of this manager, so listener knows whether this is an Node or
+                    ObjectData manager
+                @param level
+                    The hierarchy depth level
+                @param basePtrs
+                    The base ptrs.
+                @param dstInstance
+                    The slot the data was moved to.
+            */
+            virtual void slotMoved( ManagerType managerType, uint16 level,
+                                    const MemoryPoolVec &basePtrs, size_t const *elementsMemSizes,
+                                    size_t dstInstance )
+            {
+                performCleanup( managerType, level, basePtrs, elementsMemSizes, dstInstance, 0 );
+            }
         };
 
     protected:
@@ -179,6 +204,8 @@ namespace Ogre
         size_t              mMaxMemory;
         size_t              mMaxHardLimit;
         size_t              mCleanupThreshold;
+        /// When true, cleanups are never triggered from destroySlot. @See defragment
+        bool                mIncrementalCleanup;
         typedef std::vector<size_t> SlotsVec; //TODO: Modify for Ogre
         SlotsVec            mAvailableSlots;
         RebaseListener      *mRebaseListener;
@@ -255,6 +282,33 @@ namespace Ogre
         size_t getWastedMemory() const;
         /// Gets all memory reserved for this manager
         size_t getAllMemory() const;
+        /// Gets the number of slots the memory pools can hold (used or not) before growing
+        size_t getNumSlots() const                          { return mMaxMemory; }
+
+        /** When enabled, removing slots in a non-LIFO fashion never triggers a cleanup
+            (regardless of the cleanup threshold). Instead the owner is expected to call
+            @see defragment regularly (i.e. once per frame), spreading the cost over time.
+        @remarks
+            The cleanup routine shifts every slot after the first hole in one go, which
+            can take milliseconds with lots of objects. Useful when objects are
+            constantly being created and destroyed.
+        */
+        void setIncrementalCleanup( bool bIncremental )     { mIncrementalCleanup = bIncremental; }
+        bool getIncrementalCleanup(void) const              { return mIncrementalCleanup; }
+
+        /** Fills the holes left by non-LIFO removals by moving the last slots into them
+            (swap-with-last) until there are no holes left or maxMoves slots were moved.
+            Holes at the end of the pool are released for free and don't count.
+        @remarks
+            Unlike the regular cleanup, this doesn't preserve the order of the slots.
+            The RebaseListener is notified through RebaseListener::slotMoved for each
+            moved slot.
+        @param maxMoves
+            Maximum number of slots to move in this call.
+        @return
+            Number of slots that were moved.
+        */
+        size_t defragment( size_t maxMoves );
 
     protected:
         /** Requests memory for a new slot (could be used for SceneNode, Entities, etc.)
@@ -283,6 +337,12 @@ namespace Ogre
             The previous value of mMaxMemory before changing mMemoryPools
         */
         virtual void slotsRecreated( size_t prevNumSlots ) {}
+
+        /** Called by defragment after the data in the given slot was moved elsewhere and it
+            has been default initialized; to give the derived class a chance to restore
+            its own defaults (i.e. dummy pointers) for that slot.
+        */
+        virtual void slotVacated( size_t slot ) {}
     };
 
 
@@ -302,6 +362,8 @@ namespace Ogre
     protected:
         /// We overload to set all mParents to point to mDummyNode
         virtual void slotsRecreated( size_t prevNumSlots );
+        /// @copydoc ArrayMemoryManager::slotVacated
+        virtual void slotVacated( size_t slot );
 
     public:
         enum MemoryTypes
@@ -375,6 +437,8 @@ namespace Ogre
     protected:
         /// We overload to set all mParents to point to mDummyNode
         virtual void slotsRecreated( size_t prevNumSlots );
+        /// @copydoc ArrayMemoryManager::slotVacated
+        virtual void slotVacated( size_t slot );
 
     public:
         enum MemoryTypes
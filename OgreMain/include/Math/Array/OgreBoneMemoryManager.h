@@ -159,6 +159,9 @@ namespace Ogre
         */
         size_t getFirstNode( BoneTransform &outTransform, size_t depth );
 
+        /// Number of slots allocated for the given depth level. @see ArrayMemoryManager::getNumSlots
+        size_t getNumSlots( size_t depth ) const        { return mMemoryManagers[depth].getNumSlots(); }
+
         void setBoneRebaseListener( BySkeletonDef *l )          { mBoneRebaseListener = l; }
 
         //Derived from ArrayMemoryManager::RebaseListener
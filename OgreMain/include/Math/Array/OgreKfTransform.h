@@ -40,6 +40,10 @@ namespace Ogre
         ArrayQuaternion mOrientation;
         ArrayVector3    mScale;
     };
+
+    /// Number of Reals in a KfTransform: 3 (position) + 4 (orientation) + 3 (scale)
+    /// per SIMD slot. Compressed keyframes have one uint16 for each of them.
+    #define OGRE_KF_TRANSFORM_NUM_REALS (10 * ARRAY_PACKED_REALS)
 }
 
 #endif
@@ -68,6 +68,9 @@ namespace Ogre
         SceneMemoryMgrTypes                     mMemoryManagerType;
         NodeMemoryManager                       *mTwinMemoryManager;
 
+        /// @See setIncrementalCleanup
+        bool                                    mIncrementalCleanup;
+
         /** Makes mMemoryManagers big enough to be able to fulfill mMemoryManagers[newDepth]
         @param newDepth
             Hierarchy level depth we wish to grow to.
@@ -168,6 +171,17 @@ namespace Ogre
         */
         size_t getFirstNode( Transform &outTransform, size_t depth );
 
+        /// Enables incremental cleanups in all depth levels. @See ArrayMemoryManager::setIncrementalCleanup
+        void setIncrementalCleanup( bool bIncremental );
+        bool getIncrementalCleanup(void) const                      { return mIncrementalCleanup; }
+
+        /** Moves at most maxMoves slots to fill the holes left by removals, across all depth levels.
+            @See ArrayMemoryManager::defragment
+        @return
+            Number of slots that were moved.
+        */
+        size_t defragment( size_t maxMoves );
+
         //Derived from ArrayMemoryManager::RebaseListener
         virtual void buildDiffList( ArrayMemoryManager::ManagerType managerType, uint16 level,
                                     const MemoryPoolVec &basePtrs,
@@ -178,6 +192,9 @@ namespace Ogre
         virtual void performCleanup( ArrayMemoryManager::ManagerType managerType, uint16 level,
                                      const MemoryPoolVec &basePtrs, size_t const *elementsMemSizes,
                                      size_t startInstance, size_t diffInstances );
+        virtual void slotMoved( ArrayMemoryManager::ManagerType managerType, uint16 level,
+                                const MemoryPoolVec &basePtrs, size_t const *elementsMemSizes,
+                                size_t dstInstance );
     };
 
     /** @} */
@@ -0,0 +1,154 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __ObjectDataBvh_H__
+#define __ObjectDataBvh_H__
+
+#include "OgrePrerequisites.h"
+#include "Math/Simple/OgreAabb.h"
+
+namespace Ogre
+{
+    class ObjectMemoryManager;
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Memory
+    *  @{
+    */
+
+    /** Bounding volume hierarchy built on top of the world AABBs stored in an
+        ObjectMemoryManager, one tree per render queue.
+    @remarks
+        The leaves of the tree are SoA packs (ARRAY_PACKED_REALS objects each), not individual
+        objects. The tree never moves any object in memory; instead culling it outputs the
+        ranges of packs that may be visible so that the regular SoA frustum test
+        (MovableObject::cullFrustum) only runs on them.
+        @par
+        Building the tree is not cheap, and it is only conservative while the world AABBs
+        don't change. Therefore it's only meant for SCENE_STATIC memory managers, and must be
+        rebuilt every time the static objects are flagged as dirty (see
+        SceneManager::notifyStaticAabbDirty), or objects are added or removed.
+        @par
+        Only the spatial test is performed. Visibility flags and rendering distances can
+        change without the static objects being flagged as dirty, so they are left to the
+        SoA test.
+    */
+    class _OgreExport ObjectDataBvh
+    {
+    public:
+        /// Range of consecutive packs, in units of packs (not objects)
+        struct PackRange
+        {
+            size_t  firstPack;
+            size_t  numPacks;
+
+            PackRange( size_t _firstPack, size_t _numPacks ) :
+                firstPack( _firstPack ), numPacks( _numPacks ) {}
+        };
+
+        typedef vector<PackRange>::type PackRangeVec;
+
+    protected:
+        struct BvhNode
+        {
+            Aabb    aabb;
+            /// Range in mPackIndices this node (and all its children) cover
+            uint32  firstIndex;
+            uint32  numIndices;
+            /// Index to the right child in mNodes. The left child is always the next node.
+            /// 0 if this node is a leaf.
+            uint32  rightChild;
+        };
+
+        typedef vector<BvhNode>::type BvhNodeVec;
+
+        struct RenderQueueTree
+        {
+            BvhNodeVec          nodes;
+            /// Packs sorted by BVH location. Each node covers a contiguous range of it.
+            vector<uint32>::type packIndices;
+            /// Number of objects (incl. empty slots) when this tree was built,
+            /// used to detect stale trees.
+            size_t              numObjs;
+
+            RenderQueueTree() : numObjs( 0 ) {}
+        };
+
+        typedef vector<RenderQueueTree>::type RenderQueueTreeVec;
+
+        RenderQueueTreeVec  mRenderQueues;
+        bool                mBuilt;
+
+        /// Temporary buffers reused between builds & culls to avoid allocations
+        vector<Aabb>::type      mTmpPackAabbs;
+        vector<uint32>::type    mTmpVisiblePacks;
+
+        /// Recursively builds the tree out of mTmpPackAabbs for the given range of packIndices.
+        /// Returns the index of the created node.
+        static uint32 buildNode( RenderQueueTree &tree, const vector<Aabb>::type &packAabbs,
+                                 uint32 firstIndex, uint32 numIndices );
+
+    public:
+        /// Maximum number of packs in a leaf
+        static const uint32 MAX_PACKS_PER_LEAF;
+
+        ObjectDataBvh();
+
+        /// Discards the trees. isUpToDate will return false until build is called again.
+        void clear(void);
+
+        /** Rebuilds the trees from the current world AABBs of the given memory manager.
+        @remarks
+            The world AABBs must be up to date (i.e. call this after updateAllBounds)
+        */
+        void build( ObjectMemoryManager &memoryManager );
+
+        /** Returns false if objects were created, destroyed or moved since the last build
+            in a way that invalidates the trees; in which case they must not be used for culling.
+        */
+        bool isUpToDate( ObjectMemoryManager &memoryManager ) const;
+
+        /** Traverses the tree of the given render queue and appends to outRanges the
+            packs that may be inside the frustum. Ranges are sorted and merged together
+            when they are consecutive.
+        @param renderQueue
+            Render queue whose tree to traverse.
+        @param frustumPlanes
+            The 6 planes of the frustum, as returned by Frustum::_getCachedFrustumPlanes
+        @param outRanges
+            [out] Ranges of packs that need to be tested by the SoA code. Not cleared.
+        */
+        void cullFrustum( size_t renderQueue, const Plane *frustumPlanes, PackRangeVec &outRanges );
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#endif
@@ -635,10 +635,14 @@ namespace Ogre
         virtual void apply(const TimeIndex& timeIndex, Real weight = 1.0, Real scale = 1.0f);
 
         /** As the 'apply' method but applies to specified VertexData instead of 
-            associated data. */
+            associated data.
+        @param sceneManager
+            Optional. When not null, software morphs of big buffers are split
+            across its worker threads. @see Mesh::softwareVertexMorph
+        */
         virtual void applyToVertexData(VertexData* data, 
             const TimeIndex& timeIndex, Real weight = 1.0, 
-            const PoseList* poseList = 0);
+            const PoseList* poseList = 0, SceneManager *sceneManager = 0);
 
 
         /** Returns the morph KeyFrame at the specified index. */
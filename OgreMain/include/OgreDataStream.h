@@ -475,6 +475,38 @@ namespace Ogre {
         void setFreeOnClose(bool free) { mFreeOnClose = free; }
     };
 
+    /** MemoryDataStream whose memory is a read-only view of a whole file, mapped
+        into the address space by the OS instead of being read & copied.
+    @remarks
+        Pages are only loaded when touched, and getPtr / getCurrentPtr can be used to
+        access the contents in place (i.e. to upload vertex data straight to a
+        HardwareBuffer, @see MeshSerializerImpl).
+        @par
+        On platforms without file mapping support the file is read into memory
+        at once, so the stream behaves like a regular MemoryDataStream.
+    */
+    class _OgreExport MappedFileDataStream : public MemoryDataStream
+    {
+    protected:
+        /// True if mData points to a mapped view rather than to memory we allocated
+        bool mMapped;
+
+    public:
+        /** Maps the given file.
+        @param name The name to give the stream
+        @param fullPath Path to the file to map
+        */
+        MappedFileDataStream( const String& name, const String& fullPath );
+        ~MappedFileDataStream();
+
+        /// Whether the file is really mapped (false if it had to be read into memory)
+        bool isMapped(void) const               { return mMapped; }
+
+        /** @copydoc DataStream::close
+        */
+        void close(void);
+    };
+
     /** Common subclass of DataStream for handling data from 
         std::basic_istream.
     */
@@ -120,7 +120,21 @@ namespace Ogre {
             return msIgnoreHidden;
         }
 
+        /// Set whether files opened read-only are memory mapped (@see MappedFileDataStream)
+        /// instead of being read through a std::ifstream. The default is false.
+        static void setMemoryMapFiles(bool memoryMap)
+        {
+            msMemoryMapFiles = memoryMap;
+        }
+
+        /// Get whether files opened read-only are memory mapped.
+        static bool getMemoryMapFiles()
+        {
+            return msMemoryMapFiles;
+        }
+
         static bool msIgnoreHidden;
+        static bool msMemoryMapFiles;
     };
 
     /** Specialisation of ArchiveFactory for FileSystem files. */
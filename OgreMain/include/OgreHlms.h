@@ -30,6 +30,8 @@ THE SOFTWARE.
 
 #include "OgreStringVector.h"
 #include "OgreHlmsCommon.h"
+#include "OgreWorkQueue.h"
+#include "Threading/OgreUniformScalableTask.h"
 #include "OgreHeaderPrefix.h"
 
 namespace Ogre
@@ -43,7 +45,8 @@ namespace Ogre
     *  @{
     */
     /** HLMS stands for "High Level Material System". */
-    class _OgreExport Hlms : public PassAlloc
+    class _OgreExport Hlms : public PassAlloc, public WorkQueue::RequestHandler,
+                             public WorkQueue::ResponseHandler
     {
         enum ShaderType
         {
@@ -55,6 +58,22 @@ namespace Ogre
             NumShaderTypes
         };
 
+    public:
+        /// A renderable and the parameters of its material. @See calculateHashForBatch
+        struct RenderableParams
+        {
+            Renderable          *renderable;
+            HlmsParamVec const  *params;
+
+            RenderableParams( Renderable *_renderable, const HlmsParamVec *_params ) :
+                renderable( _renderable ), params( _params ) {}
+        };
+
+        typedef vector<RenderableParams>::type RenderableParamsVec;
+
+        /// Below this number of renderables calculateHashForBatch runs in the caller's thread
+        static const size_t PARALLEL_HASH_THRESHOLD;
+
     protected:
         HlmsCacheVec    mRenderableCache;
         HlmsCacheVec    mShaderCache;
@@ -65,6 +84,48 @@ namespace Ogre
 
         Archive         *mDataFolder;
         StringVector     mPieceFiles[5];
+        /// Contents of each file in mPieceFiles, loaded once. @See loadTemplateFiles
+        StringVector     mPieceFileContents[5];
+        /// Contents of the main template of each shader stage. Empty if there is none.
+        String          mTemplateContents[5];
+        /// Hash of the contents of all template files. @See loadTemplateFiles
+        uint32          mTemplateHash;
+
+        /// Reused by generateShaderSources so the preprocessor doesn't allocate every permutation
+        String          mPreprocessorBuffers[2];
+
+        /// Sent to the WorkQueue to generate the shaders of a permutation in the background
+        struct GenerateShaderRequest
+        {
+            Hlms            *hlms;
+            uint32          finalHash;
+            HlmsPropertyVec setProperties;
+            friend std::ostream& operator<<( std::ostream &o, const GenerateShaderRequest &r )
+            { return o; }
+        };
+
+        struct GenerateShaderResponse
+        {
+            String  sources[NumShaderTypes];
+            friend std::ostream& operator<<( std::ostream &o, const GenerateShaderResponse &r )
+            { return o; }
+        };
+
+        /// @See setAsyncShaderGeneration
+        bool            mAsyncShaderGeneration;
+        uint16          mWorkQueueChannel;
+        /// Runs the preprocessor in the background threads,
+        /// so they don't touch the state of this Hlms.
+        Hlms            *mBackgroundGenerator;
+        OGRE_MUTEX( mBackgroundGeneratorMutex );
+        typedef map<uint32, WorkQueue::RequestID>::type PendingShaderMap;
+        /// Final hashes of the permutations that have been queued but aren't ready yet,
+        /// with their request so they can be aborted if we stop listening.
+        PendingShaderMap mPendingShaders;
+
+        /// @See setFallbackCache
+        HlmsCache       mFallbackCache;
+        bool            mUseFallbackCache;
         //HlmsManager     *mHlmsManager;
 
         /** Inserts common properties about the current Renderable,
@@ -82,29 +143,46 @@ namespace Ogre
         */
         void enumeratePieceFiles(void);
 
+        /** Reads all the piece files and shader templates into memory, so that generating
+            a permutation doesn't touch mDataFolder. Their names and contents are hashed
+            into mTemplateHash.
+        */
+        void loadTemplateFiles(void);
+
         void setProperty( IdString key, int32 value );
         int32 getProperty( IdString key, int32 defaultVal=0 ) const;
 
-        enum ExpressionType
-        {
-            EXPR_OPERATOR_OR,        //||
-            EXPR_OPERATOR_AND,       //&&
-            EXPR_OBJECT,             //(...)
-            EXPR_VAR
-        };
+        /// Versions of setProperty & getProperty that work on any (sorted) property vector
+        static void setProperty( HlmsPropertyVec &properties, IdString key, int32 value );
+        static int32 getProperty( const HlmsPropertyVec &properties, IdString key,
+                                  int32 defaultVal=0 );
 
-        struct Expression
+        /** State of a parenthesis level while evaluating an @property expression. The
+            operands are folded from left to right as they are found, i.e. there is no
+            operator precedence.
+        */
+        struct ExpressionLevel
         {
-            bool                    result;
-            bool                    negated;
-            ExpressionType          type;
-            std::vector<Expression> children;
-            String                  value;
-
-            Expression() : result( false ), negated( false ), type( EXPR_VAR ) {}
+            /// Result of the operands folded so far
+            bool    result;
+            /// Whether the next operand is and'ed (true) or or'ed (false)
+            bool    andMode;
+            bool    lastWasOperator;
+            /// Whether the level was opened with "!("
+            bool    negated;
+            bool    hasChildren;
+
+            ExpressionLevel( bool _negated ) :
+                result( true ), andMode( true ), lastWasOperator( true ),
+                negated( _negated ), hasChildren( false ) {}
         };
 
-        typedef std::vector<Expression> ExpressionVec;
+        typedef vector<ExpressionLevel>::type ExpressionLevelVec;
+
+        /// Scratch memory of the preprocessor, kept around to avoid allocations
+        mutable ExpressionLevelVec  mExpressionLevels;
+        mutable String              mExpressionToken;
+        mutable StringVector        mArgValues;
 
         static void copy( String &outBuffer, const SubStringRef &inSubString, size_t length );
         static void repeat( String &outBuffer, const SubStringRef &inSubString, size_t length,
@@ -128,26 +206,84 @@ namespace Ogre
         static void findBlockEnd( SubStringRef &outSubString , bool &syntaxError );
 
         bool evaluateExpression( SubStringRef &outSubString, bool &outSyntaxError ) const;
-        bool evaluateExpressionRecursive( ExpressionVec &expression, bool &outSyntaxError ) const;
+        /// Adds the operand in mExpressionToken, or the level that was just closed,
+        /// to the given level.
+        void addExpressionOperand( ExpressionLevel &level, bool negated, bool value,
+                                   bool &outSyntaxError ) const;
+        void addExpressionToken( ExpressionLevel &level, bool negated, bool &outSyntaxError ) const;
         static size_t evaluateExpressionEnd( const SubStringRef &outSubString );
 
-        static void evaluateParamArgs( SubStringRef &outSubString, StringVector &outArgs,
-                                       bool &outSyntaxError );
+        /** Parses the comma separated arguments of a directive, e.g. @foreach( a, b ).
+        @param outArgs
+            The arguments are written to the first entries of this vector. It may be bigger
+            than the number of arguments, since its strings are reused across calls.
+        @return
+            The number of arguments.
+        */
+        static size_t evaluateParamArgs( SubStringRef &outSubString, StringVector &outArgs,
+                                         bool &outSyntaxError );
 
         static size_t calculateLineCount(const String &buffer, size_t idx );
         static size_t calculateLineCount( const SubStringRef &subString );
 
         void addRenderableCache( uint32 hash, const HlmsPropertyVec &renderableSetProperties );
+        /// Inserts the entry into the cache (sorted by hash) unless the hash is already there.
+        static void addCacheEntry( HlmsCacheVec &cache, uint32 hash,
+                                   const HlmsPropertyVec &setProperties );
         const HlmsCache* getRenderableCache( uint32 hash ) const;
-        const HlmsCache* addShaderCache( uint32 hash, GpuProgramPtr &vertexShader,
+        const HlmsCache* addShaderCache( uint32 hash, const HlmsPropertyVec &setProperties,
+                                         GpuProgramPtr &vertexShader,
                                          GpuProgramPtr &geometryShader,
                                          GpuProgramPtr &tesselationHullShader,
                                          GpuProgramPtr &tesselationDomainShader,
                                          GpuProgramPtr &pixelShader );
         const HlmsCache* getShaderCache( uint32 hash ) const;
+
+        /// Sets mSetProperties to the properties of the renderable cache merged with those of the pass.
+        void mergeProperties( uint32 renderableHash, const HlmsCache &passCache );
+
         const HlmsCache* createShaderCacheEntry( uint32 renderableHash, const HlmsCache &passCache,
                                                  uint32 finalHash );
 
+        /** Queues the permutation to be generated in the WorkQueue's threads (unless it has
+            already been queued).
+        @return
+            The fallback cache. Null if there is none. @See setFallbackCache
+        */
+        const HlmsCache* queueShaderCacheEntry( uint32 renderableHash, const HlmsCache &passCache,
+                                                uint32 finalHash );
+
+        /** Runs the templates through the preprocessor using the properties in mSetProperties.
+        @param outSources
+            Generated source of each shader stage. Left empty for the stages that
+            don't have a template.
+        */
+        void generateShaderSources( String outSources[NumShaderTypes] );
+
+        /** Creates the GPU programs from the given sources and adds them to the shader cache.
+            The properties in mSetProperties are stored with the entry.
+        */
+        const HlmsCache* createShaderCacheEntry( uint32 finalHash,
+                                                 const String sources[NumShaderTypes] );
+
+        /// An entry of a shader cache file, @see loadShaderCache
+        struct CachedShader
+        {
+            uint32          hash;
+            HlmsPropertyVec setProperties;
+            String          sources[NumShaderTypes];
+        };
+
+        typedef vector<CachedShader>::type CachedShaderVec;
+
+        /** Reads the entries of a shader cache file, after its header.
+        @return
+            False if the stream ends early or a count or length stored in it doesn't
+            fit in the remaining bytes.
+        */
+        static bool readShaderCacheEntries( DataStreamPtr &stream, uint32 numEntries,
+                                            uint32 debugStrSize, CachedShaderVec &outEntries );
+
         /** Finds the parameter with key 'key' in the given 'paramVec'. If found, outputs
             the value to 'inOut', otherwise leaves 'inOut' as is.
         @return
@@ -157,8 +293,59 @@ namespace Ogre
         */
         static bool findParamInVec( const HlmsParamVec &paramVec, IdString key, String &inOut );
 
+        /** Clears outProperties and fills it with the properties of the given renderable.
+            Doesn't modify the Hlms, so it can be called from any thread.
+        @See calculateHashFor
+        */
+        virtual void fillRenderableProperties( Renderable *renderable, const HlmsParamVec &params,
+                                               HlmsPropertyVec &outProperties ) const;
+
+        /// Turns the properties filled by fillRenderableProperties into the ones of the
+        /// shadow caster pass.
+        virtual void toCasterProperties( HlmsPropertyVec &inOutProperties ) const;
+
         /// @See calculateHashFor
-        virtual uint32 calculateRenderableHash(void) const;
+        virtual uint32 calculateRenderableHash( const HlmsPropertyVec &properties ) const;
+
+        /** Fills the properties of the renderable and of its shadow caster pass, and
+            calculates the hashes of both. Used by both calculateHashFor and (from the
+            worker threads) calculateHashForBatch, so it must not modify the Hlms.
+        @remarks
+            This is the hook to override to customise the hashes. The default calls
+            fillRenderableProperties, toCasterProperties & calculateRenderableHash.
+        */
+        virtual void calculateHashes( Renderable *renderable, const HlmsParamVec &params,
+                                      HlmsPropertyVec &outProperties,
+                                      HlmsPropertyVec &outCasterProperties,
+                                      uint32 &outHash, uint32 &outCasterHash ) const;
+
+        /// Calculates the hashes of a range of renderables for @calculateHashForBatch.
+        class HashBatchTask : public UniformScalableTask
+        {
+            struct ThreadData
+            {
+                HlmsPropertyVec properties;
+                HlmsPropertyVec casterProperties;
+                /// Entries that weren't in the renderable cache, sorted by hash
+                HlmsCacheVec    newEntries;
+            };
+
+            typedef vector<ThreadData>::type ThreadDataVec;
+
+            Hlms const                  *mHlms;
+            RenderableParamsVec const   &mRenderables;
+            ThreadDataVec               mThreadData;
+
+        public:
+            HashBatchTask( const Hlms *hlms, const RenderableParamsVec &renderables,
+                           size_t numThreads );
+
+            /// Adds the new entries from all threads to the renderable cache of 'hlms'.
+            void mergeNewEntries( Hlms *hlms ) const;
+
+            /// @copydoc UniformScalableTask::execute
+            virtual void execute( size_t threadId, size_t numThreads );
+        };
 
     public:
         Hlms( Archive *dataFolder );
@@ -172,9 +359,31 @@ namespace Ogre
             The MovableObject the material will be used on (usually the parent of renderable)
         @return
             A hash. This hash references property parameters that are already cached.
+        @remarks
+            Not virtual, so it always gives the same results as calculateHashForBatch.
+            Derived classes customise the hashes through calculateHashes.
+        */
+        void calculateHashFor( Renderable *renderable, const HlmsParamVec &params,
+                               uint32 &outHash, uint32 &outCasterHash );
+
+        /** Same as calling renderable->setHlms( this, params ) for every entry, but the
+            hashes are calculated by the SceneManager's worker threads. Meant for load time,
+            when materials are assigned to many renderables at once.
+        @remarks
+            The renderable cache is only read by the worker threads. Each thread keeps the
+            entries it didn't find there in its own list, and these lists are merged into
+            the cache in the caller's thread at the end, so no locking is needed.
+            @par
+            Renderable::getRenderOperation is called from the worker threads.
+        @param renderables
+            Renderables and the parameters of their materials. The hashes are written to
+            the renderables.
+        @param sceneManager
+            SceneManager whose worker threads will be used. Can be null, in which case
+            everything runs in the caller's thread. Must not be called from a worker thread.
         */
-        virtual void calculateHashFor( Renderable *renderable, const HlmsParamVec &params,
-                                       uint32 &outHash, uint32 &outCasterHash );
+        void calculateHashForBatch( const RenderableParamsVec &renderables,
+                                    SceneManager *sceneManager );
 
         /** Called every frame by the Render Queue to cache the properties needed by this
             pass. i.e. Number of PSSM splits, number of shadow casting lights, etc
@@ -204,11 +413,83 @@ namespace Ogre
         @param casterPass
             True if this pass is the shadow mapping caster pass, false otherwise
         @return
-            Structure containing all necessary shaders
+            Structure containing all necessary shaders.
+            When generating shaders in the background (@see setAsyncShaderGeneration) and
+            the shaders aren't ready yet, the fallback cache is returned instead, or null if
+            there isn't one; in which case the renderable should be skipped.
         */
         const HlmsCache* getMaterial( const HlmsCache &passCache, Renderable *renderable,
                                       MovableObject *movableObject, bool casterPass );
 
+        /** Writes every shader generated so far (its final hash, the properties it was
+            generated with, and the source of each stage) so they can be restored with
+            @loadShaderCache on the next run instead of being generated while rendering.
+        @remarks
+            Compiled binaries are not part of this cache. Programs created by the Hlms get a
+            name derived from their hash which stays the same across runs, so if the
+            RenderSystem supports it they can be kept with GpuProgramManager's microcode
+            cache (@see GpuProgramManager::setSaveMicrocodesToCache).
+        @param stream
+            Writeable stream.
+        */
+        void saveShaderCache( DataStreamPtr &stream ) const;
+
+        /** Loads a cache written by @saveShaderCache and creates its GPU programs.
+            Entries whose hash is already in the shader cache are skipped.
+        @param stream
+            Stream to read from.
+        @param regenerateOutdated
+            When the templates changed since the cache was saved, the stored sources are
+            stale. If true, the sources are generated again from the stored properties
+            (which is slow; it's meant for offline tools that rebuild the cache). If false,
+            the whole cache is discarded.
+        @remarks
+            A truncated or corrupted cache is discarded as a whole (nothing is added), and
+            the shaders are generated as usual when they're needed.
+        @return
+            Number of entries added to the shader cache.
+        */
+        size_t loadShaderCache( DataStreamPtr &stream, bool regenerateOutdated );
+
+        /// Discards all entries from the shader cache (but not from the renderable cache)
+        void clearShaderCache(void);
+
+        /// Hash identifying the current contents of the template files
+        uint32 getTemplateHash(void) const                  { return mTemplateHash; }
+
+        /** When enabled, permutations that aren't in the shader cache are generated in the
+            background by the WorkQueue (@see Root::getWorkQueue) instead of stalling
+            @getMaterial. Meanwhile getMaterial returns the fallback cache.
+        @remarks
+            Only the preprocessing of the templates runs in the background, which is the
+            expensive part. The GPU programs are created in the main thread once the WorkQueue
+            processes the responses (i.e. at the beginning of the next frame), since
+            RenderSystems can't create them from another thread.
+        */
+        void setAsyncShaderGeneration( bool async );
+        bool getAsyncShaderGeneration(void) const           { return mAsyncShaderGeneration; }
+
+        /** Sets the shaders to use while the real ones are being generated in the background.
+        @param fallback
+            Cache to copy the shaders from (usually one returned by getMaterial for a simple
+            renderable). Null to return null from getMaterial, so that those renderables
+            don't get drawn.
+        */
+        void setFallbackCache( const HlmsCache *fallback );
+
+        /// Number of permutations being generated in the background
+        size_t getNumPendingShaders(void) const             { return mPendingShaders.size(); }
+
+        /// WorkQueue::RequestHandler override
+        virtual bool canHandleRequest( const WorkQueue::Request *req, const WorkQueue *srcQ );
+        /// WorkQueue::RequestHandler override
+        virtual WorkQueue::Response* handleRequest( const WorkQueue::Request *req,
+                                                    const WorkQueue *srcQ );
+        /// WorkQueue::ResponseHandler override
+        virtual bool canHandleResponse( const WorkQueue::Response *res, const WorkQueue *srcQ );
+        /// WorkQueue::ResponseHandler override
+        virtual void handleResponse( const WorkQueue::Response *res, const WorkQueue *srcQ );
+
         /// For debugging stuff. I.e. the Command line uses it for testing manually set properties
         void _setProperty( IdString key, int32 value )      { setProperty( key, value ); }
     };
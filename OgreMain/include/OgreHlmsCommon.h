@@ -127,7 +127,7 @@ namespace Ogre
     inline bool OrderParamVecByKey( const std::pair<IdString, String> &_left,
                                     const std::pair<IdString, String> &_right )
     {
-        return _left.first < _right.second;
+        return _left.first < _right.first;
     }
 
     struct HlmsParam
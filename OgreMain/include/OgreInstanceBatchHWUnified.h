@@ -0,0 +1,210 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __InstanceBatchHWUnified_H__
+#define __InstanceBatchHWUnified_H__
+
+#include "OgreInstanceBatchHW.h"
+#include "OgreHardwareVertexBuffer.h"
+#include "Threading/OgreUniformScalableTask.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Scene
+    *  @{
+    */
+
+    class InstanceBatchHWUnified;
+
+    /** Per instance data of every InstanceBatchHWUnified that shares the same mesh, material,
+        scene memory type and render queue, packed in a single vertex buffer.
+    @remarks
+        The stream is rebuilt on every render pass:
+            1. The worker threads cull the instances of each visible batch on their own
+               (@see InstanceBatchHWUnified::instanceBatchCullFrustumThreaded), and each
+               thread keeps a list of the batches it culled.
+            2. _update merges those lists, gives each batch its offset inside the stream,
+               locks the buffer once and lets the worker threads write the world matrices
+               (and custom params) of all batches in parallel.
+            3. The first batch to reach _updateRenderQueue queues itself using the stream's
+               RenderOperation, so the whole stream is rendered with a single draw call.
+        @par
+        The buffer is always locked with HBL_DISCARD, so the driver hands out fresh memory
+        if the GPU is still reading what the previous pass wrote.
+    */
+    class _OgreExport UnifiedInstanceStream : public UniformScalableTask, public FactoryAlloc
+    {
+    public:
+        typedef FastArray<InstanceBatchHWUnified*> InstanceBatchHWUnifiedArray;
+
+        /// Below this number of instances, the buffer is written in the caller's thread
+        static const size_t PARALLEL_THRESHOLD;
+
+    protected:
+        SceneManager                *mSceneManager;
+
+        RenderOperation             mRenderOperation;
+        unsigned short              mInstanceDataSource;
+        /// Size in bytes of the data of one instance
+        size_t                      mInstanceDataSize;
+
+        HardwareVertexBufferSharedPtr mInstanceBuffer;
+
+        /// Batches culled by each worker thread in the current pass
+        vector<InstanceBatchHWUnifiedArray>::type   mThreadBatches;
+        /// All batches from mThreadBatches, in thread order, & their offsets inside the stream
+        InstanceBatchHWUnifiedArray mBatches;
+        FastArray<size_t>           mBatchOffsets;
+
+        /// Pointer to the locked buffer while the worker threads write to it
+        float                       *mMappedData;
+        /// True once a batch has queued the stream in the current pass
+        bool                        mQueued;
+
+    public:
+        /**
+        @param baseRenderOperation
+            The RenderOperation of the first batch. Its vertex & index data are cloned
+            (the buffers are shared).
+        @param instanceDataSource
+            The source in the vertex declaration that holds the per instance data.
+        */
+        UnifiedInstanceStream( SceneManager *sceneManager, const RenderOperation &baseRenderOperation,
+                               unsigned short instanceDataSource );
+        virtual ~UnifiedInstanceStream();
+
+        /** Called from the worker threads when a batch has visible instances.
+        @param threadIdx
+            Index of the calling thread. Each thread only touches its own list.
+        */
+        void _notifyCulled( InstanceBatchHWUnified *batch, size_t threadIdx )
+        {
+            mThreadBatches[threadIdx].push_back( batch );
+        }
+
+        /** Fills the stream with the instances culled by the worker threads since the last call.
+            Called by the SceneManager once per pass, after culling.
+            Must not be called from a worker thread.
+        */
+        void _update(void);
+
+        /** Returns true exactly once per pass if there is something to render;
+            the caller must then queue itself. @see InstanceBatchHWUnified::_updateRenderQueue
+        */
+        bool _claimQueue(void);
+
+        /// The RenderOperation of the whole stream (numberOfInstances is up to date after _update)
+        const RenderOperation& getRenderOperation(void) const   { return mRenderOperation; }
+
+        /// Number of instances written by the last _update
+        size_t getNumInstances(void) const                      { return mRenderOperation.numberOfInstances; }
+
+        /// Batches written by the last _update, in the order they were merged
+        const InstanceBatchHWUnifiedArray& _getBatches(void) const  { return mBatches; }
+
+        /// Offset (in instances) inside the stream of each batch from _getBatches
+        const FastArray<size_t>& _getBatchOffsets(void) const   { return mBatchOffsets; }
+
+        /// @copydoc UniformScalableTask::execute
+        virtual void execute( size_t threadId, size_t numThreads );
+    };
+
+    /** Variation of InstanceBatchHW where, instead of each batch filling & rendering its
+        own instance buffer, all batches from the same InstanceManager with the same
+        material and render queue write to a shared UnifiedInstanceStream.
+    @remarks
+        Each batch is still culled as a whole by the SceneManager and its instances are
+        still culled individually in the worker threads (regardless of
+        InstancingTheadedCullingMethod), but there is only one buffer lock & one draw call
+        per mesh & material, no matter how many batches there are.
+        @par
+        The vertex layout is the same as InstanceBatchHW's (3 TEXCOORDs with the 4x3 world
+        matrix, plus one float4 TEXCOORD per custom param), so the same shaders can be used.
+        Skeletal animation isn't supported either.
+    */
+    class _OgreExport InstanceBatchHWUnified : public InstanceBatchHW
+    {
+    protected:
+        UnifiedInstanceStream   *mInstanceStream;
+
+        /// Overloaded to leave the per instance data source unbound; it lives in the stream
+        void setupVertices( const SubMesh* baseSubMesh );
+
+    public:
+        InstanceBatchHWUnified( IdType id, ObjectMemoryManager *objectMemoryManager,
+                                InstanceManager *creator, MeshPtr &meshReference,
+                                const MaterialPtr &material, size_t instancesPerBatch,
+                                const Mesh::IndexMap *indexToBoneMap );
+        virtual ~InstanceBatchHWUnified();
+
+        /// Sets the stream this batch writes to. Done by the InstanceManager after building.
+        void _setInstanceStream( UnifiedInstanceStream *instanceStream )
+                                                        { mInstanceStream = instanceStream; }
+        UnifiedInstanceStream* _getInstanceStream(void) const   { return mInstanceStream; }
+
+        /// Index of the vertex declaration source that holds the per instance data
+        unsigned short _getInstanceDataSource(void) const;
+
+        /** @see InstanceBatch::buildFrom
+            Unlike InstanceBatchHW, the vertex data is shared as is (no per batch buffer)
+        */
+        void buildFrom( const SubMesh *baseSubMesh, const RenderOperation &renderOperation );
+
+        /// Number of instances that survived the last cull
+        size_t _getNumCulledInstances(void) const               { return mCulledInstances.size(); }
+
+        /** Writes the world matrices & custom params of the instances that survived the
+            last cull. Called from the worker threads.
+        @param dest
+            Where to write; must have room for _getNumCulledInstances() instances.
+        */
+        void _writeCulledInstances( float * RESTRICT_ALIAS dest ) const;
+
+        /// Renderable overload, returns the operation of the whole stream
+        void getRenderOperation( RenderOperation& op );
+
+        /// Overloaded to queue the whole stream once instead of this batch
+        virtual void _updateRenderQueue( RenderQueue* queue, Camera *camera, const Camera *lodCamera );
+
+        /// Overloaded to move to the stream of the new render queue
+        virtual void setRenderQueueGroup( uint8 queueID );
+
+        /// Overloaded to cull always, and to tell the stream
+        virtual void instanceBatchCullFrustumThreaded( const Frustum *frustum,
+                                                       const Camera *lodCamera,
+                                                       uint32 combinedVisibilityFlags,
+                                                       size_t threadIdx );
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#endif
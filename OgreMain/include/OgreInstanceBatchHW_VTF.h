@@ -183,10 +183,8 @@ namespace Ogre
 
         virtual void instanceBatchCullFrustumThreaded( const Frustum *frustum,
                                                        const Camera *lodCamera,
-                                                        uint32 combinedVisibilityFlags )
-        {
-            instanceBatchCullFrustumThreadedImpl( frustum, lodCamera, combinedVisibilityFlags );
-        }
+                                                        uint32 combinedVisibilityFlags,
+                                                        size_t threadIdx );
     };
 
 }
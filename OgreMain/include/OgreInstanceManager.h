@@ -69,6 +69,7 @@ namespace Ogre
             TextureVTF,             ///< Needs Vertex Texture Fetch & SM 3.0+ @see InstanceBatchVTF
             HWInstancingBasic,      ///< Needs SM 3.0+ and HW instancing support @see InstanceBatchHW
             HWInstancingVTF,        ///< Needs SM 3.0+, HW instancing support & VTF @see InstanceBatchHW_VTF
+            HWInstancingUnified,    ///< Same as HWInstancingBasic, one draw per material @see InstanceBatchHWUnified
             InstancingTechniquesCount
         };
 
@@ -101,6 +102,10 @@ namespace Ogre
 
         typedef map<IdString, BatchSettings>::type  BatchSettingsMap;
 
+        /// Only used by HWInstancingUnified. map[(materialName + sceneType, renderQueueId)] = Stream
+        typedef std::pair<IdString, uint8>                          InstanceStreamKey;
+        typedef map<InstanceStreamKey, UnifiedInstanceStream*>::type InstanceStreamMap;
+
         const IdString          mName;                  //Not the name of the mesh
         MeshPtr                 mMeshReference;
         InstanceBatchMap        mInstanceBatches;
@@ -109,6 +114,7 @@ namespace Ogre
 #endif
         InstanceBatchVec        mDynamicBatches;
         InstanceBatchVec        mDirtyStaticBatches;
+        InstanceStreamMap       mInstanceStreams;
 
         RenderOperation         mSharedRenderOperation;
 
@@ -321,6 +327,17 @@ namespace Ogre
         /** Called by SceneManager every frame */
         void _updateDirtyBatches(void);
 
+        /** Called by SceneManager on every render pass, after the instances were culled.
+            Fills the instance streams of HWInstancingUnified. Does nothing for other techniques.
+        */
+        void _updateInstanceStreams(void);
+
+        /** Makes the batch write to the stream of the batches with its same material, scene
+            memory type and render queue, creating it if needed. Called when the batch is built
+            and whenever its render queue changes. Only used by HWInstancingUnified.
+        */
+        void _assignInstanceStream( InstanceBatchHWUnified *batch );
+
         typedef ConstMapIterator<InstanceBatchMap> InstanceBatchMapIterator;
         typedef ConstVectorIterator<InstanceBatchVec> InstanceBatchIterator;
 
@@ -82,6 +82,7 @@ namespace Ogre
         friend class InstanceBatchShader;
         friend class InstanceBatchHW;
         friend class InstanceBatchHW_VTF;
+        friend class InstanceBatchHWUnified;
         friend class BaseInstanceBatchVTF;
     protected:
         uint16 mInstanceId; //Note it may change after defragmenting!
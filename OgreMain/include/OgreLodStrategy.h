@@ -76,7 +76,7 @@ namespace Ogre {
                                     const Camera *camera, Real bias ) const = 0;
 
         //Include OgreLodStrategyPrivate.inl in the CPP files that use this function.
-        inline static void lodSet( ObjectData &t, Real lodValues[ARRAY_PACKED_REALS] );
+        inline void lodSet( ObjectData &t, Real lodValues[ARRAY_PACKED_REALS] ) const;
 
         /** Transform user supplied value to internal value.
         @remarks
@@ -28,11 +28,13 @@ THE SOFTWARE.
 
 namespace Ogre
 {
-    inline void LodStrategy::lodSet( ObjectData &objData, Real lodValues[ARRAY_PACKED_REALS] )
+    inline void LodStrategy::lodSet( ObjectData &objData, Real lodValues[ARRAY_PACKED_REALS] ) const
     {
         for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
         {
             MovableObject *owner = objData.mOwner[j];
+            owner->mCurrentLodValue     = lodValues[j];
+            owner->mCurrentLodStrategy  = this;
 
             //This may look like a lot of ugly indirections, but mLodMerged is a pointer that allows
             //sharing with many MovableObjects (it should perfectly fit even in small caches).
@@ -208,6 +208,13 @@ namespace Ogre {
         void mergeAdjacentTexcoords( unsigned short finalTexCoordSet,
                                      unsigned short texCoordSetToDestroy, VertexData *vertexData );
 
+        /** Optimises all the triangle lists using vertexData.
+        @param vertexDataTarget
+            0 for the shared vertex data, submesh index + 1 otherwise (same as Pose targets).
+        */
+        void optimiseVertexCache( unsigned short vertexDataTarget, VertexData *vertexData,
+                                  bool reorderVertices, bool reduceOverdraw );
+
 
     public:
         /** Default constructor - used by MeshManager
@@ -624,6 +631,27 @@ namespace Ogre {
         */
         void mergeAdjacentTexcoords( unsigned short finalTexCoordSet, unsigned short texCoordSetToDestroy );
 
+        /** Reorders the geometry of all submeshes so that it renders faster on the GPU.
+        @remarks
+            Triangle lists (including the generated LOD levels) are reordered to make better use
+            of the post-transform vertex cache, then vertices are sorted in the order the
+            triangles first use them so that vertex fetches walk linearly through memory.
+            Bone assignments, poses, morph animations and edge lists are updated accordingly.
+            @par
+            The vertex buffers & index buffers must be readable, so either the mesh must be
+            loaded with shadow buffers or the buffers must not be write only.
+            @par
+            Vertex reordering is skipped for vertex data that is used by non indexed geometry,
+            has a vertexStart other than 0, or has been prepared for shadow volumes.
+        @param reorderVertices
+            Whether to also sort the vertices for vertex fetch.
+        @param reduceOverdraw
+            Whether to additionally reorder clusters of triangles so that occluders are
+            drawn first. Slightly increases the amount of transformed vertices.
+            @see MeshOptimiser
+        */
+        void optimiseVertexCache( bool reorderVertices = true, bool reduceOverdraw = false );
+
         /** This method builds a set of tangent vectors for a given mesh into a 3D texture coordinate buffer.
         @remarks
             Tangent vectors are vectors representing the local 'X' axis for a given vertex based
@@ -775,11 +803,14 @@ namespace Ogre {
             as a hint for optimisation.
         @param blendNormals
             If @c true, normals are blended as well as positions.
+        @param sceneManager
+            Optional. When not null, big buffers are split in ranges of vertices
+            blended by its worker threads. Must not be called from a worker thread.
         */
         static void softwareVertexBlend(const VertexData* sourceVertexData, 
             const VertexData* targetVertexData,
             const Matrix4* const* blendMatrices, size_t numMatrices,
-            bool blendNormals);
+            bool blendNormals, SceneManager *sceneManager = 0);
 
         /** Performs a software vertex morph, of the kind used for
             morph animation although it can be used for other purposes. 
@@ -796,11 +827,14 @@ namespace Ogre {
             VertexData destination; assumed to have a separate position
             buffer already bound, and the number of vertices must agree with the
             number in start and end
+        @param sceneManager
+            Optional. When not null, big buffers are split in ranges of vertices
+            morphed by its worker threads. Must not be called from a worker thread.
         */
         static void softwareVertexMorph(Real t, 
             const HardwareVertexBufferSharedPtr& b1, 
             const HardwareVertexBufferSharedPtr& b2, 
-            VertexData* targetVertexData);
+            VertexData* targetVertexData, SceneManager *sceneManager = 0);
 
         /** Performs a software vertex pose blend, of the kind used for
             morph animation although it can be used for other purposes. 
@@ -66,9 +66,16 @@ namespace Ogre {
                 // bool useSharedVertices
                 // unsigned int indexCount
                 // bool indexes32Bit
-                // unsigned int* faceVertexIndices (indexCount)
-                // OR
-                // unsigned short* faceVertexIndices (indexCount)
+                // unsigned char indexCompression (v2.0+, MeshIndexCompression)
+                // If indexCompression == MIC_RAW and indexCount > 0:
+                //      [buffer data padding head] (v2.0+)
+                //      unsigned int* faceVertexIndices (indexCount)
+                //      OR
+                //      unsigned short* faceVertexIndices (indexCount)
+                //      [buffer data padding tail] (v2.0+)
+                // If indexCompression == MIC_DELTA_VARINT:
+                //      unsigned int encodedSize
+                //      unsigned char encoded[encodedSize]
                 // M_GEOMETRY chunk (Optional: present only if useSharedVertices = false)
                 M_SUBMESH_OPERATION = 0x4010, // optional, trilist assumed if missing
                     // unsigned short operationType
@@ -97,7 +104,28 @@ namespace Ogre {
                     // unsigned short bindIndex;    // Index to bind this buffer to
                     // unsigned short vertexSize;   // Per-vertex size, must agree with declaration at this index
                     M_GEOMETRY_VERTEX_BUFFER_DATA = 0x5210,
+                        // [buffer data padding head] (v2.0+)
                         // raw buffer data
+                        // [buffer data padding tail] (v2.0+)
+                    // Replaces M_GEOMETRY_VERTEX_BUFFER_DATA. Decoded to the
+                    // vertex declaration's formats when loading (v2.0+)
+                    M_GEOMETRY_VERTEX_BUFFER_DATA_COMPRESSED = 0x5220,
+                        // Repeating section, for each element using this buffer
+                        // in declaration order (one array per element):
+                        // unsigned char compression; // MeshVertexElementCompression
+                        // If MVEC_UNORM16_RANGE:
+                        //      float min[numComponents], max[numComponents]
+                        //      unsigned short values[vertexCount * numComponents]
+                        // If MVEC_OCTAHEDRAL_SNORM16:
+                        //      short values[vertexCount * 2]
+                        // If MVEC_RAW:
+                        //      raw element data [vertexCount]
+
+            // Buffer data padding (v2.0+): 16 bytes in total around raw vertex/index data, so
+            // that the data starts at a file offset multiple of 16 and can be used in place.
+            //      unsigned char headBytes
+            //      headBytes zeroes (head)
+            //      15 - headBytes zeroes (tail)
             M_MESH_SKELETON_LINK = 0x6000,
                 // Optional link to skeleton
                 // char* skeletonName           : name of .skeleton to use
@@ -286,6 +314,27 @@ namespace Ogre {
 
     */
     };
+
+    /// How each element is stored in M_GEOMETRY_VERTEX_BUFFER_DATA_COMPRESSED
+    enum MeshVertexElementCompression
+    {
+        /// Stored as is
+        MVEC_RAW                    = 0,
+        /// Float components quantized to 16 bits between the min & max of each component
+        MVEC_UNORM16_RANGE          = 1,
+        /// Unit float3 direction, octahedron mapped & quantized to two signed 16 bit values.
+        /// Elements whose vectors aren't all unit length use MVEC_UNORM16_RANGE instead.
+        MVEC_OCTAHEDRAL_SNORM16     = 2
+    };
+
+    /// How the indices of a submesh are stored (v2.0+)
+    enum MeshIndexCompression
+    {
+        /// Plain 16 or 32 bit array
+        MIC_RAW                     = 0,
+        /// Difference with the previous index, zigzag encoded as a LEB128 varint
+        MIC_DELTA_VARINT            = 1
+    };
     /** @} */
     /** @} */
 
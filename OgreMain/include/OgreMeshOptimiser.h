@@ -0,0 +1,124 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __MeshOptimiser_H__
+#define __MeshOptimiser_H__
+
+#include "OgrePrerequisites.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Resources
+    *  @{
+    */
+
+    /** Reorders triangle lists & vertices so that they are rendered faster.
+    @remarks
+        These are the building blocks of Mesh::optimiseVertexCache; they work on plain
+        32-bit index arrays so they can also be used on data that isn't in a Mesh yet.
+        @par
+        optimiseVertexCache implements Tom Forsyth's "Linear-Speed Vertex Cache
+        Optimisation": triangles are emitted one at a time, always picking the best
+        scoring triangle that uses a vertex in a simulated LRU cache. Only the triangles
+        around the cached vertices get their score updated, so it runs in linear time.
+        @par
+        optimiseOverdraw follows Sander et al. "Fast Triangle Reordering for Vertex Locality
+        and Reduced Overdraw": the cache optimised list is split into clusters where the
+        cache would have been flushed anyway, and clusters facing away from the mesh
+        centre are drawn first, since they're more likely to occlude the rest.
+        @par
+        buildVertexFetchRemap sorts vertices in order of first use, so vertex fetches
+        walk linearly through memory.
+    */
+    class _OgreExport MeshOptimiser
+    {
+    public:
+        /// Size of the LRU cache simulated by optimiseVertexCache
+        static const size_t VERTEX_CACHE_SIZE;
+        /// Size of the FIFO cache used to measure ACMR & find cluster boundaries
+        static const size_t FIFO_CACHE_SIZE;
+
+        /** Reorders the triangles of a triangle list for the post-transform vertex cache.
+        @param indices
+            Triangle list. Reordered in place.
+        @param indexCount
+            Number of indices. Indices after the last whole triangle are left untouched.
+        @param vertexCount
+            All indices must be lower than this value.
+        */
+        static void optimiseVertexCache( uint32 *indices, size_t indexCount, size_t vertexCount );
+
+        /** Reorders clusters of triangles to reduce overdraw. The indices should have
+            been passed through optimiseVertexCache first. Like there, indices after the
+            last whole triangle are left untouched.
+        @param positions
+            Position of the first vertex (3 floats).
+        @param positionStride
+            Bytes between the position of a vertex and the next one.
+        */
+        static void optimiseOverdraw( uint32 *indices, size_t indexCount, const float *positions,
+                                      size_t positionStride, size_t vertexCount );
+
+        /** Creates the table that sorts vertices in order of first use.
+        @param outRemap
+            Array of vertexCount elements; outRemap[oldIndex] = newIndex.
+            Unused vertices go to the end, keeping their relative order.
+        */
+        static void buildVertexFetchRemap( const uint32 *indices, size_t indexCount,
+                                           size_t vertexCount, uint32 *outRemap );
+
+        /** Average cache miss ratio: number of vertices transformed per triangle
+            with a FIFO cache of the given size. 0.5 is the ideal, 3 the worst.
+        */
+        static Real calculateAcmr( const uint32 *indices, size_t indexCount,
+                                   size_t cacheSize = FIFO_CACHE_SIZE );
+
+        /// Copies the used range of the index buffer to a 32-bit array.
+        static void readIndices( const IndexData *indexData, vector<uint32>::type &outIndices );
+        /// Writes back the indices in the used range of the index buffer.
+        static void writeIndices( IndexData *indexData, const vector<uint32>::type &indices );
+
+        /** Runs optimiseVertexCache on a 16 or 32-bit triangle list, i.e. a locked index buffer.
+        @param indexSize
+            Size of an index in bytes (2 or 4).
+        */
+        static void optimiseIndexBuffer( void *indices, size_t indexCount, size_t indexSize );
+
+        /// Runs optimiseVertexCache on the used range of an IndexData containing a triangle list.
+        static void optimiseVertexCache( IndexData *indexData );
+        /// Runs calculateAcmr on the used range of an IndexData.
+        static Real calculateAcmr( const IndexData *indexData, size_t cacheSize = FIFO_CACHE_SIZE );
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#endif
@@ -41,9 +41,14 @@ namespace Ogre {
     /// Mesh compatibility versions
     enum MeshVersion 
     {
-        /// Latest version available
+        /** Version written by default, currently v1.10.
+            v2.0 isn't the default yet because OGRE 1.x can't read it; request it
+            with MESH_VERSION_2_0.
+        */
         MESH_VERSION_LATEST,
-        
+
+        /// OGRE version v2.0+ (raw buffer data aligned in the file). Opt-in, see MESH_VERSION_LATEST
+        MESH_VERSION_2_0,
         /// OGRE version v1.10+
         MESH_VERSION_1_10,
         /// OGRE version v1.8+
@@ -98,7 +103,7 @@ namespace Ogre {
         /** Exports a mesh to the file specified, in the latest format
         @remarks
             This method takes an externally created Mesh object, and exports it
-            to a .mesh file in the latest format version available.
+            to a .mesh file in the default format version, see MESH_VERSION_LATEST.
         @param pMesh Pointer to the Mesh to export
         @param filename The destination filename
         @param endianMode The endian mode of the written file
@@ -124,7 +129,7 @@ namespace Ogre {
         /** Exports a mesh to the stream specified, in the latest format. 
         @remarks
          This method takes an externally created Mesh object, and exports it
-         to a .mesh file in the latest format version. 
+         to a .mesh file in the default format version, see MESH_VERSION_LATEST.
         @param pMesh Pointer to the Mesh to export
         @param stream Writeable stream
         @param endianMode The endian mode of the written file
@@ -160,6 +165,28 @@ namespace Ogre {
         void setListener(MeshSerializerListener *listener);
         /// Returns the current listener
         MeshSerializerListener *getListener();
+
+        /** Whether exported meshes store compressed geometry. Off by default.
+        @remarks
+            Positions & texture coordinates are quantized to 16 bits within their range,
+            float3 normals, tangents & binormals are octahedron encoded in 2x16 bits (or
+            quantized like positions if any of them isn't unit length) and indices are
+            delta + varint coded. This is lossy for vertex data, but loaded meshes have
+            the same vertex declaration as the original.
+            Only MESH_VERSION_2_0 supports it, which must be passed explicitly to
+            exportMesh; ignored for older versions.
+        */
+        void setGeometryCompression(bool compress);
+        bool getGeometryCompression(void) const;
+
+        /** Sets the WorkQueue whose threads help decoding vertex & index data of
+            imported meshes. Defaults to Root's WorkQueue; null imports in the calling thread.
+        @remarks
+            Only used for streams held in memory, see MeshSerializerImpl::importMesh.
+            Hardware buffers are always created and filled from the calling thread.
+        */
+        void setImportWorkQueue(WorkQueue *workQueue);
+        WorkQueue* getImportWorkQueue(void) const;
         
     protected:
         
@@ -181,6 +208,8 @@ namespace Ogre {
         MeshVersionDataList mVersionData;
 
         MeshSerializerListener *mListener;
+        bool mCompressGeometry;
+        WorkQueue *mImportWorkQueue;
 
     };
 
@@ -34,6 +34,10 @@ THE SOFTWARE.
 #include "OgreEdgeListBuilder.h"
 #include "OgreKeyFrame.h"
 #include "OgreVertexBoneAssignment.h"
+#include "OgreMeshFileFormat.h"
+#include "OgreWorkQueueParallelFor.h"
+#include "OgreHardwareVertexBuffer.h"
+#include "OgreHardwareIndexBuffer.h"
 
 namespace Ogre {
     
@@ -52,12 +56,19 @@ namespace Ogre {
     In order to maintain compatibility with older versions of the .mesh format, there
     will be alternative subclasses of this class to load older versions, whilst this class
     will remain to load the latest version.
+    @par
+    When the stream lives in memory and a WorkQueue with worker threads is given,
+    the file is parsed first; the chunks that need decoding (edge lists, pose
+    vertices & pose keyframes, compressed or endian swapped vertex, index & morph
+    data) are only located, then decoded in parallel into system memory. GPU
+    buffers are created while parsing and filled at the end, in the calling thread.
+    See isParallelImportSupported.
 
      @note
         This mesh format was used from Ogre v1.10.
 
     */
-    class _OgrePrivate MeshSerializerImpl : public Serializer
+    class _OgrePrivate MeshSerializerImpl : public Serializer, public WorkQueueParallelFor::Task
     {
     public:
         MeshSerializerImpl();
@@ -69,9 +80,11 @@ namespace Ogre {
         @param pMesh Pointer to the Mesh to export
         @param stream The destination stream
         @param endianMode The endian mode for the written file
+        @param compressGeometry Whether to quantize vertex data & compress indices.
+            Ignored by versions of the format that don't support it.
         */
         void exportMesh(const Mesh* pMesh, DataStreamPtr stream,
-            Endian endianMode = ENDIAN_NATIVE);
+            Endian endianMode = ENDIAN_NATIVE, bool compressGeometry = false);
 
         /** Imports Mesh and (optionally) Material data from a .mesh file DataStream.
         @remarks
@@ -79,10 +92,88 @@ namespace Ogre {
         contents into the Mesh object which is passed in. 
         @param stream The DataStream holding the .mesh data. Must be initialised (pos at the start of the buffer).
         @param pDest Pointer to the Mesh object which will receive the data. Should be blank already.
+        @param workQueue WorkQueue whose threads help decoding the mesh. Can be null.
         */
-        void importMesh(DataStreamPtr& stream, Mesh* pDest, MeshSerializerListener *listener);
+        void importMesh(DataStreamPtr& stream, Mesh* pDest, MeshSerializerListener *listener,
+                        WorkQueue *workQueue = 0);
+
+        /// WorkQueueParallelFor::Task override. Decodes the given ImportJobs.
+        virtual void execute( size_t begin, size_t end );
 
     protected:
+        /// A chunk whose contents can be decoded from any thread once its header was read.
+        struct ImportJob
+        {
+            enum Type
+            {
+                EDGE_LIST_LOD,
+                POSE_VERTICES,
+                POSE_KEYFRAME,
+                /// Vertex data, uploaded to vertexBuffer
+                VERTEX_BUFFER,
+                /// Index data, uploaded to indexBuffer
+                INDEX_BUFFER,
+                /// Morph keyframe positions (and normals), uploaded to vertexBuffer
+                MORPH_KEYFRAME
+            };
+
+            Type            type;
+            /// Location of the chunk's contents in the imported stream.
+            size_t          offset;
+            size_t          size;
+            unsigned short  lodIndex;
+            EdgeData        *edgeData;
+            Pose            *pose;
+            VertexPoseKeyFrame *poseKeyFrame;
+            bool            includesNormals;
+
+            /// Whether the data is stored compressed (see isGeometryCompressionSupported)
+            bool            compressed;
+            HardwareVertexBufferSharedPtr   vertexBuffer;
+            HardwareIndexBufferSharedPtr    indexBuffer;
+            /// Elements of the vertex buffer, to decode or endian swap them
+            VertexDeclaration::VertexElementList elements;
+            /// Decoded contents of vertexBuffer or indexBuffer, in system memory.
+            void            *data;
+
+            ImportJob( Type _type );
+        };
+
+        typedef vector<ImportJob>::type ImportJobVec;
+
+        /// Whether the current import defers chunks to ImportJobs. @See isParallelImportSupported
+        bool                mParallelImport;
+        /// Start of the memory of the stream being imported, when mParallelImport is true.
+        uchar               *mImportData;
+        String              mImportStreamName;
+        ImportJobVec        mImportJobs;
+        WorkQueue           *mImportWorkQueue;
+
+        /// Whether the current export writes compressed geometry. @See isGeometryCompressionSupported
+        bool                mCompressGeometry;
+
+        /** Whether this version of the format can be imported in parallel. Requires chunk
+            sizes to be reliable, since deferred chunks are skipped without being parsed.
+        */
+        virtual bool isParallelImportSupported(void) const;
+
+        /// Main thread. Queues a chunk whose contents go from the current position to chunkEnd.
+        void addImportJob(DataStreamPtr& stream, ImportJob &job, size_t chunkEnd);
+        /// Any thread. Decodes the job, writing only to the job and the objects it points to.
+        void executeImportJob(ImportJob &job) const;
+        /// Main thread. Decodes all jobs in parallel and assembles the results.
+        void finishImportJobs(Mesh *pMesh);
+        /// Main thread. Frees what the jobs allocated and wasn't handed to the mesh.
+        void releaseImportJobs(void);
+        /// Whether a vertex buffer with these elements can be decoded by an ImportJob.
+        bool canDeferVertexBuffer(const VertexDeclaration::VertexElementList &elems) const;
+
+        /// Same as readEdgeList, but defers reading the LOD data to ImportJobs.
+        void scanEdgeList(DataStreamPtr& stream, Mesh* pMesh);
+        /// Same as readPoses, but defers reading the pose vertices to ImportJobs.
+        void scanPoses(DataStreamPtr& stream, Mesh* pMesh);
+        /// Points the edge groups to the vertex data of the mesh they belong to.
+        void setupEdgeGroupVertexData(EdgeData *edgeData, Mesh* pMesh);
 
         // Internal methods
         virtual void writeSubMeshNameTable(const Mesh* pMesh);
@@ -166,12 +257,15 @@ namespace Ogre {
         virtual void readEdgeListLodInfo(DataStreamPtr& stream, EdgeData* edgeData);
         virtual void readPoses(DataStreamPtr& stream, Mesh* pMesh);
         virtual void readPose(DataStreamPtr& stream, Mesh* pMesh);
+        void readPoseVertices(DataStreamPtr& stream, Pose* pose, bool includesNormals);
         virtual void readAnimations(DataStreamPtr& stream, Mesh* pMesh);
         virtual void readAnimation(DataStreamPtr& stream, Mesh* pMesh);
         virtual void readAnimationTrack(DataStreamPtr& stream, Animation* anim, 
             Mesh* pMesh);
         virtual void readMorphKeyFrame(DataStreamPtr& stream, VertexAnimationTrack* track);
         virtual void readPoseKeyFrame(DataStreamPtr& stream, VertexAnimationTrack* track);
+        /// Reads the pose references of a keyframe, until a chunk of another type is found.
+        void readPoseKeyFramePoseRefs(DataStreamPtr& stream, VertexPoseKeyFrame* kf);
         virtual void readExtremes(DataStreamPtr& stream, Mesh *pMesh);
 
 
@@ -186,14 +280,77 @@ namespace Ogre {
         /// This function can be overloaded to disable validation in debug builds.
         virtual void enableValidation();
 
+        /** Size in bytes of the padding that goes around raw vertex & index buffer data so
+            that it starts at an offset in the file aligned to BUFFER_DATA_ALIGNMENT.
+            Returns 0 for the versions that didn't have it.
+        */
+        virtual size_t calcBufferDataPaddingSize(void) const;
+        /// Writes the padding that goes before raw buffer data. Returns the bytes to write after it.
+        size_t writeBufferDataPaddingHead(void);
+        /// Writes the padding that goes after raw buffer data.
+        void writeBufferDataPaddingTail(size_t tailBytes);
+        /// Skips the padding before raw buffer data. Returns the bytes to skip after it.
+        size_t readBufferDataPaddingHead(DataStreamPtr& stream);
+
+        /** Uploads raw buffer data straight from the stream's memory, without locking the
+            buffer nor copying it to a temporary. Only possible when the stream lives in
+            memory (i.e. MappedFileDataStream) and no endian conversion is needed.
+        @return
+            False if it isn't possible; the stream is left untouched and the caller
+            must read the data the usual way.
+        */
+        bool readBufferDataInPlace(DataStreamPtr& stream, HardwareBuffer *dest, size_t sizeBytes);
+
+        /// Whether this version can store M_GEOMETRY_VERTEX_BUFFER_DATA_COMPRESSED & compressed indices.
+        virtual bool isGeometryCompressionSupported(void) const;
+        /** How the given element is stored when compressing geometry. Normals, tangents &
+            binormals are only octahedron encoded if all of them are unit length.
+        @param pSrc Start of the vertex buffer the element belongs to.
+        */
+        static MeshVertexElementCompression getVertexElementCompression(const VertexElement &elem,
+                                                                        const void *pSrc,
+                                                                        size_t vertexSize,
+                                                                        size_t vertexCount);
+        /// Size of the M_GEOMETRY_VERTEX_BUFFER_DATA_COMPRESSED chunk, including its header
+        size_t calcCompressedVertexBufferSize(const VertexDeclaration::VertexElementList &elems,
+                                              const void *pSrc, size_t vertexSize,
+                                              size_t vertexCount) const;
+        void writeCompressedVertexBuffer(const VertexDeclaration::VertexElementList &elems,
+                                         const void *pSrc, size_t vertexSize, size_t vertexCount);
+        void readCompressedVertexBuffer(DataStreamPtr& stream,
+                                        const VertexDeclaration::VertexElementList &elems,
+                                        void *pDst, size_t vertexSize, size_t vertexCount);
+        /// Encodes the submesh indices with MIC_DELTA_VARINT. Returns the size in bytes.
+        static size_t encodeIndices(const IndexData *indexData, vector<uint8>::type *outEncoded);
+        /// Decodes MIC_DELTA_VARINT indices. Returns false if the data is malformed.
+        static bool decodeIndices(const uint8 *pSrc, size_t srcSize, void *pDst,
+                                  size_t indexCount, bool idx32bit);
+
         ushort exportedLodCount; // Needed to limit exported Edge data, when exporting
+
+    public:
+        /// Raw vertex & index data starts at file offsets multiple of this value
+        static const size_t BUFFER_DATA_ALIGNMENT;
+    };
+
+    /** Class for providing backwards-compatibility for loading version 1.10 of the .mesh format.
+     This is the last version without padding around the raw buffer data.
+     */
+    class _OgrePrivate MeshSerializerImpl_v1_10 : public MeshSerializerImpl
+    {
+    public:
+        MeshSerializerImpl_v1_10();
+        ~MeshSerializerImpl_v1_10();
+    protected:
+        virtual size_t calcBufferDataPaddingSize(void) const;
+        virtual bool isGeometryCompressionSupported(void) const;
     };
 
 
     /** Class for providing backwards-compatibility for loading version 1.8 of the .mesh format. 
      This mesh format was used from Ogre v1.8.
      */
-    class _OgrePrivate MeshSerializerImpl_v1_8 : public MeshSerializerImpl
+    class _OgrePrivate MeshSerializerImpl_v1_8 : public MeshSerializerImpl_v1_10
     {
     public:
         MeshSerializerImpl_v1_8();
@@ -218,6 +375,7 @@ namespace Ogre {
 #endif
         virtual void readMeshLodLevel(DataStreamPtr& stream, Mesh* pMesh);
         virtual void enableValidation();
+        virtual bool isParallelImportSupported(void) const;
     };
 
     /** Class for providing backwards-compatibility for loading version 1.41 of the .mesh format. 
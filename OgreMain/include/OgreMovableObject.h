@@ -95,6 +95,10 @@ namespace Ogre {
         FastArray< FastArray<Real> const * > mLodMaterial;
         unsigned char                       mCurrentMeshLod;
         FastArray<unsigned char>            mCurrentMaterialLod;
+        /// Value returned by the LodStrategy the last time the LODs were updated
+        Real                                mCurrentLodValue;
+        /// The LodStrategy that calculated mCurrentLodValue. Null if it never was.
+        LodStrategy const                   *mCurrentLodStrategy;
 
         /// Minimum pixel size to still render
         Real mMinPixelSize;
@@ -247,8 +251,10 @@ namespace Ogre {
                                  const Camera *lodCamera );
 
         /// @See InstancingTheadedCullingMethod, @see InstanceBatch::instanceBatchCullFrustumThreaded
+        /// threadIdx is the index of the worker thread making the call.
         virtual void instanceBatchCullFrustumThreaded( const Frustum *frustum, const Camera *lodCamera,
-                                                        uint32 combinedVisibilityFlags ) {}
+                                                        uint32 combinedVisibilityFlags,
+                                                        size_t threadIdx ) {}
 
         /** @See SceneManager::cullLights & @see MovableObject::cullFrustum
             Produces the global list of visible lights that is needed in buildLightList
@@ -282,7 +288,7 @@ namespace Ogre {
 
         friend void LodStrategy::lodUpdateImpl( const size_t numNodes, ObjectData t,
                                                 const Camera *camera, Real bias ) const;
-        friend void LodStrategy::lodSet( ObjectData &t, Real lodValues[ARRAY_PACKED_REALS] );
+        friend void LodStrategy::lodSet( ObjectData &t, Real lodValues[ARRAY_PACKED_REALS] ) const;
 
         /** Tells this object whether to be visible or not, if it has a renderable component. 
         @note An alternative approach of making an object invisible is to detach it
@@ -535,6 +541,20 @@ namespace Ogre {
 
         const FastArray<unsigned char>& getCurrentMaterialLod(void) const       { return mCurrentMaterialLod; }
 
+        /** Returns the LOD value (i.e. the biased distance to the LOD camera when using the
+            distance strategy) computed the last time the LODs were updated. The mesh & material
+            LODs were selected from it. It's in the same space as the transformUserValue of
+            getCurrentLodStrategy.
+        @remarks
+            LODs are only updated for the objects that are visible in a scene pass, using
+            that pass' LOD camera. The value is the one of the last pass that saw this object;
+            it goes stale while the object is culled.
+        */
+        Real getCurrentLodValue(void) const                                     { return mCurrentLodValue; }
+        /// The LodStrategy that calculated getCurrentLodValue. Null if the LODs of this object
+        /// were never updated.
+        const LodStrategy* getCurrentLodStrategy(void) const                    { return mCurrentLodStrategy; }
+
         /** Sets whether or not this object will cast shadows.
         @remarks
         This setting simply allows you to turn on/off shadows for a given object.
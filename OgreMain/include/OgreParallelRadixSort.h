@@ -0,0 +1,131 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __ParallelRadixSort_H__
+#define __ParallelRadixSort_H__
+
+#include "OgrePrerequisites.h"
+#include "Threading/OgreUniformScalableTask.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup General
+    *  @{
+    */
+
+    /** LSD radix sort of 64-bit keys that splits its work across the SceneManager's
+        worker threads.
+    @remarks
+        Unlike RadixSort, this class doesn't read the keys through a functor; the caller
+        builds an array of (key, value) pairs (usually the value is an index into the
+        container that is being sorted) which allows building the keys in parallel too.
+        @par
+        Each pass works on 8 bits. Every thread builds a histogram of its own range of
+        entries, then scatters them to the offsets derived from all histograms, which
+        keeps the sort stable. Passes whose digit is the same for all entries are skipped,
+        so keys that only use a few bits are cheap to sort.
+        @par
+        The histograms of all the digits are gathered in a single read of the input. They
+        are only valid for the first pass that isn't skipped, the following passes build
+        their own since the entries are moved around.
+    */
+    class _OgreExport ParallelRadixSort : public UniformScalableTask
+    {
+    public:
+        struct Entry
+        {
+            uint64  key;
+            size_t  value;
+
+            Entry() {}
+            Entry( uint64 _key, size_t _value ) : key( _key ), value( _value ) {}
+        };
+
+        typedef vector<Entry>::type EntryVec;
+
+        /// Below this number of entries the sort runs in the caller's thread
+        static const size_t PARALLEL_THRESHOLD;
+
+    protected:
+        enum Phase
+        {
+            /// Build the histograms of all digits (only done once per sort)
+            PHASE_HISTOGRAM_ALL,
+            /// Build the histograms of mCurrentDigit
+            PHASE_HISTOGRAM,
+            /// Move the entries from mSrc to mDst using mOffsets
+            PHASE_SCATTER
+        };
+
+        static const size_t NUM_DIGITS  = 8;
+        static const size_t NUM_BUCKETS = 256;
+
+        Phase   mPhase;
+        size_t  mCurrentDigit;
+        size_t  mNumThreads;
+        size_t  mNumEntries;
+        Entry   *mSrc;
+        Entry   *mDst;
+
+        /// NUM_DIGITS * NUM_BUCKETS counters per thread
+        vector<size_t>::type    mHistograms;
+        /// NUM_BUCKETS write offsets per thread for the current digit
+        vector<size_t>::type    mOffsets;
+        /// Ping-pong buffer, kept around to avoid allocating every sort
+        EntryVec                mTmpEntries;
+
+        /// Range of entries [outStart; outEnd) processed by the given thread
+        void getThreadRange( size_t threadId, size_t &outStart, size_t &outEnd ) const;
+
+        /// Runs the current phase, in the worker threads if sceneManager isn't null.
+        void executePhase( SceneManager *sceneManager );
+
+    public:
+        ParallelRadixSort();
+        virtual ~ParallelRadixSort();
+
+        /** Sorts the entries by ascending key. The sort is stable.
+        @param entries
+            Entries to sort.
+        @param sceneManager
+            SceneManager whose worker threads will be used. Can be null, in which
+            case the sort runs single threaded. Must not be called from a worker thread.
+        */
+        void sort( EntryVec &entries, SceneManager *sceneManager );
+
+        /// @copydoc UniformScalableTask::execute
+        virtual void execute( size_t threadId, size_t numThreads );
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#endif
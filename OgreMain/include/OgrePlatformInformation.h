@@ -77,7 +77,10 @@ namespace Ogre {
 
 /** Find perfect alignment (should supports SIMD alignment if SIMD available)
 */
-#if OGRE_CPU == OGRE_CPU_X86
+#if OGRE_CPU == OGRE_CPU_X86 && OGRE_USE_SIMD == 1 && OGRE_USE_AVX2 == 1
+#   define OGRE_SIMD_ALIGNMENT  32
+
+#elif OGRE_CPU == OGRE_CPU_X86
 #   define OGRE_SIMD_ALIGNMENT  16
 
 #else
@@ -110,6 +113,15 @@ namespace Ogre {
 #   define __OGRE_HAVE_SSE  0
 #endif
 
+/* Define whether or not Ogre compiled with AVX2 (and FMA3) support.
+   Only possible on top of SSE; the SoA math library switches to 8-wide.
+*/
+#if __OGRE_HAVE_SSE && OGRE_USE_AVX2 == 1
+#   define __OGRE_HAVE_AVX2  1
+#else
+#   define __OGRE_HAVE_AVX2  0
+#endif
+
 #if OGRE_USE_SIMD == 0 || !defined(__OGRE_HAVE_NEON)
 #   define __OGRE_HAVE_NEON  0
 #endif
@@ -159,6 +171,10 @@ namespace Ogre {
             CPU_FEATURE_FPU         = 1 << 9,
             CPU_FEATURE_PRO         = 1 << 10,
             CPU_FEATURE_HTT         = 1 << 11,
+            CPU_FEATURE_SSE41       = 1 << 15,
+            CPU_FEATURE_AVX         = 1 << 16,
+            CPU_FEATURE_AVX2        = 1 << 17,
+            CPU_FEATURE_FMA         = 1 << 18,
 #elif OGRE_CPU == OGRE_CPU_ARM
             CPU_FEATURE_VFP         = 1 << 12,
             CPU_FEATURE_NEON        = 1 << 13,
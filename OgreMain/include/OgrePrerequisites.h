@@ -160,6 +160,7 @@ namespace Ogre {
     class BillboardSet;
     class Bone;
     class BoneMemoryManager;
+    class BonePaletteBuffer;
     struct BoneTransform;
     class Camera;
     class Codec;
@@ -203,6 +204,7 @@ namespace Ogre {
     class InstanceBatch;
     class InstanceBatchHW;
     class InstanceBatchHW_VTF;
+    class InstanceBatchHWUnified;
     class InstanceBatchShader;
     class InstanceBatchVTF;
     class InstanceManager;
@@ -328,6 +330,7 @@ namespace Ogre {
     struct Transform;
     class TransformKeyFrame;
     class Timer;
+    class UnifiedInstanceStream;
     class UserObjectBindings;
     class Vector2;
     class Vector3;
@@ -0,0 +1,160 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __RenderCommandBuffer_H__
+#define __RenderCommandBuffer_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreRenderQueueSortingGrouping.h"
+#include "Threading/OgreUniformScalableTask.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup RenderSystem
+    *  @{
+    */
+
+    /** Backend agnostic list of state & draw commands recorded out of a
+        QueuedRenderableCollection.
+    @remarks
+        The renderables are split in ranges following the collection's iteration
+        order (see QueuedRenderableCollection::acceptVisitor) and each range is
+        turned into commands by a different worker thread, into its own command
+        list. Threads read the collection directly: sorted collections are indexed,
+        and pass groups wholly outside a thread's range are skipped by their size.
+        @par
+        Replaying is single threaded; the commands are issued to a
+        QueuedRenderableVisitor making the same calls the collection would have
+        made: pass groups set the pass and then draw each renderable, while sorted
+        collections hand each renderable & pass pair to visit( RenderablePass* ).
+        The only difference is that setting the same pass again is skipped, which
+        happens at the boundaries of the per-thread lists.
+        The visitor consumes the commands, i.e. SceneManager's visitor sends them
+        to the RenderSystem, while a visitor that just counts them can be used
+        for testing or benchmarking without a RenderSystem.
+    */
+    class _OgreExport RenderCommandBuffer : public UniformScalableTask, public RenderQueueAlloc
+    {
+    public:
+        enum CommandType
+        {
+            /// Set the pass for the following draws
+            COMMAND_SET_PASS,
+            /// Draw the renderable with the last pass that was set
+            COMMAND_DRAW,
+            /// Draw the renderable with the given pass, through visit( RenderablePass* ).
+            /// Used by sorted collections, whose passes change from one renderable to the next
+            COMMAND_DRAW_RENDERABLE_PASS
+        };
+
+        struct Command
+        {
+            CommandType type;
+            Pass        *pass;
+            Renderable  *renderable;
+
+            Command( CommandType _type, Pass *_pass, Renderable *_renderable ) :
+                type( _type ), pass( _pass ), renderable( _renderable ) {}
+        };
+
+        typedef vector<Command>::type CommandVec;
+        typedef vector<CommandVec>::type CommandVecVec;
+
+        /// Below this number of renderables the commands are recorded in the caller's thread
+        static const size_t PARALLEL_THRESHOLD;
+
+    protected:
+        /// Collection being recorded, only valid inside record
+        const QueuedRenderableCollection            *mCollection;
+        QueuedRenderableCollection::OrganisationMode mOrganisationMode;
+        /// Number of renderables in mCollection, split evenly between the threads
+        size_t              mNumItems;
+        /// One list of commands per thread, replayed in order
+        CommandVecVec       mThreadCommands;
+
+        size_t  mNumStateCommands;
+        size_t  mNumDrawCommands;
+        size_t  mNumRedundantStateCommands;
+
+        /// Appends the commands to draw a renderable of a pass group with the given pass
+        void addDraw( CommandVec &commands, const Pass *&lastPass,
+                      Pass *pass, Renderable *renderable ) const;
+
+    public:
+        RenderCommandBuffer();
+        virtual ~RenderCommandBuffer();
+
+        /** Discards the previous commands and records new ones from the collection.
+        @param objs
+            The collection to record. It must have been sorted already.
+        @param om
+            The organisation mode to iterate it with. @see QueuedRenderableCollection::acceptVisitor
+        @param sceneManager
+            SceneManager whose worker threads will record the commands. Can be null.
+            Must not be called from a worker thread.
+        */
+        void record( const QueuedRenderableCollection &objs,
+                     QueuedRenderableCollection::OrganisationMode om,
+                     SceneManager *sceneManager );
+
+        /** Issues the recorded commands to the given visitor. Set pass commands call
+            visit( const Pass* ), and the draws that follow it are skipped if it returns
+            false. Draw commands call visit( Renderable* ), and the draws recorded from
+            sorted collections call visit( RenderablePass* ), which decides on its own
+            whether to draw (i.e. SceneManager's visitor filters transparent shadow casters)
+        @remarks
+            The buffer isn't modified, so the same commands can be replayed many times.
+        */
+        void replay( QueuedRenderableVisitor *visitor );
+
+        /// Discards all commands. Memory isn't released.
+        void clear(void);
+
+        /// Returns the command lists, one per recording thread
+        const CommandVecVec& getThreadCommands(void) const      { return mThreadCommands; }
+
+        /// Number of set pass commands issued by the last replay. For sorted
+        /// collections, the number of times the pass changed between draws.
+        size_t getNumStateCommands(void) const                  { return mNumStateCommands; }
+        /// Number of draw commands issued by the last replay (for sorted collections,
+        /// including those the visitor chose not to draw)
+        size_t getNumDrawCommands(void) const                   { return mNumDrawCommands; }
+        /// Number of set pass commands the last replay skipped because the pass was already set
+        size_t getNumRedundantStateCommands(void) const         { return mNumRedundantStateCommands; }
+
+        /// @copydoc UniformScalableTask::execute
+        virtual void execute( size_t threadId, size_t numThreads );
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#endif
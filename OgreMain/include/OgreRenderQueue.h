@@ -266,6 +266,19 @@ namespace Ogre {
         /** Merge render queue.
         */
         void merge( const RenderQueue* rhs );
+
+        /** Sorts all the queue groups ahead of rendering.
+        @remarks
+            The SceneManager calls this after the queue is built, while its worker
+            threads are idle, so that big collections are sorted in parallel. The
+            collections remember they're sorted, so the sort calls made while
+            rendering are free unless renderables are added in between.
+        @param cam
+            Camera the queue will be rendered from.
+        @param sceneManager
+            SceneManager whose worker threads will be used. Can be null.
+        */
+        void sort( const Camera *cam, SceneManager *sceneManager );
     };
 
     /** @} */
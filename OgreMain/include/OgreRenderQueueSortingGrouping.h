@@ -31,7 +31,7 @@ THE SOFTWARE.
 // Precompiler options
 #include "OgrePrerequisites.h"
 #include "OgrePass.h"
-#include "OgreRadixSort.h"
+#include "OgreParallelRadixSort.h"
 
 namespace Ogre {
 
@@ -131,6 +131,9 @@ namespace Ogre {
         };
 
     protected:
+        /// Records straight from mSortedDescending & mGrouped, from multiple threads
+        friend class RenderCommandBuffer;
+
         /// Comparator to order pass groups
         struct PassGroupLess
         {
@@ -195,38 +198,25 @@ namespace Ogre {
         /** Map of pass to renderable lists, this is a grouping by pass. */
         typedef map<Pass*, RenderableList*, PassGroupLess>::type PassGroupRenderableMap;
 
-        /// Functor for accessing sort value 1 for radix sort (Pass)
-        struct RadixSortFunctorPass
-        {
-            uint32 operator()(const RenderablePass& p) const
-            {
-                return p.pass->getHash();
-            }
-        };
-
-        /// Radix sorter for accessing sort value 1 (Pass)
-        static RadixSort<RenderablePassList, RenderablePass, uint32> msRadixSorter1;
-
-        /// Functor for descending sort value 2 for radix sort (distance)
-        struct RadixSortFunctorDistance
+        /** Builds the sort keys of mSortedDescending, from multiple threads if available.
+        @remarks
+            The key has the descending depth in its upper 32 bits and the pass hash in
+            the lower ones, giving the same order as sorting by pass and then by depth.
+        */
+        class DepthSortKeyTask : public UniformScalableTask
         {
-            const Camera* camera;
+        public:
+            QueuedRenderableCollection  *collection;
+            const Camera                *camera;
 
-            RadixSortFunctorDistance(const Camera* cam)
-                : camera(cam)
-            {
-            }
+            DepthSortKeyTask( QueuedRenderableCollection *_collection, const Camera *_camera ) :
+                collection( _collection ), camera( _camera ) {}
 
-            float operator()(const RenderablePass& p) const
-            {
-                // Sort DESCENDING by depth (ie far objects first), use negative distance
-                // here because radix sorter always dealing with accessing sort
-                return static_cast<float>(- p.renderable->getSquaredViewDepth(camera));
-            }
+            virtual void execute( size_t threadId, size_t numThreads );
         };
 
-        /// Radix sorter for sort value 2 (distance)
-        static RadixSort<RenderablePassList, RenderablePass, float> msRadixSorter2;
+        /// Radix sorter for the depth & pass keys
+        static ParallelRadixSort msRadixSorter;
 
         /// Bitmask of the organisation modes requested
         uint8 mOrganisationMode;
@@ -235,6 +225,12 @@ namespace Ogre {
         PassGroupRenderableMap mGrouped;
         /// Sorted descending (can iterate backwards to get ascending)
         RenderablePassList mSortedDescending;
+        /// Sort keys of mSortedDescending, value is the index of the item
+        ParallelRadixSort::EntryVec mSortKeys;
+        /// Where mSortedDescending gets reordered into. Swapped with it after sorting.
+        RenderablePassList mTmpSortedDescending;
+        /// Camera the collection was last sorted for. Null if it needs sorting.
+        const Camera *mSortedCamera;
 
         /// Internal visitor implementation
         void acceptVisitorGrouped(QueuedRenderableVisitor* visitor) const;
@@ -281,9 +277,14 @@ namespace Ogre {
         void addRenderable(Pass* pass, Renderable* rend);
         
         /** Perform any sorting that is required on this collection.
+        @remarks
+            Does nothing if it was already sorted for the same camera and
+            nothing was added since then.
         @param cam The camera
+        @param sceneManager Optional. When not null, big collections are sorted
+            using its worker threads.
         */
-        void sort(const Camera* cam);
+        void sort(const Camera* cam, SceneManager *sceneManager = 0);
 
         /** Accept a visitor over the collection contents.
         @param visitor Visitor class which should be called back
@@ -387,8 +388,9 @@ namespace Ogre {
         void addRenderable(Renderable* pRend, Technique* pTech);
 
         /** Sorts the objects which have been added to the queue; transparent objects by their 
-            depth in relation to the passed in Camera. */
-        void sort(const Camera* cam);
+            depth in relation to the passed in Camera.
+        @see QueuedRenderableCollection::sort */
+        void sort(const Camera* cam, SceneManager *sceneManager = 0);
 
         /** Clears this group of renderables. 
         */
@@ -418,6 +418,13 @@ namespace Ogre {
             hlms->calculateHashFor( this, params, mHlmsHash, mHlmsCasterHash );
         }
 
+        /// Sets the hashes calculated by Hlms::calculateHashForBatch
+        void _setHlmsHashes( uint32 hash, uint32 casterHash )
+        {
+            mHlmsHash       = hash;
+            mHlmsCasterHash = casterHash;
+        }
+
     protected:
         typedef map<size_t, Vector4>::type CustomParameterMap;
         CustomParameterMap mCustomParameters;
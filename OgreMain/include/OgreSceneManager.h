@@ -42,6 +42,7 @@ Torus Knot Software Ltd.
 #include "OgreAnimationState.h"
 #include "OgreRenderQueue.h"
 #include "OgreRenderQueueSortingGrouping.h"
+#include "OgreRenderCommandBuffer.h"
 #include "OgreResourceGroupManager.h"
 #include "OgreShadowTextureManager.h"
 #include "OgreInstanceManager.h"
@@ -49,8 +50,10 @@ Torus Knot Software Ltd.
 #include "OgreLodListener.h"
 #include "Math/Array/OgreNodeMemoryManager.h"
 #include "Math/Array/OgreObjectMemoryManager.h"
+#include "Math/Array/OgreObjectDataBvh.h"
 #include "Animation/OgreSkeletonAnimManager.h"
 #include "Threading/OgreThreads.h"
+#include "Threading/OgreWorkStealingScheduler.h"
 #include "OgreHeaderPrefix.h"
 
 namespace Ogre {
@@ -162,17 +165,22 @@ namespace Ogre {
         Camera const                    *camera;
         /// Camera whose frustum we're to cull against. Must be const (read only for all threads).
         Camera const                    *lodCamera;
+        /// Combination of the viewport's & scene's visibility flags. @See
+        /// SceneManager::_getCombinedVisibilityMask. Ignored by LOD requests.
+        uint32                          visibilityMask;
 
         CullFrustumRequest() :
-            firstRq( 0 ), lastRq( 0 ), objectMemManager( 0 ), camera( 0 ), lodCamera( 0 )
+            firstRq( 0 ), lastRq( 0 ), objectMemManager( 0 ), camera( 0 ), lodCamera( 0 ),
+            visibilityMask( 0 )
         {
         }
         CullFrustumRequest( uint8 _firstRq, uint8 _lastRq,
                             const ObjectMemoryManagerVec *_objectMemManager,
-                            const Camera *_camera, const Camera *_lodCamera ) :
+                            const Camera *_camera, const Camera *_lodCamera,
+                            uint32 _visibilityMask=0 ) :
             firstRq( _firstRq ), lastRq( _lastRq ),
             objectMemManager( _objectMemManager ), camera( _camera ),
-            lodCamera( _lodCamera )
+            lodCamera( _lodCamera ), visibilityMask( _visibilityMask )
         {
         }
     };
@@ -194,18 +202,32 @@ namespace Ogre {
         }
     };
 
-    struct UpdateTransformRequest
+    /// A contiguous range of nodes from the same depth level, processed
+    /// as a single chunk by the worker threads.
+    struct TransformChunk
     {
         Transform t;
-        /// Number of nodes to process for each thread. Must be multiple of ARRAY_PACKED_REALS
-        size_t numNodesPerThread;
-        size_t numTotalNodes;
+        /// Must be multiple of ARRAY_PACKED_REALS (except for the last chunk of a level)
+        size_t numNodes;
 
-        UpdateTransformRequest() :
-            numNodesPerThread( 0 ), numTotalNodes( 0 ) {}
+        TransformChunk() : numNodes( 0 ) {}
+        TransformChunk( const Transform &_t, size_t _numNodes ) :
+            t( _t ), numNodes( _numNodes )
+        {
+        }
+    };
+
+    /// A contiguous range of objects from the same render queue, processed
+    /// as a single chunk by the worker threads.
+    struct ObjectDataChunk
+    {
+        ObjectData objData;
+        /// Must be multiple of ARRAY_PACKED_REALS (except for the last chunk of a render queue)
+        size_t numObjs;
 
-        UpdateTransformRequest( const Transform &_t, size_t _numNodesPerThread, size_t _numTotalNodes ) :
-            t( _t ), numNodesPerThread( _numNodesPerThread ), numTotalNodes( _numTotalNodes )
+        ObjectDataChunk() : numObjs( 0 ) {}
+        ObjectDataChunk( const ObjectData &_objData, size_t _numObjs ) :
+            objData( _objData ), numObjs( _numObjs )
         {
         }
     };
@@ -492,6 +514,15 @@ namespace Ogre {
         */
         bool                    mStaticEntitiesDirty;
 
+        /// @See setStaticBvhCulling
+        bool                    mStaticBvhCulling;
+        /// Built over mEntityMemoryManager[SCENE_STATIC] when mStaticBvhCulling is enabled.
+        ObjectDataBvh           mStaticBvh;
+        ObjectDataBvh::PackRangeVec mTmpStaticPackRanges;
+
+        /// @See setIncrementalMemoryCleanup. 0 if disabled.
+        size_t                  mMaxMemoryMovesPerFrame;
+
         /// Instance name
         String mName;
 
@@ -859,6 +890,14 @@ namespace Ogre {
         /** Updates all instance managers with dirty instance batches. @see _addDirtyInstanceManager */
         void updateInstanceManagers(void);
 
+        /// Whether any instance manager uses InstanceManager::HWInstancingUnified
+        bool hasUnifiedInstanceManagers(void) const;
+
+        /** Fills the instance streams of all HWInstancingUnified managers. Must be called
+            after the instance batches have been culled by the worker threads.
+            @see UnifiedInstanceStream */
+        void updateInstanceStreams(void);
+
         /** Culls the scene in a high level fashion (i.e. Octree, Portal, etc.) by taking into account all
             registered cameras. Produces a list of culled Entities & SceneNodes that must follow a very
             strict set of rules:
@@ -953,20 +992,66 @@ namespace Ogre {
             NUM_REQUESTS
         };
 
+        /// Runs a range of chunks of one of the RequestType in the worker threads
+        class SceneTask : public ChunkedTask
+        {
+        public:
+            SceneManager    *sceneManager;
+            RequestType     requestType;
+            /// Offset into mTransformChunks/mObjectDataChunks, if the request uses them
+            size_t          firstChunk;
+
+            SceneTask( SceneManager *_sceneManager, RequestType _requestType, size_t _firstChunk ) :
+                sceneManager( _sceneManager ), requestType( _requestType ), firstChunk( _firstChunk )
+            {
+            }
+
+            virtual void execute( size_t chunkIdx, size_t threadIdx );
+        };
+
+        /// @See setCullPrefetch
+        enum CullPrefetchState
+        {
+            CULL_PREFETCH_NONE,
+            /// mScheduledCullRequest will be fired by the next _renderPhase02
+            CULL_PREFETCH_SCHEDULED,
+            /// The worker threads are culling mCurrentCullFrustumRequest
+            CULL_PREFETCH_RUNNING,
+            /// mVisibleObjects holds the result of culling mCurrentCullFrustumRequest
+            CULL_PREFETCH_DONE
+        };
+
+        /// Deque on purpose: the scheduler holds pointers to its elements
+        typedef deque<SceneTask>::type              SceneTaskDeque;
+        typedef vector<TransformChunk>::type        TransformChunkVec;
+        typedef vector<ObjectDataChunk>::type       ObjectDataChunkVec;
+
         size_t mNumWorkerThreads;
 
         volatile bool       mExitWorkerThreads;
         CullFrustumRequest              mCurrentCullFrustumRequest;
         UpdateLodRequest                mUpdateLodRequest;
-        UpdateTransformRequest          mUpdateTransformRequest;
-        ObjectMemoryManagerVec const    *mUpdateBoundsRequest;
         InstancingThreadedCullingMethod mInstancingThreadedCullingMethod;
         InstanceBatchCullRequest        mInstanceBatchCullRequest;
         UniformScalableTask *mUserTask;
-        RequestType         mRequestType;
         Barrier             *mWorkerThreadsBarrier;
         ThreadHandleVec     mWorkerThreads;
 
+        /// Distributes the work of every request across the worker threads
+        WorkStealingScheduler   *mTaskScheduler;
+        SceneTaskDeque          mSceneTasks;
+        /// Work split in chunks for the tasks currently in mTaskScheduler
+        TransformChunkVec       mTransformChunks;
+        ObjectDataChunkVec      mObjectDataChunks;
+
+        bool                mCullPrefetch;
+        CullPrefetchState   mCullPrefetchState;
+        CullFrustumRequest  mScheduledCullRequest;
+        /// Frustum & LOD camera position the prefetched culling was performed with, so
+        /// we can tell whether the camera changed before its pass asked for the results.
+        Plane               mCullPrefetchPlanes[6];
+        Vector3             mCullPrefetchLodCameraPos;
+
         /** Contains MovableObjects to be visited and rendered.
         @rermarks
             Declared here to avoid allocating and deallocating every frame. Declared as array of
@@ -1027,6 +1112,16 @@ namespace Ogre {
         /// Storage for default renderable visitor
         SceneMgrQueuedRenderableVisitor mDefaultQueuedRenderableVisitor;
 
+        /// @See setRenderCommandBuffer
+        bool                mUseRenderCommandBuffer;
+        RenderCommandBuffer mRenderCommandBuffer;
+
+        /** Sends the collection to mActiveQueuedRenderableVisitor, recording it
+            first into mRenderCommandBuffer if enabled.
+        */
+        void visitQueuedRenderables( const QueuedRenderableCollection &objs,
+                                     QueuedRenderableCollection::OrganisationMode om );
+
         /// Whether to use camera-relative rendering
         Matrix4 mCachedViewMatrix;
         Vector3 mRelativeOffset;
@@ -1069,40 +1164,46 @@ namespace Ogre {
 
         /** Updates the Animations from the given request inside a thread. @See updateAllAnimations
         @param threadIdx
-            Thread index so we know at which point we should start at.
-            Must be unique for each worker thread
+            Index of the share of work to process, in range [0; mNumWorkerThreads).
+            It is the scheduler's chunk index; not necessarily the thread running it.
         */
         void updateAllAnimationsThread( size_t threadIdx );
         void updateAnimationTransforms( BySkeletonDef &bySkeletonDef, size_t threadIdx );
 
-        /** Updates the Nodes from the given request inside a thread. @See updateAllTransforms
-        @param request
-            Fully setup request. @See UpdateTransformRequest.
-        @param threadIdx
-            Thread index so we know at which point we should start at.
-            Must be unique for each worker thread
+        /** Splits the given render queues of the memory managers in chunks and appends
+            them to mObjectDataChunks.
+        @return
+            Number of chunks added.
         */
-        void updateAllTransformsThread( const UpdateTransformRequest &request, size_t threadIdx );
+        size_t addObjectDataChunks( const ObjectMemoryManagerVec &objectMemManager,
+                                    size_t firstRq, size_t lastRq );
+        size_t addObjectDataChunks( ObjectMemoryManager *memoryManager, size_t firstRq, size_t lastRq );
 
-        /** Updates the world aabbs from the given request inside a thread. @See updateAllTransforms
-        @param threadIdx
-            Thread index so we know at which point we should start at.
-            Must be unique for each worker thread
+        /** Same as addObjectDataChunks, but the static objects are first culled against
+            mStaticBvh (when enabled and up to date), so only the packs that may be visible
+            are split in chunks.
         */
-        void updateAllBoundsThread( const ObjectMemoryManagerVec &objectMemManager, size_t threadIdx );
+        size_t addCullFrustumChunks( const CullFrustumRequest &request );
 
-        /**
-        @param threadIdx
-            Thread index so we know at which point we should start at.
-            Must be unique for each worker thread
+        /** Adds a task to mTaskScheduler.
+        @param numChunks
+            Number of chunks. For tasks that work on mTransformChunks or mObjectDataChunks,
+            the range [firstChunk; firstChunk + numChunks) of those arrays. For tasks that
+            still divide the work on their own, use mNumWorkerThreads.
         */
-        void updateAllLodsThread( const UpdateLodRequest &request, size_t threadIdx );
+        WorkStealingScheduler::TaskId addSceneTask( RequestType requestType,
+                                                    size_t firstChunk, size_t numChunks );
+
+        /// Wakes up the worker threads to execute the tasks in mTaskScheduler. Doesn't wait.
+        void fireWorkerThreads(void);
+        /// Waits until all tasks fired with fireWorkerThreads are finished and clears them.
+        void waitForWorkerThreads(void);
 
         /** Traverses mVisibleObjects[threadIdx] from each thread to call
             MovableObject::instanceBatchCullFrustumThreaded (which is supposed to cull objects)
         @param threadIdx
-            Thread index so we know at which point we should start at.
-            Must be unique for each worker thread
+            Index of the mVisibleObjects array to traverse, in range [0; mNumWorkerThreads).
+            It is the scheduler's chunk index; not necessarily the thread running it.
         */
         void instanceBatchCullFrustumThread( const InstanceBatchCullRequest &request, size_t threadIdx );
 
@@ -1111,11 +1212,14 @@ namespace Ogre {
             @See MovableObject::cullFrustum
         @param request
             Fully setup request. @See CullFrustumRequest.
+        @param chunk
+            Objects to cull.
         @param threadIdx
-            Index to mVisibleObjects so we know which array we should start at.
+            Index to mVisibleObjects so we know which array we should append to.
             Must be unique for each worker thread
         */
-        void cullFrustum( const CullFrustumRequest &request, size_t threadIdx );
+        void cullFrustum( const CullFrustumRequest &request, const ObjectDataChunk &chunk,
+                          size_t threadIdx );
 
         /** Builds a list of all lights that are visible by all queued cameras (this should be fed by
             Compositor). Then calls MovableObject::buildLightList with that list so that each
@@ -1127,7 +1231,6 @@ namespace Ogre {
 
         void buildLightListThread01( const BuildLightListRequest &buildLightListRequest,
                                      size_t threadIdx );
-        void buildLightListThread02( size_t threadIdx );
 
     public:
         /** Constructor.
@@ -1418,6 +1521,12 @@ namespace Ogre {
         SkeletonInstance* createSkeletonInstance( const SkeletonDef *skeletonDef );
         /// Destroys an instance of a skeleton created with @createSkeletonInstance.
         void destroySkeletonInstance( SkeletonInstance *skeletonInstance );
+        /** Returns the GPU skinning palette shared by all the instances of the given
+            definition, creating it the first time. It's flagged as out of date every frame
+            after the animations are updated, and uploaded the first time a renderable asks
+            for its buffer. @see BonePaletteBuffer
+        */
+        BonePaletteBuffer* getBonePaletteBuffer( const SkeletonDef *skeletonDef );
 
         /** Create a ManualObject, an object which you populate with geometry
             manually through a GL immediate-mode style interface.
@@ -2975,6 +3084,68 @@ namespace Ogre {
         */
         virtual bool getFindVisibleObjects(void) { return mFindVisibleObjects; }
 
+        /** Enables cull prefetching. When enabled, the frustum culling of a scene pass is
+            started in the worker threads as soon as the previous scene pass (of the same
+            compositor node) has built its render queue, so it runs while the main thread
+            is still submitting the previous pass to the RenderSystem.
+        @remarks
+            This only overlaps passes within the same frame. Animations, transforms and
+            bounds of the next frame are still updated after this frame was submitted.
+        @par
+            If the camera, the LOD camera, the visibility masks or the render queue range
+            change between the passes (i.e. by a listener), the results are discarded and
+            the pass gets culled again. Changes to the objects themselves (i.e. their
+            visibility flags) made while rendering the previous pass aren't detected.
+            Off by default.
+        */
+        void setCullPrefetch( bool bEnabled )               { mCullPrefetch = bEnabled; }
+        bool getCullPrefetch(void) const                    { return mCullPrefetch; }
+
+        /** When enabled, each collection of the render queue is recorded into a
+            RenderCommandBuffer (using the worker threads when it's big enough, and they're
+            not busy with cull prefetching) and then replayed to the active
+            SceneMgrQueuedRenderableVisitor, skipping the redundant pass changes.
+            Off by default.
+        @see RenderCommandBuffer
+        */
+        void setRenderCommandBuffer( bool bEnabled )        { mUseRenderCommandBuffer = bEnabled; }
+        bool getRenderCommandBuffer(void) const             { return mUseRenderCommandBuffer; }
+
+        /// Returns the command buffer used to render the last collection. @see setRenderCommandBuffer
+        const RenderCommandBuffer& _getRenderCommandBuffer(void) const { return mRenderCommandBuffer; }
+
+        /** Enables culling static objects through a bounding volume hierarchy, which allows
+            rejecting entire regions of static objects before they reach the SoA frustum test.
+        @remarks
+            The hierarchy is rebuilt during updateSceneGraph every time static objects are
+            flagged as dirty (@see notifyStaticDirty), which is slow. Worth it on scenes with
+            lots of static objects that are rarely modified, where most of them are outside
+            the camera. Off by default.
+        */
+        void setStaticBvhCulling( bool bEnabled );
+        bool getStaticBvhCulling(void) const                { return mStaticBvhCulling; }
+
+        /** Spreads the cost of compacting the memory of Nodes, entities and lights over time.
+        @remarks
+            By default, when too many of them were destroyed in a non-LIFO fashion, all the
+            memory past the first hole is shifted at once, which may cause noticeable hitches
+            in scenes where objects are constantly being created and destroyed.
+            When enabled, those cleanups never happen. Instead every frame (in updateSceneGraph)
+            the last objects are moved into the holes, up to the given limit.
+        @param maxMovesPerFrame
+            Maximum number of objects (Nodes, entities & lights combined) moved per frame.
+            0 to disable and go back to the default behavior.
+        */
+        void setIncrementalMemoryCleanup( size_t maxMovesPerFrame );
+        size_t getIncrementalMemoryCleanup(void) const      { return mMaxMemoryMovesPerFrame; }
+
+        /** Requests the next _renderPhase02 to start culling ahead of time with the given
+            parameters, which are the ones expected for the next _cullPhase01 call.
+            Does nothing if cull prefetching is disabled. @See setCullPrefetch
+        */
+        void _scheduleCullPrefetch( const Camera *camera, const Camera *lodCamera,
+                                    uint32 viewportVisibilityMask, uint8 firstRq, uint8 lastRq );
+
         /** Set whether to automatically normalise normals on objects whenever they
             are scaled.
         @remarks
@@ -3197,11 +3368,31 @@ namespace Ogre {
         IlluminationRenderStage _getCurrentRenderStage() const {return mIlluminationStage;}
 
     protected:
+        /// Fills a CullFrustumRequest for culling our entities. @See _cullPhase01
+        CullFrustumRequest createCullFrustumRequest( const Camera *camera, const Camera *lodCamera,
+                                                     uint32 viewportVisibilityMask,
+                                                     uint8 firstRq, uint8 lastRq ) const;
+
+        /// Waits for the worker threads if a prefetched culling is still running.
+        /// Must be called before using the worker threads or touching mVisibleObjects.
+        void syncCullPrefetch(void);
+
+        /// Fires the culling requested by _scheduleCullPrefetch, if any, without waiting for it.
+        void startCullPrefetch(void);
+
+        /** Fills mVisibleObjects with the objects seen by the camera. Reuses the results
+            of the culling started by startCullPrefetch if it was performed with the same
+            parameters, otherwise culls again.
+        */
+        void cullVisibleObjects( Camera *camera, const Camera *lodCamera,
+                                 uint32 viewportVisibilityMask, uint8 firstRq, uint8 lastRq );
+
         /** Launches cullFrustum on all worker threads with the requested parameters
-        @remarks
-            Will block until all threads are done.
+        @param bBlock
+            True to block until all threads are done. False to return immediately
+            (used by cull prefetching, @See setCullPrefetch)
         */
-        void fireCullFrustumThreads( const CullFrustumRequest &request );
+        void fireCullFrustumThreads( const CullFrustumRequest &request, bool bBlock );
         void fireCullFrustumInstanceBatchThreads( const InstanceBatchCullRequest &request );
         void startWorkerThreads();
         void stopWorkerThreads();
@@ -3229,8 +3420,8 @@ namespace Ogre {
         */
         void waitForPendingUserScalableTask();
 
-        /** Called from the worker thread, polls to process frustum culling
-            requests when a sync is performed
+        /** Called from the worker thread, runs the tasks from mTaskScheduler
+            when a sync is performed
         */
         unsigned long _updateWorkerThread( ThreadHandle *threadHandle );
     };
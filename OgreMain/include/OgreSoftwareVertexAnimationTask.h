@@ -0,0 +1,138 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __SoftwareVertexAnimationTask_H__
+#define __SoftwareVertexAnimationTask_H__
+
+#include "OgrePrerequisites.h"
+#include "Threading/OgreUniformScalableTask.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Animation
+    *  @{
+    */
+
+    /** Splits the software skinning & morphing done by OptimisedUtil in ranges of
+        vertices and runs each range in a different worker thread of a SceneManager.
+    @remarks
+        Every vertex is processed independently, so the results are exactly the same
+        as a single OptimisedUtil call. Ranges start at multiples of VERTEX_GRANULARITY
+        vertices so that the SIMD implementations see the same pointer alignment they
+        would have seen for the whole buffer.
+        @par
+        Buffers with less than PARALLEL_THRESHOLD vertices, or a null SceneManager,
+        are processed in the caller's thread.
+    */
+    class _OgreExport SoftwareVertexAnimationTask : public UniformScalableTask
+    {
+    public:
+        /// Below this number of vertices the work is done in the caller's thread
+        static const size_t PARALLEL_THRESHOLD;
+        /// The vertex ranges of each thread start at multiples of this value
+        static const size_t VERTEX_GRANULARITY;
+
+    protected:
+        enum Mode
+        {
+            MODE_SKINNING,
+            MODE_MORPH
+        };
+
+        Mode    mMode;
+        size_t  mNumVertices;
+
+        /// Positions. In MODE_MORPH mSrcPos is the start & mSrcPos2 the end keyframe
+        const float *mSrcPos;
+        const float *mSrcPos2;
+        float       *mDestPos;
+        const float *mSrcNorm;
+        float       *mDestNorm;
+        const float *mBlendWeight;
+        const unsigned char *mBlendIndex;
+        const Matrix4* const *mBlendMatrices;
+
+        /// Strides in bytes. In MODE_MORPH mSrcNormStride is the vertex size of mSrcPos2
+        size_t  mSrcPosStride;
+        size_t  mDestPosStride;
+        size_t  mSrcNormStride;
+        size_t  mDestNormStride;
+        size_t  mBlendWeightStride;
+        size_t  mBlendIndexStride;
+        size_t  mNumWeightsPerVertex;
+
+        Real    mMorphT;
+        bool    mMorphNormals;
+
+        /// Range of vertices [outStart; outEnd) processed by the given thread
+        void getThreadRange( size_t threadId, size_t numThreads,
+                             size_t &outStart, size_t &outEnd ) const;
+
+        /// Runs the task, in the worker threads if the buffer is big enough.
+        void dispatch( SceneManager *sceneManager );
+
+    public:
+        SoftwareVertexAnimationTask();
+        virtual ~SoftwareVertexAnimationTask();
+
+        /** Same as OptimisedUtil::softwareVertexSkinning, split across worker threads.
+        @param sceneManager
+            SceneManager whose worker threads will be used. Can be null.
+            Must not be called from a worker thread.
+        */
+        void softwareVertexSkinning( const float *srcPosPtr, float *destPosPtr,
+                                     const float *srcNormPtr, float *destNormPtr,
+                                     const float *blendWeightPtr, const unsigned char* blendIndexPtr,
+                                     const Matrix4* const* blendMatrices,
+                                     size_t srcPosStride, size_t destPosStride,
+                                     size_t srcNormStride, size_t destNormStride,
+                                     size_t blendWeightStride, size_t blendIndexStride,
+                                     size_t numWeightsPerVertex, size_t numVertices,
+                                     SceneManager *sceneManager );
+
+        /** Same as OptimisedUtil::softwareVertexMorph, split across worker threads.
+        @param sceneManager
+            SceneManager whose worker threads will be used. Can be null.
+            Must not be called from a worker thread.
+        */
+        void softwareVertexMorph( Real t, const float *srcPos1, const float *srcPos2,
+                                  float *dstPos, size_t pos1VSize, size_t pos2VSize,
+                                  size_t dstVSize, size_t numVertices, bool morphNormals,
+                                  SceneManager *sceneManager );
+
+        /// @copydoc UniformScalableTask::execute
+        virtual void execute( size_t threadId, size_t numThreads );
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#endif
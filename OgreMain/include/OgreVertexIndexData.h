@@ -273,6 +273,8 @@ namespace Ogre {
             Can only be used for index data which consists of triangle lists.
             It would in fact be pointless to use it on triangle strips or fans
             in any case.
+        @par
+            Only the range starting at indexStart is reordered. @see MeshOptimiser
         */
         void optimiseVertexCacheTriList(void);
     
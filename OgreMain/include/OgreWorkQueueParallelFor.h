@@ -0,0 +1,123 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __WorkQueueParallelFor_H__
+#define __WorkQueueParallelFor_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreWorkQueue.h"
+#include "Threading/OgreLightweightMutex.h"
+#include "Threading/OgreSemaphore.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup General
+    *  @{
+    */
+
+    /** Splits a loop over independent items between the calling thread and the threads
+        of a WorkQueue.
+    @remarks
+        The items are handed out in ranges, a few per thread, so the threads that finish
+        early take over the remaining work. The calling thread processes ranges too,
+        which guarantees progress even if the WorkQueue's threads are busy (or the caller
+        is one of them), and then blocks until the ranges other threads started are done.
+        @par
+        Unlike SceneManager::executeUserScalableTask, it can be used outside rendering
+        (i.e. while loading resources) and the work doesn't need to be uniform.
+    */
+    class _OgreExport WorkQueueParallelFor : public WorkQueue::RequestHandler, public GeneralAllocatedObject
+    {
+    public:
+        /// The loop body
+        class Task
+        {
+        public:
+            virtual ~Task() {}
+            /** Processes the items in [begin; end). Called from several threads at
+                once, on distinct ranges.
+            */
+            virtual void execute( size_t begin, size_t end ) = 0;
+        };
+
+        /** Runs the task on the items [0; count) and returns when all of them were processed.
+        @param workQueue
+            WorkQueue whose threads help. When null, or not a DefaultWorkQueueBase with
+            worker threads, the loop runs in the calling thread.
+        @param minRangeSize
+            The smallest number of items processed by one call to Task::execute.
+        @remarks
+            Exceptions of any type thrown by the task are caught; no more ranges are
+            handed out after the first one, and an Exception with its description is
+            thrown from this function once all threads stopped.
+        */
+        static void run( Task &task, size_t count, WorkQueue *workQueue, size_t minRangeSize = 1 );
+
+        /// Returns Root's WorkQueue, or null if there's no Root.
+        static WorkQueue* getRootWorkQueue(void);
+
+        /// WorkQueue::RequestHandler override
+        virtual bool canHandleRequest( const WorkQueue::Request *req, const WorkQueue *srcQ );
+        /// WorkQueue::RequestHandler override
+        virtual WorkQueue::Response* handleRequest( const WorkQueue::Request *req,
+                                                    const WorkQueue *srcQ );
+
+    protected:
+        /// Sent to the WorkQueue so its threads help processing the ranges.
+        struct RangeRequest
+        {
+            WorkQueueParallelFor *owner;
+            friend std::ostream& operator<<( std::ostream &o, const RangeRequest &r )
+            { return o; }
+        };
+
+        Task                &mTask;
+        size_t              mCount;
+        size_t              mRangeSize;
+        /// Protects mNextRangeBegin, mStartedRanges & mError
+        LightweightMutex    mMutex;
+        size_t              mNextRangeBegin;
+        size_t              mStartedRanges;
+        /// Description of the first exception raised by the task, empty if none.
+        String              mError;
+        /// Posted once per finished range
+        Semaphore           mRangeFinished;
+
+        WorkQueueParallelFor( Task &task, size_t count, size_t rangeSize );
+
+        /// Any thread. Processes the next unclaimed range. Returns false if there were none left.
+        bool executeNextRange(void);
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#endif
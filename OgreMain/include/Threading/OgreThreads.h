@@ -177,6 +177,12 @@ namespace Ogre
         */
         static void WaitForThreads( size_t numThreadHandles, const ThreadHandlePtr *threadHandles );
         static void WaitForThreads( const ThreadHandleVec &threadHandles );
+
+        /** Suspends the calling thread.
+        @param milliseconds
+            Time to sleep. 0 just yields the rest of the time slice to other threads.
+        */
+        static void Sleep( uint32 milliseconds );
     };
 }
 
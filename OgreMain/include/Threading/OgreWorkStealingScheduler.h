@@ -0,0 +1,195 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __WorkStealingScheduler_H__
+#define __WorkStealingScheduler_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreFastArray.h"
+#include "Threading/OgreLightweightMutex.h"
+#include "Threading/OgreSemaphore.h"
+
+namespace Ogre
+{
+    /** A task that can be divided into many independent chunks.
+        Chunks of the same task may run concurrently, in any order, and
+        from any worker thread.
+        @see WorkStealingScheduler
+    */
+    class _OgreExport ChunkedTask
+    {
+    public:
+        virtual ~ChunkedTask() {}
+
+        /** Overload this function to perform the work of a single chunk.
+        @param chunkIdx
+            Index of the chunk to process, in range [0; numChunks)
+        @param threadIdx
+            The index of the thread it is being called from. Guaranteed to
+            be in range [0; numThreads). Use it to index per-thread output
+            (i.e. to avoid locks); do not use it to partition the work.
+        */
+        virtual void execute( size_t chunkIdx, size_t threadIdx ) = 0;
+    };
+
+    /** Runs a graph of ChunkedTask across a fixed number of worker threads.
+    @remarks
+        Each thread owns a queue of ranges of chunks. A thread pops from the
+        back of its own queue, and splits big ranges in half, leaving the other
+        half where idle threads can steal it (they steal from the front, where
+        the bigger ranges are). This keeps cores busy even when the work is
+        uneven, instead of dividing it statically by thread index.
+    @par
+        Tasks can depend on other tasks. A task isn't started until all the
+        tasks it depends on are finished; but unrelated tasks keep running,
+        so there is no need to sync all threads between dependent phases.
+    @par
+        Usage:
+            1. Main thread: addTask & addDependency to build the graph.
+            2. Main thread: _prepare()
+            3. Every worker thread: _execute( threadIdx ). Returns once the
+               whole graph is done.
+            4. Main thread (after the workers returned): clear()
+        Waking up the threads before step 3 & putting them to sleep after it is
+        caller's responsibility (i.e. SceneManager uses a Barrier for it). Inside
+        _execute, a worker that runs out of work spins for a short while, then
+        blocks until new work is released or the graph is done.
+    @par
+        The graph must not be modified while it is being executed.
+    */
+    class _OgreExport WorkStealingScheduler
+    {
+    public:
+        typedef size_t TaskId;
+
+    protected:
+        struct WorkRange
+        {
+            TaskId  taskId;
+            size_t  chunkBegin;
+            size_t  chunkEnd;
+
+            WorkRange() : taskId( 0 ), chunkBegin( 0 ), chunkEnd( 0 ) {}
+            WorkRange( TaskId _taskId, size_t _chunkBegin, size_t _chunkEnd ) :
+                taskId( _taskId ), chunkBegin( _chunkBegin ), chunkEnd( _chunkEnd ) {}
+        };
+
+        struct ThreadQueue
+        {
+            LightweightMutex            mutex;
+            deque<WorkRange>::type      ranges;
+            /// Avoid false cache sharing between queues of different threads
+            uint8                       padding[64];
+        };
+
+        struct TaskEntry
+        {
+            ChunkedTask         *task;
+            size_t              numChunks;
+            size_t              chunksLeft;
+            size_t              pendingDependencies;
+            FastArray<TaskId>   dependents;
+        };
+
+        typedef vector<TaskEntry>::type         TaskEntryVec;
+        typedef vector<ThreadQueue*>::type      ThreadQueueVec;
+
+        size_t              mNumThreads;
+        TaskEntryVec        mTasks;
+        ThreadQueueVec      mQueues;
+
+        /// Protects chunksLeft & pendingDependencies from all tasks, mRemainingTasks
+        /// and mNumSleeping. mRemainingTasks is also read without it (with acquire
+        /// semantics) by the workers' polling loop, so it's only written with
+        /// storeRelease.
+        LightweightMutex    mGraphMutex;
+        size_t              mRemainingTasks;
+        /// Number of workers blocked in mIdleSemaphore. Only accessed with mGraphMutex held.
+        size_t              mNumSleeping;
+        Semaphore           mIdleSemaphore;
+
+        /// Pushes the whole range of the task into the given thread's queue.
+        void pushTask( TaskId taskId, size_t threadIdx );
+        /// Pops from the back of our own queue
+        bool popRange( size_t threadIdx, WorkRange &outRange );
+        /// Steals from the front of someone else's queue
+        bool stealRange( size_t threadIdx, WorkRange &outRange );
+
+        /** Marks the task as finished and releases the tasks that were waiting on it.
+            mGraphMutex must be held.
+        */
+        void finishTask( TaskId taskId, size_t threadIdx );
+
+        /// Wakes up to 'count' sleeping workers. mGraphMutex must be held.
+        void wakeUpWorkers( size_t count );
+
+        /** Called when a worker found nothing to do after spinning for a while. Blocks
+            until there may be work again or the graph is done, unless some queue got
+            work in the meantime. Returns false if the graph is done.
+        */
+        bool waitForWork(void);
+
+    public:
+        WorkStealingScheduler( size_t numThreads );
+        ~WorkStealingScheduler();
+
+        /** Adds a task to the graph.
+        @param task
+            Task to run. Pointer must be valid until clear() is called.
+        @param numChunks
+            Number of chunks the task is divided into. Can be 0.
+        @return
+            Id to be used in addDependency.
+        */
+        TaskId addTask( ChunkedTask *task, size_t numChunks );
+
+        /// Task 'taskId' won't start until 'dependsOn' has finished.
+        void addDependency( TaskId taskId, TaskId dependsOn );
+
+        /// Returns true if no task has been added since the last clear
+        bool empty(void) const                          { return mTasks.empty(); }
+
+        size_t getNumThreads(void) const                { return mNumThreads; }
+
+        /** Distributes the tasks that have no dependencies across all the thread queues.
+            Must be called from the main thread, before the workers start.
+        */
+        void _prepare(void);
+
+        /** Processes chunks (stealing from other threads when our queue runs dry)
+            until all the tasks in the graph are done.
+            Must be called from all worker threads.
+        */
+        void _execute( size_t threadIdx );
+
+        /// Removes all tasks. Must not be called while the graph is executing.
+        void clear(void);
+    };
+}
+
+#endif
@@ -0,0 +1,147 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "Animation/OgreBonePaletteBuffer.h"
+#include "Animation/OgreSkeletonInstance.h"
+#include "Math/Array/OgreBoneMemoryManager.h"
+
+#include "OgreHardwareBufferManager.h"
+
+namespace Ogre
+{
+    BonePaletteBuffer::BonePaletteBuffer( BoneMemoryManager *boneMemoryManager ) :
+        mBoneMemoryManager( boneMemoryManager ),
+        mNumMatrices( 0 ),
+        mLayoutVersion( 0 ),
+        mDirty( true )
+    {
+        updateLevelOffsets();
+    }
+    //-----------------------------------------------------------------------------------
+    BonePaletteBuffer::~BonePaletteBuffer()
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    void BonePaletteBuffer::updateLevelOffsets(void)
+    {
+        const size_t numDepths = mBoneMemoryManager->getNumDepths();
+
+        //Offsets are based on the number of slots (not the used ones), so
+        //they only change when the BoneMemoryManager grows.
+        bool changed = mLevelOffsets.size() != numDepths;
+        mLevelOffsets.resize( numDepths );
+
+        size_t offset = 0;
+        for( size_t i=0; i<numDepths; ++i )
+        {
+            changed |= mLevelOffsets[i] != offset;
+            mLevelOffsets[i] = offset;
+            offset += mBoneMemoryManager->getNumSlots( i );
+        }
+
+        if( changed )
+            ++mLayoutVersion;
+
+        mNumMatrices = offset;
+    }
+    //-----------------------------------------------------------------------------------
+    void BonePaletteBuffer::_notifyTransformsChanged(void)
+    {
+        //The offsets are kept up to date every frame so getPaletteIndex is
+        //valid even if nobody has asked for the buffer yet.
+        updateLevelOffsets();
+        mDirty = true;
+    }
+    //-----------------------------------------------------------------------------------
+    const HardwareUniformBufferSharedPtr& BonePaletteBuffer::getBuffer(void)
+    {
+        if( mDirty )
+        {
+            upload();
+            mDirty = false;
+        }
+
+        return mBuffer;
+    }
+    //-----------------------------------------------------------------------------------
+    void BonePaletteBuffer::upload(void)
+    {
+        if( !mNumMatrices )
+            return;
+
+        const size_t requiredBytes = mNumMatrices * sizeof( SimpleMatrixAf4x3 );
+
+        if( mBuffer.isNull() || mBuffer->getSizeInBytes() < requiredBytes )
+        {
+            //Leave some room so that adding instances doesn't recreate it every time
+            mBuffer = HardwareBufferManager::getSingleton().createUniformBuffer(
+                                        requiredBytes + (requiredBytes >> 1),
+                                        HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY_DISCARDABLE, false );
+        }
+
+        uint8 *dstData = static_cast<uint8*>( mBuffer->lock( HardwareBuffer::HBL_DISCARD ) );
+
+        for( size_t i=0; i<mLevelOffsets.size(); ++i )
+        {
+            BoneTransform t;
+            const size_t numUsedSlots = mBoneMemoryManager->getFirstNode( t, i );
+            memcpy( dstData + mLevelOffsets[i] * sizeof( SimpleMatrixAf4x3 ),
+                    t.mFinalTransform, numUsedSlots * sizeof( SimpleMatrixAf4x3 ) );
+        }
+
+        mBuffer->unlock();
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 BonePaletteBuffer::getPaletteIndex( Bone *bone ) const
+    {
+        const uint16 depthLevel = bone->getDepthLevel();
+        assert( depthLevel < mLevelOffsets.size() );
+
+        BoneTransform first;
+        mBoneMemoryManager->getFirstNode( first, depthLevel );
+
+        const BoneTransform &t = bone->_getTransform();
+        return static_cast<uint32>( mLevelOffsets[depthLevel] + (t.mOwner - first.mOwner) + t.mIndex );
+    }
+    //-----------------------------------------------------------------------------------
+    void BonePaletteBuffer::getPaletteIndices( SkeletonInstance *skeletonInstance,
+                                               const FastArray<unsigned short> &usedBones,
+                                               uint32 * RESTRICT_ALIAS outIndices ) const
+    {
+        FastArray<unsigned short>::const_iterator itor = usedBones.begin();
+        FastArray<unsigned short>::const_iterator end  = usedBones.end();
+
+        while( itor != end )
+        {
+            *outIndices++ = getPaletteIndex( skeletonInstance->getBone( *itor ) );
+            ++itor;
+        }
+    }
+}
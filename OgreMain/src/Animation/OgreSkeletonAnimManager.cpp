@@ -53,29 +53,63 @@ namespace Ogre
     //-----------------------------------------------------------------------
     void BySkeletonDef::updateThreadStarts(void)
     {
+        const size_t numThreads = threadStarts.size() - 1;
+        const size_t numSkeletons = skeletons.size();
+
+        size_t totalCost = 0;
+        FastArray<SkeletonInstance*>::const_iterator itor = skeletons.begin();
+        FastArray<SkeletonInstance*>::const_iterator end  = skeletons.end();
+
+        while( itor != end )
+        {
+            totalCost += (*itor)->_getLodUpdateCost();
+            ++itor;
+        }
+
+        //Thread i ends once the accumulated cost reaches (i+1) / numThreads of the total.
+        //Comparing against the accumulated cost (rather than a per thread budget) keeps
+        //the rounding errors from piling up in the last thread.
+        size_t accumCost = 0;
         size_t lastStart = 0;
-        size_t increments = std::max<size_t>( ARRAY_PACKED_REALS,
-                                              skeletons.size() / (threadStarts.size() - 1) );
-        for( size_t i=0; i<threadStarts.size(); ++i )
+        for( size_t i=0; i<numThreads; ++i )
         {
             threadStarts[i] = lastStart;
-            lastStart += increments;
-            lastStart = std::min( lastStart, skeletons.size() );
 
-            while( lastStart < skeletons.size() &&
+            const size_t targetCost = (totalCost * (i + 1)) / numThreads;
+            while( lastStart < numSkeletons && accumCost < targetCost )
+                accumCost += skeletons[lastStart++]->_getLodUpdateCost();
+
+            while( lastStart < numSkeletons && lastStart > 0 &&
                    skeletons[lastStart]->_getMemoryBlock() ==
                    skeletons[lastStart-1]->_getMemoryBlock() )
             {
-                ++lastStart;
+                accumCost += skeletons[lastStart++]->_getLodUpdateCost();
             }
         }
 
-        assert( threadStarts.back() <= skeletons.size() );
-        threadStarts.back() = skeletons.size();
+        assert( lastStart <= numSkeletons );
+        threadStarts.back() = numSkeletons;
+    }
+    //-----------------------------------------------------------------------
+    void BySkeletonDef::_updateLods(void)
+    {
+        FastArray<SkeletonInstance*>::iterator itor = skeletons.begin();
+        FastArray<SkeletonInstance*>::iterator end  = skeletons.end();
+
+        while( itor != end )
+        {
+            (*itor)->_updateLod();
+            ++itor;
+        }
+
+        updateThreadStarts();
     }
     //-----------------------------------------------------------------------
     void BySkeletonDef::_updateBoneStartTransforms(void)
     {
+        if( !bonePaletteBuffer.isNull() )
+            bonePaletteBuffer->_notifyLayoutChanged();
+
         FastArray<SkeletonInstance*>::iterator itor = skeletons.begin();
         FastArray<SkeletonInstance*>::iterator end  = skeletons.end();
 
@@ -182,4 +216,51 @@ namespace Ogre
         //Update the thread starts, they have changed.
         bySkelDef.updateThreadStarts();
     }
+    //-----------------------------------------------------------------------
+    BonePaletteBuffer* SkeletonAnimManager::getBonePaletteBuffer( const SkeletonDef *skeletonDef )
+    {
+        IdString defName( skeletonDef->getName() );
+        BySkeletonDefList::iterator itor = std::find( bySkeletonDefs.begin(), bySkeletonDefs.end(),
+                                                        defName );
+
+        if( itor == bySkeletonDefs.end() )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         "No SkeletonInstance has been created from '" + skeletonDef->getName() + "'",
+                         "SkeletonAnimManager::getBonePaletteBuffer" );
+        }
+
+        if( itor->bonePaletteBuffer.isNull() )
+        {
+            itor->bonePaletteBuffer = SharedPtr<BonePaletteBuffer>(
+                        OGRE_NEW BonePaletteBuffer( &itor->boneMemoryManager ) );
+        }
+
+        return itor->bonePaletteBuffer.get();
+    }
+    //-----------------------------------------------------------------------
+    void SkeletonAnimManager::_notifyBonePaletteBuffers(void)
+    {
+        BySkeletonDefList::iterator itor = bySkeletonDefs.begin();
+        BySkeletonDefList::iterator end  = bySkeletonDefs.end();
+
+        while( itor != end )
+        {
+            if( !itor->bonePaletteBuffer.isNull() )
+                itor->bonePaletteBuffer->_notifyTransformsChanged();
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------
+    void SkeletonAnimManager::_updateLods(void)
+    {
+        BySkeletonDefList::iterator itor = bySkeletonDefs.begin();
+        BySkeletonDefList::iterator end  = bySkeletonDefs.end();
+
+        while( itor != end )
+        {
+            itor->_updateLods();
+            ++itor;
+        }
+    }
 }
@@ -59,9 +59,10 @@ namespace Ogre
     {
         const FastArray<size_t> &slotStarts = *mSlotStarts;
 
-        mBoneWeights = RawSimdUniquePtr<ArrayReal, MEMCATEGORY_ANIMATION>( mDefinition->mTracks.size() );
-        ArrayReal *boneWeights = mBoneWeights.get();
-        Real *boneWeightsScalar = reinterpret_cast<Real*>( mBoneWeights.get() );
+        mBoneWeights = RawSimdUniquePtr<Real, MEMCATEGORY_ANIMATION>( mDefinition->mTracks.size() *
+                                                                      ARRAY_PACKED_REALS );
+        ArrayReal *boneWeights = reinterpret_cast<ArrayReal*>( mBoneWeights.get() );
+        Real *boneWeightsScalar = mBoneWeights.get();
 
         SkeletonTrackVec::const_iterator itor = mDefinition->mTracks.begin();
         SkeletonTrackVec::const_iterator end  = mDefinition->mTracks.end();
@@ -117,8 +118,7 @@ namespace Ogre
         {
             size_t level    = itor->second >> 24;
             size_t offset   = itor->second & 0x00FFFFFF;
-            Real *aliasedBoneWeights = reinterpret_cast<Real*>( mBoneWeights.get() ) +
-                                                offset + (*mSlotStarts)[level];
+            Real *aliasedBoneWeights = mBoneWeights.get() + offset + (*mSlotStarts)[level];
             *aliasedBoneWeights = weight;
         }
     }
@@ -132,8 +132,7 @@ namespace Ogre
         {
             size_t level    = itor->second >> 24;
             size_t offset   = itor->second & 0x00FFFFFF;
-            const Real *aliasedBoneWeights = reinterpret_cast<const Real*>( mBoneWeights.get() ) +
-                                                            offset + (*mSlotStarts)[level];
+            const Real *aliasedBoneWeights = mBoneWeights.get() + offset + (*mSlotStarts)[level];
             retVal = *aliasedBoneWeights;
         }
         return retVal;
@@ -148,7 +147,7 @@ namespace Ogre
         {
             size_t level    = itor->second >> 24;
             size_t offset   = itor->second & 0x00FFFFFF;
-            retVal = reinterpret_cast<Real*>( mBoneWeights.get() ) + offset + (*mSlotStarts)[level];
+            retVal = mBoneWeights.get() + offset + (*mSlotStarts)[level];
         }
 
         return retVal;
@@ -167,20 +166,38 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
-    void SkeletonAnimation::_applyAnimation( const TransformArray &boneTransforms )
+    void SkeletonAnimation::_applyAnimation( const TransformArray &boneTransforms,
+                                             size_t numDepthLevels, Real weight,
+                                             const ArrayReal *boneMask,
+                                             const FastArray<size_t> *levelBlockStarts )
     {
         SkeletonTrackVec::const_iterator itor = mDefinition->mTracks.begin();
         SkeletonTrackVec::const_iterator end  = mDefinition->mTracks.end();
 
         KnownKeyFramesVec::iterator itLastKnownKeyFrame = mLastKnownKeyFrames.begin();
 
-        ArrayReal simdWeight = Mathlib::SetAll( mWeight );
-        ArrayReal * RESTRICT_ALIAS boneWeights = mBoneWeights.get();
+        ArrayReal simdWeight = Mathlib::SetAll( mWeight * weight );
+        ArrayReal * RESTRICT_ALIAS boneWeights = reinterpret_cast<ArrayReal*>( mBoneWeights.get() );
 
         while( itor != end )
         {
-            itor->applyKeyFrameRigAt( *itLastKnownKeyFrame, mCurrentFrame, simdWeight,
-                                        boneWeights, boneTransforms );
+            const uint32 blockIdx = itor->getBoneBlockIdx();
+            const size_t level = blockIdx >> 24;
+            if( level < numDepthLevels )
+            {
+                if( !boneMask )
+                {
+                    itor->applyKeyFrameRigAt( *itLastKnownKeyFrame, mCurrentFrame, simdWeight,
+                                                boneWeights, boneTransforms );
+                }
+                else
+                {
+                    const ArrayReal maskedWeights = (*boneWeights) *
+                                boneMask[(*levelBlockStarts)[level] + (blockIdx & 0x00FFFFFF)];
+                    itor->applyKeyFrameRigAt( *itLastKnownKeyFrame, mCurrentFrame, simdWeight,
+                                                &maskedWeights, boneTransforms );
+                }
+            }
             ++itLastKnownKeyFrame;
             ++boneWeights;
             ++itor;
@@ -216,6 +216,48 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void SkeletonAnimationDef::compress( Real positionTolerance, Radian orientationTolerance,
+                                         Real scaleTolerance )
+    {
+        SkeletonTrackVec::iterator itor = mTracks.begin();
+        SkeletonTrackVec::iterator end  = mTracks.end();
+
+        while( itor != end )
+        {
+            itor->_compress( positionTolerance, orientationTolerance, scaleTolerance );
+            ++itor;
+        }
+
+        //No track uses the uncompressed keyframes anymore
+        if( mKfTransformMemoryManager )
+        {
+            mKfTransformMemoryManager->destroy();
+            delete mKfTransformMemoryManager;
+            mKfTransformMemoryManager = 0;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool SkeletonAnimationDef::isCompressed(void) const
+    {
+        return !mTracks.empty() && mTracks.front().isCompressed();
+    }
+    //-----------------------------------------------------------------------------------
+    size_t SkeletonAnimationDef::getKeyFrameMemoryUsage(void) const
+    {
+        size_t retVal = 0;
+
+        SkeletonTrackVec::const_iterator itor = mTracks.begin();
+        SkeletonTrackVec::const_iterator end  = mTracks.end();
+
+        while( itor != end )
+        {
+            retVal += itor->getKeyFrameMemoryUsage();
+            ++itor;
+        }
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
     void SkeletonAnimationDef::allocateCacheFriendlyKeyframes(
                                             const TimestampsPerBlock &timestampsByBlock, Real frameRate )
     {
@@ -371,22 +413,20 @@ namespace Ogre
                     outText += boneDef.name;
                     outText += ",";
 
-                    KeyFrameRigVec::const_iterator itKeyFrames = keyFrames.begin();
-                    KeyFrameRigVec::const_iterator enKeyFrames = keyFrames.end();
-
-                    while( itKeyFrames != enKeyFrames )
+                    for( size_t j=0; j<keyFrames.size(); ++j )
                     {
-                        outText += StringConverter::toString( itKeyFrames->mFrame );
+                        outText += StringConverter::toString( keyFrames[j].mFrame );
                         outText += ",";
 
-                        const KfTransform * RESTRICT_ALIAS boneTransform = itKeyFrames->mBoneTransform;
+                        KfTransform boneTransform;
+                        track.getKeyFrameTransform( j, boneTransform );
 
                         Vector3 vPos, vScale;
                         Quaternion qRot;
 
-                        boneTransform->mPosition.getAsVector3( vPos, i );
-                        boneTransform->mOrientation.getAsQuaternion( qRot, i );
-                        boneTransform->mScale.getAsVector3( vScale, i );
+                        boneTransform.mPosition.getAsVector3( vPos, i );
+                        boneTransform.mOrientation.getAsQuaternion( qRot, i );
+                        boneTransform.mScale.getAsVector3( vScale, i );
 
                         outText += StringConverter::toString( vPos.x ) + ",";
                         outText += StringConverter::toString( vPos.y ) + ",";
@@ -398,7 +438,6 @@ namespace Ogre
                         outText += StringConverter::toString( vScale.x ) + ",";
                         outText += StringConverter::toString( vScale.y ) + ",";
                         outText += StringConverter::toString( vScale.z ) + ",";
-                        ++itKeyFrames;
                     }
 
                     outText += "\n";
@@ -0,0 +1,508 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "Animation/OgreSkeletonAnimationLayer.h"
+#include "Animation/OgreSkeletonAnimation.h"
+#include "Animation/OgreSkeletonInstance.h"
+#include "Animation/OgreSkeletonDef.h"
+#include "Math/Array/OgreArrayKernels.h"
+
+#include "OgreException.h"
+
+namespace Ogre
+{
+    SkeletonBlendClip::SkeletonBlendClip( SkeletonAnimation *animation ) :
+        mAnimation( animation )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonBlendClip::addTime( Real time )
+    {
+        mAnimation->addTime( time );
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonBlendClip::_collectAnimations( Real weight, WeightedAnimationVec &outAnimations ) const
+    {
+        if( weight > 0 )
+            outAnimations.push_back( WeightedAnimation( mAnimation, weight ) );
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    SkeletonBlendSpace1D::SkeletonBlendSpace1D() :
+        mParameter( 0 )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonBlendSpace1D::addSample( SkeletonBlendNode *node, Real position )
+    {
+        SampleVec::iterator it = std::lower_bound( mSamples.begin(), mSamples.end(), position );
+        mSamples.insert( it, Sample( position, node ) );
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonBlendSpace1D::addTime( Real time )
+    {
+        SampleVec::const_iterator itor = mSamples.begin();
+        SampleVec::const_iterator end  = mSamples.end();
+
+        while( itor != end )
+        {
+            itor->node->addTime( time );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonBlendSpace1D::_collectAnimations( Real weight,
+                                                   WeightedAnimationVec &outAnimations ) const
+    {
+        if( mSamples.empty() )
+            return;
+
+        SampleVec::const_iterator next = std::lower_bound( mSamples.begin(), mSamples.end(),
+                                                           mParameter );
+
+        if( next == mSamples.begin() )
+        {
+            next->node->_collectAnimations( weight, outAnimations );
+        }
+        else if( next == mSamples.end() )
+        {
+            mSamples.back().node->_collectAnimations( weight, outAnimations );
+        }
+        else
+        {
+            SampleVec::const_iterator prev = next - 1;
+            const Real w = (mParameter - prev->position) / (next->position - prev->position);
+            prev->node->_collectAnimations( weight * (1.0f - w), outAnimations );
+            next->node->_collectAnimations( weight * w, outAnimations );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    size_t SkeletonBlendSpace1D::getMaxAnimations(void) const
+    {
+        //Only two neighbouring samples are blended at the same time
+        size_t maxPrev = 0;
+        size_t retVal = 0;
+
+        SampleVec::const_iterator itor = mSamples.begin();
+        SampleVec::const_iterator end  = mSamples.end();
+
+        while( itor != end )
+        {
+            const size_t maxAnimations = itor->node->getMaxAnimations();
+            retVal  = std::max( retVal, maxPrev + maxAnimations );
+            maxPrev = maxAnimations;
+            ++itor;
+        }
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    SkeletonBlendSpace2D::SkeletonBlendSpace2D() :
+        mParameter( Vector2::ZERO )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonBlendSpace2D::addSample( SkeletonBlendNode *node, const Vector2 &position )
+    {
+        mSamples.push_back( Sample( position, node ) );
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonBlendSpace2D::addTime( Real time )
+    {
+        SampleVec::const_iterator itor = mSamples.begin();
+        SampleVec::const_iterator end  = mSamples.end();
+
+        while( itor != end )
+        {
+            itor->node->addTime( time );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonBlendSpace2D::_collectAnimations( Real weight,
+                                                   WeightedAnimationVec &outAnimations ) const
+    {
+        Real totalWeight = 0;
+
+        SampleVec::const_iterator itor = mSamples.begin();
+        SampleVec::const_iterator end  = mSamples.end();
+
+        while( itor != end )
+        {
+            const Real sqDistance = itor->position.squaredDistance( mParameter );
+            if( sqDistance < 1e-6f )
+            {
+                itor->node->_collectAnimations( weight, outAnimations );
+                return;
+            }
+
+            totalWeight += 1.0f / sqDistance;
+            ++itor;
+        }
+
+        if( totalWeight <= 0 )
+            return;
+
+        const Real invTotalWeight = weight / totalWeight;
+
+        itor = mSamples.begin();
+        while( itor != end )
+        {
+            const Real sqDistance = itor->position.squaredDistance( mParameter );
+            itor->node->_collectAnimations( invTotalWeight / sqDistance, outAnimations );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    size_t SkeletonBlendSpace2D::getMaxAnimations(void) const
+    {
+        size_t retVal = 0;
+
+        SampleVec::const_iterator itor = mSamples.begin();
+        SampleVec::const_iterator end  = mSamples.end();
+
+        while( itor != end )
+        {
+            retVal += itor->node->getMaxAnimations();
+            ++itor;
+        }
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    SkeletonBlendStateMachine::SkeletonBlendStateMachine() :
+        mCurrentState( std::numeric_limits<size_t>::max() ),
+        mCrossfadeTime( 0 ),
+        mCrossfadeDuration( 0 )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    size_t SkeletonBlendStateMachine::findState( IdString name ) const
+    {
+        StateVec::const_iterator itor = std::find( mStates.begin(), mStates.end(), name );
+
+        if( itor == mStates.end() )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         "Can't find state '" + name.getFriendlyText() + "'",
+                         "SkeletonBlendStateMachine::findState" );
+        }
+
+        return itor - mStates.begin();
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonBlendStateMachine::addState( IdString name, SkeletonBlendNode *node )
+    {
+        if( std::find( mStates.begin(), mStates.end(), name ) != mStates.end() )
+        {
+            OGRE_EXCEPT( Exception::ERR_DUPLICATE_ITEM,
+                         "State '" + name.getFriendlyText() + "' already exists",
+                         "SkeletonBlendStateMachine::addState" );
+        }
+
+        const bool firstState = mStates.empty();
+        mStates.push_back( State( name, node, firstState ? 1.0f : 0.0f ) );
+
+        if( firstState )
+            mCurrentState = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    Real SkeletonBlendStateMachine::getStateWeight( size_t stateIdx ) const
+    {
+        //The current state fades in from its start weight, the rest fade out from theirs.
+        const Real w = isCrossfading() ? mCrossfadeTime / mCrossfadeDuration : 1.0f;
+        const Real startWeight = mStates[stateIdx].startWeight;
+
+        return stateIdx == mCurrentState ? startWeight + (1.0f - startWeight) * w :
+                                           startWeight * (1.0f - w);
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonBlendStateMachine::setState( IdString name )
+    {
+        mCurrentState       = findState( name );
+        mCrossfadeTime      = 0;
+        mCrossfadeDuration  = 0;
+
+        for( size_t i=0; i<mStates.size(); ++i )
+            mStates[i].startWeight = i == mCurrentState ? 1.0f : 0.0f;
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonBlendStateMachine::crossfadeTo( IdString name, Real duration )
+    {
+        const size_t newState = findState( name );
+
+        if( newState == mCurrentState )
+            return;
+
+        if( duration <= 0 )
+        {
+            setState( name );
+        }
+        else
+        {
+            //Start from wherever the previous crossfade (if any) was, so the pose doesn't jump
+            for( size_t i=0; i<mStates.size(); ++i )
+                mStates[i].startWeight = getStateWeight( i );
+
+            mCurrentState       = newState;
+            mCrossfadeTime      = 0;
+            mCrossfadeDuration  = duration;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    IdString SkeletonBlendStateMachine::getCurrentState(void) const
+    {
+        return mCurrentState < mStates.size() ? mStates[mCurrentState].name : IdString();
+    }
+    //-----------------------------------------------------------------------------------
+    bool SkeletonBlendStateMachine::isCrossfading(void) const
+    {
+        return mCrossfadeDuration > 0;
+    }
+    //-----------------------------------------------------------------------------------
+    Real SkeletonBlendStateMachine::getStateWeight( IdString name ) const
+    {
+        return getStateWeight( findState( name ) );
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonBlendStateMachine::addTime( Real time )
+    {
+        for( size_t i=0; i<mStates.size(); ++i )
+        {
+            if( i == mCurrentState || (isCrossfading() && mStates[i].startWeight > 0) )
+                mStates[i].node->addTime( time );
+        }
+
+        if( isCrossfading() )
+        {
+            mCrossfadeTime += time;
+            if( mCrossfadeTime >= mCrossfadeDuration )
+                setState( mStates[mCurrentState].name );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonBlendStateMachine::_collectAnimations( Real weight,
+                                                        WeightedAnimationVec &outAnimations ) const
+    {
+        if( mCurrentState >= mStates.size() )
+            return;
+
+        if( isCrossfading() )
+        {
+            for( size_t i=0; i<mStates.size(); ++i )
+            {
+                const Real stateWeight = getStateWeight( i );
+                if( stateWeight > 0 )
+                    mStates[i].node->_collectAnimations( weight * stateWeight, outAnimations );
+            }
+        }
+        else
+        {
+            mStates[mCurrentState].node->_collectAnimations( weight, outAnimations );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    size_t SkeletonBlendStateMachine::getMaxAnimations(void) const
+    {
+        size_t retVal = 0;
+        for( size_t i=0; i<mStates.size(); ++i )
+        {
+            if( i == mCurrentState || (isCrossfading() && mStates[i].startWeight > 0) )
+                retVal += mStates[i].node->getMaxAnimations();
+        }
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    SkeletonAnimationLayer::SkeletonAnimationLayer( IdString name, BlendMode blendMode,
+                                                    SkeletonInstance *owner ) :
+        mName( name ),
+        mBlendMode( blendMode ),
+        mWeight( 1.0f ),
+        mOwner( owner ),
+        mRootNode( 0 )
+    {
+        const SkeletonDef *skeletonDef = mOwner->getDefinition();
+        const size_t numDepthLevels = skeletonDef->getDepthLevelInfo().size();
+
+        mBoneMask = RawSimdUniquePtr<Real, MEMCATEGORY_ANIMATION>(
+                        skeletonDef->getNumberOfBoneBlocks( numDepthLevels ) * ARRAY_PACKED_REALS );
+        mOwner->_fillBoneMask( mBoneMask.get(), 1.0f );
+
+        mLevelBlockStarts.reserve( numDepthLevels );
+        for( size_t i=0; i<numDepthLevels; ++i )
+            mLevelBlockStarts.push_back( skeletonDef->getNumberOfBoneBlocks( i ) );
+    }
+    //-----------------------------------------------------------------------------------
+    SkeletonAnimationLayer::~SkeletonAnimationLayer()
+    {
+        SkeletonBlendNodeVec::const_iterator itor = mNodes.begin();
+        SkeletonBlendNodeVec::const_iterator end  = mNodes.end();
+
+        while( itor != end )
+        {
+            OGRE_DELETE *itor;
+            ++itor;
+        }
+
+        mNodes.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    template <typename T> T* SkeletonAnimationLayer::addNode( T *node )
+    {
+        mNodes.push_back( node );
+        return node;
+    }
+    //-----------------------------------------------------------------------------------
+    SkeletonBlendClip* SkeletonAnimationLayer::createClip( IdString animationName )
+    {
+        return addNode( OGRE_NEW SkeletonBlendClip( mOwner->getAnimation( animationName ) ) );
+    }
+    //-----------------------------------------------------------------------------------
+    SkeletonBlendSpace1D* SkeletonAnimationLayer::createBlendSpace1D(void)
+    {
+        return addNode( OGRE_NEW SkeletonBlendSpace1D() );
+    }
+    //-----------------------------------------------------------------------------------
+    SkeletonBlendSpace2D* SkeletonAnimationLayer::createBlendSpace2D(void)
+    {
+        return addNode( OGRE_NEW SkeletonBlendSpace2D() );
+    }
+    //-----------------------------------------------------------------------------------
+    SkeletonBlendStateMachine* SkeletonAnimationLayer::createStateMachine(void)
+    {
+        return addNode( OGRE_NEW SkeletonBlendStateMachine() );
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonAnimationLayer::setRootNode( SkeletonBlendNode *rootNode )
+    {
+        assert( (!rootNode || std::find( mNodes.begin(), mNodes.end(), rootNode ) != mNodes.end()) &&
+                "The node wasn't created by this layer!" );
+        mRootNode = rootNode;
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonAnimationLayer::addTime( Real time )
+    {
+        if( mRootNode )
+            mRootNode->addTime( time );
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonAnimationLayer::setBoneMask( IdString boneName, Real weight, bool includeChildren )
+    {
+        Real *boneMask = mBoneMask.get();
+
+        Bone *bone = mOwner->getBone( boneName );
+        boneMask[mOwner->_getBoneMaskIndex( bone )] = weight;
+
+        if( includeChildren )
+        {
+            const SkeletonDef::BoneDataVec &bones = mOwner->getDefinition()->getBones();
+            const size_t boneIdx = bone->mGlobalIndex;
+
+            for( size_t i=0; i<bones.size(); ++i )
+            {
+                size_t parentIdx = bones[i].parent;
+                while( parentIdx != std::numeric_limits<size_t>::max() && parentIdx != boneIdx )
+                    parentIdx = bones[parentIdx].parent;
+
+                if( parentIdx == boneIdx )
+                    boneMask[mOwner->_getBoneMaskIndex( mOwner->getBone( i ) )] = weight;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    Real SkeletonAnimationLayer::getBoneMask( IdString boneName ) const
+    {
+        const Real *boneMask = mBoneMask.get();
+        return boneMask[mOwner->_getBoneMaskIndex( mOwner->getBone( boneName ) )];
+    }
+    //-----------------------------------------------------------------------------------
+    size_t SkeletonAnimationLayer::getMaxAnimations(void) const
+    {
+        return mRootNode ? mRootNode->getMaxAnimations() : 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonAnimationLayer::_apply( const TransformArray &boneTransforms,
+                                         const TransformArray &layerPose, size_t numDepthLevels )
+    {
+        mWeightedAnimations.clear();
+
+        if( !mRootNode || mWeight <= 0 )
+            return;
+
+        mRootNode->_collectAnimations( 1.0f, mWeightedAnimations );
+
+        const ArrayReal *boneMask = reinterpret_cast<const ArrayReal*>( mBoneMask.get() );
+
+        WeightedAnimationVec::const_iterator itor = mWeightedAnimations.begin();
+        WeightedAnimationVec::const_iterator end  = mWeightedAnimations.end();
+
+        if( mBlendMode == BLEND_ADDITIVE )
+        {
+            while( itor != end )
+            {
+                itor->animation->_applyAnimation( boneTransforms, numDepthLevels,
+                                                  itor->weight * mWeight, boneMask,
+                                                  &mLevelBlockStarts );
+                ++itor;
+            }
+        }
+        else
+        {
+            while( itor != end )
+            {
+                itor->animation->_applyAnimation( layerPose, numDepthLevels, itor->weight, 0, 0 );
+                ++itor;
+            }
+
+            const SkeletonDef::DepthLevelInfoVec &depthLevelInfo =
+                                                    mOwner->getDefinition()->getDepthLevelInfo();
+            const ArrayReal simdWeight = Mathlib::SetAll( mWeight );
+            numDepthLevels = std::min( numDepthLevels, depthLevelInfo.size() );
+
+            for( size_t i=0; i<numDepthLevels; ++i )
+            {
+                const size_t numBlocks = (depthLevelInfo[i].numBonesInLevel + ARRAY_PACKED_REALS - 1) /
+                                            ARRAY_PACKED_REALS;
+                ArrayKernels::getImplementation()->blendPose( layerPose[i].mPosition,
+                                                              layerPose[i].mScale,
+                                                              layerPose[i].mOrientation,
+                                                              simdWeight,
+                                                              boneMask + mLevelBlockStarts[i],
+                                                              numBlocks,
+                                                              boneTransforms[i].mPosition,
+                                                              boneTransforms[i].mScale,
+                                                              boneTransforms[i].mOrientation );
+            }
+        }
+    }
+}
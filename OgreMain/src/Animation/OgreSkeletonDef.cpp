@@ -308,6 +308,39 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void SkeletonDef::compressAnimations( Real positionTolerance, Radian orientationTolerance,
+                                          Real scaleTolerance )
+    {
+        SkeletonAnimationDefVec::iterator itor = mAnimationDefs.begin();
+        SkeletonAnimationDefVec::iterator end  = mAnimationDefs.end();
+
+        while( itor != end )
+        {
+            itor->compress( positionTolerance, orientationTolerance, scaleTolerance );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonDef::setAnimationLods( const AnimationLodVec &lods )
+    {
+        AnimationLodVec::const_iterator itor = lods.begin();
+        AnimationLodVec::const_iterator end  = lods.end();
+
+        while( itor != end )
+        {
+            if( !itor->updateInterval || !itor->numDepthLevels )
+            {
+                OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                             "updateInterval and numDepthLevels must be greater than zero",
+                             "SkeletonDef::setAnimationLods" );
+            }
+
+            ++itor;
+        }
+
+        mAnimationLods = lods;
+    }
+    //-----------------------------------------------------------------------------------
     void SkeletonDef::getBonesPerDepth( vector<size_t>::type &out ) const
     {
         out.clear();
@@ -42,7 +42,12 @@ namespace Ogre
     SkeletonInstance::SkeletonInstance( const SkeletonDef *skeletonDef,
                                         BoneMemoryManager *boneMemoryManager ) :
             mDefinition( skeletonDef ),
-            mParentNode( 0 )
+            mParentNode( 0 ),
+            mLodSource( 0 ),
+            mLodFrameCount( 0 ),
+            mLodNumDepthLevels( skeletonDef->getDepthLevelInfo().size() ),
+            mLodAnimateThisFrame( true ),
+            mLodUpdateCost( skeletonDef->getNumberOfBoneBlocks( mLodNumDepthLevels ) )
     {
         mBones.resize( mDefinition->getBones().size(), Bone() );
 
@@ -84,9 +89,10 @@ namespace Ogre
             mSlotStarts.reserve( depthLevelInfo.size() );
             mBoneStartTransforms.reserve( depthLevelInfo.size() );
 
-            mManualBones = RawSimdUniquePtr<ArrayReal, MEMCATEGORY_ANIMATION>(
-                                mDefinition->getNumberOfBoneBlocks( depthLevelInfo.size() ) );
-            Real *manualBones = reinterpret_cast<Real*>( mManualBones.get() );
+            mManualBones = RawSimdUniquePtr<Real, MEMCATEGORY_ANIMATION>(
+                                mDefinition->getNumberOfBoneBlocks( depthLevelInfo.size() ) *
+                                ARRAY_PACKED_REALS );
+            Real *manualBones = mManualBones.get();
 
             // FIXME: manualBones could possibly be null. What to do?
 
@@ -181,10 +187,24 @@ namespace Ogre
             mAnimations.back().initialize();
             ++itor;
         }
+
+        if( !mBones.empty() )
+            mLodFrameCount = static_cast<uint32>( mBones[0].getId() );
     }
     //-----------------------------------------------------------------------------------
     SkeletonInstance::~SkeletonInstance()
     {
+        SkeletonAnimationLayerVec::const_iterator itLayer = mAnimationLayers.begin();
+        SkeletonAnimationLayerVec::const_iterator enLayer = mAnimationLayers.end();
+
+        while( itLayer != enLayer )
+        {
+            OGRE_DELETE *itLayer;
+            ++itLayer;
+        }
+
+        mAnimationLayers.clear();
+
         //Detach all bones in the reverse order they were attached (LIFO!!!)
         size_t currentDepth = mDefinition->mBonesPerDepth.size() - 1;
         vector<list<size_t>::type>::type::const_reverse_iterator ritDepth = mDefinition->mBonesPerDepth.rbegin();
@@ -221,7 +241,10 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void SkeletonInstance::update(void)
     {
-        if( !mActiveAnimations.empty() )
+        if( !mLodAnimateThisFrame )
+            return;
+
+        if( !mActiveAnimations.empty() || !mAnimationLayers.empty() )
             resetToPose();
 
         ActiveAnimationsVec::iterator itor = mActiveAnimations.begin();
@@ -229,15 +252,103 @@ namespace Ogre
 
         while( itor != end )
         {
-            (*itor)->_applyAnimation( mBoneStartTransforms );
+            (*itor)->_applyAnimation( mBoneStartTransforms, mLodNumDepthLevels, 1.0f, 0, 0 );
             ++itor;
         }
+
+        SkeletonAnimationLayerVec::iterator itLayer = mAnimationLayers.begin();
+        SkeletonAnimationLayerVec::iterator enLayer = mAnimationLayers.end();
+
+        while( itLayer != enLayer )
+        {
+            SkeletonAnimationLayer *layer = *itLayer;
+            if( layer->getRootNode() && layer->getWeight() > 0 )
+            {
+                if( layer->getBlendMode() == SkeletonAnimationLayer::BLEND_OVERRIDE )
+                    resetLayerPose();
+                layer->_apply( mBoneStartTransforms, mLayerPose, mLodNumDepthLevels );
+            }
+            ++itLayer;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonInstance::resetLayerPose(void)
+    {
+        KfTransform const * RESTRICT_ALIAS bindPose = mDefinition->getBindPose();
+        ArrayVector3 * RESTRICT_ALIAS positions         = mLayerPosePositions.get();
+        ArrayQuaternion * RESTRICT_ALIAS orientations   = mLayerPoseOrientations.get();
+        ArrayVector3 * RESTRICT_ALIAS scales            = mLayerPoseScales.get();
+
+        const size_t numBlocks = mLayerPosePositions.size();
+        for( size_t i=0; i<numBlocks; ++i )
+        {
+            positions[i]    = bindPose[i].mPosition;
+            orientations[i] = bindPose[i].mOrientation;
+            scales[i]       = bindPose[i].mScale;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonInstance::_updateLod(void)
+    {
+        const size_t numDepthLevels = mDefinition->getDepthLevelInfo().size();
+        uint32 updateInterval = 1;
+        mLodNumDepthLevels = numDepthLevels;
+
+        const SkeletonDef::AnimationLodVec &lods = mDefinition->getAnimationLods();
+        const LodStrategy *lodStrategy = mLodSource ? mLodSource->getCurrentLodStrategy() : 0;
+        if( lodStrategy && !lods.empty() )
+        {
+            //Transform the user values with the strategy that calculated the source's
+            //value; a different one (i.e. pixel count vs distance) is in another space.
+            const Real lodValue = mLodSource->getCurrentLodValue();
+            const SkeletonDef::AnimationLod *selectedLod = 0;
+
+            SkeletonDef::AnimationLodVec::const_iterator itor = lods.begin();
+            SkeletonDef::AnimationLodVec::const_iterator end  = lods.end();
+
+            while( itor != end && lodStrategy->transformUserValue( itor->lodValue ) <= lodValue )
+                selectedLod = &(*itor++);
+
+            if( selectedLod )
+            {
+                updateInterval      = selectedLod->updateInterval;
+                mLodNumDepthLevels  = std::min( selectedLod->numDepthLevels, numDepthLevels );
+            }
+        }
+
+        ++mLodFrameCount;
+        mLodAnimateThisFrame = (!mActiveAnimations.empty() || !mAnimationLayers.empty()) &&
+                                !(mLodFrameCount % updateInterval);
+
+        //The derived transforms of all bones are updated every frame, the
+        //animations only in the frames we animate and up to the LOD's depth.
+        mLodUpdateCost = mDefinition->getNumberOfBoneBlocks( numDepthLevels );
+        if( mLodAnimateThisFrame )
+        {
+            size_t numAnimations = mActiveAnimations.size();
+
+            SkeletonAnimationLayerVec::const_iterator itLayer = mAnimationLayers.begin();
+            SkeletonAnimationLayerVec::const_iterator enLayer = mAnimationLayers.end();
+
+            while( itLayer != enLayer )
+            {
+                //Override layers also reset and blend their temporary pose
+                numAnimations += (*itLayer)->getMaxAnimations();
+                if( (*itLayer)->getBlendMode() == SkeletonAnimationLayer::BLEND_OVERRIDE )
+                    numAnimations += 2;
+                ++itLayer;
+            }
+
+            mLodUpdateCost += numAnimations *
+                                mDefinition->getNumberOfBoneBlocks( mLodNumDepthLevels );
+        }
     }
     //-----------------------------------------------------------------------------------
     void SkeletonInstance::resetToPose(void)
     {
         KfTransform const * RESTRICT_ALIAS bindPose = mDefinition->getBindPose();
-        ArrayReal const * RESTRICT_ALIAS manualBones = mManualBones.get();
+        ArrayReal const * RESTRICT_ALIAS manualBones =
+                                        reinterpret_cast<const ArrayReal*>( mManualBones.get() );
 
         SkeletonDef::DepthLevelInfoVec::const_iterator itDepthLevelInfo =
                                                 mDefinition->getDepthLevelInfo().begin();
@@ -279,7 +390,7 @@ namespace Ogre
         Bone &firstBone = mBones[mDefinition->getDepthLevelInfo()[depthLevel].firstBoneIndex];
 
         uintptr_t diff = bone->_getTransform().mOwner - firstBone._getTransform().mOwner;
-        Real *manualBones = reinterpret_cast<Real*>( mManualBones.get() );
+        Real *manualBones = mManualBones.get();
         manualBones[diff] = isManual ? 1.0f : 0.0f;
     }
     //-----------------------------------------------------------------------------------
@@ -291,7 +402,7 @@ namespace Ogre
         Bone &firstBone = mBones[mDefinition->getDepthLevelInfo()[depthLevel].firstBoneIndex];
 
         uintptr_t diff = bone->_getTransform().mOwner - firstBone._getTransform().mOwner;
-        const Real *manualBones = reinterpret_cast<const Real*>( mManualBones.get() );
+        const Real *manualBones = mManualBones.get();
         return manualBones[diff] != 0.0f;
     }
     //-----------------------------------------------------------------------------------
@@ -361,6 +472,120 @@ namespace Ogre
             efficientVectorRemove( mActiveAnimations, it );
     }
     //-----------------------------------------------------------------------------------
+    SkeletonAnimationLayer* SkeletonInstance::createAnimationLayer(
+                                        IdString name, SkeletonAnimationLayer::BlendMode blendMode )
+    {
+        SkeletonAnimationLayerVec::const_iterator itor = mAnimationLayers.begin();
+        SkeletonAnimationLayerVec::const_iterator end  = mAnimationLayers.end();
+
+        while( itor != end )
+        {
+            if( (*itor)->getName() == name )
+            {
+                OGRE_EXCEPT( Exception::ERR_DUPLICATE_ITEM,
+                             "An animation layer named '" + name.getFriendlyText() +
+                             "' already exists", "SkeletonInstance::createAnimationLayer" );
+            }
+            ++itor;
+        }
+
+        if( blendMode == SkeletonAnimationLayer::BLEND_OVERRIDE && mLayerPose.empty() )
+        {
+            const SkeletonDef::DepthLevelInfoVec &depthLevelInfo = mDefinition->getDepthLevelInfo();
+            const size_t numBlocks = mDefinition->getNumberOfBoneBlocks( depthLevelInfo.size() );
+
+            mLayerPosePositions = RawSimdUniquePtr<ArrayVector3, MEMCATEGORY_ANIMATION>( numBlocks );
+            mLayerPoseOrientations =
+                    RawSimdUniquePtr<ArrayQuaternion, MEMCATEGORY_ANIMATION>( numBlocks );
+            mLayerPoseScales = RawSimdUniquePtr<ArrayVector3, MEMCATEGORY_ANIMATION>( numBlocks );
+
+            mLayerPose.reserve( depthLevelInfo.size() );
+            for( size_t i=0; i<depthLevelInfo.size(); ++i )
+            {
+                const size_t firstBlock = mDefinition->getNumberOfBoneBlocks( i );
+                BoneTransform t;
+                t.mIndex        = mBoneStartTransforms[i].mIndex;
+                t.mPosition     = mLayerPosePositions.get() + firstBlock;
+                t.mOrientation  = mLayerPoseOrientations.get() + firstBlock;
+                t.mScale        = mLayerPoseScales.get() + firstBlock;
+                mLayerPose.push_back( t );
+            }
+        }
+
+        SkeletonAnimationLayer *layer = OGRE_NEW SkeletonAnimationLayer( name, blendMode, this );
+        mAnimationLayers.push_back( layer );
+        return layer;
+    }
+    //-----------------------------------------------------------------------------------
+    SkeletonAnimationLayer* SkeletonInstance::getAnimationLayer( IdString name )
+    {
+        SkeletonAnimationLayerVec::const_iterator itor = mAnimationLayers.begin();
+        SkeletonAnimationLayerVec::const_iterator end  = mAnimationLayers.end();
+
+        while( itor != end )
+        {
+            if( (*itor)->getName() == name )
+                return *itor;
+            ++itor;
+        }
+
+        OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                     "Can't find animation layer '" + name.getFriendlyText() + "'",
+                     "SkeletonInstance::getAnimationLayer" );
+        return 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonInstance::destroyAnimationLayer( SkeletonAnimationLayer *layer )
+    {
+        SkeletonAnimationLayerVec::iterator it = std::find( mAnimationLayers.begin(),
+                                                            mAnimationLayers.end(), layer );
+        if( it == mAnimationLayers.end() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "The animation layer doesn't belong to this SkeletonInstance",
+                         "SkeletonInstance::destroyAnimationLayer" );
+        }
+
+        //Keep the order, it defines how the layers are combined
+        mAnimationLayers.erase( it );
+        OGRE_DELETE layer;
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonInstance::_fillBoneMask( Real *outMask, Real value ) const
+    {
+        Real *mask = outMask;
+
+        const SkeletonDef::DepthLevelInfoVec &depthLevelInfo = mDefinition->getDepthLevelInfo();
+        for( size_t i=0; i<depthLevelInfo.size(); ++i )
+        {
+            size_t slotStart = mSlotStarts[i];
+            size_t numBonesInLevel = depthLevelInfo[i].numBonesInLevel;
+            size_t remainder = (slotStart + numBonesInLevel) % ARRAY_PACKED_REALS;
+
+            for( size_t j=0; j<slotStart; ++j )
+                *mask++ = 0.0f;
+            for( size_t j=0; j<numBonesInLevel; ++j )
+                *mask++ = value;
+            if( remainder != 0 )
+            {
+                for( size_t j=0; j<ARRAY_PACKED_REALS - remainder; ++j )
+                    *mask++ = 0.0f;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    size_t SkeletonInstance::_getBoneMaskIndex( Bone *bone ) const
+    {
+        assert( &mBones[bone->mGlobalIndex] == bone && "The bone doesn't belong to this instance!" );
+
+        const uint16 depthLevel = bone->getDepthLevel();
+        const BoneTransform &firstTransform = mBoneStartTransforms[depthLevel];
+        const BoneTransform &boneTransform  = bone->_getTransform();
+
+        return mDefinition->getNumberOfBoneBlocks( depthLevel ) * ARRAY_PACKED_REALS +
+                (boneTransform.mOwner - firstTransform.mOwner) + boneTransform.mIndex;
+    }
+    //-----------------------------------------------------------------------------------
     void SkeletonInstance::setParentNode( Node *parentNode )
     {
         mParentNode = parentNode;
@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "Math/Array/OgreMathlib.h"
 #include "Math/Array/OgreBoneTransform.h"
 #include "Math/Array/OgreKfTransformArrayMemoryManager.h"
+#include "Math/Array/OgreArrayKernels.h"
 
 #include "OgreException.h"
 
@@ -128,34 +129,35 @@ namespace Ogre
         getKeyFrameRigAt( prevFrame, nextFrame, frame );
 
         const Real scalarW = (frame - prevFrame->mFrame) * prevFrame->mInvNextFrameDistance;
-        ArrayReal fTimeW = Mathlib::SetAll( scalarW );
 
         size_t level    = mBoneBlockIdx >> 24;
         size_t offset   = mBoneBlockIdx & 0x00FFFFFF;
 
-        ArrayVector3 * RESTRICT_ALIAS finalPos      = boneTransforms[level].mPosition + offset;
-        ArrayVector3 * RESTRICT_ALIAS finalScale    = boneTransforms[level].mScale + offset;
-        ArrayQuaternion * RESTRICT_ALIAS finalRot   = boneTransforms[level].mOrientation + offset;
-
-        KfTransform * RESTRICT_ALIAS prevTransf = prevFrame->mBoneTransform;
-        KfTransform * RESTRICT_ALIAS nextTransf = nextFrame->mBoneTransform;
-
-        ArrayVector3 interpPos, interpScale;
-        ArrayQuaternion interpRot;
-        //Interpolate keyframes' rotation not using shortestPath to respect the original animation
-        interpPos   = Math::lerp( prevTransf->mPosition, nextTransf->mPosition, fTimeW );
-        interpRot   = ArrayQuaternion::nlerp( fTimeW, prevTransf->mOrientation,
-                                                        nextTransf->mOrientation );
-        interpScale = Math::lerp( prevTransf->mScale, nextTransf->mScale, fTimeW );
-
-        //Combine our internal flag (that prevents blending
-        //unanimated bones) with user's custom weights
-        ArrayReal fW = (*perBoneWeights) * animWeight;
+        if( isCompressed() )
+        {
+            const uint16 *compressedKeyFrames = &mCompressedKeyFrames[0];
+            const size_t prevIdx = prevFrame - mKeyFrameRigs.begin();
+            const size_t nextIdx = nextFrame - mKeyFrameRigs.begin();
 
-        //When mixing, also interpolate rotation not using shortest path; as this is usually desired
-        *finalPos   += interpPos * fW;
-        *finalScale *= Math::lerp( ArrayVector3::UNIT_SCALE, interpScale, fW );
-        *finalRot   = (*finalRot) * ArrayQuaternion::nlerp( fW, ArrayQuaternion::IDENTITY, interpRot );
+            ArrayKernels::getImplementation()->blendCompressedKeyFrameRig(
+                                            compressedKeyFrames + prevIdx * OGRE_KF_TRANSFORM_NUM_REALS,
+                                            compressedKeyFrames + nextIdx * OGRE_KF_TRANSFORM_NUM_REALS,
+                                            &mQuantization[0],
+                                            &mQuantization[OGRE_KF_TRANSFORM_NUM_REALS],
+                                            scalarW, animWeight, perBoneWeights,
+                                            boneTransforms[level].mPosition + offset,
+                                            boneTransforms[level].mScale + offset,
+                                            boneTransforms[level].mOrientation + offset );
+        }
+        else
+        {
+            ArrayKernels::getImplementation()->blendKeyFrameRig( prevFrame->mBoneTransform,
+                                                                 nextFrame->mBoneTransform,
+                                                                 scalarW, animWeight, perBoneWeights,
+                                                                 boneTransforms[level].mPosition + offset,
+                                                                 boneTransforms[level].mScale + offset,
+                                                                 boneTransforms[level].mOrientation + offset );
+        }
 
         inOutLastKnownKeyFrameRig = prevFrame;
     }
@@ -189,4 +191,177 @@ namespace Ogre
             }
         }
     }
+    //-----------------------------------------------------------------------------------
+    bool SkeletonTrack::canInterpolate( size_t first, size_t last, Real positionTolerance,
+                                        Radian orientationTolerance, Real scaleTolerance ) const
+    {
+        const KeyFrameRig &keyFrameA = mKeyFrameRigs[first];
+        const KeyFrameRig &keyFrameB = mKeyFrameRigs[last];
+
+        //KfTransform is OGRE_KF_TRANSFORM_NUM_REALS consecutive Reals:
+        //3 chunks of position, 4 of orientation and 3 of scale.
+        const Real * RESTRICT_ALIAS a = reinterpret_cast<const Real*>( keyFrameA.mBoneTransform );
+        const Real * RESTRICT_ALIAS b = reinterpret_cast<const Real*>( keyFrameB.mBoneTransform );
+
+        const Real sqPositionTolerance  = positionTolerance * positionTolerance;
+        //Two unit quaternions are within the angle if |dot| >= cos( angle / 2 )
+        const Real cosHalfOrientationTol= Math::Cos( orientationTolerance * 0.5f );
+
+        bool retVal = true;
+
+        for( size_t k=first+1; k<last && retVal; ++k )
+        {
+            const Real * RESTRICT_ALIAS v = reinterpret_cast<const Real*>(
+                                                        mKeyFrameRigs[k].mBoneTransform );
+            const Real t = (mKeyFrameRigs[k].mFrame - keyFrameA.mFrame) /
+                            (keyFrameB.mFrame - keyFrameA.mFrame);
+
+            for( size_t slot=0; slot<ARRAY_PACKED_REALS && retVal; ++slot )
+            {
+                Real sqDistance = 0;
+                for( size_t i=0; i<3; ++i )
+                {
+                    const size_t idx = i * ARRAY_PACKED_REALS + slot;
+                    const Real diff = a[idx] + (b[idx] - a[idx]) * t - v[idx];
+                    sqDistance += diff * diff;
+                }
+
+                //Same as the keyframe blending: nlerp without taking the shortest path
+                Real dot = 0, interpSqLength = 0, sqLength = 0;
+                for( size_t i=3; i<7; ++i )
+                {
+                    const size_t idx = i * ARRAY_PACKED_REALS + slot;
+                    const Real interp = a[idx] + (b[idx] - a[idx]) * t;
+                    dot             += interp * v[idx];
+                    interpSqLength  += interp * interp;
+                    sqLength        += v[idx] * v[idx];
+                }
+
+                Real scaleDiff = 0;
+                for( size_t i=7; i<10; ++i )
+                {
+                    const size_t idx = i * ARRAY_PACKED_REALS + slot;
+                    scaleDiff = std::max( scaleDiff,
+                                          Math::Abs( a[idx] + (b[idx] - a[idx]) * t - v[idx] ) );
+                }
+
+                retVal = sqDistance <= sqPositionTolerance &&
+                         Math::Abs( dot ) >= cosHalfOrientationTol *
+                                             Math::Sqrt( interpSqLength * sqLength ) &&
+                         scaleDiff <= scaleTolerance;
+            }
+        }
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonTrack::_compress( Real positionTolerance, Radian orientationTolerance,
+                                   Real scaleTolerance )
+    {
+        if( isCompressed() || mKeyFrameRigs.empty() )
+            return;
+
+        //Key reduction: Extend the interpolated range [first; last] until a keyframe
+        //in between can't be reproduced anymore, then start again from the previous one.
+        KeyFrameRigVec keptKeyFrames;
+        keptKeyFrames.reserve( mKeyFrameRigs.size() );
+        keptKeyFrames.push_back( mKeyFrameRigs.front() );
+
+        size_t first = 0;
+        for( size_t last=2; last<mKeyFrameRigs.size(); ++last )
+        {
+            if( !canInterpolate( first, last, positionTolerance,
+                                 orientationTolerance, scaleTolerance ) )
+            {
+                first = last - 1;
+                keptKeyFrames.push_back( mKeyFrameRigs[first] );
+            }
+        }
+
+        if( mKeyFrameRigs.size() > 1 )
+            keptKeyFrames.push_back( mKeyFrameRigs.back() );
+
+        for( size_t i=0; i<keptKeyFrames.size() - 1; ++i )
+        {
+            keptKeyFrames[i].mInvNextFrameDistance = 1.0f / (keptKeyFrames[i+1].mFrame -
+                                                             keptKeyFrames[i].mFrame);
+        }
+        keptKeyFrames.back().mInvNextFrameDistance = 1.0f;
+
+        //Quantization: each component gets the range of values it takes along the track
+        const size_t numKeyFrames = keptKeyFrames.size();
+        mQuantization.resize( 2 * OGRE_KF_TRANSFORM_NUM_REALS );
+        mCompressedKeyFrames.resize( numKeyFrames * OGRE_KF_TRANSFORM_NUM_REALS );
+
+        Real *minimums  = &mQuantization[0];
+        Real *steps     = &mQuantization[OGRE_KF_TRANSFORM_NUM_REALS];
+
+        for( size_t i=0; i<OGRE_KF_TRANSFORM_NUM_REALS; ++i )
+        {
+            Real minValue = std::numeric_limits<Real>::max();
+            Real maxValue = -std::numeric_limits<Real>::max();
+
+            for( size_t k=0; k<numKeyFrames; ++k )
+            {
+                const Real value = reinterpret_cast<const Real*>(
+                                                    keptKeyFrames[k].mBoneTransform )[i];
+                minValue = std::min( minValue, value );
+                maxValue = std::max( maxValue, value );
+            }
+
+            minimums[i] = minValue;
+            steps[i]    = (maxValue - minValue) / 65535.0f;
+
+            for( size_t k=0; k<numKeyFrames; ++k )
+            {
+                const Real value = reinterpret_cast<const Real*>(
+                                                    keptKeyFrames[k].mBoneTransform )[i];
+                Real quantized = 0;
+                if( steps[i] > 0 )
+                    quantized = std::min( (value - minValue) / steps[i] + 0.5f, 65535.0f );
+                mCompressedKeyFrames[k * OGRE_KF_TRANSFORM_NUM_REALS + i] =
+                                                            static_cast<uint16>( quantized );
+            }
+        }
+
+        //The transforms belong to the memory manager, which can now be destroyed
+        for( size_t k=0; k<numKeyFrames; ++k )
+            keptKeyFrames[k].mBoneTransform = 0;
+
+        mKeyFrameRigs.swap( keptKeyFrames );
+    }
+    //-----------------------------------------------------------------------------------
+    size_t SkeletonTrack::getKeyFrameMemoryUsage(void) const
+    {
+        size_t retVal;
+        if( isCompressed() )
+        {
+            retVal = mCompressedKeyFrames.size() * sizeof( uint16 ) +
+                     mQuantization.size() * sizeof( Real );
+        }
+        else
+        {
+            retVal = mKeyFrameRigs.size() * sizeof( KfTransform );
+        }
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonTrack::getKeyFrameTransform( size_t keyFrameIdx, KfTransform &outTransform ) const
+    {
+        if( isCompressed() )
+        {
+            const uint16 *quantized = &mCompressedKeyFrames[keyFrameIdx * OGRE_KF_TRANSFORM_NUM_REALS];
+            const Real *minimums    = &mQuantization[0];
+            const Real *steps       = &mQuantization[OGRE_KF_TRANSFORM_NUM_REALS];
+
+            Real *dst = reinterpret_cast<Real*>( &outTransform );
+            for( size_t i=0; i<OGRE_KF_TRANSFORM_NUM_REALS; ++i )
+                dst[i] = minimums[i] + steps[i] * static_cast<Real>( quantized[i] );
+        }
+        else
+        {
+            outTransform = *mKeyFrameRigs[keyFrameIdx].mBoneTransform;
+        }
+    }
 }
@@ -402,6 +402,16 @@ namespace Ogre
 
             ++itor;
         }
+
+        //Let consecutive scene passes cull ahead of time. @See SceneManager::setCullPrefetch
+        for( size_t i=1; i<mPasses.size(); ++i )
+        {
+            if( mPasses[i-1]->getType() == PASS_SCENE && mPasses[i]->getType() == PASS_SCENE )
+            {
+                static_cast<CompositorPassScene*>( mPasses[i-1] )->_setNextPassScene(
+                            static_cast<CompositorPassScene*>( mPasses[i] ) );
+            }
+        }
     }
     //-----------------------------------------------------------------------------------
     void CompositorNode::_update( const Camera *lodCamera, SceneManager *sceneManager )
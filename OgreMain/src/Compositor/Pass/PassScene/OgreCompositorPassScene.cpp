@@ -57,7 +57,8 @@ namespace Ogre
                 mShadowNode( 0 ),
                 mCamera( 0 ),
                 mLodCamera( 0 ),
-                mUpdateShadowNode( false )
+                mUpdateShadowNode( false ),
+                mNextPassScene( 0 )
     {
         CompositorWorkspace *workspace = parentNode->getWorkspace();
 
@@ -160,6 +161,11 @@ namespace Ogre
             mTarget->_beginUpdate();
         }
 
+        //Start culling the next pass while we render. A listener could
+        //change anything in between, so we can't do it if there's one.
+        if( mNextPassScene && !listener )
+            mNextPassScene->_scheduleCullPrefetch( lodCamera );
+
         mTarget->setFsaaResolveDirty();
         mTarget->_updateViewportRenderPhase02( mViewport, mCamera, usedLodCamera,
                                                mDefinition->mFirstRQ, mDefinition->mLastRQ, true );
@@ -178,6 +184,26 @@ namespace Ogre
             mTarget->_endUpdate();
     }
     //-----------------------------------------------------------------------------------
+    void CompositorPassScene::_scheduleCullPrefetch( const Camera *lodCamera )
+    {
+        if( mNumPassesLeft == 0 || mDefinition->mCameraCubemapReorient )
+            return;
+
+        //Viewport::_updateCullPhase01 would change the aspect ratio
+        const Real aspectRatio = (Real)mViewport->getActualWidth() / (Real)mViewport->getActualHeight();
+        if( mCamera->getAutoAspectRatio() && mCamera->getAspectRatio() != aspectRatio )
+            return;
+
+        Camera const *usedLodCamera = mLodCamera;
+        if( lodCamera && mCamera == mLodCamera )
+            usedLodCamera = lodCamera;
+
+        mCamera->getSceneManager()->_scheduleCullPrefetch( mCamera, usedLodCamera,
+                                                           mDefinition->mVisibilityMask,
+                                                           mDefinition->mFirstRQ,
+                                                           mDefinition->mLastRQ );
+    }
+    //-----------------------------------------------------------------------------------
     void CompositorPassScene::notifyCleared(void)
     {
         mShadowNode = 0; //Allow changes to our shadow nodes too.
@@ -0,0 +1,121 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include <OgreStableHeaders.h>
+
+#include "OgrePlatformInformation.h"
+
+#if __OGRE_HAVE_AVX2
+#define __Mathlib_H__ //Neded to directly include OgreMathlibAVX2
+
+#include "Math/Array/OgreArrayConfig.h"
+#include "Math/Array/AVX2/Single/OgreMathlibAVX2.h"
+#include "Math/Array/AVX2/Single/avx_mathfun.h"
+#include "Math/Array/OgreBooleanMask.h"
+
+namespace Ogre
+{
+    const ArrayReal MathlibAVX2::HALF       = _mm256_set1_ps( 0.5f );
+    const ArrayReal MathlibAVX2::ONE        = _mm256_set1_ps( 1.0f );
+    const ArrayReal MathlibAVX2::THREE      = _mm256_set1_ps( 3.0f );
+    const ArrayReal MathlibAVX2::NEG_ONE    = _mm256_set1_ps( -1.0f );
+    const ArrayReal MathlibAVX2::fEpsilon   = _mm256_set1_ps( 1e-6f );
+    const ArrayReal MathlibAVX2::fSqEpsilon = _mm256_set1_ps( 1e-12f );
+    const ArrayReal MathlibAVX2::OneMinusEpsilon= _mm256_set1_ps( 1.0f - 1e-6f );
+    const ArrayReal MathlibAVX2::FLOAT_MIN  = _mm256_set1_ps( std::numeric_limits<Real>::min() );
+    const ArrayReal MathlibAVX2::SIGN_MASK  = _mm256_set1_ps( -0.0f );
+    const ArrayReal MathlibAVX2::INFINITEA  = _mm256_set1_ps( std::numeric_limits<Real>::infinity() );
+    const ArrayReal MathlibAVX2::MAX_NEG    = _mm256_set1_ps( -std::numeric_limits<Real>::max() );
+    const ArrayReal MathlibAVX2::MAX_POS    = _mm256_set1_ps( std::numeric_limits<Real>::max() );
+    const ArrayReal MathlibAVX2::LAST_AFFINE_COLUMN = _mm256_setr_ps( 0, 0, 0, 1, 0, 0, 0, 1 );
+
+    static const Real _PI = Real( 4.0 * atan( 1.0 ) );
+    //We can't use Math::fDeg2Rad & Math::fRad2Deg directly because
+    //it's not guaranteed to have been initialized first
+    const ArrayReal MathlibAVX2::PI         = _mm256_set1_ps( _PI );
+    const ArrayReal MathlibAVX2::TWO_PI     = _mm256_set1_ps( 2.0f * _PI );
+    const ArrayReal MathlibAVX2::fDeg2Rad   = _mm256_set1_ps( _PI / 180.0f );
+    const ArrayReal MathlibAVX2::fRad2Deg   = _mm256_set1_ps( 180.0f / _PI );
+
+    const ArrayReal MathlibAVX2::ONE_DIV_2PI= _mm256_set1_ps( 1.0f / (2.0f * _PI) );
+
+    //-----------------------------------------------------------------------------------
+    ArrayReal MathlibAVX2::Sin4( ArrayReal x )
+    {
+        // Map arbitrary angle x to the range [-pi; +pi] without using division.
+        // Code taken from MSDN's HLSL trick. Architectures with fused mad (i.e. NEON)
+        // can replace the add, the sub, & the two muls for two mad
+        ArrayReal integralPart;
+        x = _mm256_add_ps( _mm256_mul_ps( x, ONE_DIV_2PI ), HALF );
+        x = Modf4( x, integralPart );
+        x = _mm256_sub_ps( _mm256_mul_ps( x, TWO_PI ), PI );
+
+        return sin256_ps( x );
+    }
+    //-----------------------------------------------------------------------------------
+    ArrayReal MathlibAVX2::Cos4( ArrayReal x )
+    {
+        // Map arbitrary angle x to the range [-pi; +pi] without using division.
+        // Code taken from MSDN's HLSL trick. Architectures with fused mad (i.e. NEON)
+        // can replace the add, the sub, & the two muls for two mad
+        ArrayReal integralPart;
+        x = _mm256_add_ps( _mm256_mul_ps( x, ONE_DIV_2PI ), HALF );
+        x = Modf4( x, integralPart );
+        x = _mm256_sub_ps( _mm256_mul_ps( x, TWO_PI ), PI );
+
+        return cos256_ps( x );
+    }
+    //-----------------------------------------------------------------------------------
+    void MathlibAVX2::SinCos4( ArrayReal x, ArrayReal &outSin, ArrayReal &outCos )
+    {
+        // TODO: Improve accuracy by mapping to the range [-pi/4, pi/4] and swap
+        // between cos & sin depending on which quadrant it fell:
+        // Quadrant | sin     |  cos
+        // n = 0 ->  sin( x ),  cos( x )
+        // n = 1 ->  cos( x ), -sin( x )
+        // n = 2 -> -sin( x ), -cos( x )
+        // n = 3 -> -sin( x ),  sin( x )
+        // See ARGUMENT REDUCTION FOR HUGE ARGUMENTS:
+        // Good to the Last Bit
+        // K. C. Ng and themembers of the FP group of SunPro
+        // http://www.derekroconnor.net/Software/Ng--ArgReduction.pdf
+
+        // -- Perhaps we can leave this to GSoC students? --
+
+        // Map arbitrary angle x to the range [-pi; +pi] without using division.
+        // Code taken from MSDN's HLSL trick. Architectures with fused mad (i.e. NEON)
+        // can replace the add, the sub, & the two muls for two mad
+        ArrayReal integralPart;
+        x = _mm256_add_ps( _mm256_mul_ps( x, ONE_DIV_2PI ), HALF );
+        x = Modf4( x, integralPart );
+        x = _mm256_sub_ps( _mm256_mul_ps( x, TWO_PI ), PI );
+
+        sincos256_ps( x, &outSin, &outCos );
+    }
+}
+#endif
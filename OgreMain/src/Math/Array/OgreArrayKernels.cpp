@@ -0,0 +1,135 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+
+#include "Math/Array/OgreArrayKernels.h"
+
+#include "OgreNode.h"
+#include "OgreCamera.h"
+#include "OgreLight.h"
+#include "OgrePlatformInformation.h"
+#include "OgreRawPtr.h"
+#include "Math/Array/OgreArraySphere.h"
+#include "Math/Array/OgreBooleanMask.h"
+
+//The AVX2 variant re-encodes the 4-wide kernels with VEX prefixes & lets the compiler
+//fuse multiply-adds. It's only worth it (and only needed) when the rest of the build
+//targets plain SSE2; an OGRE_SIMD_AVX2 build already runs 8-wide everywhere.
+//MSVC can't change the target ISA per function, so it always uses the generic variant.
+#if __OGRE_HAVE_SSE && !__OGRE_HAVE_AVX2 && \
+    ( OGRE_COMPILER == OGRE_COMPILER_GNUC || OGRE_COMPILER == OGRE_COMPILER_CLANG )
+    #define OGRE_ARRAY_KERNELS_AVX2 1
+#else
+    #define OGRE_ARRAY_KERNELS_AVX2 0
+#endif
+
+namespace Ogre
+{
+    namespace ArrayKernelsGeneric
+    {
+        using namespace VisibilityFlags;
+        #include "OgreArrayKernels.inl"
+    }
+
+#if OGRE_ARRAY_KERNELS_AVX2
+    //Everything defined until here (including all the inline functions from the headers)
+    //keeps the baseline target, so nothing emitted outside of the namespace below can
+    //contain AVX instructions. The compiler is still allowed to inline those functions
+    //into the kernels.
+    #if OGRE_COMPILER == OGRE_COMPILER_CLANG
+        #pragma clang attribute push( __attribute__((target("avx2,fma"))), apply_to = function )
+    #else
+        #pragma GCC push_options
+        #pragma GCC target( "avx2,fma" )
+    #endif
+
+    namespace ArrayKernelsAVX2
+    {
+        using namespace VisibilityFlags;
+        #include "OgreArrayKernels.inl"
+    }
+
+    #if OGRE_COMPILER == OGRE_COMPILER_CLANG
+        #pragma clang attribute pop
+    #else
+        #pragma GCC pop_options
+    #endif
+#endif
+
+    static const ArrayKernels c_arrayKernelsGeneric =
+    {
+#if OGRE_USE_SIMD == 0
+        "C",
+#elif __OGRE_HAVE_AVX2
+        "AVX2 + FMA3 (8-wide)",
+#elif __OGRE_HAVE_SSE
+        "SSE2",
+#elif __OGRE_HAVE_NEON
+        "NEON",
+#else
+        "Generic",
+#endif
+        ArrayKernelsGeneric::updateAllTransforms,
+        ArrayKernelsGeneric::updateAllBounds,
+        ArrayKernelsGeneric::cullFrustum,
+        ArrayKernelsGeneric::cullLights,
+        ArrayKernelsGeneric::blendKeyFrameRig,
+        ArrayKernelsGeneric::blendCompressedKeyFrameRig,
+        ArrayKernelsGeneric::blendPose
+    };
+
+#if OGRE_ARRAY_KERNELS_AVX2
+    static const ArrayKernels c_arrayKernelsAVX2 =
+    {
+        "AVX2 + FMA3 (4-wide)",
+        ArrayKernelsAVX2::updateAllTransforms,
+        ArrayKernelsAVX2::updateAllBounds,
+        ArrayKernelsAVX2::cullFrustum,
+        ArrayKernelsAVX2::cullLights,
+        ArrayKernelsAVX2::blendKeyFrameRig,
+        ArrayKernelsAVX2::blendCompressedKeyFrameRig,
+        ArrayKernelsAVX2::blendPose
+    };
+#endif
+
+    //---------------------------------------------------------------------
+    // Pick the kernels once, during static initialisation
+    const ArrayKernels* ArrayKernels::msImplementation = ArrayKernels::_detectImplementation();
+    //---------------------------------------------------------------------
+    const ArrayKernels* ArrayKernels::_detectImplementation(void)
+    {
+#if OGRE_ARRAY_KERNELS_AVX2
+        const uint requiredFeatures = PlatformInformation::CPU_FEATURE_AVX2 |
+                                      PlatformInformation::CPU_FEATURE_FMA;
+        if( (PlatformInformation::getCpuFeatures() & requiredFeatures) == requiredFeatures )
+            return &c_arrayKernelsAVX2;
+#endif
+
+        return &c_arrayKernelsGeneric;
+    }
+}
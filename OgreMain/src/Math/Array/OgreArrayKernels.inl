@@ -0,0 +1,503 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+//No include guards on purpose. This file is included once per instruction set by
+//OgreArrayKernels.cpp, each time inside a different namespace.
+
+    //-----------------------------------------------------------------------
+    static void updateAllTransforms( const size_t numNodes, Transform t )
+    {
+        ArrayMatrix4 derivedTransform;
+        for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
+        {
+            //Retrieve from parents. Unfortunately we need to do SoA -> AoS -> SoA conversion
+            ArrayVector3 parentPos, parentScale;
+            ArrayQuaternion parentRot;
+
+            for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+            {
+                Vector3 pos, scale;
+                Quaternion qRot;
+                const Transform &parentTransform = t.mParents[j]->_getTransform();
+                parentTransform.mDerivedPosition->getAsVector3( pos, parentTransform.mIndex );
+                parentTransform.mDerivedOrientation->getAsQuaternion( qRot, parentTransform.mIndex );
+                parentTransform.mDerivedScale->getAsVector3( scale, parentTransform.mIndex );
+
+                parentPos.setFromVector3( pos, j );
+                parentRot.setFromQuaternion( qRot, j );
+                parentScale.setFromVector3( scale, j );
+            }
+
+            // Change position vector based on parent's orientation & scale
+            *t.mDerivedPosition = parentRot * (parentScale * (*t.mPosition));
+
+            // Combine orientation with that of parent
+            *t.mDerivedOrientation = ArrayQuaternion::Cmov4( parentRot * (*t.mOrientation),
+                                                             *t.mOrientation,
+                                                        BooleanMask4::getMask( t.mInheritOrientation ) );
+
+            // Scale own position by parent scale, NB just combine
+            // as equivalent axes, no shearing
+            *t.mDerivedScale = ArrayVector3::Cmov4( parentScale * (*t.mScale), *t.mScale,
+                                                    BooleanMask4::getMask( t.mInheritScale ) );
+
+            // Add altered position vector to parents
+            *t.mDerivedPosition += parentPos;
+
+            derivedTransform.makeTransform( *t.mDerivedPosition,
+                                            *t.mDerivedScale,
+                                            *t.mDerivedOrientation );
+            derivedTransform.storeToAoS( t.mDerivedTransform );
+
+            t.advancePack();
+        }
+    }
+    //-----------------------------------------------------------------------
+    static void updateAllBounds( const size_t numNodes, ObjectData objData )
+    {
+        SimpleMatrix4 mats[ARRAY_PACKED_REALS];
+        for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
+        {
+            //Retrieve from parents. Unfortunately we need to do SoA -> AoS -> SoA conversion
+            ArrayMatrix4 parentMat;
+            ArrayVector3 parentScale;
+
+            for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+            {
+                //Profiling shows these prefetches do make a difference. Perhaps playing with them could
+                //achieve even greater speed ups. This function is terribly bounded by memory latency
+                //Last tested on:
+                //  * Intel Quad Core Extreme QX9650 3Ghz
+                OGRE_PREFETCH_NTA( (const char*)(objData.mParents[i+OGRE_PREFETCH_SLOT_DISTANCE]) );
+
+                Vector3 scale;
+                const Transform &parentTransform = objData.mParents[j]->_getTransform();
+                parentTransform.mDerivedScale->getAsVector3( scale, parentTransform.mIndex );
+                mats[j].load( parentTransform.mDerivedTransform[parentTransform.mIndex] );
+                parentScale.setFromVector3( scale, j );
+
+                // j + OGRE_PREFETCH_SLOT_DISTANCE won't go out of bounds because
+                // the memory manager allocates enough extra space
+                OGRE_PREFETCH_NTA( (const char*)objData.mParents[j+(OGRE_PREFETCH_SLOT_DISTANCE>>1)]->
+                                    _getTransform().mDerivedScale );
+                OGRE_PREFETCH_NTA( (const char*)(objData.mParents[j+(OGRE_PREFETCH_SLOT_DISTANCE>>1)]->
+                                    _getTransform().mDerivedTransform+parentTransform.mIndex) );
+            }
+
+            parentMat.loadFromAoS( mats );
+
+            ArrayReal * RESTRICT_ALIAS worldRadius = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>
+                                                                        (objData.mWorldRadius);
+            ArrayReal * RESTRICT_ALIAS localRadius = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>
+                                                                        (objData.mLocalRadius);
+
+            *objData.mWorldAabb = *objData.mLocalAabb;
+            objData.mWorldAabb->transformAffine( parentMat );
+            *worldRadius = (*localRadius) * parentScale.getMaxComponent();
+
+            objData.advanceBoundsPack();
+        }
+    }
+    //-----------------------------------------------------------------------
+    static void cullFrustum( const size_t numNodes, ObjectData objData, const Frustum *frustum,
+                             uint32 sceneVisibilityFlags,
+                             MovableObject::MovableObjectArray &outCulledObjects,
+                             const Camera *lodCamera )
+    {
+        //On threaded environments, the internal variables from outCulledObjects cause
+        //a false cache sharing because they're too close to each other. Perfoming
+        //a swap places those internal vars in the local stack, increasing scalability
+        MovableObject::MovableObjectArray culledObjects;
+        culledObjects.swap( outCulledObjects );
+
+        //Thanks to Fabian Giesen for summing up all known methods of frustum culling:
+        //http://fgiesen.wordpress.com/2010/10/17/view-frustum-culling/
+        // (we use method Method 5: "If you really don't care whether a box is
+        // partially or fully inside"):
+        // vector4 signFlip = componentwise_and(plane, 0x80000000);
+        // return dot3(center + xor(extent, signFlip), plane) > -plane.w;
+        struct ArrayPlane
+        {
+            ArrayVector3    planeNormal;
+            ArrayVector3    signFlip;
+            ArrayReal       planeNegD;
+        };
+
+        ArrayVector3 lodCameraPos;
+        lodCameraPos.setAll( lodCamera->_getCachedDerivedPosition() );
+
+        // Flip the bit from shadow caster, and leave only that in "includeNonCasters"
+        ArrayInt includeNonCasters = Mathlib::SetAll( ((sceneVisibilityFlags & LAYER_SHADOW_CASTER) ^ -1)
+                                                        & LAYER_SHADOW_CASTER );
+        sceneVisibilityFlags &= RESERVED_VISIBILITY_FLAGS;
+
+        ArrayInt sceneFlags = Mathlib::SetAll( sceneVisibilityFlags );
+        ArrayPlane planes[6];
+        const Plane *frustumPlanes = frustum->_getCachedFrustumPlanes();
+
+        for( size_t i=0; i<6; ++i )
+        {
+            planes[i].planeNormal.setAll( frustumPlanes[i].normal );
+            planes[i].signFlip.setAll( frustumPlanes[i].normal );
+            planes[i].signFlip.setToSign();
+            planes[i].planeNegD = Mathlib::SetAll( -frustumPlanes[i].d );
+        }
+
+        //TODO: Profile whether we should use XOR to flip the sign or simple multiplication.
+        //In theory xor is faster, but some archs have a penalty for switching between integer
+        //& floating point, even if it's simd sse
+        for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
+        {
+            ArrayInt * RESTRICT_ALIAS visibilityFlags = reinterpret_cast<ArrayInt*RESTRICT_ALIAS>
+                                                                        (objData.mVisibilityFlags);
+            ArrayReal * RESTRICT_ALIAS worldRadius = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>
+                                                                        (objData.mWorldRadius);
+            ArrayReal * RESTRICT_ALIAS upperDistance = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>
+                                                                        (objData.mUpperDistance);
+
+            //Test all 6 planes and AND the dot product. If one is false, then we're not visible
+            ArrayReal dotResult;
+            ArrayMaskR mask;
+            ArrayVector3 centerPlusFlippedHS;
+            centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
+                                                                 planes[0].signFlip;
+            dotResult = planes[0].planeNormal.dotProduct( centerPlusFlippedHS );
+            mask = Mathlib::CompareGreater( dotResult, planes[0].planeNegD );
+
+            centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
+                                                                 planes[1].signFlip;
+            dotResult = planes[1].planeNormal.dotProduct( centerPlusFlippedHS );
+            mask = Mathlib::And( mask, Mathlib::CompareGreater( dotResult, planes[1].planeNegD ) );
+
+            centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
+                                                                 planes[2].signFlip;
+            dotResult = planes[2].planeNormal.dotProduct( centerPlusFlippedHS );
+            mask = Mathlib::And( mask, Mathlib::CompareGreater( dotResult, planes[2].planeNegD ) );
+
+            centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
+                                                                 planes[3].signFlip;
+            dotResult = planes[3].planeNormal.dotProduct( centerPlusFlippedHS );
+            mask = Mathlib::And( mask, Mathlib::CompareGreater( dotResult, planes[3].planeNegD ) );
+
+            centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
+                                                                 planes[4].signFlip;
+            dotResult = planes[4].planeNormal.dotProduct( centerPlusFlippedHS );
+            mask = Mathlib::And( mask, Mathlib::CompareGreater( dotResult, planes[4].planeNegD ) );
+
+            centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
+                                                                 planes[5].signFlip;
+            dotResult = planes[5].planeNormal.dotProduct( centerPlusFlippedHS );
+            mask = Mathlib::And( mask, Mathlib::CompareGreater( dotResult, planes[5].planeNegD ) );
+
+            //Always pass the test if any of the components were
+            //Infinity (dot product above could've caused nans)
+            ArrayMaskR tmpMask = Mathlib::Or(
+                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[0] ),
+                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[1] ) );
+            mask = Mathlib::Or( Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[2] ),
+                                mask );
+
+            ArrayReal distance = lodCameraPos.distance( objData.mWorldAabb->mCenter );
+            mask = Mathlib::And( Mathlib::Or( mask, tmpMask ),
+                                 Mathlib::CompareLessEqual( distance, *worldRadius + *upperDistance ) );
+
+            //isVisible = isVisible() && (isCaster || includeNonCasters)
+            ArrayMaskI isVisible = Mathlib::And(
+                                Mathlib::TestFlags4( *visibilityFlags,
+                                                        Mathlib::SetAll( LAYER_VISIBILITY ) ),
+                                Mathlib::TestFlags4( Mathlib::Or( *visibilityFlags, includeNonCasters ),
+                                                        Mathlib::SetAll( LAYER_SHADOW_CASTER ) ) );
+
+            //Fuse result with visibility flag
+            // finalMask = ((visible|infinite_aabb) & sceneFlags & visibilityFlags) != 0 ? 0xffffffff : 0
+            ArrayMaskI finalMask = Mathlib::TestFlags4( CastRealToInt( mask ),
+                                                        Mathlib::And( sceneFlags, *visibilityFlags ) );
+            finalMask               = Mathlib::And( finalMask, isVisible );
+
+            const uint32 scalarMask = BooleanMask4::getScalarMask( finalMask );
+
+            for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+            {
+                //Decompose the result for analyzing each MovableObject's
+                //There's no need to check objData.mOwner[j] is null because
+                //we set mVisibilityFlags to 0 on slot removals
+                if( IS_BIT_SET( j, scalarMask ) )
+                {
+                    culledObjects.push_back( objData.mOwner[j] );
+                }
+            }
+
+            objData.advanceFrustumPack();
+        }
+
+        culledObjects.swap( outCulledObjects );
+    }
+    //-----------------------------------------------------------------------
+    static void cullLights( const size_t numNodes, ObjectData objData,
+                            LightListInfo &outGlobalLightList, const FrustumVec &frustums,
+                            const FrustumVec &cubemapFrustums )
+    {
+        struct ArrayPlane
+        {
+            ArrayVector3    planeNormal;
+            ArrayVector3    signFlip;
+            ArrayReal       planeNegD;
+        };
+        struct ArraySixPlanes
+        {
+            ArrayPlane planes[6];
+        };
+        const size_t numFrustums = frustums.size();
+        ArraySixPlanes *planes = OGRE_ALLOC_T_SIMD( ArraySixPlanes, numFrustums,
+                                                    MEMCATEGORY_SCENE_CONTROL );
+
+        FrustumVec::const_iterator itor = frustums.begin();
+        FrustumVec::const_iterator end  = frustums.end();
+        ArraySixPlanes *planesIt = planes;
+
+        while( itor != end )
+        {
+            const Plane *frustumPlanes = (*itor)->_getCachedFrustumPlanes();
+
+            for( size_t i=0; i<6; ++i )
+            {
+                planesIt->planes[i].planeNormal.setAll( frustumPlanes[i].normal );
+                planesIt->planes[i].signFlip.setAll( frustumPlanes[i].normal );
+                planesIt->planes[i].signFlip.setToSign();
+                planesIt->planes[i].planeNegD = Mathlib::SetAll( -frustumPlanes[i].d );
+            }
+
+            ++planesIt;
+            ++itor;
+        }
+
+        const size_t numCubemapFrustums = cubemapFrustums.size();
+        RawSimdUniquePtr<ArrayAabb, MEMCATEGORY_SCENE_CONTROL> aabbsPtr =
+                                RawSimdUniquePtr<ArrayAabb, MEMCATEGORY_SCENE_CONTROL>( numCubemapFrustums );
+        ArrayAabb * RESTRICT_ALIAS aabbs = aabbsPtr.get();
+
+        itor = cubemapFrustums.begin();
+        end  = cubemapFrustums.end();
+        ArrayAabb *aabbsIt = aabbs;
+
+        while( itor != end )
+        {
+            assert( dynamic_cast<const Camera*>(*itor) );
+            const Camera *c = static_cast<const Camera*>(*itor);
+            aabbsIt->setAll( Aabb( c->_getCachedDerivedPosition(), Vector3(c->getFarClipDistance() * 0.5f) ) );
+            ++aabbsIt;
+            ++itor;
+        }
+
+        //Implementation detail: Ogre 1.9 treated spotlights as a point (Sphere vs Plane collision test)
+        //for simplicity (and presumably performance). We use aabbs for all lights in Ogre 2.0, which
+        //plays better with area lights when we implemented (and spotlights too) degrading performance
+        //for point lights
+
+        //TODO: Profile whether we should use XOR to flip signs
+        //instead of multiplication (see cullFrustum)
+        for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
+        {
+            //Initialize mask to 0
+            ArrayMaskI mask = ARRAY_INT_ZERO;
+
+            for( size_t j=0; j<numFrustums; ++j )
+            {
+                ArrayMaskR tmpMask;
+
+                //Test all 6 planes and AND the dot product. If one is false, then we're not visible
+                ArrayReal dotResult;
+                ArrayVector3 centerPlusFlippedHS;
+                centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
+                                                                    planes[j].planes[0].signFlip;
+                dotResult = planes[j].planes[0].planeNormal.dotProduct( centerPlusFlippedHS );
+                tmpMask = Mathlib::CompareGreater( dotResult, planes[j].planes[0].planeNegD );
+
+                centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
+                                                                     planes[j].planes[1].signFlip;
+                dotResult = planes[j].planes[1].planeNormal.dotProduct( centerPlusFlippedHS );
+                tmpMask = Mathlib::And( tmpMask, Mathlib::CompareGreater( dotResult,
+                                                                planes[j].planes[1].planeNegD ) );
+
+                centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
+                                                                     planes[j].planes[2].signFlip;
+                dotResult = planes[j].planes[2].planeNormal.dotProduct( centerPlusFlippedHS );
+                tmpMask = Mathlib::And( tmpMask, Mathlib::CompareGreater( dotResult,
+                                                                planes[j].planes[2].planeNegD ) );
+
+                centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
+                                                                     planes[j].planes[3].signFlip;
+                dotResult = planes[j].planes[3].planeNormal.dotProduct( centerPlusFlippedHS );
+                tmpMask = Mathlib::And( tmpMask, Mathlib::CompareGreater( dotResult,
+                                                                planes[j].planes[3].planeNegD ) );
+
+                centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
+                                                                     planes[j].planes[4].signFlip;
+                dotResult = planes[j].planes[4].planeNormal.dotProduct( centerPlusFlippedHS );
+                tmpMask = Mathlib::And( tmpMask, Mathlib::CompareGreater( dotResult,
+                                                                planes[j].planes[4].planeNegD ) );
+
+                centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
+                                                                     planes[j].planes[5].signFlip;
+                dotResult = planes[j].planes[5].planeNormal.dotProduct( centerPlusFlippedHS );
+                tmpMask = Mathlib::And( tmpMask, Mathlib::CompareGreater( dotResult,
+                                                                planes[j].planes[5].planeNegD ) );
+
+                //Accumulate into mask. If one Frustum can see, then we need to include it.
+                mask = Mathlib::Or( mask, CastRealToInt( tmpMask ) );
+            }
+
+            for( size_t j=0; j<numCubemapFrustums; ++j )
+            {
+                ArrayMaskR tmpMask = aabbs[j].contains( *objData.mWorldAabb );
+
+                //Accumulate into mask. If one Frustum can see, then we need to include it.
+                mask = Mathlib::Or( mask, CastRealToInt( tmpMask ) );
+            }
+
+            //Always pass the test if any of the components were
+            //Infinity (dot product above could've caused nans)
+            ArrayMaskR tmpMask = Mathlib::Or( Mathlib::Or(
+                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[0] ),
+                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[1] ) ),
+                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[2] ) );
+            mask = Mathlib::Or( mask, CastRealToInt( tmpMask ) );
+
+            //Use the light mask to discard null mOwner ptrs
+            mask = Mathlib::TestFlags4( mask, *reinterpret_cast<ArrayInt*RESTRICT_ALIAS>
+                                                (objData.mLightMask) );
+
+            const uint32 scalarMask = BooleanMask4::getScalarMask( mask );
+
+            for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+            {
+                //Decompose the result for analyzing each MovableObject's
+                //There's no need to check objData.mOwner[j] is null because
+                //we set mVisibilityFlags to 0 on slot removals
+                if( IS_BIT_SET( j, scalarMask ) )
+                {
+                    const size_t idx = outGlobalLightList.lights.size();
+                    outGlobalLightList.visibilityMask[idx] = objData.mVisibilityFlags[j];
+                    outGlobalLightList.boundingSphere[idx] = Sphere(
+                                                        objData.mWorldAabb->mCenter.getAsVector3( j ),
+                                                        objData.mWorldRadius[j] );
+                    assert( dynamic_cast<Light*>( objData.mOwner[j] ) );
+                    outGlobalLightList.lights.push_back( static_cast<Light*>( objData.mOwner[j] ) );
+                }
+            }
+
+            objData.advanceCullLightPack();
+        }
+
+        OGRE_FREE_SIMD( planes, MEMCATEGORY_SCENE_CONTROL );
+        planes = 0;
+    }
+    //-----------------------------------------------------------------------
+    static void blendKeyFrameRig( const KfTransform * RESTRICT_ALIAS prevTransf,
+                                  const KfTransform * RESTRICT_ALIAS nextTransf,
+                                  Real scalarW, ArrayReal animWeight,
+                                  const ArrayReal * RESTRICT_ALIAS perBoneWeights,
+                                  ArrayVector3 * RESTRICT_ALIAS finalPos,
+                                  ArrayVector3 * RESTRICT_ALIAS finalScale,
+                                  ArrayQuaternion * RESTRICT_ALIAS finalRot )
+    {
+        ArrayReal fTimeW = Mathlib::SetAll( scalarW );
+
+        ArrayVector3 interpPos, interpScale;
+        ArrayQuaternion interpRot;
+        //Interpolate keyframes' rotation not using shortestPath to respect the original animation
+        interpPos   = Math::lerp( prevTransf->mPosition, nextTransf->mPosition, fTimeW );
+        interpRot   = ArrayQuaternion::nlerp( fTimeW, prevTransf->mOrientation,
+                                                        nextTransf->mOrientation );
+        interpScale = Math::lerp( prevTransf->mScale, nextTransf->mScale, fTimeW );
+
+        //Combine our internal flag (that prevents blending
+        //unanimated bones) with user's custom weights
+        ArrayReal fW = (*perBoneWeights) * animWeight;
+
+        //When mixing, also interpolate rotation not using shortest path; as this is usually desired
+        *finalPos   += interpPos * fW;
+        *finalScale *= Math::lerp( ArrayVector3::UNIT_SCALE, interpScale, fW );
+        *finalRot   = (*finalRot) * ArrayQuaternion::nlerp( fW, ArrayQuaternion::IDENTITY, interpRot );
+    }
+    //-----------------------------------------------------------------------
+    static void dequantizeKfTransform( const uint16 * RESTRICT_ALIAS quantized,
+                                       const Real * RESTRICT_ALIAS minimums,
+                                       const Real * RESTRICT_ALIAS steps,
+                                       KfTransform * RESTRICT_ALIAS outTransf )
+    {
+        //KfTransform is OGRE_KF_TRANSFORM_NUM_REALS consecutive Reals. This
+        //loop is simple enough for the compiler to vectorize it.
+        Real * RESTRICT_ALIAS dst = reinterpret_cast<Real*>( outTransf );
+        for( size_t i=0; i<OGRE_KF_TRANSFORM_NUM_REALS; ++i )
+            dst[i] = minimums[i] + steps[i] * static_cast<Real>( quantized[i] );
+    }
+    //-----------------------------------------------------------------------
+    static void blendCompressedKeyFrameRig( const uint16 * RESTRICT_ALIAS prevTransf,
+                                            const uint16 * RESTRICT_ALIAS nextTransf,
+                                            const Real * RESTRICT_ALIAS minimums,
+                                            const Real * RESTRICT_ALIAS steps,
+                                            Real scalarW, ArrayReal animWeight,
+                                            const ArrayReal * RESTRICT_ALIAS perBoneWeights,
+                                            ArrayVector3 * RESTRICT_ALIAS finalPos,
+                                            ArrayVector3 * RESTRICT_ALIAS finalScale,
+                                            ArrayQuaternion * RESTRICT_ALIAS finalRot )
+    {
+        KfTransform prev, next;
+        dequantizeKfTransform( prevTransf, minimums, steps, &prev );
+        dequantizeKfTransform( nextTransf, minimums, steps, &next );
+
+        blendKeyFrameRig( &prev, &next, scalarW, animWeight, perBoneWeights,
+                          finalPos, finalScale, finalRot );
+    }
+    //-----------------------------------------------------------------------
+    static void blendPose( const ArrayVector3 * RESTRICT_ALIAS srcPos,
+                           const ArrayVector3 * RESTRICT_ALIAS srcScale,
+                           const ArrayQuaternion * RESTRICT_ALIAS srcRot,
+                           ArrayReal weight,
+                           const ArrayReal * RESTRICT_ALIAS perBoneWeights,
+                           size_t numBlocks,
+                           ArrayVector3 * RESTRICT_ALIAS finalPos,
+                           ArrayVector3 * RESTRICT_ALIAS finalScale,
+                           ArrayQuaternion * RESTRICT_ALIAS finalRot )
+    {
+        const ArrayReal zero = Mathlib::SetAll( 0.0f );
+
+        for( size_t i=0; i<numBlocks; ++i )
+        {
+            ArrayReal fW = perBoneWeights[i] * weight;
+
+            finalPos[i]     = Math::lerp( finalPos[i], srcPos[i], fW );
+            finalScale[i]   = Math::lerp( finalScale[i], srcScale[i], fW );
+
+            //nlerp would renormalize the lanes with no weight (i.e. bones from other
+            //SkeletonInstances sharing the block), keep them bit exact instead.
+            finalRot[i].Cmov4( Mathlib::CompareGreater( fW, zero ),
+                               ArrayQuaternion::nlerpShortest( fW, finalRot[i], srcRot[i] ) );
+        }
+    }
@@ -57,6 +57,7 @@ namespace Ogre
                             mMaxMemory( hintMaxNodes ),
                             mMaxHardLimit( maxHardLimit ),
                             mCleanupThreshold( cleanupThreshold ),
+                            mIncrementalCleanup( false ),
                             mRebaseListener( rebaseListener ),
                             mLevel( depthLevel ),
                             mManagerType( managerType )
@@ -227,7 +228,7 @@ namespace Ogre
 
             //The pool is getting to big? Do some cleanup (depending
             //on fragmentation, may take a performance hit)
-            if( mAvailableSlots.size() > mCleanupThreshold )
+            if( mAvailableSlots.size() > mCleanupThreshold && !mIncrementalCleanup )
             {
                 //Sort, last values first. This may improve performance in some
                 //scenarios by reducing the amount of data to be shifted
@@ -281,6 +282,66 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    size_t ArrayMemoryManager::defragment( size_t maxMoves )
+    {
+        if( mAvailableSlots.empty() || !mRebaseListener )
+            return 0;
+
+        //Lowest holes first, they're filled first. Highest at the back, which may be trimmed.
+        std::sort( mAvailableSlots.begin(), mAvailableSlots.end() );
+
+        size_t numMoves = 0;
+        size_t nextHole = 0;
+
+        while( nextHole < mAvailableSlots.size() )
+        {
+            if( mAvailableSlots.back() + 1 == mUsedMemory )
+            {
+                //The last slot is a hole, nothing to move.
+                mAvailableSlots.pop_back();
+                --mUsedMemory;
+                continue;
+            }
+
+            if( numMoves >= maxMoves )
+                break;
+
+            //The last slot is in use (otherwise it would've been trimmed above)
+            //and is after any hole. Move it to the lowest one.
+            const size_t dstSlot = mAvailableSlots[nextHole++];
+            const size_t srcSlot = mUsedMemory - 1;
+
+            size_t i=0;
+            MemoryPoolVec::iterator itPools = mMemoryPools.begin();
+            MemoryPoolVec::iterator enPools = mMemoryPools.end();
+
+            while( itPools != enPools )
+            {
+                char *dstPtr    = *itPools + dstSlot * mElementsMemSizes[i];
+                char *srcPtr    = *itPools + srcSlot * mElementsMemSizes[i];
+                size_t indexDst = dstSlot % ARRAY_PACKED_REALS;
+                size_t indexSrc = srcSlot % ARRAY_PACKED_REALS;
+
+                //Copy the slot, then default-initialize the one we took it from.
+                mCleanupRoutines[i]( dstPtr, indexDst, srcPtr, indexSrc, 1, 0, mElementsMemSizes[i] );
+                mCleanupRoutines[i]( srcPtr, indexSrc, srcPtr, indexSrc, 0, 1, mElementsMemSizes[i] );
+                ++i;
+                ++itPools;
+            }
+
+            --mUsedMemory;
+            slotVacated( srcSlot );
+
+            mRebaseListener->slotMoved( mManagerType, mLevel, mMemoryPools,
+                                        mElementsMemSizes, dstSlot );
+            ++numMoves;
+        }
+
+        mAvailableSlots.erase( mAvailableSlots.begin(), mAvailableSlots.begin() + nextHole );
+
+        return numMoves;
+    }
+    //-----------------------------------------------------------------------------------
     void cleanerFlat( char *dstPtr, size_t indexDst, char *srcPtr, size_t indexSrc,
                         size_t numSlots, size_t numFreeSlots, size_t elementsMemSize )
     {
@@ -93,6 +93,11 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void NodeArrayMemoryManager::slotVacated( size_t slot )
+    {
+        reinterpret_cast<Node**>( mMemoryPools[Parent] )[slot] = mDummyNode;
+    }
+    //-----------------------------------------------------------------------------------
     void NodeArrayMemoryManager::createNewNode( Transform &outTransform )
     {
         const size_t nextSlot = createNewSlot();
@@ -37,7 +37,8 @@ namespace Ogre
     NodeMemoryManager::NodeMemoryManager() :
             mDummyNode( 0 ),
             mMemoryManagerType( SCENE_DYNAMIC ),
-            mTwinMemoryManager( 0 )
+            mTwinMemoryManager( 0 ),
+            mIncrementalCleanup( false )
     {
         //Manually allocate the memory for the dummy scene nodes (since we can't pass ourselves
         //or yet another object) We only allocate what's needed to prevent access violations.
@@ -116,6 +117,7 @@ namespace Ogre
                                                                 ArrayMemoryManager::MAX_MEMORY_SLOTS,
                                                                 this ) );
             mMemoryManagers.back().initialize();
+            mMemoryManagers.back().setIncrementalCleanup( mIncrementalCleanup );
         }
     }
     //-----------------------------------------------------------------------------------
@@ -279,4 +281,43 @@ namespace Ogre
             transform.advancePack();
         }
     }
+    //---------------------------------------------------------------------
+    void NodeMemoryManager::slotMoved( ArrayMemoryManager::ManagerType managerType, uint16 level,
+                                       const MemoryPoolVec &basePtrs, size_t const *elementsMemSizes,
+                                       size_t dstInstance )
+    {
+        Transform transform;
+        this->getFirstNode( transform, level );
+
+        transform.advancePack( dstInstance / ARRAY_PACKED_REALS );
+        transform.mIndex = dstInstance % ARRAY_PACKED_REALS;
+
+        Node *owner = transform.mOwner[transform.mIndex];
+        owner->_getTransform() = transform;
+        owner->_callMemoryChangeListeners();
+    }
+    //---------------------------------------------------------------------
+    void NodeMemoryManager::setIncrementalCleanup( bool bIncremental )
+    {
+        mIncrementalCleanup = bIncremental;
+
+        ArrayMemoryManagerVec::iterator itor = mMemoryManagers.begin();
+        ArrayMemoryManagerVec::iterator end  = mMemoryManagers.end();
+
+        while( itor != end )
+            (itor++)->setIncrementalCleanup( bIncremental );
+    }
+    //---------------------------------------------------------------------
+    size_t NodeMemoryManager::defragment( size_t maxMoves )
+    {
+        size_t numMoves = 0;
+
+        ArrayMemoryManagerVec::iterator itor = mMemoryManagers.begin();
+        ArrayMemoryManagerVec::iterator end  = mMemoryManagers.end();
+
+        while( itor != end && numMoves < maxMoves )
+            numMoves += (itor++)->defragment( maxMoves - numMoves );
+
+        return numMoves;
+    }
 }
@@ -89,6 +89,12 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void ObjectDataArrayMemoryManager::slotVacated( size_t slot )
+    {
+        reinterpret_cast<Node**>( mMemoryPools[Parent] )[slot] = mDummyNode;
+        reinterpret_cast<MovableObject**>( mMemoryPools[Owner] )[slot] = mDummyObject;
+    }
+    //-----------------------------------------------------------------------------------
     void ObjectDataArrayMemoryManager::createNewNode( ObjectData &outData )
     {
         const size_t nextSlot = createNewSlot();
@@ -0,0 +1,287 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "Math/Array/OgreObjectDataBvh.h"
+#include "Math/Array/OgreObjectMemoryManager.h"
+
+#include "OgrePlane.h"
+
+#include <limits>
+
+namespace Ogre
+{
+    const uint32 ObjectDataBvh::MAX_PACKS_PER_LEAF = 4;
+
+    namespace
+    {
+        /// Sorts pack indices by the center of their aabb along one axis
+        struct PackCenterCompare
+        {
+            const vector<Aabb>::type    &packAabbs;
+            size_t                      axis;
+
+            PackCenterCompare( const vector<Aabb>::type &_packAabbs, size_t _axis ) :
+                packAabbs( _packAabbs ), axis( _axis ) {}
+
+            bool operator () ( uint32 a, uint32 b ) const
+            {
+                return packAabbs[a].mCenter[axis] < packAabbs[b].mCenter[axis];
+            }
+        };
+
+        inline bool isInfinite( const Aabb &aabb )
+        {
+            const Real inf = std::numeric_limits<Real>::infinity();
+            return aabb.mHalfSize.x == inf || aabb.mHalfSize.y == inf || aabb.mHalfSize.z == inf;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    ObjectDataBvh::ObjectDataBvh() :
+        mBuilt( false )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    void ObjectDataBvh::clear(void)
+    {
+        mRenderQueues.clear();
+        mBuilt = false;
+    }
+    //-----------------------------------------------------------------------------------
+    void ObjectDataBvh::build( ObjectMemoryManager &memoryManager )
+    {
+        const size_t numRenderQueues = memoryManager.getNumRenderQueues();
+
+        mRenderQueues.clear();
+        mRenderQueues.resize( numRenderQueues );
+
+        for( size_t i=0; i<numRenderQueues; ++i )
+        {
+            RenderQueueTree &tree = mRenderQueues[i];
+
+            ObjectData objData;
+            const size_t totalObjs = memoryManager.getFirstObjectData( objData, i );
+            const size_t numPacks = (totalObjs + ARRAY_PACKED_REALS - 1) / ARRAY_PACKED_REALS;
+
+            tree.numObjs = totalObjs;
+
+            mTmpPackAabbs.resize( numPacks );
+            tree.packIndices.reserve( numPacks );
+
+            for( size_t j=0; j<numPacks; ++j )
+            {
+                bool packEmpty = true;
+                Aabb packAabb;
+
+                for( size_t k=0; k<ARRAY_PACKED_REALS; ++k )
+                {
+                    if( objData.mOwner[k] )
+                    {
+                        Aabb aabb;
+                        objData.mWorldAabb->getAsAabb( aabb, k );
+
+                        if( packEmpty )
+                            packAabb = aabb;
+                        else
+                            packAabb.merge( aabb );
+
+                        packEmpty = false;
+                    }
+                }
+
+                //Empty packs would never pass the SoA test. Leave them out of the tree.
+                if( !packEmpty )
+                {
+                    mTmpPackAabbs[j] = packAabb;
+                    tree.packIndices.push_back( static_cast<uint32>( j ) );
+                }
+
+                objData.advancePack();
+            }
+
+            if( !tree.packIndices.empty() )
+            {
+                tree.nodes.reserve( (tree.packIndices.size() / MAX_PACKS_PER_LEAF) * 2 + 1 );
+                buildNode( tree, mTmpPackAabbs, 0, static_cast<uint32>( tree.packIndices.size() ) );
+            }
+        }
+
+        mBuilt = true;
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 ObjectDataBvh::buildNode( RenderQueueTree &tree, const vector<Aabb>::type &packAabbs,
+                                     uint32 firstIndex, uint32 numIndices )
+    {
+        const uint32 nodeIdx = static_cast<uint32>( tree.nodes.size() );
+        tree.nodes.push_back( BvhNode() );
+
+        const uint32 *packIndices = &tree.packIndices[firstIndex];
+
+        Aabb nodeAabb = packAabbs[packIndices[0]];
+        Vector3 centerMin = nodeAabb.mCenter;
+        Vector3 centerMax = nodeAabb.mCenter;
+        for( uint32 i=1; i<numIndices; ++i )
+        {
+            const Aabb &packAabb = packAabbs[packIndices[i]];
+            nodeAabb.merge( packAabb );
+            centerMin.makeFloor( packAabb.mCenter );
+            centerMax.makeCeil( packAabb.mCenter );
+        }
+
+        uint32 rightChild = 0;
+
+        if( numIndices > MAX_PACKS_PER_LEAF )
+        {
+            //Median split along the axis where the centers are most spread out
+            const Vector3 centerSpread = centerMax - centerMin;
+            size_t axis = 0;
+            if( centerSpread.y > centerSpread[axis] )
+                axis = 1;
+            if( centerSpread.z > centerSpread[axis] )
+                axis = 2;
+
+            const uint32 numLeft = numIndices >> 1u;
+            vector<uint32>::type::iterator begin = tree.packIndices.begin() + firstIndex;
+            std::nth_element( begin, begin + numLeft, begin + numIndices,
+                              PackCenterCompare( packAabbs, axis ) );
+
+            buildNode( tree, packAabbs, firstIndex, numLeft );
+            rightChild = buildNode( tree, packAabbs, firstIndex + numLeft, numIndices - numLeft );
+        }
+
+        //Don't keep a reference across the recursive calls, 'nodes' may have been reallocated
+        BvhNode &node   = tree.nodes[nodeIdx];
+        node.aabb       = nodeAabb;
+        node.firstIndex = firstIndex;
+        node.numIndices = numIndices;
+        node.rightChild = rightChild;
+
+        return nodeIdx;
+    }
+    //-----------------------------------------------------------------------------------
+    bool ObjectDataBvh::isUpToDate( ObjectMemoryManager &memoryManager ) const
+    {
+        if( !mBuilt || memoryManager.getNumRenderQueues() != mRenderQueues.size() )
+            return false;
+
+        bool retVal = true;
+        for( size_t i=0; i<mRenderQueues.size() && retVal; ++i )
+        {
+            ObjectData objData;
+            retVal = memoryManager.getFirstObjectData( objData, i ) == mRenderQueues[i].numObjs;
+        }
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    void ObjectDataBvh::cullFrustum( size_t renderQueue, const Plane *frustumPlanes,
+                                     PackRangeVec &outRanges )
+    {
+        if( renderQueue >= mRenderQueues.size() || mRenderQueues[renderQueue].nodes.empty() )
+            return;
+
+        const RenderQueueTree &tree = mRenderQueues[renderQueue];
+
+        //Same test as the SoA version (see MovableObject::cullFrustum), "center + extent * signFlip"
+        //gives the corner furthest along the plane's normal; "center - extent * signFlip" the
+        //closest one, which tells us whether the whole node is inside.
+        Vector3 signFlip[6];
+        for( size_t i=0; i<6; ++i )
+        {
+            signFlip[i] = Vector3( frustumPlanes[i].normal.x >= 0 ? 1.0f : -1.0f,
+                                   frustumPlanes[i].normal.y >= 0 ? 1.0f : -1.0f,
+                                   frustumPlanes[i].normal.z >= 0 ? 1.0f : -1.0f );
+        }
+
+        mTmpVisiblePacks.clear();
+
+        //The tree is balanced (median split), 64 levels is way more than enough.
+        uint32 stack[64];
+        size_t stackSize = 0;
+        stack[stackSize++] = 0;
+
+        while( stackSize )
+        {
+            const BvhNode &node = tree.nodes[stack[--stackSize]];
+
+            bool intersects     = true;
+            bool fullyInside    = false;
+
+            if( !isInfinite( node.aabb ) )
+            {
+                fullyInside = true;
+                for( size_t i=0; i<6 && intersects; ++i )
+                {
+                    const Vector3 flippedHalfSize = node.aabb.mHalfSize * signFlip[i];
+                    intersects  = frustumPlanes[i].normal.dotProduct( node.aabb.mCenter +
+                                                                      flippedHalfSize ) >
+                                  -frustumPlanes[i].d;
+                    fullyInside = fullyInside &&
+                                  frustumPlanes[i].normal.dotProduct( node.aabb.mCenter -
+                                                                      flippedHalfSize ) >
+                                  -frustumPlanes[i].d;
+                }
+            }
+
+            if( intersects )
+            {
+                if( fullyInside || !node.rightChild )
+                {
+                    mTmpVisiblePacks.insert( mTmpVisiblePacks.end(),
+                                             tree.packIndices.begin() + node.firstIndex,
+                                             tree.packIndices.begin() + node.firstIndex +
+                                             node.numIndices );
+                }
+                else
+                {
+                    assert( stackSize + 2 <= sizeof(stack) / sizeof(stack[0]) );
+                    stack[stackSize++] = node.rightChild;
+                    stack[stackSize++] = static_cast<uint32>( &node - &tree.nodes[0] ) + 1;
+                }
+            }
+        }
+
+        //Convert the visible packs back to memory order and merge consecutive ones
+        std::sort( mTmpVisiblePacks.begin(), mTmpVisiblePacks.end() );
+
+        vector<uint32>::type::const_iterator itor = mTmpVisiblePacks.begin();
+        vector<uint32>::type::const_iterator end  = mTmpVisiblePacks.end();
+
+        while( itor != end )
+        {
+            const uint32 firstPack = *itor++;
+            uint32 lastPack = firstPack;
+
+            while( itor != end && *itor == lastPack + 1 )
+                lastPack = *itor++;
+
+            outRanges.push_back( PackRange( firstPack, lastPack - firstPack + 1 ) );
+        }
+    }
+}
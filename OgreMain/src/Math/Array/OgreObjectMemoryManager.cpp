@@ -39,7 +39,8 @@ namespace Ogre
             mDummyNode( 0 ),
             mDummyObject( 0 ),
             mMemoryManagerType( SCENE_DYNAMIC ),
-            mTwinMemoryManager( 0 )
+            mTwinMemoryManager( 0 ),
+            mIncrementalCleanup( false )
     {
         //Manually allocate the memory for the dummy scene nodes (since we can't pass ourselves
         //or yet another object) We only allocate what's needed to prevent access violations.
@@ -124,6 +125,7 @@ namespace Ogre
                                             mDummyNode, mDummyObject, 100,
                                             ArrayMemoryManager::MAX_MEMORY_SLOTS, this ) );
             mMemoryManagers.back().initialize();
+            mMemoryManagers.back().setIncrementalCleanup( mIncrementalCleanup );
         }
     }
     //-----------------------------------------------------------------------------------
@@ -263,4 +265,41 @@ namespace Ogre
             objectData.advancePack();
         }
     }
+    //---------------------------------------------------------------------
+    void ObjectMemoryManager::slotMoved( ArrayMemoryManager::ManagerType managerType, uint16 level,
+                                         const MemoryPoolVec &basePtrs, size_t const *elementsMemSizes,
+                                         size_t dstInstance )
+    {
+        ObjectData objectData;
+        this->getFirstObjectData( objectData, level );
+
+        objectData.advancePack( dstInstance / ARRAY_PACKED_REALS );
+        objectData.mIndex = dstInstance % ARRAY_PACKED_REALS;
+
+        objectData.mOwner[objectData.mIndex]->_getObjectData() = objectData;
+    }
+    //---------------------------------------------------------------------
+    void ObjectMemoryManager::setIncrementalCleanup( bool bIncremental )
+    {
+        mIncrementalCleanup = bIncremental;
+
+        ArrayMemoryManagerVec::iterator itor = mMemoryManagers.begin();
+        ArrayMemoryManagerVec::iterator end  = mMemoryManagers.end();
+
+        while( itor != end )
+            (itor++)->setIncrementalCleanup( bIncremental );
+    }
+    //---------------------------------------------------------------------
+    size_t ObjectMemoryManager::defragment( size_t maxMoves )
+    {
+        size_t numMoves = 0;
+
+        ArrayMemoryManagerVec::iterator itor = mMemoryManagers.begin();
+        ArrayMemoryManagerVec::iterator end  = mMemoryManagers.end();
+
+        while( itor != end && numMoves < maxMoves )
+            numMoves += (itor++)->defragment( maxMoves - numMoves );
+
+        return numMoves;
+    }
 }
@@ -465,7 +465,7 @@ namespace Ogre {
             {
                 track->setTargetMode(VertexAnimationTrack::TM_SOFTWARE);
                 track->applyToVertexData(swVertexData, timeIndex, weight, 
-                    &(entity->getMesh()->getPoseList()));
+                    &(entity->getMesh()->getPoseList()), entity->_getManager());
             }
             if (hardware)
             {
@@ -1193,7 +1193,8 @@ namespace Ogre {
     }
     //--------------------------------------------------------------------------
     void VertexAnimationTrack::applyToVertexData(VertexData* data,
-        const TimeIndex& timeIndex, Real weight, const PoseList* poseList)
+        const TimeIndex& timeIndex, Real weight, const PoseList* poseList,
+        SceneManager *sceneManager)
     {
         // Nothing to do if no keyframes or no vertex data
         if (mKeyFrames.empty() || !data)
@@ -1236,7 +1237,8 @@ namespace Ogre {
                 // If target mode is software, need to software interpolate each vertex
 
                 Mesh::softwareVertexMorph(
-                    t, vkf1->getVertexBuffer(), vkf2->getVertexBuffer(), data);
+                    t, vkf1->getVertexBuffer(), vkf2->getVertexBuffer(), data,
+                    sceneManager);
             }
         }
         else
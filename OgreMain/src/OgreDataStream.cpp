@@ -30,6 +30,22 @@ THE SOFTWARE.
 #include "OgreLogManager.h"
 #include "OgreException.h"
 
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+#   define WIN32_LEAN_AND_MEAN
+#   if !defined(NOMINMAX) && defined(_MSC_VER)
+#       define NOMINMAX // required to stop windows.h messing up std::min
+#   endif
+#   include <windows.h>
+#   define OGRE_MAPPED_FILES_WIN32 1
+#elif OGRE_PLATFORM == OGRE_PLATFORM_LINUX || OGRE_PLATFORM == OGRE_PLATFORM_APPLE || \
+      OGRE_PLATFORM == OGRE_PLATFORM_APPLE_IOS || OGRE_PLATFORM == OGRE_PLATFORM_ANDROID
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#   define OGRE_MAPPED_FILES_POSIX 1
+#endif
+
 namespace Ogre {
 
     //-----------------------------------------------------------------------
@@ -470,6 +486,117 @@ namespace Ogre {
     }
     //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
+    MappedFileDataStream::MappedFileDataStream( const String& name, const String& fullPath ) :
+        MemoryDataStream( name, (void*)0, 0, false, true ),
+        mMapped( false )
+    {
+        void *mappedData = 0;
+        size_t fileSize = 0;
+
+#if OGRE_MAPPED_FILES_WIN32
+        HANDLE hFile = CreateFileA( fullPath.c_str(), GENERIC_READ, FILE_SHARE_READ, 0,
+                                    OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, 0 );
+        if( hFile == INVALID_HANDLE_VALUE )
+        {
+            OGRE_EXCEPT( Exception::ERR_FILE_NOT_FOUND, "Cannot open file: " + fullPath,
+                         "MappedFileDataStream::MappedFileDataStream" );
+        }
+
+        LARGE_INTEGER largeSize;
+        GetFileSizeEx( hFile, &largeSize );
+        fileSize = static_cast<size_t>( largeSize.QuadPart );
+
+        if( fileSize )
+        {
+            HANDLE hMapping = CreateFileMappingA( hFile, 0, PAGE_READONLY, 0, 0, 0 );
+            if( hMapping )
+            {
+                mappedData = MapViewOfFile( hMapping, FILE_MAP_READ, 0, 0, 0 );
+                //The view keeps the mapping alive
+                CloseHandle( hMapping );
+            }
+        }
+        CloseHandle( hFile );
+#elif OGRE_MAPPED_FILES_POSIX
+        int fd = open( fullPath.c_str(), O_RDONLY );
+        if( fd < 0 )
+        {
+            OGRE_EXCEPT( Exception::ERR_FILE_NOT_FOUND, "Cannot open file: " + fullPath,
+                         "MappedFileDataStream::MappedFileDataStream" );
+        }
+
+        struct stat tagStat;
+        if( fstat( fd, &tagStat ) == 0 )
+            fileSize = static_cast<size_t>( tagStat.st_size );
+
+        if( fileSize )
+        {
+            mappedData = mmap( 0, fileSize, PROT_READ, MAP_PRIVATE, fd, 0 );
+            if( mappedData == MAP_FAILED )
+                mappedData = 0;
+#if defined(POSIX_MADV_SEQUENTIAL)
+            else
+                posix_madvise( mappedData, fileSize, POSIX_MADV_SEQUENTIAL );
+#endif
+        }
+        //The mapping keeps the file alive
+        ::close( fd );
+#endif
+
+        if( mappedData )
+        {
+            mMapped = true;
+        }
+        else
+        {
+            //Mapping isn't supported (or failed). Read it the old way.
+            FILE *handle = fopen( fullPath.c_str(), "rb" );
+            if( !handle )
+            {
+                OGRE_EXCEPT( Exception::ERR_FILE_NOT_FOUND, "Cannot open file: " + fullPath,
+                             "MappedFileDataStream::MappedFileDataStream" );
+            }
+
+            fseek( handle, 0, SEEK_END );
+            fileSize = static_cast<size_t>( ftell( handle ) );
+            fseek( handle, 0, SEEK_SET );
+
+            if( fileSize )
+            {
+                mappedData = OGRE_ALLOC_T( uchar, fileSize, MEMCATEGORY_GENERAL );
+                fileSize = fread( mappedData, 1, fileSize, handle );
+                mFreeOnClose = true;
+            }
+            fclose( handle );
+        }
+
+        mData = mPos = static_cast<uchar*>( mappedData );
+        mSize = fileSize;
+        mEnd = mData + mSize;
+    }
+    //-----------------------------------------------------------------------
+    MappedFileDataStream::~MappedFileDataStream()
+    {
+        close();
+    }
+    //-----------------------------------------------------------------------
+    void MappedFileDataStream::close(void)
+    {
+        if( mMapped && mData )
+        {
+#if OGRE_MAPPED_FILES_WIN32
+            UnmapViewOfFile( mData );
+#elif OGRE_MAPPED_FILES_POSIX
+            munmap( mData, mSize );
+#endif
+            mData = mPos = mEnd = 0;
+            mMapped = false;
+        }
+
+        MemoryDataStream::close();
+    }
+    //-----------------------------------------------------------------------
+    //-----------------------------------------------------------------------
     FileStreamDataStream::FileStreamDataStream(std::ifstream* s, bool freeOnClose)
         : DataStream(), mInStream(s), mFStreamRO(s), mFStream(0), mFreeOnClose(freeOnClose)
     {
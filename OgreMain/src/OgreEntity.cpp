@@ -713,6 +713,8 @@ namespace Ogre {
                 // Software blend?
                 if (softwareAnimation)
                 {
+                    // We're in the main thread (SceneManager::_renderPhase02), so
+                    // big buffers can be blended by mManager's worker threads
                     const Matrix4* blendMatrices[256];
 
                     // Ok, we need to do a software blend
@@ -735,7 +737,7 @@ namespace Ogre {
                                 mSoftwareVertexAnimVertexData : mMesh->sharedVertexData,
                             mSkelAnimVertexData,
                             blendMatrices, mMesh->sharedBlendIndexToBoneIndexMap.size(),
-                            blendNormals);
+                            blendNormals, mManager);
                     }
                     SubEntityList::iterator i, iend;
                     iend = mSubEntityList.end();
@@ -757,7 +759,7 @@ namespace Ogre {
                                     se.mSoftwareVertexAnimVertexData : se.mSubMesh->vertexData,
                                 se.mSkelAnimVertexData,
                                 blendMatrices, se.mSubMesh->blendIndexToBoneIndexMap.size(),
-                                blendNormals);
+                                blendNormals, mManager);
                         }
 
                     }
@@ -55,6 +55,7 @@ THE SOFTWARE.
 namespace Ogre {
 
     bool FileSystemArchive::msIgnoreHidden = true;
+    bool FileSystemArchive::msMemoryMapFiles = false;
 
     //-----------------------------------------------------------------------
     FileSystemArchive::FileSystemArchive(const String& name, const String& archType, bool readOnly )
@@ -225,6 +226,9 @@ namespace Ogre {
                         "FileSystemArchive::open");
         }
 
+        if (readOnly && msMemoryMapFiles)
+            return DataStreamPtr(OGRE_NEW MappedFileDataStream(filename, full_path));
+
         if (!readOnly)
         {
             mode |= std::ios::out;
@@ -38,6 +38,8 @@ THE SOFTWARE.
 
 #include "OgreLight.h"
 #include "OgreSceneManager.h"
+#include "OgreLogManager.h"
+#include "OgreRoot.h"
 //#include "OgreMovableObject.h"
 //#include "OgreRenderable.h"
 
@@ -97,13 +99,31 @@ namespace Ogre
                                    "HullShader_hs", "DomainShader_ds" };
     const String PieceFilePatterns[] = { "piece_vs", "piece_ps", "piece_gs", "piece_hs", "piece_ds" };
 
-    Hlms::Hlms( Archive *dataFolder ) : mDataFolder( dataFolder )
+    //Bump when the layout written by Hlms::saveShaderCache changes
+    const uint32 HlmsShaderCacheMagic   = 0x43534C48; //"HLSC"
+    const uint32 HlmsShaderCacheVersion = 2;
+
+    const size_t Hlms::PARALLEL_HASH_THRESHOLD = 1024;
+
+    Hlms::Hlms( Archive *dataFolder ) :
+        mDataFolder( dataFolder ),
+        mTemplateHash( 0 ),
+        mAsyncShaderGeneration( false ),
+        mWorkQueueChannel( 0 ),
+        mBackgroundGenerator( 0 ),
+        mFallbackCache( 0 ),
+        mUseFallbackCache( false )
     {
         enumeratePieceFiles();
+        loadTemplateFiles();
     }
     //-----------------------------------------------------------------------------------
     Hlms::~Hlms()
     {
+        setAsyncShaderGeneration( false );
+
+        OGRE_DELETE mBackgroundGenerator;
+        mBackgroundGenerator = 0;
     }
     //-----------------------------------------------------------------------------------
     void Hlms::setCommonProperties(void)
@@ -171,24 +191,71 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void Hlms::loadTemplateFiles(void)
+    {
+        uint32 hash = IdString::Seed;
+
+        for( size_t i=0; i<NumShaderTypes; ++i )
+        {
+            mPieceFileContents[i].clear();
+            mPieceFileContents[i].resize( mPieceFiles[i].size() );
+            mTemplateContents[i].clear();
+
+            StringVector files( mPieceFiles[i] );
+            //TODO: Identify the file extension at runtime
+            files.push_back( ShaderFiles[i] + ".glsl" );
+
+            for( size_t j=0; j<files.size(); ++j )
+            {
+                if( mDataFolder->exists( files[j] ) )
+                {
+                    DataStreamPtr inFile = mDataFolder->open( files[j] );
+
+                    String &contents = j < mPieceFiles[i].size() ? mPieceFileContents[i][j] :
+                                                                   mTemplateContents[i];
+                    contents.resize( inFile->size() );
+                    if( !contents.empty() )
+                        inFile->read( &contents[0], contents.size() );
+
+                    MurmurHash3_x86_32( files[j].c_str(), static_cast<int>( files[j].size() ),
+                                        hash, &hash );
+                    MurmurHash3_x86_32( contents.c_str(), static_cast<int>( contents.size() ),
+                                        hash, &hash );
+                }
+            }
+        }
+
+        mTemplateHash = hash;
+    }
+    //-----------------------------------------------------------------------------------
     void Hlms::setProperty( IdString key, int32 value )
+    {
+        setProperty( mSetProperties, key, value );
+    }
+    //-----------------------------------------------------------------------------------
+    int32 Hlms::getProperty( IdString key, int32 defaultVal ) const
+    {
+        return getProperty( mSetProperties, key, defaultVal );
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::setProperty( HlmsPropertyVec &properties, IdString key, int32 value )
     {
         HlmsProperty p( key, value );
-        HlmsPropertyVec::iterator it = std::lower_bound( mSetProperties.begin(), mSetProperties.end(),
+        HlmsPropertyVec::iterator it = std::lower_bound( properties.begin(), properties.end(),
                                                          p, OrderPropertyByIdString );
-        if( it == mSetProperties.end() || it->keyName != p.keyName )
-            mSetProperties.insert( it, p );
+        if( it == properties.end() || it->keyName != p.keyName )
+            properties.insert( it, p );
         else
             *it = p;
     }
     //-----------------------------------------------------------------------------------
-    int32 Hlms::getProperty(IdString key, int32 defaultVal ) const
+    int32 Hlms::getProperty( const HlmsPropertyVec &properties, IdString key, int32 defaultVal )
     {
         HlmsProperty p( key, 0 );
-        HlmsPropertyVec::const_iterator it = std::lower_bound( mSetProperties.begin(),
-                                                               mSetProperties.end(),
+        HlmsPropertyVec::const_iterator it = std::lower_bound( properties.begin(),
+                                                               properties.end(),
                                                                p, OrderPropertyByIdString );
-        if( it != mSetProperties.end() && it->keyName == p.keyName )
+        if( it != properties.end() && it->keyName == p.keyName )
             defaultVal = it->value;
 
         return defaultVal;
@@ -261,21 +328,18 @@ namespace Ogre
         }
 
         SubStringRef subString( &outSubString.getOriginalBuffer(), outSubString.getStart(),
-								 outSubString.getStart() + expEnd );
+                                 outSubString.getStart() + expEnd );
 
-		outSubString = SubStringRef( &outSubString.getOriginalBuffer(),
+        outSubString = SubStringRef( &outSubString.getOriginalBuffer(),
                                      outSubString.getStart() + expEnd + 1 );
 
         bool textStarted = false;
+        bool tokenNegated = false;
         bool syntaxError = false;
         bool nextExpressionNegates = false;
 
-        std::vector<Expression*> expressionParents;
-        ExpressionVec outExpressions;
-        outExpressions.clear();
-        outExpressions.resize( 1 );
-
-        Expression *currentExpression = &outExpressions.back();
+        mExpressionLevels.clear();
+        mExpressionLevels.push_back( ExpressionLevel( false ) );
 
         String::const_iterator it = subString.begin();
         String::const_iterator en = subString.end();
@@ -286,30 +350,53 @@ namespace Ogre
 
             if( c == '(' )
             {
-                currentExpression->children.push_back( Expression() );
-                expressionParents.push_back( currentExpression );
+                if( textStarted )
+                    addExpressionToken( mExpressionLevels.back(), tokenNegated, syntaxError );
 
-                currentExpression->children.back().negated = nextExpressionNegates;
+                mExpressionLevels.push_back( ExpressionLevel( nextExpressionNegates ) );
 
                 textStarted = false;
                 nextExpressionNegates = false;
-
-                currentExpression = &currentExpression->children.back();
             }
             else if( c == ')' )
             {
-				if( expressionParents.empty() )
-					syntaxError = true;
-				else
-				{
-					currentExpression = expressionParents.back();
-					expressionParents.pop_back();
-				}
+                if( textStarted )
+                    addExpressionToken( mExpressionLevels.back(), tokenNegated, syntaxError );
+
+                if( mExpressionLevels.size() == 1 )
+                {
+                    syntaxError = true;
+                }
+                else
+                {
+                    const ExpressionLevel closedLevel = mExpressionLevels.back();
+                    mExpressionLevels.pop_back();
+
+                    if( closedLevel.hasChildren && closedLevel.lastWasOperator )
+                    {
+                        //"(a &&)"
+                        syntaxError = true;
+                    }
+                    else if( closedLevel.hasChildren )
+                    {
+                        addExpressionOperand( mExpressionLevels.back(), closedLevel.negated,
+                                              closedLevel.result, syntaxError );
+                    }
+                    else
+                    {
+                        //Empty parenthesis are evaluated like a variable with no name
+                        mExpressionToken.clear();
+                        addExpressionToken( mExpressionLevels.back(), closedLevel.negated,
+                                            syntaxError );
+                    }
+                }
 
                 textStarted = false;
             }
             else if( c == ' ' || c == '\t' || c == '\n' || c == '\r' )
             {
+                if( textStarted )
+                    addExpressionToken( mExpressionLevels.back(), tokenNegated, syntaxError );
                 textStarted = false;
             }
             else if( c == '!' )
@@ -321,37 +408,61 @@ namespace Ogre
                 if( !textStarted )
                 {
                     textStarted = true;
-                    currentExpression->children.push_back( Expression() );
-                    currentExpression->children.back().negated = nextExpressionNegates;
+                    tokenNegated = nextExpressionNegates;
+                    mExpressionToken.clear();
                 }
 
                 if( c == '&' || c == '|' )
                 {
-                    if( currentExpression->children.empty() || nextExpressionNegates )
+                    if( nextExpressionNegates )
                     {
                         syntaxError = true;
                     }
-                    else if( !currentExpression->children.back().value.empty() &&
-                             c != *(currentExpression->children.back().value.end()-1) )
+                    else if( !mExpressionToken.empty() &&
+                             c != *(mExpressionToken.end()-1) )
                     {
-                        currentExpression->children.push_back( Expression() );
+                        //"a&&" or "&&|" start a new token
+                        addExpressionToken( mExpressionLevels.back(), tokenNegated, syntaxError );
+                        tokenNegated = false;
+                        mExpressionToken.clear();
                     }
                 }
+                else if( !mExpressionToken.empty() &&
+                         (*(mExpressionToken.end()-1) == '&' || *(mExpressionToken.end()-1) == '|') )
+                {
+                    //"&&b" and "&&!b" start a new token too
+                    addExpressionToken( mExpressionLevels.back(), tokenNegated, syntaxError );
+                    tokenNegated = nextExpressionNegates;
+                    mExpressionToken.clear();
+                }
 
-                currentExpression->children.back().value.push_back( c );
+                mExpressionToken.push_back( c );
                 nextExpressionNegates = false;
             }
 
             ++it;
         }
 
-        bool retVal = false;
+        if( textStarted && !syntaxError )
+            addExpressionToken( mExpressionLevels.back(), tokenNegated, syntaxError );
 
-        if( !expressionParents.empty() )
+        if( mExpressionLevels.size() != 1 ||
+            (mExpressionLevels.back().hasChildren && mExpressionLevels.back().lastWasOperator) )
+        {
+            //Unclosed parenthesis or "a &&"
             syntaxError = true;
+        }
+
+        bool retVal = false;
 
         if( !syntaxError )
-            retVal = evaluateExpressionRecursive( outExpressions, syntaxError );
+        {
+            const ExpressionLevel &root = mExpressionLevels.back();
+            if( root.hasChildren )
+                retVal = root.result;
+            else
+                retVal = getProperty( IdString( "" ) ) != 0;
+        }
 
         if( syntaxError )
             printf( "Syntax Error at line %lu\n", calculateLineCount( subString ) );
@@ -361,84 +472,44 @@ namespace Ogre
         return retVal;
     }
     //-----------------------------------------------------------------------------------
-    bool Hlms::evaluateExpressionRecursive( ExpressionVec &expression, bool &outSyntaxError ) const
+    void Hlms::addExpressionOperand( ExpressionLevel &level, bool negated, bool value,
+                                     bool &outSyntaxError ) const
     {
-        ExpressionVec::iterator itor = expression.begin();
-        ExpressionVec::iterator end  = expression.end();
+        level.hasChildren = true;
 
-        while( itor != end )
+        if( !level.lastWasOperator )
         {
-            if( itor->value == "&&" )
-                itor->type = EXPR_OPERATOR_AND;
-            else if( itor->value == "||" )
-                itor->type = EXPR_OPERATOR_OR;
-            else if( !itor->children.empty() )
-                itor->type = EXPR_OBJECT;
-            else
-                itor->type = EXPR_VAR;
-
-            ++itor;
+            outSyntaxError = true;
         }
-
-        bool syntaxError = outSyntaxError;
-        bool lastExpWasOperator = true;
-
-        itor = expression.begin();
-
-        while( itor != end && !syntaxError )
+        else
         {
-            Expression &exp = *itor;
-            if( ((exp.type == EXPR_OPERATOR_OR || exp.type == EXPR_OPERATOR_AND) && lastExpWasOperator) ||
-                ((exp.type == EXPR_VAR || exp.type == EXPR_OBJECT) && !lastExpWasOperator ) )
-            {
-                syntaxError = true;
-            }
-            else if( exp.type == EXPR_OPERATOR_OR || exp.type == EXPR_OPERATOR_AND )
-            {
-                lastExpWasOperator = true;
-            }
-            else if( exp.type == EXPR_VAR )
+            value = negated ? !value : value;
+            level.result = level.andMode ? (level.result && value) : (level.result || value);
+            level.lastWasOperator = false;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::addExpressionToken( ExpressionLevel &level, bool negated, bool &outSyntaxError ) const
+    {
+        if( mExpressionToken == "&&" || mExpressionToken == "||" )
+        {
+            level.hasChildren = true;
+
+            if( level.lastWasOperator )
             {
-                exp.result = getProperty( exp.value ) != 0;
-                lastExpWasOperator = false;
+                outSyntaxError = true;
             }
             else
             {
-                exp.result = evaluateExpressionRecursive( exp.children, syntaxError );
-                lastExpWasOperator = false;
+                level.andMode = mExpressionToken[0] == '&';
+                level.lastWasOperator = true;
             }
-
-            ++itor;
         }
-
-        bool retVal = true;
-
-        if( !syntaxError )
+        else
         {
-            itor = expression.begin();
-            bool andMode = true;
-
-            while( itor != end )
-            {
-                if( itor->type == EXPR_OPERATOR_OR )
-                    andMode = false;
-                else if( itor->type == EXPR_OPERATOR_AND )
-                    andMode = true;
-                else
-                {
-                    if( andMode )
-                        retVal &= itor->negated ? !itor->result : itor->result;
-                    else
-                        retVal |= itor->negated ? !itor->result : itor->result;
-                }
-
-                ++itor;
-            }
+            addExpressionOperand( level, negated, getProperty( IdString( mExpressionToken ) ) != 0,
+                                  outSyntaxError );
         }
-
-        outSyntaxError = syntaxError;
-
-        return retVal;
     }
     //-----------------------------------------------------------------------------------
     size_t Hlms::evaluateExpressionEnd( const SubStringRef &outSubString )
@@ -473,15 +544,15 @@ namespace Ogre
         return retVal;
     }
     //-----------------------------------------------------------------------------------
-    void Hlms::evaluateParamArgs( SubStringRef &outSubString, StringVector &outArgs,
-                                  bool &outSyntaxError )
+    size_t Hlms::evaluateParamArgs( SubStringRef &outSubString, StringVector &outArgs,
+                                    bool &outSyntaxError )
     {
         size_t expEnd = evaluateExpressionEnd( outSubString );
 
         if( expEnd == String::npos )
         {
             outSyntaxError = true;
-            return;
+            return 0;
         }
 
         SubStringRef subString( &outSubString.getOriginalBuffer(), outSubString.getStart(),
@@ -493,8 +564,11 @@ namespace Ogre
         int expressionState = 0;
         bool syntaxError = false;
 
-        outArgs.clear();
-        outArgs.push_back( String() );
+        //Reuse the strings from previous calls, they probably have enough capacity
+        size_t numArgs = 1;
+        if( outArgs.empty() )
+            outArgs.push_back( String() );
+        outArgs[0].clear();
 
         String::const_iterator it = subString.begin();
         String::const_iterator en = subString.end();
@@ -515,7 +589,10 @@ namespace Ogre
             else if( c == ',' )
             {
                 expressionState = 0;
-                outArgs.push_back( String() );
+                ++numArgs;
+                if( outArgs.size() < numArgs )
+                    outArgs.push_back( String() );
+                outArgs[numArgs-1].clear();
             }
             else
             {
@@ -527,7 +604,7 @@ namespace Ogre
                 }
                 else
                 {
-                    outArgs.back().push_back( *it );
+                    outArgs[numArgs-1].push_back( *it );
                     expressionState = 1;
                 }
             }
@@ -539,15 +616,13 @@ namespace Ogre
             printf( "Syntax Error at line %lu\n", calculateLineCount( subString ) );
 
         outSyntaxError = syntaxError;
+
+        return numArgs;
     }
     //-----------------------------------------------------------------------------------
     void Hlms::copy( String &outBuffer, const SubStringRef &inSubString, size_t length )
     {
-        String::const_iterator itor = inSubString.begin();
-        String::const_iterator end  = inSubString.begin() + length;
-
-        while( itor != end )
-            outBuffer.push_back( *itor++ );
+        outBuffer.append( inSubString.begin(), inSubString.begin() + length );
     }
     //-----------------------------------------------------------------------------------
     void Hlms::repeat( String &outBuffer, const SubStringRef &inSubString, size_t length,
@@ -585,7 +660,6 @@ namespace Ogre
         outBuffer.clear();
         outBuffer.reserve( inBuffer.size() );
 
-        StringVector argValues;
         SubStringRef subString( &inBuffer, 0 );
         size_t pos = subString.find( "@foreach" );
 
@@ -597,7 +671,7 @@ namespace Ogre
             copy( outBuffer, subString, pos );
 
             subString.setStart( subString.getStart() + pos + sizeof( "@foreach" ) );
-            evaluateParamArgs( subString, argValues, syntaxError );
+            const size_t numArgs = evaluateParamArgs( subString, mArgValues, syntaxError );
 
             SubStringRef blockSubString = subString;
             findBlockEnd( blockSubString, syntaxError );
@@ -605,41 +679,39 @@ namespace Ogre
             if( !syntaxError )
             {
                 char *endPtr;
-                int count = strtol( argValues[0].c_str(), &endPtr, 10 );
-                if( argValues[0].c_str() == endPtr )
+                int count = strtol( mArgValues[0].c_str(), &endPtr, 10 );
+                if( mArgValues[0].c_str() == endPtr )
                 {
                     //This isn't a number. Let's try if it's a variable
-                    count = getProperty( argValues[0], -1 );
+                    count = getProperty( mArgValues[0], -1 );
                 }
 
                 if( count < 0 )
                 {
                     printf( "Invalid parameter at line %lu (@foreach)."
                             " '%s' is not a number nor a variable\n",
-                            calculateLineCount( blockSubString ), argValues[0].c_str() );
+                            calculateLineCount( blockSubString ), mArgValues[0].c_str() );
                     syntaxError = true;
                     count = 0;
                 }
 
-                String counterVar;
-                if( argValues.size() > 1 )
-                    counterVar = argValues[1];
+                const String &counterVar = numArgs > 1 ? mArgValues[1] : BLANKSTRING;
 
                 int start = 0;
-                if( argValues.size() > 2 )
+                if( numArgs > 2 )
                 {
-                    start = strtol( argValues[2].c_str(), &endPtr, 10 );
-                    if( argValues[2].c_str() == endPtr )
+                    start = strtol( mArgValues[2].c_str(), &endPtr, 10 );
+                    if( mArgValues[2].c_str() == endPtr )
                     {
                         //This isn't a number. Let's try if it's a variable
-                        start = getProperty( argValues[2], -1 );
+                        start = getProperty( mArgValues[2], -1 );
                     }
 
                     if( start < 0 )
                     {
                         printf( "Invalid parameter at line %lu (@foreach)."
                                 " '%s' is not a number nor a variable\n",
-                                calculateLineCount( blockSubString ), argValues[2].c_str() );
+                                calculateLineCount( blockSubString ), mArgValues[2].c_str() );
                         syntaxError = true;
                         start = 0;
                         count = 0;
@@ -704,7 +776,6 @@ namespace Ogre
         outBuffer.clear();
         outBuffer.reserve( inBuffer.size() );
 
-        StringVector argValues;
         SubStringRef subString( &inBuffer, 0 );
         size_t pos = subString.find( "@piece" );
 
@@ -716,28 +787,26 @@ namespace Ogre
             copy( outBuffer, subString, pos );
 
             subString.setStart( subString.getStart() + pos + sizeof( "@piece" ) );
-            evaluateParamArgs( subString, argValues, syntaxError );
+            const size_t numArgs = evaluateParamArgs( subString, mArgValues, syntaxError );
 
-            syntaxError |= argValues.size() != 1;
+            syntaxError |= numArgs != 1;
 
             if( !syntaxError )
             {
-                const IdString pieceName( argValues[0] );
+                const IdString pieceName( mArgValues[0] );
                 PiecesMap::const_iterator it = mPieces.find( pieceName );
                 if( it != mPieces.end() )
                 {
                     syntaxError = true;
                     printf( "Error at line %lu: @piece '%s' already defined",
-                            calculateLineCount( subString ), argValues[0].c_str() );
+                            calculateLineCount( subString ), mArgValues[0].c_str() );
                 }
                 else
                 {
                     SubStringRef blockSubString = subString;
                     findBlockEnd( blockSubString, syntaxError );
 
-                    String tmpBuffer;
-                    copy( tmpBuffer, blockSubString, blockSubString.getSize() );
-                    mPieces[pieceName] = tmpBuffer;
+                    copy( mPieces[pieceName], blockSubString, blockSubString.getSize() );
 
                     subString.setStart( blockSubString.getEnd() + sizeof( "@end" ) );
                 }
@@ -761,7 +830,6 @@ namespace Ogre
         outBuffer.clear();
         outBuffer.reserve( inBuffer.size() );
 
-        StringVector argValues;
         SubStringRef subString( &inBuffer, 0 );
         size_t pos = subString.find( "@insertpiece" );
 
@@ -773,13 +841,13 @@ namespace Ogre
             copy( outBuffer, subString, pos );
 
             subString.setStart( subString.getStart() + pos + sizeof( "@insertpiece" ) );
-            evaluateParamArgs( subString, argValues, syntaxError );
+            const size_t numArgs = evaluateParamArgs( subString, mArgValues, syntaxError );
 
-            syntaxError |= argValues.size() != 1;
+            syntaxError |= numArgs != 1;
 
             if( !syntaxError )
             {
-                const IdString pieceName( argValues[0] );
+                const IdString pieceName( mArgValues[0] );
                 PiecesMap::const_iterator it = mPieces.find( pieceName );
                 if( it != mPieces.end() )
                     outBuffer += it->second;
@@ -809,7 +877,6 @@ namespace Ogre
         outBuffer.clear();
         outBuffer.reserve( inBuffer.size() );
 
-        StringVector argValues;
         SubStringRef subString( &inBuffer, 0 );
         size_t _pos[2];
         _pos[0] = subString.find( "@counter" );
@@ -837,13 +904,13 @@ namespace Ogre
 
             subString.setStart( subString.getStart() + pos +
                                 (keyword == 0 ? sizeof( "@counter" ) : sizeof( "@value" )) );
-            evaluateParamArgs( subString, argValues, syntaxError );
+            const size_t numArgs = evaluateParamArgs( subString, mArgValues, syntaxError );
 
-            syntaxError |= argValues.size() != 1;
+            syntaxError |= numArgs != 1;
 
             if( !syntaxError )
             {
-                const IdString propertyKey( argValues[0] );
+                const IdString propertyKey( mArgValues[0] );
                 int32 count = getProperty( propertyKey );
                 char tmp[16];
                 sprintf( tmp, "%i", count );
@@ -891,14 +958,19 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void Hlms::addRenderableCache( uint32 hash, const HlmsPropertyVec &renderableSetProperties )
     {
-        HlmsCache cache( hash );
-        HlmsCacheVec::iterator it = std::lower_bound( mRenderableCache.begin(), mRenderableCache.end(),
-                                                      cache, OrderCacheByHash );
+        addCacheEntry( mRenderableCache, hash, renderableSetProperties );
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::addCacheEntry( HlmsCacheVec &cache, uint32 hash, const HlmsPropertyVec &setProperties )
+    {
+        HlmsCache entry( hash );
+        HlmsCacheVec::iterator it = std::lower_bound( cache.begin(), cache.end(),
+                                                      entry, OrderCacheByHash );
 
-        if( it == mRenderableCache.end() || it->hash != hash )
+        if( it == cache.end() || it->hash != hash )
         {
-            cache.setProperties = renderableSetProperties;
-            mRenderableCache.insert( it, cache );
+            entry.setProperties = setProperties;
+            cache.insert( it, entry );
         }
     }
     //-----------------------------------------------------------------------------------
@@ -930,7 +1002,8 @@ namespace Ogre
         return retVal;
     }
     //-----------------------------------------------------------------------------------
-    const HlmsCache* Hlms::addShaderCache( uint32 hash, GpuProgramPtr &vertexShader,
+    const HlmsCache* Hlms::addShaderCache( uint32 hash, const HlmsPropertyVec &setProperties,
+                                           GpuProgramPtr &vertexShader,
                                            GpuProgramPtr &geometryShader,
                                            GpuProgramPtr &tesselationHullShader,
                                            GpuProgramPtr &tesselationDomainShader,
@@ -943,6 +1016,7 @@ namespace Ogre
         assert( it == mShaderCache.end() || it->hash != hash &&
                 "Can't add the same shader to the cache twice! (or a hash collision happened)" );
 
+        cache.setProperties             = setProperties;
         cache.vertexShader              = vertexShader;
         cache.geometryShader            = geometryShader;
         cache.tesselationHullShader     = tesselationHullShader;
@@ -964,8 +1038,7 @@ namespace Ogre
         return 0;
     }
     //-----------------------------------------------------------------------------------
-    const HlmsCache* Hlms::createShaderCacheEntry( uint32 renderableHash, const HlmsCache &passCache,
-                                                   uint32 finalHash )
+    void Hlms::mergeProperties( uint32 renderableHash, const HlmsCache &passCache )
     {
         //Set the properties by merging the cache from the pass, with the cache from renderable
         mSetProperties.clear();
@@ -986,57 +1059,99 @@ namespace Ogre
                 ++itor;
             }
         }
+    }
+    //-----------------------------------------------------------------------------------
+    const HlmsCache* Hlms::createShaderCacheEntry( uint32 renderableHash, const HlmsCache &passCache,
+                                                   uint32 finalHash )
+    {
+        mergeProperties( renderableHash, passCache );
+
+        String sources[NumShaderTypes];
+        generateShaderSources( sources );
+
+        return createShaderCacheEntry( finalHash, sources );
+    }
+    //-----------------------------------------------------------------------------------
+    const HlmsCache* Hlms::queueShaderCacheEntry( uint32 renderableHash, const HlmsCache &passCache,
+                                                  uint32 finalHash )
+    {
+        if( mPendingShaders.find( finalHash ) == mPendingShaders.end() )
+        {
+            mergeProperties( renderableHash, passCache );
+
+            GenerateShaderRequest request;
+            request.hlms            = this;
+            request.finalHash       = finalHash;
+            request.setProperties   = mSetProperties;
+
+            //Without threads the response is handled (and erased) inside addRequest
+            mPendingShaders[finalHash] = 0;
+            const WorkQueue::RequestID requestId = Root::getSingleton().getWorkQueue()->addRequest(
+                                                            mWorkQueueChannel, 0, Any( request ) );
+            PendingShaderMap::iterator itor = mPendingShaders.find( finalHash );
+            if( itor != mPendingShaders.end() )
+                itor->second = requestId;
+        }
+
+        return mUseFallbackCache ? &mFallbackCache : 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::generateShaderSources( String outSources[NumShaderTypes] )
+    {
+        String &inString  = mPreprocessorBuffers[0];
+        String &outString = mPreprocessorBuffers[1];
 
-        GpuProgramPtr shaders[NumShaderTypes];
         //Generate the shaders
         for( size_t i=0; i<NumShaderTypes; ++i )
         {
+            outSources[i].clear();
+
             //Collect pieces
             mPieces.clear();
-            StringVector::const_iterator itor = mPieceFiles[i].begin();
-            StringVector::const_iterator end  = mPieceFiles[i].end();
+            StringVector::const_iterator itor = mPieceFileContents[i].begin();
+            StringVector::const_iterator end  = mPieceFileContents[i].end();
 
             while( itor != end )
             {
-                DataStreamPtr inFile = mDataFolder->open( *itor );
-
-                String inString;
-                String outString;
-
-                inString.resize( inFile->size() );
-                inFile->read( &inString[0], inFile->size() );
-
-                this->parseForEach( inString, outString );
+                this->parseForEach( *itor, outString );
                 this->parseProperties( outString, inString );
                 this->collectPieces( inString, outString );
                 ++itor;
             }
 
-            //Generate the shader file. TODO: Identify the file extension at runtime
-            const String filename = ShaderFiles[i] + ".glsl";
-            if( mDataFolder->exists( filename ) )
+            //Generate the shader file.
+            if( !mTemplateContents[i].empty() )
             {
-                DataStreamPtr inFile = mDataFolder->open( filename );
-
-                String inString;
-                String outString;
-
-                inString.resize( inFile->size() );
-                inFile->read( &inString[0], inFile->size() );
-
-                this->parseForEach( inString, outString );
+                this->parseForEach( mTemplateContents[i], outString );
                 this->parseProperties( outString, inString );
                 this->collectPieces( inString, outString );
                 this->insertPieces( outString, inString );
                 this->parseCounter( inString, outString );
 
-                HighLevelGpuProgramManager *gpuProgramManager =
-                                                        HighLevelGpuProgramManager::getSingletonPtr();
+                //Copy instead of swapping, so the buffers keep their capacity
+                outSources[i] = outString;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    const HlmsCache* Hlms::createShaderCacheEntry( uint32 finalHash,
+                                                   const String sources[NumShaderTypes] )
+    {
+        HighLevelGpuProgramManager *gpuProgramManager = HighLevelGpuProgramManager::getSingletonPtr();
 
+        GpuProgramPtr shaders[NumShaderTypes];
+        for( size_t i=0; i<NumShaderTypes; ++i )
+        {
+            if( !sources[i].empty() )
+            {
+                //The name must only depend on the hash, so that it's the same
+                //across runs and can be used to look up the microcode cache.
                 HighLevelGpuProgramPtr gp = gpuProgramManager->createProgram(
-                                    "name", ResourceGroupManager::INTERNAL_RESOURCE_GROUP_NAME,
+                                    "Hlms/" + StringConverter::toString( finalHash ) + "/" +
+                                    ShaderFiles[i],
+                                    ResourceGroupManager::INTERNAL_RESOURCE_GROUP_NAME,
                                     "glsl", static_cast<GpuProgramType>(i) );
-                gp->setSource( outString );
+                gp->setSource( sources[i] );
 
                 gp->setSkeletalAnimationIncluded( getProperty( HlmsPropertySkeleton ) != 0 );
                 gp->setMorphAnimationIncluded( false );
@@ -1047,47 +1162,72 @@ namespace Ogre
             }
         }
 
-        const HlmsCache* retVal = addShaderCache( finalHash, shaders[VertexShader],
+        const HlmsCache* retVal = addShaderCache( finalHash, mSetProperties, shaders[VertexShader],
                                                   shaders[GeometryShader], shaders[HullShader],
                                                   shaders[DomainShader], shaders[PixelShader] );
         return retVal;
     }
     //-----------------------------------------------------------------------------------
-    uint32 Hlms::calculateRenderableHash(void) const
+    uint32 Hlms::calculateRenderableHash( const HlmsPropertyVec &properties ) const
     {
         //Change per material (hash can be cached on the renderable)
         //If you alter the bit shifting here, you'll have to change the masks in Hlms::getMaterial
-        uint32 hash = getProperty( HlmsPropertySkeleton ) |
-                (getProperty( HlmsPropertyBonesPerVertex )  << 1)|
-                (getProperty( HlmsPropertyNormal )          << 3)|
-                (getProperty( HlmsPropertyQTangent )        << 4)|
-                (getProperty( HlmsPropertyUvCount )         << 5 )|
-                ((getProperty( HlmsPropertyUvCount0 ) - 1)  << 9 )|
-                ((getProperty( HlmsPropertyUvCount1 ) - 1)  << 11)|
-                ((getProperty( HlmsPropertyUvCount2 ) - 1)  << 13)|
-                ((getProperty( HlmsPropertyUvCount3 ) - 1)  << 15)|
-                ((getProperty( HlmsPropertyUvCount4 ) - 1)  << 17)|
-                ((getProperty( HlmsPropertyUvCount5 ) - 1)  << 19)|
-                ((getProperty( HlmsPropertyUvCount6 ) - 1)  << 21)|
-                ((getProperty( HlmsPropertyUvCount7 ) - 1)  << 23)|
-                (getProperty( PropertyDiffuseMap )          << 25)|
-                (getProperty( PropertyNormalMap )           << 26)|
-                (getProperty( PropertySpecularMap )         << 27)|
-                (getProperty( PropertyEnvProbeMap )         << 28)|
-                (getProperty( PropertyAlphaTest )           << 29)|
-                (getProperty( HlmsPropertyPose )            << 29);
+        uint32 hash = getProperty( properties, HlmsPropertySkeleton ) |
+                (getProperty( properties, HlmsPropertyBonesPerVertex )  << 1)|
+                (getProperty( properties, HlmsPropertyNormal )          << 3)|
+                (getProperty( properties, HlmsPropertyQTangent )        << 4)|
+                (getProperty( properties, HlmsPropertyUvCount )         << 5 )|
+                ((getProperty( properties, HlmsPropertyUvCount0 ) - 1)  << 9 )|
+                ((getProperty( properties, HlmsPropertyUvCount1 ) - 1)  << 11)|
+                ((getProperty( properties, HlmsPropertyUvCount2 ) - 1)  << 13)|
+                ((getProperty( properties, HlmsPropertyUvCount3 ) - 1)  << 15)|
+                ((getProperty( properties, HlmsPropertyUvCount4 ) - 1)  << 17)|
+                ((getProperty( properties, HlmsPropertyUvCount5 ) - 1)  << 19)|
+                ((getProperty( properties, HlmsPropertyUvCount6 ) - 1)  << 21)|
+                ((getProperty( properties, HlmsPropertyUvCount7 ) - 1)  << 23)|
+                (getProperty( properties, PropertyDiffuseMap )          << 25)|
+                (getProperty( properties, PropertyNormalMap )           << 26)|
+                (getProperty( properties, PropertySpecularMap )         << 27)|
+                (getProperty( properties, PropertyEnvProbeMap )         << 28)|
+                (getProperty( properties, PropertyAlphaTest )           << 29)|
+                (getProperty( properties, HlmsPropertyPose )            << 29);
         return hash;
     }
     //-----------------------------------------------------------------------------------
     void Hlms::calculateHashFor( Renderable *renderable, const HlmsParamVec &params,
                                  uint32 &outHash, uint32 &outCasterHash )
     {
-        mSetProperties.clear();
         mPieces.clear();
 
+        HlmsPropertyVec casterProperties;
+        calculateHashes( renderable, params, mSetProperties, casterProperties,
+                         outHash, outCasterHash );
+
+        this->addRenderableCache( outHash, mSetProperties );
+        this->addRenderableCache( outCasterHash, casterProperties );
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::calculateHashes( Renderable *renderable, const HlmsParamVec &params,
+                                HlmsPropertyVec &outProperties,
+                                HlmsPropertyVec &outCasterProperties,
+                                uint32 &outHash, uint32 &outCasterHash ) const
+    {
+        fillRenderableProperties( renderable, params, outProperties );
+        outHash = calculateRenderableHash( outProperties );
+
+        outCasterProperties = outProperties;
+        toCasterProperties( outCasterProperties );
+        outCasterHash = calculateRenderableHash( outCasterProperties );
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::fillRenderableProperties( Renderable *renderable, const HlmsParamVec &params,
+                                         HlmsPropertyVec &outProperties ) const
+    {
+        outProperties.clear();
+
         uint16 numWorldTransforms = renderable->getNumWorldTransforms();//TODO: Remove virtualness
 
-        setProperty( HlmsPropertySkeleton, numWorldTransforms > 1 );
+        setProperty( outProperties, HlmsPropertySkeleton, numWorldTransforms > 1 );
 
         RenderOperation op;
         renderable->getRenderOperation( op );
@@ -1106,12 +1246,12 @@ namespace Ogre
             case VES_NORMAL:
                 if( VertexElement::getTypeCount( vertexElem.getType() ) < 4 )
                 {
-                    setProperty( HlmsPropertyNormal, 1 );
+                    setProperty( outProperties, HlmsPropertyNormal, 1 );
                 }
                 else
                 {
                     normalMappedCanBeSupported = true;
-                    setProperty( HlmsPropertyQTangent, 1 );
+                    setProperty( outProperties, HlmsPropertyQTangent, 1 );
                 }
                 break;
             case VES_TANGENT:
@@ -1119,11 +1259,11 @@ namespace Ogre
                 break;
             case VES_TEXTURE_COORDINATES:
                 numTexCoords = std::max<uint>( numTexCoords, vertexElem.getIndex() + 1 );
-                setProperty( *UvCountPtrs[vertexElem.getIndex()],
+                setProperty( outProperties, *UvCountPtrs[vertexElem.getIndex()],
                               VertexElement::getTypeCount( vertexElem.getType() ) );
                 break;
             case VES_BLEND_WEIGHTS:
-                setProperty( HlmsPropertyBonesPerVertex,
+                setProperty( outProperties, HlmsPropertyBonesPerVertex,
                              VertexElement::getTypeCount( vertexElem.getType() ) );
                 break;
             default:
@@ -1134,40 +1274,114 @@ namespace Ogre
             ++itor;
         }
 
-        setProperty( HlmsPropertyUvCount, numTexCoords );
+        setProperty( outProperties, HlmsPropertyUvCount, numTexCoords );
 
         String paramVal;
         if( findParamInVec( params, PropertyDiffuseMap, paramVal ) )
-            setProperty( PropertyDiffuseMap, 1 );
+            setProperty( outProperties, PropertyDiffuseMap, 1 );
         if( normalMappedCanBeSupported && findParamInVec( params, PropertyNormalMap, paramVal ) )
-            setProperty( PropertyNormalMap, 1 );
+            setProperty( outProperties, PropertyNormalMap, 1 );
         if( findParamInVec( params, PropertySpecularMap, paramVal ) )
-            setProperty( PropertySpecularMap, 1 );
+            setProperty( outProperties, PropertySpecularMap, 1 );
         if( findParamInVec( params, PropertyEnvProbeMap, paramVal ) )
-            setProperty( PropertyEnvProbeMap, 1 );
-        bool alphaTest = findParamInVec( params, PropertyAlphaTest, paramVal );
-        if( alphaTest )
-            setProperty( PropertyAlphaTest, 1 );
+            setProperty( outProperties, PropertyEnvProbeMap, 1 );
+        if( findParamInVec( params, PropertyAlphaTest, paramVal ) )
+            setProperty( outProperties, PropertyAlphaTest, 1 );
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::toCasterProperties( HlmsPropertyVec &inOutProperties ) const
+    {
+        //For shadow casters, turn normals off. UVs & diffuse also off unless there's alpha testing.
+        setProperty( inOutProperties, HlmsPropertyNormal, 0 );
+        setProperty( inOutProperties, HlmsPropertyQTangent, 0 );
+        setProperty( inOutProperties, PropertyNormalMap, 0 );
+        setProperty( inOutProperties, PropertySpecularMap, 0 );
+        setProperty( inOutProperties, PropertyEnvProbeMap, 0 );
+        if( !getProperty( inOutProperties, PropertyAlphaTest ) )
+        {
+            setProperty( inOutProperties, HlmsPropertyUvCount, 0 );
+            setProperty( inOutProperties, PropertyDiffuseMap, 0 );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::calculateHashForBatch( const RenderableParamsVec &renderables,
+                                      SceneManager *sceneManager )
+    {
+        size_t numThreads = 1;
+        if( renderables.size() >= PARALLEL_HASH_THRESHOLD && sceneManager )
+            numThreads = sceneManager->getNumWorkerThreads();
 
-        uint32 renderableHash = calculateRenderableHash();
-        this->addRenderableCache( renderableHash, mSetProperties );
+        HashBatchTask task( this, renderables, numThreads );
 
-        //For shadow casters, turn normals off. UVs & diffuse also off unless there's alpha testing.
-        setProperty( HlmsPropertyNormal, 0 );
-        setProperty( HlmsPropertyQTangent, 0 );
-        setProperty( PropertyNormalMap, 0 );
-        setProperty( PropertySpecularMap, 0 );
-        setProperty( PropertyEnvProbeMap, 0 );
-        if( !alphaTest )
+        if( numThreads > 1 )
+            sceneManager->executeUserScalableTask( &task, true );
+        else
+            task.execute( 0, 1 );
+
+        task.mergeNewEntries( this );
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    Hlms::HashBatchTask::HashBatchTask( const Hlms *hlms, const RenderableParamsVec &renderables,
+                                        size_t numThreads ) :
+        mHlms( hlms ),
+        mRenderables( renderables ),
+        mThreadData( numThreads )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::HashBatchTask::mergeNewEntries( Hlms *hlms ) const
+    {
+        ThreadDataVec::const_iterator itThread = mThreadData.begin();
+        ThreadDataVec::const_iterator enThread = mThreadData.end();
+
+        while( itThread != enThread )
         {
-            setProperty( HlmsPropertyUvCount, 0 );
-            setProperty( PropertyDiffuseMap, 0 );
+            HlmsCacheVec::const_iterator itor = itThread->newEntries.begin();
+            HlmsCacheVec::const_iterator end  = itThread->newEntries.end();
+
+            while( itor != end )
+            {
+                hlms->addRenderableCache( itor->hash, itor->setProperties );
+                ++itor;
+            }
+
+            ++itThread;
         }
-        uint32 renderableCasterHash = calculateRenderableHash();
-        this->addRenderableCache( renderableCasterHash, mSetProperties );
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::HashBatchTask::execute( size_t threadId, size_t numThreads )
+    {
+        assert( numThreads == mThreadData.size() );
+
+        ThreadData &threadData = mThreadData[threadId];
+
+        const size_t numRenderables = mRenderables.size();
+        const size_t renderablesPerThread = (numRenderables + numThreads - 1) / numThreads;
+        const size_t start  = std::min( threadId * renderablesPerThread, numRenderables );
+        const size_t end    = std::min( start + renderablesPerThread, numRenderables );
+
+        for( size_t i=start; i<end; ++i )
+        {
+            Renderable *renderable = mRenderables[i].renderable;
+
+            uint32 renderableHash, renderableCasterHash;
+            mHlms->calculateHashes( renderable, *mRenderables[i].params, threadData.properties,
+                                    threadData.casterProperties,
+                                    renderableHash, renderableCasterHash );
+
+            //The renderable cache isn't modified until all threads are done
+            if( !mHlms->getRenderableCache( renderableHash ) )
+                addCacheEntry( threadData.newEntries, renderableHash, threadData.properties );
+            if( !mHlms->getRenderableCache( renderableCasterHash ) )
+            {
+                addCacheEntry( threadData.newEntries, renderableCasterHash,
+                               threadData.casterProperties );
+            }
 
-        outHash         = renderableHash;
-        outCasterHash   = renderableCasterHash;
+            renderable->_setHlmsHashes( renderableHash, renderableCasterHash );
+        }
     }
     //-----------------------------------------------------------------------------------
     HlmsCache Hlms::preparePassHash( const CompositorShadowNode *shadowNode, bool casterPass,
@@ -1300,11 +1514,348 @@ namespace Ogre
         HlmsCache const *retVal = this->getShaderCache( finalHash );
 
         if( !retVal )
-            retVal = createShaderCacheEntry( hash[0], passCache, finalHash );
+        {
+            if( mAsyncShaderGeneration )
+                retVal = queueShaderCacheEntry( hash[0], passCache, finalHash );
+            else
+                retVal = createShaderCacheEntry( hash[0], passCache, finalHash );
+        }
 
         return retVal;
     }
     //-----------------------------------------------------------------------------------
+    void Hlms::saveShaderCache( DataStreamPtr &stream ) const
+    {
+        if( !stream->isWriteable() )
+        {
+            OGRE_EXCEPT( Exception::ERR_CANNOT_WRITE_TO_FILE,
+                         "Unable to write to stream " + stream->getName(),
+                         "Hlms::saveShaderCache" );
+        }
+
+        //Debug builds save the IdString debug strings of the properties too
+#ifndef NDEBUG
+        const uint32 debugStrSize = OGRE_DEBUG_STR_SIZE;
+#else
+        const uint32 debugStrSize = 0;
+#endif
+        const uint32 header[5] = { HlmsShaderCacheMagic, HlmsShaderCacheVersion, debugStrSize,
+                                   mTemplateHash, static_cast<uint32>( mShaderCache.size() ) };
+        stream->write( header, sizeof( header ) );
+
+        HlmsCacheVec::const_iterator itor = mShaderCache.begin();
+        HlmsCacheVec::const_iterator end  = mShaderCache.end();
+
+        while( itor != end )
+        {
+            const uint32 entryHeader[2] = { itor->hash,
+                                            static_cast<uint32>( itor->setProperties.size() ) };
+            stream->write( entryHeader, sizeof( entryHeader ) );
+
+            HlmsPropertyVec::const_iterator itProp = itor->setProperties.begin();
+            HlmsPropertyVec::const_iterator enProp = itor->setProperties.end();
+            while( itProp != enProp )
+            {
+                stream->write( &itProp->keyName.mHash, sizeof( uint32 ) );
+                stream->write( &itProp->value, sizeof( int32 ) );
+#ifndef NDEBUG
+                stream->write( itProp->keyName.mDebugString, OGRE_DEBUG_STR_SIZE );
+#endif
+                ++itProp;
+            }
+
+            const GpuProgramPtr *shaders[NumShaderTypes];
+            shaders[VertexShader]   = &itor->vertexShader;
+            shaders[PixelShader]    = &itor->pixelShader;
+            shaders[GeometryShader] = &itor->geometryShader;
+            shaders[HullShader]     = &itor->tesselationHullShader;
+            shaders[DomainShader]   = &itor->tesselationDomainShader;
+
+            for( size_t i=0; i<NumShaderTypes; ++i )
+            {
+                const String &source = shaders[i]->isNull() ? BLANKSTRING : (*shaders[i])->getSource();
+                const uint32 sourceLength = static_cast<uint32>( source.size() );
+                stream->write( &sourceLength, sizeof( uint32 ) );
+                if( sourceLength )
+                    stream->write( source.c_str(), sourceLength );
+            }
+
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    namespace
+    {
+        size_t getRemainingBytes( const DataStreamPtr &stream )
+        {
+            const size_t streamSize = stream->size();
+            const size_t position   = stream->tell();
+            return streamSize > position ? streamSize - position : 0;
+        }
+
+        bool readExact( DataStreamPtr &stream, void *outData, size_t numBytes )
+        {
+            return numBytes <= getRemainingBytes( stream ) &&
+                   stream->read( outData, numBytes ) == numBytes;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool Hlms::readShaderCacheEntries( DataStreamPtr &stream, uint32 numEntries,
+                                       uint32 debugStrSize, CachedShaderVec &outEntries )
+    {
+        const size_t propertySize = sizeof( uint32 ) + sizeof( int32 ) + debugStrSize;
+        const size_t minEntrySize = sizeof( uint32 ) * 2 + sizeof( uint32 ) * NumShaderTypes;
+
+        //Counts & lengths come from the file. Don't trust them beyond what's left in it.
+        if( debugStrSize > getRemainingBytes( stream ) ||
+            numEntries > getRemainingBytes( stream ) / minEntrySize )
+        {
+            return false;
+        }
+
+        outEntries.resize( numEntries );
+
+        for( uint32 i=0; i<numEntries; ++i )
+        {
+            CachedShader &entry = outEntries[i];
+
+            uint32 entryHeader[2];
+            if( !readExact( stream, entryHeader, sizeof( entryHeader ) ) ||
+                entryHeader[1] > getRemainingBytes( stream ) / propertySize )
+            {
+                return false;
+            }
+
+            entry.hash = entryHeader[0];
+            entry.setProperties.reserve( entryHeader[1] );
+            for( uint32 j=0; j<entryHeader[1]; ++j )
+            {
+                IdString keyName;
+                int32 value;
+                if( !readExact( stream, &keyName.mHash, sizeof( uint32 ) ) ||
+                    !readExact( stream, &value, sizeof( int32 ) ) )
+                {
+                    return false;
+                }
+#ifndef NDEBUG
+                if( !readExact( stream, keyName.mDebugString, OGRE_DEBUG_STR_SIZE ) )
+                    return false;
+                keyName.mDebugString[OGRE_DEBUG_STR_SIZE-1] = '\0';
+#else
+                stream->skip( debugStrSize );
+#endif
+                entry.setProperties.push_back( HlmsProperty( keyName, value ) );
+            }
+
+            for( size_t j=0; j<NumShaderTypes; ++j )
+            {
+                uint32 sourceLength = 0;
+                if( !readExact( stream, &sourceLength, sizeof( uint32 ) ) ||
+                    sourceLength > getRemainingBytes( stream ) )
+                {
+                    return false;
+                }
+
+                entry.sources[j].resize( sourceLength );
+                if( sourceLength && !readExact( stream, &entry.sources[j][0], sourceLength ) )
+                    return false;
+            }
+        }
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    size_t Hlms::loadShaderCache( DataStreamPtr &stream, bool regenerateOutdated )
+    {
+        uint32 header[5];
+        if( stream->read( header, sizeof( header ) ) != sizeof( header ) ||
+            header[0] != HlmsShaderCacheMagic || header[1] != HlmsShaderCacheVersion )
+        {
+            LogManager::getSingleton().logMessage( "Hlms: Ignoring shader cache '" +
+                                                   stream->getName() + "'. Unknown format or version." );
+            return 0;
+        }
+
+        const uint32 debugStrSize = header[2];
+#ifndef NDEBUG
+        //Debug builds assert if two IdStrings with the same hash have different debug strings
+        if( debugStrSize != OGRE_DEBUG_STR_SIZE )
+        {
+            LogManager::getSingleton().logMessage( "Hlms: Ignoring shader cache '" +
+                                                   stream->getName() + "'. Debug builds can only "
+                                                   "load caches saved by debug builds." );
+            return 0;
+        }
+#endif
+
+        const bool outdated = header[3] != mTemplateHash;
+        if( outdated && !regenerateOutdated )
+        {
+            LogManager::getSingleton().logMessage( "Hlms: Ignoring shader cache '" +
+                                                   stream->getName() + "'. The templates changed." );
+            return 0;
+        }
+
+        //Read & validate everything before creating any program. A truncated or
+        //corrupted cache is discarded as a whole; its shaders get generated again
+        //when they're needed.
+        const uint32 numEntries = header[4];
+        CachedShaderVec entries;
+        if( !readShaderCacheEntries( stream, numEntries, debugStrSize, entries ) )
+        {
+            LogManager::getSingleton().logMessage( "Hlms: Ignoring shader cache '" +
+                                                   stream->getName() + "'. The file is "
+                                                   "truncated or corrupted." );
+            return 0;
+        }
+
+        size_t numLoaded = 0;
+
+        CachedShaderVec::iterator itor = entries.begin();
+        CachedShaderVec::iterator end  = entries.end();
+
+        while( itor != end )
+        {
+            if( !getShaderCache( itor->hash ) )
+            {
+                mSetProperties.swap( itor->setProperties );
+
+                if( outdated )
+                    generateShaderSources( itor->sources );
+
+                createShaderCacheEntry( itor->hash, itor->sources );
+                ++numLoaded;
+            }
+
+            ++itor;
+        }
+
+        mSetProperties.clear();
+
+        return numLoaded;
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::clearShaderCache(void)
+    {
+        HighLevelGpuProgramManager *gpuProgramManager = HighLevelGpuProgramManager::getSingletonPtr();
+
+        HlmsCacheVec::const_iterator itor = mShaderCache.begin();
+        HlmsCacheVec::const_iterator end  = mShaderCache.end();
+
+        while( itor != end )
+        {
+            const GpuProgramPtr *shaders[NumShaderTypes];
+            shaders[VertexShader]   = &itor->vertexShader;
+            shaders[PixelShader]    = &itor->pixelShader;
+            shaders[GeometryShader] = &itor->geometryShader;
+            shaders[HullShader]     = &itor->tesselationHullShader;
+            shaders[DomainShader]   = &itor->tesselationDomainShader;
+
+            for( size_t i=0; i<NumShaderTypes; ++i )
+            {
+                if( !shaders[i]->isNull() )
+                    gpuProgramManager->remove( (*shaders[i])->getHandle() );
+            }
+
+            ++itor;
+        }
+
+        mShaderCache.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::setAsyncShaderGeneration( bool async )
+    {
+        if( mAsyncShaderGeneration == async )
+            return;
+
+        WorkQueue *workQueue = Root::getSingleton().getWorkQueue();
+
+        if( async )
+        {
+            if( !mBackgroundGenerator )
+                mBackgroundGenerator = OGRE_NEW Hlms( mDataFolder );
+
+            mWorkQueueChannel = workQueue->getChannel( "Ogre/Hlms" );
+            workQueue->addRequestHandler( mWorkQueueChannel, this );
+            workQueue->addResponseHandler( mWorkQueueChannel, this );
+        }
+        else
+        {
+            workQueue->removeRequestHandler( mWorkQueueChannel, this );
+            workQueue->removeResponseHandler( mWorkQueueChannel, this );
+
+            //Responses that didn't arrive are lost, let them be queued again. The requests
+            //must go too: they point to us, and another Hlms may later live at our address.
+            PendingShaderMap::const_iterator itor = mPendingShaders.begin();
+            PendingShaderMap::const_iterator end  = mPendingShaders.end();
+            while( itor != end )
+            {
+                workQueue->abortRequest( itor->second );
+                ++itor;
+            }
+            mPendingShaders.clear();
+        }
+
+        mAsyncShaderGeneration = async;
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::setFallbackCache( const HlmsCache *fallback )
+    {
+        mUseFallbackCache = fallback != 0;
+        mFallbackCache = fallback ? *fallback : HlmsCache( 0 );
+    }
+    //-----------------------------------------------------------------------------------
+    bool Hlms::canHandleRequest( const WorkQueue::Request *req, const WorkQueue *srcQ )
+    {
+        const GenerateShaderRequest &request = any_cast<GenerateShaderRequest>( req->getData() );
+        //Other Hlms instances share the channel
+        if( request.hlms != this )
+            return false;
+
+        return RequestHandler::canHandleRequest( req, srcQ );
+    }
+    //-----------------------------------------------------------------------------------
+    WorkQueue::Response* Hlms::handleRequest( const WorkQueue::Request *req, const WorkQueue *srcQ )
+    {
+        //Background thread (maybe)
+        const GenerateShaderRequest &request = any_cast<GenerateShaderRequest>( req->getData() );
+
+        GenerateShaderResponse response;
+        {
+            OGRE_LOCK_MUTEX( mBackgroundGeneratorMutex );
+            mBackgroundGenerator->mSetProperties = request.setProperties;
+            mBackgroundGenerator->generateShaderSources( response.sources );
+        }
+
+        return OGRE_NEW WorkQueue::Response( req, true, Any( response ) );
+    }
+    //-----------------------------------------------------------------------------------
+    bool Hlms::canHandleResponse( const WorkQueue::Response *res, const WorkQueue *srcQ )
+    {
+        const GenerateShaderRequest &request =
+                any_cast<GenerateShaderRequest>( res->getRequest()->getData() );
+        return request.hlms == this;
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::handleResponse( const WorkQueue::Response *res, const WorkQueue *srcQ )
+    {
+        //Main thread
+        const GenerateShaderRequest &request =
+                any_cast<GenerateShaderRequest>( res->getRequest()->getData() );
+
+        mPendingShaders.erase( request.finalHash );
+
+        //A synchronous getMaterial or loadShaderCache may have created it in the meantime
+        if( res->succeeded() && !getShaderCache( request.finalHash ) )
+        {
+            const GenerateShaderResponse &response =
+                    any_cast<GenerateShaderResponse>( res->getData() );
+
+            mSetProperties = request.setProperties;
+            createShaderCacheEntry( request.finalHash, response.sources );
+        }
+    }
+    //-----------------------------------------------------------------------------------
     /*void Hlms::generateFor()
     {
         uint16 numWorldTransforms = 1;
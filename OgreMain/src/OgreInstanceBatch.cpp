@@ -123,7 +123,9 @@ namespace Ogre
                         "InstanceBatch::checkSubMeshCompatibility");
         }
 
-        if( !mCustomParams.empty() && mCreator->getInstancingTechnique() != InstanceManager::HWInstancingBasic )
+        if( !mCustomParams.empty() &&
+            mCreator->getInstancingTechnique() != InstanceManager::HWInstancingBasic &&
+            mCreator->getInstancingTechnique() != InstanceManager::HWInstancingUnified )
         {
             //Implementing this for ShaderBased is impossible. All other variants can be.
             OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "Custom parameters not supported for this "
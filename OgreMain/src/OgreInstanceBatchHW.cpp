@@ -280,4 +280,14 @@ namespace Ogre
                 queue->addRenderable( this, mRenderQueueID, mRenderQueuePriority );
         }*/
     }
+    //-----------------------------------------------------------------------
+    void InstanceBatchHW::instanceBatchCullFrustumThreaded( const Frustum *frustum,
+                                                       const Camera *lodCamera,
+                                                       uint32 combinedVisibilityFlags,
+                                                       size_t threadIdx )
+    {
+        //We may get called in single threaded mode too if there are unified batches around
+        if( mManager->getInstancingThreadedCullingMethod() == INSTANCING_CULLING_THREADED )
+            instanceBatchCullFrustumThreadedImpl( frustum, lodCamera, combinedVisibilityFlags );
+    }
 }
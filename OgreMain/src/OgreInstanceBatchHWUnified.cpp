@@ -0,0 +1,255 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreInstanceBatchHWUnified.h"
+#include "OgreInstanceManager.h"
+#include "OgreInstancedEntity.h"
+#include "OgreHardwareBufferManager.h"
+#include "OgreRenderQueue.h"
+#include "OgreSceneManager.h"
+
+namespace Ogre
+{
+    const size_t UnifiedInstanceStream::PARALLEL_THRESHOLD = 1024;
+    //-----------------------------------------------------------------------
+    UnifiedInstanceStream::UnifiedInstanceStream( SceneManager *sceneManager,
+                                                  const RenderOperation &baseRenderOperation,
+                                                  unsigned short instanceDataSource ) :
+        mSceneManager( sceneManager ),
+        mRenderOperation( baseRenderOperation ),
+        mInstanceDataSource( instanceDataSource ),
+        mInstanceDataSize( 0 ),
+        mMappedData( 0 ),
+        mQueued( false )
+    {
+        //Clone the structures but share the buffers. We need our own binding for the
+        //instance data, and the first batch (who owns the originals) may be destroyed
+        //before us (@see InstanceManager::cleanupEmptyBatches)
+        mRenderOperation.vertexData = baseRenderOperation.vertexData->clone( false );
+        mRenderOperation.indexData  = baseRenderOperation.indexData->clone( false );
+        mRenderOperation.numberOfInstances = 0;
+
+        mInstanceDataSize = mRenderOperation.vertexData->vertexDeclaration->
+                                                    getVertexSize( mInstanceDataSource );
+
+        mThreadBatches.resize( mSceneManager->getNumWorkerThreads() );
+    }
+    //-----------------------------------------------------------------------
+    UnifiedInstanceStream::~UnifiedInstanceStream()
+    {
+        OGRE_DELETE mRenderOperation.vertexData;
+        OGRE_DELETE mRenderOperation.indexData;
+        mRenderOperation.vertexData = 0;
+        mRenderOperation.indexData  = 0;
+    }
+    //-----------------------------------------------------------------------
+    void UnifiedInstanceStream::_update(void)
+    {
+        mBatches.clear();
+        mBatchOffsets.clear();
+        mQueued = false;
+
+        //Merge in thread order. Offsets are in instances.
+        size_t numInstances = 0;
+        vector<InstanceBatchHWUnifiedArray>::type::iterator itor = mThreadBatches.begin();
+        vector<InstanceBatchHWUnifiedArray>::type::iterator end  = mThreadBatches.end();
+
+        while( itor != end )
+        {
+            InstanceBatchHWUnifiedArray::const_iterator it = itor->begin();
+            InstanceBatchHWUnifiedArray::const_iterator en = itor->end();
+
+            while( it != en )
+            {
+                mBatches.push_back( *it );
+                mBatchOffsets.push_back( numInstances );
+                numInstances += (*it)->_getNumCulledInstances();
+                ++it;
+            }
+
+            itor->clear();
+            ++itor;
+        }
+
+        mRenderOperation.numberOfInstances = numInstances;
+
+        if( !numInstances )
+            return;
+
+        HardwareVertexBufferSharedPtr &vertexBuffer = mInstanceBuffer;
+
+        if( vertexBuffer.isNull() || vertexBuffer->getNumVertices() < numInstances )
+        {
+            //Grow by 50% to avoid recreating the buffer every time a few more instances show up
+            size_t newCapacity = numInstances;
+            if( !vertexBuffer.isNull() )
+                newCapacity = std::max( numInstances, vertexBuffer->getNumVertices() * 3 / 2 );
+
+            vertexBuffer = HardwareBufferManager::getSingleton().createVertexBuffer(
+                                        mInstanceDataSize, newCapacity,
+                                        HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY_DISCARDABLE );
+            vertexBuffer->setIsInstanceData( true );
+            vertexBuffer->setInstanceDataStepRate( 1 );
+        }
+
+        mRenderOperation.vertexData->vertexBufferBinding->setBinding( mInstanceDataSource,
+                                                                       vertexBuffer );
+
+        mMappedData = static_cast<float*>( vertexBuffer->lock( 0, numInstances * mInstanceDataSize,
+                                                               HardwareBuffer::HBL_DISCARD ) );
+
+        if( numInstances < PARALLEL_THRESHOLD || mSceneManager->getNumWorkerThreads() <= 1 )
+            execute( 0, 1 );
+        else
+            mSceneManager->executeUserScalableTask( this, true );
+
+        vertexBuffer->unlock();
+        mMappedData = 0;
+    }
+    //-----------------------------------------------------------------------
+    bool UnifiedInstanceStream::_claimQueue(void)
+    {
+        if( mQueued || !mRenderOperation.numberOfInstances )
+            return false;
+
+        mQueued = true;
+        return true;
+    }
+    //-----------------------------------------------------------------------
+    void UnifiedInstanceStream::execute( size_t threadId, size_t numThreads )
+    {
+        const size_t numBatches = mBatches.size();
+        const size_t batchesPerThread = (numBatches + numThreads - 1) / numThreads;
+        const size_t start  = std::min( threadId * batchesPerThread, numBatches );
+        const size_t end    = std::min( start + batchesPerThread, numBatches );
+
+        const size_t floatsPerInstance = mInstanceDataSize / sizeof(float);
+
+        for( size_t i=start; i<end; ++i )
+            mBatches[i]->_writeCulledInstances( mMappedData + mBatchOffsets[i] * floatsPerInstance );
+    }
+    //-----------------------------------------------------------------------
+    //-----------------------------------------------------------------------
+    //-----------------------------------------------------------------------
+    InstanceBatchHWUnified::InstanceBatchHWUnified( IdType id, ObjectMemoryManager *objectMemoryManager,
+                                                    InstanceManager *creator, MeshPtr &meshReference,
+                                                    const MaterialPtr &material, size_t instancesPerBatch,
+                                                    const Mesh::IndexMap *indexToBoneMap ) :
+                InstanceBatchHW( id, objectMemoryManager, creator, meshReference, material,
+                                 instancesPerBatch, indexToBoneMap ),
+                mInstanceStream( 0 )
+    {
+    }
+    //-----------------------------------------------------------------------
+    InstanceBatchHWUnified::~InstanceBatchHWUnified()
+    {
+    }
+    //-----------------------------------------------------------------------
+    void InstanceBatchHWUnified::setupVertices( const SubMesh* baseSubMesh )
+    {
+        InstanceBatchHW::setupVertices( baseSubMesh );
+
+        //The declaration stays the same, but the buffer isn't needed
+        mRenderOperation.vertexData->vertexBufferBinding->unsetBinding( _getInstanceDataSource() );
+    }
+    //-----------------------------------------------------------------------
+    unsigned short InstanceBatchHWUnified::_getInstanceDataSource(void) const
+    {
+        return mRenderOperation.vertexData->vertexDeclaration->getMaxSource();
+    }
+    //-----------------------------------------------------------------------
+    void InstanceBatchHWUnified::buildFrom( const SubMesh *baseSubMesh,
+                                            const RenderOperation &renderOperation )
+    {
+        InstanceBatch::buildFrom( baseSubMesh, renderOperation );
+    }
+    //-----------------------------------------------------------------------
+    void InstanceBatchHWUnified::_writeCulledInstances( float * RESTRICT_ALIAS dest ) const
+    {
+        const unsigned char numCustomParams = mCreator->getNumCustomParams();
+
+        MovableObjectArray::const_iterator itor = mCulledInstances.begin();
+        MovableObjectArray::const_iterator end  = mCulledInstances.end();
+
+        while( itor != end )
+        {
+            assert( dynamic_cast<InstancedEntity*>(*itor) );
+            const InstancedEntity *instancedEntity = static_cast<InstancedEntity*>(*itor);
+
+            //Write transform matrix
+            instancedEntity->writeSingleTransform3x4( dest );
+            dest += 12;
+
+            //Write custom parameters, if any
+            const size_t customParamIdx = instancedEntity->mInstanceId * numCustomParams;
+            for( unsigned char i=0; i<numCustomParams; ++i )
+            {
+                *dest++ = mCustomParams[customParamIdx+i].x;
+                *dest++ = mCustomParams[customParamIdx+i].y;
+                *dest++ = mCustomParams[customParamIdx+i].z;
+                *dest++ = mCustomParams[customParamIdx+i].w;
+            }
+
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------
+    void InstanceBatchHWUnified::getRenderOperation( RenderOperation& op )
+    {
+        op = mInstanceStream->getRenderOperation();
+    }
+    //-----------------------------------------------------------------------
+    void InstanceBatchHWUnified::_updateRenderQueue( RenderQueue* queue, Camera *camera,
+                                                     const Camera *lodCamera )
+    {
+        //Any batch from the stream will do, they all share mesh, material & render queue.
+        if( mInstanceStream && mInstanceStream->_claimQueue() )
+            queue->addRenderable( this, mRenderQueueID, mRenderQueuePriority );
+    }
+    //-----------------------------------------------------------------------
+    void InstanceBatchHWUnified::setRenderQueueGroup( uint8 queueID )
+    {
+        const uint8 oldQueueID = mRenderQueueID;
+        InstanceBatchHW::setRenderQueueGroup( queueID );
+
+        //Batches from different render queues can't share the same draw call
+        if( mInstanceStream && oldQueueID != mRenderQueueID )
+            mCreator->_assignInstanceStream( this );
+    }
+    //-----------------------------------------------------------------------
+    void InstanceBatchHWUnified::instanceBatchCullFrustumThreaded( const Frustum *frustum,
+                                                                   const Camera *lodCamera,
+                                                                   uint32 combinedVisibilityFlags,
+                                                                   size_t threadIdx )
+    {
+        instanceBatchCullFrustumThreadedImpl( frustum, lodCamera, combinedVisibilityFlags );
+
+        if( mInstanceStream && !mCulledInstances.empty() )
+            mInstanceStream->_notifyCulled( this, threadIdx );
+    }
+}
@@ -590,4 +590,14 @@ namespace Ogre
         instancedEntity->writeDualQuatTransform( pDest, boneIdxStart, boneIdxEnd );
         ++mInstancesWritten;
     }
+    //-----------------------------------------------------------------------
+    void InstanceBatchHW_VTF::instanceBatchCullFrustumThreaded( const Frustum *frustum,
+                                                       const Camera *lodCamera,
+                                                       uint32 combinedVisibilityFlags,
+                                                       size_t threadIdx )
+    {
+        //We may get called in single threaded mode too if there are unified batches around
+        if( mManager->getInstancingThreadedCullingMethod() == INSTANCING_CULLING_THREADED )
+            instanceBatchCullFrustumThreadedImpl( frustum, lodCamera, combinedVisibilityFlags );
+    }
 }
@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include "OgreInstanceManager.h"
 #include "OgreInstanceBatchHW.h"
 #include "OgreInstanceBatchHW_VTF.h"
+#include "OgreInstanceBatchHWUnified.h"
 #include "OgreInstanceBatchShader.h"
 #include "OgreInstanceBatchVTF.h"
 #include "OgreMesh.h"
@@ -84,6 +85,16 @@ namespace Ogre
 
             ++itor;
         }
+
+        InstanceStreamMap::const_iterator itStream = mInstanceStreams.begin();
+        InstanceStreamMap::const_iterator enStream = mInstanceStreams.end();
+
+        while( itStream != enStream )
+        {
+            OGRE_DELETE itStream->second;
+            ++itStream;
+        }
+        mInstanceStreams.clear();
     }
     //----------------------------------------------------------------------
     void InstanceManager::setInstancesPerBatch( size_t instancesPerBatch )
@@ -150,6 +161,10 @@ namespace Ogre
             batch = OGRE_NEW InstanceBatchHW( -1, &mSceneManager->_getEntityMemoryManager( SCENE_DYNAMIC ), this,
                                                 mMeshReference, mat, suggestedSize, 0 );
             break;
+        case HWInstancingUnified:
+            batch = OGRE_NEW InstanceBatchHWUnified( -1, &mSceneManager->_getEntityMemoryManager( SCENE_DYNAMIC ),
+                                                    this, mMeshReference, mat, suggestedSize, 0 );
+            break;
         case HWInstancingVTF:
             batch = OGRE_NEW InstanceBatchHW_VTF( -1, &mSceneManager->_getEntityMemoryManager( SCENE_DYNAMIC ), this,
                                                     mMeshReference, mat, suggestedSize, 0 );
@@ -248,6 +263,12 @@ namespace Ogre
                                                     this, mMeshReference, mat, mInstancesPerBatch,
                                                     &idxMap );
             break;
+        case HWInstancingUnified:
+            batch = OGRE_NEW InstanceBatchHWUnified( Id::generateNewId<InstanceBatch>(),
+                                                    &mSceneManager->_getEntityMemoryManager(sceneType),
+                                                    this, mMeshReference, mat, mInstancesPerBatch,
+                                                    &idxMap );
+            break;
         case HWInstancingVTF:
             batch = OGRE_NEW InstanceBatchHW_VTF( Id::generateNewId<InstanceBatch>(),
                                                     &mSceneManager->_getEntityMemoryManager(sceneType),
@@ -298,6 +319,9 @@ namespace Ogre
 
         batch->setStatic( sceneType == SCENE_STATIC );
 
+        if( mInstancingTechnique == HWInstancingUnified )
+            _assignInstanceStream( static_cast<InstanceBatchHWUnified*>( batch ) );
+
         materialInstanceBatch.push_back( batch );
 
         return batch;
@@ -601,6 +625,43 @@ namespace Ogre
         mDirtyStaticBatches.clear();
     }
     //-----------------------------------------------------------------------
+    void InstanceManager::_updateInstanceStreams(void)
+    {
+        InstanceStreamMap::const_iterator itor = mInstanceStreams.begin();
+        InstanceStreamMap::const_iterator end  = mInstanceStreams.end();
+
+        while( itor != end )
+        {
+            itor->second->_update();
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------
+    void InstanceManager::_assignInstanceStream( InstanceBatchHWUnified *batch )
+    {
+        //All batches with the same material, scene type & render queue write to the same stream
+        const SceneMemoryMgrTypes sceneType = batch->isStatic() ? SCENE_STATIC : SCENE_DYNAMIC;
+        const InstanceStreamKey key( IdString( batch->getMaterial()->getName() +
+                                               StringConverter::toString( sceneType ) ),
+                                     batch->getRenderQueueGroup() );
+
+        UnifiedInstanceStream *instanceStream = 0;
+
+        InstanceStreamMap::const_iterator itStream = mInstanceStreams.find( key );
+        if( itStream == mInstanceStreams.end() )
+        {
+            instanceStream = OGRE_NEW UnifiedInstanceStream( mSceneManager, mSharedRenderOperation,
+                                                             batch->_getInstanceDataSource() );
+            mInstanceStreams[key] = instanceStream;
+        }
+        else
+        {
+            instanceStream = itStream->second;
+        }
+
+        batch->_setInstanceStream( instanceStream );
+    }
+    //-----------------------------------------------------------------------
     InstanceManager::InstanceBatchIterator InstanceManager::getInstanceBatchIterator(
                                         const String &materialName, SceneMemoryMgrTypes sceneType ) const
     {
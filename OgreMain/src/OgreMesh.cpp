@@ -37,11 +37,13 @@ THE SOFTWARE.
 #include "OgreException.h"
 #include "OgreMeshManager.h"
 #include "OgreEdgeListBuilder.h"
+#include "OgreMeshOptimiser.h"
 #include "OgreAnimation.h"
 #include "OgreAnimationState.h"
 #include "OgreAnimationTrack.h"
 #include "OgreOldBone.h"
 #include "OgreOptimisedUtil.h"
+#include "OgreSoftwareVertexAnimationTask.h"
 #include "OgreSkeleton.h"
 #include "OgreTangentSpaceCalc.h"
 #include "OgreLodStrategyManager.h"
@@ -244,8 +246,9 @@ namespace Ogre {
             ResourceGroupManager::getSingleton().openResource(
                 mName, mGroup, true, this);
  
-        // fully prebuffer into host RAM
-        mFreshFromDisk = DataStreamPtr(OGRE_NEW MemoryDataStream(mName,mFreshFromDisk));
+        // fully prebuffer into host RAM, unless it's already there (i.e. a memory mapped file)
+        if( !dynamic_cast<MemoryDataStream*>( mFreshFromDisk.get() ) )
+            mFreshFromDisk = DataStreamPtr(OGRE_NEW MemoryDataStream(mName,mFreshFromDisk));
     }
     //-----------------------------------------------------------------------
     void Mesh::unprepareImpl()
@@ -1305,6 +1308,297 @@ namespace Ogre {
         }
     }
     //---------------------------------------------------------------------
+    void Mesh::optimiseVertexCache( bool reorderVertices, bool reduceOverdraw )
+    {
+        if( sharedVertexData )
+            optimiseVertexCache( 0, sharedVertexData, reorderVertices, reduceOverdraw );
+
+        for( size_t i=0; i<mSubMeshList.size(); ++i )
+        {
+            if( !mSubMeshList[i]->useSharedVertices )
+            {
+                optimiseVertexCache( static_cast<unsigned short>( i + 1 ), mSubMeshList[i]->vertexData,
+                                     reorderVertices, reduceOverdraw );
+            }
+        }
+
+        if( mEdgeListsBuilt )
+        {
+            //Edge lists reference triangles & vertices by index
+            freeEdgeList();
+            buildEdgeList();
+        }
+    }
+    //---------------------------------------------------------------------
+    namespace
+    {
+        void remapBoneAssignments( Mesh::VertexBoneAssignmentList &assignments,
+                                   const vector<uint32>::type &remap )
+        {
+            Mesh::VertexBoneAssignmentList remapped;
+
+            Mesh::VertexBoneAssignmentList::const_iterator itor = assignments.begin();
+            Mesh::VertexBoneAssignmentList::const_iterator end  = assignments.end();
+            while( itor != end )
+            {
+                VertexBoneAssignment assignment = itor->second;
+                assignment.vertexIndex = remap[assignment.vertexIndex];
+                remapped.insert( Mesh::VertexBoneAssignmentList::value_type( assignment.vertexIndex,
+                                                                             assignment ) );
+                ++itor;
+            }
+
+            assignments.swap( remapped );
+        }
+
+        void remapVertexBuffer( const HardwareVertexBufferSharedPtr &vertexBuffer,
+                                const vector<uint32>::type &remap )
+        {
+            const size_t vertexSize = vertexBuffer->getVertexSize();
+            assert( vertexBuffer->getNumVertices() >= remap.size() );
+
+            unsigned char *data = static_cast<unsigned char*>(
+                        vertexBuffer->lock( 0, remap.size() * vertexSize, HardwareBuffer::HBL_NORMAL ) );
+            const vector<unsigned char>::type original( data, data + remap.size() * vertexSize );
+
+            for( size_t i=0; i<remap.size(); ++i )
+                memcpy( data + remap[i] * vertexSize, &original[i * vertexSize], vertexSize );
+
+            vertexBuffer->unlock();
+        }
+
+        void remapIndexBuffer( const HardwareIndexBufferSharedPtr &indexBuffer,
+                               const vector<uint32>::type &remap )
+        {
+            void *data = indexBuffer->lock( HardwareBuffer::HBL_NORMAL );
+
+            if( indexBuffer->getType() == HardwareIndexBuffer::IT_16BIT )
+            {
+                uint16 *indices = static_cast<uint16*>( data );
+                for( size_t i=0; i<indexBuffer->getNumIndexes(); ++i )
+                {
+                    if( indices[i] < remap.size() )
+                        indices[i] = static_cast<uint16>( remap[indices[i]] );
+                }
+            }
+            else
+            {
+                uint32 *indices = static_cast<uint32*>( data );
+                for( size_t i=0; i<indexBuffer->getNumIndexes(); ++i )
+                {
+                    if( indices[i] < remap.size() )
+                        indices[i] = remap[indices[i]];
+                }
+            }
+
+            indexBuffer->unlock();
+        }
+    }
+    //---------------------------------------------------------------------
+    void Mesh::optimiseVertexCache( unsigned short vertexDataTarget, VertexData *vertexData,
+                                    bool reorderVertices, bool reduceOverdraw )
+    {
+        const size_t vertexCount = vertexData->vertexCount;
+        if( !vertexCount )
+            return;
+
+        //Gather every index data (including LODs) using this vertex data.
+        //The main ones come first, they decide the order of the vertices.
+        vector<IndexData*>::type mainIndexData;
+        vector<IndexData*>::type triangleLists;
+        vector<IndexData*>::type allIndexData;
+        map<HardwareIndexBuffer*, size_t>::type indexBufferUsers;
+        bool allIndexed = true;
+
+        for( size_t i=0; i<mSubMeshList.size(); ++i )
+        {
+            SubMesh *subMesh = mSubMeshList[i];
+            if( (vertexDataTarget == 0) != subMesh->useSharedVertices ||
+                (vertexDataTarget != 0 && vertexDataTarget != i + 1) )
+            {
+                continue;
+            }
+
+            if( subMesh->indexData->indexBuffer.isNull() )
+            {
+                allIndexed = false;
+                continue;
+            }
+
+            mainIndexData.push_back( subMesh->indexData );
+            allIndexData.push_back( subMesh->indexData );
+            allIndexData.insert( allIndexData.end(), subMesh->mLodFaceList.begin(),
+                                 subMesh->mLodFaceList.end() );
+
+            if( subMesh->operationType == RenderOperation::OT_TRIANGLE_LIST )
+            {
+                triangleLists.push_back( subMesh->indexData );
+                triangleLists.insert( triangleLists.end(), subMesh->mLodFaceList.begin(),
+                                      subMesh->mLodFaceList.end() );
+            }
+        }
+
+        for( size_t i=0; i<allIndexData.size(); ++i )
+        {
+            if( !allIndexData[i]->indexBuffer.isNull() && allIndexData[i]->indexCount )
+                ++indexBufferUsers[allIndexData[i]->indexBuffer.get()];
+        }
+
+        //Overdraw optimisation needs the positions, in a tightly packed array.
+        vector<float>::type positions;
+        const VertexElement *posElem = vertexData->vertexDeclaration->findElementBySemantic( VES_POSITION );
+        if( reduceOverdraw && posElem && posElem->getType() == VET_FLOAT3 )
+        {
+            HardwareVertexBufferSharedPtr posBuffer =
+                    vertexData->vertexBufferBinding->getBuffer( posElem->getSource() );
+            const size_t vertexSize = posBuffer->getVertexSize();
+            const unsigned char *data = static_cast<const unsigned char*>(
+                        posBuffer->lock( vertexData->vertexStart * vertexSize, vertexCount * vertexSize,
+                                         HardwareBuffer::HBL_READ_ONLY ) );
+
+            positions.resize( vertexCount * 3 );
+            for( size_t i=0; i<vertexCount; ++i )
+            {
+                float *src;
+                posElem->baseVertexPointerToElement( const_cast<unsigned char*>( data + i * vertexSize ),
+                                                     &src );
+                positions[i * 3 + 0] = src[0];
+                positions[i * 3 + 1] = src[1];
+                positions[i * 3 + 2] = src[2];
+            }
+
+            posBuffer->unlock();
+        }
+
+        vector<uint32>::type indices;
+        for( size_t i=0; i<triangleLists.size(); ++i )
+        {
+            IndexData *indexData = triangleLists[i];
+
+            //Compressed LODs point to overlapping ranges of a single
+            //buffer, reordering one of them would break the others.
+            if( indexData->indexBuffer.isNull() || indexData->indexCount < 6 ||
+                indexBufferUsers[indexData->indexBuffer.get()] != 1 )
+            {
+                continue;
+            }
+
+            MeshOptimiser::readIndices( indexData, indices );
+
+            const uint32 maxIndex = *std::max_element( indices.begin(), indices.end() );
+            if( maxIndex >= vertexCount )
+            {
+                LogManager::getSingleton().logMessage( "Mesh::optimiseVertexCache: " + mName +
+                                                       " has out of bounds indices. Skipping." );
+                return;
+            }
+
+            MeshOptimiser::optimiseVertexCache( &indices[0], indices.size(), vertexCount );
+            if( !positions.empty() )
+            {
+                MeshOptimiser::optimiseOverdraw( &indices[0], indices.size(), &positions[0],
+                                                 sizeof(float) * 3, vertexCount );
+            }
+
+            MeshOptimiser::writeIndices( indexData, indices );
+        }
+
+        if( !reorderVertices || !allIndexed || mainIndexData.empty() ||
+            vertexData->vertexStart != 0 || mPreparedForShadowVolumes )
+        {
+            return;
+        }
+
+        //Sort the vertices in order of first use
+        vector<uint32>::type remap( vertexCount );
+        {
+            vector<uint32>::type allIndices;
+            for( size_t i=0; i<mainIndexData.size(); ++i )
+            {
+                MeshOptimiser::readIndices( mainIndexData[i], indices );
+                allIndices.insert( allIndices.end(), indices.begin(), indices.end() );
+            }
+
+            if( allIndices.empty() ||
+                *std::max_element( allIndices.begin(), allIndices.end() ) >= vertexCount )
+            {
+                return;
+            }
+
+            MeshOptimiser::buildVertexFetchRemap( &allIndices[0], allIndices.size(),
+                                                  vertexCount, &remap[0] );
+        }
+
+        {
+            set<HardwareVertexBuffer*>::type remappedBuffers;
+            const VertexBufferBinding::VertexBufferBindingMap &bindings =
+                    vertexData->vertexBufferBinding->getBindings();
+            VertexBufferBinding::VertexBufferBindingMap::const_iterator itor = bindings.begin();
+            VertexBufferBinding::VertexBufferBindingMap::const_iterator end  = bindings.end();
+            while( itor != end )
+            {
+                if( remappedBuffers.insert( itor->second.get() ).second )
+                    remapVertexBuffer( itor->second, remap );
+                ++itor;
+            }
+        }
+
+        {
+            set<HardwareIndexBuffer*>::type remappedBuffers;
+            for( size_t i=0; i<allIndexData.size(); ++i )
+            {
+                const HardwareIndexBufferSharedPtr &indexBuffer = allIndexData[i]->indexBuffer;
+                if( !indexBuffer.isNull() && remappedBuffers.insert( indexBuffer.get() ).second )
+                    remapIndexBuffer( indexBuffer, remap );
+            }
+        }
+
+        if( vertexDataTarget == 0 )
+            remapBoneAssignments( mBoneAssignments, remap );
+        else
+            remapBoneAssignments( mSubMeshList[vertexDataTarget - 1]->mBoneAssignments, remap );
+
+        for( size_t i=0; i<mPoseList.size(); ++i )
+        {
+            Pose *pose = mPoseList[i];
+            if( pose->getTarget() != vertexDataTarget )
+                continue;
+
+            const Pose::VertexOffsetMap offsets( pose->getVertexOffsets() );
+            const Pose::NormalsMap normals( pose->getNormals() );
+            pose->clearVertices();
+
+            Pose::VertexOffsetMap::const_iterator itor = offsets.begin();
+            Pose::VertexOffsetMap::const_iterator end  = offsets.end();
+            while( itor != end )
+            {
+                Pose::NormalsMap::const_iterator itNormal = normals.find( itor->first );
+                if( itNormal != normals.end() )
+                    pose->addVertex( remap[itor->first], itor->second, itNormal->second );
+                else
+                    pose->addVertex( remap[itor->first], itor->second );
+                ++itor;
+            }
+        }
+
+        AnimationList::const_iterator itAnim = mAnimationsList.begin();
+        AnimationList::const_iterator enAnim = mAnimationsList.end();
+        while( itAnim != enAnim )
+        {
+            Animation::VertexTrackIterator trackIt = itAnim->second->getVertexTrackIterator();
+            while( trackIt.hasMoreElements() )
+            {
+                VertexAnimationTrack *track = trackIt.getNext();
+                if( track->getHandle() == vertexDataTarget && track->getAnimationType() == VAT_MORPH )
+                {
+                    for( unsigned short i=0; i<track->getNumKeyFrames(); ++i )
+                        remapVertexBuffer( track->getVertexMorphKeyFrame( i )->getVertexBuffer(), remap );
+                }
+            }
+            ++itAnim;
+        }
+    }
+    //---------------------------------------------------------------------
     void Mesh::organiseTangentsBuffer(VertexData *vertexData,
         VertexElementSemantic targetSemantic, unsigned short index, 
         unsigned short sourceTexCoordSet)
@@ -1863,7 +2157,7 @@ namespace Ogre {
     void Mesh::softwareVertexBlend(const VertexData* sourceVertexData,
         const VertexData* targetVertexData,
         const Matrix4* const* blendMatrices, size_t numMatrices,
-        bool blendNormals)
+        bool blendNormals, SceneManager *sceneManager)
     {
         float *pSrcPos = 0;
         float *pSrcNorm = 0;
@@ -1973,7 +2267,8 @@ namespace Ogre {
             destElemNorm->baseVertexPointerToElement(pBuffer, &pDestNorm);
         }
 
-        OptimisedUtil::getImplementation()->softwareVertexSkinning(
+        SoftwareVertexAnimationTask skinningTask;
+        skinningTask.softwareVertexSkinning(
             pSrcPos, pDestPos,
             pSrcNorm, pDestNorm,
             pBlendWeight, pBlendIdx,
@@ -1982,7 +2277,8 @@ namespace Ogre {
             srcNormStride, destNormStride,
             blendWeightStride, blendIdxStride,
             numWeightsPerVertex,
-            targetVertexData->vertexCount);
+            targetVertexData->vertexCount,
+            sceneManager);
 
         // Unlock source buffers
         srcPosBuf->unlock();
@@ -2007,7 +2303,7 @@ namespace Ogre {
     void Mesh::softwareVertexMorph(Real t,
         const HardwareVertexBufferSharedPtr& b1,
         const HardwareVertexBufferSharedPtr& b2,
-        VertexData* targetVertexData)
+        VertexData* targetVertexData, SceneManager *sceneManager)
     {
         float* pb1 = static_cast<float*>(b1->lock(HardwareBuffer::HBL_READ_ONLY));
         float* pb2;
@@ -2043,11 +2339,12 @@ namespace Ogre {
         float* pdst = static_cast<float*>(
             destBuf->lock(HardwareBuffer::HBL_DISCARD));
 
-        OptimisedUtil::getImplementation()->softwareVertexMorph(
+        SoftwareVertexAnimationTask morphTask;
+        morphTask.softwareVertexMorph(
             t, pb1, pb2, pdst,
             b1->getVertexSize(), b2->getVertexSize(), destBuf->getVertexSize(),
             targetVertexData->vertexCount,
-            morphNormals);
+            morphNormals, sceneManager);
 
         destBuf->unlock();
         b1->unlock();
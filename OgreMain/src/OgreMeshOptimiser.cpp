@@ -0,0 +1,603 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreMeshOptimiser.h"
+#include "OgreVertexIndexData.h"
+#include "OgreHardwareIndexBuffer.h"
+#include "OgreVector3.h"
+
+namespace Ogre
+{
+    const size_t MeshOptimiser::VERTEX_CACHE_SIZE   = 32;
+    const size_t MeshOptimiser::FIFO_CACHE_SIZE     = 16;
+
+    namespace
+    {
+        /// Valences above this value are evaluated with pow() instead of a table lookup
+        const size_t MAX_VALENCE_TABLE = 32;
+        const uint32 INVALID_TRIANGLE = 0xffffffff;
+
+        /// Vertex scoring function from Forsyth's article, with its suggested constants
+        class VertexScorer
+        {
+            float mCacheScore[MeshOptimiser::VERTEX_CACHE_SIZE];
+            float mValenceScore[MAX_VALENCE_TABLE];
+
+        public:
+            VertexScorer()
+            {
+                const float lastTriScore = 0.75f;
+                const float cacheDecayPower = 1.5f;
+                const float scaler = 1.0f / (MeshOptimiser::VERTEX_CACHE_SIZE - 3);
+
+                for( size_t i=0; i<MeshOptimiser::VERTEX_CACHE_SIZE; ++i )
+                {
+                    //The last triangle's vertices get a fixed score, so that the algorithm
+                    //doesn't prefer using them again (which would depend on their order).
+                    if( i < 3 )
+                        mCacheScore[i] = lastTriScore;
+                    else
+                        mCacheScore[i] = powf( 1.0f - (i - 3) * scaler, cacheDecayPower );
+                }
+
+                mValenceScore[0] = 0.0f;
+                for( size_t i=1; i<MAX_VALENCE_TABLE; ++i )
+                    mValenceScore[i] = valenceScore( i );
+            }
+
+            static float valenceScore( size_t liveTriangles )
+            {
+                //Boost vertices with few triangles left, to get rid of lone triangles early.
+                return 2.0f * powf( static_cast<float>( liveTriangles ), -0.5f );
+            }
+
+            float operator () ( int32 cachePosition, size_t liveTriangles ) const
+            {
+                //Vertices without triangles left will never be used again
+                if( !liveTriangles )
+                    return -1.0f;
+
+                float score = cachePosition >= 0 ? mCacheScore[cachePosition] : 0.0f;
+                score += liveTriangles < MAX_VALENCE_TABLE ? mValenceScore[liveTriangles] :
+                                                             valenceScore( liveTriangles );
+                return score;
+            }
+        };
+
+        /** Simulates a FIFO cache using timestamps. Flushing is just a matter of
+            advancing the time, so it is O(1).
+        */
+        class FifoCacheSimulator
+        {
+            vector<uint32>::type    mTimestamps;
+            uint32                  mTime;
+            uint32                  mCacheSize;
+
+        public:
+            FifoCacheSimulator( size_t vertexCount, size_t cacheSize ) :
+                mTimestamps( vertexCount, 0 ),
+                mTime( static_cast<uint32>( cacheSize + 1 ) ),
+                mCacheSize( static_cast<uint32>( cacheSize ) )
+            {
+            }
+
+            /// Returns the number of cache misses caused by the given triangle
+            size_t addTriangle( const uint32 *triangle )
+            {
+                size_t misses = 0;
+                for( size_t i=0; i<3; ++i )
+                {
+                    if( mTime - mTimestamps[triangle[i]] > mCacheSize )
+                    {
+                        mTimestamps[triangle[i]] = mTime++;
+                        ++misses;
+                    }
+                }
+                return misses;
+            }
+
+            void flush(void)                { mTime += mCacheSize + 1; }
+        };
+
+        struct TriangleCluster
+        {
+            uint32  start;
+            uint32  end;
+            float   sortKey;
+        };
+
+        struct ClusterSortKeyGreater
+        {
+            bool operator () ( const TriangleCluster &a, const TriangleCluster &b ) const
+            {
+                return a.sortKey > b.sortKey;
+            }
+        };
+
+        inline Vector3 getPosition( const float *positions, size_t positionStride, uint32 vertexIdx )
+        {
+            const float *position = reinterpret_cast<const float*>(
+                        reinterpret_cast<const unsigned char*>( positions ) + vertexIdx * positionStride );
+            return Vector3( position[0], position[1], position[2] );
+        }
+
+        /// Writes the distinct vertices of a triangle to outVertices, returns how many there are.
+        /// Degenerate triangles reference a vertex more than once, but it is transformed once.
+        inline size_t getUniqueVertices( const uint32 *triangle, uint32 *outVertices )
+        {
+            size_t count = 0;
+            outVertices[count++] = triangle[0];
+            if( triangle[1] != triangle[0] )
+                outVertices[count++] = triangle[1];
+            if( triangle[2] != triangle[0] && triangle[2] != triangle[1] )
+                outVertices[count++] = triangle[2];
+            return count;
+        }
+
+        size_t getMaxIndex( const uint32 *indices, size_t indexCount )
+        {
+            uint32 maxIndex = 0;
+            for( size_t i=0; i<indexCount; ++i )
+                maxIndex = std::max( maxIndex, indices[i] );
+            return maxIndex;
+        }
+    }
+    //-----------------------------------------------------------------------
+    void MeshOptimiser::optimiseVertexCache( uint32 *indices, size_t indexCount, size_t vertexCount )
+    {
+        //A trailing partial triangle isn't reordered and is left untouched
+        const size_t triangleCount = indexCount / 3;
+        indexCount = triangleCount * 3;
+        if( triangleCount < 2 )
+            return;
+
+        assert( getMaxIndex( indices, indexCount ) < vertexCount && "Index out of bounds" );
+
+        //Build vertex -> triangles adjacency. liveTriangles[v] is the number of triangles not
+        //emitted yet using v, which are kept at the beginning of v's range in 'adjacency'.
+        //Degenerate triangles are only listed once per distinct vertex.
+        vector<uint32>::type liveTriangles( vertexCount, 0 );
+        vector<uint32>::type adjacencyOffsets( vertexCount, 0 );
+        vector<uint32>::type adjacency;
+
+        {
+            uint32 uniqueVertices[3];
+            size_t adjacencyCount = 0;
+            for( size_t i=0; i<triangleCount; ++i )
+            {
+                const size_t uniqueCount = getUniqueVertices( indices + i * 3, uniqueVertices );
+                for( size_t j=0; j<uniqueCount; ++j )
+                    ++liveTriangles[uniqueVertices[j]];
+                adjacencyCount += uniqueCount;
+            }
+
+            uint32 offset = 0;
+            for( size_t i=0; i<vertexCount; ++i )
+            {
+                adjacencyOffsets[i] = offset;
+                offset += liveTriangles[i];
+            }
+
+            adjacency.resize( adjacencyCount );
+            vector<uint32>::type fillOffsets( adjacencyOffsets );
+            for( size_t i=0; i<triangleCount; ++i )
+            {
+                const size_t uniqueCount = getUniqueVertices( indices + i * 3, uniqueVertices );
+                for( size_t j=0; j<uniqueCount; ++j )
+                    adjacency[fillOffsets[uniqueVertices[j]]++] = static_cast<uint32>( i );
+            }
+        }
+
+        const VertexScorer scorer;
+
+        vector<int32>::type cachePositions( vertexCount, -1 );
+        vector<float>::type vertexScores( vertexCount );
+        for( size_t i=0; i<vertexCount; ++i )
+            vertexScores[i] = scorer( -1, liveTriangles[i] );
+
+        vector<float>::type triangleScores( triangleCount );
+        uint32 bestTriangle = 0;
+        for( size_t i=0; i<triangleCount; ++i )
+        {
+            //A vertex referenced twice counts twice, so degenerate triangles get
+            //emitted as soon as their vertices are cached instead of lagging behind
+            const uint32 *triangle = indices + i * 3;
+            triangleScores[i] = vertexScores[triangle[0]] + vertexScores[triangle[1]] +
+                                vertexScores[triangle[2]];
+            if( triangleScores[i] > triangleScores[bestTriangle] )
+                bestTriangle = static_cast<uint32>( i );
+        }
+
+        vector<unsigned char>::type emitted( triangleCount, 0 );
+        vector<uint32>::type output( indexCount );
+
+        uint32 cache[VERTEX_CACHE_SIZE + 3];
+        uint32 newCache[VERTEX_CACHE_SIZE + 3];
+        size_t cacheCount = 0;
+        size_t nextUnemitted = 0;
+
+        for( size_t outTriangle=0; outTriangle<triangleCount; ++outTriangle )
+        {
+            if( bestTriangle == INVALID_TRIANGLE )
+            {
+                //None of the cached vertices has triangles left. Resume
+                //with the first triangle that hasn't been emitted yet.
+                while( emitted[nextUnemitted] )
+                    ++nextUnemitted;
+                bestTriangle = static_cast<uint32>( nextUnemitted );
+            }
+
+            const uint32 *triangle = indices + bestTriangle * 3;
+            output[outTriangle * 3 + 0] = triangle[0];
+            output[outTriangle * 3 + 1] = triangle[1];
+            output[outTriangle * 3 + 2] = triangle[2];
+            emitted[bestTriangle] = 1;
+
+            //Remove the triangle from its vertices' live range. They go to the front of
+            //the LRU cache, once each even if the triangle is degenerate.
+            const size_t uniqueCount = getUniqueVertices( triangle, newCache );
+            for( size_t i=0; i<uniqueCount; ++i )
+            {
+                const uint32 vertexIdx = newCache[i];
+                uint32 *vertexTriangles = &adjacency[adjacencyOffsets[vertexIdx]];
+                const uint32 lastLive = --liveTriangles[vertexIdx];
+
+                for( uint32 j=0; j<lastLive; ++j )
+                {
+                    if( vertexTriangles[j] == bestTriangle )
+                    {
+                        std::swap( vertexTriangles[j], vertexTriangles[lastLive] );
+                        break;
+                    }
+                }
+            }
+
+            //Move the rest of the cache behind them
+            size_t newCacheCount = uniqueCount;
+            for( size_t i=0; i<cacheCount; ++i )
+            {
+                const uint32 vertexIdx = cache[i];
+                if( vertexIdx != triangle[0] && vertexIdx != triangle[1] && vertexIdx != triangle[2] )
+                    newCache[newCacheCount++] = vertexIdx;
+            }
+
+            //Update the scores of everything that moved in (or fell out of) the cache
+            for( size_t i=0; i<newCacheCount; ++i )
+            {
+                const uint32 vertexIdx = newCache[i];
+                const int32 cachePos = i < VERTEX_CACHE_SIZE ? static_cast<int32>( i ) : -1;
+                cachePositions[vertexIdx] = cachePos;
+
+                const float newScore = scorer( cachePos, liveTriangles[vertexIdx] );
+                const float scoreDelta = newScore - vertexScores[vertexIdx];
+                vertexScores[vertexIdx] = newScore;
+
+                const uint32 *vertexTriangles = &adjacency[adjacencyOffsets[vertexIdx]];
+                for( uint32 j=0; j<liveTriangles[vertexIdx]; ++j )
+                {
+                    const uint32 *liveTriangle = indices + vertexTriangles[j] * 3;
+                    const size_t references = (liveTriangle[0] == vertexIdx) +
+                                              (liveTriangle[1] == vertexIdx) +
+                                              (liveTriangle[2] == vertexIdx);
+                    triangleScores[vertexTriangles[j]] += scoreDelta * references;
+                }
+            }
+
+            //Only triangles using a cached vertex are candidates for the next one
+            bestTriangle = INVALID_TRIANGLE;
+            float bestScore = -std::numeric_limits<float>::max();
+            cacheCount = std::min( newCacheCount, VERTEX_CACHE_SIZE );
+
+            for( size_t i=0; i<cacheCount; ++i )
+            {
+                const uint32 vertexIdx = newCache[i];
+                cache[i] = vertexIdx;
+
+                const uint32 *vertexTriangles = &adjacency[adjacencyOffsets[vertexIdx]];
+                for( uint32 j=0; j<liveTriangles[vertexIdx]; ++j )
+                {
+                    if( triangleScores[vertexTriangles[j]] > bestScore )
+                    {
+                        bestScore = triangleScores[vertexTriangles[j]];
+                        bestTriangle = vertexTriangles[j];
+                    }
+                }
+            }
+        }
+
+        memcpy( indices, &output[0], indexCount * sizeof(uint32) );
+    }
+    //-----------------------------------------------------------------------
+    void MeshOptimiser::optimiseOverdraw( uint32 *indices, size_t indexCount, const float *positions,
+                                          size_t positionStride, size_t vertexCount )
+    {
+        //A trailing partial triangle isn't reordered and is left untouched
+        const size_t triangleCount = indexCount / 3;
+        indexCount = triangleCount * 3;
+        if( triangleCount < 2 )
+            return;
+
+        assert( getMaxIndex( indices, indexCount ) < vertexCount && "Index out of bounds" );
+
+        const float overdrawThreshold = 1.05f;
+
+        //Hard boundaries: triangles where the FIFO cache misses all three vertices.
+        //Reordering at these points doesn't make the ACMR any worse.
+        vector<uint32>::type hardBoundaries;
+        {
+            FifoCacheSimulator cacheSim( vertexCount, FIFO_CACHE_SIZE );
+            for( size_t i=0; i<triangleCount; ++i )
+            {
+                if( cacheSim.addTriangle( indices + i * 3 ) == 3 || i == 0 )
+                    hardBoundaries.push_back( static_cast<uint32>( i ) );
+            }
+            hardBoundaries.push_back( static_cast<uint32>( triangleCount ) );
+        }
+
+        //Soft boundaries: split each hard cluster further where flushing the cache
+        //costs at most overdrawThreshold times the cluster's own ACMR.
+        vector<TriangleCluster>::type clusters;
+        {
+            FifoCacheSimulator cacheSim( vertexCount, FIFO_CACHE_SIZE );
+            for( size_t i=0; i<hardBoundaries.size() - 1; ++i )
+            {
+                const uint32 hardStart  = hardBoundaries[i];
+                const uint32 hardEnd    = hardBoundaries[i+1];
+
+                size_t hardMisses = 0;
+                cacheSim.flush();
+                for( uint32 j=hardStart; j<hardEnd; ++j )
+                    hardMisses += cacheSim.addTriangle( indices + j * 3 );
+
+                const float threshold = overdrawThreshold * hardMisses / (hardEnd - hardStart);
+
+                TriangleCluster cluster;
+                cluster.start   = hardStart;
+                cluster.sortKey = 0;
+
+                size_t clusterMisses = 0;
+                cacheSim.flush();
+                for( uint32 j=hardStart; j<hardEnd; ++j )
+                {
+                    clusterMisses += cacheSim.addTriangle( indices + j * 3 );
+
+                    const float clusterAcmr = static_cast<float>( clusterMisses ) /
+                                                (j - cluster.start + 1);
+                    if( j + 1 < hardEnd && clusterAcmr <= threshold )
+                    {
+                        cluster.end = j + 1;
+                        clusters.push_back( cluster );
+                        cluster.start = j + 1;
+                        clusterMisses = 0;
+                        cacheSim.flush();
+                    }
+                }
+
+                cluster.end = hardEnd;
+                clusters.push_back( cluster );
+            }
+        }
+
+        if( clusters.size() < 2 )
+            return;
+
+        //Area weighted centroid of the whole mesh
+        Vector3 meshCentroid( Vector3::ZERO );
+        Real meshArea = 0;
+        for( size_t i=0; i<triangleCount; ++i )
+        {
+            const uint32 *triangle = indices + i * 3;
+            const Vector3 p0( getPosition( positions, positionStride, triangle[0] ) );
+            const Vector3 p1( getPosition( positions, positionStride, triangle[1] ) );
+            const Vector3 p2( getPosition( positions, positionStride, triangle[2] ) );
+            const Real area = (p1 - p0).crossProduct( p2 - p0 ).length();
+
+            meshCentroid += (p0 + p1 + p2) * area;
+            meshArea += area;
+        }
+
+        if( meshArea > 0 )
+            meshCentroid /= meshArea * 3.0f;
+
+        //Clusters whose average normal points away from the centre are likely to be
+        //occluders, so draw them first.
+        for( size_t i=0; i<clusters.size(); ++i )
+        {
+            TriangleCluster &cluster = clusters[i];
+
+            Vector3 clusterCentroid( Vector3::ZERO );
+            Vector3 clusterNormal( Vector3::ZERO );
+            Real clusterArea = 0;
+
+            for( uint32 j=cluster.start; j<cluster.end; ++j )
+            {
+                const uint32 *triangle = indices + j * 3;
+                const Vector3 p0( getPosition( positions, positionStride, triangle[0] ) );
+                const Vector3 p1( getPosition( positions, positionStride, triangle[1] ) );
+                const Vector3 p2( getPosition( positions, positionStride, triangle[2] ) );
+                const Vector3 areaNormal = (p1 - p0).crossProduct( p2 - p0 );
+                const Real area = areaNormal.length();
+
+                clusterCentroid += (p0 + p1 + p2) * area;
+                clusterNormal   += areaNormal;
+                clusterArea     += area;
+            }
+
+            if( clusterArea > 0 )
+                clusterCentroid /= clusterArea * 3.0f;
+
+            clusterNormal.normalise();
+            cluster.sortKey = static_cast<float>( (clusterCentroid - meshCentroid).dotProduct( clusterNormal ) );
+        }
+
+        std::stable_sort( clusters.begin(), clusters.end(), ClusterSortKeyGreater() );
+
+        vector<uint32>::type output;
+        output.reserve( indexCount );
+        for( size_t i=0; i<clusters.size(); ++i )
+        {
+            output.insert( output.end(), indices + clusters[i].start * 3,
+                           indices + clusters[i].end * 3 );
+        }
+
+        memcpy( indices, &output[0], indexCount * sizeof(uint32) );
+    }
+    //-----------------------------------------------------------------------
+    void MeshOptimiser::buildVertexFetchRemap( const uint32 *indices, size_t indexCount,
+                                               size_t vertexCount, uint32 *outRemap )
+    {
+        const uint32 unused = 0xffffffff;
+        std::fill( outRemap, outRemap + vertexCount, unused );
+
+        uint32 nextVertex = 0;
+        for( size_t i=0; i<indexCount; ++i )
+        {
+            assert( indices[i] < vertexCount && "Index out of bounds" );
+            if( outRemap[indices[i]] == unused )
+                outRemap[indices[i]] = nextVertex++;
+        }
+
+        for( size_t i=0; i<vertexCount; ++i )
+        {
+            if( outRemap[i] == unused )
+                outRemap[i] = nextVertex++;
+        }
+    }
+    //-----------------------------------------------------------------------
+    Real MeshOptimiser::calculateAcmr( const uint32 *indices, size_t indexCount, size_t cacheSize )
+    {
+        const size_t triangleCount = indexCount / 3;
+        if( !triangleCount )
+            return 0;
+
+        FifoCacheSimulator cacheSim( getMaxIndex( indices, indexCount ) + 1, cacheSize );
+
+        size_t misses = 0;
+        for( size_t i=0; i<triangleCount; ++i )
+            misses += cacheSim.addTriangle( indices + i * 3 );
+
+        return static_cast<Real>( misses ) / static_cast<Real>( triangleCount );
+    }
+    //-----------------------------------------------------------------------
+    void MeshOptimiser::readIndices( const IndexData *indexData, vector<uint32>::type &outIndices )
+    {
+        outIndices.resize( indexData->indexCount );
+        if( !indexData->indexCount )
+            return;
+
+        const HardwareIndexBufferSharedPtr &indexBuffer = indexData->indexBuffer;
+        const size_t indexSize = indexBuffer->getIndexSize();
+        const void *src = indexBuffer->lock( indexData->indexStart * indexSize,
+                                             indexData->indexCount * indexSize,
+                                             HardwareBuffer::HBL_READ_ONLY );
+
+        if( indexBuffer->getType() == HardwareIndexBuffer::IT_16BIT )
+        {
+            const uint16 *src16 = static_cast<const uint16*>( src );
+            for( size_t i=0; i<indexData->indexCount; ++i )
+                outIndices[i] = src16[i];
+        }
+        else
+        {
+            memcpy( &outIndices[0], src, indexData->indexCount * sizeof(uint32) );
+        }
+
+        indexBuffer->unlock();
+    }
+    //-----------------------------------------------------------------------
+    void MeshOptimiser::writeIndices( IndexData *indexData, const vector<uint32>::type &indices )
+    {
+        assert( indices.size() == indexData->indexCount );
+        if( !indexData->indexCount )
+            return;
+
+        const HardwareIndexBufferSharedPtr &indexBuffer = indexData->indexBuffer;
+        const size_t indexSize = indexBuffer->getIndexSize();
+        void *dst = indexBuffer->lock( indexData->indexStart * indexSize,
+                                       indexData->indexCount * indexSize,
+                                       HardwareBuffer::HBL_NORMAL );
+
+        if( indexBuffer->getType() == HardwareIndexBuffer::IT_16BIT )
+        {
+            uint16 *dst16 = static_cast<uint16*>( dst );
+            for( size_t i=0; i<indexData->indexCount; ++i )
+                dst16[i] = static_cast<uint16>( indices[i] );
+        }
+        else
+        {
+            memcpy( dst, &indices[0], indexData->indexCount * sizeof(uint32) );
+        }
+
+        indexBuffer->unlock();
+    }
+    //-----------------------------------------------------------------------
+    void MeshOptimiser::optimiseIndexBuffer( void *indices, size_t indexCount, size_t indexSize )
+    {
+        if( indexCount < 6 )
+            return;
+
+        if( indexSize == sizeof(uint16) )
+        {
+            uint16 *indices16 = static_cast<uint16*>( indices );
+            vector<uint32>::type indices32( indices16, indices16 + indexCount );
+            optimiseVertexCache( &indices32[0], indexCount,
+                                 getMaxIndex( &indices32[0], indexCount ) + 1 );
+            for( size_t i=0; i<indexCount; ++i )
+                indices16[i] = static_cast<uint16>( indices32[i] );
+        }
+        else
+        {
+            uint32 *indices32 = static_cast<uint32*>( indices );
+            optimiseVertexCache( indices32, indexCount, getMaxIndex( indices32, indexCount ) + 1 );
+        }
+    }
+    //-----------------------------------------------------------------------
+    void MeshOptimiser::optimiseVertexCache( IndexData *indexData )
+    {
+        if( indexData->indexCount < 6 || indexData->indexBuffer.isNull() )
+            return;
+
+        const HardwareIndexBufferSharedPtr &indexBuffer = indexData->indexBuffer;
+        const size_t indexSize = indexBuffer->getIndexSize();
+        void *data = indexBuffer->lock( indexData->indexStart * indexSize,
+                                        indexData->indexCount * indexSize,
+                                        HardwareBuffer::HBL_NORMAL );
+        optimiseIndexBuffer( data, indexData->indexCount, indexSize );
+        indexBuffer->unlock();
+    }
+    //-----------------------------------------------------------------------
+    Real MeshOptimiser::calculateAcmr( const IndexData *indexData, size_t cacheSize )
+    {
+        if( !indexData->indexCount || indexData->indexBuffer.isNull() )
+            return 0;
+
+        vector<uint32>::type indices;
+        readIndices( indexData, indices );
+        return calculateAcmr( &indices[0], indices.size(), cacheSize );
+    }
+}
@@ -38,18 +38,23 @@ namespace Ogre {
     const unsigned short HEADER_CHUNK_ID = 0x1000;
     //---------------------------------------------------------------------
     MeshSerializer::MeshSerializer()
-        :mListener(0)
+        :mListener(0), mCompressGeometry(false),
+         mImportWorkQueue(WorkQueueParallelFor::getRootWorkQueue())
     {
         // Init implementations
         // String identifiers have not always been 100% unified with OGRE version
         
         // Note MUST be added in reverse order so latest is first in the list
 
+        mVersionData.push_back(OGRE_NEW MeshVersionData(
+            MESH_VERSION_2_0, "[MeshSerializer_v2.0]",
+            OGRE_NEW MeshSerializerImpl()));
+
         // This one is a little ugly, 1.10 is used for version 1.1 legacy meshes.
         // So bump up to 1.100
         mVersionData.push_back(OGRE_NEW MeshVersionData(
             MESH_VERSION_1_10, "[MeshSerializer_v1.100]", 
-            OGRE_NEW MeshSerializerImpl()));
+            OGRE_NEW MeshSerializerImpl_v1_10()));
 
         mVersionData.push_back(OGRE_NEW MeshVersionData(
             MESH_VERSION_1_8, "[MeshSerializer_v1.8]", 
@@ -126,19 +131,19 @@ namespace Ogre {
                         "You may not supply a legacy version number (pre v1.0) for writing meshes.",
                         "MeshSerializer::exportMesh");
         
-        MeshSerializerImpl* impl = 0;
+        // v2.0 is opt-in until it can be read by every OGRE version in use,
+        // so the default stays the newest 1.x format
         if (version == MESH_VERSION_LATEST)
-            impl = mVersionData[0]->impl;
-        else 
+            version = MESH_VERSION_1_10;
+
+        MeshSerializerImpl* impl = 0;
+        for (MeshVersionDataList::iterator i = mVersionData.begin(); 
+             i != mVersionData.end(); ++i)
         {
-            for (MeshVersionDataList::iterator i = mVersionData.begin(); 
-                 i != mVersionData.end(); ++i)
+            if (version == (*i)->version)
             {
-                if (version == (*i)->version)
-                {
-                    impl = (*i)->impl;
-                    break;
-                }
+                impl = (*i)->impl;
+                break;
             }
         }
         
@@ -147,7 +152,7 @@ namespace Ogre {
                     "specified version", "MeshSerializer::exportMesh");
 
                     
-        impl->exportMesh(pMesh, stream, endianMode);
+        impl->exportMesh(pMesh, stream, endianMode, mCompressGeometry);
     }
     //---------------------------------------------------------------------
     void MeshSerializer::importMesh(DataStreamPtr& stream, Mesh* pDest)
@@ -186,7 +191,7 @@ namespace Ogre {
                         "mesh version " + ver, "MeshSerializer::importMesh");
         
         // Call implementation
-        impl->importMesh(stream, pDest, mListener);
+        impl->importMesh(stream, pDest, mListener, mImportWorkQueue);
         // Warn on old version of mesh
         if (ver != mVersionData[0]->versionString)
         {
@@ -208,5 +213,25 @@ namespace Ogre {
     {
         return mListener;
     }
+    //-------------------------------------------------------------------------
+    void MeshSerializer::setGeometryCompression(bool compress)
+    {
+        mCompressGeometry = compress;
+    }
+    //-------------------------------------------------------------------------
+    bool MeshSerializer::getGeometryCompression(void) const
+    {
+        return mCompressGeometry;
+    }
+    //-------------------------------------------------------------------------
+    void MeshSerializer::setImportWorkQueue(WorkQueue *workQueue)
+    {
+        mImportWorkQueue = workQueue;
+    }
+    //-------------------------------------------------------------------------
+    WorkQueue* MeshSerializer::getImportWorkQueue(void) const
+    {
+        return mImportWorkQueue;
+    }
 }
 
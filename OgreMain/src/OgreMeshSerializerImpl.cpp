@@ -52,11 +52,91 @@ namespace Ogre {
 
     /// stream overhead = ID + size
     const long MSTREAM_OVERHEAD_SIZE = sizeof(uint16) + sizeof(uint32);
+
+    namespace {
+        // Octahedral mapping of unit vectors, see MVEC_OCTAHEDRAL_SNORM16
+        inline float signNotZero(float value)
+        {
+            return value >= 0.0f ? 1.0f : -1.0f;
+        }
+
+        inline int16 toSnorm16(float value)
+        {
+            value = std::max(-1.0f, std::min(value, 1.0f));
+            return static_cast<int16>(Math::Floor(value * 32767.0f + 0.5f));
+        }
+
+        void encodeOctahedral(const float *dir, int16 *outValues)
+        {
+            const float l1Norm = Math::Abs(dir[0]) + Math::Abs(dir[1]) + Math::Abs(dir[2]);
+            if (l1Norm <= 0.0f)
+            {
+                outValues[0] = 0;
+                outValues[1] = 0;
+                return;
+            }
+
+            float x = dir[0] / l1Norm;
+            float y = dir[1] / l1Norm;
+            if (dir[2] < 0.0f)
+            {
+                const float oldX = x;
+                x = (1.0f - Math::Abs(y)) * signNotZero(oldX);
+                y = (1.0f - Math::Abs(oldX)) * signNotZero(y);
+            }
+
+            outValues[0] = toSnorm16(x);
+            outValues[1] = toSnorm16(y);
+        }
+
+        void decodeOctahedral(const int16 *values, float *outDir)
+        {
+            float x = std::max(values[0] / 32767.0f, -1.0f);
+            float y = std::max(values[1] / 32767.0f, -1.0f);
+            const float z = 1.0f - Math::Abs(x) - Math::Abs(y);
+            if (z < 0.0f)
+            {
+                const float oldX = x;
+                x = (1.0f - Math::Abs(y)) * signNotZero(oldX);
+                y = (1.0f - Math::Abs(oldX)) * signNotZero(y);
+            }
+
+            const float invLength = Math::InvSqrt(x * x + y * y + z * z);
+            outDir[0] = x * invLength;
+            outDir[1] = y * invLength;
+            outDir[2] = z * invLength;
+        }
+
+        /// How far from 1 the squared length of a vector can be and still be octahedron encoded
+        const float OCTAHEDRAL_UNIT_LENGTH_TOLERANCE = 1e-3f;
+
+        /// Whether all the float3 of a vertex element are unit vectors. The octahedral mapping
+        /// would normalize the others (i.e. zero or deliberately scaled normals).
+        bool areUnitVectors(const void *pElem, size_t vertexSize, size_t vertexCount)
+        {
+            for (size_t i = 0; i < vertexCount; ++i)
+            {
+                const float *dir = reinterpret_cast<const float*>(
+                            static_cast<const uint8*>(pElem) + i * vertexSize);
+                const float squaredLength = dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2];
+                // Written so that NaNs fail too
+                if (!(Math::Abs(squaredLength - 1.0f) <= OCTAHEDRAL_UNIT_LENGTH_TOLERANCE))
+                    return false;
+            }
+
+            return true;
+        }
+    }
+    const size_t MeshSerializerImpl::BUFFER_DATA_ALIGNMENT = 16;
     //---------------------------------------------------------------------
-    MeshSerializerImpl::MeshSerializerImpl()
+    MeshSerializerImpl::MeshSerializerImpl() :
+        mParallelImport( false ),
+        mImportData( 0 ),
+        mImportWorkQueue( 0 ),
+        mCompressGeometry( false )
     {
         // Version number
-        mVersion = "[MeshSerializer_v1.100]";
+        mVersion = "[MeshSerializer_v2.0]";
     }
     //---------------------------------------------------------------------
     MeshSerializerImpl::~MeshSerializerImpl()
@@ -64,13 +144,20 @@ namespace Ogre {
     }
     //---------------------------------------------------------------------
     void MeshSerializerImpl::exportMesh(const Mesh* pMesh, 
-        DataStreamPtr stream, Endian endianMode)
+        DataStreamPtr stream, Endian endianMode, bool compressGeometry)
     {
         LogManager::getSingleton().logMessage("MeshSerializer writing mesh data to stream " + stream->getName() + "...");
 
         // Decide on endian mode
         determineEndianness(endianMode);
 
+        mCompressGeometry = compressGeometry && isGeometryCompressionSupported();
+        if (compressGeometry && !mCompressGeometry)
+        {
+            LogManager::getSingleton().logMessage("Geometry compression isn't supported by " +
+                                                  mVersion + ", writing uncompressed geometry.");
+        }
+
         // Check that the mesh has it's bounds set
         if (pMesh->getBounds().isNull() || pMesh->getBoundingSphereRadius() == 0.0f)
         {
@@ -99,7 +186,8 @@ namespace Ogre {
         LogManager::getSingleton().logMessage("MeshSerializer export successful.");
     }
     //---------------------------------------------------------------------
-    void MeshSerializerImpl::importMesh(DataStreamPtr& stream, Mesh* pMesh, MeshSerializerListener *listener)
+    void MeshSerializerImpl::importMesh(DataStreamPtr& stream, Mesh* pMesh, MeshSerializerListener *listener,
+                                        WorkQueue *workQueue)
     {
         // Determine endianness (must be the first thing we do!)
         determineEndianness(stream);
@@ -107,23 +195,261 @@ namespace Ogre {
 #if OGRE_SERIALIZER_VALIDATE_CHUNKSIZE
         enableValidation();
 #endif
-        // Check header
-        readFileHeader(stream);
-        pushInnerChunk(stream);
-        unsigned short streamID = readChunk(stream);
 
-        while(!stream->eof())
+        mParallelImport = false;
+        mImportData = 0;
+        mImportWorkQueue = 0;
+
+        // Deferring only pays off if other threads can help
+        DefaultWorkQueueBase *defaultWorkQueue = dynamic_cast<DefaultWorkQueueBase*>( workQueue );
+        if( isParallelImportSupported() && defaultWorkQueue &&
+            defaultWorkQueue->getWorkerThreadCount() > 0 )
+        {
+            // Deferred chunks are decoded by other threads straight from the stream's memory
+            MemoryDataStream *memStream = dynamic_cast<MemoryDataStream*>( stream.get() );
+            if( memStream )
+            {
+                mParallelImport     = true;
+                mImportData         = memStream->getPtr();
+                mImportStreamName   = stream->getName();
+                mImportWorkQueue    = workQueue;
+                mImportJobs.clear();
+            }
+        }
+
+        try
+        {
+            // Check header
+            readFileHeader(stream);
+            pushInnerChunk(stream);
+            unsigned short streamID = readChunk(stream);
+
+            while(!stream->eof())
+            {
+                switch (streamID)
+                {
+                case M_MESH:
+                    readMesh(stream, pMesh, listener);
+                    break;
+                }
+
+                streamID = readChunk(stream);
+            }
+            popInnerChunk(stream);
+        }
+        catch( ... )
+        {
+            // Not only OGRE exceptions: std::bad_alloc & co. must not leak what the jobs own.
+            // Nothing has been decoded yet, that only starts in finishImportJobs.
+            if( mParallelImport )
+            {
+                releaseImportJobs();
+                mParallelImport = false;
+                mImportData = 0;
+                mImportWorkQueue = 0;
+            }
+            throw;
+        }
+
+        if( mParallelImport )
+            finishImportJobs( pMesh );
+    }
+    //---------------------------------------------------------------------
+    bool MeshSerializerImpl::isParallelImportSupported(void) const
+    {
+        return true;
+    }
+    //---------------------------------------------------------------------
+    MeshSerializerImpl::ImportJob::ImportJob( Type _type ) :
+        type( _type ),
+        offset( 0 ),
+        size( 0 ),
+        lodIndex( 0 ),
+        edgeData( 0 ),
+        pose( 0 ),
+        poseKeyFrame( 0 ),
+        includesNormals( false ),
+        compressed( false ),
+        data( 0 )
+    {
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::addImportJob( DataStreamPtr& stream, ImportJob &job, size_t chunkEnd )
+    {
+        if( chunkEnd < stream->tell() || chunkEnd > stream->size() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Corrupted chunk detected! Stream name: " + stream->getName(),
+                         "MeshSerializerImpl::addImportJob" );
+        }
+
+        job.offset  = stream->tell();
+        job.size    = chunkEnd - job.offset;
+        stream->seek( chunkEnd );
+
+        mImportJobs.push_back( job );
+    }
+    //---------------------------------------------------------------------
+    bool MeshSerializerImpl::canDeferVertexBuffer( const VertexDeclaration::VertexElementList &elems ) const
+    {
+        if( !mParallelImport )
+            return false;
+
+        // readGeometry converts packed colours right away, which needs the data
+        VertexDeclaration::VertexElementList::const_iterator itor = elems.begin();
+        VertexDeclaration::VertexElementList::const_iterator end  = elems.end();
+        while( itor != end )
+        {
+            const VertexElementType type = itor->getType();
+            if( type == VET_COLOUR || type == VET_COLOUR_ABGR || type == VET_COLOUR_ARGB )
+                return false;
+            ++itor;
+        }
+
+        return true;
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::execute( size_t begin, size_t end )
+    {
+        for( size_t i=begin; i<end; ++i )
+            executeImportJob( mImportJobs[i] );
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::executeImportJob( ImportJob &job ) const
+    {
+        // Every job gets its own reader & stream, as both keep parsing state
+        MeshSerializerImpl reader;
+        reader.mFlipEndian = mFlipEndian;
+        DataStreamPtr stream( OGRE_NEW MemoryDataStream( mImportStreamName, mImportData + job.offset,
+                                                         job.size, false, true ) );
+
+        switch( job.type )
+        {
+        case ImportJob::EDGE_LIST_LOD:
+            reader.readEdgeListLodInfo( stream, job.edgeData );
+            break;
+        case ImportJob::POSE_VERTICES:
+            reader.readPoseVertices( stream, job.pose, job.includesNormals );
+            break;
+        case ImportJob::POSE_KEYFRAME:
+            reader.readPoseKeyFramePoseRefs( stream, job.poseKeyFrame );
+            break;
+        case ImportJob::VERTEX_BUFFER:
         {
-            switch (streamID)
+            const size_t vertexSize  = job.vertexBuffer->getVertexSize();
+            const size_t vertexCount = job.vertexBuffer->getNumVertices();
+            job.data = OGRE_MALLOC( vertexSize * vertexCount, MEMCATEGORY_GEOMETRY );
+            if( job.compressed )
             {
-            case M_MESH:
-                readMesh(stream, pMesh, listener);
+                reader.readCompressedVertexBuffer( stream, job.elements, job.data,
+                                                   vertexSize, vertexCount );
+            }
+            else
+            {
+                stream->read( job.data, vertexSize * vertexCount );
+                reader.flipFromLittleEndian( job.data, vertexCount, vertexSize, job.elements );
+            }
+            break;
+        }
+        case ImportJob::INDEX_BUFFER:
+        {
+            const size_t indexCount = job.indexBuffer->getNumIndexes();
+            const bool idx32bit = job.indexBuffer->getType() == HardwareIndexBuffer::IT_32BIT;
+            job.data = OGRE_MALLOC( job.indexBuffer->getSizeInBytes(), MEMCATEGORY_GEOMETRY );
+            if( job.compressed )
+            {
+                if( !decodeIndices( mImportData + job.offset, job.size,
+                                    job.data, indexCount, idx32bit ) )
+                {
+                    OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "Corrupt compressed index data in " +
+                                 mImportStreamName, "MeshSerializerImpl::executeImportJob" );
+                }
+            }
+            else if( idx32bit )
+            {
+                reader.readInts( stream, static_cast<uint32*>( job.data ), indexCount );
+            }
+            else
+            {
+                reader.readShorts( stream, static_cast<uint16*>( job.data ), indexCount );
+            }
+            break;
+        }
+        case ImportJob::MORPH_KEYFRAME:
+        {
+            const size_t numFloats = job.vertexBuffer->getNumVertices() *
+                                        (job.includesNormals ? 6 : 3);
+            job.data = OGRE_MALLOC( numFloats * sizeof(float), MEMCATEGORY_GEOMETRY );
+            reader.readFloats( stream, static_cast<float*>( job.data ), numFloats );
+            break;
+        }
+        }
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::finishImportJobs( Mesh *pMesh )
+    {
+        WorkQueue *workQueue = mImportWorkQueue;
+
+        mParallelImport = false;
+        mImportWorkQueue = 0;
+
+        try
+        {
+            WorkQueueParallelFor::run( *this, mImportJobs.size(), workQueue );
+        }
+        catch( Exception &e )
+        {
+            mImportData = 0;
+            releaseImportJobs();
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Error decoding " + mImportStreamName + ": " + e.getDescription(),
+                         "MeshSerializerImpl::finishImportJobs" );
+        }
+
+        mImportData = 0;
+
+        // Hand the results to the mesh & upload them. Only this thread can touch GPU buffers.
+        ImportJobVec::iterator itor = mImportJobs.begin();
+        ImportJobVec::iterator end  = mImportJobs.end();
+        while( itor != end )
+        {
+            switch( itor->type )
+            {
+            case ImportJob::EDGE_LIST_LOD:
+                pMesh->mMeshLodUsageList[itor->lodIndex].edgeData = itor->edgeData;
+                setupEdgeGroupVertexData( itor->edgeData, pMesh );
+                itor->edgeData = 0;
+                break;
+            case ImportJob::VERTEX_BUFFER:
+            case ImportJob::MORPH_KEYFRAME:
+                itor->vertexBuffer->writeData( 0, itor->vertexBuffer->getSizeInBytes(),
+                                               itor->data, true );
+                break;
+            case ImportJob::INDEX_BUFFER:
+                itor->indexBuffer->writeData( 0, itor->indexBuffer->getSizeInBytes(),
+                                              itor->data, true );
+                break;
+            default:
                 break;
             }
+            ++itor;
+        }
 
-            streamID = readChunk(stream);
+        releaseImportJobs();
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::releaseImportJobs(void)
+    {
+        ImportJobVec::const_iterator itor = mImportJobs.begin();
+        ImportJobVec::const_iterator end  = mImportJobs.end();
+        while( itor != end )
+        {
+            // Edge lists not handed to the mesh yet
+            OGRE_DELETE itor->edgeData;
+            OGRE_FREE( itor->data, MEMCATEGORY_GEOMETRY );
+            ++itor;
         }
-        popInnerChunk(stream);
+        mImportJobs.clear();
     }
     //---------------------------------------------------------------------
     void MeshSerializerImpl::writeMesh(const Mesh* pMesh)
@@ -261,8 +587,30 @@ namespace Ogre {
             s->indexData->indexBuffer->getType() == HardwareIndexBuffer::IT_32BIT);
         writeBools(&idx32bit, 1);
 
-        if (indexCount > 0)
+        // Compressed indices are only used if they're actually smaller
+        vector<uint8>::type encodedIndices;
+        if (mCompressGeometry && indexCount > 0)
+        {
+            const size_t rawSize = indexCount * (idx32bit ? sizeof(uint32) : sizeof(uint16));
+            if (encodeIndices(s->indexData, &encodedIndices) >= rawSize)
+                encodedIndices.clear();
+        }
+
+        // unsigned char indexCompression
+        const uint8 indexCompression = encodedIndices.empty() ? MIC_RAW : MIC_DELTA_VARINT;
+        if (isGeometryCompressionSupported())
+            writeData(&indexCompression, sizeof(uint8), 1);
+
+        if (indexCompression == MIC_DELTA_VARINT)
         {
+            uint32 encodedSize = static_cast<uint32>(encodedIndices.size());
+            writeInts(&encodedSize, 1);
+            writeData(&encodedIndices[0], sizeof(uint8), encodedIndices.size());
+        }
+        else if (indexCount > 0)
+        {
+            const size_t paddingTail = writeBufferDataPaddingHead();
+
             // unsigned short* faceVertexIndices ((indexCount)
             HardwareIndexBufferSharedPtr ibuf = s->indexData->indexBuffer;
             void* pIdx = ibuf->lock(HardwareBuffer::HBL_READ_ONLY);
@@ -277,6 +625,8 @@ namespace Ogre {
                 writeShorts(pIdx16, s->indexData->indexCount);
             }
             ibuf->unlock();
+
+            writeBufferDataPaddingTail(paddingTail);
         }
 
         pushInnerChunk(mStream);
@@ -459,7 +809,22 @@ namespace Ogre {
         for (vbi = bindings.begin(); vbi != vbiend; ++vbi)
         {
             const HardwareVertexBufferSharedPtr& vbuf = vbi->second;
-            size = (MSTREAM_OVERHEAD_SIZE * 2) + (sizeof(unsigned short) * 2) + vbuf->getSizeInBytes();
+            const VertexDeclaration::VertexElementList bufferElems =
+                    vertexData->vertexDeclaration->findElementsBySource(vbi->first);
+            if (mCompressGeometry)
+            {
+                // How each element is compressed depends on its data
+                const void* pBuf = vbuf->lock(HardwareBuffer::HBL_READ_ONLY);
+                size = MSTREAM_OVERHEAD_SIZE + (sizeof(unsigned short) * 2) +
+                        calcCompressedVertexBufferSize(bufferElems, pBuf, vbuf->getVertexSize(),
+                                                       vertexData->vertexCount);
+                vbuf->unlock();
+            }
+            else
+            {
+                size = (MSTREAM_OVERHEAD_SIZE * 2) + (sizeof(unsigned short) * 2) + vbuf->getSizeInBytes() +
+                        calcBufferDataPaddingSize();
+            }
             writeChunkHeader(M_GEOMETRY_VERTEX_BUFFER,  size);
             // unsigned short bindIndex;    // Index to bind this buffer to
                 unsigned short tmp = vbi->first;
@@ -468,10 +833,19 @@ namespace Ogre {
             tmp = (unsigned short)vbuf->getVertexSize();
             writeShorts(&tmp, 1);
                 pushInnerChunk(mStream);
+            if (mCompressGeometry)
+            {
+                const void* pBuf = vbuf->lock(HardwareBuffer::HBL_READ_ONLY);
+                writeCompressedVertexBuffer(bufferElems, pBuf, vbuf->getVertexSize(),
+                                            vertexData->vertexCount);
+                vbuf->unlock();
+            }
+            else
                 {
             // Data
-            size = MSTREAM_OVERHEAD_SIZE + vbuf->getSizeInBytes();
+            size = MSTREAM_OVERHEAD_SIZE + vbuf->getSizeInBytes() + calcBufferDataPaddingSize();
             writeChunkHeader(M_GEOMETRY_VERTEX_BUFFER_DATA, size);
+            const size_t paddingTail = writeBufferDataPaddingHead();
             void* pBuf = vbuf->lock(HardwareBuffer::HBL_READ_ONLY);
 
             if (mFlipEndian)
@@ -484,7 +858,7 @@ namespace Ogre {
                     tempData,
                     vertexData->vertexCount,
                     vbuf->getVertexSize(),
-                    vertexData->vertexDeclaration->findElementsBySource(vbi->first));
+                    bufferElems);
                 writeData(tempData, vbuf->getVertexSize(), vertexData->vertexCount);
                 OGRE_FREE(tempData, MEMCATEGORY_GEOMETRY);
             }
@@ -493,6 +867,7 @@ namespace Ogre {
                 writeData(pBuf, vbuf->getVertexSize(), vertexData->vertexCount);
             }
             vbuf->unlock();
+            writeBufferDataPaddingTail(paddingTail);
         }
                 popInnerChunk(mStream);
             }
@@ -593,14 +968,30 @@ namespace Ogre {
         size += sizeof(unsigned int);
         // bool indexes32bit
         size += sizeof(bool);
+        // unsigned char indexCompression
+        if (isGeometryCompressionSupported())
+            size += sizeof(uint8);
 
         bool idx32bit = (!pSub->indexData->indexBuffer.isNull() &&
             pSub->indexData->indexBuffer->getType() == HardwareIndexBuffer::IT_32BIT);
         // unsigned int* / unsigned short* faceVertexIndices
-        if (idx32bit)
-            size += sizeof(unsigned int) * pSub->indexData->indexCount;
+        const size_t rawIndexSize = pSub->indexData->indexCount *
+                (idx32bit ? sizeof(unsigned int) : sizeof(unsigned short));
+        size_t encodedIndexSize = 0;
+        if (mCompressGeometry && pSub->indexData->indexCount > 0)
+            encodedIndexSize = encodeIndices(pSub->indexData, 0);
+
+        if (encodedIndexSize > 0 && encodedIndexSize < rawIndexSize)
+        {
+            // unsigned int encodedSize, unsigned char encoded[encodedSize]
+            size += sizeof(uint32) + encodedIndexSize;
+        }
         else
-            size += sizeof(unsigned short) * pSub->indexData->indexCount;
+        {
+            size += rawIndexSize;
+            if (pSub->indexData->indexCount > 0)
+                size += calcBufferDataPaddingSize();
+        }
 
         // Geometry
         if (!pSub->useSharedVertices)
@@ -660,15 +1051,27 @@ namespace Ogre {
         size += MSTREAM_OVERHEAD_SIZE + elemList.size() * (MSTREAM_OVERHEAD_SIZE + sizeof(unsigned short)* 5);
         
         // Buffers and bindings
-        size += bindings.size() * ((MSTREAM_OVERHEAD_SIZE * 2) + (sizeof(unsigned short)* 2));
+        size += bindings.size() * (MSTREAM_OVERHEAD_SIZE + (sizeof(unsigned short)* 2));
 
         // Buffer data
         VertexBufferBinding::VertexBufferBindingMap::const_iterator vbi, vbiend;
         vbiend = bindings.end();
         for (vbi = bindings.begin(); vbi != vbiend; ++vbi)
         {
-            const HardwareVertexBufferSharedPtr& vbuf = vbi->second;
-            size += vbuf->getSizeInBytes();
+            if (mCompressGeometry)
+            {
+                const HardwareVertexBufferSharedPtr& vbuf = vbi->second;
+                const void* pBuf = vbuf->lock(HardwareBuffer::HBL_READ_ONLY);
+                size += calcCompressedVertexBufferSize(
+                            vertexData->vertexDeclaration->findElementsBySource(vbi->first),
+                            pBuf, vbuf->getVertexSize(), vertexData->vertexCount);
+                vbuf->unlock();
+            }
+            else
+            {
+                const HardwareVertexBufferSharedPtr& vbuf = vbi->second;
+                size += MSTREAM_OVERHEAD_SIZE + vbuf->getSizeInBytes() + calcBufferDataPaddingSize();
+            }
         }
         return size;
     }
@@ -802,7 +1205,8 @@ namespace Ogre {
         // Check for vertex data header
         unsigned short headerID;
         headerID = readChunk(stream);
-        if (headerID != M_GEOMETRY_VERTEX_BUFFER_DATA)
+        if (headerID != M_GEOMETRY_VERTEX_BUFFER_DATA &&
+            headerID != M_GEOMETRY_VERTEX_BUFFER_DATA_COMPRESSED)
         {
             OGRE_EXCEPT(Exception::ERR_ITEM_NOT_FOUND, "Can't find vertex buffer data area",
                 "MeshSerializerImpl::readGeometryVertexBuffer");
@@ -821,16 +1225,53 @@ namespace Ogre {
             dest->vertexCount,
             pMesh->mVertexBufferUsage,
             pMesh->mVertexBufferShadowBuffer);
-        void* pBuf = vbuf->lock(HardwareBuffer::HBL_DISCARD);
-        stream->read(pBuf, dest->vertexCount * vertexSize);
-
-        // endian conversion for OSX
-        flipFromLittleEndian(
-            pBuf,
-            dest->vertexCount,
-            vertexSize,
-            dest->vertexDeclaration->findElementsBySource(bindIndex));
-        vbuf->unlock();
+        const VertexDeclaration::VertexElementList elems =
+            dest->vertexDeclaration->findElementsBySource(bindIndex);
+        // Data that can't be uploaded as is gets decoded by the import jobs, see finishImportJobs
+        const bool deferred = canDeferVertexBuffer(elems);
+        ImportJob job( ImportJob::VERTEX_BUFFER );
+        job.vertexBuffer    = vbuf;
+        job.elements        = elems;
+
+        if (headerID == M_GEOMETRY_VERTEX_BUFFER_DATA_COMPRESSED)
+        {
+            if (deferred)
+            {
+                job.compressed = true;
+                addImportJob(stream, job, stream->tell() - MSTREAM_OVERHEAD_SIZE + mCurrentstreamLen);
+            }
+            else
+            {
+                void* pBuf = vbuf->lock(HardwareBuffer::HBL_DISCARD);
+                readCompressedVertexBuffer(stream, elems, pBuf, vertexSize, dest->vertexCount);
+                vbuf->unlock();
+            }
+        }
+        else
+        {
+        const size_t paddingTail = readBufferDataPaddingHead(stream);
+        if (!readBufferDataInPlace(stream, vbuf.get(), dest->vertexCount * vertexSize))
+        {
+            if (deferred)
+            {
+                addImportJob(stream, job, stream->tell() + dest->vertexCount * vertexSize);
+            }
+            else
+            {
+            void* pBuf = vbuf->lock(HardwareBuffer::HBL_DISCARD);
+            stream->read(pBuf, dest->vertexCount * vertexSize);
+
+            // endian conversion for OSX
+            flipFromLittleEndian(
+                pBuf,
+                dest->vertexCount,
+                vertexSize,
+                elems);
+            vbuf->unlock();
+            }
+        }
+        stream->skip(static_cast<long>(paddingTail));
+        }
 
         // Set binding
         dest->vertexBufferBinding->setBinding(bindIndex, vbuf);
@@ -962,10 +1403,16 @@ namespace Ogre {
                     readSubMeshNameTable(stream, pMesh);
                     break;
                 case M_EDGE_LISTS:
-                    readEdgeList(stream, pMesh);
+                    if (mParallelImport)
+                        scanEdgeList(stream, pMesh);
+                    else
+                        readEdgeList(stream, pMesh);
                     break;
                 case M_POSES:
-                    readPoses(stream, pMesh);
+                    if (mParallelImport)
+                        scanPoses(stream, pMesh);
+                    else
+                        readPoses(stream, pMesh);
                     break;
                 case M_ANIMATIONS:
                     readAnimations(stream, pMesh);
@@ -1015,39 +1462,105 @@ namespace Ogre {
         // bool indexes32Bit
         bool idx32bit;
         readBools(stream, &idx32bit, 1);
-        if (indexCount > 0)
+
+        // unsigned char indexCompression
+        uint8 indexCompression = MIC_RAW;
+        if (isGeometryCompressionSupported())
+            stream->read(&indexCompression, sizeof(uint8));
+
+        if (indexCompression == MIC_DELTA_VARINT)
         {
-            if (idx32bit)
+            // unsigned int encodedSize
+            uint32 encodedSize = 0;
+            readInts(stream, &encodedSize, 1);
+
+            ibuf = HardwareBufferManager::getSingleton().
+                createIndexBuffer(
+                    idx32bit ? HardwareIndexBuffer::IT_32BIT : HardwareIndexBuffer::IT_16BIT,
+                    sm->indexData->indexCount,
+                    pMesh->mIndexBufferUsage,
+                    pMesh->mIndexBufferShadowBuffer);
+
+            if (mParallelImport)
+            {
+                ImportJob job( ImportJob::INDEX_BUFFER );
+                job.indexBuffer = ibuf;
+                job.compressed  = true;
+                addImportJob(stream, job, stream->tell() + encodedSize);
+            }
+            else
+            {
+            void* pIdx = ibuf->lock(HardwareBuffer::HBL_DISCARD);
+            bool decoded = false;
+            MemoryDataStream *memoryStream = dynamic_cast<MemoryDataStream*>(stream.get());
+            if (memoryStream && stream->size() - stream->tell() >= encodedSize)
+            {
+                // Decode straight from the stream's memory
+                decoded = decodeIndices(memoryStream->getCurrentPtr(), encodedSize,
+                                        pIdx, indexCount, idx32bit);
+                stream->skip(static_cast<long>(encodedSize));
+            }
+            else if (encodedSize > 0)
+            {
+                vector<uint8>::type encoded(encodedSize);
+                if (stream->read(&encoded[0], encodedSize) == encodedSize)
+                    decoded = decodeIndices(&encoded[0], encodedSize, pIdx, indexCount, idx32bit);
+            }
+            ibuf->unlock();
+
+            if (!decoded)
+            {
+                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "Corrupt compressed index data in " +
+                            stream->getName(), "MeshSerializerImpl::readSubMesh");
+            }
+            }
+        }
+        else if (indexCompression != MIC_RAW)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "Unknown index compression in " +
+                        stream->getName(), "MeshSerializerImpl::readSubMesh");
+        }
+        else if (indexCount > 0)
+        {
+            const size_t paddingTail = readBufferDataPaddingHead(stream);
+
+            ibuf = HardwareBufferManager::getSingleton().
+                createIndexBuffer(
+                    idx32bit ? HardwareIndexBuffer::IT_32BIT : HardwareIndexBuffer::IT_16BIT,
+                    sm->indexData->indexCount,
+                    pMesh->mIndexBufferUsage,
+                    pMesh->mIndexBufferShadowBuffer);
+
+            if (!readBufferDataInPlace(stream, ibuf.get(), ibuf->getSizeInBytes()))
             {
-                ibuf = HardwareBufferManager::getSingleton().
-                    createIndexBuffer(
-                        HardwareIndexBuffer::IT_32BIT,
-                        sm->indexData->indexCount,
-                        pMesh->mIndexBufferUsage,
-                        pMesh->mIndexBufferShadowBuffer);
-                // unsigned int* faceVertexIndices
-                unsigned int* pIdx = static_cast<unsigned int*>(
-                    ibuf->lock(HardwareBuffer::HBL_DISCARD)
-                    );
-                readInts(stream, pIdx, sm->indexData->indexCount);
-                ibuf->unlock();
-
-            }
-            else // 16-bit
-            {
-                ibuf = HardwareBufferManager::getSingleton().
-                    createIndexBuffer(
-                        HardwareIndexBuffer::IT_16BIT,
-                        sm->indexData->indexCount,
-                        pMesh->mIndexBufferUsage,
-                        pMesh->mIndexBufferShadowBuffer);
-                // unsigned short* faceVertexIndices
-                unsigned short* pIdx = static_cast<unsigned short*>(
-                    ibuf->lock(HardwareBuffer::HBL_DISCARD)
-                    );
-                readShorts(stream, pIdx, sm->indexData->indexCount);
-                ibuf->unlock();
+                if (mParallelImport)
+                {
+                    // Endian swapped by an import job, see finishImportJobs
+                    ImportJob job( ImportJob::INDEX_BUFFER );
+                    job.indexBuffer = ibuf;
+                    addImportJob(stream, job, stream->tell() + ibuf->getSizeInBytes());
+                }
+                else if (idx32bit)
+                {
+                    // unsigned int* faceVertexIndices
+                    unsigned int* pIdx = static_cast<unsigned int*>(
+                        ibuf->lock(HardwareBuffer::HBL_DISCARD)
+                        );
+                    readInts(stream, pIdx, sm->indexData->indexCount);
+                    ibuf->unlock();
+                }
+                else // 16-bit
+                {
+                    // unsigned short* faceVertexIndices
+                    unsigned short* pIdx = static_cast<unsigned short*>(
+                        ibuf->lock(HardwareBuffer::HBL_DISCARD)
+                        );
+                    readShorts(stream, pIdx, sm->indexData->indexCount);
+                    ibuf->unlock();
+                }
             }
+
+            stream->skip(static_cast<long>(paddingTail));
         }
         sm->indexData->indexBuffer = ibuf;
 
@@ -1916,30 +2429,68 @@ namespace Ogre {
                     readEdgeListLodInfo(stream, usage.edgeData);
 
                     // Postprocessing edge groups
-                    EdgeData::EdgeGroupList::iterator egi, egend;
-                    egend = usage.edgeData->edgeGroups.end();
-                    for (egi = usage.edgeData->edgeGroups.begin(); egi != egend; ++egi)
+                    setupEdgeGroupVertexData(usage.edgeData, pMesh);
+                }
+
+                if (!stream->eof())
+                {
+                    streamID = readChunk(stream);
+                }
+
+            }
+            if (!stream->eof())
+            {
+                // Backpedal back to start of stream
+                backpedalChunkHeader(stream);
+            }
+            popInnerChunk(stream);
+        }
+
+        pMesh->mEdgeListsBuilt = true;
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::scanEdgeList(DataStreamPtr& stream, Mesh* pMesh)
+    {
+        if (!stream->eof())
+        {
+            pushInnerChunk(stream);
+            unsigned short streamID = readChunk(stream);
+            while(!stream->eof() &&
+                streamID == M_EDGE_LIST_LOD)
+            {
+                const size_t chunkEnd = stream->tell() - MSTREAM_OVERHEAD_SIZE + mCurrentstreamLen;
+
+                // unsigned short lodIndex
+                unsigned short lodIndex;
+                readShorts(stream, &lodIndex, 1);
+
+                // bool isManual
+                bool isManual;
+                readBools(stream, &isManual, 1);
+
+                if (!isManual)
+                {
+#if OGRE_NO_MESHLOD
+                    if (lodIndex != 0)
                     {
-                        EdgeData::EdgeGroup& edgeGroup = *egi;
-                        // Populate edgeGroup.vertexData pointers
-                        // If there is shared vertex data, vertexSet 0 is that,
-                        // otherwise 0 is first dedicated
-                        if (pMesh->sharedVertexData)
+                        stream->seek(chunkEnd);
+                    }
+                    else
+#endif
+                    {
+                        // Only the header is parsed now. The mesh gets the
+                        // EdgeData once it's been decoded, see finishImportJobs
+                        ImportJob job( ImportJob::EDGE_LIST_LOD );
+                        job.lodIndex        = lodIndex;
+                        job.edgeData        = OGRE_NEW EdgeData();
+                        try
                         {
-                            if (edgeGroup.vertexSet == 0)
-                            {
-                                edgeGroup.vertexData = pMesh->sharedVertexData;
-                            }
-                            else
-                            {
-                                edgeGroup.vertexData = pMesh->getSubMesh(
-                                    (unsigned short)edgeGroup.vertexSet-1)->vertexData;
-                            }
+                            addImportJob(stream, job, chunkEnd);
                         }
-                        else
+                        catch (Exception&)
                         {
-                            edgeGroup.vertexData = pMesh->getSubMesh(
-                                (unsigned short)edgeGroup.vertexSet)->vertexData;
+                            OGRE_DELETE job.edgeData;
+                            throw;
                         }
                     }
                 }
@@ -1961,6 +2512,36 @@ namespace Ogre {
         pMesh->mEdgeListsBuilt = true;
     }
     //---------------------------------------------------------------------
+    void MeshSerializerImpl::setupEdgeGroupVertexData(EdgeData *edgeData, Mesh* pMesh)
+    {
+        EdgeData::EdgeGroupList::iterator egi, egend;
+        egend = edgeData->edgeGroups.end();
+        for (egi = edgeData->edgeGroups.begin(); egi != egend; ++egi)
+        {
+            EdgeData::EdgeGroup& edgeGroup = *egi;
+            // Populate edgeGroup.vertexData pointers
+            // If there is shared vertex data, vertexSet 0 is that,
+            // otherwise 0 is first dedicated
+            if (pMesh->sharedVertexData)
+            {
+                if (edgeGroup.vertexSet == 0)
+                {
+                    edgeGroup.vertexData = pMesh->sharedVertexData;
+                }
+                else
+                {
+                    edgeGroup.vertexData = pMesh->getSubMesh(
+                        (unsigned short)edgeGroup.vertexSet-1)->vertexData;
+                }
+            }
+            else
+            {
+                edgeGroup.vertexData = pMesh->getSubMesh(
+                    (unsigned short)edgeGroup.vertexSet)->vertexData;
+            }
+        }
+    }
+    //---------------------------------------------------------------------
     void MeshSerializerImpl::readEdgeListLodInfo(DataStreamPtr& stream,
         EdgeData* edgeData)
     {
@@ -2443,6 +3024,49 @@ namespace Ogre {
         }
     }
     //---------------------------------------------------------------------
+    void MeshSerializerImpl::scanPoses(DataStreamPtr& stream, Mesh* pMesh)
+    {
+        if (!stream->eof())
+        {
+            pushInnerChunk(stream);
+            unsigned short streamID = readChunk(stream);
+            while(!stream->eof() &&
+                (streamID == M_POSE))
+            {
+                const size_t chunkEnd = stream->tell() - MSTREAM_OVERHEAD_SIZE + mCurrentstreamLen;
+
+                // char* name (may be blank)
+                String name = readString(stream);
+                // unsigned short target
+                unsigned short target;
+                readShorts(stream, &target, 1);
+
+                // bool includesNormals
+                bool includesNormals;
+                readBools(stream, &includesNormals, 1);
+
+                // Poses are created in order so their indices don't change;
+                // only their vertices are filled in by the jobs
+                ImportJob job( ImportJob::POSE_VERTICES );
+                job.pose            = pMesh->createPose(target, name);
+                job.includesNormals = includesNormals;
+                addImportJob(stream, job, chunkEnd);
+
+                if (!stream->eof())
+                {
+                    streamID = readChunk(stream);
+                }
+
+            }
+            if (!stream->eof())
+            {
+                // Backpedal back to start of stream
+                backpedalChunkHeader(stream);
+            }
+            popInnerChunk(stream);
+        }
+    }
+    //---------------------------------------------------------------------
     void MeshSerializerImpl::readPose(DataStreamPtr& stream, Mesh* pMesh)
     {
         // char* name (may be blank)
@@ -2457,6 +3081,11 @@ namespace Ogre {
         
         Pose* pose = pMesh->createPose(target, name);
 
+        readPoseVertices(stream, pose, includesNormals);
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::readPoseVertices(DataStreamPtr& stream, Pose* pose, bool includesNormals)
+    {
         // Find all substreams
         if (!stream->eof())
         {
@@ -2670,16 +3299,31 @@ namespace Ogre {
                 vertexSize, vertexCount,
                 HardwareBuffer::HBU_STATIC, true);
         // float x,y,z          // repeat by number of vertices in original geometry
-        float* pDst = static_cast<float*>(
-            vbuf->lock(HardwareBuffer::HBL_DISCARD));
-        readFloats(stream, pDst, vertexCount * (includesNormals ? 6 : 3));
-        vbuf->unlock();
+        if (!readBufferDataInPlace(stream, vbuf.get(), vertexCount * vertexSize))
+        {
+            if (mParallelImport)
+            {
+                ImportJob job( ImportJob::MORPH_KEYFRAME );
+                job.vertexBuffer    = vbuf;
+                job.includesNormals = includesNormals;
+                addImportJob(stream, job, stream->tell() + vertexCount * vertexSize);
+            }
+            else
+            {
+                float* pDst = static_cast<float*>(
+                    vbuf->lock(HardwareBuffer::HBL_DISCARD));
+                readFloats(stream, pDst, vertexCount * (includesNormals ? 6 : 3));
+                vbuf->unlock();
+            }
+        }
         kf->setVertexBuffer(vbuf);
 
     }
     //---------------------------------------------------------------------
     void MeshSerializerImpl::readPoseKeyFrame(DataStreamPtr& stream, VertexAnimationTrack* track)
     {
+        const size_t chunkEnd = stream->tell() - MSTREAM_OVERHEAD_SIZE + mCurrentstreamLen;
+
         // float time
         float timePos;
         readFloats(stream, &timePos, 1);
@@ -2687,6 +3331,21 @@ namespace Ogre {
         // Create keyframe
         VertexPoseKeyFrame* kf = track->createVertexPoseKeyFrame(timePos);
 
+        if (mParallelImport)
+        {
+            // Keyframes are created in order, only their pose references are read by the jobs
+            ImportJob job( ImportJob::POSE_KEYFRAME );
+            job.poseKeyFrame = kf;
+            addImportJob(stream, job, chunkEnd);
+        }
+        else
+        {
+            readPoseKeyFramePoseRefs(stream, kf);
+        }
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::readPoseKeyFramePoseRefs(DataStreamPtr& stream, VertexPoseKeyFrame* kf)
+    {
         if (!stream->eof())
         {
             pushInnerChunk(stream);
@@ -2750,8 +3409,442 @@ namespace Ogre {
         mReportChunkErrors = true;
 #endif
     }
+    //---------------------------------------------------------------------
+    size_t MeshSerializerImpl::calcBufferDataPaddingSize(void) const
+    {
+        // uint8 headBytes + up to (BUFFER_DATA_ALIGNMENT - 1) bytes before & after the data,
+        // always BUFFER_DATA_ALIGNMENT in total so chunk sizes can be known in advance.
+        return BUFFER_DATA_ALIGNMENT;
+    }
+    //---------------------------------------------------------------------
+    size_t MeshSerializerImpl::writeBufferDataPaddingHead(void)
+    {
+        const size_t paddingSize = calcBufferDataPaddingSize();
+        if (!paddingSize)
+            return 0;
 
+        const size_t dataStart = mStream->tell() + sizeof(uint8);
+        const uint8 headBytes = static_cast<uint8>( (BUFFER_DATA_ALIGNMENT -
+                                                    (dataStart % BUFFER_DATA_ALIGNMENT)) %
+                                                    BUFFER_DATA_ALIGNMENT );
+        writeData(&headBytes, sizeof(uint8), 1);
+        writeBufferDataPaddingTail(headBytes);
 
+        return paddingSize - sizeof(uint8) - headBytes;
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::writeBufferDataPaddingTail(size_t tailBytes)
+    {
+        const uint8 zero = 0;
+        for (size_t i = 0; i < tailBytes; ++i)
+            writeData(&zero, sizeof(uint8), 1);
+    }
+    //---------------------------------------------------------------------
+    size_t MeshSerializerImpl::readBufferDataPaddingHead(DataStreamPtr& stream)
+    {
+        const size_t paddingSize = calcBufferDataPaddingSize();
+        if (!paddingSize)
+            return 0;
+
+        uint8 headBytes = 0;
+        stream->read(&headBytes, sizeof(uint8));
+        if (headBytes >= paddingSize)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALID_STATE, "Corrupt buffer data padding in " +
+                        stream->getName(), "MeshSerializerImpl::readBufferDataPaddingHead");
+        }
+        stream->skip(headBytes);
+
+        return paddingSize - sizeof(uint8) - headBytes;
+    }
+    //---------------------------------------------------------------------
+    bool MeshSerializerImpl::readBufferDataInPlace(DataStreamPtr& stream, HardwareBuffer *dest,
+                                                   size_t sizeBytes)
+    {
+        if (mFlipEndian)
+            return false;
+
+        MemoryDataStream *memoryStream = dynamic_cast<MemoryDataStream*>(stream.get());
+        if (!memoryStream || stream->size() - stream->tell() < sizeBytes)
+            return false;
+
+        dest->writeData(0, sizeBytes, memoryStream->getCurrentPtr(), true);
+        stream->skip(static_cast<long>(sizeBytes));
+
+        return true;
+    }
+    //---------------------------------------------------------------------
+    bool MeshSerializerImpl::isGeometryCompressionSupported(void) const
+    {
+        return true;
+    }
+    //---------------------------------------------------------------------
+    MeshVertexElementCompression MeshSerializerImpl::getVertexElementCompression(
+            const VertexElement &elem, const void *pSrc, size_t vertexSize, size_t vertexCount)
+    {
+        if (VertexElement::getBaseType(elem.getType()) != VET_FLOAT1)
+            return MVEC_RAW;
+
+        switch (elem.getSemantic())
+        {
+        case VES_POSITION:
+        case VES_TEXTURE_COORDINATES:
+            return MVEC_UNORM16_RANGE;
+        case VES_NORMAL:
+        case VES_TANGENT:
+        case VES_BINORMAL:
+            // float4 tangents keep the handedness in w, which doesn't fit the octahedron
+            if (elem.getType() == VET_FLOAT3 &&
+                areUnitVectors(static_cast<const uint8*>(pSrc) + elem.getOffset(),
+                               vertexSize, vertexCount))
+            {
+                return MVEC_OCTAHEDRAL_SNORM16;
+            }
+            return MVEC_UNORM16_RANGE;
+        default:
+            return MVEC_RAW;
+        }
+    }
+    //---------------------------------------------------------------------
+    size_t MeshSerializerImpl::calcCompressedVertexBufferSize(
+            const VertexDeclaration::VertexElementList &elems, const void *pSrc,
+            size_t vertexSize, size_t vertexCount) const
+    {
+        size_t size = MSTREAM_OVERHEAD_SIZE;
+
+        VertexDeclaration::VertexElementList::const_iterator itor = elems.begin();
+        VertexDeclaration::VertexElementList::const_iterator end  = elems.end();
+        while (itor != end)
+        {
+            // unsigned char compression
+            size += sizeof(uint8);
+
+            switch (getVertexElementCompression(*itor, pSrc, vertexSize, vertexCount))
+            {
+            case MVEC_UNORM16_RANGE:
+            {
+                const size_t numComponents = VertexElement::getTypeCount(itor->getType());
+                size += numComponents * sizeof(float) * 2;
+                size += vertexCount * numComponents * sizeof(uint16);
+                break;
+            }
+            case MVEC_OCTAHEDRAL_SNORM16:
+                size += vertexCount * 2 * sizeof(uint16);
+                break;
+            case MVEC_RAW:
+                size += vertexCount * itor->getSize();
+                break;
+            }
+
+            ++itor;
+        }
+
+        return size;
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::writeCompressedVertexBuffer(
+            const VertexDeclaration::VertexElementList &elems, const void *pSrc,
+            size_t vertexSize, size_t vertexCount)
+    {
+        writeChunkHeader(M_GEOMETRY_VERTEX_BUFFER_DATA_COMPRESSED,
+                         calcCompressedVertexBufferSize(elems, pSrc, vertexSize, vertexCount));
+
+        VertexDeclaration::VertexElementList::const_iterator itor = elems.begin();
+        VertexDeclaration::VertexElementList::const_iterator end  = elems.end();
+        while (itor != end)
+        {
+            const VertexElement &elem = *itor;
+            const uint8 *pElem = static_cast<const uint8*>(pSrc) + elem.getOffset();
+
+            // unsigned char compression
+            const uint8 compression = getVertexElementCompression(elem, pSrc, vertexSize,
+                                                                  vertexCount);
+            writeData(&compression, sizeof(uint8), 1);
+
+            switch (compression)
+            {
+            case MVEC_UNORM16_RANGE:
+            {
+                const size_t numComponents = VertexElement::getTypeCount(elem.getType());
+
+                float minValue[4] = { 0, 0, 0, 0 };
+                float maxValue[4] = { 0, 0, 0, 0 };
+                for (size_t i = 0; i < vertexCount; ++i)
+                {
+                    const float *pValue = reinterpret_cast<const float*>(pElem + i * vertexSize);
+                    for (size_t c = 0; c < numComponents; ++c)
+                    {
+                        minValue[c] = i == 0 ? pValue[c] : std::min(minValue[c], pValue[c]);
+                        maxValue[c] = i == 0 ? pValue[c] : std::max(maxValue[c], pValue[c]);
+                    }
+                }
+
+                // float min[numComponents], max[numComponents]
+                writeFloats(minValue, numComponents);
+                writeFloats(maxValue, numComponents);
+
+                float scale[4];
+                for (size_t c = 0; c < numComponents; ++c)
+                {
+                    scale[c] = maxValue[c] > minValue[c] ?
+                                65535.0f / (maxValue[c] - minValue[c]) : 0.0f;
+                }
+
+                vector<uint16>::type values(vertexCount * numComponents);
+                for (size_t i = 0; i < vertexCount; ++i)
+                {
+                    const float *pValue = reinterpret_cast<const float*>(pElem + i * vertexSize);
+                    for (size_t c = 0; c < numComponents; ++c)
+                    {
+                        const float quantized = (pValue[c] - minValue[c]) * scale[c] + 0.5f;
+                        values[i * numComponents + c] =
+                                static_cast<uint16>(std::min(quantized, 65535.0f));
+                    }
+                }
+
+                // unsigned short values[vertexCount * numComponents]
+                if (!values.empty())
+                    writeShorts(&values[0], values.size());
+                break;
+            }
+            case MVEC_OCTAHEDRAL_SNORM16:
+            {
+                vector<int16>::type values(vertexCount * 2);
+                for (size_t i = 0; i < vertexCount; ++i)
+                {
+                    encodeOctahedral(reinterpret_cast<const float*>(pElem + i * vertexSize),
+                                     &values[i * 2]);
+                }
+
+                // short values[vertexCount * 2]
+                if (!values.empty())
+                    writeShorts(reinterpret_cast<const uint16*>(&values[0]), values.size());
+                break;
+            }
+            case MVEC_RAW:
+            {
+                const size_t elemSize = elem.getSize();
+                vector<uint8>::type values(vertexCount * elemSize);
+                for (size_t i = 0; i < vertexCount; ++i)
+                    memcpy(&values[i * elemSize], pElem + i * vertexSize, elemSize);
+
+                if (!values.empty())
+                {
+                    VertexDeclaration::VertexElementList packedElem;
+                    packedElem.push_back(VertexElement(0, 0, elem.getType(), elem.getSemantic(),
+                                                       elem.getIndex()));
+                    flipToLittleEndian(&values[0], vertexCount, elemSize, packedElem);
+
+                    // raw element data [vertexCount]
+                    writeData(&values[0], elemSize, vertexCount);
+                }
+                break;
+            }
+            }
+
+            ++itor;
+        }
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::readCompressedVertexBuffer(DataStreamPtr& stream,
+            const VertexDeclaration::VertexElementList &elems, void *pDst,
+            size_t vertexSize, size_t vertexCount)
+    {
+        // Bytes not covered by any element aren't stored
+        size_t elementsSize = 0;
+        VertexDeclaration::VertexElementList::const_iterator itor = elems.begin();
+        VertexDeclaration::VertexElementList::const_iterator end  = elems.end();
+        while (itor != end)
+            elementsSize += (itor++)->getSize();
+        if (elementsSize < vertexSize)
+            memset(pDst, 0, vertexSize * vertexCount);
+
+        itor = elems.begin();
+        while (itor != end)
+        {
+            const VertexElement &elem = *itor;
+            uint8 *pElem = static_cast<uint8*>(pDst) + elem.getOffset();
+
+            // unsigned char compression
+            uint8 compression = MVEC_RAW;
+            stream->read(&compression, sizeof(uint8));
+
+            const bool isFloat = VertexElement::getBaseType(elem.getType()) == VET_FLOAT1;
+            if ((compression == MVEC_UNORM16_RANGE && !isFloat) ||
+                (compression == MVEC_OCTAHEDRAL_SNORM16 && elem.getType() != VET_FLOAT3) ||
+                compression > MVEC_OCTAHEDRAL_SNORM16)
+            {
+                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                            "Invalid vertex element compression in " + stream->getName(),
+                            "MeshSerializerImpl::readCompressedVertexBuffer");
+            }
+
+            switch (compression)
+            {
+            case MVEC_UNORM16_RANGE:
+            {
+                const size_t numComponents = VertexElement::getTypeCount(elem.getType());
+
+                // float min[numComponents], max[numComponents]
+                float minValue[4];
+                float maxValue[4];
+                readFloats(stream, minValue, numComponents);
+                readFloats(stream, maxValue, numComponents);
+
+                float scale[4];
+                for (size_t c = 0; c < numComponents; ++c)
+                    scale[c] = (maxValue[c] - minValue[c]) / 65535.0f;
+
+                // unsigned short values[vertexCount * numComponents]
+                vector<uint16>::type values(vertexCount * numComponents);
+                if (!values.empty())
+                    readShorts(stream, &values[0], values.size());
+
+                for (size_t i = 0; i < vertexCount; ++i)
+                {
+                    float *pValue = reinterpret_cast<float*>(pElem + i * vertexSize);
+                    for (size_t c = 0; c < numComponents; ++c)
+                        pValue[c] = minValue[c] + values[i * numComponents + c] * scale[c];
+                }
+                break;
+            }
+            case MVEC_OCTAHEDRAL_SNORM16:
+            {
+                // short values[vertexCount * 2]
+                vector<int16>::type values(vertexCount * 2);
+                if (!values.empty())
+                    readShorts(stream, reinterpret_cast<uint16*>(&values[0]), values.size());
+
+                for (size_t i = 0; i < vertexCount; ++i)
+                    decodeOctahedral(&values[i * 2], reinterpret_cast<float*>(pElem + i * vertexSize));
+                break;
+            }
+            case MVEC_RAW:
+            {
+                // raw element data [vertexCount]
+                const size_t elemSize = elem.getSize();
+                vector<uint8>::type values(vertexCount * elemSize);
+                if (!values.empty())
+                {
+                    stream->read(&values[0], values.size());
+
+                    VertexDeclaration::VertexElementList packedElem;
+                    packedElem.push_back(VertexElement(0, 0, elem.getType(), elem.getSemantic(),
+                                                       elem.getIndex()));
+                    flipFromLittleEndian(&values[0], vertexCount, elemSize, packedElem);
+                }
+
+                for (size_t i = 0; i < vertexCount; ++i)
+                    memcpy(pElem + i * vertexSize, &values[i * elemSize], elemSize);
+                break;
+            }
+            }
+
+            ++itor;
+        }
+    }
+    //---------------------------------------------------------------------
+    size_t MeshSerializerImpl::encodeIndices(const IndexData *indexData,
+                                             vector<uint8>::type *outEncoded)
+    {
+        const HardwareIndexBufferSharedPtr &ibuf = indexData->indexBuffer;
+        const bool idx32bit = ibuf->getType() == HardwareIndexBuffer::IT_32BIT;
+        const void *pIdx = ibuf->lock(HardwareBuffer::HBL_READ_ONLY);
+        const uint32 *pIdx32 = static_cast<const uint32*>(pIdx);
+        const uint16 *pIdx16 = static_cast<const uint16*>(pIdx);
+
+        if (outEncoded)
+        {
+            outEncoded->clear();
+            outEncoded->reserve(indexData->indexCount * 2);
+        }
+
+        // Consecutive indices in an optimized mesh are close to each other, so the
+        // zigzag encoded difference usually fits in a single byte.
+        size_t encodedSize = 0;
+        uint32 prevIndex = 0;
+        for (size_t i = 0; i < indexData->indexCount; ++i)
+        {
+            const uint32 index = idx32bit ? pIdx32[i] : pIdx16[i];
+            const int32 delta = static_cast<int32>(index - prevIndex);
+            uint32 zigzag = (static_cast<uint32>(delta) << 1u) ^ static_cast<uint32>(delta >> 31);
+            prevIndex = index;
+
+            do
+            {
+                uint8 byte = static_cast<uint8>(zigzag & 0x7f);
+                zigzag >>= 7u;
+                if (zigzag)
+                    byte |= 0x80;
+                if (outEncoded)
+                    outEncoded->push_back(byte);
+                ++encodedSize;
+            }
+            while (zigzag);
+        }
+
+        ibuf->unlock();
+
+        return encodedSize;
+    }
+    //---------------------------------------------------------------------
+    bool MeshSerializerImpl::decodeIndices(const uint8 *pSrc, size_t srcSize, void *pDst,
+                                           size_t indexCount, bool idx32bit)
+    {
+        const uint8 *pEnd = pSrc + srcSize;
+        uint32 *pIdx32 = static_cast<uint32*>(pDst);
+        uint16 *pIdx16 = static_cast<uint16*>(pDst);
+
+        uint32 prevIndex = 0;
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            uint32 zigzag = 0;
+            uint32 shift = 0;
+            uint8 byte;
+            do
+            {
+                if (pSrc == pEnd || shift > 28u)
+                    return false;
+                byte = *pSrc++;
+                zigzag |= static_cast<uint32>(byte & 0x7f) << shift;
+                shift += 7u;
+            }
+            while (byte & 0x80);
+
+            prevIndex += (zigzag >> 1u) ^ (0u - (zigzag & 1u));
+
+            if (idx32bit)
+                pIdx32[i] = prevIndex;
+            else
+                pIdx16[i] = static_cast<uint16>(prevIndex);
+        }
+
+        return pSrc == pEnd;
+    }
+
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    MeshSerializerImpl_v1_10::MeshSerializerImpl_v1_10()
+    {
+        // Version number
+        mVersion = "[MeshSerializer_v1.100]";
+    }
+    //---------------------------------------------------------------------
+    MeshSerializerImpl_v1_10::~MeshSerializerImpl_v1_10()
+    {
+    }
+    //---------------------------------------------------------------------
+    size_t MeshSerializerImpl_v1_10::calcBufferDataPaddingSize(void) const
+    {
+        return 0;
+    }
+    //---------------------------------------------------------------------
+    bool MeshSerializerImpl_v1_10::isGeometryCompressionSupported(void) const
+    {
+        return false;
+    }
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
@@ -3215,6 +4308,12 @@ namespace Ogre {
         mReportChunkErrors = false;
 #endif
     }
+    //---------------------------------------------------------------------
+    bool MeshSerializerImpl_v1_8::isParallelImportSupported(void) const
+    {
+        // Chunk sizes written by older exporters can't be trusted, see enableValidation
+        return false;
+    }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
@@ -40,6 +40,7 @@ THE SOFTWARE.
 #include "Math/Array/OgreArraySphere.h"
 #include "Math/Array/OgreBooleanMask.h"
 #include "OgreRawPtr.h"
+#include "Math/Array/OgreArrayKernels.h"
 
 namespace Ogre {
     using namespace VisibilityFlags;
@@ -62,6 +63,8 @@ namespace Ogre {
         , mManager(0)
         , mLodMesh( &c_DefaultLodMesh )
         , mCurrentMeshLod( 0 )
+        , mCurrentLodValue( 0 )
+        , mCurrentLodStrategy( 0 )
         , mMinPixelSize(0)
         , mListener(0)
         , mDebugDisplay(false)
@@ -87,6 +90,8 @@ namespace Ogre {
         , mManager(0)
         , mLodMesh( &c_DefaultLodMesh )
         , mCurrentMeshLod( 0 )
+        , mCurrentLodValue( 0 )
+        , mCurrentLodStrategy( 0 )
         , mMinPixelSize(0)
         , mListener(0)
         , mDebugDisplay(false)
@@ -368,349 +373,37 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void MovableObject::updateAllBounds( const size_t numNodes, ObjectData objData )
     {
-        SimpleMatrix4 mats[ARRAY_PACKED_REALS];
-        for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
-        {
-            //Retrieve from parents. Unfortunately we need to do SoA -> AoS -> SoA conversion
-            ArrayMatrix4 parentMat;
-            ArrayVector3 parentScale;
-
-            for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
-            {
-                //Profiling shows these prefetches do make a difference. Perhaps playing with them could
-                //achieve even greater speed ups. This function is terribly bounded by memory latency
-                //Last tested on:
-                //  * Intel Quad Core Extreme QX9650 3Ghz
-                OGRE_PREFETCH_NTA( (const char*)(objData.mParents[i+OGRE_PREFETCH_SLOT_DISTANCE]) );
-
-                Vector3 scale;
-                const Transform &parentTransform = objData.mParents[j]->_getTransform();
-                parentTransform.mDerivedScale->getAsVector3( scale, parentTransform.mIndex );
-                mats[j].load( parentTransform.mDerivedTransform[parentTransform.mIndex] );
-                parentScale.setFromVector3( scale, j );
-
-                // j + OGRE_PREFETCH_SLOT_DISTANCE won't go out of bounds because
-                // the memory manager allocates enough extra space
-                OGRE_PREFETCH_NTA( (const char*)objData.mParents[j+(OGRE_PREFETCH_SLOT_DISTANCE>>1)]->
-                                    _getTransform().mDerivedScale );
-                OGRE_PREFETCH_NTA( (const char*)(objData.mParents[j+(OGRE_PREFETCH_SLOT_DISTANCE>>1)]->
-                                    _getTransform().mDerivedTransform+parentTransform.mIndex) );
-            }
-
-            parentMat.loadFromAoS( mats );
-
-            ArrayReal * RESTRICT_ALIAS worldRadius = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>
-                                                                        (objData.mWorldRadius);
-            ArrayReal * RESTRICT_ALIAS localRadius = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>
-                                                                        (objData.mLocalRadius);
-
-            *objData.mWorldAabb = *objData.mLocalAabb;
-            objData.mWorldAabb->transformAffine( parentMat );
-            *worldRadius = (*localRadius) * parentScale.getMaxComponent();
+        ArrayKernels::getImplementation()->updateAllBounds( numNodes, objData );
 
 #ifndef NDEBUG
+        for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
+        {
             for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
             {
                 if( objData.mOwner[j] )
                     objData.mOwner[j]->mCachedAabbOutOfDate = false;
             }
-#endif
 
             objData.advanceBoundsPack();
         }
+#endif
     }
     //-----------------------------------------------------------------------
     void MovableObject::cullFrustum( const size_t numNodes, ObjectData objData, const Frustum *frustum,
                                      uint32 sceneVisibilityFlags, MovableObjectArray &outCulledObjects,
                                      const Camera *lodCamera )
     {
-        //On threaded environments, the internal variables from outCulledObjects cause
-        //a false cache sharing because they're too close to each other. Perfoming
-        //a swap places those internal vars in the local stack, increasing scalability
-        MovableObjectArray culledObjects;
-        culledObjects.swap( outCulledObjects );
-
-        //Thanks to Fabian Giesen for summing up all known methods of frustum culling:
-        //http://fgiesen.wordpress.com/2010/10/17/view-frustum-culling/
-        // (we use method Method 5: "If you really don't care whether a box is
-        // partially or fully inside"):
-        // vector4 signFlip = componentwise_and(plane, 0x80000000);
-        // return dot3(center + xor(extent, signFlip), plane) > -plane.w;
-        struct ArrayPlane
-        {
-            ArrayVector3    planeNormal;
-            ArrayVector3    signFlip;
-            ArrayReal       planeNegD;
-        };
-
-        ArrayVector3 lodCameraPos;
-        lodCameraPos.setAll( lodCamera->_getCachedDerivedPosition() );
-
-        // Flip the bit from shadow caster, and leave only that in "includeNonCasters"
-        ArrayInt includeNonCasters = Mathlib::SetAll( ((sceneVisibilityFlags & LAYER_SHADOW_CASTER) ^ -1)
-                                                        & LAYER_SHADOW_CASTER );
-        sceneVisibilityFlags &= RESERVED_VISIBILITY_FLAGS;
-
-        ArrayInt sceneFlags = Mathlib::SetAll( sceneVisibilityFlags );
-        ArrayPlane planes[6];
-        const Plane *frustumPlanes = frustum->_getCachedFrustumPlanes();
-
-        for( size_t i=0; i<6; ++i )
-        {
-            planes[i].planeNormal.setAll( frustumPlanes[i].normal );
-            planes[i].signFlip.setAll( frustumPlanes[i].normal );
-            planes[i].signFlip.setToSign();
-            planes[i].planeNegD = Mathlib::SetAll( -frustumPlanes[i].d );
-        }
-
-        //TODO: Profile whether we should use XOR to flip the sign or simple multiplication.
-        //In theory xor is faster, but some archs have a penalty for switching between integer
-        //& floating point, even if it's simd sse
-        for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
-        {
-            ArrayInt * RESTRICT_ALIAS visibilityFlags = reinterpret_cast<ArrayInt*RESTRICT_ALIAS>
-                                                                        (objData.mVisibilityFlags);
-            ArrayReal * RESTRICT_ALIAS worldRadius = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>
-                                                                        (objData.mWorldRadius);
-            ArrayReal * RESTRICT_ALIAS upperDistance = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>
-                                                                        (objData.mUpperDistance);
-
-            //Test all 6 planes and AND the dot product. If one is false, then we're not visible
-            ArrayReal dotResult;
-            ArrayMaskR mask;
-            ArrayVector3 centerPlusFlippedHS;
-            centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
-                                                                 planes[0].signFlip;
-            dotResult = planes[0].planeNormal.dotProduct( centerPlusFlippedHS );
-            mask = Mathlib::CompareGreater( dotResult, planes[0].planeNegD );
-
-            centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
-                                                                 planes[1].signFlip;
-            dotResult = planes[1].planeNormal.dotProduct( centerPlusFlippedHS );
-            mask = Mathlib::And( mask, Mathlib::CompareGreater( dotResult, planes[1].planeNegD ) );
-
-            centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
-                                                                 planes[2].signFlip;
-            dotResult = planes[2].planeNormal.dotProduct( centerPlusFlippedHS );
-            mask = Mathlib::And( mask, Mathlib::CompareGreater( dotResult, planes[2].planeNegD ) );
-
-            centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
-                                                                 planes[3].signFlip;
-            dotResult = planes[3].planeNormal.dotProduct( centerPlusFlippedHS );
-            mask = Mathlib::And( mask, Mathlib::CompareGreater( dotResult, planes[3].planeNegD ) );
-
-            centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
-                                                                 planes[4].signFlip;
-            dotResult = planes[4].planeNormal.dotProduct( centerPlusFlippedHS );
-            mask = Mathlib::And( mask, Mathlib::CompareGreater( dotResult, planes[4].planeNegD ) );
-
-            centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
-                                                                 planes[5].signFlip;
-            dotResult = planes[5].planeNormal.dotProduct( centerPlusFlippedHS );
-            mask = Mathlib::And( mask, Mathlib::CompareGreater( dotResult, planes[5].planeNegD ) );
-
-            //Always pass the test if any of the components were
-            //Infinity (dot product above could've caused nans)
-            ArrayMaskR tmpMask = Mathlib::Or(
-                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[0] ),
-                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[1] ) );
-            mask = Mathlib::Or( Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[2] ),
-                                mask );
-
-            ArrayReal distance = lodCameraPos.distance( objData.mWorldAabb->mCenter );
-            mask = Mathlib::And( Mathlib::Or( mask, tmpMask ),
-                                 Mathlib::CompareLessEqual( distance, *worldRadius + *upperDistance ) );
-
-            //isVisible = isVisible() && (isCaster || includeNonCasters)
-            ArrayMaskI isVisible = Mathlib::And(
-                                Mathlib::TestFlags4( *visibilityFlags,
-                                                        Mathlib::SetAll( LAYER_VISIBILITY ) ),
-                                Mathlib::TestFlags4( Mathlib::Or( *visibilityFlags, includeNonCasters ),
-                                                        Mathlib::SetAll( LAYER_SHADOW_CASTER ) ) );
-
-            //Fuse result with visibility flag
-            // finalMask = ((visible|infinite_aabb) & sceneFlags & visibilityFlags) != 0 ? 0xffffffff : 0
-            ArrayMaskI finalMask = Mathlib::TestFlags4( CastRealToInt( mask ),
-                                                        Mathlib::And( sceneFlags, *visibilityFlags ) );
-            finalMask               = Mathlib::And( finalMask, isVisible );
-
-            const uint32 scalarMask = BooleanMask4::getScalarMask( finalMask );
-
-            for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
-            {
-                //Decompose the result for analyzing each MovableObject's
-                //There's no need to check objData.mOwner[j] is null because
-                //we set mVisibilityFlags to 0 on slot removals
-                if( IS_BIT_SET( j, scalarMask ) )
-                {
-                    culledObjects.push_back( objData.mOwner[j] );
-                }
-            }
-
-            objData.advanceFrustumPack();
-        }
-
-        culledObjects.swap( outCulledObjects );
+        ArrayKernels::getImplementation()->cullFrustum( numNodes, objData, frustum,
+                                                        sceneVisibilityFlags, outCulledObjects,
+                                                        lodCamera );
     }
     //-----------------------------------------------------------------------
     void MovableObject::cullLights( const size_t numNodes, ObjectData objData,
                                     LightListInfo &outGlobalLightList, const FrustumVec &frustums,
                                     const FrustumVec &cubemapFrustums )
     {
-        struct ArrayPlane
-        {
-            ArrayVector3    planeNormal;
-            ArrayVector3    signFlip;
-            ArrayReal       planeNegD;
-        };
-        struct ArraySixPlanes
-        {
-            ArrayPlane planes[6];
-        };
-        const size_t numFrustums = frustums.size();
-        ArraySixPlanes *planes = OGRE_ALLOC_T_SIMD( ArraySixPlanes, numFrustums,
-                                                    MEMCATEGORY_SCENE_CONTROL );
-
-        FrustumVec::const_iterator itor = frustums.begin();
-        FrustumVec::const_iterator end  = frustums.end();
-        ArraySixPlanes *planesIt = planes;
-
-        while( itor != end )
-        {
-            const Plane *frustumPlanes = (*itor)->_getCachedFrustumPlanes();
-
-            for( size_t i=0; i<6; ++i )
-            {
-                planesIt->planes[i].planeNormal.setAll( frustumPlanes[i].normal );
-                planesIt->planes[i].signFlip.setAll( frustumPlanes[i].normal );
-                planesIt->planes[i].signFlip.setToSign();
-                planesIt->planes[i].planeNegD = Mathlib::SetAll( -frustumPlanes[i].d );
-            }
-
-            ++planesIt;
-            ++itor;
-        }
-
-        const size_t numCubemapFrustums = cubemapFrustums.size();
-        RawSimdUniquePtr<ArrayAabb, MEMCATEGORY_SCENE_CONTROL> aabbsPtr =
-                                RawSimdUniquePtr<ArrayAabb, MEMCATEGORY_SCENE_CONTROL>( numCubemapFrustums );
-        ArrayAabb * RESTRICT_ALIAS aabbs = aabbsPtr.get();
-
-        itor = cubemapFrustums.begin();
-        end  = cubemapFrustums.end();
-        ArrayAabb *aabbsIt = aabbs;
-
-        while( itor != end )
-        {
-            assert( dynamic_cast<const Camera*>(*itor) );
-            const Camera *c = static_cast<const Camera*>(*itor);
-            aabbsIt->setAll( Aabb( c->_getCachedDerivedPosition(), Vector3(c->getFarClipDistance() * 0.5f) ) );
-            ++aabbsIt;
-            ++itor;
-        }
-
-        //Implementation detail: Ogre 1.9 treated spotlights as a point (Sphere vs Plane collision test)
-        //for simplicity (and presumably performance). We use aabbs for all lights in Ogre 2.0, which
-        //plays better with area lights when we implemented (and spotlights too) degrading performance
-        //for point lights
-
-        //TODO: Profile whether we should use XOR to flip signs
-        //instead of multiplication (see cullFrustum)
-        for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
-        {
-            //Initialize mask to 0
-            ArrayMaskI mask = ARRAY_INT_ZERO;
-
-            for( size_t j=0; j<numFrustums; ++j )
-            {
-                ArrayMaskR tmpMask;
-
-                //Test all 6 planes and AND the dot product. If one is false, then we're not visible
-                ArrayReal dotResult;
-                ArrayVector3 centerPlusFlippedHS;
-                centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
-                                                                    planes[j].planes[0].signFlip;
-                dotResult = planes[j].planes[0].planeNormal.dotProduct( centerPlusFlippedHS );
-                tmpMask = Mathlib::CompareGreater( dotResult, planes[j].planes[0].planeNegD );
-
-                centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
-                                                                     planes[j].planes[1].signFlip;
-                dotResult = planes[j].planes[1].planeNormal.dotProduct( centerPlusFlippedHS );
-                tmpMask = Mathlib::And( tmpMask, Mathlib::CompareGreater( dotResult,
-                                                                planes[j].planes[1].planeNegD ) );
-
-                centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
-                                                                     planes[j].planes[2].signFlip;
-                dotResult = planes[j].planes[2].planeNormal.dotProduct( centerPlusFlippedHS );
-                tmpMask = Mathlib::And( tmpMask, Mathlib::CompareGreater( dotResult,
-                                                                planes[j].planes[2].planeNegD ) );
-
-                centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
-                                                                     planes[j].planes[3].signFlip;
-                dotResult = planes[j].planes[3].planeNormal.dotProduct( centerPlusFlippedHS );
-                tmpMask = Mathlib::And( tmpMask, Mathlib::CompareGreater( dotResult,
-                                                                planes[j].planes[3].planeNegD ) );
-
-                centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
-                                                                     planes[j].planes[4].signFlip;
-                dotResult = planes[j].planes[4].planeNormal.dotProduct( centerPlusFlippedHS );
-                tmpMask = Mathlib::And( tmpMask, Mathlib::CompareGreater( dotResult,
-                                                                planes[j].planes[4].planeNegD ) );
-
-                centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
-                                                                     planes[j].planes[5].signFlip;
-                dotResult = planes[j].planes[5].planeNormal.dotProduct( centerPlusFlippedHS );
-                tmpMask = Mathlib::And( tmpMask, Mathlib::CompareGreater( dotResult,
-                                                                planes[j].planes[5].planeNegD ) );
-
-                //Accumulate into mask. If one Frustum can see, then we need to include it.
-                mask = Mathlib::Or( mask, CastRealToInt( tmpMask ) );
-            }
-
-            for( size_t j=0; j<numCubemapFrustums; ++j )
-            {
-                ArrayMaskR tmpMask = aabbs[j].contains( *objData.mWorldAabb );
-
-                //Accumulate into mask. If one Frustum can see, then we need to include it.
-                mask = Mathlib::Or( mask, CastRealToInt( tmpMask ) );
-            }
-
-            //Always pass the test if any of the components were
-            //Infinity (dot product above could've caused nans)
-            ArrayMaskR tmpMask = Mathlib::Or( Mathlib::Or(
-                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[0] ),
-                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[1] ) ),
-                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[2] ) );
-            mask = Mathlib::Or( mask, CastRealToInt( tmpMask ) );
-
-            //Use the light mask to discard null mOwner ptrs
-            mask = Mathlib::TestFlags4( mask, *reinterpret_cast<ArrayInt*RESTRICT_ALIAS>
-                                                (objData.mLightMask) );
-
-            const uint32 scalarMask = BooleanMask4::getScalarMask( mask );
-
-            for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
-            {
-                //Decompose the result for analyzing each MovableObject's
-                //There's no need to check objData.mOwner[j] is null because
-                //we set mVisibilityFlags to 0 on slot removals
-                if( IS_BIT_SET( j, scalarMask ) )
-                {
-                    const size_t idx = outGlobalLightList.lights.size();
-                    outGlobalLightList.visibilityMask[idx] = objData.mVisibilityFlags[j];
-                    outGlobalLightList.boundingSphere[idx] = Sphere(
-                                                        objData.mWorldAabb->mCenter.getAsVector3( j ),
-                                                        objData.mWorldRadius[j] );
-                    assert( dynamic_cast<Light*>( objData.mOwner[j] ) );
-                    outGlobalLightList.lights.push_back( static_cast<Light*>( objData.mOwner[j] ) );
-                }
-            }
-
-            objData.advanceCullLightPack();
-        }
-
-        OGRE_FREE_SIMD( planes, MEMCATEGORY_SCENE_CONTROL );
-        planes = 0;
+        ArrayKernels::getImplementation()->cullLights( numNodes, objData, outGlobalLightList,
+                                                       frustums, cubemapFrustums );
     }
     //-----------------------------------------------------------------------
     void MovableObject::buildLightList( const size_t numNodes, ObjectData objData,
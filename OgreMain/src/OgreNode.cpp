@@ -43,6 +43,7 @@ THE SOFTWARE.
 
 #include "Math/Array/OgreNodeMemoryManager.h"
 #include "Math/Array/OgreBooleanMask.h"
+#include "Math/Array/OgreArrayKernels.h"
 
 #ifndef NDEBUG
     #define CACHED_TRANSFORM_OUT_OF_DATE() this->_setCachedTransformOutOfDate()
@@ -313,57 +314,20 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void Node::updateAllTransforms( const size_t numNodes, Transform t )
     {
-        ArrayMatrix4 derivedTransform;
-        for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
-        {
-            //Retrieve from parents. Unfortunately we need to do SoA -> AoS -> SoA conversion
-            ArrayVector3 parentPos, parentScale;
-            ArrayQuaternion parentRot;
-
-            for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
-            {
-                Vector3 pos, scale;
-                Quaternion qRot;
-                const Transform &parentTransform = t.mParents[j]->mTransform;
-                parentTransform.mDerivedPosition->getAsVector3( pos, parentTransform.mIndex );
-                parentTransform.mDerivedOrientation->getAsQuaternion( qRot, parentTransform.mIndex );
-                parentTransform.mDerivedScale->getAsVector3( scale, parentTransform.mIndex );
-
-                parentPos.setFromVector3( pos, j );
-                parentRot.setFromQuaternion( qRot, j );
-                parentScale.setFromVector3( scale, j );
-            }
-
-            // Change position vector based on parent's orientation & scale
-            *t.mDerivedPosition = parentRot * (parentScale * (*t.mPosition));
+        ArrayKernels::getImplementation()->updateAllTransforms( numNodes, t );
 
-            // Combine orientation with that of parent
-            *t.mDerivedOrientation = ArrayQuaternion::Cmov4( parentRot * (*t.mOrientation),
-                                                             *t.mOrientation,
-                                                        BooleanMask4::getMask( t.mInheritOrientation ) );
-
-            // Scale own position by parent scale, NB just combine
-            // as equivalent axes, no shearing
-            *t.mDerivedScale = ArrayVector3::Cmov4( parentScale * (*t.mScale), *t.mScale,
-                                                    BooleanMask4::getMask( t.mInheritScale ) );
-
-            // Add altered position vector to parents
-            *t.mDerivedPosition += parentPos;
-
-            derivedTransform.makeTransform( *t.mDerivedPosition,
-                                            *t.mDerivedScale,
-                                            *t.mDerivedOrientation );
-            derivedTransform.storeToAoS( t.mDerivedTransform );
 #ifndef NDEBUG
+        for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
+        {
             for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
             {
                 if( t.mOwner[j] )
                     t.mOwner[j]->mCachedTransformOutOfDate = false;
             }
-#endif
 
             t.advancePack();
         }
+#endif
     }
     //-----------------------------------------------------------------------
     Node* Node::createChild( SceneMemoryMgrTypes sceneType,
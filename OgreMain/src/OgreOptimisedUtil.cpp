@@ -43,6 +43,14 @@ namespace Ogre {
     extern OptimisedUtil* _getOptimisedUtilGeneral(void);
 #if __OGRE_HAVE_SSE
     extern OptimisedUtil* _getOptimisedUtilSSE(void);
+    extern OptimisedUtil* _getOptimisedUtilAVX(void);
+
+    static bool _hasAVXAndFMA(void)
+    {
+        const uint requiredFeatures = PlatformInformation::CPU_FEATURE_AVX |
+                                      PlatformInformation::CPU_FEATURE_FMA;
+        return (PlatformInformation::getCpuFeatures() & requiredFeatures) == requiredFeatures;
+    }
 #endif
 #if __OGRE_HAVE_DIRECTXMATH
     extern OptimisedUtil* _getOptimisedUtilDirectXMath(void);
@@ -82,6 +90,7 @@ namespace Ogre {
             IMPL_DEFAULT,
 #if __OGRE_HAVE_SSE
             IMPL_SSE,
+            IMPL_AVX,
 #endif
             IMPL_COUNT
         };
@@ -129,6 +138,10 @@ namespace Ogre {
             {
                 mOptimisedUtils.push_back(_getOptimisedUtilSSE());
             }
+            if (_hasAVXAndFMA())
+            {
+                mOptimisedUtils.push_back(_getOptimisedUtilAVX());
+            }
 #endif
         }
 
@@ -384,7 +397,13 @@ namespace Ogre {
 #else   // !__DO_PROFILE__
 
 #if __OGRE_HAVE_SSE
-        if (PlatformInformation::getCpuFeatures() & PlatformInformation::CPU_FEATURE_SSE)
+        // The AVX version only replaces skinning & morphing, and forwards
+        // everything else to the SSE version.
+        if (_hasAVXAndFMA())
+        {
+            return _getOptimisedUtilAVX();
+        }
+        else if (PlatformInformation::getCpuFeatures() & PlatformInformation::CPU_FEATURE_SSE)
         {
             return _getOptimisedUtilSSE();
         }
@@ -0,0 +1,353 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+
+#include "OgreOptimisedUtil.h"
+#include "OgrePlatformInformation.h"
+
+#if __OGRE_HAVE_SSE
+
+#include "OgreMatrix4.h"
+#include "OgreVector4.h"
+
+#include <immintrin.h>
+
+//-------------------------------------------------------------------------
+//
+// AVX + FMA3 versions of the software skinning & morph routines. The
+// remaining routines aren't worth it & are forwarded to the SSE version.
+//
+// Unlike the SSE file, the instructions are enabled per function (via
+// the target pragma below) so the rest of the build doesn't need to be
+// compiled with AVX. Everything included above keeps the baseline target.
+// MSVC doesn't need this; it accepts the intrinsics regardless of /arch.
+//
+//-------------------------------------------------------------------------
+
+#if OGRE_COMPILER == OGRE_COMPILER_CLANG
+    #pragma clang attribute push( __attribute__((target("avx,fma"))), apply_to = function )
+#elif OGRE_COMPILER == OGRE_COMPILER_GNUC
+    #pragma GCC push_options
+    #pragma GCC target( "avx,fma" )
+#endif
+
+namespace Ogre {
+
+    extern OptimisedUtil* _getOptimisedUtilSSE(void);
+
+//-------------------------------------------------------------------------
+// Local classes
+//-------------------------------------------------------------------------
+
+    /** AVX implementation of OptimisedUtil.
+    @remarks
+        Skinning processes two vertices per iteration, one in each 128-bit lane:
+        the rows of both collapsed matrices are accumulated with the same FMA
+        instructions and transformed with a single vdpps per row. Morphing lerps
+        8 floats per instruction.
+    @note
+        Don't use this class directly, use OptimisedUtil instead.
+    */
+    class _OgrePrivate OptimisedUtilAVX : public OptimisedUtil
+    {
+    protected:
+        /// Implementation used for the routines that don't have an AVX version
+        OptimisedUtil* mFallback;
+
+    public:
+        /// Constructor
+        OptimisedUtilAVX(void) : mFallback(_getOptimisedUtilSSE()) {}
+
+        /// @copydoc OptimisedUtil::softwareVertexSkinning
+        virtual void softwareVertexSkinning(
+            const float *srcPosPtr, float *destPosPtr,
+            const float *srcNormPtr, float *destNormPtr,
+            const float *blendWeightPtr, const unsigned char* blendIndexPtr,
+            const Matrix4* const* blendMatrices,
+            size_t srcPosStride, size_t destPosStride,
+            size_t srcNormStride, size_t destNormStride,
+            size_t blendWeightStride, size_t blendIndexStride,
+            size_t numWeightsPerVertex,
+            size_t numVertices);
+
+        /// @copydoc OptimisedUtil::softwareVertexMorph
+        virtual void softwareVertexMorph(
+            Real t,
+            const float *srcPos1, const float *srcPos2,
+            float *dstPos,
+            size_t pos1VSize, size_t pos2VSize, size_t dstVSize, 
+            size_t numVertices,
+            bool morphNormals);
+
+        /// @copydoc OptimisedUtil::concatenateAffineMatrices
+        virtual void concatenateAffineMatrices(
+            const Matrix4& baseMatrix,
+            const Matrix4* srcMatrices,
+            Matrix4* dstMatrices,
+            size_t numMatrices)
+        {
+            mFallback->concatenateAffineMatrices(baseMatrix, srcMatrices, dstMatrices, numMatrices);
+        }
+
+        /// @copydoc OptimisedUtil::calculateFaceNormals
+        virtual void calculateFaceNormals(
+            const float *positions,
+            const EdgeData::Triangle *triangles,
+            Vector4 *faceNormals,
+            size_t numTriangles)
+        {
+            mFallback->calculateFaceNormals(positions, triangles, faceNormals, numTriangles);
+        }
+
+        /// @copydoc OptimisedUtil::calculateLightFacing
+        virtual void calculateLightFacing(
+            const Vector4& lightPos,
+            const Vector4* faceNormals,
+            char* lightFacings,
+            size_t numFaces)
+        {
+            mFallback->calculateLightFacing(lightPos, faceNormals, lightFacings, numFaces);
+        }
+
+        /// @copydoc OptimisedUtil::extrudeVertices
+        virtual void extrudeVertices(
+            const Vector4& lightPos,
+            Real extrudeDist,
+            const float* srcPositions,
+            float* destPositions,
+            size_t numVertices)
+        {
+            mFallback->extrudeVertices(lightPos, extrudeDist, srcPositions, destPositions,
+                                       numVertices);
+        }
+    };
+
+//---------------------------------------------------------------------
+// Helpers. The low 128-bit lane holds vertex A, the high lane vertex B.
+//---------------------------------------------------------------------
+
+    static FORCEINLINE __m256 _loadPair(const float *pA, const float *pB)
+    {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(pA)), _mm_loadu_ps(pB), 1);
+    }
+    //---------------------------------------------------------------------
+    static FORCEINLINE __m256 _broadcastPair(const float *pA, const float *pB)
+    {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_broadcast_ss(pA)),
+                                    _mm_broadcast_ss(pB), 1);
+    }
+    //---------------------------------------------------------------------
+    /// Loads (x, y, z, w) of both vertices
+    static FORCEINLINE __m256 _loadVector3Pair(const float *pA, const float *pB, float w)
+    {
+        return _mm256_setr_ps(pA[0], pA[1], pA[2], w, pB[0], pB[1], pB[2], w);
+    }
+    //---------------------------------------------------------------------
+    static FORCEINLINE void _storeVector3(float *pDst, __m128 v)
+    {
+        _mm_storel_pi((__m64*)pDst, v);
+        _mm_store_ss(pDst + 2, _mm_movehl_ps(v, v));
+    }
+    //---------------------------------------------------------------------
+    /// Normalises the xyz of both vertices, zero vectors are left untouched
+    static FORCEINLINE __m256 _normalisePair(__m256 v)
+    {
+        __m256 sqLength = _mm256_dp_ps(v, v, 0x77);
+        __m256 isZero   = _mm256_cmp_ps(sqLength, _mm256_setzero_ps(), _CMP_EQ_OQ);
+        __m256 length   = _mm256_sqrt_ps(_mm256_blendv_ps(sqLength, _mm256_set1_ps(1.0f), isZero));
+        return _mm256_div_ps(v, length);
+    }
+    //---------------------------------------------------------------------
+    /// Collapses the weighted matrices of both vertices into 3 rows
+    static FORCEINLINE void _collapseMatrixPair(
+        __m256 &row0, __m256 &row1, __m256 &row2,
+        const float *pWeightA, const float *pWeightB,
+        const unsigned char *pIndexA, const unsigned char *pIndexB,
+        const Matrix4* const* blendMatrices,
+        size_t numWeightsPerVertex)
+    {
+        const Matrix4 &mA = *blendMatrices[pIndexA[0]];
+        const Matrix4 &mB = *blendMatrices[pIndexB[0]];
+        __m256 weight = _broadcastPair(pWeightA, pWeightB);
+        row0 = _mm256_mul_ps(_loadPair(mA[0], mB[0]), weight);
+        row1 = _mm256_mul_ps(_loadPair(mA[1], mB[1]), weight);
+        row2 = _mm256_mul_ps(_loadPair(mA[2], mB[2]), weight);
+
+        for (size_t i = 1; i < numWeightsPerVertex; ++i)
+        {
+            const Matrix4 &nA = *blendMatrices[pIndexA[i]];
+            const Matrix4 &nB = *blendMatrices[pIndexB[i]];
+            weight = _broadcastPair(pWeightA + i, pWeightB + i);
+            row0 = _mm256_fmadd_ps(_loadPair(nA[0], nB[0]), weight, row0);
+            row1 = _mm256_fmadd_ps(_loadPair(nA[1], nB[1]), weight, row1);
+            row2 = _mm256_fmadd_ps(_loadPair(nA[2], nB[2]), weight, row2);
+        }
+    }
+    //---------------------------------------------------------------------
+    /// Transforms (x, y, z, w) by the 3 rows, result is (x', y', z', 0)
+    static FORCEINLINE __m256 _transformPair(__m256 row0, __m256 row1, __m256 row2, __m256 v)
+    {
+        return _mm256_or_ps(_mm256_or_ps(_mm256_dp_ps(row0, v, 0xF1),
+                                         _mm256_dp_ps(row1, v, 0xF2)),
+                            _mm256_dp_ps(row2, v, 0xF4));
+    }
+
+//---------------------------------------------------------------------
+// OptimisedUtilAVX implementation
+//---------------------------------------------------------------------
+
+    void OptimisedUtilAVX::softwareVertexSkinning(
+        const float *pSrcPos, float *pDestPos,
+        const float *pSrcNorm, float *pDestNorm,
+        const float *pBlendWeight, const unsigned char* pBlendIndex,
+        const Matrix4* const* blendMatrices,
+        size_t srcPosStride, size_t destPosStride,
+        size_t srcNormStride, size_t destNormStride,
+        size_t blendWeightStride, size_t blendIndexStride,
+        size_t numWeightsPerVertex,
+        size_t numVertices)
+    {
+        for (size_t i = 0; i < numVertices; i += 2)
+        {
+            // With an odd number of vertices the last one is processed twice,
+            // but only stored once.
+            const bool hasB = i + 1 < numVertices;
+            const size_t offsetB = hasB ? 1 : 0;
+
+            __m256 row0, row1, row2;
+            _collapseMatrixPair(row0, row1, row2,
+                                pBlendWeight,
+                                rawOffsetPointer(pBlendWeight, offsetB * blendWeightStride),
+                                pBlendIndex,
+                                rawOffsetPointer(pBlendIndex, offsetB * blendIndexStride),
+                                blendMatrices, numWeightsPerVertex);
+
+            // Positions
+            {
+                const float *pSrcPosB = rawOffsetPointer(pSrcPos, offsetB * srcPosStride);
+                __m256 pos = _transformPair(row0, row1, row2,
+                                            _loadVector3Pair(pSrcPos, pSrcPosB, 1.0f));
+                _storeVector3(pDestPos, _mm256_castps256_ps128(pos));
+                if (hasB)
+                {
+                    _storeVector3(rawOffsetPointer(pDestPos, destPosStride),
+                                  _mm256_extractf128_ps(pos, 1));
+                }
+            }
+
+            // Normals (translation is ignored since w = 0)
+            if (pSrcNorm)
+            {
+                const float *pSrcNormB = rawOffsetPointer(pSrcNorm, offsetB * srcNormStride);
+                __m256 norm = _transformPair(row0, row1, row2,
+                                             _loadVector3Pair(pSrcNorm, pSrcNormB, 0.0f));
+                norm = _normalisePair(norm);
+                _storeVector3(pDestNorm, _mm256_castps256_ps128(norm));
+                if (hasB)
+                {
+                    _storeVector3(rawOffsetPointer(pDestNorm, destNormStride),
+                                  _mm256_extractf128_ps(norm, 1));
+                }
+
+                advanceRawPointer(pSrcNorm, 2 * srcNormStride);
+                advanceRawPointer(pDestNorm, 2 * destNormStride);
+            }
+
+            advanceRawPointer(pSrcPos, 2 * srcPosStride);
+            advanceRawPointer(pDestPos, 2 * destPosStride);
+            advanceRawPointer(pBlendWeight, 2 * blendWeightStride);
+            advanceRawPointer(pBlendIndex, 2 * blendIndexStride);
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX::softwareVertexMorph(
+        Real t,
+        const float *pSrc1, const float *pSrc2,
+        float *pDst,
+        size_t pos1VSize, size_t pos2VSize, size_t dstVSize, 
+        size_t numVertices,
+        bool morphNormals)
+    {
+        // Same layout requirements as the SSE version: the buffers are packed,
+        // either positions only or interleaved positions & normals. We lerp
+        // everything first, then normalise just the normals.
+        const size_t numFloats = numVertices * (morphNormals ? 6 : 3);
+        const size_t numIterations = numFloats / 8;
+
+        const __m256 t8 = _mm256_set1_ps(t);
+
+        float *pStartDst = pDst;
+
+        for (size_t i = 0; i < numIterations; ++i)
+        {
+            __m256 src1 = _mm256_loadu_ps(pSrc1);
+            __m256 src2 = _mm256_loadu_ps(pSrc2);
+            _mm256_storeu_ps(pDst, _mm256_fmadd_ps(t8, _mm256_sub_ps(src2, src1), src1));
+            pSrc1 += 8; pSrc2 += 8; pDst += 8;
+        }
+
+        for (size_t i = numIterations * 8; i < numFloats; ++i)
+        {
+            *pDst = *pSrc1 + t * (*pSrc2 - *pSrc1);
+            ++pSrc1; ++pSrc2; ++pDst;
+        }
+
+        if (morphNormals)
+        {
+            // Two normals at a time, with the same tail trick as the skinning
+            float *pNorm = pStartDst + 3;
+            for (size_t i = 0; i < numVertices; i += 2)
+            {
+                const bool hasB = i + 1 < numVertices;
+                float *pNormB = hasB ? pNorm + 6 : pNorm;
+
+                __m256 norm = _normalisePair(_loadVector3Pair(pNorm, pNormB, 0.0f));
+                _storeVector3(pNorm, _mm256_castps256_ps128(norm));
+                if (hasB)
+                    _storeVector3(pNormB, _mm256_extractf128_ps(norm, 1));
+
+                pNorm += 12;
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    extern OptimisedUtil* _getOptimisedUtilAVX(void)
+    {
+        static OptimisedUtilAVX msOptimisedUtilAVX;
+        return &msOptimisedUtilAVX;
+    }
+
+}
+
+#if OGRE_COMPILER == OGRE_COMPILER_CLANG
+    #pragma clang attribute pop
+#elif OGRE_COMPILER == OGRE_COMPILER_GNUC
+    #pragma GCC pop_options
+#endif
+
+#endif // __OGRE_HAVE_SSE
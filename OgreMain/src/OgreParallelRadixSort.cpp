@@ -0,0 +1,189 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreParallelRadixSort.h"
+#include "OgreSceneManager.h"
+
+namespace Ogre
+{
+    const size_t ParallelRadixSort::PARALLEL_THRESHOLD = 8192;
+    //-----------------------------------------------------------------------------------
+    ParallelRadixSort::ParallelRadixSort() :
+        mPhase( PHASE_HISTOGRAM_ALL ),
+        mCurrentDigit( 0 ),
+        mNumThreads( 1 ),
+        mNumEntries( 0 ),
+        mSrc( 0 ),
+        mDst( 0 )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    ParallelRadixSort::~ParallelRadixSort()
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    void ParallelRadixSort::getThreadRange( size_t threadId, size_t &outStart, size_t &outEnd ) const
+    {
+        const size_t entriesPerThread = (mNumEntries + mNumThreads - 1) / mNumThreads;
+        outStart = std::min( threadId * entriesPerThread, mNumEntries );
+        outEnd   = std::min( outStart + entriesPerThread, mNumEntries );
+    }
+    //-----------------------------------------------------------------------------------
+    void ParallelRadixSort::executePhase( SceneManager *sceneManager )
+    {
+        if( sceneManager )
+            sceneManager->executeUserScalableTask( this, true );
+        else
+            execute( 0, 1 );
+    }
+    //-----------------------------------------------------------------------------------
+    void ParallelRadixSort::sort( EntryVec &entries, SceneManager *sceneManager )
+    {
+        mNumEntries = entries.size();
+        if( mNumEntries < 2 )
+            return;
+
+        if( mNumEntries < PARALLEL_THRESHOLD || !sceneManager ||
+            sceneManager->getNumWorkerThreads() <= 1 )
+        {
+            sceneManager = 0;
+        }
+
+        mNumThreads = sceneManager ? sceneManager->getNumWorkerThreads() : 1;
+
+        mTmpEntries.resize( mNumEntries );
+        mHistograms.resize( mNumThreads * NUM_DIGITS * NUM_BUCKETS );
+        mOffsets.resize( mNumThreads * NUM_BUCKETS );
+
+        mSrc = &entries[0];
+        mDst = &mTmpEntries[0];
+
+        mPhase = PHASE_HISTOGRAM_ALL;
+        executePhase( sceneManager );
+
+        bool histogramsValid = true;
+
+        for( size_t digit=0; digit<NUM_DIGITS; ++digit )
+        {
+            //The total count of each bucket doesn't depend on the order of the
+            //entries, so the histograms from PHASE_HISTOGRAM_ALL are always good for this.
+            bool skipDigit = false;
+            for( size_t bucket=0; bucket<NUM_BUCKETS && !skipDigit; ++bucket )
+            {
+                size_t count = 0;
+                for( size_t i=0; i<mNumThreads; ++i )
+                    count += mHistograms[(i * NUM_DIGITS + digit) * NUM_BUCKETS + bucket];
+                skipDigit = count == mNumEntries;
+            }
+
+            if( skipDigit )
+                continue;
+
+            mCurrentDigit = digit;
+
+            if( !histogramsValid )
+            {
+                mPhase = PHASE_HISTOGRAM;
+                executePhase( sceneManager );
+            }
+
+            //Entries from thread 0 go before those of thread 1 within the same bucket.
+            size_t offset = 0;
+            for( size_t bucket=0; bucket<NUM_BUCKETS; ++bucket )
+            {
+                for( size_t i=0; i<mNumThreads; ++i )
+                {
+                    mOffsets[i * NUM_BUCKETS + bucket] = offset;
+                    offset += mHistograms[(i * NUM_DIGITS + digit) * NUM_BUCKETS + bucket];
+                }
+            }
+
+            mPhase = PHASE_SCATTER;
+            executePhase( sceneManager );
+
+            std::swap( mSrc, mDst );
+            histogramsValid = false;
+        }
+
+        if( mSrc != &entries[0] )
+            entries.swap( mTmpEntries );
+    }
+    //-----------------------------------------------------------------------------------
+    void ParallelRadixSort::execute( size_t threadId, size_t numThreads )
+    {
+        assert( numThreads == mNumThreads );
+
+        size_t start, end;
+        getThreadRange( threadId, start, end );
+
+        const Entry * RESTRICT_ALIAS src = mSrc;
+
+        switch( mPhase )
+        {
+        case PHASE_HISTOGRAM_ALL:
+            {
+                size_t * RESTRICT_ALIAS histograms = &mHistograms[threadId * NUM_DIGITS * NUM_BUCKETS];
+                memset( histograms, 0, NUM_DIGITS * NUM_BUCKETS * sizeof(size_t) );
+
+                for( size_t i=start; i<end; ++i )
+                {
+                    uint64 key = src[i].key;
+                    for( size_t digit=0; digit<NUM_DIGITS; ++digit )
+                    {
+                        ++histograms[digit * NUM_BUCKETS + (key & 0xFF)];
+                        key >>= 8u;
+                    }
+                }
+            }
+            break;
+        case PHASE_HISTOGRAM:
+            {
+                size_t * RESTRICT_ALIAS histogram = &mHistograms[(threadId * NUM_DIGITS +
+                                                                  mCurrentDigit) * NUM_BUCKETS];
+                memset( histogram, 0, NUM_BUCKETS * sizeof(size_t) );
+
+                const size_t shift = mCurrentDigit * 8u;
+                for( size_t i=start; i<end; ++i )
+                    ++histogram[(src[i].key >> shift) & 0xFF];
+            }
+            break;
+        case PHASE_SCATTER:
+            {
+                size_t * RESTRICT_ALIAS offsets = &mOffsets[threadId * NUM_BUCKETS];
+                Entry * RESTRICT_ALIAS dst = mDst;
+
+                const size_t shift = mCurrentDigit * 8u;
+                for( size_t i=start; i<end; ++i )
+                    dst[offsets[(src[i].key >> shift) & 0xFF]++] = src[i];
+            }
+            break;
+        }
+    }
+}
@@ -160,7 +160,12 @@ namespace Ogre {
 #if OGRE_COMPILER == OGRE_COMPILER_MSVC
     #if _MSC_VER >= 1400 
         int CPUInfo[4];
+        #if _MSC_FULL_VER >= 150030729
+        // Clear the subleaf (ecx) like the other paths do, leaf 7 depends on it
+        __cpuidex(CPUInfo, query, 0);
+        #else
         __cpuid(CPUInfo, query);
+        #endif
         result._eax = CPUInfo[0];
         result._ebx = CPUInfo[1];
         result._ecx = CPUInfo[2];
@@ -283,6 +288,32 @@ namespace Ogre {
 #endif
     }
 
+    //---------------------------------------------------------------------
+    // Detect whether or not os saves the upper half of the YMM registers on
+    // context switches. Must only be called if CPUID reported OSXSAVE.
+    static bool _checkOperatingSystemSupportAVX(void)
+    {
+#if OGRE_COMPILER == OGRE_COMPILER_MSVC
+    #if _MSC_FULL_VER >= 160040219
+        // XCR0 bits 1 & 2: XMM & YMM state enabled by the OS
+        return (_xgetbv(0) & 0x6) == 0x6;
+    #else
+        return false;
+    #endif
+#elif (OGRE_COMPILER == OGRE_COMPILER_GNUC || OGRE_COMPILER == OGRE_COMPILER_CLANG) && OGRE_PLATFORM != OGRE_PLATFORM_NACL && OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+        uint xcr0Lo, xcr0Hi;
+        // xgetbv opcode, old assemblers don't know the mnemonic
+        __asm__ __volatile__
+        (
+            ".byte 0x0f, 0x01, 0xd0" : "=a" (xcr0Lo), "=d" (xcr0Hi) : "c" (0)
+        );
+        (void)xcr0Hi;
+        return (xcr0Lo & 0x6) == 0x6;
+#else
+        return false;
+#endif
+    }
+
     //---------------------------------------------------------------------
     // Compiler-independent routines
     //---------------------------------------------------------------------
@@ -298,6 +329,12 @@ namespace Ogre {
 #define CPUID_STD_HTT               (1<<28)     // EDX[28] - Bit 28 set indicates  Hyper-Threading Technology is supported in hardware.
 
 #define CPUID_STD_SSE3              (1<<0)      // ECX[0] - Bit 0 of standard function 1 indicate SSE3 supported
+#define CPUID_STD_FMA               (1<<12)     // ECX[12] - FMA3
+#define CPUID_STD_SSE41             (1<<19)     // ECX[19] - SSE4.1
+#define CPUID_STD_OSXSAVE           (1<<27)     // ECX[27] - OS uses XSAVE/XRSTOR, xgetbv is available
+#define CPUID_STD_AVX               (1<<28)     // ECX[28] - AVX
+
+#define CPUID_STD7_AVX2             (1<<5)      // EBX[5] - Bit 5 of structured extended function 7 indicate AVX2 supported
 
 #define CPUID_FAMILY_ID_MASK        0x0F00      // EAX[11:8] - Bit 11 thru 8 contains family  processor id
 #define CPUID_EXT_FAMILY_ID_MASK    0x0F00000   // EAX[23:20] - Bit 23 thru 20 contains extended family processor id
@@ -388,6 +425,29 @@ namespace Ogre {
                             features |= PlatformInformation::CPU_FEATURE_MMXEXT;
                     }
                 }
+
+                // Vendor independent extensions (Intel & AMD report them the same way)
+                const uint maxStdLevel = _performCpuid(0, result);
+                _performCpuid(1, result);
+
+                if (result._ecx & CPUID_STD_SSE41)
+                    features |= PlatformInformation::CPU_FEATURE_SSE41;
+
+                if ((result._ecx & CPUID_STD_AVX) && (result._ecx & CPUID_STD_OSXSAVE) &&
+                    _checkOperatingSystemSupportAVX())
+                {
+                    features |= PlatformInformation::CPU_FEATURE_AVX;
+
+                    if (result._ecx & CPUID_STD_FMA)
+                        features |= PlatformInformation::CPU_FEATURE_FMA;
+
+                    if (maxStdLevel >= 7)
+                    {
+                        _performCpuid(7, result);
+                        if (result._ebx & CPUID_STD7_AVX2)
+                            features |= PlatformInformation::CPU_FEATURE_AVX2;
+                    }
+                }
             }
         }
 
@@ -399,7 +459,9 @@ namespace Ogre {
         uint features = queryCpuFeatures();
 
         const uint sse_features = PlatformInformation::CPU_FEATURE_SSE |
-            PlatformInformation::CPU_FEATURE_SSE2 | PlatformInformation::CPU_FEATURE_SSE3;
+            PlatformInformation::CPU_FEATURE_SSE2 | PlatformInformation::CPU_FEATURE_SSE3 |
+            PlatformInformation::CPU_FEATURE_SSE41 | PlatformInformation::CPU_FEATURE_AVX |
+            PlatformInformation::CPU_FEATURE_AVX2 | PlatformInformation::CPU_FEATURE_FMA;
         if ((features & sse_features) && !_checkOperatingSystemSupportSSE())
         {
             features &= ~sse_features;
@@ -701,6 +763,14 @@ namespace Ogre {
                 " *      PRO: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_PRO), true));
             pLog->logMessage(
                 " *       HT: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_HTT), true));
+            pLog->logMessage(
+                " *   SSE4.1: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_SSE41), true));
+            pLog->logMessage(
+                " *      AVX: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_AVX), true));
+            pLog->logMessage(
+                " *     AVX2: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_AVX2), true));
+            pLog->logMessage(
+                " *      FMA: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_FMA), true));
         }
 #elif OGRE_CPU == OGRE_CPU_ARM || OGRE_PLATFORM == OGRE_PLATFORM_ANDROID
         pLog->logMessage(
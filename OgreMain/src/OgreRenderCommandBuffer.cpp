@@ -0,0 +1,228 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreRenderCommandBuffer.h"
+#include "OgreSceneManager.h"
+
+namespace Ogre
+{
+    const size_t RenderCommandBuffer::PARALLEL_THRESHOLD = 4096;
+    //-----------------------------------------------------------------------------------
+    RenderCommandBuffer::RenderCommandBuffer() :
+        mCollection( 0 ),
+        mOrganisationMode( QueuedRenderableCollection::OM_PASS_GROUP ),
+        mNumItems( 0 ),
+        mNumStateCommands( 0 ),
+        mNumDrawCommands( 0 ),
+        mNumRedundantStateCommands( 0 )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    RenderCommandBuffer::~RenderCommandBuffer()
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    void RenderCommandBuffer::record( const QueuedRenderableCollection &objs,
+                                      QueuedRenderableCollection::OrganisationMode om,
+                                      SceneManager *sceneManager )
+    {
+        mCollection         = &objs;
+        mOrganisationMode   = om;
+
+        if( om == QueuedRenderableCollection::OM_PASS_GROUP )
+        {
+            mNumItems = 0;
+            QueuedRenderableCollection::PassGroupRenderableMap::const_iterator itor =
+                                                                    objs.mGrouped.begin();
+            QueuedRenderableCollection::PassGroupRenderableMap::const_iterator end  =
+                                                                    objs.mGrouped.end();
+            while( itor != end )
+            {
+                mNumItems += itor->second->size();
+                ++itor;
+            }
+        }
+        else
+        {
+            mNumItems = objs.mSortedDescending.size();
+        }
+
+        if( mNumItems < PARALLEL_THRESHOLD || !sceneManager ||
+            sceneManager->getNumWorkerThreads() <= 1 )
+        {
+            mThreadCommands.resize( 1 );
+            execute( 0, 1 );
+        }
+        else
+        {
+            mThreadCommands.resize( sceneManager->getNumWorkerThreads() );
+            sceneManager->executeUserScalableTask( this, true );
+        }
+
+        mCollection = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void RenderCommandBuffer::addDraw( CommandVec &commands, const Pass *&lastPass,
+                                       Pass *pass, Renderable *renderable ) const
+    {
+        if( pass != lastPass )
+        {
+            commands.push_back( Command( COMMAND_SET_PASS, pass, 0 ) );
+            lastPass = pass;
+        }
+
+        commands.push_back( Command( COMMAND_DRAW, pass, renderable ) );
+    }
+    //-----------------------------------------------------------------------------------
+    void RenderCommandBuffer::execute( size_t threadId, size_t numThreads )
+    {
+        CommandVec &commands = mThreadCommands[threadId];
+        commands.clear();
+
+        const size_t itemsPerThread = (mNumItems + numThreads - 1) / numThreads;
+        const size_t start  = std::min( threadId * itemsPerThread, mNumItems );
+        const size_t end    = std::min( start + itemsPerThread, mNumItems );
+
+        const Pass *lastPass = 0;
+
+        if( mOrganisationMode == QueuedRenderableCollection::OM_PASS_GROUP )
+        {
+            QueuedRenderableCollection::PassGroupRenderableMap::const_iterator itor =
+                                                                mCollection->mGrouped.begin();
+            QueuedRenderableCollection::PassGroupRenderableMap::const_iterator enGroups =
+                                                                mCollection->mGrouped.end();
+
+            //Index of the first renderable of the current group
+            size_t groupStart = 0;
+
+            while( itor != enGroups && groupStart < end )
+            {
+                const QueuedRenderableCollection::RenderableList &renderables = *itor->second;
+                const size_t groupEnd = groupStart + renderables.size();
+
+                if( groupEnd > start )
+                {
+                    const size_t first  = std::max( start, groupStart ) - groupStart;
+                    const size_t last   = std::min( end, groupEnd ) - groupStart;
+
+                    for( size_t i=first; i<last; ++i )
+                        addDraw( commands, lastPass, itor->first, renderables[i] );
+                }
+
+                groupStart = groupEnd;
+                ++itor;
+            }
+        }
+        else
+        {
+            const QueuedRenderableCollection::RenderablePassList &sorted =
+                                                                mCollection->mSortedDescending;
+            //Ascending order iterates the list backwards
+            const bool ascending = mOrganisationMode == QueuedRenderableCollection::OM_SORT_ASCENDING;
+
+            for( size_t i=start; i<end; ++i )
+            {
+                const RenderablePass &rp = sorted[ascending ? mNumItems - i - 1 : i];
+                commands.push_back( Command( COMMAND_DRAW_RENDERABLE_PASS,
+                                             rp.pass, rp.renderable ) );
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void RenderCommandBuffer::replay( QueuedRenderableVisitor *visitor )
+    {
+        mNumStateCommands           = 0;
+        mNumDrawCommands            = 0;
+        mNumRedundantStateCommands  = 0;
+
+        const Pass *lastPass = 0;
+        bool skipDraws = false;
+
+        CommandVecVec::const_iterator itThread = mThreadCommands.begin();
+        CommandVecVec::const_iterator enThread = mThreadCommands.end();
+
+        while( itThread != enThread )
+        {
+            CommandVec::const_iterator itor = itThread->begin();
+            CommandVec::const_iterator end  = itThread->end();
+
+            while( itor != end )
+            {
+                if( itor->type == COMMAND_SET_PASS )
+                {
+                    if( itor->pass != lastPass )
+                    {
+                        skipDraws = !visitor->visit( itor->pass );
+                        lastPass = itor->pass;
+                        ++mNumStateCommands;
+                    }
+                    else
+                    {
+                        ++mNumRedundantStateCommands;
+                    }
+                }
+                else if( itor->type == COMMAND_DRAW_RENDERABLE_PASS )
+                {
+                    //The visitor sets the pass (if it needs to) and draws
+                    if( itor->pass != lastPass )
+                    {
+                        lastPass = itor->pass;
+                        ++mNumStateCommands;
+                    }
+
+                    RenderablePass rp( itor->renderable, itor->pass );
+                    visitor->visit( &rp );
+                    ++mNumDrawCommands;
+                }
+                else if( !skipDraws )
+                {
+                    visitor->visit( itor->renderable );
+                    ++mNumDrawCommands;
+                }
+
+                ++itor;
+            }
+
+            ++itThread;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void RenderCommandBuffer::clear(void)
+    {
+        CommandVecVec::iterator itor = mThreadCommands.begin();
+        CommandVecVec::iterator end  = mThreadCommands.end();
+
+        while( itor != end )
+        {
+            itor->clear();
+            ++itor;
+        }
+    }
+}
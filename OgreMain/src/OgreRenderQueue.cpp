@@ -224,5 +224,19 @@ namespace Ogre {
             pDstGroup->merge( pSrcGroup );
         }
     }
+    //-----------------------------------------------------------------------
+    void RenderQueue::sort( const Camera *cam, SceneManager *sceneManager )
+    {
+        RenderQueueGroupMap::const_iterator itor = mGroups.begin();
+        RenderQueueGroupMap::const_iterator end  = mGroups.end();
+
+        while( itor != end )
+        {
+            RenderQueueGroup::PriorityMapIterator groupIt = itor->second->getIterator();
+            while( groupIt.hasMoreElements() )
+                groupIt.getNext()->sort( cam, sceneManager );
+            ++itor;
+        }
+    }
 }
 
@@ -29,13 +29,11 @@ THE SOFTWARE.
 #include "OgreRenderQueueSortingGrouping.h"
 #include "OgreException.h"
 #include "OgreTechnique.h"
+#include "OgreSceneManager.h"
 
 namespace Ogre {
     // Init statics
-    RadixSort<QueuedRenderableCollection::RenderablePassList,
-        RenderablePass, uint32> QueuedRenderableCollection::msRadixSorter1;
-    RadixSort<QueuedRenderableCollection::RenderablePassList,
-        RenderablePass, float> QueuedRenderableCollection::msRadixSorter2;
+    ParallelRadixSort QueuedRenderableCollection::msRadixSorter;
 
 
     //-----------------------------------------------------------------------
@@ -180,11 +178,11 @@ namespace Ogre {
 
     }
     //-----------------------------------------------------------------------
-    void RenderPriorityGroup::sort(const Camera* cam)
+    void RenderPriorityGroup::sort(const Camera* cam, SceneManager *sceneManager)
     {
-        mSolidsBasic.sort(cam);
-        mTransparentsUnsorted.sort(cam);
-        mTransparents.sort(cam);
+        mSolidsBasic.sort(cam, sceneManager);
+        mTransparentsUnsorted.sort(cam, sceneManager);
+        mTransparents.sort(cam, sceneManager);
     }
     //-----------------------------------------------------------------------
     void RenderPriorityGroup::merge( const RenderPriorityGroup* rhs )
@@ -196,6 +194,7 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     QueuedRenderableCollection::QueuedRenderableCollection(void)
         :mOrganisationMode(0)
+        ,mSortedCamera(0)
     {
     }
     //-----------------------------------------------------------------------
@@ -224,6 +223,7 @@ namespace Ogre {
 
         // Clear sorted list
         mSortedDescending.clear();
+        mSortedCamera = 0;
     }
     //-----------------------------------------------------------------------
     void QueuedRenderableCollection::removePassGroup(Pass* p)
@@ -240,8 +240,12 @@ namespace Ogre {
         }
     }
     //-----------------------------------------------------------------------
-    void QueuedRenderableCollection::sort(const Camera* cam)
+    void QueuedRenderableCollection::sort(const Camera* cam, SceneManager *sceneManager)
     {
+        // Already sorted for this camera (i.e. by RenderQueue::sort ahead of rendering)
+        if (mSortedCamera == cam)
+            return;
+
         // ascending and descending sort both set bit 1
         // We always sort descending, because the only difference is in the
         // acceptVisitor method, where we iterate in reverse in ascending mode
@@ -249,22 +253,38 @@ namespace Ogre {
         {
             
             // We can either use a stable_sort and the 'less' implementation,
-            // or a 2-pass radix sort (once by pass, then by distance, since
-            // radix sorting is inherently stable this will work)
-            // We use stable_sort if the number of items is 512 or less, since
-            // the complexity of the radix sort is approximately O(10N), since 
-            // each sort is O(5N) (1 pass histograms, 4 passes sort)
-            // Since stable_sort has a worst-case performance of O(N(logN)^2)
-            // the performance tipping point is from about 1500 items, but in
-            // stable_sorts best-case scenario O(NlogN) it would be much higher.
-            // Take a stab at 2000 items.
+            // or a radix sort on a 64-bit key made of the depth and the pass
+            // hash (see DepthSortKeyTask).
+            // We use stable_sort if the number of items is 2000 or less, since
+            // the complexity of the radix sort is approximately O(N) with a
+            // big constant (key building, 1 pass histograms, up to 8 passes sort
+            // and the final reordering), while stable_sort has a worst-case
+            // performance of O(N(logN)^2) but is very fast for small N.
             
             if (mSortedDescending.size() > 2000)
             {
-                // sort by pass
-                msRadixSorter1.sort(mSortedDescending, RadixSortFunctorPass());
-                // sort by depth
-                msRadixSorter2.sort(mSortedDescending, RadixSortFunctorDistance(cam));
+                const size_t numItems = mSortedDescending.size();
+                mSortKeys.resize(numItems);
+
+                DepthSortKeyTask keyTask(this, cam);
+                if (sceneManager && numItems >= ParallelRadixSort::PARALLEL_THRESHOLD)
+                    sceneManager->executeUserScalableTask(&keyTask, true);
+                else
+                    keyTask.execute(0, 1);
+
+                msRadixSorter.sort(mSortKeys, sceneManager);
+
+                mTmpSortedDescending.clear();
+                mTmpSortedDescending.reserve(numItems);
+                ParallelRadixSort::EntryVec::const_iterator itor = mSortKeys.begin();
+                ParallelRadixSort::EntryVec::const_iterator end  = mSortKeys.end();
+                while (itor != end)
+                {
+                    mTmpSortedDescending.push_back(mSortedDescending[itor->value]);
+                    ++itor;
+                }
+
+                mSortedDescending.swap(mTmpSortedDescending);
             }
             else
             {
@@ -276,10 +296,40 @@ namespace Ogre {
 
         // Nothing needs to be done for pass groups, they auto-organise
 
+        mSortedCamera = cam;
+    }
+    //-----------------------------------------------------------------------
+    void QueuedRenderableCollection::DepthSortKeyTask::execute(size_t threadId, size_t numThreads)
+    {
+        const RenderablePassList &sortedDescending = collection->mSortedDescending;
+        ParallelRadixSort::Entry * RESTRICT_ALIAS sortKeys = &collection->mSortKeys[0];
+
+        const size_t numItems = sortedDescending.size();
+        const size_t itemsPerThread = (numItems + numThreads - 1) / numThreads;
+        const size_t start = std::min(threadId * itemsPerThread, numItems);
+        const size_t end   = std::min(start + itemsPerThread, numItems);
+
+        for (size_t i = start; i < end; ++i)
+        {
+            const RenderablePass &rp = sortedDescending[i];
+
+            // Flip the float so that it sorts like an unsigned int (negative numbers
+            // have all their bits flipped, positive ones just the sign bit) then invert
+            // it because far objects go first.
+            union { float f; uint32 u; } depth;
+            depth.f = static_cast<float>(rp.renderable->getSquaredViewDepth(camera));
+            const uint32 mask = -static_cast<int32>(depth.u >> 31u) | 0x80000000;
+            depth.u = ~(depth.u ^ mask);
+
+            sortKeys[i] = ParallelRadixSort::Entry(
+                        (static_cast<uint64>(depth.u) << 32ul) | rp.pass->getHash(), i);
+        }
     }
     //-----------------------------------------------------------------------
     void QueuedRenderableCollection::addRenderable(Pass* pass, Renderable* rend)
     {
+        mSortedCamera = 0;
+
         // ascending and descending sort both set bit 1
         if (mOrganisationMode & OM_SORT_DESCENDING)
         {
@@ -400,6 +450,7 @@ namespace Ogre {
     void QueuedRenderableCollection::merge( const QueuedRenderableCollection& rhs )
     {
         mSortedDescending.insert( mSortedDescending.end(), rhs.mSortedDescending.begin(), rhs.mSortedDescending.end() );
+        mSortedCamera = 0;
 
         PassGroupRenderableMap::const_iterator srcGroup;
         for( srcGroup = rhs.mGrouped.begin(); srcGroup != rhs.mGrouped.end(); ++srcGroup )
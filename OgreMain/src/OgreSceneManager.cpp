@@ -74,9 +74,25 @@ THE SOFTWARE.
 // This class implements the most basic scene manager
 
 #include <cstdio>
+#include <limits>
 
 namespace Ogre {
 
+//-----------------------------------------------------------------------
+/** Splits numObjs into enough chunks so that idle threads have something to steal, but
+    not so small that the scheduling overhead dominates. Always a multiple of ARRAY_PACKED_REALS.
+*/
+static size_t calculateChunkSize( size_t numObjs, size_t numThreads )
+{
+    const size_t c_chunksPerThread  = 8;
+    const size_t c_minObjsPerChunk  = 64;
+
+    size_t objsPerChunk = ( numObjs + numThreads * c_chunksPerThread - 1 ) /
+                            ( numThreads * c_chunksPerThread );
+    objsPerChunk = std::max( objsPerChunk, c_minObjsPerChunk );
+    return ( (objsPerChunk + ARRAY_PACKED_REALS - 1) / ARRAY_PACKED_REALS ) * ARRAY_PACKED_REALS;
+}
+
 //-----------------------------------------------------------------------
 uint32 SceneManager::QUERY_ENTITY_DEFAULT_MASK         = 0x80000000;
 uint32 SceneManager::QUERY_FX_DEFAULT_MASK             = 0x40000000;
@@ -88,6 +104,8 @@ SceneManager::SceneManager(const String& name, size_t numWorkerThreads,
                            InstancingThreadedCullingMethod threadedCullingMethod) :
 mStaticMinDepthLevelDirty( 0 ),
 mStaticEntitiesDirty( true ),
+mStaticBvhCulling( false ),
+mMaxMemoryMovesPerFrame( 0 ),
 mName(name),
 mRenderQueue(0),
 mLastRenderQueueInvocationCustom(false),
@@ -137,12 +155,14 @@ mVisibilityMask(0xFFFFFFFF & VisibilityFlags::RESERVED_VISIBILITY_FLAGS),
 mFindVisibleObjects(true),
 mNumWorkerThreads( numWorkerThreads ),
 mExitWorkerThreads( false ),
-mUpdateBoundsRequest( 0 ),
 mInstancingThreadedCullingMethod( threadedCullingMethod ),
 mUserTask( 0 ),
-mRequestType( NUM_REQUESTS ),
 mWorkerThreadsBarrier( 0 ),
+mTaskScheduler( 0 ),
+mCullPrefetch( false ),
+mCullPrefetchState( CULL_PREFETCH_NONE ),
 mSuppressRenderStateChanges(false),
+mUseRenderCommandBuffer(false),
 mLastLightHash(0),
 mLastLightLimit(0),
 mLastLightHashGpuProgram(0),
@@ -421,6 +441,8 @@ void SceneManager::destroyAllCameras(void)
 //-----------------------------------------------------------------------
 void SceneManager::clearFrameData(void)
 {
+    syncCullPrefetch();
+    mCullPrefetchState = CULL_PREFETCH_NONE;
     mGlobalLightList.lights.clear();
 }
 //-----------------------------------------------------------------------
@@ -523,6 +545,11 @@ void SceneManager::destroySkeletonInstance( SkeletonInstance *skeletonInstance )
     mSkeletonAnimationManager.destroySkeletonInstance( skeletonInstance );
 }
 //-----------------------------------------------------------------------
+BonePaletteBuffer* SceneManager::getBonePaletteBuffer( const SkeletonDef *skeletonDef )
+{
+    return mSkeletonAnimationManager.getBonePaletteBuffer( skeletonDef );
+}
+//-----------------------------------------------------------------------
 void SceneManager::destroyAllBillboardSets(void)
 {
     destroyAllMovableObjectsByType(BillboardSetFactory::FACTORY_TYPE_NAME);
@@ -1136,6 +1163,8 @@ void SceneManager::prepareRenderQueue(void)
 //-----------------------------------------------------------------------
 void SceneManager::_swapVisibleObjectsForShadowMapping()
 {
+    syncCullPrefetch();
+    mCullPrefetchState = CULL_PREFETCH_NONE;
     mVisibleObjects.swap( mVisibleObjectsBackup );
 }
 //-----------------------------------------------------------------------
@@ -1162,37 +1191,7 @@ void SceneManager::_cullPhase01( Camera* camera, const Camera *lodCamera, Viewpo
             prepareRenderQueue();
         }*/
 
-        if (mFindVisibleObjects)
-        {
-            OgreProfileGroup("cullFrustum", OGREPROF_CULLING);
-
-            assert( !mEntitiesMemoryManagerCulledList.empty() );
-
-            // Quick way of reducing overhead/stress on VisibleObjectsBoundsInfo
-            // calculation (lastRq can be up to 255)
-            uint8 realFirstRq= firstRq;
-            uint8 realLastRq = 0;
-            {
-                ObjectMemoryManagerVec::const_iterator itor = mEntitiesMemoryManagerCulledList.begin();
-                ObjectMemoryManagerVec::const_iterator end  = mEntitiesMemoryManagerCulledList.end();
-                while( itor != end )
-                {
-                    realFirstRq = std::min<uint8>( realFirstRq, (*itor)->_getTotalRenderQueues() );
-                    realLastRq  = std::max<uint8>( realLastRq, (*itor)->_getTotalRenderQueues() );
-                    ++itor;
-                }
-
-                //clamp RQ values to the real RQ range
-                realFirstRq = std::min(realLastRq, std::max(realFirstRq, firstRq));
-                realLastRq = std::min(realLastRq, std::max(realFirstRq, lastRq));
-            }
-
-            camera->_setRenderedRqs( realFirstRq, realLastRq );
-
-            CullFrustumRequest cullRequest( realFirstRq, realLastRq,
-                                            &mEntitiesMemoryManagerCulledList, camera, lodCamera );
-            fireCullFrustumThreads( cullRequest );
-        }
+        cullVisibleObjects( camera, lodCamera, vp->getVisibilityMask(), firstRq, lastRq );
     } // end lock on scene graph mutex
 }
 //-----------------------------------------------------------------------
@@ -1253,7 +1252,10 @@ void SceneManager::_renderPhase02(Camera* camera, const Camera *lodCamera, Viewp
         {
             OgreProfileGroup("_updateRenderQueue", OGREPROF_CULLING);
 
-            if( mInstancingThreadedCullingMethod == INSTANCING_CULLING_THREADED )
+            //Unified instance batches always cull their instances in the worker threads
+            const bool unifiedInstancing = hasUnifiedInstanceManagers();
+
+            if( mInstancingThreadedCullingMethod == INSTANCING_CULLING_THREADED || unifiedInstancing )
             {
                 fireCullFrustumInstanceBatchThreads( InstanceBatchCullRequest( camera, lodCamera,
                                                      (vp->getVisibilityMask() & getVisibilityMask()) |
@@ -1261,6 +1263,9 @@ void SceneManager::_renderPhase02(Camera* camera, const Camera *lodCamera, Viewp
                                                        ~VisibilityFlags::RESERVED_VISIBILITY_FLAGS) ) );
             }
 
+            if( unifiedInstancing )
+                updateInstanceStreams();
+
             //mVisibleObjects should be filled in phase 01
             VisibleObjectsPerThreadArray::const_iterator it = mVisibleObjects.begin();
             VisibleObjectsPerThreadArray::const_iterator en = mVisibleObjects.end();
@@ -1286,8 +1291,19 @@ void SceneManager::_renderPhase02(Camera* camera, const Camera *lodCamera, Viewp
         {
             _queueSkiesForRendering(camera);
         }
+
+        {
+            //Sort now while the worker threads are idle. Sorting again when
+            //rendering each group is a no-op unless something else gets queued.
+            OgreProfileGroup("sortRenderQueue", OGREPROF_GENERAL);
+            getRenderQueue()->sort( camera, this );
+        }
     } // end lock on scene graph mutex
 
+    //The render queue is built, we no longer need mVisibleObjects. Cull
+    //the next pass in the worker threads while we submit this one.
+    startCullPrefetch();
+
     mDestRenderSystem->_beginGeometryCount();
 
     // Set rasterisation mode
@@ -2045,31 +2061,37 @@ void SceneManager::updateAnimationTransforms( BySkeletonDef &bySkeletonDef, size
 //-----------------------------------------------------------------------
 void SceneManager::updateAllAnimations()
 {
-    mRequestType = UPDATE_ALL_ANIMATIONS;
-    mWorkerThreadsBarrier->sync(); //Fire threads
-    mWorkerThreadsBarrier->sync(); //Wait them to complete
-}
-//-----------------------------------------------------------------------
-void SceneManager::updateAllTransformsThread( const UpdateTransformRequest &request, size_t threadIdx )
-{
-    Transform t( request.t );
-    const size_t toAdvance = std::min( threadIdx * request.numNodesPerThread,
-                                        request.numTotalNodes );
+    //Select the animation LODs, SkeletonAnimManager splits the skeletons in
+    //mNumWorkerThreads shares of similar work based on them
+    SkeletonAnimManagerVec::const_iterator it = mSkeletonAnimManagerCulledList.begin();
+    SkeletonAnimManagerVec::const_iterator en = mSkeletonAnimManagerCulledList.end();
 
-    //Prevent going out of bounds (usually in the last threadIdx, or
-    //when there are less nodes than ARRAY_PACKED_REALS
-    const size_t numNodes = std::min( request.numNodesPerThread, request.numTotalNodes - toAdvance );
-    t.advancePack( toAdvance / ARRAY_PACKED_REALS );
+    while( it != en )
+    {
+        (*it)->_updateLods();
+        ++it;
+    }
+
+    addSceneTask( UPDATE_ALL_ANIMATIONS, 0, mNumWorkerThreads );
+    fireWorkerThreads();
+    waitForWorkerThreads();
 
-    Node::updateAllTransforms( numNodes, t );
+    it = mSkeletonAnimManagerCulledList.begin();
+    while( it != en )
+    {
+        (*it)->_notifyBonePaletteBuffers();
+        ++it;
+    }
 }
 //-----------------------------------------------------------------------
 void SceneManager::updateAllTransforms()
 {
-    mRequestType = UPDATE_ALL_TRANSFORMS;
     NodeMemoryManagerVec::const_iterator it = mNodeMemoryManagerUpdateList.begin();
     NodeMemoryManagerVec::const_iterator en = mNodeMemoryManagerUpdateList.end();
 
+    WorkStealingScheduler::TaskId prevLevelTask = 0;
+    bool hasPrevLevel = false;
+
     while( it != en )
     {
         NodeMemoryManager *nodeMemoryManager = *it;
@@ -2084,22 +2106,36 @@ void SceneManager::updateAllTransforms()
             Transform t;
             const size_t numNodes = nodeMemoryManager->getFirstNode( t, i );
 
-            //nodesPerThread must be multiple of ARRAY_PACKED_REALS
-            size_t nodesPerThread = ( numNodes + (mNumWorkerThreads-1) ) / mNumWorkerThreads;
-            nodesPerThread        = ( (nodesPerThread + ARRAY_PACKED_REALS - 1) / ARRAY_PACKED_REALS ) *
-                                    ARRAY_PACKED_REALS;
+            const size_t nodesPerChunk  = calculateChunkSize( numNodes, mNumWorkerThreads );
+            const size_t firstChunk     = mTransformChunks.size();
+            for( size_t j=0; j<numNodes; j += nodesPerChunk )
+            {
+                mTransformChunks.push_back( TransformChunk( t, std::min( nodesPerChunk,
+                                                                         numNodes - j ) ) );
+                t.advancePack( nodesPerChunk / ARRAY_PACKED_REALS );
+            }
+
+            //We need to go depth by depth because we may depend on parents which could be
+            //processed by different threads (dark_sylinc). The dependency lets the threads
+            //move on to the next level as soon as it's ready, without syncing all of them.
+            WorkStealingScheduler::TaskId levelTask = addSceneTask( UPDATE_ALL_TRANSFORMS, firstChunk,
+                                                                    mTransformChunks.size() - firstChunk );
+            if( hasPrevLevel )
+                mTaskScheduler->addDependency( levelTask, prevLevelTask );
 
-            //Send them to worker threads (dark_sylinc). We need to go depth by depth because
-            //we may depend on parents which could be processed by different threads.
-            mUpdateTransformRequest = UpdateTransformRequest( t, nodesPerThread, numNodes );
-            mWorkerThreadsBarrier->sync(); //Fire threads
-            mWorkerThreadsBarrier->sync(); //Wait them to complete
-            //Node::updateAllTransforms( numNodes, t );
+            prevLevelTask = levelTask;
+            hasPrevLevel  = true;
         }
 
         ++it;
     }
 
+    if( !mTaskScheduler->empty() )
+    {
+        fireWorkerThreads();
+        waitForWorkerThreads();
+    }
+
     //Call all listeners
     SceneNodeList::const_iterator itor = mSceneNodesWithListeners.begin();
     SceneNodeList::const_iterator end  = mSceneNodesWithListeners.end();
@@ -2111,101 +2147,30 @@ void SceneManager::updateAllTransforms()
     }
 }
 //-----------------------------------------------------------------------
-void SceneManager::updateAllBoundsThread( const ObjectMemoryManagerVec &objectMemManager, size_t threadIdx )
-{
-    ObjectMemoryManagerVec::const_iterator it = objectMemManager.begin();
-    ObjectMemoryManagerVec::const_iterator en = objectMemManager.end();
-
-    while( it != en )
-    {
-        ObjectMemoryManager *memoryManager = *it;
-        const size_t numRenderQueues = memoryManager->getNumRenderQueues();
-
-        for( size_t i=0; i<numRenderQueues; ++i )
-        {
-            ObjectData objData;
-            const size_t totalObjs = memoryManager->getFirstObjectData( objData, i );
-
-            //Distribute the work evenly across all threads (not perfect), taking into
-            //account we need to distribute in multiples of ARRAY_PACKED_REALS
-            size_t numObjs  = ( totalObjs + (mNumWorkerThreads-1) ) / mNumWorkerThreads;
-            numObjs         = ( (numObjs + ARRAY_PACKED_REALS - 1) / ARRAY_PACKED_REALS ) *
-                                ARRAY_PACKED_REALS;
-
-            const size_t toAdvance = std::min( threadIdx * numObjs, totalObjs );
-
-            //Prevent going out of bounds (usually in the last threadIdx, or
-            //when there are less entities than ARRAY_PACKED_REALS
-            numObjs = std::min( numObjs, totalObjs - toAdvance );
-            objData.advancePack( toAdvance / ARRAY_PACKED_REALS );
-
-            MovableObject::updateAllBounds( numObjs, objData );
-        }
-
-        ++it;
-    }
-}
-//-----------------------------------------------------------------------
 void SceneManager::updateAllBounds( const ObjectMemoryManagerVec &objectMemManager )
 {
-    mUpdateBoundsRequest    = &objectMemManager;
-    mRequestType            = UPDATE_ALL_BOUNDS;
-    mWorkerThreadsBarrier->sync(); //Fire threads
-    mWorkerThreadsBarrier->sync(); //Wait them to complete
-}
-//-----------------------------------------------------------------------
-void SceneManager::updateAllLodsThread( const UpdateLodRequest &request, size_t threadIdx )
-{
-    LodStrategy *lodStrategy = LodStrategyManager::getSingleton().getDefaultStrategy();
-
-    const Camera *lodCamera = request.lodCamera;
-    ObjectMemoryManagerVec::const_iterator it = request.objectMemManager->begin();
-    ObjectMemoryManagerVec::const_iterator en = request.objectMemManager->end();
-
-    while( it != en )
-    {
-        ObjectMemoryManager *memoryManager = *it;
-        const size_t numRenderQueues = memoryManager->getNumRenderQueues();
-
-        size_t firstRq = std::min<size_t>( request.firstRq, numRenderQueues );
-        size_t lastRq  = std::min<size_t>( request.lastRq,  numRenderQueues );
-
-        for( size_t i=firstRq; i<lastRq; ++i )
-        {
-            ObjectData objData;
-            const size_t totalObjs = memoryManager->getFirstObjectData( objData, i );
-
-            //Distribute the work evenly across all threads (not perfect), taking into
-            //account we need to distribute in multiples of ARRAY_PACKED_REALS
-            size_t numObjs  = ( totalObjs + (mNumWorkerThreads-1) ) / mNumWorkerThreads;
-            numObjs         = ( (numObjs + ARRAY_PACKED_REALS - 1) / ARRAY_PACKED_REALS ) *
-                                ARRAY_PACKED_REALS;
-
-            const size_t toAdvance = std::min( threadIdx * numObjs, totalObjs );
-
-            //Prevent going out of bounds (usually in the last threadIdx, or
-            //when there are less entities than ARRAY_PACKED_REALS
-            numObjs = std::min( numObjs, totalObjs - toAdvance );
-            objData.advancePack( toAdvance / ARRAY_PACKED_REALS );
-
-            lodStrategy->lodUpdateImpl( numObjs, objData, lodCamera, request.lodBias );
-        }
-
-        ++it;
-    }
+    const size_t numChunks = addObjectDataChunks( objectMemManager, 0,
+                                                  std::numeric_limits<size_t>::max() );
+    addSceneTask( UPDATE_ALL_BOUNDS, 0, numChunks );
+    fireWorkerThreads();
+    waitForWorkerThreads();
 }
 //-----------------------------------------------------------------------
 void SceneManager::updateAllLods( const Camera *lodCamera, Real lodBias, uint8 firstRq, uint8 lastRq )
 {
-    mRequestType        = UPDATE_ALL_LODS;
+    syncCullPrefetch();
+
     mUpdateLodRequest   = UpdateLodRequest( firstRq, lastRq, &mEntitiesMemoryManagerCulledList,
                                              lodCamera, lodCamera, lodBias );
 
     mUpdateLodRequest.camera->getFrustumPlanes();
     mUpdateLodRequest.lodCamera->getFrustumPlanes();
 
-    mWorkerThreadsBarrier->sync(); //Fire threads
-    mWorkerThreadsBarrier->sync(); //Wait them to complete
+    const size_t numChunks = addObjectDataChunks( *mUpdateLodRequest.objectMemManager,
+                                                  firstRq, lastRq );
+    addSceneTask( UPDATE_ALL_LODS, 0, numChunks );
+    fireWorkerThreads();
+    waitForWorkerThreads();
 }
 //-----------------------------------------------------------------------
 void SceneManager::instanceBatchCullFrustumThread( const InstanceBatchCullRequest &request,
@@ -2217,56 +2182,21 @@ void SceneManager::instanceBatchCullFrustumThread( const InstanceBatchCullReques
     while( itor != end )
     {
         (*itor)->instanceBatchCullFrustumThreaded( request.frustum, request.lodCamera,
-                                                   request.combinedVisibilityFlags );
+                                                   request.combinedVisibilityFlags, threadIdx );
         ++itor;
     }
 }
 //-----------------------------------------------------------------------
-void SceneManager::cullFrustum( const CullFrustumRequest &request, size_t threadIdx )
+void SceneManager::cullFrustum( const CullFrustumRequest &request, const ObjectDataChunk &chunk,
+                                size_t threadIdx )
 {
     MovableObject::MovableObjectArray &outVisibleObjects = *(mVisibleObjects.begin() + threadIdx);
-    outVisibleObjects.clear();
 
     const Camera *camera    = request.camera;
     const Camera *lodCamera = request.lodCamera;
-    ObjectMemoryManagerVec::const_iterator it = request.objectMemManager->begin();
-    ObjectMemoryManagerVec::const_iterator en = request.objectMemManager->end();
 
-    while( it != en )
-    {
-        ObjectMemoryManager *memoryManager = *it;
-        const size_t numRenderQueues = memoryManager->getNumRenderQueues();
-
-        size_t firstRq = std::min<size_t>( request.firstRq, numRenderQueues );
-        size_t lastRq  = std::min<size_t>( request.lastRq,  numRenderQueues );
-
-        for( size_t i=firstRq; i<lastRq; ++i )
-        {
-            ObjectData objData;
-            const size_t totalObjs = memoryManager->getFirstObjectData( objData, i );
-
-            //Distribute the work evenly across all threads (not perfect), taking into
-            //account we need to distribute in multiples of ARRAY_PACKED_REALS
-            size_t numObjs  = ( totalObjs + (mNumWorkerThreads-1) ) / mNumWorkerThreads;
-            numObjs         = ( (numObjs + ARRAY_PACKED_REALS - 1) / ARRAY_PACKED_REALS ) *
-                                ARRAY_PACKED_REALS;
-
-            const size_t toAdvance = std::min( threadIdx * numObjs, totalObjs );
-
-            //Prevent going out of bounds (usually in the last threadIdx, or
-            //when there are less entities than ARRAY_PACKED_REALS
-            numObjs = std::min( numObjs, totalObjs - toAdvance );
-            objData.advancePack( toAdvance / ARRAY_PACKED_REALS );
-
-            MovableObject::cullFrustum( numObjs, objData, camera,
-                    (camera->getLastViewport()->getVisibilityMask() & getVisibilityMask()) |
-                    (camera->getLastViewport()->getVisibilityMask() &
-                                        ~VisibilityFlags::RESERVED_VISIBILITY_FLAGS),
-                    outVisibleObjects, lodCamera );
-        }
-
-        ++it;
-    }
+    MovableObject::cullFrustum( chunk.numObjs, chunk.objData, camera, request.visibilityMask,
+                                outVisibleObjects, lodCamera );
 }
 //-----------------------------------------------------------------------
 void SceneManager::buildLightList()
@@ -2312,7 +2242,6 @@ void SceneManager::buildLightList()
         }
     }
 
-    mRequestType = BUILD_LIGHT_LIST01;
     {
         //This is where I figuratively kill whoever made mutable variables inside a
         //const function, silencing a race condition: Update the frustum planes now
@@ -2335,8 +2264,12 @@ void SceneManager::buildLightList()
             ++itor;
         }
     }
-    mWorkerThreadsBarrier->sync(); //Fire threads
-    mWorkerThreadsBarrier->sync(); //Wait them to complete
+
+    //Each share writes to its own range of mGlobalLightList (startLightIdx), so this
+    //phase keeps the static split. Stealing still balances the shares across threads.
+    addSceneTask( BUILD_LIGHT_LIST01, 0, mNumWorkerThreads );
+    fireWorkerThreads();
+    waitForWorkerThreads();
 
     //Now merge the results into a single list.
 
@@ -2364,9 +2297,11 @@ void SceneManager::buildLightList()
     }
 
     //Now fire the threads again, to build the per-MovableObject lists
-    mRequestType = BUILD_LIGHT_LIST02;
-    mWorkerThreadsBarrier->sync(); //Fire threads
-    mWorkerThreadsBarrier->sync(); //Wait them to complete
+    const size_t numChunks = addObjectDataChunks( mEntitiesMemoryManagerCulledList, 0,
+                                                  std::numeric_limits<size_t>::max() );
+    addSceneTask( BUILD_LIGHT_LIST02, 0, numChunks );
+    fireWorkerThreads();
+    waitForWorkerThreads();
 }
 //-----------------------------------------------------------------------
 void SceneManager::buildLightListThread01( const BuildLightListRequest &buildLightListRequest,
@@ -2421,41 +2356,6 @@ void SceneManager::buildLightListThread01( const BuildLightListRequest &buildLig
     threadLocalLightList.boundingSphere = 0;
 }
 //-----------------------------------------------------------------------
-void SceneManager::buildLightListThread02( size_t threadIdx )
-{
-    //Global light list built. Now build a per-movable object light list
-    ObjectMemoryManagerVec::const_iterator it = mEntitiesMemoryManagerCulledList.begin();
-    ObjectMemoryManagerVec::const_iterator en = mEntitiesMemoryManagerCulledList.end();
-    while( it != en )
-    {
-        ObjectMemoryManager *objMemoryManager = *it;
-        const size_t numRenderQueues = objMemoryManager->getNumRenderQueues();
-
-        for( size_t i=0; i<numRenderQueues; ++i )
-        {
-            ObjectData objData;
-            const size_t totalObjs = objMemoryManager->getFirstObjectData( objData, i );
-
-            //Distribute the work evenly across all threads (not perfect), taking into
-            //account we need to distribute in multiples of ARRAY_PACKED_REALS
-            size_t numObjs  = ( totalObjs + (mNumWorkerThreads-1) ) / mNumWorkerThreads;
-            numObjs         = ( (numObjs + ARRAY_PACKED_REALS - 1) / ARRAY_PACKED_REALS ) *
-                                ARRAY_PACKED_REALS;
-
-            const size_t toAdvance = std::min( threadIdx * numObjs, totalObjs );
-
-            //Prevent going out of bounds (usually in the last threadIdx, or
-            //when there are less entities than ARRAY_PACKED_REALS
-            numObjs = std::min( numObjs, totalObjs - toAdvance );
-            objData.advancePack( toAdvance / ARRAY_PACKED_REALS );
-
-            MovableObject::buildLightList( numObjs, objData, mGlobalLightList );
-        }
-
-        ++it;
-    }
-}
-//-----------------------------------------------------------------------
 void SceneManager::highLevelCull()
 {
     mNodeMemoryManagerUpdateList.clear();
@@ -2505,6 +2405,17 @@ void SceneManager::updateSceneGraph()
     // Update controllers 
     ControllerManager::getSingleton().updateAllControllers();
 
+    if( mMaxMemoryMovesPerFrame )
+    {
+        size_t movesLeft = mMaxMemoryMovesPerFrame;
+        for( size_t i=0; i<NUM_SCENE_MEMORY_MANAGER_TYPES && movesLeft; ++i )
+        {
+            movesLeft -= mNodeMemoryManager[i].defragment( movesLeft );
+            movesLeft -= mEntityMemoryManager[i].defragment( movesLeft );
+        }
+        mLightMemoryManager.defragment( movesLeft );
+    }
+
     highLevelCull();
     _applySceneAnimations();
     updateAllTransforms();
@@ -2516,6 +2427,12 @@ void SceneManager::updateSceneGraph()
     updateAllBounds( mEntitiesMemoryManagerUpdateList );
     updateAllBounds( mLightsMemoryManagerCulledList );
 
+    if( mStaticBvhCulling && (mStaticEntitiesDirty ||
+                              !mStaticBvh.isUpToDate( mEntityMemoryManager[SCENE_STATIC] )) )
+    {
+        mStaticBvh.build( mEntityMemoryManager[SCENE_STATIC] );
+    }
+
     {
         // Auto-track nodes
         AutoTrackingSceneNodeVec::const_iterator itor = mAutoTrackingSceneNodes.begin();
@@ -2808,7 +2725,23 @@ void SceneManager::renderObjects(const QueuedRenderableCollection& objs,
     mActiveQueuedRenderableVisitor->transparentShadowCastersMode = false;
     mActiveQueuedRenderableVisitor->scissoring = lightScissoringClipping;
     // Use visitor
-    objs.acceptVisitor(mActiveQueuedRenderableVisitor, om);
+    visitQueuedRenderables(objs, om);
+}
+//-----------------------------------------------------------------------
+void SceneManager::visitQueuedRenderables( const QueuedRenderableCollection &objs,
+                                           QueuedRenderableCollection::OrganisationMode om )
+{
+    if( mUseRenderCommandBuffer )
+    {
+        //Don't stall the prefetched culling waiting for it to finish; record from this thread.
+        SceneManager *sceneManager = mCullPrefetchState != CULL_PREFETCH_RUNNING ? this : 0;
+        mRenderCommandBuffer.record( objs, om, sceneManager );
+        mRenderCommandBuffer.replay( mActiveQueuedRenderableVisitor );
+    }
+    else
+    {
+        objs.acceptVisitor( mActiveQueuedRenderableVisitor, om );
+    }
 }
 //-----------------------------------------------------------------------
 void SceneManager::_renderQueueGroupObjects(RenderQueueGroup* pGroup, 
@@ -2866,8 +2799,7 @@ void SceneManager::renderTransparentShadowCasterObjects(
     mActiveQueuedRenderableVisitor->scissoring = lightScissoringClipping;
     
     // Sort descending (transparency)
-    objs.acceptVisitor(mActiveQueuedRenderableVisitor, 
-        QueuedRenderableCollection::OM_SORT_DESCENDING);
+    visitQueuedRenderables(objs, QueuedRenderableCollection::OM_SORT_DESCENDING);
 
     mActiveQueuedRenderableVisitor->transparentShadowCastersMode = false;
 }
@@ -4791,9 +4723,10 @@ void SceneManager::updateInstanceManagersThread( size_t threadIdx )
 void SceneManager::updateInstanceManagers(void)
 {
     // First update the individual instances from multiple threads
-    mRequestType = UPDATE_INSTANCE_MANAGERS;
-    mWorkerThreadsBarrier->sync(); //Fire threads
-    mWorkerThreadsBarrier->sync(); //Wait them to complete
+    // (each InstanceBatch splits its objects in mNumWorkerThreads shares)
+    addSceneTask( UPDATE_INSTANCE_MANAGERS, 0, mNumWorkerThreads );
+    fireWorkerThreads();
+    waitForWorkerThreads();
 
     // Now perform the final pass from a single thread
     InstanceManagerVec::const_iterator itor = mInstanceManagers.begin();
@@ -4806,6 +4739,33 @@ void SceneManager::updateInstanceManagers(void)
     }
 }
 //---------------------------------------------------------------------
+bool SceneManager::hasUnifiedInstanceManagers(void) const
+{
+    InstanceManagerVec::const_iterator itor = mInstanceManagers.begin();
+    InstanceManagerVec::const_iterator end  = mInstanceManagers.end();
+
+    while( itor != end )
+    {
+        if( (*itor)->getInstancingTechnique() == InstanceManager::HWInstancingUnified )
+            return true;
+        ++itor;
+    }
+
+    return false;
+}
+//---------------------------------------------------------------------
+void SceneManager::updateInstanceStreams(void)
+{
+    InstanceManagerVec::const_iterator itor = mInstanceManagers.begin();
+    InstanceManagerVec::const_iterator end  = mInstanceManagers.end();
+
+    while( itor != end )
+    {
+        (*itor)->_updateInstanceStreams();
+        ++itor;
+    }
+}
+//---------------------------------------------------------------------
 AxisAlignedBoxSceneQuery* 
 SceneManager::createAABBQuery(const AxisAlignedBox& box, uint32 mask)
 {
@@ -5390,42 +5350,394 @@ void SceneManager::updateGpuProgramParameters(const Pass* pass)
 }
 //---------------------------------------------------------------------
 //---------------------------------------------------------------------
-void SceneManager::fireCullFrustumThreads( const CullFrustumRequest &request )
+void SceneManager::fireCullFrustumThreads( const CullFrustumRequest &request, bool bBlock )
 {
+    syncCullPrefetch();
+
     mCurrentCullFrustumRequest = request;
-    mRequestType = CULL_FRUSTUM;
     //This is where I figuratively kill whoever made mutable variables inside a
     //const function, silencing a race condition: Update the frustum planes now
     //in case they weren't up to date.
     mCurrentCullFrustumRequest.camera->getFrustumPlanes();
     mCurrentCullFrustumRequest.lodCamera->getFrustumPlanes();
-    mWorkerThreadsBarrier->sync(); //Fire threads
-    mWorkerThreadsBarrier->sync(); //Wait them to complete
+
+    //Any thread may process any chunk, thus they append to their
+    //list instead of clearing it. Clear them all beforehand.
+    VisibleObjectsPerThreadArray::iterator itor = mVisibleObjects.begin();
+    VisibleObjectsPerThreadArray::iterator end  = mVisibleObjects.end();
+    while( itor != end )
+    {
+        itor->clear();
+        ++itor;
+    }
+
+    const size_t numChunks = addCullFrustumChunks( mCurrentCullFrustumRequest );
+    addSceneTask( CULL_FRUSTUM, 0, numChunks );
+    fireWorkerThreads();
+    if( bBlock )
+        waitForWorkerThreads();
 }
 //---------------------------------------------------------------------
 void SceneManager::fireCullFrustumInstanceBatchThreads( const InstanceBatchCullRequest &request )
 {
+    syncCullPrefetch();
+
     mInstanceBatchCullRequest = request;
-    mRequestType = CULL_FRUSTUM_INSTANCEDENTS;
     mInstanceBatchCullRequest.frustum->getFrustumPlanes(); // Ensure they're up to date.
     mInstanceBatchCullRequest.lodCamera->getFrustumPlanes(); // Ensure they're up to date.
-    mWorkerThreadsBarrier->sync(); //Fire threads
-    mWorkerThreadsBarrier->sync(); //Wait them to complete
+    addSceneTask( CULL_FRUSTUM_INSTANCEDENTS, 0, mNumWorkerThreads );
+    fireWorkerThreads();
+    waitForWorkerThreads();
 }
 //---------------------------------------------------------------------
 void SceneManager::executeUserScalableTask( UniformScalableTask *task, bool bBlock )
 {
-    mRequestType = USER_UNIFORM_SCALABLE_TASK;
+    syncCullPrefetch();
+
     mUserTask = task;
-    mWorkerThreadsBarrier->sync(); //Fire threads
+    addSceneTask( USER_UNIFORM_SCALABLE_TASK, 0, mNumWorkerThreads );
+    fireWorkerThreads();
     if( bBlock )
-        mWorkerThreadsBarrier->sync(); //Wait them to complete
+        waitForWorkerThreads();
 }
 //---------------------------------------------------------------------
 void SceneManager::waitForPendingUserScalableTask()
 {
-    assert( mRequestType == USER_UNIFORM_SCALABLE_TASK );
+    assert( !mSceneTasks.empty() && mSceneTasks.back().requestType == USER_UNIFORM_SCALABLE_TASK );
+    waitForWorkerThreads();
+}
+//---------------------------------------------------------------------
+CullFrustumRequest SceneManager::createCullFrustumRequest( const Camera *camera,
+                                                           const Camera *lodCamera,
+                                                           uint32 viewportVisibilityMask,
+                                                           uint8 firstRq, uint8 lastRq ) const
+{
+    // Quick way of reducing overhead/stress on VisibleObjectsBoundsInfo
+    // calculation (lastRq can be up to 255)
+    uint8 realFirstRq= firstRq;
+    uint8 realLastRq = 0;
+    {
+        ObjectMemoryManagerVec::const_iterator itor = mEntitiesMemoryManagerCulledList.begin();
+        ObjectMemoryManagerVec::const_iterator end  = mEntitiesMemoryManagerCulledList.end();
+        while( itor != end )
+        {
+            realFirstRq = std::min<uint8>( realFirstRq, (*itor)->_getTotalRenderQueues() );
+            realLastRq  = std::max<uint8>( realLastRq, (*itor)->_getTotalRenderQueues() );
+            ++itor;
+        }
+
+        //clamp RQ values to the real RQ range
+        realFirstRq = std::min(realLastRq, std::max(realFirstRq, firstRq));
+        realLastRq = std::min(realLastRq, std::max(realFirstRq, lastRq));
+    }
+
+    //Always preserve the settings of the reserved visibility flags in the viewport.
+    const uint32 visibilityMask = (viewportVisibilityMask & getVisibilityMask()) |
+                                  (viewportVisibilityMask & ~VisibilityFlags::RESERVED_VISIBILITY_FLAGS);
+
+    return CullFrustumRequest( realFirstRq, realLastRq, &mEntitiesMemoryManagerCulledList,
+                               camera, lodCamera, visibilityMask );
+}
+//---------------------------------------------------------------------
+void SceneManager::syncCullPrefetch(void)
+{
+    if( mCullPrefetchState == CULL_PREFETCH_RUNNING )
+    {
+        waitForWorkerThreads();
+        mCullPrefetchState = CULL_PREFETCH_DONE;
+    }
+}
+//---------------------------------------------------------------------
+void SceneManager::_scheduleCullPrefetch( const Camera *camera, const Camera *lodCamera,
+                                          uint32 viewportVisibilityMask, uint8 firstRq, uint8 lastRq )
+{
+    if( !mCullPrefetch || !mFindVisibleObjects || mEntitiesMemoryManagerCulledList.empty() )
+        return;
+
+    syncCullPrefetch();
+    mScheduledCullRequest = createCullFrustumRequest( camera, lodCamera, viewportVisibilityMask,
+                                                      firstRq, lastRq );
+    mCullPrefetchState = CULL_PREFETCH_SCHEDULED;
+}
+//---------------------------------------------------------------------
+void SceneManager::startCullPrefetch(void)
+{
+    if( mCullPrefetchState == CULL_PREFETCH_SCHEDULED )
+    {
+        const Plane *frustumPlanes = mScheduledCullRequest.camera->getFrustumPlanes();
+        for( size_t i=0; i<6; ++i )
+            mCullPrefetchPlanes[i] = frustumPlanes[i];
+        mScheduledCullRequest.lodCamera->getFrustumPlanes();
+        mCullPrefetchLodCameraPos = mScheduledCullRequest.lodCamera->_getCachedDerivedPosition();
+
+        fireCullFrustumThreads( mScheduledCullRequest, false );
+        mCullPrefetchState = CULL_PREFETCH_RUNNING;
+    }
+}
+//---------------------------------------------------------------------
+void SceneManager::cullVisibleObjects( Camera *camera, const Camera *lodCamera,
+                                       uint32 viewportVisibilityMask, uint8 firstRq, uint8 lastRq )
+{
+    //Wait for the culling started by the previous pass, if any. @See setCullPrefetch
+    syncCullPrefetch();
+    const bool prefetched = mCullPrefetchState == CULL_PREFETCH_DONE;
+    mCullPrefetchState = CULL_PREFETCH_NONE;
+
+    if( mFindVisibleObjects )
+    {
+        OgreProfileGroup("cullFrustum", OGREPROF_CULLING);
+
+        assert( !mEntitiesMemoryManagerCulledList.empty() );
+
+        CullFrustumRequest cullRequest = createCullFrustumRequest( camera, lodCamera,
+                                                                   viewportVisibilityMask,
+                                                                   firstRq, lastRq );
+        camera->_setRenderedRqs( cullRequest.firstRq, cullRequest.lastRq );
+
+        bool reusePrefetch = prefetched &&
+                mCurrentCullFrustumRequest.firstRq == cullRequest.firstRq &&
+                mCurrentCullFrustumRequest.lastRq == cullRequest.lastRq &&
+                mCurrentCullFrustumRequest.objectMemManager == cullRequest.objectMemManager &&
+                mCurrentCullFrustumRequest.camera == cullRequest.camera &&
+                mCurrentCullFrustumRequest.lodCamera == cullRequest.lodCamera &&
+                mCurrentCullFrustumRequest.visibilityMask == cullRequest.visibilityMask;
+
+        if( reusePrefetch )
+        {
+            //Someone (i.e. a listener) may've moved the camera after we started culling
+            const Plane *frustumPlanes = camera->getFrustumPlanes();
+            lodCamera->getFrustumPlanes();
+            for( size_t i=0; i<6; ++i )
+                reusePrefetch &= frustumPlanes[i] == mCullPrefetchPlanes[i];
+            reusePrefetch &= lodCamera->_getCachedDerivedPosition() == mCullPrefetchLodCameraPos;
+        }
+
+        if( !reusePrefetch )
+            fireCullFrustumThreads( cullRequest, true );
+    }
+}
+//---------------------------------------------------------------------
+size_t SceneManager::addObjectDataChunks( const ObjectMemoryManagerVec &objectMemManager,
+                                          size_t firstRq, size_t lastRq )
+{
+    size_t numChunks = 0;
+
+    ObjectMemoryManagerVec::const_iterator it = objectMemManager.begin();
+    ObjectMemoryManagerVec::const_iterator en = objectMemManager.end();
+
+    while( it != en )
+        numChunks += addObjectDataChunks( *it++, firstRq, lastRq );
+
+    return numChunks;
+}
+//---------------------------------------------------------------------
+size_t SceneManager::addObjectDataChunks( ObjectMemoryManager *memoryManager,
+                                          size_t firstRq, size_t lastRq )
+{
+    const size_t oldNumChunks = mObjectDataChunks.size();
+
+    const size_t numRenderQueues = memoryManager->getNumRenderQueues();
+
+    const size_t realFirstRq = std::min( firstRq, numRenderQueues );
+    const size_t realLastRq  = std::min( lastRq,  numRenderQueues );
+
+    for( size_t i=realFirstRq; i<realLastRq; ++i )
+    {
+        ObjectData objData;
+        const size_t totalObjs = memoryManager->getFirstObjectData( objData, i );
+
+        const size_t objsPerChunk = calculateChunkSize( totalObjs, mNumWorkerThreads );
+        for( size_t j=0; j<totalObjs; j += objsPerChunk )
+        {
+            mObjectDataChunks.push_back( ObjectDataChunk( objData, std::min( objsPerChunk,
+                                                                             totalObjs - j ) ) );
+            objData.advancePack( objsPerChunk / ARRAY_PACKED_REALS );
+        }
+    }
+
+    return mObjectDataChunks.size() - oldNumChunks;
+}
+//---------------------------------------------------------------------
+size_t SceneManager::addCullFrustumChunks( const CullFrustumRequest &request )
+{
+    ObjectMemoryManager *staticMemoryManager = &mEntityMemoryManager[SCENE_STATIC];
+
+    //The tree may be stale if static objects were created or destroyed after
+    //updateSceneGraph. It will be rebuilt next frame; cull everything until then.
+    const bool useBvh = mStaticBvhCulling && mStaticBvh.isUpToDate( *staticMemoryManager );
+
+    if( !useBvh )
+        return addObjectDataChunks( *request.objectMemManager, request.firstRq, request.lastRq );
+
+    size_t numChunks = 0;
+
+    ObjectMemoryManagerVec::const_iterator it = request.objectMemManager->begin();
+    ObjectMemoryManagerVec::const_iterator en = request.objectMemManager->end();
+
+    while( it != en )
+    {
+        ObjectMemoryManager *memoryManager = *it++;
+
+        if( memoryManager != staticMemoryManager )
+        {
+            numChunks += addObjectDataChunks( memoryManager, request.firstRq, request.lastRq );
+            continue;
+        }
+
+        const Plane *frustumPlanes = request.camera->_getCachedFrustumPlanes();
+
+        const size_t numRenderQueues = memoryManager->getNumRenderQueues();
+        const size_t realFirstRq = std::min<size_t>( request.firstRq, numRenderQueues );
+        const size_t realLastRq  = std::min<size_t>( request.lastRq,  numRenderQueues );
+
+        for( size_t i=realFirstRq; i<realLastRq; ++i )
+        {
+            mTmpStaticPackRanges.clear();
+            mStaticBvh.cullFrustum( i, frustumPlanes, mTmpStaticPackRanges );
+
+            if( mTmpStaticPackRanges.empty() )
+                continue;
+
+            ObjectData firstObjData;
+            const size_t totalObjs = memoryManager->getFirstObjectData( firstObjData, i );
+
+            //Chunk sizes are based on what survived the tree, not on the whole render queue
+            size_t numVisiblePacks = 0;
+            ObjectDataBvh::PackRangeVec::const_iterator itRange = mTmpStaticPackRanges.begin();
+            ObjectDataBvh::PackRangeVec::const_iterator enRange = mTmpStaticPackRanges.end();
+            while( itRange != enRange )
+                numVisiblePacks += (itRange++)->numPacks;
+
+            const size_t objsPerChunk = calculateChunkSize( numVisiblePacks * ARRAY_PACKED_REALS,
+                                                            mNumWorkerThreads );
+
+            itRange = mTmpStaticPackRanges.begin();
+            while( itRange != enRange )
+            {
+                const size_t rangeStart = itRange->firstPack * ARRAY_PACKED_REALS;
+                const size_t rangeEnd   = std::min( totalObjs, rangeStart +
+                                                    itRange->numPacks * ARRAY_PACKED_REALS );
+
+                ObjectData objData = firstObjData;
+                objData.advancePack( itRange->firstPack );
+
+                for( size_t j=rangeStart; j<rangeEnd; j += objsPerChunk )
+                {
+                    mObjectDataChunks.push_back( ObjectDataChunk( objData,
+                                                                  std::min( objsPerChunk,
+                                                                            rangeEnd - j ) ) );
+                    objData.advancePack( objsPerChunk / ARRAY_PACKED_REALS );
+                    ++numChunks;
+                }
+
+                ++itRange;
+            }
+        }
+    }
+
+    return numChunks;
+}
+//---------------------------------------------------------------------
+void SceneManager::setStaticBvhCulling( bool bEnabled )
+{
+    mStaticBvhCulling = bEnabled;
+    mStaticBvh.clear();
+}
+//---------------------------------------------------------------------
+void SceneManager::setIncrementalMemoryCleanup( size_t maxMovesPerFrame )
+{
+    mMaxMemoryMovesPerFrame = maxMovesPerFrame;
+
+    const bool bIncremental = maxMovesPerFrame != 0;
+    for( size_t i=0; i<NUM_SCENE_MEMORY_MANAGER_TYPES; ++i )
+    {
+        mNodeMemoryManager[i].setIncrementalCleanup( bIncremental );
+        mEntityMemoryManager[i].setIncrementalCleanup( bIncremental );
+    }
+    mLightMemoryManager.setIncrementalCleanup( bIncremental );
+}
+//---------------------------------------------------------------------
+WorkStealingScheduler::TaskId SceneManager::addSceneTask( RequestType requestType,
+                                                          size_t firstChunk, size_t numChunks )
+{
+    mSceneTasks.push_back( SceneTask( this, requestType, firstChunk ) );
+    return mTaskScheduler->addTask( &mSceneTasks.back(), numChunks );
+}
+//---------------------------------------------------------------------
+void SceneManager::fireWorkerThreads(void)
+{
+    assert( mCullPrefetchState != CULL_PREFETCH_RUNNING &&
+            "The previous graph is still running. Call syncCullPrefetch first" );
+    mTaskScheduler->_prepare();
+    mWorkerThreadsBarrier->sync(); //Fire threads
+}
+//---------------------------------------------------------------------
+void SceneManager::waitForWorkerThreads(void)
+{
     mWorkerThreadsBarrier->sync(); //Wait them to complete
+    mTaskScheduler->clear();
+    mSceneTasks.clear();
+    mTransformChunks.clear();
+    mObjectDataChunks.clear();
+}
+//---------------------------------------------------------------------
+void SceneManager::SceneTask::execute( size_t chunkIdx, size_t threadIdx )
+{
+    switch( requestType )
+    {
+    case CULL_FRUSTUM:
+        sceneManager->cullFrustum( sceneManager->mCurrentCullFrustumRequest,
+                                   sceneManager->mObjectDataChunks[firstChunk + chunkIdx],
+                                   threadIdx );
+        break;
+    case UPDATE_ALL_ANIMATIONS:
+        sceneManager->updateAllAnimationsThread( chunkIdx );
+        break;
+    case UPDATE_ALL_TRANSFORMS:
+        {
+            const TransformChunk &chunk = sceneManager->mTransformChunks[firstChunk + chunkIdx];
+            Node::updateAllTransforms( chunk.numNodes, chunk.t );
+        }
+        break;
+    case UPDATE_ALL_BOUNDS:
+        {
+            const ObjectDataChunk &chunk = sceneManager->mObjectDataChunks[firstChunk + chunkIdx];
+            MovableObject::updateAllBounds( chunk.numObjs, chunk.objData );
+        }
+        break;
+    case UPDATE_ALL_LODS:
+        {
+            const ObjectDataChunk &chunk = sceneManager->mObjectDataChunks[firstChunk + chunkIdx];
+            const UpdateLodRequest &request = sceneManager->mUpdateLodRequest;
+            LodStrategy *lodStrategy = LodStrategyManager::getSingleton().getDefaultStrategy();
+            lodStrategy->lodUpdateImpl( chunk.numObjs, chunk.objData,
+                                        request.lodCamera, request.lodBias );
+        }
+        break;
+    case UPDATE_INSTANCE_MANAGERS:
+        sceneManager->updateInstanceManagersThread( chunkIdx );
+        break;
+    case CULL_FRUSTUM_INSTANCEDENTS:
+        sceneManager->instanceBatchCullFrustumThread( sceneManager->mInstanceBatchCullRequest,
+                                                      chunkIdx );
+        break;
+    case BUILD_LIGHT_LIST01:
+        sceneManager->buildLightListThread01(
+                    sceneManager->mBuildLightListRequestPerThread[chunkIdx], chunkIdx );
+        break;
+    case BUILD_LIGHT_LIST02:
+        {
+            const ObjectDataChunk &chunk = sceneManager->mObjectDataChunks[firstChunk + chunkIdx];
+            MovableObject::buildLightList( chunk.numObjs, chunk.objData,
+                                           sceneManager->mGlobalLightList );
+        }
+        break;
+    case USER_UNIFORM_SCALABLE_TASK:
+        sceneManager->mUserTask->execute( chunkIdx, sceneManager->mNumWorkerThreads );
+        break;
+    default:
+        break;
+    }
 }
 //---------------------------------------------------------------------
 unsigned long updateWorkerThread( ThreadHandle *threadHandle )
@@ -5437,6 +5749,7 @@ THREAD_DECLARE( updateWorkerThread );
 //---------------------------------------------------------------------
 void SceneManager::startWorkerThreads()
 {
+    mTaskScheduler = new WorkStealingScheduler( mNumWorkerThreads );
     mWorkerThreadsBarrier = new Barrier( mNumWorkerThreads+1 );
     mWorkerThreads.reserve( mNumWorkerThreads );
     for( size_t i=0; i<mNumWorkerThreads; ++i )
@@ -5448,56 +5761,34 @@ void SceneManager::startWorkerThreads()
 //---------------------------------------------------------------------
 void SceneManager::stopWorkerThreads()
 {
+    syncCullPrefetch();
+    mCullPrefetchState = CULL_PREFETCH_NONE;
+
     mExitWorkerThreads = true;
     mWorkerThreadsBarrier->sync(); // Wake up worker threads so they stop
     Threads::WaitForThreads( mWorkerThreads );
 
     delete mWorkerThreadsBarrier;
     mWorkerThreadsBarrier = 0;
+
+    delete mTaskScheduler;
+    mTaskScheduler = 0;
 }
 //---------------------------------------------------------------------
 unsigned long SceneManager::_updateWorkerThread( ThreadHandle *threadHandle )
 {
     size_t threadIdx = threadHandle->getThreadIdx();
-    while( !mExitWorkerThreads )
+    while( true )
     {
+        //Always check the flag after the barrier. Checking it before could see it set by
+        //stopWorkerThreads and leave it waiting on a barrier we'll never reach.
+        mWorkerThreadsBarrier->sync();
+        if( mExitWorkerThreads )
+            break;
+
+        //Returns once all tasks (from all threads) are done
+        mTaskScheduler->_execute( threadIdx );
         mWorkerThreadsBarrier->sync();
-        if( !mExitWorkerThreads )
-        {
-            switch( mRequestType )
-            {
-            case CULL_FRUSTUM:
-                cullFrustum( mCurrentCullFrustumRequest, threadIdx );
-                break;
-            case UPDATE_ALL_ANIMATIONS:
-                updateAllAnimationsThread( threadIdx );
-                break;
-            case UPDATE_ALL_TRANSFORMS:
-                updateAllTransformsThread( mUpdateTransformRequest, threadIdx );
-                break;
-            case UPDATE_ALL_BOUNDS:
-                updateAllBoundsThread( *mUpdateBoundsRequest, threadIdx );
-                break;
-            case UPDATE_ALL_LODS:
-                updateAllLodsThread( mUpdateLodRequest, threadIdx );
-                break;
-            case UPDATE_INSTANCE_MANAGERS:
-                updateInstanceManagersThread( threadIdx );
-                break;
-            case BUILD_LIGHT_LIST01:
-                buildLightListThread01( mBuildLightListRequestPerThread[threadIdx], threadIdx );
-                break;
-            case BUILD_LIGHT_LIST02:
-                buildLightListThread02( threadIdx );
-                break;
-            case USER_UNIFORM_SCALABLE_TASK:
-                mUserTask->execute( threadIdx, mNumWorkerThreads );
-                break;
-            default:
-                break;
-            }
-            mWorkerThreadsBarrier->sync();
-        }
     }
 
     return 0;
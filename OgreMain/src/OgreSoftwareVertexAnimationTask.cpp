@@ -0,0 +1,196 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreSoftwareVertexAnimationTask.h"
+#include "OgreOptimisedUtil.h"
+#include "OgreSceneManager.h"
+
+namespace Ogre
+{
+    const size_t SoftwareVertexAnimationTask::PARALLEL_THRESHOLD = 2048;
+    const size_t SoftwareVertexAnimationTask::VERTEX_GRANULARITY = 8;
+    //-----------------------------------------------------------------------------------
+    SoftwareVertexAnimationTask::SoftwareVertexAnimationTask() :
+        mMode( MODE_SKINNING ),
+        mNumVertices( 0 ),
+        mSrcPos( 0 ),
+        mSrcPos2( 0 ),
+        mDestPos( 0 ),
+        mSrcNorm( 0 ),
+        mDestNorm( 0 ),
+        mBlendWeight( 0 ),
+        mBlendIndex( 0 ),
+        mBlendMatrices( 0 ),
+        mSrcPosStride( 0 ),
+        mDestPosStride( 0 ),
+        mSrcNormStride( 0 ),
+        mDestNormStride( 0 ),
+        mBlendWeightStride( 0 ),
+        mBlendIndexStride( 0 ),
+        mNumWeightsPerVertex( 0 ),
+        mMorphT( 0 ),
+        mMorphNormals( false )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    SoftwareVertexAnimationTask::~SoftwareVertexAnimationTask()
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    void SoftwareVertexAnimationTask::getThreadRange( size_t threadId, size_t numThreads,
+                                                      size_t &outStart, size_t &outEnd ) const
+    {
+        size_t verticesPerThread = (mNumVertices + numThreads - 1) / numThreads;
+        verticesPerThread = ( (verticesPerThread + VERTEX_GRANULARITY - 1) / VERTEX_GRANULARITY ) *
+                            VERTEX_GRANULARITY;
+        outStart = std::min( threadId * verticesPerThread, mNumVertices );
+        outEnd   = std::min( outStart + verticesPerThread, mNumVertices );
+    }
+    //-----------------------------------------------------------------------------------
+    void SoftwareVertexAnimationTask::dispatch( SceneManager *sceneManager )
+    {
+        if( mNumVertices < PARALLEL_THRESHOLD || !sceneManager ||
+            sceneManager->getNumWorkerThreads() <= 1 )
+        {
+            execute( 0, 1 );
+        }
+        else
+        {
+            sceneManager->executeUserScalableTask( this, true );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SoftwareVertexAnimationTask::softwareVertexSkinning(
+            const float *srcPosPtr, float *destPosPtr,
+            const float *srcNormPtr, float *destNormPtr,
+            const float *blendWeightPtr, const unsigned char* blendIndexPtr,
+            const Matrix4* const* blendMatrices,
+            size_t srcPosStride, size_t destPosStride,
+            size_t srcNormStride, size_t destNormStride,
+            size_t blendWeightStride, size_t blendIndexStride,
+            size_t numWeightsPerVertex, size_t numVertices,
+            SceneManager *sceneManager )
+    {
+        mMode               = MODE_SKINNING;
+        mNumVertices        = numVertices;
+        mSrcPos             = srcPosPtr;
+        mSrcPos2            = 0;
+        mDestPos            = destPosPtr;
+        mSrcNorm            = srcNormPtr;
+        mDestNorm           = destNormPtr;
+        mBlendWeight        = blendWeightPtr;
+        mBlendIndex         = blendIndexPtr;
+        mBlendMatrices      = blendMatrices;
+        mSrcPosStride       = srcPosStride;
+        mDestPosStride      = destPosStride;
+        mSrcNormStride      = srcNormStride;
+        mDestNormStride     = destNormStride;
+        mBlendWeightStride  = blendWeightStride;
+        mBlendIndexStride   = blendIndexStride;
+        mNumWeightsPerVertex= numWeightsPerVertex;
+
+        dispatch( sceneManager );
+    }
+    //-----------------------------------------------------------------------------------
+    void SoftwareVertexAnimationTask::softwareVertexMorph( Real t, const float *srcPos1,
+                                                           const float *srcPos2, float *dstPos,
+                                                           size_t pos1VSize, size_t pos2VSize,
+                                                           size_t dstVSize, size_t numVertices,
+                                                           bool morphNormals,
+                                                           SceneManager *sceneManager )
+    {
+        mMode           = MODE_MORPH;
+        mNumVertices    = numVertices;
+        mSrcPos         = srcPos1;
+        mSrcPos2        = srcPos2;
+        mDestPos        = dstPos;
+        mSrcPosStride   = pos1VSize;
+        mSrcNormStride  = pos2VSize;
+        mDestPosStride  = dstVSize;
+        mMorphT         = t;
+        mMorphNormals   = morphNormals;
+
+        dispatch( sceneManager );
+    }
+    //-----------------------------------------------------------------------------------
+    void SoftwareVertexAnimationTask::execute( size_t threadId, size_t numThreads )
+    {
+        size_t start, end;
+        getThreadRange( threadId, numThreads, start, end );
+
+        if( start == end )
+            return;
+
+        OptimisedUtil *optimisedUtil = OptimisedUtil::getImplementation();
+
+        if( mMode == MODE_SKINNING )
+        {
+            const float *srcNorm = 0;
+            float *destNorm = 0;
+            if( mSrcNorm )
+            {
+                srcNorm = reinterpret_cast<const float*>(
+                            reinterpret_cast<const uint8*>( mSrcNorm ) + start * mSrcNormStride );
+                destNorm = reinterpret_cast<float*>(
+                            reinterpret_cast<uint8*>( mDestNorm ) + start * mDestNormStride );
+            }
+
+            optimisedUtil->softwareVertexSkinning(
+                    reinterpret_cast<const float*>(
+                        reinterpret_cast<const uint8*>( mSrcPos ) + start * mSrcPosStride ),
+                    reinterpret_cast<float*>(
+                        reinterpret_cast<uint8*>( mDestPos ) + start * mDestPosStride ),
+                    srcNorm, destNorm,
+                    reinterpret_cast<const float*>(
+                        reinterpret_cast<const uint8*>( mBlendWeight ) + start * mBlendWeightStride ),
+                    mBlendIndex + start * mBlendIndexStride,
+                    mBlendMatrices,
+                    mSrcPosStride, mDestPosStride,
+                    mSrcNormStride, mDestNormStride,
+                    mBlendWeightStride, mBlendIndexStride,
+                    mNumWeightsPerVertex,
+                    end - start );
+        }
+        else
+        {
+            optimisedUtil->softwareVertexMorph(
+                    mMorphT,
+                    reinterpret_cast<const float*>(
+                        reinterpret_cast<const uint8*>( mSrcPos ) + start * mSrcPosStride ),
+                    reinterpret_cast<const float*>(
+                        reinterpret_cast<const uint8*>( mSrcPos2 ) + start * mSrcNormStride ),
+                    reinterpret_cast<float*>(
+                        reinterpret_cast<uint8*>( mDestPos ) + start * mDestPosStride ),
+                    mSrcPosStride, mSrcNormStride, mDestPosStride,
+                    end - start,
+                    mMorphNormals );
+        }
+    }
+}
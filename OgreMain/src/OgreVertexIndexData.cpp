@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "OgreRoot.h"
 #include "OgreRenderSystem.h" 
 #include "OgreException.h"
+#include "OgreMeshOptimiser.h"
 
 namespace Ogre {
 
@@ -733,204 +734,11 @@ namespace Ogre {
     }
     //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
-    // Local Utility class for vertex cache optimizer
-    class Triangle
-    {
-    public:
-        enum EdgeMatchType {
-            AB, BC, CA, ANY, NONE
-        };
-
-        uint32 a, b, c;     
-
-        inline Triangle()
-        {
-        }
-
-        inline Triangle( uint32 ta, uint32 tb, uint32 tc ) 
-            : a( ta ), b( tb ), c( tc )
-        {
-        }
-
-        inline Triangle( uint32 t[3] )
-            : a( t[0] ), b( t[1] ), c( t[2] )
-        {
-        }
-
-        inline Triangle( const Triangle& t )
-            : a( t.a ), b( t.b ), c( t.c )
-        {
-        }
-
-        inline bool sharesEdge(const Triangle& t) const
-        {
-            return( (a == t.a && b == t.c) ||
-                    (a == t.b && b == t.a) ||
-                    (a == t.c && b == t.b) ||
-                    (b == t.a && c == t.c) ||
-                    (b == t.b && c == t.a) ||
-                    (b == t.c && c == t.b) ||
-                    (c == t.a && a == t.c) ||
-                    (c == t.b && a == t.a) ||
-                    (c == t.c && a == t.b) );
-        }
-
-        inline bool sharesEdge(const uint32 ea, const uint32 eb, const Triangle& t) const
-        {
-            return( (ea == t.a && eb == t.c) ||
-                    (ea == t.b && eb == t.a) ||
-                    (ea == t.c && eb == t.b) ); 
-        }
-
-        inline bool sharesEdge(const EdgeMatchType edge, const Triangle& t) const
-        {
-            if (edge == AB)
-                return sharesEdge(a, b, t);
-            else if (edge == BC)
-                return sharesEdge(b, c, t);
-            else if (edge == CA)
-                return sharesEdge(c, a, t);
-            else
-                return (edge == ANY) == sharesEdge(t);
-        }
-
-        inline EdgeMatchType endoSharedEdge(const Triangle& t) const
-        {
-            if (sharesEdge(a, b, t)) return AB;
-            if (sharesEdge(b, c, t)) return BC;
-            if (sharesEdge(c, a, t)) return CA;
-            return NONE;
-        }
-
-        inline EdgeMatchType exoSharedEdge(const Triangle& t) const
-        {
-            return t.endoSharedEdge(*this);
-        }
-
-        inline void shiftClockwise()
-        {
-            uint32 t = a;
-            a = c;
-            c = b;
-            b = t;
-        }
-
-        inline void shiftCounterClockwise()
-        {
-            uint32 t = a;
-            a = b;
-            b = c;
-            c = t;
-        }
-    };
-    //-----------------------------------------------------------------------
-    //-----------------------------------------------------------------------
     void IndexData::optimiseVertexCacheTriList(void)
     {
-        if (indexBuffer->isLocked()) return;
-
-        void *buffer = indexBuffer->lock(HardwareBuffer::HBL_NORMAL);
-
-        Triangle* triangles;
+        if (indexBuffer.isNull() || indexBuffer->isLocked()) return;
 
-        size_t nIndexes = indexCount;
-        size_t nTriangles = nIndexes / 3;
-        size_t i, j;
-        uint16 *source = 0;
-
-        if (indexBuffer->getType() == HardwareIndexBuffer::IT_16BIT)
-        {
-            triangles = OGRE_ALLOC_T(Triangle, nTriangles, MEMCATEGORY_GEOMETRY);
-            source = (uint16 *)buffer;
-            uint32 *dest = (uint32 *)triangles;
-            for (i = 0; i < nIndexes; ++i) dest[i] = source[i];
-        }
-        else
-            triangles = static_cast<Triangle*>(buffer);
-
-        // sort triangles based on shared edges
-        uint32 *destlist = OGRE_ALLOC_T(uint32, nTriangles, MEMCATEGORY_GEOMETRY);
-        unsigned char *visited = OGRE_ALLOC_T(unsigned char, nTriangles, MEMCATEGORY_GEOMETRY);
-
-        for (i = 0; i < nTriangles; ++i) visited[i] = 0;
-
-        uint32 start = 0, ti = 0, destcount = 0;
-
-        bool found = false;
-        for (i = 0; i < nTriangles; ++i)
-        {
-            if (found)
-                found = false;
-            else
-            {
-                while (visited[start++]);
-                ti = start - 1;
-            }
-
-            destlist[destcount++] = ti;
-            visited[ti] = 1;
-
-            for (j = start; j < nTriangles; ++j)
-            {
-                if (visited[j]) continue;
-                
-                if (triangles[ti].sharesEdge(triangles[j]))
-                {
-                    found = true;
-                    ti = static_cast<uint32>(j);
-                    break;
-                }
-            }
-        }
-
-        if (indexBuffer->getType() == HardwareIndexBuffer::IT_16BIT)
-        {
-            // reorder the indexbuffer
-            j = 0;
-            for (i = 0; i < nTriangles; ++i)
-            {
-                Triangle *t = &triangles[destlist[i]];
-                if(source)
-                {
-                    source[j++] = (uint16)t->a;
-                    source[j++] = (uint16)t->b;
-                    source[j++] = (uint16)t->c;
-                }
-            }
-            OGRE_FREE(triangles, MEMCATEGORY_GEOMETRY);
-        }
-        else
-        {
-            uint32 *reflist = OGRE_ALLOC_T(uint32, nTriangles, MEMCATEGORY_GEOMETRY);
-
-            // fill the referencebuffer
-            for (i = 0; i < nTriangles; ++i)
-                reflist[destlist[i]] = static_cast<uint32>(i);
-            
-            // reorder the indexbuffer
-            for (i = 0; i < nTriangles; ++i)
-            {
-                j = destlist[i];
-                if (i == j) continue; // do not move triangle
-
-                // swap triangles
-
-                Triangle t = triangles[i];
-                triangles[i] = triangles[j];
-                triangles[j] = t;
-
-                // change reference
-                destlist[reflist[i]] = static_cast<uint32>(j);
-                // destlist[i] = i; // not needed, it will not be used
-            }
-
-            OGRE_FREE(reflist, MEMCATEGORY_GEOMETRY);
-        }
-
-        OGRE_FREE(destlist, MEMCATEGORY_GEOMETRY);
-        OGRE_FREE(visited, MEMCATEGORY_GEOMETRY);
-                    
-        indexBuffer->unlock();
+        MeshOptimiser::optimiseVertexCache(this);
     }
     //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
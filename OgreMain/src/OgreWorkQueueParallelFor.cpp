@@ -0,0 +1,174 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+
+#include "OgreWorkQueueParallelFor.h"
+#include "OgreRoot.h"
+#include "OgreException.h"
+
+namespace Ogre
+{
+    WorkQueueParallelFor::WorkQueueParallelFor( Task &task, size_t count, size_t rangeSize ) :
+        mTask( task ),
+        mCount( count ),
+        mRangeSize( rangeSize ),
+        mNextRangeBegin( 0 ),
+        mStartedRanges( 0 )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    void WorkQueueParallelFor::run( Task &task, size_t count, WorkQueue *workQueue,
+                                    size_t minRangeSize )
+    {
+        size_t threadCount = 0;
+        DefaultWorkQueueBase *defaultWorkQueue = dynamic_cast<DefaultWorkQueueBase*>( workQueue );
+        if( defaultWorkQueue )
+            threadCount = defaultWorkQueue->getWorkerThreadCount();
+
+        minRangeSize = std::max<size_t>( minRangeSize, 1 );
+        if( threadCount == 0 || count <= minRangeSize )
+        {
+            if( count > 0 )
+                task.execute( 0, count );
+            return;
+        }
+
+        //A few ranges per thread, so the threads finishing early can take over the remaining work
+        const size_t rangeSize  = std::max<size_t>( minRangeSize, count / ((threadCount + 1) * 4) );
+        const size_t rangeCount = (count + rangeSize - 1) / rangeSize;
+
+        WorkQueueParallelFor job( task, count, rangeSize );
+        const uint16 channel = workQueue->getChannel( "Ogre/WorkQueueParallelFor" );
+        workQueue->addRequestHandler( channel, &job );
+
+        //The calling thread processes ranges too, so one request less is enough
+        vector<WorkQueue::RequestID>::type requests;
+        const size_t requestCount = std::min( threadCount, rangeCount - 1 );
+        requests.reserve( requestCount );
+        for( size_t i=0; i<requestCount; ++i )
+        {
+            RangeRequest request;
+            request.owner = &job;
+            requests.push_back( workQueue->addRequest( channel, 0, Any( request ) ) );
+        }
+
+        //Help the worker threads. Once we run out of ranges no more get started,
+        //so we know how many we have to wait for.
+        while( job.executeNextRange() ) {}
+
+        job.mMutex.lock();
+        const size_t startedRanges = job.mStartedRanges;
+        job.mMutex.unlock();
+
+        for( size_t i=0; i<startedRanges; ++i )
+            job.mRangeFinished.wait();
+
+        //The requests which didn't get to run have nothing left to do. Removing the
+        //handler waits for the ones still returning from handleRequest.
+        vector<WorkQueue::RequestID>::type::const_iterator itor = requests.begin();
+        vector<WorkQueue::RequestID>::type::const_iterator end  = requests.end();
+        while( itor != end )
+            workQueue->abortRequest( *itor++ );
+        workQueue->removeRequestHandler( channel, &job );
+
+        if( !job.mError.empty() )
+            OGRE_EXCEPT( Exception::ERR_INTERNAL_ERROR, job.mError, "WorkQueueParallelFor::run" );
+    }
+    //-----------------------------------------------------------------------------------
+    WorkQueue* WorkQueueParallelFor::getRootWorkQueue(void)
+    {
+        Root *root = Root::getSingletonPtr();
+        return root ? root->getWorkQueue() : 0;
+    }
+    //-----------------------------------------------------------------------------------
+    bool WorkQueueParallelFor::executeNextRange(void)
+    {
+        mMutex.lock();
+        //Stop handing out ranges after an error, the result is thrown away anyway
+        if( mNextRangeBegin >= mCount || !mError.empty() )
+        {
+            mMutex.unlock();
+            return false;
+        }
+        const size_t begin  = mNextRangeBegin;
+        const size_t end    = std::min( begin + mRangeSize, mCount );
+        mNextRangeBegin = end;
+        ++mStartedRanges;
+        mMutex.unlock();
+
+        String error;
+        try
+        {
+            mTask.execute( begin, end );
+        }
+        catch( Exception &e )
+        {
+            error = e.getFullDescription();
+        }
+        catch( std::exception &e )
+        {
+            error = e.what();
+        }
+        catch( ... )
+        {
+            error = "Unknown exception";
+        }
+
+        if( !error.empty() )
+        {
+            mMutex.lock();
+            if( mError.empty() )
+                mError = error;
+            mMutex.unlock();
+        }
+
+        mRangeFinished.post();
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    bool WorkQueueParallelFor::canHandleRequest( const WorkQueue::Request *req,
+                                                 const WorkQueue *srcQ )
+    {
+        const RangeRequest &request = any_cast<RangeRequest>( req->getData() );
+        //Other loops running at the same time share the channel
+        if( request.owner != this )
+            return false;
+
+        return RequestHandler::canHandleRequest( req, srcQ );
+    }
+    //-----------------------------------------------------------------------------------
+    WorkQueue::Response* WorkQueueParallelFor::handleRequest( const WorkQueue::Request *req,
+                                                              const WorkQueue *srcQ )
+    {
+        //Background thread
+        while( executeNextRange() ) {}
+
+        return OGRE_NEW WorkQueue::Response( req, true, Any() );
+    }
+}
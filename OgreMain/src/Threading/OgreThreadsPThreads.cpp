@@ -30,6 +30,9 @@ THE SOFTWARE.
 
 #include "Threading/OgreThreads.h"
 
+#include <sched.h>
+#include <unistd.h>
+
 namespace Ogre
 {
     ThreadHandle::ThreadHandle( size_t threadIdx, void *userParam ) :
@@ -67,4 +70,12 @@ namespace Ogre
         if( !threadHandles.empty() )
             Threads::WaitForThreads( threadHandles.size(), &threadHandles[0] );
     }
+    //-----------------------------------------------------------------------------------
+    void Threads::Sleep( uint32 milliseconds )
+    {
+        if( milliseconds == 0 )
+            sched_yield();
+        else
+            usleep( milliseconds * 1000 );
+    }
 }
@@ -0,0 +1,330 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "Threading/OgreWorkStealingScheduler.h"
+
+namespace Ogre
+{
+    namespace
+    {
+        /// Number of times an idle worker looks for work before blocking
+        const size_t c_maxIdleSpins = 64;
+
+        inline size_t loadAcquire( const size_t &value )
+        {
+#if OGRE_COMPILER == OGRE_COMPILER_MSVC
+            //MSVC gives volatile accesses acquire/release semantics
+            return *static_cast<const volatile size_t*>( &value );
+#elif ((OGRE_COMPILER == OGRE_COMPILER_GNUC) && (OGRE_COMP_VER >= 470)) || (OGRE_COMPILER == OGRE_COMPILER_CLANG)
+            return __atomic_load_n( &value, __ATOMIC_ACQUIRE );
+#else
+            const size_t retVal = *static_cast<const volatile size_t*>( &value );
+            __sync_synchronize();
+            return retVal;
+#endif
+        }
+
+        inline void storeRelease( size_t &dst, size_t value )
+        {
+#if OGRE_COMPILER == OGRE_COMPILER_MSVC
+            *static_cast<volatile size_t*>( &dst ) = value;
+#elif ((OGRE_COMPILER == OGRE_COMPILER_GNUC) && (OGRE_COMP_VER >= 470)) || (OGRE_COMPILER == OGRE_COMPILER_CLANG)
+            __atomic_store_n( &dst, value, __ATOMIC_RELEASE );
+#else
+            __sync_synchronize();
+            *static_cast<volatile size_t*>( &dst ) = value;
+#endif
+        }
+    }
+
+    WorkStealingScheduler::WorkStealingScheduler( size_t numThreads ) :
+        mNumThreads( numThreads ),
+        mRemainingTasks( 0 ),
+        mNumSleeping( 0 )
+    {
+        assert( numThreads > 0 );
+
+        mQueues.reserve( numThreads );
+        for( size_t i=0; i<numThreads; ++i )
+            mQueues.push_back( OGRE_NEW_T( ThreadQueue, MEMCATEGORY_GENERAL ) );
+    }
+    //-----------------------------------------------------------------------------------
+    WorkStealingScheduler::~WorkStealingScheduler()
+    {
+        ThreadQueueVec::const_iterator itor = mQueues.begin();
+        ThreadQueueVec::const_iterator end  = mQueues.end();
+
+        while( itor != end )
+        {
+            OGRE_DELETE_T( *itor, ThreadQueue, MEMCATEGORY_GENERAL );
+            ++itor;
+        }
+
+        mQueues.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    WorkStealingScheduler::TaskId WorkStealingScheduler::addTask( ChunkedTask *task, size_t numChunks )
+    {
+        TaskEntry entry;
+        entry.task                  = task;
+        entry.numChunks             = numChunks;
+        entry.chunksLeft            = numChunks;
+        entry.pendingDependencies   = 0;
+        mTasks.push_back( entry );
+
+        return mTasks.size() - 1;
+    }
+    //-----------------------------------------------------------------------------------
+    void WorkStealingScheduler::addDependency( TaskId taskId, TaskId dependsOn )
+    {
+        assert( taskId < mTasks.size() && dependsOn < mTasks.size() );
+        assert( dependsOn < taskId && "Tasks can only depend on tasks added before them" );
+
+        mTasks[dependsOn].dependents.push_back( taskId );
+        ++mTasks[taskId].pendingDependencies;
+    }
+    //-----------------------------------------------------------------------------------
+    void WorkStealingScheduler::pushTask( TaskId taskId, size_t threadIdx )
+    {
+        ThreadQueue *queue = mQueues[threadIdx];
+        queue->mutex.lock();
+        queue->ranges.push_back( WorkRange( taskId, 0, mTasks[taskId].numChunks ) );
+        queue->mutex.unlock();
+    }
+    //-----------------------------------------------------------------------------------
+    bool WorkStealingScheduler::popRange( size_t threadIdx, WorkRange &outRange )
+    {
+        bool retVal = false;
+
+        ThreadQueue *queue = mQueues[threadIdx];
+        queue->mutex.lock();
+        if( !queue->ranges.empty() )
+        {
+            outRange = queue->ranges.back();
+            queue->ranges.pop_back();
+            retVal = true;
+        }
+        queue->mutex.unlock();
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    bool WorkStealingScheduler::stealRange( size_t threadIdx, WorkRange &outRange )
+    {
+        bool retVal = false;
+
+        for( size_t i=1; i<mNumThreads && !retVal; ++i )
+        {
+            ThreadQueue *victim = mQueues[(threadIdx + i) % mNumThreads];
+
+            //Don't wait on a contended queue, try the next victim
+            if( victim->mutex.tryLock() )
+            {
+                if( !victim->ranges.empty() )
+                {
+                    outRange = victim->ranges.front();
+                    victim->ranges.pop_front();
+                    retVal = true;
+                }
+                victim->mutex.unlock();
+            }
+        }
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    void WorkStealingScheduler::finishTask( TaskId taskId, size_t threadIdx )
+    {
+        assert( mRemainingTasks > 0 );
+        storeRelease( mRemainingTasks, mRemainingTasks - 1 );
+        if( mRemainingTasks == 0 )
+            wakeUpWorkers( mNumSleeping );
+
+        const FastArray<TaskId> &dependents = mTasks[taskId].dependents;
+        FastArray<TaskId>::const_iterator itor = dependents.begin();
+        FastArray<TaskId>::const_iterator end  = dependents.end();
+
+        while( itor != end )
+        {
+            TaskEntry &dependent = mTasks[*itor];
+            if( --dependent.pendingDependencies == 0 )
+            {
+                if( dependent.numChunks == 0 )
+                {
+                    finishTask( *itor, threadIdx );
+                }
+                else
+                {
+                    pushTask( *itor, threadIdx );
+                    wakeUpWorkers( 1 );
+                }
+            }
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void WorkStealingScheduler::wakeUpWorkers( size_t count )
+    {
+        count = std::min( count, mNumSleeping );
+        if( count > 0 )
+        {
+            mNumSleeping -= count;
+            mIdleSemaphore.post( count );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool WorkStealingScheduler::waitForWork(void)
+    {
+        mGraphMutex.lock();
+
+        if( mRemainingTasks == 0 )
+        {
+            mGraphMutex.unlock();
+            return false;
+        }
+
+        //Tasks released by finishTask are pushed with mGraphMutex held, after looking
+        //at mNumSleeping. Thus anything pushed before we took the lock is still in a
+        //queue, and anything pushed after it will see us sleeping and wake us up.
+        bool hasWork = false;
+        for( size_t i=0; i<mNumThreads && !hasWork; ++i )
+        {
+            mQueues[i]->mutex.lock();
+            hasWork = !mQueues[i]->ranges.empty();
+            mQueues[i]->mutex.unlock();
+        }
+
+        if( !hasWork )
+            ++mNumSleeping;
+
+        mGraphMutex.unlock();
+
+        if( !hasWork )
+            mIdleSemaphore.wait();
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void WorkStealingScheduler::_prepare(void)
+    {
+        assert( mNumSleeping == 0 );
+        mRemainingTasks = mTasks.size();
+
+        //Split the tasks that can start right away evenly across all threads. Not perfect,
+        //but it's a good start and keeps each thread working on contiguous memory.
+        //Stealing takes care of the rest.
+        const TaskId numTasks = mTasks.size();
+        for( TaskId i=0; i<numTasks; ++i )
+        {
+            const TaskEntry &entry = mTasks[i];
+            if( entry.pendingDependencies == 0 && entry.numChunks != 0 )
+            {
+                for( size_t j=0; j<mNumThreads; ++j )
+                {
+                    const size_t chunkBegin = (entry.numChunks * j) / mNumThreads;
+                    const size_t chunkEnd   = (entry.numChunks * (j+1)) / mNumThreads;
+                    if( chunkBegin != chunkEnd )
+                        mQueues[j]->ranges.push_back( WorkRange( i, chunkBegin, chunkEnd ) );
+                }
+            }
+        }
+
+        //Empty tasks are done already (this may release tasks that depend on them).
+        //Go backwards: finishing a task recursively finishes the empty tasks after it
+        //that were waiting only on it, which must not be visited again afterwards.
+        for( TaskId i=numTasks; i-- > 0; )
+        {
+            if( mTasks[i].pendingDependencies == 0 && mTasks[i].numChunks == 0 )
+                finishTask( i, 0 );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void WorkStealingScheduler::_execute( size_t threadIdx )
+    {
+        WorkRange range;
+        size_t idleSpins = 0;
+        bool keepRunning = true;
+        while( keepRunning )
+        {
+            if( popRange( threadIdx, range ) || stealRange( threadIdx, range ) )
+            {
+                idleSpins = 0;
+
+                //Keep the first chunk for us, leave the rest (in halves, biggest
+                //ones at the front) so that idle threads can steal them.
+                size_t numSplits = 0;
+                ThreadQueue *queue = mQueues[threadIdx];
+                queue->mutex.lock();
+                while( range.chunkEnd - range.chunkBegin > 1 )
+                {
+                    const size_t midPoint = range.chunkBegin + ((range.chunkEnd - range.chunkBegin) >> 1);
+                    queue->ranges.push_back( WorkRange( range.taskId, midPoint, range.chunkEnd ) );
+                    range.chunkEnd = midPoint;
+                    ++numSplits;
+                }
+                queue->mutex.unlock();
+
+                //Let sleeping workers help. waitForWork looks at the queues with mGraphMutex
+                //held: either it saw our ranges, or it's sleeping by the time we get the lock.
+                if( numSplits > 0 )
+                {
+                    mGraphMutex.lock();
+                    wakeUpWorkers( numSplits );
+                    mGraphMutex.unlock();
+                }
+
+                TaskEntry &entry = mTasks[range.taskId];
+                entry.task->execute( range.chunkBegin, threadIdx );
+
+                mGraphMutex.lock();
+                if( --entry.chunksLeft == 0 )
+                    finishTask( range.taskId, threadIdx );
+                mGraphMutex.unlock();
+            }
+            else if( loadAcquire( mRemainingTasks ) == 0 )
+            {
+                keepRunning = false;
+            }
+            else if( ++idleSpins >= c_maxIdleSpins )
+            {
+                //Nothing to steal. Someone is still working on the chunks our next
+                //task depends on. Block instead of burning the core meanwhile.
+                idleSpins = 0;
+                keepRunning = waitForWork();
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void WorkStealingScheduler::clear(void)
+    {
+        assert( mRemainingTasks == 0 && "Clearing a graph that is still running!" );
+        mTasks.clear();
+    }
+}
@@ -0,0 +1,221 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __NullRenderSystem_H__
+#define __NullRenderSystem_H__
+
+#include "OgreNullPrerequisites.h"
+
+#include "OgreRenderSystem.h"
+
+namespace Ogre
+{
+    class HardwareBufferManager;
+
+    /** RenderSystem that doesn't talk to any graphics API.
+    @remarks
+        Windows, textures and hardware buffers live in system memory, shaders aren't
+        compiled and draw calls only update the statistics. It doesn't need a GPU nor
+        a display, which makes it suitable for dedicated servers and automated tests
+        that need SceneManager (animation, culling, LOD) and Compositor logic, and for
+        measuring the CPU cost of the frame loop.
+        @par
+        Only the fixed function pipeline is advertised in the capabilities, so materials
+        fall back to their fixed function techniques, if any.
+    */
+    class _OgreNullExport NullRenderSystem : public RenderSystem
+    {
+    public:
+        /// Counters accumulated by _render
+        struct Statistics
+        {
+            size_t numFrames;
+            size_t numDrawCalls;
+            size_t numInstances;
+            size_t numFaces;
+            size_t numVertices;
+
+            Statistics() :
+                numFrames( 0 ), numDrawCalls( 0 ), numInstances( 0 ),
+                numFaces( 0 ), numVertices( 0 ) {}
+        };
+
+    protected:
+        ConfigOptionMap mOptions;
+
+        HardwareBufferManager   *mHardwareBufferManager;
+        NullGpuProgramManager   *mGpuProgramManager;
+
+        bool        mInitialised;
+
+        Statistics  mCurrentFrameStats;
+        Statistics  mLastFrameStats;
+        Statistics  mTotalStats;
+
+        void initConfigOptions(void);
+
+    public:
+        NullRenderSystem();
+        ~NullRenderSystem();
+
+        /// Statistics of the frame being rendered, since the last _beginFrame
+        const Statistics& getCurrentFrameStatistics(void) const     { return mCurrentFrameStats; }
+        /// Statistics of the last finished frame (between the last _beginFrame & _endFrame pair)
+        const Statistics& getLastFrameStatistics(void) const        { return mLastFrameStats; }
+        /// Statistics accumulated since creation or the last call to resetStatistics
+        const Statistics& getTotalStatistics(void) const            { return mTotalStats; }
+        /// Zeroes all statistics
+        void resetStatistics(void);
+
+        // ----------------------------------
+        // Overridden RenderSystem functions
+        // ----------------------------------
+        const String& getName(void) const;
+        const String& getFriendlyName(void) const;
+        ConfigOptionMap& getConfigOptions(void);
+        void setConfigOption(const String &name, const String &value);
+        String validateConfigOptions(void);
+        RenderWindow* _initialise(bool autoCreateWindow, const String& windowTitle = "OGRE Render Window");
+        RenderSystemCapabilities* createRenderSystemCapabilities() const;
+        void initialiseFromRenderSystemCapabilities(RenderSystemCapabilities* caps, RenderTarget* primary);
+        void reinitialise(void);
+        void shutdown(void);
+
+        void setAmbientLight(float r, float g, float b) {}
+        void setShadingType(ShadeOptions so) {}
+        void setLightingEnabled(bool enabled) {}
+
+        RenderWindow* _createRenderWindow(const String &name, unsigned int width, unsigned int height, 
+            bool fullScreen, const NameValuePairList *miscParams = 0);
+        MultiRenderTarget* createMultiRenderTarget(const String & name);
+        DepthBuffer* _createDepthBufferFor( RenderTarget *renderTarget );
+        HardwareOcclusionQuery* createHardwareOcclusionQuery(void);
+
+        String getErrorDescription(long errorNumber) const;
+        VertexElementType getColourVertexElementType(void) const;
+        void setNormaliseNormals(bool normalise) {}
+
+        void _useLights(const LightList& lights, unsigned short limit) {}
+        void _setWorldMatrix(const Matrix4 &m) {}
+        void _setViewMatrix(const Matrix4 &m) {}
+        void _setProjectionMatrix(const Matrix4 &m) {}
+        void _setSurfaceParams(const ColourValue &ambient,
+            const ColourValue &diffuse, const ColourValue &specular,
+            const ColourValue &emissive, Real shininess,
+            TrackVertexColourType tracking) {}
+        void _setPointSpritesEnabled(bool enabled) {}
+        void _setPointParameters(Real size, bool attenuationEnabled, 
+            Real constant, Real linear, Real quadratic, Real minSize, Real maxSize) {}
+        void _setTexture(size_t unit, bool enabled, const TexturePtr &texPtr) {}
+        void _setTextureCoordSet(size_t unit, size_t index) {}
+        void _setTextureCoordCalculation(size_t unit, TexCoordCalcMethod m, 
+            const Frustum* frustum = 0) {}
+        void _setTextureBlendMode(size_t unit, const LayerBlendModeEx& bm) {}
+        void _setTextureUnitFiltering(size_t unit, FilterType ftype, FilterOptions filter) {}
+        void _setTextureUnitCompareEnabled(size_t unit, bool compare) {}
+        void _setTextureUnitCompareFunction(size_t unit, CompareFunction function) {}
+        void _setTextureLayerAnisotropy(size_t unit, unsigned int maxAnisotropy) {}
+        void _setTextureAddressingMode(size_t unit, const TextureUnitState::UVWAddressingMode& uvw) {}
+        void _setTextureBorderColour(size_t unit, const ColourValue& colour) {}
+        void _setTextureMipmapBias(size_t unit, float bias) {}
+        void _setTextureMatrix(size_t unit, const Matrix4& xform) {}
+        void _setSceneBlending(SceneBlendFactor sourceFactor, SceneBlendFactor destFactor,
+                               SceneBlendOperation op) {}
+        void _setSeparateSceneBlending(SceneBlendFactor sourceFactor, SceneBlendFactor destFactor,
+                                       SceneBlendFactor sourceFactorAlpha, SceneBlendFactor destFactorAlpha,
+                                       SceneBlendOperation op, SceneBlendOperation alphaOp) {}
+        void _setAlphaRejectSettings(CompareFunction func, unsigned char value, bool alphaToCoverage) {}
+
+        void _beginFrame(void);
+        void _endFrame(void);
+        void _setViewport(Viewport *vp);
+        void _setRenderTarget(RenderTarget *target);
+
+        void _setCullingMode(CullingMode mode) {}
+        void _setDepthBufferParams(bool depthTest, bool depthWrite, CompareFunction depthFunction) {}
+        void _setDepthBufferCheckEnabled(bool enabled) {}
+        void _setDepthBufferWriteEnabled(bool enabled) {}
+        void _setDepthBufferFunction(CompareFunction func) {}
+        void _setColourBufferWriteEnabled(bool red, bool green, bool blue, bool alpha) {}
+        void _setDepthBias(float constantBias, float slopeScaleBias) {}
+        void _setFog(FogMode mode, const ColourValue& colour, Real expDensity,
+                     Real linearStart, Real linearEnd) {}
+        void _setPolygonMode(PolygonMode level) {}
+
+        void _convertProjectionMatrix(const Matrix4& matrix, Matrix4& dest, bool forGpuProgram = false);
+        void _makeProjectionMatrix(const Radian& fovy, Real aspect, Real nearPlane, Real farPlane, 
+            Matrix4& dest, bool forGpuProgram = false);
+        void _makeProjectionMatrix(Real left, Real right, Real bottom, Real top, 
+            Real nearPlane, Real farPlane, Matrix4& dest, bool forGpuProgram = false);
+        void _makeOrthoMatrix(const Radian& fovy, Real aspect, Real nearPlane, Real farPlane, 
+            Matrix4& dest, bool forGpuProgram = false);
+        void _applyObliqueDepthProjection(Matrix4& matrix, const Plane& plane, 
+            bool forGpuProgram);
+
+        void setStencilCheckEnabled(bool enabled) {}
+
+        void setVertexDeclaration(VertexDeclaration* decl) {}
+        void setVertexBufferBinding(VertexBufferBinding* binding) {}
+
+        /** Updates the statistics; nothing is drawn.
+        @copydoc RenderSystem::_render
+        */
+        void _render(const RenderOperation& op);
+
+        void bindGpuProgramParameters(GpuProgramType gptype, 
+            GpuProgramParametersSharedPtr params, uint16 variabilityMask) {}
+        void bindGpuProgramPassIterationParameters(GpuProgramType gptype) {}
+
+        void setScissorTest(bool enabled, size_t left = 0, size_t top = 0, 
+            size_t right = 800, size_t bottom = 600) {}
+        void clearFrameBuffer(unsigned int buffers, 
+            const ColourValue& colour = ColourValue::Black, 
+            Real depth = 1.0f, unsigned short stencil = 0) {}
+
+        Real getHorizontalTexelOffset(void)     { return 0.0f; }
+        Real getVerticalTexelOffset(void)       { return 0.0f; }
+        Real getMinimumDepthInputValue(void)    { return -1.0f; }
+        Real getMaximumDepthInputValue(void)    { return 1.0f; }
+
+        void preExtraThreadsStarted() {}
+        void postExtraThreadsStarted() {}
+        void registerThread() {}
+        void unregisterThread() {}
+        unsigned int getDisplayMonitorCount() const     { return 1; }
+
+        void beginProfileEvent( const String &eventName ) {}
+        void endProfileEvent( void ) {}
+        void markProfileEvent( const String &event ) {}
+
+        bool hasAnisotropicMipMapFilter() const         { return false; }
+
+    protected:
+        void setClipPlanesImpl(const PlaneList& clipPlanes) {}
+    };
+}
+
+#endif
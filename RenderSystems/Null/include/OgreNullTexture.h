@@ -0,0 +1,66 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __NullTexture_H__
+#define __NullTexture_H__
+
+#include "OgreNullPrerequisites.h"
+#include "OgreTexture.h"
+
+namespace Ogre
+{
+    /** Texture whose surfaces are NullHardwarePixelBuffers.
+    @remarks
+        Textures loaded from a file don't read it: they keep the size and format
+        that were requested (512x512 by default), and their contents are black.
+        Manually loaded textures (i.e. Texture::loadImage) and render targets
+        behave like in any other RenderSystem.
+    */
+    class _OgreNullExport NullTexture : public Texture
+    {
+    protected:
+        typedef vector<HardwarePixelBufferSharedPtr>::type SurfaceList;
+        SurfaceList mSurfaceList;
+
+        /// @copydoc Texture::createInternalResourcesImpl
+        void createInternalResourcesImpl(void);
+        /// @copydoc Resource::loadImpl
+        void loadImpl(void);
+        /// @copydoc Texture::freeInternalResourcesImpl
+        void freeInternalResourcesImpl(void);
+
+    public:
+        NullTexture( ResourceManager* creator, const String& name, ResourceHandle handle,
+                     const String& group, bool isManual, ManualResourceLoader* loader );
+        virtual ~NullTexture();
+
+        /// @copydoc Texture::getBuffer
+        HardwarePixelBufferSharedPtr getBuffer(size_t face=0, size_t mipmap=0);
+    };
+}
+
+#endif
@@ -0,0 +1,136 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreNullTexture.h"
+#include "OgreNullHardwarePixelBuffer.h"
+#include "OgreTextureManager.h"
+#include "OgreStringConverter.h"
+
+namespace Ogre
+{
+    NullTexture::NullTexture( ResourceManager* creator, const String& name, ResourceHandle handle,
+                              const String& group, bool isManual, ManualResourceLoader* loader ) :
+        Texture( creator, name, handle, group, isManual, loader )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    NullTexture::~NullTexture()
+    {
+        // have to call this here rather than in Resource destructor
+        // since calling virtual methods in base destructors causes crash
+        if( isLoaded() )
+            unload();
+        else
+            freeInternalResources();
+    }
+    //-----------------------------------------------------------------------------------
+    void NullTexture::createInternalResourcesImpl(void)
+    {
+        // Adjust format if required
+        mFormat = TextureManager::getSingleton().getNativeFormat( mTextureType, mFormat, mUsage );
+
+        // Check requested number of mipmaps
+        uint32 width  = mWidth;
+        uint32 height = mHeight;
+        uint32 depth  = mTextureType != TEX_TYPE_2D_ARRAY ? mDepth : 1;
+
+        size_t maxMips = 0;
+        while( width > 1 || height > 1 || depth > 1 )
+        {
+            width  = std::max<uint32>( width / 2, 1 );
+            height = std::max<uint32>( height / 2, 1 );
+            depth  = std::max<uint32>( depth / 2, 1 );
+            ++maxMips;
+        }
+
+        mNumMipmaps = mNumRequestedMipmaps;
+        if( mNumMipmaps > maxMips )
+            mNumMipmaps = maxMips;
+
+        mMipmapsHardwareGenerated = true;
+
+        mSurfaceList.clear();
+        mSurfaceList.reserve( getNumFaces() * (mNumMipmaps + 1) );
+
+        for( size_t face=0; face<getNumFaces(); ++face )
+        {
+            width  = mWidth;
+            height = mHeight;
+            depth  = mDepth;
+
+            for( size_t mip=0; mip<=mNumMipmaps; ++mip )
+            {
+                // Only the top mip can be rendered to
+                HardwareBuffer::Usage usage = static_cast<HardwareBuffer::Usage>(
+                            mip == 0 ? mUsage : (mUsage & ~TU_RENDERTARGET) );
+
+                String baseName = mName;
+                if( getNumFaces() > 1 )
+                    baseName += "/" + StringConverter::toString( face );
+
+                NullHardwarePixelBuffer *buf = new NullHardwarePixelBuffer( baseName, width, height,
+                                                                            depth, mFormat, usage );
+                mSurfaceList.push_back( HardwarePixelBufferSharedPtr( buf ) );
+
+                width  = std::max<uint32>( width / 2, 1 );
+                height = std::max<uint32>( height / 2, 1 );
+                if( mTextureType != TEX_TYPE_2D_ARRAY )
+                    depth = std::max<uint32>( depth / 2, 1 );
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void NullTexture::loadImpl(void)
+    {
+        // There's no file to read, just create the surfaces
+        createInternalResources();
+    }
+    //-----------------------------------------------------------------------------------
+    void NullTexture::freeInternalResourcesImpl(void)
+    {
+        mSurfaceList.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    HardwarePixelBufferSharedPtr NullTexture::getBuffer( size_t face, size_t mipmap )
+    {
+        if( face >= getNumFaces() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "Face index out of range",
+                         "NullTexture::getBuffer" );
+        }
+        if( mipmap > mNumMipmaps )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "Mipmap index out of range",
+                         "NullTexture::getBuffer" );
+        }
+
+        size_t idx = face * (mNumMipmaps + 1) + mipmap;
+        assert( idx < mSurfaceList.size() );
+        return mSurfaceList[idx];
+    }
+}
@@ -0,0 +1,131 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreNullWindow.h"
+#include "OgreViewport.h"
+#include "OgrePixelBox.h"
+#include "OgreStringConverter.h"
+
+namespace Ogre
+{
+    NullRenderWindow::NullRenderWindow() :
+        mClosed( false )
+    {
+        mIsFullScreen = false;
+        mActive = false;
+    }
+    //-----------------------------------------------------------------------------------
+    NullRenderWindow::~NullRenderWindow()
+    {
+        destroy();
+    }
+    //-----------------------------------------------------------------------------------
+    void NullRenderWindow::create( const String& name, unsigned int widthPt, unsigned int heightPt,
+                                   bool fullScreen, const NameValuePairList *miscParams )
+    {
+        mName           = name;
+        mWidth          = widthPt;
+        mHeight         = heightPt;
+        mIsFullScreen   = fullScreen;
+        mColourDepth    = 32;
+        mLeft           = 0;
+        mTop            = 0;
+        mFSAA           = 0;
+
+        if( miscParams )
+        {
+            NameValuePairList::const_iterator opt;
+
+            opt = miscParams->find( "left" );
+            if( opt != miscParams->end() )
+                mLeft = StringConverter::parseInt( opt->second );
+
+            opt = miscParams->find( "top" );
+            if( opt != miscParams->end() )
+                mTop = StringConverter::parseInt( opt->second );
+
+            opt = miscParams->find( "colourDepth" );
+            if( opt != miscParams->end() )
+                mColourDepth = StringConverter::parseUnsignedInt( opt->second );
+
+            opt = miscParams->find( "FSAA" );
+            if( opt != miscParams->end() )
+                mFSAA = StringConverter::parseUnsignedInt( opt->second );
+        }
+
+        mActive = true;
+        mClosed = false;
+    }
+    //-----------------------------------------------------------------------------------
+    void NullRenderWindow::destroy(void)
+    {
+        mActive = false;
+        mClosed = true;
+    }
+    //-----------------------------------------------------------------------------------
+    void NullRenderWindow::setFullscreen( bool fullScreen, unsigned int widthPt, unsigned int heightPt )
+    {
+        mIsFullScreen = fullScreen;
+        resize( widthPt, heightPt );
+    }
+    //-----------------------------------------------------------------------------------
+    void NullRenderWindow::resize( unsigned int widthPt, unsigned int heightPt )
+    {
+        if( mClosed || (mWidth == widthPt && mHeight == heightPt) )
+            return;
+
+        mWidth  = widthPt;
+        mHeight = heightPt;
+
+        for( ViewportList::iterator it = mViewportList.begin(); it != mViewportList.end(); ++it )
+            (*it)->_updateDimensions();
+    }
+    //-----------------------------------------------------------------------------------
+    void NullRenderWindow::reposition( int leftPt, int topPt )
+    {
+        mLeft   = leftPt;
+        mTop    = topPt;
+    }
+    //-----------------------------------------------------------------------------------
+    void NullRenderWindow::copyContentsToMemory( const PixelBox &dst, FrameBuffer buffer )
+    {
+        //There's nothing to read back, return black
+        const size_t pixelSize = PixelUtil::getNumElemBytes( dst.format );
+        const size_t rowSize   = dst.getWidth() * pixelSize;
+
+        for( size_t z=dst.front; z<dst.back; ++z )
+        {
+            for( size_t y=dst.top; y<dst.bottom; ++y )
+            {
+                uint8 *row = static_cast<uint8*>( dst.data ) +
+                             (z * dst.slicePitch + y * dst.rowPitch + dst.left) * pixelSize;
+                memset( row, 0, rowSize );
+            }
+        }
+    }
+}
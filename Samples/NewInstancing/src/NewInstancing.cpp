@@ -36,6 +36,7 @@ static const char *c_instancingTechniques[] =
     "Hardware Instancing Basic",
     "Hardware Instancing + VTF",
     "Limited Animation - Hardware Instancing + VTF",
+    "Hardware Instancing Unified",
     "No Instancing"
 };
 
@@ -46,6 +47,7 @@ static const char *c_materialsTechniques[] =
     "Examples/Instancing/HWBasic/Robot",
     "Examples/Instancing/VTF/HW/Robot",
     "Examples/Instancing/VTF/HW/LUT/Robot",
+    "Examples/Instancing/HWBasic/Robot",
     "Examples/Instancing/ShaderBased/Robot"
 };
 
@@ -56,6 +58,7 @@ static const char *c_materialsTechniques_dq[] =
     "Examples/Instancing/HWBasic/Robot",
     "Examples/Instancing/VTF/HW/Robot_dq",
     "Examples/Instancing/VTF/HW/LUT/Robot_dq",
+    "Examples/Instancing/HWBasic/Robot",
     "Examples/Instancing/ShaderBased/Robot_dq"
 };
 
@@ -66,6 +69,7 @@ static const char *c_materialsTechniques_dq_two_weights[] =
     "Examples/Instancing/HWBasic/spine",
     "Examples/Instancing/VTF/HW/spine_dq_two_weights",
     "Examples/Instancing/VTF/HW/LUT/spine_dq_two_weights",
+    "Examples/Instancing/HWBasic/spine",
     "Examples/Instancing/ShaderBased/spine_dq_two_weights"
 };
 
@@ -268,6 +272,7 @@ void Sample_NewInstancing::switchInstancingTechnique()
         case 2: technique = InstanceManager::HWInstancingBasic; break;
         case 3:
         case 4: technique = InstanceManager::HWInstancingVTF; break;
+        case 5: technique = InstanceManager::HWInstancingUnified; break;
         }
 
         uint16 flags = IM_USEALL;
@@ -310,7 +315,8 @@ void Sample_NewInstancing::switchInstancingTechnique()
     //Show/hide "static" button, and restore config. Do this _after_ createSceneNodes()
     if( mInstancingTechnique == InstanceManager::HWInstancingBasic ||
         mInstancingTechnique == InstanceManager::HWInstancingVTF ||
-        mInstancingTechnique == InstanceManager::HWInstancingVTF + 1) // instancing with lookup
+        mInstancingTechnique == InstanceManager::HWInstancingVTF + 1 || // instancing with lookup
+        mInstancingTechnique == InstanceManager::HWInstancingVTF + 2) // unified
     {
         /**if( mSetStatic->isChecked() )
             mCurrentManager->setBatchesAsStaticAndUpdate( mSetStatic->isChecked() );*/
@@ -379,8 +385,9 @@ void Sample_NewInstancing::createInstancedEntities()
                                         mCurrentMaterialSet[mInstancingTechnique], sceneMemoryMgrType );
             mEntities.push_back( ent );
 
-            //HWInstancingBasic is the only technique without animation support
-            if( mInstancingTechnique != InstanceManager::HWInstancingBasic)
+            //HWInstancingBasic & Unified are the only techniques without animation support
+            if( mInstancingTechnique != InstanceManager::HWInstancingBasic &&
+                mInstancingTechnique != InstanceManager::HWInstancingVTF + 2 )
             {
 #ifndef OGRE_LEGACY_ANIMATIONS
                 //Get the animation
@@ -726,6 +733,7 @@ void Sample_NewInstancing::checkHardwareSupport()
         case 2: technique = InstanceManager::HWInstancingBasic; break;
         case 3: 
         case 4: technique = InstanceManager::HWInstancingVTF; break;
+        case 5: technique = InstanceManager::HWInstancingUnified; break;
         }
 
         uint16 flags = IM_USEALL;
@@ -0,0 +1,176 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __FramePhaseBenchmark_H__
+#define __FramePhaseBenchmark_H__
+
+#include "OgreSceneManager.h"
+#include "OgreSceneManagerEnumerator.h"
+#include "OgreTimer.h"
+#include "Animation/OgreSkeletonAnimation.h"
+
+/** Description of the synthetic scene built by FramePhaseBenchmark.
+@remarks
+    Nodes are arranged in a tree with four children per node, so the number of
+    hierarchy levels (and thus the number of dependent steps in
+    updateAllTransforms) grows with the node count. Entities, lights and
+    skeleton instances are attached to the nodes round robin.
+*/
+struct FramePhaseBenchmarkParams
+{
+    size_t  numNodes;
+    size_t  numEntities;
+    size_t  numSkeletons;
+    /// Bones per skeleton
+    size_t  numBones;
+    size_t  numLights;
+    /// Frames run before timing starts (not reported)
+    size_t  numWarmupFrames;
+    /// Frames timed per thread count
+    size_t  numFrames;
+    /// Half the size of the cube the scene is spread in
+    Ogre::Real  worldExtent;
+    Ogre::vector<size_t>::type threadCounts;
+
+    FramePhaseBenchmarkParams();
+};
+
+/// Exposes the individual (mostly protected) phases of SceneManager::updateSceneGraph
+/// and _cullPhase01 so they can be timed separately.
+class BenchmarkSceneManager : public Ogre::SceneManager
+{
+public:
+    enum Phase
+    {
+        PHASE_UPDATE_ALL_ANIMATIONS,
+        PHASE_UPDATE_ALL_TRANSFORMS,
+        PHASE_UPDATE_ALL_BOUNDS,
+        PHASE_BUILD_LIGHT_LIST,
+        PHASE_CULL_FRUSTUM,
+        PHASE_UPDATE_ALL_LODS,
+        NUM_PHASES
+    };
+
+    /// Microseconds spent in each phase during the last call to runFrame
+    typedef unsigned long PhaseTimes[NUM_PHASES];
+
+    BenchmarkSceneManager( const Ogre::String &name, size_t numWorkerThreads,
+                           Ogre::InstancingThreadedCullingMethod threadedCullingMethod );
+    virtual ~BenchmarkSceneManager();
+
+    virtual const Ogre::String& getTypeName(void) const;
+
+    /** Runs the same steps as updateSceneGraph followed by the culling of _cullPhase01,
+        minus controllers, scene animations, instancing and auto tracking, timing each one.
+    @param camera
+        Camera to cull against and compute the Lods with.
+    @param outTimes
+        Time spent in each phase.
+    */
+    void runFrame( const Ogre::Camera *camera, PhaseTimes &outTimes );
+
+    /// Number of objects that passed frustum culling in the last call to runFrame
+    size_t getNumVisibleObjects(void) const;
+
+    static const char* getPhaseName( Phase phase );
+
+protected:
+    Ogre::Timer mTimer;
+};
+
+class BenchmarkSceneManagerFactory : public Ogre::SceneManagerFactory
+{
+protected:
+    void initMetaData(void) const;
+public:
+    static const Ogre::String FACTORY_TYPE_NAME;
+
+    Ogre::SceneManager* createInstance( const Ogre::String &instanceName, size_t numWorkerThreads,
+                                        Ogre::InstancingThreadedCullingMethod threadedCullingMethod );
+    void destroyInstance( Ogre::SceneManager *instance );
+};
+
+/** Times the phases of the v2 scene pipeline on a synthetic scene, once per
+    thread count, and writes the results as JSON.
+@remarks
+    Root must be initialised and a render window created (the Null RenderSystem is
+    enough) before calling run, since entities need hardware buffers.
+*/
+class FramePhaseBenchmark
+{
+public:
+    struct PhaseStats
+    {
+        unsigned long   minTime;
+        unsigned long   maxTime;
+        Ogre::uint64    totalTime;
+
+        PhaseStats();
+        void addSample( unsigned long time );
+    };
+
+    struct Result
+    {
+        size_t      numThreads;
+        size_t      numVisibleObjects;
+        PhaseStats  phases[BenchmarkSceneManager::NUM_PHASES];
+    };
+
+    typedef Ogre::vector<Result>::type ResultVec;
+
+protected:
+    FramePhaseBenchmarkParams   mParams;
+    BenchmarkSceneManagerFactory mFactory;
+    ResultVec                   mResults;
+    Ogre::SkeletonDefPtr        mSkeletonDef;
+    /// Deterministic so runs with different thread counts see the same scene
+    Ogre::uint32                mRandomState;
+
+    Ogre::Real randomReal( Ogre::Real minVal, Ogre::Real maxVal );
+
+    /// Creates the skeleton used by all skeleton instances: a binary tree of
+    /// mParams.numBones bones with a looping animation on every bone.
+    void createSkeletonDef(void);
+
+    void buildScene( BenchmarkSceneManager *sceneManager, Ogre::Camera *camera,
+                     Ogre::vector<Ogre::SkeletonAnimation*>::type &outAnimations );
+
+    Result runThreadCount( size_t numThreads );
+
+public:
+    FramePhaseBenchmark( const FramePhaseBenchmarkParams &params );
+    ~FramePhaseBenchmark();
+
+    void run(void);
+
+    const ResultVec& getResults(void) const         { return mResults; }
+
+    /// Writes the parameters and the results of the last run as a JSON object
+    void writeJson( std::ostream &out ) const;
+};
+
+#endif
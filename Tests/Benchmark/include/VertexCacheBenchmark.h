@@ -0,0 +1,99 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __VertexCacheBenchmark_H__
+#define __VertexCacheBenchmark_H__
+
+#include "OgreMesh.h"
+#include "OgreStringVector.h"
+#include "OgreTimer.h"
+#include "OgreMeshOptimiser.h"
+
+struct VertexCacheBenchmarkParams
+{
+    /// Directories searched (non recursively) for .mesh files
+    Ogre::StringVector  mediaDirs;
+    /// Size of the FIFO cache the ACMR is measured with
+    size_t              cacheSize;
+
+    VertexCacheBenchmarkParams();
+};
+
+/** Loads every .mesh file in the given directories and reports the average cache
+    miss ratio (ACMR) of their triangle lists before and after Mesh::optimiseVertexCache,
+    as JSON.
+@remarks
+    Root must be initialised with a RenderSystem that provides readable hardware
+    buffers (the Null RenderSystem does) before calling run.
+*/
+class VertexCacheBenchmark
+{
+public:
+    struct Result
+    {
+        Ogre::String    meshName;
+        /// Set when the mesh couldn't be loaded; the rest of the fields are then zero
+        Ogre::String    error;
+        size_t          numTriangles;
+        size_t          numVertices;
+        Ogre::Real      acmrBefore;
+        /// After reordering triangles & vertices
+        Ogre::Real      acmrOptimised;
+        /// After also reordering for overdraw
+        Ogre::Real      acmrOverdraw;
+        /// Microseconds spent in Mesh::optimiseVertexCache
+        unsigned long   optimiseTime;
+        unsigned long   overdrawTime;
+
+        Result();
+    };
+
+    typedef Ogre::vector<Result>::type ResultVec;
+
+protected:
+    VertexCacheBenchmarkParams  mParams;
+    ResultVec                   mResults;
+    Ogre::Timer                 mTimer;
+
+    /// ACMR of all the triangle lists in the mesh, weighted by their triangle count
+    Ogre::Real calculateAcmr( const Ogre::MeshPtr &mesh, size_t &outNumTriangles ) const;
+    size_t countVertices( const Ogre::MeshPtr &mesh ) const;
+
+    Result runMesh( const Ogre::String &meshName, const Ogre::String &groupName );
+
+public:
+    VertexCacheBenchmark( const VertexCacheBenchmarkParams &params );
+
+    void run(void);
+
+    const ResultVec& getResults(void) const         { return mResults; }
+
+    /// Writes the parameters and the results of the last run as a JSON object
+    void writeJson( std::ostream &out ) const;
+};
+
+#endif
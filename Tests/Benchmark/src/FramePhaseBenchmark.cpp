@@ -0,0 +1,411 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "FramePhaseBenchmark.h"
+
+#include "OgreRoot.h"
+#include "OgreCamera.h"
+#include "OgreEntity.h"
+#include "OgreLight.h"
+#include "OgreSceneNode.h"
+#include "OgreSkeleton.h"
+#include "OgreOldSkeletonManager.h"
+#include "OgreOldBone.h"
+#include "OgreAnimation.h"
+#include "OgreAnimationTrack.h"
+#include "OgreKeyFrame.h"
+#include "Animation/OgreSkeletonManager.h"
+#include "Animation/OgreSkeletonInstance.h"
+
+#include <limits>
+
+using namespace Ogre;
+
+FramePhaseBenchmarkParams::FramePhaseBenchmarkParams() :
+    numNodes( 10000 ),
+    numEntities( 10000 ),
+    numSkeletons( 500 ),
+    numBones( 32 ),
+    numLights( 64 ),
+    numWarmupFrames( 10 ),
+    numFrames( 100 ),
+    worldExtent( 5000.0f )
+{
+    threadCounts.push_back( 1 );
+    threadCounts.push_back( 2 );
+    threadCounts.push_back( 4 );
+}
+//-----------------------------------------------------------------------------------
+//-----------------------------------------------------------------------------------
+//-----------------------------------------------------------------------------------
+BenchmarkSceneManager::BenchmarkSceneManager( const String &name, size_t numWorkerThreads,
+                                              InstancingThreadedCullingMethod threadedCullingMethod ) :
+    SceneManager( name, numWorkerThreads, threadedCullingMethod )
+{
+}
+//-----------------------------------------------------------------------------------
+BenchmarkSceneManager::~BenchmarkSceneManager()
+{
+}
+//-----------------------------------------------------------------------------------
+const String& BenchmarkSceneManager::getTypeName(void) const
+{
+    return BenchmarkSceneManagerFactory::FACTORY_TYPE_NAME;
+}
+//-----------------------------------------------------------------------------------
+void BenchmarkSceneManager::runFrame( const Camera *camera, PhaseTimes &outTimes )
+{
+    const uint8 firstRq = 0;
+    const uint8 lastRq  = std::numeric_limits<uint8>::max();
+
+    highLevelCull();
+
+    mTimer.reset();
+    updateAllTransforms();
+    outTimes[PHASE_UPDATE_ALL_TRANSFORMS] = mTimer.getMicroseconds();
+
+    mTimer.reset();
+    updateAllAnimations();
+    outTimes[PHASE_UPDATE_ALL_ANIMATIONS] = mTimer.getMicroseconds();
+
+    mTimer.reset();
+    updateAllBounds( mEntitiesMemoryManagerUpdateList );
+    updateAllBounds( mLightsMemoryManagerCulledList );
+    outTimes[PHASE_UPDATE_ALL_BOUNDS] = mTimer.getMicroseconds();
+
+    mTimer.reset();
+    buildLightList();
+    outTimes[PHASE_BUILD_LIGHT_LIST] = mTimer.getMicroseconds();
+
+    mTimer.reset();
+    CullFrustumRequest cullRequest = createCullFrustumRequest( camera, camera,
+                                                               std::numeric_limits<uint32>::max(),
+                                                               firstRq, lastRq );
+    fireCullFrustumThreads( cullRequest, true );
+    outTimes[PHASE_CULL_FRUSTUM] = mTimer.getMicroseconds();
+
+    mTimer.reset();
+    updateAllLods( camera, 1.0f, firstRq, lastRq );
+    outTimes[PHASE_UPDATE_ALL_LODS] = mTimer.getMicroseconds();
+}
+//-----------------------------------------------------------------------------------
+size_t BenchmarkSceneManager::getNumVisibleObjects(void) const
+{
+    size_t retVal = 0;
+
+    VisibleObjectsPerThreadArray::const_iterator itor = mVisibleObjects.begin();
+    VisibleObjectsPerThreadArray::const_iterator end  = mVisibleObjects.end();
+
+    while( itor != end )
+    {
+        retVal += itor->size();
+        ++itor;
+    }
+
+    return retVal;
+}
+//-----------------------------------------------------------------------------------
+const char* BenchmarkSceneManager::getPhaseName( Phase phase )
+{
+    static const char *names[NUM_PHASES] =
+    {
+        "updateAllAnimations",
+        "updateAllTransforms",
+        "updateAllBounds",
+        "buildLightList",
+        "cullFrustum",
+        "updateAllLods"
+    };
+
+    return names[phase];
+}
+//-----------------------------------------------------------------------------------
+//-----------------------------------------------------------------------------------
+//-----------------------------------------------------------------------------------
+const String BenchmarkSceneManagerFactory::FACTORY_TYPE_NAME = "BenchmarkSceneManager";
+//-----------------------------------------------------------------------------------
+void BenchmarkSceneManagerFactory::initMetaData(void) const
+{
+    mMetaData.typeName = FACTORY_TYPE_NAME;
+    mMetaData.description = "Default scene manager with its update phases exposed for timing";
+    mMetaData.sceneTypeMask = 0; //Never picked by type mask
+    mMetaData.worldGeometrySupported = false;
+}
+//-----------------------------------------------------------------------------------
+SceneManager* BenchmarkSceneManagerFactory::createInstance(
+        const String &instanceName, size_t numWorkerThreads,
+        InstancingThreadedCullingMethod threadedCullingMethod )
+{
+    return OGRE_NEW BenchmarkSceneManager( instanceName, numWorkerThreads, threadedCullingMethod );
+}
+//-----------------------------------------------------------------------------------
+void BenchmarkSceneManagerFactory::destroyInstance( SceneManager *instance )
+{
+    OGRE_DELETE instance;
+}
+//-----------------------------------------------------------------------------------
+//-----------------------------------------------------------------------------------
+//-----------------------------------------------------------------------------------
+FramePhaseBenchmark::PhaseStats::PhaseStats() :
+    minTime( std::numeric_limits<unsigned long>::max() ),
+    maxTime( 0 ),
+    totalTime( 0 )
+{
+}
+//-----------------------------------------------------------------------------------
+void FramePhaseBenchmark::PhaseStats::addSample( unsigned long time )
+{
+    minTime = std::min( minTime, time );
+    maxTime = std::max( maxTime, time );
+    totalTime += time;
+}
+//-----------------------------------------------------------------------------------
+//-----------------------------------------------------------------------------------
+//-----------------------------------------------------------------------------------
+FramePhaseBenchmark::FramePhaseBenchmark( const FramePhaseBenchmarkParams &params ) :
+    mParams( params ),
+    mRandomState( 0 )
+{
+    Root::getSingleton().addSceneManagerFactory( &mFactory );
+}
+//-----------------------------------------------------------------------------------
+FramePhaseBenchmark::~FramePhaseBenchmark()
+{
+    Root::getSingleton().removeSceneManagerFactory( &mFactory );
+}
+//-----------------------------------------------------------------------------------
+Real FramePhaseBenchmark::randomReal( Real minVal, Real maxVal )
+{
+    //Numerical Recipes' LCG. We don't use Math::RangeRandom because the
+    //scene must be the same for every thread count.
+    mRandomState = mRandomState * 1664525u + 1013904223u;
+    return minVal + (maxVal - minVal) * Real( mRandomState >> 8u ) / Real( 1u << 24u );
+}
+//-----------------------------------------------------------------------------------
+void FramePhaseBenchmark::createSkeletonDef(void)
+{
+    const String skeletonName = "FramePhaseBenchmark/Skeleton";
+
+    SkeletonPtr skeleton = OldSkeletonManager::getSingleton().create(
+                skeletonName, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, true );
+
+    const size_t numBones = std::max<size_t>( mParams.numBones, 1 );
+
+    Animation *animation = skeleton->createAnimation( "Benchmark", 1.0f );
+
+    for( size_t i=0; i<numBones; ++i )
+    {
+        OldBone *bone;
+        if( i == 0 )
+        {
+            bone = skeleton->createBone( static_cast<unsigned short>( i ) );
+        }
+        else
+        {
+            OldBone *parent = skeleton->getBone( static_cast<unsigned short>( (i - 1) / 2 ) );
+            bone = parent->createChild( static_cast<unsigned short>( i ), Vector3::UNIT_Y );
+        }
+
+        OldNodeAnimationTrack *track = animation->createOldNodeTrack(
+                                                static_cast<unsigned short>( i ), bone );
+        for( size_t j=0; j<3; ++j )
+        {
+            TransformKeyFrame *keyFrame = track->createNodeKeyFrame( j * 0.5f );
+            keyFrame->setRotation( Quaternion( Radian( (j == 1) ? 0.5f : 0.0f ), Vector3::UNIT_X ) );
+        }
+    }
+
+    skeleton->setBindingPose();
+
+    mSkeletonDef = SkeletonManager::getSingleton().getSkeletonDef( skeleton.get() );
+}
+//-----------------------------------------------------------------------------------
+void FramePhaseBenchmark::buildScene( BenchmarkSceneManager *sceneManager, Camera *camera,
+                                      vector<SkeletonAnimation*>::type &outAnimations )
+{
+    mRandomState = 0;
+
+    const Real extent = mParams.worldExtent;
+
+    camera->setPosition( Vector3( 0, extent * 0.5f, extent * 1.5f ) );
+    camera->lookAt( Vector3::ZERO );
+    camera->setNearClipDistance( 1.0f );
+    camera->setFarClipDistance( extent * 4.0f );
+    camera->setAspectRatio( 16.0f / 9.0f );
+
+    //Each node has 4 children. Children are placed close to their parents.
+    vector<SceneNode*>::type nodes;
+    nodes.reserve( mParams.numNodes );
+    for( size_t i=0; i<mParams.numNodes; ++i )
+    {
+        SceneNode *parent = i == 0 ? sceneManager->getRootSceneNode() : nodes[(i - 1) / 4];
+        const Real spread = i == 0 ? extent : extent * 0.1f;
+        SceneNode *node = parent->createChildSceneNode( SCENE_DYNAMIC,
+                                                        Vector3( randomReal( -spread, spread ),
+                                                                 randomReal( -spread, spread ),
+                                                                 randomReal( -spread, spread ) ) );
+        node->setOrientation( Quaternion( Radian( randomReal( 0, Math::TWO_PI ) ),
+                                          Vector3::UNIT_Y ) );
+        nodes.push_back( node );
+    }
+
+    if( nodes.empty() )
+        nodes.push_back( sceneManager->getRootSceneNode() );
+
+    for( size_t i=0; i<mParams.numEntities; ++i )
+    {
+        Entity *entity = sceneManager->createEntity( SceneManager::PT_CUBE );
+        nodes[i % nodes.size()]->attachObject( entity );
+    }
+
+    for( size_t i=0; i<mParams.numLights; ++i )
+    {
+        Light *light = sceneManager->createLight();
+        light->setType( Light::LT_POINT );
+        light->setAttenuationBasedOnRadius( extent * 0.1f, 0.00192f );
+        nodes[(i * 7) % nodes.size()]->attachObject( light );
+    }
+
+    if( mParams.numSkeletons && mSkeletonDef.isNull() )
+        createSkeletonDef();
+
+    for( size_t i=0; i<mParams.numSkeletons; ++i )
+    {
+        SkeletonInstance *skeletonInstance = sceneManager->createSkeletonInstance( mSkeletonDef.get() );
+        skeletonInstance->setParentNode( nodes[(i * 3) % nodes.size()] );
+
+        SkeletonAnimation *animation = skeletonInstance->getAnimation( "Benchmark" );
+        animation->setEnabled( true );
+        animation->setLoop( true );
+        //Desync the instances so they don't all sample the same keyframes
+        animation->addTime( randomReal( 0, 1 ) );
+        outAnimations.push_back( animation );
+    }
+}
+//-----------------------------------------------------------------------------------
+FramePhaseBenchmark::Result FramePhaseBenchmark::runThreadCount( size_t numThreads )
+{
+    Result result;
+    result.numThreads = numThreads;
+
+    BenchmarkSceneManager *sceneManager = static_cast<BenchmarkSceneManager*>(
+                Root::getSingleton().createSceneManager( BenchmarkSceneManagerFactory::FACTORY_TYPE_NAME,
+                                                         numThreads,
+                                                         INSTANCING_CULLING_SINGLETHREAD ) );
+
+    Camera *camera = sceneManager->createCamera( "FramePhaseBenchmark" );
+
+    vector<SkeletonAnimation*>::type animations;
+    buildScene( sceneManager, camera, animations );
+
+    const Real timeSinceLast = 1.0f / 60.0f;
+    const size_t totalFrames = mParams.numWarmupFrames + mParams.numFrames;
+
+    for( size_t frame=0; frame<totalFrames; ++frame )
+    {
+        vector<SkeletonAnimation*>::type::const_iterator itor = animations.begin();
+        vector<SkeletonAnimation*>::type::const_iterator end  = animations.end();
+        while( itor != end )
+            (*itor++)->addTime( timeSinceLast );
+
+        BenchmarkSceneManager::PhaseTimes times;
+        sceneManager->runFrame( camera, times );
+
+        if( frame >= mParams.numWarmupFrames )
+        {
+            for( size_t i=0; i<BenchmarkSceneManager::NUM_PHASES; ++i )
+                result.phases[i].addSample( times[i] );
+        }
+    }
+
+    result.numVisibleObjects = sceneManager->getNumVisibleObjects();
+
+    Root::getSingleton().destroySceneManager( sceneManager );
+
+    return result;
+}
+//-----------------------------------------------------------------------------------
+void FramePhaseBenchmark::run(void)
+{
+    mResults.clear();
+
+    vector<size_t>::type::const_iterator itor = mParams.threadCounts.begin();
+    vector<size_t>::type::const_iterator end  = mParams.threadCounts.end();
+
+    while( itor != end )
+    {
+        mResults.push_back( runThreadCount( *itor ) );
+        ++itor;
+    }
+}
+//-----------------------------------------------------------------------------------
+void FramePhaseBenchmark::writeJson( std::ostream &out ) const
+{
+    out << "{\n";
+    out << "  \"scene\": {\n";
+    out << "    \"nodes\": " << mParams.numNodes << ",\n";
+    out << "    \"entities\": " << mParams.numEntities << ",\n";
+    out << "    \"skeletons\": " << mParams.numSkeletons << ",\n";
+    out << "    \"bonesPerSkeleton\": " << mParams.numBones << ",\n";
+    out << "    \"lights\": " << mParams.numLights << ",\n";
+    out << "    \"warmupFrames\": " << mParams.numWarmupFrames << ",\n";
+    out << "    \"frames\": " << mParams.numFrames << "\n";
+    out << "  },\n";
+    out << "  \"results\": [";
+
+    for( size_t i=0; i<mResults.size(); ++i )
+    {
+        const Result &result = mResults[i];
+
+        out << (i ? ",\n" : "\n");
+        out << "    {\n";
+        out << "      \"threads\": " << result.numThreads << ",\n";
+        out << "      \"visibleObjects\": " << result.numVisibleObjects << ",\n";
+        out << "      \"phases\": {";
+
+        for( size_t j=0; j<BenchmarkSceneManager::NUM_PHASES; ++j )
+        {
+            const PhaseStats &stats = result.phases[j];
+            const double avgTime = mParams.numFrames ?
+                        double( stats.totalTime ) / double( mParams.numFrames ) : 0.0;
+
+            out << (j ? ",\n" : "\n");
+            out << "        \"" << BenchmarkSceneManager::getPhaseName(
+                                            static_cast<BenchmarkSceneManager::Phase>( j ) )
+                << "\": { \"avgUs\": " << avgTime
+                << ", \"minUs\": " << (mParams.numFrames ? stats.minTime : 0)
+                << ", \"maxUs\": " << stats.maxTime << " }";
+        }
+
+        out << "\n      }\n";
+        out << "    }";
+    }
+
+    out << "\n  ]\n";
+    out << "}\n";
+}
@@ -0,0 +1,216 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "VertexCacheBenchmark.h"
+
+#include "OgreMeshManager.h"
+#include "OgreSubMesh.h"
+#include "OgreResourceGroupManager.h"
+#include "OgreVertexIndexData.h"
+
+using namespace Ogre;
+
+VertexCacheBenchmarkParams::VertexCacheBenchmarkParams() :
+    cacheSize( MeshOptimiser::FIFO_CACHE_SIZE )
+{
+}
+//-----------------------------------------------------------------------------------
+VertexCacheBenchmark::Result::Result() :
+    numTriangles( 0 ),
+    numVertices( 0 ),
+    acmrBefore( 0 ),
+    acmrOptimised( 0 ),
+    acmrOverdraw( 0 ),
+    optimiseTime( 0 ),
+    overdrawTime( 0 )
+{
+}
+//-----------------------------------------------------------------------------------
+//-----------------------------------------------------------------------------------
+//-----------------------------------------------------------------------------------
+VertexCacheBenchmark::VertexCacheBenchmark( const VertexCacheBenchmarkParams &params ) :
+    mParams( params )
+{
+}
+//-----------------------------------------------------------------------------------
+Real VertexCacheBenchmark::calculateAcmr( const MeshPtr &mesh, size_t &outNumTriangles ) const
+{
+    Real misses = 0;
+    outNumTriangles = 0;
+
+    for( unsigned short i=0; i<mesh->getNumSubMeshes(); ++i )
+    {
+        const SubMesh *subMesh = mesh->getSubMesh( i );
+        if( subMesh->operationType == RenderOperation::OT_TRIANGLE_LIST )
+        {
+            const size_t numTriangles = subMesh->indexData->indexCount / 3;
+            misses += MeshOptimiser::calculateAcmr( subMesh->indexData, mParams.cacheSize ) * numTriangles;
+            outNumTriangles += numTriangles;
+        }
+    }
+
+    return outNumTriangles ? misses / outNumTriangles : 0;
+}
+//-----------------------------------------------------------------------------------
+size_t VertexCacheBenchmark::countVertices( const MeshPtr &mesh ) const
+{
+    size_t numVertices = mesh->sharedVertexData ? mesh->sharedVertexData->vertexCount : 0;
+
+    for( unsigned short i=0; i<mesh->getNumSubMeshes(); ++i )
+    {
+        const SubMesh *subMesh = mesh->getSubMesh( i );
+        if( !subMesh->useSharedVertices )
+            numVertices += subMesh->vertexData->vertexCount;
+    }
+
+    return numVertices;
+}
+//-----------------------------------------------------------------------------------
+VertexCacheBenchmark::Result VertexCacheBenchmark::runMesh( const String &meshName,
+                                                            const String &groupName )
+{
+    Result result;
+    result.meshName = meshName;
+
+    MeshManager &meshManager = MeshManager::getSingleton();
+
+    try
+    {
+        //Readable buffers, so the optimiser can access them
+        MeshPtr mesh = meshManager.load( meshName, groupName,
+                                         HardwareBuffer::HBU_STATIC, HardwareBuffer::HBU_STATIC,
+                                         true, true );
+        MeshPtr overdrawMesh = mesh->clone( meshName + "/VertexCacheBenchmark/Overdraw" );
+
+        result.numVertices  = countVertices( mesh );
+        result.acmrBefore   = calculateAcmr( mesh, result.numTriangles );
+
+        mTimer.reset();
+        mesh->optimiseVertexCache( true, false );
+        result.optimiseTime = mTimer.getMicroseconds();
+
+        mTimer.reset();
+        overdrawMesh->optimiseVertexCache( true, true );
+        result.overdrawTime = mTimer.getMicroseconds();
+
+        size_t numTriangles;
+        result.acmrOptimised    = calculateAcmr( mesh, numTriangles );
+        result.acmrOverdraw     = calculateAcmr( overdrawMesh, numTriangles );
+
+        meshManager.remove( overdrawMesh->getHandle() );
+        meshManager.remove( mesh->getHandle() );
+    }
+    catch( Exception &e )
+    {
+        result = Result();
+        result.meshName = meshName;
+        result.error    = e.getDescription();
+    }
+
+    return result;
+}
+//-----------------------------------------------------------------------------------
+void VertexCacheBenchmark::run(void)
+{
+    mResults.clear();
+
+    const String groupName( "VertexCacheBenchmark" );
+    ResourceGroupManager &resourceGroupManager = ResourceGroupManager::getSingleton();
+    resourceGroupManager.createResourceGroup( groupName, false );
+
+    for( size_t i=0; i<mParams.mediaDirs.size(); ++i )
+        resourceGroupManager.addResourceLocation( mParams.mediaDirs[i], "FileSystem", groupName );
+
+    resourceGroupManager.initialiseResourceGroup( groupName );
+
+    StringVectorPtr meshNames = resourceGroupManager.findResourceNames( groupName, "*.mesh" );
+    std::sort( meshNames->begin(), meshNames->end() );
+
+    for( size_t i=0; i<meshNames->size(); ++i )
+        mResults.push_back( runMesh( (*meshNames)[i], groupName ) );
+
+    resourceGroupManager.destroyResourceGroup( groupName );
+}
+//-----------------------------------------------------------------------------------
+void VertexCacheBenchmark::writeJson( std::ostream &out ) const
+{
+    size_t totalTriangles = 0;
+    Real totalMissesBefore = 0;
+    Real totalMissesOptimised = 0;
+    Real totalMissesOverdraw = 0;
+
+    out << "{\n";
+    out << "  \"cacheSize\": " << mParams.cacheSize << ",\n";
+    out << "  \"meshes\": [";
+
+    for( size_t i=0; i<mResults.size(); ++i )
+    {
+        const Result &result = mResults[i];
+
+        out << (i ? ",\n" : "\n");
+        out << "    {\n";
+        out << "      \"name\": \"" << result.meshName << "\",\n";
+
+        if( !result.error.empty() )
+        {
+            String error( result.error );
+            StringUtil::trim( error );
+            error = StringUtil::replaceAll( StringUtil::replaceAll( error, "\\", "\\\\" ),
+                                            "\"", "\\\"" );
+            out << "      \"error\": \"" << error << "\"\n";
+        }
+        else
+        {
+            out << "      \"triangles\": " << result.numTriangles << ",\n";
+            out << "      \"vertices\": " << result.numVertices << ",\n";
+            out << "      \"acmrBefore\": " << result.acmrBefore << ",\n";
+            out << "      \"acmrOptimised\": " << result.acmrOptimised << ",\n";
+            out << "      \"acmrOverdraw\": " << result.acmrOverdraw << ",\n";
+            out << "      \"optimiseUs\": " << result.optimiseTime << ",\n";
+            out << "      \"overdrawUs\": " << result.overdrawTime << "\n";
+
+            totalTriangles          += result.numTriangles;
+            totalMissesBefore       += result.acmrBefore * result.numTriangles;
+            totalMissesOptimised    += result.acmrOptimised * result.numTriangles;
+            totalMissesOverdraw     += result.acmrOverdraw * result.numTriangles;
+        }
+
+        out << "    }";
+    }
+
+    const Real invTriangles = totalTriangles ? Real( 1 ) / totalTriangles : Real( 0 );
+
+    out << "\n  ],\n";
+    out << "  \"total\": {\n";
+    out << "    \"triangles\": " << totalTriangles << ",\n";
+    out << "    \"acmrBefore\": " << totalMissesBefore * invTriangles << ",\n";
+    out << "    \"acmrOptimised\": " << totalMissesOptimised * invTriangles << ",\n";
+    out << "    \"acmrOverdraw\": " << totalMissesOverdraw * invTriangles << "\n";
+    out << "  }\n";
+    out << "}\n";
+}
@@ -0,0 +1,141 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreRoot.h"
+#include "OgreLogManager.h"
+#include "OgreRenderSystem.h"
+#include "OgreStringConverter.h"
+#include "VertexCacheBenchmark.h"
+
+#ifdef OGRE_STATIC_LIB
+#   include "OgreNullPlugin.h"
+#endif
+
+#include <iostream>
+#include <fstream>
+
+using namespace Ogre;
+
+namespace
+{
+    void printUsage(void)
+    {
+        std::cerr << "Usage: VertexCacheBenchmark [options]\n"
+                     "  --media DIR        Directory with .mesh files. Can be repeated.\n"
+                     "                     Defaults to Tests/Media and Samples/Media/models\n"
+                     "  --cache N          FIFO cache size used to measure the ACMR\n"
+                     "  --output FILE      Write the JSON results to FILE instead of stdout\n";
+    }
+}
+
+int main( int argc, char *argv[] )
+{
+    VertexCacheBenchmarkParams params;
+    String outputFile;
+
+    for( int i=1; i<argc; ++i )
+    {
+        const String arg( argv[i] );
+        if( i + 1 >= argc )
+        {
+            printUsage();
+            return 1;
+        }
+
+        const String value( argv[++i] );
+
+        if( arg == "--media" )
+            params.mediaDirs.push_back( value );
+        else if( arg == "--cache" )
+            params.cacheSize = std::max( 1u, StringConverter::parseUnsignedInt( value ) );
+        else if( arg == "--output" )
+            outputFile = value;
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if( params.mediaDirs.empty() )
+    {
+        params.mediaDirs.push_back( OGRE_BENCHMARK_SOURCE_DIR "/Tests/Media" );
+        params.mediaDirs.push_back( OGRE_BENCHMARK_SOURCE_DIR "/Samples/Media/models" );
+    }
+
+    //Create the log ourselves so it doesn't go to the console, where it
+    //would get mixed with the JSON output.
+    LogManager *logManager = OGRE_NEW LogManager();
+    logManager->createLog( "VertexCacheBenchmark.log", true, false, false );
+
+    int retVal = 0;
+
+    try
+    {
+#ifdef OGRE_STATIC_LIB
+        //Must outlive Root, which uninstalls it
+        NullPlugin nullPlugin;
+#endif
+        Root root( "", "", "" );
+
+#ifdef OGRE_STATIC_LIB
+        root.installPlugin( &nullPlugin );
+#else
+        root.loadPlugin( "RenderSystem_Null" + String( OGRE_BUILD_SUFFIX ) );
+#endif
+
+        //The Null RenderSystem keeps hardware buffers in system memory, so they're readable
+        root.setRenderSystem( root.getAvailableRenderers().front() );
+        root.initialise( false );
+        root.createRenderWindow( "VertexCacheBenchmark", 64, 64, false );
+
+        {
+            VertexCacheBenchmark benchmark( params );
+            benchmark.run();
+
+            if( outputFile.empty() )
+            {
+                benchmark.writeJson( std::cout );
+            }
+            else
+            {
+                std::ofstream outFile( outputFile.c_str() );
+                benchmark.writeJson( outFile );
+            }
+        }
+    }
+    catch( Exception &e )
+    {
+        std::cerr << "Benchmark failed: " << e.getFullDescription() << std::endl;
+        retVal = 1;
+    }
+
+    OGRE_DELETE logManager;
+
+    return retVal;
+}
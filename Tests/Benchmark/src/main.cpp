@@ -0,0 +1,159 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreRoot.h"
+#include "OgreLogManager.h"
+#include "OgreRenderSystem.h"
+#include "OgreStringConverter.h"
+#include "OgreResourceGroupManager.h"
+#include "FramePhaseBenchmark.h"
+
+#ifdef OGRE_STATIC_LIB
+#   include "OgreNullPlugin.h"
+#endif
+
+#include <iostream>
+#include <fstream>
+
+using namespace Ogre;
+
+namespace
+{
+    void printUsage(void)
+    {
+        std::cerr << "Usage: FramePhaseBenchmark [options]\n"
+                     "  --nodes N          Number of scene nodes\n"
+                     "  --entities M       Number of entities\n"
+                     "  --skeletons K      Number of skeleton instances\n"
+                     "  --bones B          Bones per skeleton\n"
+                     "  --lights L         Number of point lights\n"
+                     "  --frames F         Frames timed per thread count\n"
+                     "  --warmup W         Untimed frames run before timing\n"
+                     "  --threads 1,2,4    Comma separated list of worker thread counts\n"
+                     "  --output FILE      Write the JSON results to FILE instead of stdout\n";
+    }
+}
+
+int main( int argc, char *argv[] )
+{
+    FramePhaseBenchmarkParams params;
+    String outputFile;
+
+    for( int i=1; i<argc; ++i )
+    {
+        const String arg( argv[i] );
+        if( i + 1 >= argc )
+        {
+            printUsage();
+            return 1;
+        }
+
+        const String value( argv[++i] );
+
+        if( arg == "--nodes" )
+            params.numNodes = StringConverter::parseUnsignedInt( value );
+        else if( arg == "--entities" )
+            params.numEntities = StringConverter::parseUnsignedInt( value );
+        else if( arg == "--skeletons" )
+            params.numSkeletons = StringConverter::parseUnsignedInt( value );
+        else if( arg == "--bones" )
+            params.numBones = StringConverter::parseUnsignedInt( value );
+        else if( arg == "--lights" )
+            params.numLights = StringConverter::parseUnsignedInt( value );
+        else if( arg == "--frames" )
+            params.numFrames = StringConverter::parseUnsignedInt( value );
+        else if( arg == "--warmup" )
+            params.numWarmupFrames = StringConverter::parseUnsignedInt( value );
+        else if( arg == "--output" )
+            outputFile = value;
+        else if( arg == "--threads" )
+        {
+            params.threadCounts.clear();
+            StringVector counts = StringUtil::split( value, "," );
+            for( size_t j=0; j<counts.size(); ++j )
+                params.threadCounts.push_back( std::max( 1u, StringConverter::parseUnsignedInt( counts[j] ) ) );
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    //Create the log ourselves so it doesn't go to the console, where it
+    //would get mixed with the JSON output.
+    LogManager *logManager = OGRE_NEW LogManager();
+    logManager->createLog( "FramePhaseBenchmark.log", true, false, false );
+
+    int retVal = 0;
+
+    try
+    {
+#ifdef OGRE_STATIC_LIB
+        //Must outlive Root, which uninstalls it
+        NullPlugin nullPlugin;
+#endif
+        Root root( "", "", "" );
+
+#ifdef OGRE_STATIC_LIB
+        root.installPlugin( &nullPlugin );
+#else
+        root.loadPlugin( "RenderSystem_Null" + String( OGRE_BUILD_SUFFIX ) );
+#endif
+
+        root.setRenderSystem( root.getAvailableRenderers().front() );
+        root.initialise( false );
+        //Entities need hardware buffers, which the RenderSystem creates with the first window
+        root.createRenderWindow( "FramePhaseBenchmark", 1280, 720, false );
+        ResourceGroupManager::getSingleton().initialiseAllResourceGroups();
+
+        {
+            FramePhaseBenchmark benchmark( params );
+            benchmark.run();
+
+            if( outputFile.empty() )
+            {
+                benchmark.writeJson( std::cout );
+            }
+            else
+            {
+                std::ofstream outFile( outputFile.c_str() );
+                benchmark.writeJson( outFile );
+            }
+        }
+    }
+    catch( Exception &e )
+    {
+        std::cerr << "Benchmark failed: " << e.getFullDescription() << std::endl;
+        retVal = 1;
+    }
+
+    OGRE_DELETE logManager;
+
+    return retVal;
+}
@@ -46,6 +46,8 @@ class MeshLodTests : public CppUnit::TestFixture
     CPPUNIT_TEST(testLodConfigSerializer);
     CPPUNIT_TEST(testMeshLodGenerator);
     CPPUNIT_TEST(testManualLodLevels);
+    CPPUNIT_TEST(testParallelProcessing);
+    CPPUNIT_TEST(testCollapseCostHeap);
     CPPUNIT_TEST_SUITE_END();
 
 #ifdef OGRE_STATIC_LIB
@@ -60,8 +62,11 @@ public:
     void testMeshLodGenerator();
     void testManualLodLevels();
     void testQuadricError();
+    void testParallelProcessing();
+    void testCollapseCostHeap();
     void runMeshLodConfigTests(LodConfig::Advanced& advanced);
     void blockedWaitForLodGeneration(const MeshPtr& mesh);
+    void assertLodIndicesEqual(Mesh* a, Mesh* b);
     void addProfile(LodConfig& config);
     void setTestLodConfig(LodConfig& config);
     bool isEqual(Real a, Real b);
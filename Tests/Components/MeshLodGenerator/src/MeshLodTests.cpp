@@ -18,6 +18,7 @@
 #include "OgreRenderWindow.h"
 #include "OgreLodConfigSerializer.h"
 #include "OgreWorkQueue.h"
+#include "OgreLodData.h"
 
 #include "UnitTestSuite.h"
 
@@ -245,6 +246,168 @@ void MeshLodTests::testQuadricError()
     gen.generateLodLevels(config, LodCollapseCostPtr(new LodCollapseCostQuadric()));
 }
 //--------------------------------------------------------------------------
+void MeshLodTests::assertLodIndicesEqual(Mesh* a, Mesh* b)
+{
+    CPPUNIT_ASSERT_EQUAL(a->getNumLodLevels(), b->getNumLodLevels());
+    CPPUNIT_ASSERT_EQUAL(a->getNumSubMeshes(), b->getNumSubMeshes());
+    for (unsigned short i = 0; i < a->getNumSubMeshes(); i++)
+    {
+        SubMesh::LODFaceList& aFaces = a->getSubMesh(i)->mLodFaceList;
+        SubMesh::LODFaceList& bFaces = b->getSubMesh(i)->mLodFaceList;
+        CPPUNIT_ASSERT_EQUAL(aFaces.size(), bFaces.size());
+        for (size_t n = 0; n < aFaces.size(); n++)
+        {
+            IndexData* aData = aFaces[n];
+            IndexData* bData = bFaces[n];
+            CPPUNIT_ASSERT_EQUAL(aData->indexCount, bData->indexCount);
+            if (aData->indexCount == 0)
+                continue;
+
+            HardwareIndexBufferSharedPtr aBuf = aData->indexBuffer;
+            HardwareIndexBufferSharedPtr bBuf = bData->indexBuffer;
+            CPPUNIT_ASSERT(aBuf->getType() == bBuf->getType());
+            const size_t indexSize = aBuf->getIndexSize();
+            const unsigned char* aIdx = static_cast<const unsigned char*>(
+                aBuf->lock(aData->indexStart * indexSize, aData->indexCount * indexSize,
+                           HardwareBuffer::HBL_READ_ONLY));
+            const unsigned char* bIdx = static_cast<const unsigned char*>(
+                bBuf->lock(bData->indexStart * indexSize, bData->indexCount * indexSize,
+                           HardwareBuffer::HBL_READ_ONLY));
+            const bool equal = memcmp(aIdx, bIdx, aData->indexCount * indexSize) == 0;
+            aBuf->unlock();
+            bBuf->unlock();
+            CPPUNIT_ASSERT(equal);
+        }
+    }
+}
+//--------------------------------------------------------------------------
+void MeshLodTests::testParallelProcessing()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // Splitting the setup across the WorkQueue threads must not change a single index
+    MeshLodGenerator& gen = MeshLodGenerator::getSingleton();
+    for (int compression = 0; compression < 2; compression++)
+    {
+        MeshPtr serialMesh = mMesh->clone(mMesh->getName() + ".serial" +
+                                          StringConverter::toString(compression));
+
+        LodConfig config;
+        setTestLodConfig(config);
+        config.advanced.useCompression = compression != 0;
+        config.advanced.useParallelProcessing = true;
+        gen.generateLodLevels(config);
+
+        LodConfig serialConfig;
+        setTestLodConfig(serialConfig);
+        serialConfig.mesh = serialMesh;
+        serialConfig.advanced.useCompression = compression != 0;
+        serialConfig.advanced.useParallelProcessing = false;
+        gen.generateLodLevels(serialConfig);
+
+        CPPUNIT_ASSERT_EQUAL(config.levels.size(), serialConfig.levels.size());
+        for (size_t i = 0; i < config.levels.size(); i++)
+        {
+            CPPUNIT_ASSERT_EQUAL(config.levels[i].outSkipped, serialConfig.levels[i].outSkipped);
+            CPPUNIT_ASSERT_EQUAL(config.levels[i].outUniqueVertexCount,
+                                 serialConfig.levels[i].outUniqueVertexCount);
+        }
+        assertLodIndicesEqual(mMesh.get(), serialMesh.get());
+
+        MeshManager::getSingleton().remove(serialMesh->getHandle());
+    }
+}
+//--------------------------------------------------------------------------
+namespace
+{
+    struct HeapReferenceLess
+    {
+        const vector<Real>::type& costs;
+        HeapReferenceLess(const vector<Real>::type& c) : costs(c) {}
+
+        // Same order as CollapseCostHeap: by cost, then by vertex address (the vertices are in an array)
+        bool operator()(size_t a, size_t b) const
+        {
+            return costs[a] < costs[b] || (costs[a] == costs[b] && a < b);
+        }
+    };
+}
+//--------------------------------------------------------------------------
+void MeshLodTests::testCollapseCostHeap()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const size_t vertexCount = 500;
+    LodData::VertexList vertices(vertexCount);
+    for (size_t i = 0; i < vertexCount; i++)
+        vertices[i].costHeapPosition = LodData::CollapseCostHeap::NOT_IN_HEAP;
+
+    // Reference: the cost of every vertex and whether it is in the heap.
+    // Few distinct costs, so the tie breaking gets tested too.
+    vector<Real>::type costs(vertexCount, 0);
+    vector<bool>::type inHeap(vertexCount, false);
+    HeapReferenceLess less(costs);
+
+    LodData::CollapseCostHeap heap;
+    for (size_t i = 0; i < vertexCount; i += 2)
+    {
+        costs[i] = (Real)(rand() % 50);
+        inHeap[i] = true;
+        heap.pushUnordered(&vertices[i], costs[i]);
+    }
+    heap.makeHeap();
+
+    for (int op = 0; op < 5000; op++)
+    {
+        size_t i = rand() % vertexCount;
+        if (inHeap[i] && rand() % 3 == 0)
+        {
+            heap.erase(&vertices[i]);
+            inHeap[i] = false;
+        }
+        else
+        {
+            costs[i] = (Real)(rand() % 50);
+            inHeap[i] = true;
+            heap.update(&vertices[i], costs[i]);
+        }
+
+        size_t expectedSize = 0;
+        size_t expectedTop = vertexCount;
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            CPPUNIT_ASSERT_EQUAL((bool)inHeap[v], heap.contains(&vertices[v]));
+            if (inHeap[v])
+            {
+                expectedSize++;
+                CPPUNIT_ASSERT_EQUAL(costs[v], heap.getCost(&vertices[v]));
+                if (expectedTop == vertexCount || less(v, expectedTop))
+                    expectedTop = v;
+            }
+        }
+        CPPUNIT_ASSERT_EQUAL(expectedSize, heap.size());
+        if (expectedSize)
+            CPPUNIT_ASSERT(heap.top().vertex == &vertices[expectedTop]);
+    }
+
+    // Draining the heap must give the reference ordering
+    vector<size_t>::type expected;
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        if (inHeap[v])
+            expected.push_back(v);
+    }
+    std::sort(expected.begin(), expected.end(), less);
+    for (size_t n = 0; n < expected.size(); n++)
+    {
+        CPPUNIT_ASSERT(!heap.empty());
+        CPPUNIT_ASSERT(heap.top().vertex == &vertices[expected[n]]);
+        CPPUNIT_ASSERT_EQUAL(costs[expected[n]], heap.top().cost);
+        heap.erase(heap.top().vertex);
+    }
+    CPPUNIT_ASSERT(heap.empty());
+}
+//--------------------------------------------------------------------------
 void MeshLodTests::setTestLodConfig(LodConfig& config)
 {
     config.mesh = mMesh;
@@ -45,6 +45,10 @@ class MeshSerializerTests : public CppUnit::TestFixture
     CPPUNIT_TEST(testSkeleton_Version_1_8);
     CPPUNIT_TEST(testSkeleton_Version_1_0);
     CPPUNIT_TEST(testMesh_clone);
+    CPPUNIT_TEST(testMesh_Version_2_0);
+    CPPUNIT_TEST(testMesh_Version_2_0_Compressed);
+    CPPUNIT_TEST(testMesh_Version_2_0_CompressedNonUnitNormals);
+    CPPUNIT_TEST(testMesh_Version_2_0_ParallelImport);
     CPPUNIT_TEST(testMesh_Version_1_10);
     CPPUNIT_TEST(testMesh_Version_1_8);
     CPPUNIT_TEST(testMesh_Version_1_41);
@@ -60,6 +64,8 @@ protected:
     String mSkeletonFullPath;
     SkeletonPtr mSkeleton;
     Real mErrorFactor;
+    /// Max difference allowed between float vertex elements. 0 for an exact match.
+    Real mVertexTolerance;
     FileSystemLayer* mFSLayer;
 
 public:
@@ -68,6 +74,10 @@ public:
     void testSkeleton_Version_1_8();
     void testSkeleton_Version_1_0();
     void testMesh_clone();
+    void testMesh_Version_2_0();
+    void testMesh_Version_2_0_Compressed();
+    void testMesh_Version_2_0_CompressedNonUnitNormals();
+    void testMesh_Version_2_0_ParallelImport();
     void testMesh_Version_1_10();
     void testMesh_Version_1_8();
     void testMesh_Version_1_41();
@@ -81,6 +91,7 @@ public:
     void assertIndexDataClone(IndexData* a, IndexData* b, MeshVersion version = MESH_VERSION_LATEST);
     void assertEdgeDataClone(EdgeData* a, EdgeData* b, MeshVersion version = MESH_VERSION_LATEST);
     void assertLodUsageClone(const MeshLodUsage& a, const MeshLodUsage& b, MeshVersion version = MESH_VERSION_LATEST);
+    void assertVertexAnimationClone(Mesh* a, Mesh* b);
 
     template<typename T>
     bool isContainerClone(T& a, T& b);
@@ -42,6 +42,8 @@ class RadixSortTests : public CppUnit::TestFixture
     CPPUNIT_TEST(testIntList);
     CPPUNIT_TEST(testUnsignedIntVector);
     CPPUNIT_TEST(testIntVector);
+    CPPUNIT_TEST(testParallelUint64Vector);
+    CPPUNIT_TEST(testParallelUint64VectorThreaded);
     CPPUNIT_TEST_SUITE_END();
 
 protected:
@@ -56,6 +58,8 @@ public:
     void testIntList();
     void testUnsignedIntVector();
     void testIntVector();
+    void testParallelUint64Vector();
+    void testParallelUint64VectorThreaded();
 };
 
 #endif
\ No newline at end of file
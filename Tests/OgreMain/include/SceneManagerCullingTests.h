@@ -0,0 +1,79 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __SceneManagerCullingTests_H__
+#define __SceneManagerCullingTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "OgrePrerequisites.h"
+#include "OgreCommon.h"
+
+class CullTestSceneManager;
+
+class SceneManagerCullingTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(SceneManagerCullingTests);
+    CPPUNIT_TEST(testCullPrefetchUnchanged);
+    CPPUNIT_TEST(testCullPrefetchCameraChanged);
+    CPPUNIT_TEST(testCullPrefetchMaskChanged);
+    CPPUNIT_TEST(testUnifiedInstanceStreamOffsets);
+    CPPUNIT_TEST(testUnifiedInstanceStreamRenderQueue);
+    CPPUNIT_TEST(testStaticBvhCulling);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    Ogre::Root* mRoot;
+#ifdef OGRE_STATIC_LIB
+    Ogre::Plugin* mNullPlugin;
+#endif
+    CullTestSceneManager* mSceneMgr;
+    Ogre::Camera* mCameras[2];
+    Ogre::vector<Ogre::MovableObject*>::type mObjects;
+    Ogre::vector<Ogre::InstancedEntity*>::type mInstances;
+
+    void createScene(size_t numObjects, Ogre::SceneMemoryMgrTypes sceneType = Ogre::SCENE_DYNAMIC);
+    void destroyScene();
+
+    Ogre::InstanceManager* createInstancedScene(size_t numInstances);
+    void destroyInstancedScene(Ogre::InstanceManager* instanceManager);
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testCullPrefetchUnchanged();
+    void testCullPrefetchCameraChanged();
+    void testCullPrefetchMaskChanged();
+    void testUnifiedInstanceStreamOffsets();
+    void testUnifiedInstanceStreamRenderQueue();
+    void testStaticBvhCulling();
+};
+
+#endif
@@ -0,0 +1,8 @@
+#version 330
+
+@property( diffuse_map )uniform sampler2D diffuseMap;@end
+@property( hlms_shadowcaster )out float depth;@end
+
+void main()
+{
+}
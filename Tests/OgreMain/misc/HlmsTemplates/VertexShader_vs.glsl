@@ -0,0 +1,9 @@
+#version 330
+
+in vec4 vertex;
+@property( hlms_normal )in vec3 normal;@end
+@property( diffuse_map )out vec2 uv0;@end
+
+void main()
+{
+}
@@ -0,0 +1,370 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "ArrayMathTests.h"
+#include "UnitTestSuite.h"
+
+#include "OgreMatrix4.h"
+#include "OgreOptimisedUtil.h"
+#include "Math/Array/OgreArrayMatrixAf4x3.h"
+#include "Math/Array/OgreArrayQuaternion.h"
+#include "Math/Array/OgreArrayVector3.h"
+#include "Math/Array/OgreMathlib.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(ArrayMathTests);
+
+namespace
+{
+    // FMA rounds differently and the SIMD sin/cos/sqrt are approximations
+    const Real TOLERANCE = 1e-3f;
+    const size_t NUM_VERTICES = 37; // Not a multiple of any SIMD width, to cover the tails
+
+    Real randomReal(Real low, Real high)
+    {
+        return low + (high - low) * (static_cast<Real>(rand()) / static_cast<Real>(RAND_MAX));
+    }
+
+    Vector3 randomVector3(Real range)
+    {
+        return Vector3(randomReal(-range, range), randomReal(-range, range), randomReal(-range, range));
+    }
+
+    Quaternion randomQuaternion()
+    {
+        Vector3 axis = randomVector3(1.0f);
+        while (axis.isZeroLength())
+            axis = randomVector3(1.0f);
+        axis.normalise();
+        return Quaternion(Radian(randomReal(-Math::PI, Math::PI)), axis);
+    }
+
+    Real getLane(ArrayReal value, size_t index)
+    {
+        return ArrayVector3(value, value, value).getAsVector3(index).x;
+    }
+
+    void assertEqual(const Vector3& expected, const Vector3& actual)
+    {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.x, actual.x, TOLERANCE);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.y, actual.y, TOLERANCE);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.z, actual.z, TOLERANCE);
+    }
+
+    void assertEqual(const Quaternion& expected, const Quaternion& actual)
+    {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.w, actual.w, TOLERANCE);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.x, actual.x, TOLERANCE);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.y, actual.y, TOLERANCE);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.z, actual.z, TOLERANCE);
+    }
+
+    void assertEqual(const Matrix4& expected, const Matrix4& actual)
+    {
+        for (size_t i = 0; i < 4; ++i)
+        {
+            for (size_t j = 0; j < 4; ++j)
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i][j], actual[i][j], TOLERANCE);
+        }
+    }
+
+    void assertEqual(const float* expected, const float* actual)
+    {
+        assertEqual(Vector3(expected), Vector3(actual));
+    }
+}
+
+//--------------------------------------------------------------------------
+void ArrayMathTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+    srand(0);
+}
+//--------------------------------------------------------------------------
+void ArrayMathTests::tearDown()
+{
+}
+//--------------------------------------------------------------------------
+void ArrayMathTests::testArrayVector3()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    Vector3 a[ARRAY_PACKED_REALS], b[ARRAY_PACKED_REALS];
+    ArrayVector3 arrayA, arrayB;
+    for (size_t i = 0; i < ARRAY_PACKED_REALS; ++i)
+    {
+        a[i] = randomVector3(10.0f);
+        b[i] = randomVector3(10.0f);
+        arrayA.setFromVector3(a[i], i);
+        arrayB.setFromVector3(b[i], i);
+    }
+
+    const ArrayVector3 sum = arrayA + arrayB;
+    const ArrayVector3 product = arrayA * arrayB;
+    const ArrayVector3 cross = arrayA.crossProduct(arrayB);
+    const ArrayVector3 normalised = arrayA.normalisedCopy();
+    const ArrayReal dot = arrayA.dotProduct(arrayB);
+    const ArrayReal length = arrayA.length();
+    ArrayVector3 floor = arrayA;
+    floor.makeFloor(arrayB);
+
+    for (size_t i = 0; i < ARRAY_PACKED_REALS; ++i)
+    {
+        Vector3 expectedFloor = a[i];
+        expectedFloor.makeFloor(b[i]);
+
+        assertEqual(a[i] + b[i], sum.getAsVector3(i));
+        assertEqual(a[i] * b[i], product.getAsVector3(i));
+        assertEqual(a[i].crossProduct(b[i]), cross.getAsVector3(i));
+        assertEqual(a[i].normalisedCopy(), normalised.getAsVector3(i));
+        assertEqual(expectedFloor, floor.getAsVector3(i));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(a[i].dotProduct(b[i]), getLane(dot, i), TOLERANCE);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(a[i].length(), getLane(length, i), TOLERANCE);
+    }
+}
+//--------------------------------------------------------------------------
+void ArrayMathTests::testArrayQuaternion()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    Quaternion p[ARRAY_PACKED_REALS], q[ARRAY_PACKED_REALS];
+    Vector3 v[ARRAY_PACKED_REALS];
+    ArrayQuaternion arrayP, arrayQ;
+    ArrayVector3 arrayV;
+    for (size_t i = 0; i < ARRAY_PACKED_REALS; ++i)
+    {
+        p[i] = randomQuaternion();
+        q[i] = randomQuaternion();
+        v[i] = randomVector3(10.0f);
+        // ArrayQuaternion::Slerp flips q for the shortest path but keeps using the
+        // negative cosine, so it only matches Quaternion::Slerp in the same hemisphere
+        if (p[i].Dot(q[i]) < 0)
+            q[i] = -q[i];
+        arrayP.setFromQuaternion(p[i], i);
+        arrayQ.setFromQuaternion(q[i], i);
+        arrayV.setFromVector3(v[i], i);
+    }
+
+    const Real t = 0.3f;
+    const ArrayQuaternion product = arrayP * arrayQ;
+    const ArrayVector3 rotated = arrayP * arrayV;
+    const ArrayQuaternion nlerped = ArrayQuaternion::nlerp(Mathlib::SetAll(t), arrayP, arrayQ);
+    const ArrayQuaternion slerped = ArrayQuaternion::Slerp(Mathlib::SetAll(t), arrayP, arrayQ);
+
+    for (size_t i = 0; i < ARRAY_PACKED_REALS; ++i)
+    {
+        Quaternion result;
+        product.getAsQuaternion(result, i);
+        assertEqual(p[i] * q[i], result);
+        nlerped.getAsQuaternion(result, i);
+        assertEqual(Quaternion::nlerp(t, p[i], q[i], false), result);
+        slerped.getAsQuaternion(result, i);
+        assertEqual(Quaternion::Slerp(t, p[i], q[i], true), result);
+        assertEqual(p[i] * v[i], rotated.getAsVector3(i));
+    }
+}
+//--------------------------------------------------------------------------
+void ArrayMathTests::testArrayMatrixAf4x3()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    Matrix4 a[ARRAY_PACKED_REALS], b[ARRAY_PACKED_REALS];
+    Vector3 v[ARRAY_PACKED_REALS];
+    ArrayVector3 positions[2], scales[2], arrayV;
+    ArrayQuaternion orientations[2];
+    for (size_t i = 0; i < ARRAY_PACKED_REALS; ++i)
+    {
+        for (size_t j = 0; j < 2; ++j)
+        {
+            const Vector3 position = randomVector3(10.0f);
+            const Vector3 scale(randomReal(0.5f, 2.0f), randomReal(0.5f, 2.0f), randomReal(0.5f, 2.0f));
+            const Quaternion orientation = randomQuaternion();
+            (j == 0 ? a : b)[i].makeTransform(position, scale, orientation);
+            positions[j].setFromVector3(position, i);
+            scales[j].setFromVector3(scale, i);
+            orientations[j].setFromQuaternion(orientation, i);
+        }
+        v[i] = randomVector3(10.0f);
+        arrayV.setFromVector3(v[i], i);
+    }
+
+    ArrayMatrixAf4x3 arrayA, arrayB;
+    arrayA.makeTransform(positions[0], scales[0], orientations[0]);
+    arrayB.makeTransform(positions[1], scales[1], orientations[1]);
+    const ArrayVector3 transformed = arrayA * arrayV;
+    ArrayMatrixAf4x3 concatenated = arrayA;
+    concatenated *= arrayB;
+
+    Matrix4 *result = static_cast<Matrix4*>(OGRE_MALLOC_SIMD(sizeof(Matrix4) * ARRAY_PACKED_REALS,
+                                                             MEMCATEGORY_GENERAL));
+    arrayA.streamToAoS(result);
+    for (size_t i = 0; i < ARRAY_PACKED_REALS; ++i)
+    {
+        assertEqual(a[i], result[i]);
+        assertEqual(a[i].transformAffine(v[i]), transformed.getAsVector3(i));
+    }
+
+    concatenated.streamToAoS(result);
+    for (size_t i = 0; i < ARRAY_PACKED_REALS; ++i)
+        assertEqual(a[i].concatenateAffine(b[i]), result[i]);
+
+    OGRE_FREE_SIMD(result, MEMCATEGORY_GENERAL);
+}
+//--------------------------------------------------------------------------
+void ArrayMathTests::testSoftwareVertexSkinning()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const size_t numMatrices = 8;
+    const size_t numWeights = 4;
+
+    Matrix4 *matrices = static_cast<Matrix4*>(OGRE_MALLOC_SIMD(sizeof(Matrix4) * numMatrices,
+                                                               MEMCATEGORY_GENERAL));
+    const Matrix4 *blendMatrices[numMatrices];
+    for (size_t i = 0; i < numMatrices; ++i)
+    {
+        matrices[i].makeTransform(randomVector3(10.0f), Vector3(randomReal(0.5f, 2.0f)),
+                                  randomQuaternion());
+        blendMatrices[i] = &matrices[i];
+    }
+
+    // Interleaved position & normal, like a typical skinned vertex buffer
+    float source[NUM_VERTICES * 6];
+    float weights[NUM_VERTICES * numWeights];
+    unsigned char indices[NUM_VERTICES * numWeights];
+    for (size_t i = 0; i < NUM_VERTICES; ++i)
+    {
+        const Vector3 position = randomVector3(10.0f);
+        const Vector3 normal = randomQuaternion() * Vector3::UNIT_Z;
+        memcpy(source + i * 6, position.ptr(), sizeof(float) * 3);
+        memcpy(source + i * 6 + 3, normal.ptr(), sizeof(float) * 3);
+
+        // Some vertices have unused (zero) weights
+        const size_t usedWeights = 1 + i % numWeights;
+        Real totalWeight = 0;
+        for (size_t j = 0; j < numWeights; ++j)
+        {
+            weights[i * numWeights + j] = j < usedWeights ? randomReal(0.1f, 1.0f) : 0.0f;
+            indices[i * numWeights + j] = static_cast<unsigned char>(rand() % numMatrices);
+            totalWeight += weights[i * numWeights + j];
+        }
+        for (size_t j = 0; j < numWeights; ++j)
+            weights[i * numWeights + j] /= totalWeight;
+    }
+
+    // Exercise both the separated (packed) and the interleaved code paths
+    for (size_t interleaved = 0; interleaved < 2; ++interleaved)
+    {
+        float srcPos[NUM_VERTICES * 6], srcNorm[NUM_VERTICES * 6];
+        float dstPos[NUM_VERTICES * 6], dstNorm[NUM_VERTICES * 6];
+        const size_t stride = sizeof(float) * (interleaved ? 6 : 3);
+        const size_t floatStride = stride / sizeof(float);
+        const size_t normOffset = interleaved ? 3 : 0;
+        float *srcNormBase = interleaved ? srcPos : srcNorm;
+        float *dstNormBase = interleaved ? dstPos : dstNorm;
+        for (size_t i = 0; i < NUM_VERTICES; ++i)
+        {
+            memcpy(srcPos + i * floatStride, source + i * 6, sizeof(float) * 3);
+            memcpy(srcNormBase + i * floatStride + normOffset, source + i * 6 + 3, sizeof(float) * 3);
+        }
+
+        OptimisedUtil::getImplementation()->softwareVertexSkinning(
+            srcPos, dstPos, srcNormBase + normOffset, dstNormBase + normOffset,
+            weights, indices, blendMatrices, stride, stride, stride, stride,
+            sizeof(float) * numWeights, numWeights, numWeights, NUM_VERTICES);
+
+        for (size_t i = 0; i < NUM_VERTICES; ++i)
+        {
+            const Vector3 position(source + i * 6);
+            const Vector3 normal(source + i * 6 + 3);
+            Vector3 expectedPosition(Vector3::ZERO), expectedNormal(Vector3::ZERO);
+            for (size_t j = 0; j < numWeights; ++j)
+            {
+                const Real weight = weights[i * numWeights + j];
+                const Matrix4 &matrix = matrices[indices[i * numWeights + j]];
+                Matrix3 rotation;
+                matrix.extract3x3Matrix(rotation);
+                expectedPosition += matrix.transformAffine(position) * weight;
+                expectedNormal += (rotation * normal) * weight;
+            }
+            expectedNormal.normalise();
+
+            assertEqual(expectedPosition.ptr(), dstPos + i * floatStride);
+            assertEqual(expectedNormal.ptr(), dstNormBase + i * floatStride + normOffset);
+        }
+    }
+
+    OGRE_FREE_SIMD(matrices, MEMCATEGORY_GENERAL);
+}
+//--------------------------------------------------------------------------
+void ArrayMathTests::testSoftwareVertexMorph()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const Real t = 0.35f;
+    float src1[NUM_VERTICES * 6], src2[NUM_VERTICES * 6], dst[NUM_VERTICES * 6];
+    for (size_t i = 0; i < NUM_VERTICES; ++i)
+    {
+        const Vector3 values[4] = { randomVector3(10.0f), randomQuaternion() * Vector3::UNIT_Z,
+                                    randomVector3(10.0f), randomQuaternion() * Vector3::UNIT_Z };
+        memcpy(src1 + i * 6, values[0].ptr(), sizeof(float) * 3);
+        memcpy(src1 + i * 6 + 3, values[1].ptr(), sizeof(float) * 3);
+        memcpy(src2 + i * 6, values[2].ptr(), sizeof(float) * 3);
+        memcpy(src2 + i * 6 + 3, values[3].ptr(), sizeof(float) * 3);
+    }
+
+    // Positions only, then positions followed by normals
+    for (size_t morphNormals = 0; morphNormals < 2; ++morphNormals)
+    {
+        const size_t floatStride = morphNormals ? 6 : 3;
+        float packed1[NUM_VERTICES * 6], packed2[NUM_VERTICES * 6];
+        for (size_t i = 0; i < NUM_VERTICES; ++i)
+        {
+            memcpy(packed1 + i * floatStride, src1 + i * 6, sizeof(float) * floatStride);
+            memcpy(packed2 + i * floatStride, src2 + i * 6, sizeof(float) * floatStride);
+        }
+
+        const size_t stride = sizeof(float) * floatStride;
+        OptimisedUtil::getImplementation()->softwareVertexMorph(
+            t, packed1, packed2, dst, stride, stride, stride, NUM_VERTICES, morphNormals != 0);
+
+        for (size_t i = 0; i < NUM_VERTICES; ++i)
+        {
+            const Vector3 position1(src1 + i * 6), position2(src2 + i * 6);
+            assertEqual((position1 + (position2 - position1) * t).ptr(), dst + i * floatStride);
+
+            if (morphNormals)
+            {
+                const Vector3 normal1(src1 + i * 6 + 3), normal2(src2 + i * 6 + 3);
+                const Vector3 expected = (normal1 + (normal2 - normal1) * t).normalisedCopy();
+                assertEqual(expected.ptr(), dst + i * floatStride + 3);
+            }
+        }
+    }
+}
@@ -0,0 +1,231 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "ArrayMemoryManagerTests.h"
+#include "UnitTestSuite.h"
+
+#include "Math/Array/OgreArrayMemoryManager.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(ArrayMemoryManagerTests);
+
+namespace
+{
+    /// Owner of a slot, like a Node owns its Transform. The slot stores the owner's id,
+    /// so after a move we can tell whether the pointer still points to our own data.
+    struct SlotOwner
+    {
+        size_t  id;
+        size_t  *data;
+        bool    alive;
+    };
+    typedef vector<SlotOwner>::type SlotOwnerVec;
+
+    /// Same as Ogre::cleanerFlat (which isn't exported)
+    void testCleanerFlat(char *dstPtr, size_t, char *srcPtr, size_t,
+                         size_t numSlots, size_t numFreeSlots, size_t elementsMemSize)
+    {
+        memmove(dstPtr, srcPtr, numSlots * elementsMemSize);
+        memset(dstPtr + numSlots * elementsMemSize, 0, numFreeSlots * elementsMemSize);
+    }
+
+    const size_t elementsMemSizes[1] = { sizeof(size_t) };
+    const CleanupRoutines cleanupRoutines[1] = { testCleanerFlat };
+
+    /// Single pool manager exposing slot creation & destruction.
+    class TestArrayMemoryManager : public ArrayMemoryManager, public ArrayMemoryManager::RebaseListener
+    {
+    public:
+        SlotOwnerVec    owners;
+        size_t          numSlotsMoved;
+
+        TestArrayMemoryManager(size_t hintMaxSlots) :
+            ArrayMemoryManager(UserDefinedType0, elementsMemSizes, cleanupRoutines, 1, 0,
+                               hintMaxSlots, 100, MAX_MEMORY_SLOTS, this),
+            numSlotsMoved(0)
+        {
+            setIncrementalCleanup(true);
+        }
+
+        void createOwner()
+        {
+            // May grow the pool, get the slot before reading the base pointer
+            const size_t slot = createNewSlot();
+
+            SlotOwner owner;
+            owner.id    = owners.size();
+            owner.data  = reinterpret_cast<size_t*>(mMemoryPools[0]) + slot;
+            owner.alive = true;
+            *owner.data = owner.id;
+            owners.push_back(owner);
+        }
+
+        void destroyOwner(size_t id)
+        {
+            destroySlot(reinterpret_cast<const char*>(owners[id].data), 0);
+            owners[id].alive = false;
+        }
+
+        virtual void buildDiffList(ManagerType, uint16, const MemoryPoolVec &basePtrs,
+                                   PtrdiffVec &outDiffsList)
+        {
+            for (size_t i = 0; i < owners.size(); ++i)
+                outDiffsList.push_back(reinterpret_cast<char*>(owners[i].data) - basePtrs[0]);
+        }
+        virtual void applyRebase(ManagerType, uint16, const MemoryPoolVec &newBasePtrs,
+                                 const PtrdiffVec &diffsList)
+        {
+            for (size_t i = 0; i < owners.size(); ++i)
+                owners[i].data = reinterpret_cast<size_t*>(newBasePtrs[0] + diffsList[i]);
+        }
+        virtual void performCleanup(ManagerType, uint16, const MemoryPoolVec&, size_t const*,
+                                    size_t, size_t)
+        {
+            CPPUNIT_FAIL("Incremental cleanup must never trigger a full cleanup");
+        }
+        virtual void slotMoved(ManagerType, uint16, const MemoryPoolVec &basePtrs,
+                               size_t const *sizes, size_t dstInstance)
+        {
+            size_t *data = reinterpret_cast<size_t*>(basePtrs[0] + dstInstance * sizes[0]);
+            CPPUNIT_ASSERT(*data < owners.size());
+            CPPUNIT_ASSERT(owners[*data].alive);
+            owners[*data].data = data;
+            ++numSlotsMoved;
+        }
+
+        size_t getNumUsedSlots() const      { return getUsedMemory() / sizeof(size_t); }
+        size_t getPoolEnd() const           { return mUsedMemory; }
+        const size_t* getBase() const       { return reinterpret_cast<const size_t*>(mMemoryPools[0]); }
+    };
+
+    /// Every live owner must still point to its own data, inside the pool.
+    void checkOwners(const TestArrayMemoryManager &mgr)
+    {
+        size_t numAlive = 0;
+        for (size_t i = 0; i < mgr.owners.size(); ++i)
+        {
+            const SlotOwner &owner = mgr.owners[i];
+            if (owner.alive)
+            {
+                CPPUNIT_ASSERT(owner.data >= mgr.getBase());
+                CPPUNIT_ASSERT(owner.data < mgr.getBase() + mgr.getPoolEnd());
+                CPPUNIT_ASSERT_EQUAL(owner.id, *owner.data);
+                ++numAlive;
+            }
+        }
+        CPPUNIT_ASSERT_EQUAL(numAlive, mgr.getNumUsedSlots());
+    }
+}
+
+//--------------------------------------------------------------------------
+void ArrayMemoryManagerTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+    srand(0);
+}
+//--------------------------------------------------------------------------
+void ArrayMemoryManagerTests::tearDown()
+{
+}
+//--------------------------------------------------------------------------
+void ArrayMemoryManagerTests::testDefragmentBounded()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const size_t numOwners  = 300;
+    const size_t maxMoves   = 7;
+
+    TestArrayMemoryManager mgr(64);
+    mgr.initialize();
+
+    // Grows the pool a few times on the way
+    for (size_t i = 0; i < numOwners; ++i)
+        mgr.createOwner();
+    checkOwners(mgr);
+
+    for (size_t i = 0; i < numOwners / 2; ++i)
+    {
+        const size_t id = rand() % numOwners;
+        if (mgr.owners[id].alive)
+            mgr.destroyOwner(id);
+    }
+    checkOwners(mgr);
+
+    // Holes are filled from the end of the pool, at most maxMoves per call
+    size_t prevPoolEnd = mgr.getPoolEnd();
+    while (mgr.getPoolEnd() > mgr.getNumUsedSlots())
+    {
+        const size_t prevNumSlotsMoved = mgr.numSlotsMoved;
+        const size_t numMoves = mgr.defragment(maxMoves);
+
+        CPPUNIT_ASSERT(numMoves <= maxMoves);
+        CPPUNIT_ASSERT_EQUAL(numMoves, mgr.numSlotsMoved - prevNumSlotsMoved);
+        CPPUNIT_ASSERT(mgr.getPoolEnd() < prevPoolEnd);
+        checkOwners(mgr);
+
+        prevPoolEnd = mgr.getPoolEnd();
+    }
+
+    CPPUNIT_ASSERT_EQUAL((size_t)0, mgr.getWastedMemory());
+    CPPUNIT_ASSERT_EQUAL((size_t)0, mgr.defragment(maxMoves));
+
+    // Freed slots must be reusable after defragmenting
+    for (size_t i = 0; i < 10; ++i)
+        mgr.createOwner();
+    checkOwners(mgr);
+
+    mgr.destroy();
+}
+//--------------------------------------------------------------------------
+void ArrayMemoryManagerTests::testDefragmentTrailingHoles()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    TestArrayMemoryManager mgr(64);
+    mgr.initialize();
+
+    for (size_t i = 0; i < 16; ++i)
+        mgr.createOwner();
+
+    // Non-LIFO removal of the last slots: they're holes at the end, released for free
+    for (size_t i = 8; i < 15; ++i)
+        mgr.destroyOwner(i);
+    mgr.destroyOwner(3);
+    checkOwners(mgr);
+    CPPUNIT_ASSERT_EQUAL((size_t)16, mgr.getPoolEnd());
+
+    // Only slot 15 has to move (into slot 3), everything past slot 8 is trimmed
+    CPPUNIT_ASSERT_EQUAL((size_t)1, mgr.defragment(0) + mgr.defragment(1));
+    CPPUNIT_ASSERT_EQUAL((size_t)8, mgr.getPoolEnd());
+    CPPUNIT_ASSERT_EQUAL(mgr.getBase() + 3, const_cast<const size_t*>(mgr.owners[15].data));
+    checkOwners(mgr);
+
+    mgr.destroy();
+}
+//--------------------------------------------------------------------------
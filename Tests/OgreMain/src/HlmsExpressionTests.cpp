@@ -0,0 +1,200 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "HlmsExpressionTests.h"
+#include "UnitTestSuite.h"
+
+#include "OgreHlms.h"
+#include "OgreFileSystem.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(HlmsExpressionTests);
+
+/// Gives the tests access to the properties & the evaluator of the Hlms
+class HlmsExpressionTester : public Hlms
+{
+public:
+    HlmsExpressionTester(Archive *dataFolder) : Hlms(dataFolder) {}
+
+    void setProperty(const char *name, int32 value)
+    {
+        Hlms::setProperty(IdString(name), value);
+    }
+
+    bool evaluate(const String &expression, bool &outSyntaxError)
+    {
+        // Like parseProperties, start right after "@property(". The closing
+        // parenthesis ends the expression, and a block always follows it.
+        String buffer = expression + ")\n@end";
+        SubStringRef subString(&buffer, 0);
+        outSyntaxError = false;
+        return evaluateExpression(subString, outSyntaxError);
+    }
+};
+
+//--------------------------------------------------------------------------
+void HlmsExpressionTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    // There are no templates to load, an empty folder is enough
+    mDataFolder = OGRE_NEW FileSystemArchive("HlmsExpressionTests_NoTemplates", "FileSystem", true);
+    mHlms = OGRE_NEW HlmsExpressionTester(mDataFolder);
+
+    mHlms->setProperty("one", 1);
+    mHlms->setProperty("two", 2);
+    mHlms->setProperty("minus", -1);
+    mHlms->setProperty("zero", 0);
+}
+//--------------------------------------------------------------------------
+void HlmsExpressionTests::tearDown()
+{
+    OGRE_DELETE mHlms;
+    OGRE_DELETE mDataFolder;
+}
+//--------------------------------------------------------------------------
+void HlmsExpressionTests::assertEvaluates(const char *expression, bool expected)
+{
+    bool syntaxError = false;
+    const bool result = mHlms->evaluate(expression, syntaxError);
+    CPPUNIT_ASSERT_MESSAGE(expression, !syntaxError);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(expression, expected, result);
+}
+//--------------------------------------------------------------------------
+void HlmsExpressionTests::assertSyntaxError(const char *expression)
+{
+    bool syntaxError = false;
+    mHlms->evaluate(expression, syntaxError);
+    CPPUNIT_ASSERT_MESSAGE(expression, syntaxError);
+}
+//--------------------------------------------------------------------------
+void HlmsExpressionTests::testOperands()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // Any non-zero value is true, unknown properties are 0
+    assertEvaluates("one", true);
+    assertEvaluates("two", true);
+    assertEvaluates("minus", true);
+    assertEvaluates("zero", false);
+    assertEvaluates("undefined", false);
+
+    assertEvaluates("one && two", true);
+    assertEvaluates("one && zero", false);
+    assertEvaluates("zero || two", true);
+    assertEvaluates("zero || undefined", false);
+    assertEvaluates("one && two && minus", true);
+    assertEvaluates("zero || zero || one", true);
+}
+//--------------------------------------------------------------------------
+void HlmsExpressionTests::testLeftToRight()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // There is no operator precedence: operands are folded from left to right.
+    // With C precedence the first one would be true and the second one false.
+    assertEvaluates("one || zero && zero", false);
+    assertEvaluates("zero && zero || one", true);
+    assertEvaluates("zero && one || one && zero", false);
+
+    // Parenthesis are how templates get the other grouping
+    assertEvaluates("one || (zero && zero)", true);
+    assertEvaluates("zero && (zero || one)", false);
+}
+//--------------------------------------------------------------------------
+void HlmsExpressionTests::testNesting()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    assertEvaluates("(one)", true);
+    assertEvaluates("((zero))", false);
+    assertEvaluates("(one && (zero || (zero || two)))", true);
+    assertEvaluates("one && (zero || (two && zero))", false);
+    assertEvaluates("(zero || one) && (two || zero)", true);
+    assertEvaluates("(zero || zero) || ((one && two) && (minus || zero))", true);
+
+    // An empty expression is the property with no name, which isn't set
+    assertEvaluates("", false);
+    assertEvaluates("()", false);
+}
+//--------------------------------------------------------------------------
+void HlmsExpressionTests::testNegation()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    assertEvaluates("!one", false);
+    assertEvaluates("!zero", true);
+    assertEvaluates("!undefined", true);
+    assertEvaluates("!zero && !undefined", true);
+    assertEvaluates("one && !two", false);
+
+    assertEvaluates("!(one && zero)", true);
+    assertEvaluates("!(zero || one)", false);
+    assertEvaluates("one && !(zero || (one && !two))", true);
+    assertEvaluates("!(!(one))", true);
+}
+//--------------------------------------------------------------------------
+void HlmsExpressionTests::testWhitespace()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    assertEvaluates("one&&two", true);
+    assertEvaluates("zero||one&&zero", false);
+    assertEvaluates("one&&!zero", true);
+    assertEvaluates("one||(zero)", true);
+    assertEvaluates("  one\n\t&&\r\n  ( two )  ", true);
+}
+//--------------------------------------------------------------------------
+void HlmsExpressionTests::testMalformed()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // Operators without operands
+    assertSyntaxError("&& one");
+    assertSyntaxError("one ||");
+    assertSyntaxError("one && || two");
+    assertSyntaxError("(one &&) || two");
+    assertSyntaxError("one && (two ||)");
+
+    // Operands without operators
+    assertSyntaxError("one two");
+    assertSyntaxError("one (two)");
+    assertSyntaxError("(one) (two)");
+
+    // Negated operator
+    assertSyntaxError("one !&& two");
+
+    // Unbalanced parenthesis
+    assertSyntaxError("(one");
+    assertSyntaxError("((one) && two");
+
+    // A syntax error doesn't leak into the next expression
+    assertEvaluates("one && two", true);
+}
+//--------------------------------------------------------------------------
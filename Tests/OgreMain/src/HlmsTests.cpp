@@ -0,0 +1,662 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "HlmsTests.h"
+#include "UnitTestSuite.h"
+
+#include "OgreHlms.h"
+#include "OgreFileSystem.h"
+#include "OgreDefaultHardwareBufferManager.h"
+#include "OgreRenderable.h"
+#include "OgreRenderOperation.h"
+#include "OgreVertexIndexData.h"
+#include "OgreMaterial.h"
+#include "OgreRoot.h"
+#include "OgreDataStream.h"
+#include "OgreGpuProgram.h"
+#include "OgreWorkQueue.h"
+#include "OgreMovableObject.h"
+#include "OgreId.h"
+#include "Math/Array/OgreObjectMemoryManager.h"
+#include "Threading/OgreThreads.h"
+
+#if OGRE_PLATFORM == OGRE_PLATFORM_APPLE
+#include "macUtils.h"
+#endif
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(HlmsTests);
+
+namespace
+{
+    const IdString CustomFlag("custom_flag");
+
+    /// Only the vertex layout matters to the hashes
+    class HlmsTestRenderable : public Renderable
+    {
+        VertexData *mVertexData;
+
+    public:
+        HlmsTestRenderable(VertexData *vertexData) : mVertexData(vertexData) {}
+
+        virtual const MaterialPtr& getMaterial(void) const
+        {
+            static MaterialPtr nullMaterial;
+            return nullMaterial;
+        }
+
+        virtual void getRenderOperation(RenderOperation& op)
+        {
+            op.vertexData = mVertexData;
+        }
+
+        virtual void getWorldTransforms(Matrix4* xform) const {}
+        virtual Real getSquaredViewDepth(const Camera* cam) const { return 0; }
+
+        virtual const LightList& getLights(void) const
+        {
+            static LightList lights;
+            return lights;
+        }
+    };
+
+    const size_t NumCachedShaders = 3;
+    /// Same order as Hlms::ShaderType: vertex, pixel, geometry, hull & domain
+    const size_t NumShaderStages = 5;
+
+    /// Properties & sources of the shaders put in the caches by the tests.
+    /// Not every stage has a source, like most real permutations.
+    struct CachedShaderDesc
+    {
+        uint32          hash;
+        HlmsPropertyVec properties;
+        String          sources[NumShaderStages];
+    };
+
+    void createShaderDescs(CachedShaderDesc outDescs[NumCachedShaders])
+    {
+        for (size_t i = 0; i < NumCachedShaders; ++i)
+        {
+            outDescs[i].hash = 0x1000u * (i + 1) + 7u;
+            for (size_t j = 0; j <= i; ++j)
+            {
+                outDescs[i].properties.push_back(HlmsProperty(
+                        IdString("test_property_" + StringConverter::toString(j)),
+                        static_cast<int32>(j * 10 + i) - 5));
+            }
+            std::sort(outDescs[i].properties.begin(), outDescs[i].properties.end(),
+                      OrderPropertyByIdString);
+
+            // Vertex & pixel shaders always, the geometry shader only in the last one
+            outDescs[i].sources[0] = "//Vertex shader " + StringConverter::toString(i) +
+                                     "\nvoid main() {}\n";
+            outDescs[i].sources[1] = "//Pixel shader " + StringConverter::toString(i) +
+                                     "\nvoid main() {}\n";
+            if (i == NumCachedShaders - 1)
+                outDescs[i].sources[2] = "//Geometry shader\n";
+        }
+    }
+
+    /// Copies the first numBytes of data to a stream of that exact size
+    DataStreamPtr createStream(const String &data, size_t numBytes)
+    {
+        MemoryDataStream *retVal = OGRE_NEW MemoryDataStream(numBytes);
+        if (numBytes)
+            memcpy(retVal->getPtr(), data.c_str(), numBytes);
+        return DataStreamPtr(retVal);
+    }
+
+    /// Writes the shader cache of the given Hlms and returns it in a stream of its exact size
+    DataStreamPtr saveShaderCache(const Hlms &hlms)
+    {
+        MemoryDataStream *memoryStream = OGRE_NEW MemoryDataStream(64 * 1024);
+        DataStreamPtr stream(memoryStream);
+        hlms.saveShaderCache(stream);
+
+        return createStream(String(reinterpret_cast<const char*>(memoryStream->getPtr()),
+                                   stream->tell()), stream->tell());
+    }
+
+    /// getMaterial only looks at whether it casts shadows
+    class HlmsTestObject : public MovableObject
+    {
+    public:
+        HlmsTestObject(ObjectMemoryManager *objectMemoryManager) :
+            MovableObject(Id::generateNewId<MovableObject>(), objectMemoryManager, 0)
+        {
+        }
+
+        virtual const String& getMovableType(void) const
+        {
+            static const String movableType = "HlmsTestObject";
+            return movableType;
+        }
+
+        virtual void _updateRenderQueue(RenderQueue *queue, Camera *camera, const Camera *lodCamera)
+        {
+        }
+
+        virtual void visitRenderables(Renderable::Visitor *visitor, bool debugRenderables = false)
+        {
+        }
+    };
+
+    /// Positions & normals
+    VertexData* createVertexData(void)
+    {
+        VertexData *retVal = OGRE_NEW VertexData();
+        retVal->vertexDeclaration->addElement(0, 0, VET_FLOAT3, VES_POSITION);
+        retVal->vertexDeclaration->addElement(0, 12, VET_FLOAT3, VES_NORMAL);
+        return retVal;
+    }
+
+    /// Runs what the main thread does at the beginning of every frame until the
+    /// background shaders arrive, or a few seconds pass.
+    void waitForShaders(const Hlms &hlms)
+    {
+        WorkQueue *workQueue = Root::getSingleton().getWorkQueue();
+        for (size_t i = 0; i < 1000 && hlms.getNumPendingShaders(); ++i)
+        {
+            Threads::Sleep(5);
+            workQueue->processResponses();
+        }
+    }
+
+    bool samePropertyVecs(const HlmsPropertyVec &a, const HlmsPropertyVec &b)
+    {
+        if (a.size() != b.size())
+            return false;
+
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            if (a[i].keyName != b[i].keyName || a[i].value != b[i].value)
+                return false;
+        }
+
+        return true;
+    }
+}
+
+/// Gives the tests access to the caches of the Hlms, and customises the properties
+/// & hashes like a derived Hlms would
+class HlmsTester : public Hlms
+{
+protected:
+    virtual void calculateHashes(Renderable *renderable, const HlmsParamVec &params,
+                                 HlmsPropertyVec &outProperties,
+                                 HlmsPropertyVec &outCasterProperties,
+                                 uint32 &outHash, uint32 &outCasterHash) const
+    {
+        Hlms::calculateHashes(renderable, params, outProperties, outCasterProperties,
+                              outHash, outCasterHash);
+
+        String paramVal;
+        if (findParamInVec(params, CustomFlag, paramVal))
+        {
+            setProperty(outProperties, CustomFlag, 1);
+            setProperty(outCasterProperties, CustomFlag, 1);
+        }
+
+        // The flag doesn't fit in the default hash; hash every property instead
+        outHash = hashProperties(outProperties);
+        outCasterHash = hashProperties(outCasterProperties);
+    }
+
+    static uint32 hashProperties(const HlmsPropertyVec &properties)
+    {
+        uint32 hash = 0;
+        if (!properties.empty())
+        {
+            MurmurHash3_x86_32(&properties[0], static_cast<int>(properties.size() *
+                               sizeof(HlmsProperty)), IdString::Seed, &hash);
+        }
+        return hash;
+    }
+
+public:
+    HlmsTester(Archive *dataFolder) : Hlms(dataFolder) {}
+
+    /// Same as calculateHashForBatch, but splitting the work in the given number of
+    /// threads, which are run one after another (in reverse) in the caller's thread
+    void calculateHashForBatchSplit(const RenderableParamsVec &renderables, size_t numThreads)
+    {
+        HashBatchTask task(this, renderables, numThreads);
+        for (size_t i = numThreads; i--; )
+            task.execute(i, numThreads);
+        task.mergeNewEntries(this);
+    }
+
+    const HlmsCache* getCache(uint32 hash) const    { return getRenderableCache(hash); }
+    size_t getNumCaches(void) const                 { return mRenderableCache.size(); }
+
+    int32 getCacheProperty(uint32 hash, IdString key) const
+    {
+        return getProperty(getRenderableCache(hash)->setProperties, key);
+    }
+
+    /// Adds a shader cache entry with the given sources (empty for stages without one)
+    void addShader(uint32 finalHash, const HlmsPropertyVec &properties,
+                   const String sources[NumShaderStages])
+    {
+        mSetProperties = properties;
+        createShaderCacheEntry(finalHash, sources);
+        mSetProperties.clear();
+    }
+
+    /// Asserts the entry exists, with the given properties & sources
+    void checkShader(uint32 finalHash, const HlmsPropertyVec &properties,
+                     const String sources[NumShaderStages]) const
+    {
+        const HlmsCache *cache = getShaderCache(finalHash);
+        CPPUNIT_ASSERT(cache);
+        CPPUNIT_ASSERT(samePropertyVecs(properties, cache->setProperties));
+
+        const GpuProgramPtr *shaders[NumShaderStages] =
+        {
+            &cache->vertexShader, &cache->pixelShader, &cache->geometryShader,
+            &cache->tesselationHullShader, &cache->tesselationDomainShader
+        };
+
+        for (size_t i = 0; i < NumShaderStages; ++i)
+        {
+            CPPUNIT_ASSERT_EQUAL(sources[i].empty(), shaders[i]->isNull());
+            if (!sources[i].empty())
+                CPPUNIT_ASSERT_EQUAL(sources[i], (*shaders[i])->getSource());
+        }
+    }
+
+    size_t getNumShaders(void) const                { return mShaderCache.size(); }
+    void setTemplateHash(uint32 templateHash)       { mTemplateHash = templateHash; }
+};
+
+//--------------------------------------------------------------------------
+void HlmsTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+    srand(0);
+
+    // The shader cache needs the GpuProgram managers
+    mRoot = OGRE_NEW Root(BLANKSTRING);
+
+#if OGRE_PLATFORM == OGRE_PLATFORM_APPLE
+    mTemplatesPath = macBundlePath() + "/Contents/Resources/Media/misc/HlmsTemplates";
+#elif OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+    mTemplatesPath = "../../Tests/OgreMain/misc/HlmsTemplates";
+#else
+    mTemplatesPath = "./Tests/OgreMain/misc/HlmsTemplates";
+#endif
+
+    // There are no templates to load, an empty folder is enough
+    mDataFolder = OGRE_NEW FileSystemArchive("HlmsTests_NoTemplates", "FileSystem", true);
+    // The renderables' vertex declarations need it
+    mBufferManager = OGRE_NEW DefaultHardwareBufferManager();
+}
+//--------------------------------------------------------------------------
+void HlmsTests::tearDown()
+{
+    OGRE_DELETE mBufferManager;
+    OGRE_DELETE mDataFolder;
+    OGRE_DELETE mRoot;
+}
+//--------------------------------------------------------------------------
+void HlmsTests::testBatchHashesMatchSerial()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // Position only, then normals & uvs, QTangents, tangents & skinning
+    const size_t numLayouts = 4;
+    VertexData *vertexData[numLayouts];
+    for (size_t i = 0; i < numLayouts; ++i)
+    {
+        vertexData[i] = OGRE_NEW VertexData();
+        VertexDeclaration *decl = vertexData[i]->vertexDeclaration;
+        size_t offset = 0;
+        offset += decl->addElement(0, offset, VET_FLOAT3, VES_POSITION).getSize();
+        if (i == 1 || i == 3)
+            offset += decl->addElement(0, offset, VET_FLOAT3, VES_NORMAL).getSize();
+        if (i == 2)
+            offset += decl->addElement(0, offset, VET_FLOAT4, VES_NORMAL).getSize();
+        if (i == 3)
+            offset += decl->addElement(0, offset, VET_FLOAT3, VES_TANGENT).getSize();
+        if (i > 0)
+            offset += decl->addElement(0, offset, VET_FLOAT2, VES_TEXTURE_COORDINATES, 0).getSize();
+        if (i == 2)
+            offset += decl->addElement(0, offset, VET_FLOAT3, VES_TEXTURE_COORDINATES, 1).getSize();
+        if (i == 3)
+        {
+            offset += decl->addElement(0, offset, VET_FLOAT4, VES_BLEND_WEIGHTS).getSize();
+            offset += decl->addElement(0, offset, VET_UBYTE4, VES_BLEND_INDICES).getSize();
+        }
+    }
+
+    // Every combination of material parameters, including our own
+    const IdString paramNames[] = { IdString("diffuse_map"), IdString("normal_map"),
+                                    IdString("specular_map"), IdString("alpha_test"), CustomFlag };
+    const size_t numParamNames = sizeof(paramNames) / sizeof(paramNames[0]);
+    vector<HlmsParamVec>::type paramSets(1u << numParamNames);
+    for (size_t i = 0; i < paramSets.size(); ++i)
+    {
+        for (size_t j = 0; j < numParamNames; ++j)
+        {
+            if (i & (1u << j))
+                paramSets[i].push_back(std::pair<IdString, String>(paramNames[j], "1"));
+        }
+        std::sort(paramSets[i].begin(), paramSets[i].end(), OrderParamVecByKey);
+    }
+
+    vector<HlmsTestRenderable*>::type renderables;
+    Hlms::RenderableParamsVec renderableParams;
+    for (size_t i = 0; i < 500; ++i)
+    {
+        renderables.push_back(OGRE_NEW HlmsTestRenderable(vertexData[rand() % numLayouts]));
+        renderableParams.push_back(Hlms::RenderableParams(renderables.back(),
+                                                          &paramSets[rand() % paramSets.size()]));
+    }
+
+    // One renderable at a time
+    HlmsTester serialHlms(mDataFolder);
+    vector<std::pair<uint32, uint32> >::type serialHashes;
+    for (size_t i = 0; i < renderables.size(); ++i)
+    {
+        renderables[i]->setHlms(&serialHlms, *renderableParams[i].params);
+        serialHashes.push_back(std::make_pair(renderables[i]->getHlmsHash(),
+                                              renderables[i]->getHlmsCasterHash()));
+    }
+
+    // In a batch, split in threads & without threads
+    HlmsTester splitHlms(mDataFolder);
+    HlmsTester batchHlms(mDataFolder);
+
+    HlmsTester *batchedHlms[2] = { &splitHlms, &batchHlms };
+    for (size_t h = 0; h < 2; ++h)
+    {
+        if (h == 0)
+            splitHlms.calculateHashForBatchSplit(renderableParams, 4);
+        else
+            batchHlms.calculateHashForBatch(renderableParams, 0);
+
+        CPPUNIT_ASSERT_EQUAL(serialHlms.getNumCaches(), batchedHlms[h]->getNumCaches());
+
+        for (size_t i = 0; i < renderables.size(); ++i)
+        {
+            const uint32 hash = renderables[i]->getHlmsHash();
+            const uint32 casterHash = renderables[i]->getHlmsCasterHash();
+            CPPUNIT_ASSERT_EQUAL(serialHashes[i].first, hash);
+            CPPUNIT_ASSERT_EQUAL(serialHashes[i].second, casterHash);
+
+            // Same properties behind the hashes, including the derived class' ones
+            CPPUNIT_ASSERT(samePropertyVecs(serialHlms.getCache(hash)->setProperties,
+                                            batchedHlms[h]->getCache(hash)->setProperties));
+            CPPUNIT_ASSERT(samePropertyVecs(serialHlms.getCache(casterHash)->setProperties,
+                                            batchedHlms[h]->getCache(casterHash)->setProperties));
+
+            const bool customFlag = std::find(renderableParams[i].params->begin(),
+                                              renderableParams[i].params->end(),
+                                              std::pair<IdString, String>(CustomFlag, "1")) !=
+                                    renderableParams[i].params->end();
+            CPPUNIT_ASSERT_EQUAL(customFlag ? 1 : 0, batchedHlms[h]->getCacheProperty(hash, CustomFlag));
+        }
+    }
+
+    for (size_t i = 0; i < renderables.size(); ++i)
+        OGRE_DELETE renderables[i];
+    for (size_t i = 0; i < numLayouts; ++i)
+        OGRE_DELETE vertexData[i];
+}
+//--------------------------------------------------------------------------
+void HlmsTests::testShaderCacheRoundTrip()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    CachedShaderDesc descs[NumCachedShaders];
+    createShaderDescs(descs);
+
+    DataStreamPtr stream;
+    {
+        HlmsTester hlms(mDataFolder);
+        for (size_t i = 0; i < NumCachedShaders; ++i)
+            hlms.addShader(descs[i].hash, descs[i].properties, descs[i].sources);
+        stream = saveShaderCache(hlms);
+        // The programs of the next Hlms will have the same names
+        hlms.clearShaderCache();
+    }
+
+    HlmsTester hlms(mDataFolder);
+    CPPUNIT_ASSERT_EQUAL(NumCachedShaders, hlms.loadShaderCache(stream, false));
+    CPPUNIT_ASSERT_EQUAL(NumCachedShaders, hlms.getNumShaders());
+    for (size_t i = 0; i < NumCachedShaders; ++i)
+        hlms.checkShader(descs[i].hash, descs[i].properties, descs[i].sources);
+
+    // Entries that are already in the cache are skipped
+    stream->seek(0);
+    CPPUNIT_ASSERT_EQUAL((size_t)0, hlms.loadShaderCache(stream, false));
+    CPPUNIT_ASSERT_EQUAL(NumCachedShaders, hlms.getNumShaders());
+
+    // Saving what was loaded gives the same file
+    DataStreamPtr resaved = saveShaderCache(hlms);
+    stream->seek(0);
+    CPPUNIT_ASSERT_EQUAL(stream->size(), resaved->size());
+    CPPUNIT_ASSERT(stream->getAsString() == resaved->getAsString());
+
+    hlms.clearShaderCache();
+}
+//--------------------------------------------------------------------------
+void HlmsTests::testShaderCacheRejectsTruncated()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    CachedShaderDesc descs[NumCachedShaders];
+    createShaderDescs(descs);
+
+    HlmsTester savedHlms(mDataFolder);
+    for (size_t i = 0; i < NumCachedShaders; ++i)
+        savedHlms.addShader(descs[i].hash, descs[i].properties, descs[i].sources);
+    const String file = saveShaderCache(savedHlms)->getAsString();
+    const uint32 templateHash = savedHlms.getTemplateHash();
+    savedHlms.clearShaderCache();
+
+    HlmsTester hlms(mDataFolder);
+
+    // Cut at every byte, including inside the header & the counts. Nothing
+    // may be added, not even the entries before the cut.
+    for (size_t i = 0; i < file.size(); ++i)
+    {
+        DataStreamPtr stream = createStream(file, i);
+        CPPUNIT_ASSERT_EQUAL((size_t)0, hlms.loadShaderCache(stream, false));
+        CPPUNIT_ASSERT_EQUAL((size_t)0, hlms.getNumShaders());
+    }
+
+    // Entry count far beyond the size of the file
+    {
+        String corrupted = file;
+        const uint32 numEntries = 0xFFFFFFFF;
+        memcpy(&corrupted[sizeof(uint32) * 4], &numEntries, sizeof(uint32));
+        DataStreamPtr stream = createStream(corrupted, corrupted.size());
+        CPPUNIT_ASSERT_EQUAL((size_t)0, hlms.loadShaderCache(stream, false));
+        CPPUNIT_ASSERT_EQUAL((size_t)0, hlms.getNumShaders());
+    }
+
+    DataStreamPtr stream = createStream(file, file.size());
+
+    // Saved with other templates
+    hlms.setTemplateHash(templateHash + 1);
+    CPPUNIT_ASSERT_EQUAL((size_t)0, hlms.loadShaderCache(stream, false));
+    CPPUNIT_ASSERT_EQUAL((size_t)0, hlms.getNumShaders());
+
+    // The intact file still loads
+    hlms.setTemplateHash(templateHash);
+    stream->seek(0);
+    CPPUNIT_ASSERT_EQUAL(NumCachedShaders, hlms.loadShaderCache(stream, false));
+    hlms.clearShaderCache();
+}
+//--------------------------------------------------------------------------
+void HlmsTests::testAsyncShaderGeneration()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    Archive *templates = OGRE_NEW FileSystemArchive(mTemplatesPath, "FileSystem", true);
+    templates->load();
+    mRoot->getWorkQueue()->startup();
+
+    ObjectMemoryManager objectMemoryManager;
+    HlmsTestObject *movableObject = OGRE_NEW HlmsTestObject(&objectMemoryManager);
+    VertexData *vertexData = createVertexData();
+    HlmsTestRenderable renderable(vertexData);
+    HlmsTestRenderable plainRenderable(vertexData);
+
+    HlmsParamVec diffuseParams;
+    diffuseParams.push_back(std::pair<IdString, String>(IdString("diffuse_map"), "1"));
+    const HlmsParamVec noParams;
+    const HlmsCache passCache(0);
+
+    // What getMaterial generates when it doesn't run in the background
+    String expectedSources[2];
+    {
+        HlmsTester hlms(templates);
+        renderable.setHlms(&hlms, diffuseParams);
+        const HlmsCache *cache = hlms.getMaterial(passCache, &renderable, movableObject, false);
+        CPPUNIT_ASSERT(cache);
+        CPPUNIT_ASSERT(!cache->vertexShader.isNull() && !cache->pixelShader.isNull());
+        expectedSources[0] = cache->vertexShader->getSource();
+        expectedSources[1] = cache->pixelShader->getSource();
+        CPPUNIT_ASSERT(expectedSources[0].find("uv0") != String::npos);
+        hlms.clearShaderCache();
+    }
+
+    HlmsTester hlms(templates);
+    renderable.setHlms(&hlms, diffuseParams);
+    plainRenderable.setHlms(&hlms, noParams);
+    hlms.setAsyncShaderGeneration(true);
+
+    // Without a fallback the renderable is skipped until its shaders arrive.
+    // Asking again doesn't queue it twice.
+    CPPUNIT_ASSERT(!hlms.getMaterial(passCache, &renderable, movableObject, false));
+    CPPUNIT_ASSERT(!hlms.getMaterial(passCache, &renderable, movableObject, false));
+    CPPUNIT_ASSERT_EQUAL((size_t)1, hlms.getNumPendingShaders());
+
+    waitForShaders(hlms);
+    CPPUNIT_ASSERT_EQUAL((size_t)0, hlms.getNumPendingShaders());
+    CPPUNIT_ASSERT_EQUAL((size_t)1, hlms.getNumShaders());
+
+    const HlmsCache *cache = hlms.getMaterial(passCache, &renderable, movableObject, false);
+    CPPUNIT_ASSERT(cache);
+    CPPUNIT_ASSERT_EQUAL(expectedSources[0], cache->vertexShader->getSource());
+    CPPUNIT_ASSERT_EQUAL(expectedSources[1], cache->pixelShader->getSource());
+
+    // With a fallback, new permutations get its shaders meanwhile
+    const uint32 diffuseHash = cache->hash;
+    const GpuProgramPtr diffuseVertexShader = cache->vertexShader;
+    hlms.setFallbackCache(cache);
+
+    cache = hlms.getMaterial(passCache, &plainRenderable, movableObject, false);
+    CPPUNIT_ASSERT(cache);
+    CPPUNIT_ASSERT_EQUAL(diffuseHash, cache->hash);
+    CPPUNIT_ASSERT(cache->vertexShader == diffuseVertexShader);
+    CPPUNIT_ASSERT_EQUAL((size_t)1, hlms.getNumPendingShaders());
+
+    waitForShaders(hlms);
+    CPPUNIT_ASSERT_EQUAL((size_t)2, hlms.getNumShaders());
+
+    cache = hlms.getMaterial(passCache, &plainRenderable, movableObject, false);
+    CPPUNIT_ASSERT(cache);
+    CPPUNIT_ASSERT(cache->hash != diffuseHash);
+    CPPUNIT_ASSERT(cache->vertexShader->getSource().find("uv0") == String::npos);
+
+    hlms.setAsyncShaderGeneration(false);
+    hlms.clearShaderCache();
+
+    OGRE_DELETE vertexData;
+    OGRE_DELETE movableObject;
+    OGRE_DELETE templates;
+}
+//--------------------------------------------------------------------------
+void HlmsTests::testAsyncShaderGenerationDestroyInFlight()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    Archive *templates = OGRE_NEW FileSystemArchive(mTemplatesPath, "FileSystem", true);
+    templates->load();
+    mRoot->getWorkQueue()->startup();
+
+    ObjectMemoryManager objectMemoryManager;
+    HlmsTestObject *movableObject = OGRE_NEW HlmsTestObject(&objectMemoryManager);
+    VertexData *vertexData = createVertexData();
+
+    // A permutation for each combination of these
+    const IdString paramNames[] = { IdString("diffuse_map"), IdString("specular_map"),
+                                    IdString("alpha_test") };
+    const size_t numPermutations = 8;
+    vector<HlmsParamVec>::type paramSets(numPermutations);
+    vector<HlmsTestRenderable*>::type renderables;
+    for (size_t i = 0; i < numPermutations; ++i)
+    {
+        for (size_t j = 0; j < 3; ++j)
+        {
+            if (i & (1u << j))
+                paramSets[i].push_back(std::pair<IdString, String>(paramNames[j], "1"));
+        }
+        std::sort(paramSets[i].begin(), paramSets[i].end(), OrderParamVecByKey);
+        renderables.push_back(OGRE_NEW HlmsTestRenderable(vertexData));
+    }
+
+    const HlmsCache passCache(0);
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        HlmsTester *hlms = OGRE_NEW HlmsTester(templates);
+        hlms->setAsyncShaderGeneration(true);
+        for (size_t j = 0; j < numPermutations; ++j)
+        {
+            renderables[j]->setHlms(hlms, paramSets[j]);
+            hlms->getMaterial(passCache, renderables[j], movableObject, false);
+        }
+        CPPUNIT_ASSERT_EQUAL(numPermutations, hlms->getNumPendingShaders());
+
+        // Some requests are waiting, some may be running in a worker thread
+        OGRE_DELETE hlms;
+
+        // A new Hlms (quite likely at the same address) must not get the old requests
+        hlms = OGRE_NEW HlmsTester(templates);
+        hlms->setAsyncShaderGeneration(true);
+        for (size_t j = 0; j < 20; ++j)
+        {
+            Threads::Sleep(5);
+            mRoot->getWorkQueue()->processResponses();
+        }
+        CPPUNIT_ASSERT_EQUAL((size_t)0, hlms->getNumShaders());
+        OGRE_DELETE hlms;
+    }
+
+    for (size_t i = 0; i < numPermutations; ++i)
+        OGRE_DELETE renderables[i];
+    OGRE_DELETE vertexData;
+    OGRE_DELETE movableObject;
+    OGRE_DELETE templates;
+}
+//--------------------------------------------------------------------------
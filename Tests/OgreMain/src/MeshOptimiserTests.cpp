@@ -0,0 +1,212 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "MeshOptimiserTests.h"
+#include "UnitTestSuite.h"
+
+#include "OgreMeshOptimiser.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(MeshOptimiserTests);
+
+namespace
+{
+    const uint32 GRID_SIZE = 40;
+
+    /// Triangles of a GRID_SIZE x GRID_SIZE quad grid, in random order.
+    void createShuffledGrid(vector<uint32>::type& indices, vector<float>::type& positions)
+    {
+        positions.clear();
+        for (uint32 y = 0; y <= GRID_SIZE; ++y)
+        {
+            for (uint32 x = 0; x <= GRID_SIZE; ++x)
+            {
+                positions.push_back(static_cast<float>(x));
+                positions.push_back(static_cast<float>(y));
+                positions.push_back(0.0f);
+            }
+        }
+
+        vector<uint32>::type triangles;
+        for (uint32 y = 0; y < GRID_SIZE; ++y)
+        {
+            for (uint32 x = 0; x < GRID_SIZE; ++x)
+            {
+                const uint32 v = y * (GRID_SIZE + 1) + x;
+                const uint32 quad[6] = { v, v + 1, v + GRID_SIZE + 1,
+                                         v + 1, v + GRID_SIZE + 2, v + GRID_SIZE + 1 };
+                triangles.insert(triangles.end(), quad, quad + 6);
+            }
+        }
+
+        indices.clear();
+        const size_t triangleCount = triangles.size() / 3;
+        vector<size_t>::type order(triangleCount);
+        for (size_t i = 0; i < triangleCount; ++i)
+            order[i] = i;
+        for (size_t i = triangleCount - 1; i > 0; --i)
+            std::swap(order[i], order[rand() % (i + 1)]);
+        for (size_t i = 0; i < triangleCount; ++i)
+            indices.insert(indices.end(), triangles.begin() + order[i] * 3,
+                           triangles.begin() + order[i] * 3 + 3);
+    }
+
+    /// Sorted list of the triangles, to check that reordering kept all of them.
+    vector<uint64>::type getSortedTriangles(const uint32* indices, size_t triangleCount)
+    {
+        vector<uint64>::type triangles(triangleCount);
+        for (size_t i = 0; i < triangleCount; ++i)
+        {
+            triangles[i] = (static_cast<uint64>(indices[i * 3]) << 42) |
+                           (static_cast<uint64>(indices[i * 3 + 1]) << 21) |
+                            static_cast<uint64>(indices[i * 3 + 2]);
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+
+    size_t getCacheMisses(const vector<uint32>::type& indices)
+    {
+        const size_t triangleCount = indices.size() / 3;
+        return static_cast<size_t>(MeshOptimiser::calculateAcmr(&indices[0], triangleCount * 3) *
+                                   triangleCount + 0.5f);
+    }
+}
+
+//--------------------------------------------------------------------------
+void MeshOptimiserTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+    srand(0);
+}
+//--------------------------------------------------------------------------
+void MeshOptimiserTests::tearDown()
+{
+}
+//--------------------------------------------------------------------------
+void MeshOptimiserTests::testVertexCache()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    vector<uint32>::type indices;
+    vector<float>::type positions;
+    createShuffledGrid(indices, positions);
+    const size_t vertexCount = positions.size() / 3;
+    const vector<uint64>::type triangles = getSortedTriangles(&indices[0], indices.size() / 3);
+    const Real acmrBefore = MeshOptimiser::calculateAcmr(&indices[0], indices.size());
+
+    MeshOptimiser::optimiseVertexCache(&indices[0], indices.size(), vertexCount);
+
+    CPPUNIT_ASSERT(getSortedTriangles(&indices[0], indices.size() / 3) == triangles);
+    // A shuffled grid misses nearly every vertex. An optimised one is close to 0.5
+    CPPUNIT_ASSERT(acmrBefore > 2.0f);
+    CPPUNIT_ASSERT(MeshOptimiser::calculateAcmr(&indices[0], indices.size()) < 0.8f);
+}
+//--------------------------------------------------------------------------
+void MeshOptimiserTests::testPartialTriangle()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    vector<uint32>::type indices;
+    vector<float>::type positions;
+    createShuffledGrid(indices, positions);
+    const size_t vertexCount = positions.size() / 3;
+    const size_t triangleCount = indices.size() / 3;
+    const vector<uint64>::type triangles = getSortedTriangles(&indices[0], triangleCount);
+
+    // Two indices that don't form a triangle must survive both passes unchanged
+    indices.push_back(7);
+    indices.push_back(9);
+
+    MeshOptimiser::optimiseVertexCache(&indices[0], indices.size(), vertexCount);
+    CPPUNIT_ASSERT_EQUAL(triangleCount * 3 + 2, indices.size());
+    CPPUNIT_ASSERT_EQUAL((uint32)7, indices[triangleCount * 3]);
+    CPPUNIT_ASSERT_EQUAL((uint32)9, indices[triangleCount * 3 + 1]);
+    CPPUNIT_ASSERT(getSortedTriangles(&indices[0], triangleCount) == triangles);
+
+    MeshOptimiser::optimiseOverdraw(&indices[0], indices.size(), &positions[0],
+                                    sizeof(float) * 3, vertexCount);
+    CPPUNIT_ASSERT_EQUAL((uint32)7, indices[triangleCount * 3]);
+    CPPUNIT_ASSERT_EQUAL((uint32)9, indices[triangleCount * 3 + 1]);
+    CPPUNIT_ASSERT(getSortedTriangles(&indices[0], triangleCount) == triangles);
+}
+//--------------------------------------------------------------------------
+void MeshOptimiserTests::testDegenerateTriangles()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    vector<uint32>::type indices;
+    vector<float>::type positions;
+    createShuffledGrid(indices, positions);
+    const size_t vertexCount = positions.size() / 3;
+
+    const size_t realTriangleCount = indices.size() / 3;
+
+    // Every fourth triangle gets a degenerate copy, alternating between (a, a, a) and
+    // (a, a, b). They only use vertices of real triangles and shouldn't cost extra misses.
+    vector<uint32>::type degenerateIndices;
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        degenerateIndices.insert(degenerateIndices.end(), indices.begin() + i, indices.begin() + i + 3);
+        if (i % 12 == 0)
+        {
+            const uint32 degenerate[3] = { indices[i], indices[i], indices[i + (i % 24 ? 1 : 0)] };
+            degenerateIndices.insert(degenerateIndices.end(), degenerate, degenerate + 3);
+        }
+    }
+    const size_t triangleCount = degenerateIndices.size() / 3;
+    const vector<uint64>::type triangles = getSortedTriangles(&degenerateIndices[0], triangleCount);
+
+    MeshOptimiser::optimiseVertexCache(&degenerateIndices[0], degenerateIndices.size(), vertexCount);
+
+    CPPUNIT_ASSERT(getSortedTriangles(&degenerateIndices[0], triangleCount) == triangles);
+    CPPUNIT_ASSERT(getCacheMisses(degenerateIndices) < realTriangleCount * 8 / 10);
+}
+//--------------------------------------------------------------------------
+void MeshOptimiserTests::testOverdraw()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    vector<uint32>::type indices;
+    vector<float>::type positions;
+    createShuffledGrid(indices, positions);
+    const size_t vertexCount = positions.size() / 3;
+    const size_t triangleCount = indices.size() / 3;
+    const vector<uint64>::type triangles = getSortedTriangles(&indices[0], triangleCount);
+
+    MeshOptimiser::optimiseVertexCache(&indices[0], indices.size(), vertexCount);
+    const Real acmr = MeshOptimiser::calculateAcmr(&indices[0], indices.size());
+
+    MeshOptimiser::optimiseOverdraw(&indices[0], indices.size(), &positions[0],
+                                    sizeof(float) * 3, vertexCount);
+
+    CPPUNIT_ASSERT(getSortedTriangles(&indices[0], triangleCount) == triangles);
+    // Clusters are only split where it costs at most 5% more cache misses
+    CPPUNIT_ASSERT(MeshOptimiser::calculateAcmr(&indices[0], indices.size()) <= acmr * 1.06f);
+}
@@ -45,6 +45,11 @@ THE SOFTWARE.
 #include "OgreMaterialManager.h"
 #include "OgreLodStrategyManager.h"
 #include "OgreSkeleton.h"
+#include "OgreAnimation.h"
+#include "OgreAnimationTrack.h"
+#include "OgreKeyFrame.h"
+#include "OgrePose.h"
+#include "Threading/OgreDefaultWorkQueue.h"
 
 #include "UnitTestSuite.h"
 
@@ -75,6 +80,7 @@ CPPUNIT_TEST_SUITE_REGISTRATION(MeshSerializerTests);
 void MeshSerializerTests::setUp()
 {
     mErrorFactor = 0.05;
+    mVertexTolerance = 0;
 
     mFSLayer = OGRE_NEW_T(Ogre::FileSystemLayer, Ogre::MEMCATEGORY_GENERAL)(OGRE_VERSION_NAME);
 
@@ -216,10 +222,204 @@ void MeshSerializerTests::testSkeleton_Version_1_0()
     }
 }
 //--------------------------------------------------------------------------
+void MeshSerializerTests::testMesh_Version_2_0()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    testMesh(MESH_VERSION_2_0);
+}
+//--------------------------------------------------------------------------
+void MeshSerializerTests::testMesh_Version_2_0_Compressed()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    MeshSerializer serializer;
+    serializer.setGeometryCompression(true);
+    serializer.exportMesh(mOrigMesh.get(), mMeshFullPath, MESH_VERSION_2_0);
+    mMesh->reload();
+
+    // Quantized positions, normals & uvs come back close but not identical
+    mVertexTolerance = 0.01;
+    assertMeshClone(mOrigMesh.get(), mMesh.get(), MESH_VERSION_2_0);
+    mVertexTolerance = 0;
+}
+//--------------------------------------------------------------------------
+static void scaleNormals(VertexData* vertexData)
+{
+    if (!vertexData)
+        return;
+
+    const VertexElement* normalElem =
+        vertexData->vertexDeclaration->findElementBySemantic(VES_NORMAL);
+    if (!normalElem || normalElem->getType() != VET_FLOAT3)
+        return;
+
+    HardwareVertexBufferSharedPtr vbuf =
+        vertexData->vertexBufferBinding->getBuffer(normalElem->getSource());
+    unsigned char* vertex = static_cast<unsigned char*>(vbuf->lock(HardwareBuffer::HBL_NORMAL));
+    for (size_t i = 0; i < vertexData->vertexCount; ++i, vertex += vbuf->getVertexSize())
+    {
+        float* normal;
+        normalElem->baseVertexPointerToElement(vertex, &normal);
+        // Lengths between 0 & 3, including zero vectors
+        const float scale = (i % 7) * 0.5f;
+        for (int c = 0; c < 3; ++c)
+            normal[c] *= scale;
+    }
+    vbuf->unlock();
+}
+//--------------------------------------------------------------------------
+void MeshSerializerTests::testMesh_Version_2_0_CompressedNonUnitNormals()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // The octahedral encoding would bring these back as unit vectors,
+    // they must come back with their length instead
+    scaleNormals(mOrigMesh->sharedVertexData);
+    for (unsigned short i = 0; i < mOrigMesh->getNumSubMeshes(); ++i)
+        scaleNormals(mOrigMesh->getSubMesh(i)->vertexData);
+
+    MeshSerializer serializer;
+    serializer.setGeometryCompression(true);
+    serializer.exportMesh(mOrigMesh.get(), mMeshFullPath, MESH_VERSION_2_0);
+    mMesh->reload();
+
+    mVertexTolerance = 0.01;
+    assertMeshClone(mOrigMesh.get(), mMesh.get(), MESH_VERSION_2_0);
+    mVertexTolerance = 0;
+}
+//--------------------------------------------------------------------------
+static ushort getAnimationTarget(Mesh* mesh)
+{
+    // Track handle 0 is the shared geometry, submesh i is handle i + 1
+    return mesh->getSubMesh(0)->useSharedVertices ? 0 : 1;
+}
+//--------------------------------------------------------------------------
+static void addMorphAnimation(Mesh* mesh)
+{
+    const ushort target = getAnimationTarget(mesh);
+    const size_t vertexCount = mesh->getVertexDataByTrackHandle(target)->vertexCount;
+
+    Animation* anim = mesh->createAnimation("ParallelImportMorph", 2.0f);
+    VertexAnimationTrack* track = anim->createVertexTrack(
+        target, mesh->getVertexDataByTrackHandle(target), VAT_MORPH);
+    for (int k = 0; k < 3; ++k)
+    {
+        // Positions & normals
+        const size_t floatsPerVertex = 6;
+        HardwareVertexBufferSharedPtr vbuf =
+            HardwareBufferManager::getSingleton().createVertexBuffer(
+                sizeof(float) * floatsPerVertex, vertexCount, HardwareBuffer::HBU_STATIC, true);
+        float* pDst = static_cast<float*>(vbuf->lock(HardwareBuffer::HBL_DISCARD));
+        for (size_t i = 0; i < vertexCount * floatsPerVertex; ++i)
+            pDst[i] = Math::RangeRandom(-10.0f, 10.0f);
+        vbuf->unlock();
+        track->createVertexMorphKeyFrame(k * 1.0f)->setVertexBuffer(vbuf);
+    }
+}
+//--------------------------------------------------------------------------
+static void addPoseAnimation(Mesh* mesh)
+{
+    const ushort target = getAnimationTarget(mesh);
+    const size_t vertexCount = mesh->getVertexDataByTrackHandle(target)->vertexCount;
+
+    for (int p = 0; p < 4; ++p)
+    {
+        Pose* pose = mesh->createPose(target, "ParallelImportPose" + StringConverter::toString(p));
+        for (size_t i = p; i < vertexCount; i += 3)
+        {
+            const Vector3 offset(Math::RangeRandom(-1.0f, 1.0f), Math::RangeRandom(-1.0f, 1.0f),
+                                 Math::RangeRandom(-1.0f, 1.0f));
+            if (p % 2)
+                pose->addVertex(i, offset, Vector3::UNIT_Y);
+            else
+                pose->addVertex(i, offset);
+        }
+    }
+
+    Animation* anim = mesh->createAnimation("ParallelImportPose", 4.0f);
+    VertexAnimationTrack* track = anim->createVertexTrack(
+        target, mesh->getVertexDataByTrackHandle(target), VAT_POSE);
+    for (int k = 0; k < 5; ++k)
+    {
+        // The first keyframe references no pose at all
+        VertexPoseKeyFrame* kf = track->createVertexPoseKeyFrame(k * 1.0f);
+        for (int p = 0; p < k; ++p)
+            kf->addPoseReference(p, Math::UnitRandom());
+    }
+}
+//--------------------------------------------------------------------------
+static MeshPtr importFromMemory(const String& path, const String& name, WorkQueue* workQueue)
+{
+    std::ifstream* file = OGRE_NEW_T(std::ifstream, MEMCATEGORY_GENERAL)();
+    file->open(path.c_str(), std::ios::in | std::ios::binary);
+    DataStreamPtr fileStream(OGRE_NEW FileStreamDataStream(path, file, true));
+    // Only streams held in memory are decoded by several threads
+    DataStreamPtr stream(OGRE_NEW MemoryDataStream(path, fileStream));
+
+    MeshPtr mesh = MeshManager::getSingleton().createManual(
+        name, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+    MeshSerializer serializer;
+    serializer.setImportWorkQueue(workQueue);
+    serializer.importMesh(stream, mesh.get());
+    return mesh;
+}
+//--------------------------------------------------------------------------
+void MeshSerializerTests::testMesh_Version_2_0_ParallelImport()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    DefaultWorkQueue workQueue("MeshSerializerTests");
+    workQueue.setWorkerThreadCount(2);
+    workQueue.startup();
+
+    // Compressed and byte swapped data is what the other threads decode
+    const bool compressed[4] = { false, true, false, true };
+    const Serializer::Endian endianModes[4] = { Serializer::ENDIAN_NATIVE, Serializer::ENDIAN_NATIVE,
+                                                     Serializer::ENDIAN_BIG, Serializer::ENDIAN_BIG };
+
+    // Morph & pose animations can't target the same geometry, test them separately
+    for (int round = 0; round < 2; ++round)
+    {
+        const String roundName = "ParallelImport" + StringConverter::toString(round);
+        MeshPtr source = mOrigMesh->clone(roundName + ".mesh", mOrigMesh->getGroup());
+        if (round == 0)
+            addMorphAnimation(source.get());
+        else
+            addPoseAnimation(source.get());
+
+        for (int i = 0; i < 4; ++i)
+        {
+            MeshSerializer serializer;
+            serializer.setGeometryCompression(compressed[i]);
+            serializer.exportMesh(source.get(), mMeshFullPath, MESH_VERSION_2_0, endianModes[i]);
+
+            const String name = roundName + "_" + StringConverter::toString(i);
+            MeshPtr serialMesh = importFromMemory(mMeshFullPath, name + ".serial.mesh", 0);
+            MeshPtr parallelMesh = importFromMemory(mMeshFullPath, name + ".parallel.mesh",
+                                                    &workQueue);
+
+            // Both decode the very same data, so they must match exactly
+            assertMeshClone(serialMesh.get(), parallelMesh.get(), MESH_VERSION_2_0);
+            assertVertexAnimationClone(serialMesh.get(), parallelMesh.get());
+            CPPUNIT_ASSERT_EQUAL(source->getNumAnimations(), parallelMesh->getNumAnimations());
+            CPPUNIT_ASSERT_EQUAL(source->getPoseCount(), parallelMesh->getPoseCount());
+
+            MeshManager::getSingleton().remove(serialMesh->getHandle());
+            MeshManager::getSingleton().remove(parallelMesh->getHandle());
+        }
+
+        MeshManager::getSingleton().remove(source->getHandle());
+    }
+
+    workQueue.shutdown();
+}
+//--------------------------------------------------------------------------
 void MeshSerializerTests::testMesh_Version_1_10()
 {
     UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
 
+    // The default version
     testMesh(MESH_VERSION_LATEST);
 }
 //--------------------------------------------------------------------------
@@ -279,6 +479,7 @@ void MeshSerializerTests::testMesh_Version_1_2()
             }
             mOrigMesh = mMesh->clone(mMesh->getName() + ".orig.mesh", mMesh->getGroup());
             testMesh_XML();
+            testMesh(MESH_VERSION_2_0);
             testMesh(MESH_VERSION_1_10);
             testMesh(MESH_VERSION_1_8);
             testMesh(MESH_VERSION_1_7);
@@ -426,6 +627,62 @@ void MeshSerializerTests::assertMeshClone(Mesh* a, Mesh* b, MeshVersion version
     }
 }
 //--------------------------------------------------------------------------
+void MeshSerializerTests::assertVertexAnimationClone(Mesh* a, Mesh* b)
+{
+    CPPUNIT_ASSERT_EQUAL(a->getPoseCount(), b->getPoseCount());
+    for (ushort i = 0; i < a->getPoseCount(); ++i) {
+        Pose* aPose = a->getPose(i);
+        Pose* bPose = b->getPose(i);
+        CPPUNIT_ASSERT(aPose->getName() == bPose->getName());
+        CPPUNIT_ASSERT(aPose->getTarget() == bPose->getTarget());
+        CPPUNIT_ASSERT(aPose->getVertexOffsets() == bPose->getVertexOffsets());
+        CPPUNIT_ASSERT(aPose->getNormals() == bPose->getNormals());
+    }
+
+    CPPUNIT_ASSERT_EQUAL(a->getNumAnimations(), b->getNumAnimations());
+    for (ushort i = 0; i < a->getNumAnimations(); ++i) {
+        Animation* aAnim = a->getAnimation(i);
+        Animation* bAnim = b->getAnimation(i);
+        CPPUNIT_ASSERT(aAnim->getName() == bAnim->getName());
+        CPPUNIT_ASSERT_EQUAL(aAnim->getNumVertexTracks(), bAnim->getNumVertexTracks());
+
+        Animation::VertexTrackIterator aTracks = aAnim->getVertexTrackIterator();
+        while (aTracks.hasMoreElements()) {
+            VertexAnimationTrack* aTrack = aTracks.getNext();
+            VertexAnimationTrack* bTrack = bAnim->getVertexTrack(aTrack->getHandle());
+            CPPUNIT_ASSERT(aTrack->getAnimationType() == bTrack->getAnimationType());
+            CPPUNIT_ASSERT_EQUAL(aTrack->getNumKeyFrames(), bTrack->getNumKeyFrames());
+
+            for (unsigned short k = 0; k < aTrack->getNumKeyFrames(); ++k) {
+                if (aTrack->getAnimationType() == VAT_MORPH) {
+                    VertexMorphKeyFrame* aKf = aTrack->getVertexMorphKeyFrame(k);
+                    VertexMorphKeyFrame* bKf = bTrack->getVertexMorphKeyFrame(k);
+                    CPPUNIT_ASSERT_EQUAL(aKf->getTime(), bKf->getTime());
+                    HardwareVertexBufferSharedPtr aBuf = aKf->getVertexBuffer();
+                    HardwareVertexBufferSharedPtr bBuf = bKf->getVertexBuffer();
+                    CPPUNIT_ASSERT_EQUAL(aBuf->getSizeInBytes(), bBuf->getSizeInBytes());
+                    const void* aData = aBuf->lock(HardwareBuffer::HBL_READ_ONLY);
+                    const void* bData = bBuf->lock(HardwareBuffer::HBL_READ_ONLY);
+                    CPPUNIT_ASSERT(memcmp(aData, bData, aBuf->getSizeInBytes()) == 0);
+                    aBuf->unlock();
+                    bBuf->unlock();
+                } else {
+                    VertexPoseKeyFrame* aKf = aTrack->getVertexPoseKeyFrame(k);
+                    VertexPoseKeyFrame* bKf = bTrack->getVertexPoseKeyFrame(k);
+                    CPPUNIT_ASSERT_EQUAL(aKf->getTime(), bKf->getTime());
+                    const VertexPoseKeyFrame::PoseRefList& aRefs = aKf->getPoseReferences();
+                    const VertexPoseKeyFrame::PoseRefList& bRefs = bKf->getPoseReferences();
+                    CPPUNIT_ASSERT_EQUAL(aRefs.size(), bRefs.size());
+                    for (size_t r = 0; r < aRefs.size(); ++r) {
+                        CPPUNIT_ASSERT_EQUAL(aRefs[r].poseIndex, bRefs[r].poseIndex);
+                        CPPUNIT_ASSERT_EQUAL(aRefs[r].influence, bRefs[r].influence);
+                    }
+                }
+            }
+        }
+    }
+}
+//--------------------------------------------------------------------------
 bool MeshSerializerTests::isLodMixed(const Mesh* pMesh)
 {
     if (!pMesh->hasManualLodLevel()) {
@@ -493,7 +750,12 @@ void MeshSerializerTests::assertVertexDataClone(VertexData* a, VertexData* b, Me
                     float* afloat, * bfloat;
                     aElem.baseVertexPointerToElement(avertex, &afloat);
                     bElem.baseVertexPointerToElement(bvertex, &bfloat);
-                    error |= (memcmp(afloat, bfloat, elemSize) != 0);
+                    if (mVertexTolerance > 0 && VertexElement::getBaseType(aElem.getType()) == VET_FLOAT1) {
+                        for (unsigned short c = 0; c < VertexElement::getTypeCount(aElem.getType()); c++)
+                            error |= std::abs(afloat[c] - bfloat[c]) > mVertexTolerance;
+                    } else {
+                        error |= (memcmp(afloat, bfloat, elemSize) != 0);
+                    }
                 }
                 abuf->unlock();
                 bbuf->unlock();
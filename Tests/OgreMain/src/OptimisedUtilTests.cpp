@@ -0,0 +1,485 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OptimisedUtilTests.h"
+#include "UnitTestSuite.h"
+
+#include "OgreOptimisedUtil.h"
+#include "OgreSoftwareVertexAnimationTask.h"
+#include "OgreMatrix4.h"
+#include "OgreVector4.h"
+#include "OgreQuaternion.h"
+#include "OgreMath.h"
+
+#include <cstring>
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(OptimisedUtilTests);
+
+namespace
+{
+    const float Sentinel = 12345.0f;
+    const size_t NumMatrices = 8;
+
+    /// Same as OptimisedUtilGeneral::softwareVertexSkinning, which isn't exported
+    void referenceSkinning(const float* srcPos, float* dstPos, const float* srcNorm, float* dstNorm,
+                           const float* blendWeight, const unsigned char* blendIndex,
+                           const Matrix4* const* blendMatrices,
+                           size_t srcPosStride, size_t dstPosStride,
+                           size_t srcNormStride, size_t dstNormStride,
+                           size_t blendWeightStride, size_t blendIndexStride,
+                           size_t numWeightsPerVertex, size_t numVertices)
+    {
+        for (size_t i = 0; i < numVertices; ++i)
+        {
+            const Vector3 sourceVec(srcPos[0], srcPos[1], srcPos[2]);
+            Vector3 accumVecPos(Vector3::ZERO);
+            Vector3 accumVecNorm(Vector3::ZERO);
+
+            for (size_t j = 0; j < numWeightsPerVertex; ++j)
+            {
+                const Real weight = blendWeight[j];
+                const Matrix4& mat = *blendMatrices[blendIndex[j]];
+                accumVecPos += mat.transformAffine(sourceVec) * weight;
+                if (srcNorm)
+                {
+                    const Vector4 norm = mat.transformAffine(
+                                Vector4(srcNorm[0], srcNorm[1], srcNorm[2], 0.0f));
+                    accumVecNorm += Vector3(norm.x, norm.y, norm.z) * weight;
+                }
+            }
+
+            dstPos[0] = accumVecPos.x;
+            dstPos[1] = accumVecPos.y;
+            dstPos[2] = accumVecPos.z;
+
+            if (srcNorm)
+            {
+                accumVecNorm.normalise();
+                dstNorm[0] = accumVecNorm.x;
+                dstNorm[1] = accumVecNorm.y;
+                dstNorm[2] = accumVecNorm.z;
+                advanceRawPointer(srcNorm, srcNormStride);
+                advanceRawPointer(dstNorm, dstNormStride);
+            }
+
+            advanceRawPointer(srcPos, srcPosStride);
+            advanceRawPointer(dstPos, dstPosStride);
+            advanceRawPointer(blendWeight, blendWeightStride);
+            advanceRawPointer(blendIndex, blendIndexStride);
+        }
+    }
+
+    /// Same as OptimisedUtilGeneral::softwareVertexMorph, with packed buffers
+    void referenceMorph(Real t, const float* srcPos1, const float* srcPos2, float* dstPos,
+                        size_t numVertices, bool morphNormals)
+    {
+        for (size_t i = 0; i < numVertices; ++i)
+        {
+            for (size_t j = 0; j < 3; ++j)
+                *dstPos++ = srcPos1[j] + t * (srcPos2[j] - srcPos1[j]);
+            srcPos1 += 3;
+            srcPos2 += 3;
+
+            if (morphNormals)
+            {
+                Vector3 nlerpNormal;
+                for (size_t j = 0; j < 3; ++j)
+                    nlerpNormal[j] = srcPos1[j] + t * (srcPos2[j] - srcPos1[j]);
+                nlerpNormal.normalise();
+                for (size_t j = 0; j < 3; ++j)
+                    *dstPos++ = nlerpNormal[j];
+                srcPos1 += 3;
+                srcPos2 += 3;
+            }
+        }
+    }
+
+    /// Vertex layouts the engine blends
+    enum SkinningLayout
+    {
+        PositionsOnly,
+        PackedPositionsAndNormals,
+        InterleavedWithUvs,
+        SeparateNormals,
+        NumSkinningLayouts
+    };
+
+    /// Source & destination buffers of a skinning call. The buffers start misalign
+    /// floats past their (aligned) beginning, and the destinations are filled with
+    /// Sentinel so that writes outside the vertices can be spotted.
+    struct SkinningBuffers
+    {
+        vector<float>::type src, srcNormals, dst, dstNormals, weights;
+        vector<unsigned char>::type indices;
+        size_t numVertices, numWeights, misalign;
+        size_t posStride, normStride;
+        bool hasNormals, separateNormals;
+
+        SkinningBuffers(SkinningLayout layout, size_t _numVertices, size_t _numWeights,
+                        size_t _misalign) :
+            numVertices(_numVertices), numWeights(_numWeights), misalign(_misalign),
+            hasNormals(layout != PositionsOnly), separateNormals(layout == SeparateNormals)
+        {
+            const size_t floatsPerVertex = layout == PackedPositionsAndNormals ? 6 :
+                                           layout == InterleavedWithUvs ? 8 : 3;
+            posStride = floatsPerVertex * sizeof(float);
+            normStride = separateNormals ? 3 * sizeof(float) : posStride;
+
+            src.resize(misalign + numVertices * floatsPerVertex);
+            for (size_t i = misalign; i < src.size(); ++i)
+                src[i] = Math::RangeRandom(-10.0f, 10.0f);
+            if (separateNormals)
+            {
+                srcNormals.resize(misalign + numVertices * 3);
+                for (size_t i = misalign; i < srcNormals.size(); ++i)
+                    srcNormals[i] = Math::RangeRandom(-1.0f, 1.0f);
+            }
+
+            weights.resize(numVertices * numWeights);
+            indices.resize(numVertices * 4);
+            for (size_t i = 0; i < numVertices; ++i)
+            {
+                float totalWeight = 0;
+                for (size_t j = 0; j < numWeights; ++j)
+                {
+                    // Unused bones are common, and skipped by the plain version
+                    weights[i * numWeights + j] = rand() % 5 ? Math::UnitRandom() : 0.0f;
+                    totalWeight += weights[i * numWeights + j];
+                    indices[i * 4 + j] = static_cast<unsigned char>(rand() % NumMatrices);
+                }
+                if (totalWeight == 0)
+                    weights[i * numWeights] = totalWeight = 1.0f;
+                for (size_t j = 0; j < numWeights; ++j)
+                    weights[i * numWeights + j] /= totalWeight;
+            }
+
+            resetDestination();
+        }
+
+        void resetDestination(void)
+        {
+            dst.assign(src.size(), Sentinel);
+            dstNormals.assign(srcNormals.size(), Sentinel);
+        }
+
+        const float* srcPosPtr(void) const      { return &src[misalign]; }
+        float* dstPosPtr(void)                  { return &dst[misalign]; }
+
+        const float* srcNormPtr(void) const
+        {
+            return !hasNormals ? 0 : separateNormals ? &srcNormals[misalign] : &src[misalign + 3];
+        }
+
+        float* dstNormPtr(void)
+        {
+            return !hasNormals ? 0 : separateNormals ? &dstNormals[misalign] : &dst[misalign + 3];
+        }
+
+        void skinWithReference(const Matrix4* const* blendMatrices)
+        {
+            referenceSkinning(srcPosPtr(), dstPosPtr(), srcNormPtr(), dstNormPtr(),
+                              &weights[0], &indices[0], blendMatrices,
+                              posStride, posStride, normStride, normStride,
+                              numWeights * sizeof(float), 4, numWeights, numVertices);
+        }
+
+        void skin(OptimisedUtil* optimisedUtil, const Matrix4* const* blendMatrices)
+        {
+            optimisedUtil->softwareVertexSkinning(
+                        srcPosPtr(), dstPosPtr(), srcNormPtr(), dstNormPtr(),
+                        &weights[0], &indices[0], blendMatrices,
+                        posStride, posStride, normStride, normStride,
+                        numWeights * sizeof(float), 4, numWeights, numVertices);
+        }
+
+        /// Only sets up the task, the work is done by calling execute
+        void skin(SoftwareVertexAnimationTask& task, const Matrix4* const* blendMatrices)
+        {
+            task.softwareVertexSkinning(
+                        srcPosPtr(), dstPosPtr(), srcNormPtr(), dstNormPtr(),
+                        &weights[0], &indices[0], blendMatrices,
+                        posStride, posStride, normStride, normStride,
+                        numWeights * sizeof(float), 4, numWeights, numVertices, 0);
+            resetDestination();
+        }
+    };
+
+    /// Source & destination buffers of a morph call, with the same misalignment &
+    /// sentinels as SkinningBuffers
+    struct MorphBuffers
+    {
+        vector<float>::type src1, src2, dst;
+        size_t numVertices, misalign, vertexSize;
+        bool morphNormals;
+        Real t;
+
+        MorphBuffers(size_t _numVertices, bool _morphNormals, size_t _misalign) :
+            numVertices(_numVertices), misalign(_misalign),
+            vertexSize((_morphNormals ? 6 : 3) * sizeof(float)), morphNormals(_morphNormals),
+            t(Math::UnitRandom())
+        {
+            const size_t numFloats = misalign + numVertices * vertexSize / sizeof(float);
+            src1.resize(numFloats);
+            src2.resize(numFloats);
+            for (size_t i = misalign; i < numFloats; ++i)
+            {
+                src1[i] = Math::RangeRandom(-10.0f, 10.0f);
+                src2[i] = Math::RangeRandom(-10.0f, 10.0f);
+            }
+
+            resetDestination();
+        }
+
+        void resetDestination(void)
+        {
+            dst.assign(src1.size(), Sentinel);
+        }
+
+        void morphWithReference(void)
+        {
+            referenceMorph(t, &src1[misalign], &src2[misalign], &dst[misalign],
+                           numVertices, morphNormals);
+        }
+
+        void morph(OptimisedUtil* optimisedUtil)
+        {
+            optimisedUtil->softwareVertexMorph(t, &src1[misalign], &src2[misalign], &dst[misalign],
+                                               vertexSize, vertexSize, vertexSize,
+                                               numVertices, morphNormals);
+        }
+
+        /// Only sets up the task, the work is done by calling execute
+        void morph(SoftwareVertexAnimationTask& task)
+        {
+            task.softwareVertexMorph(t, &src1[misalign], &src2[misalign], &dst[misalign],
+                                     vertexSize, vertexSize, vertexSize,
+                                     numVertices, morphNormals, 0);
+            resetDestination();
+        }
+    };
+
+    /// Sentinels must match exactly, everything else within SIMD & FMA rounding
+    void checkClose(const vector<float>::type& expected, const vector<float>::type& actual)
+    {
+        CPPUNIT_ASSERT_EQUAL(expected.size(), actual.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            if (expected[i] == Sentinel || actual[i] == Sentinel)
+            {
+                CPPUNIT_ASSERT_EQUAL(expected[i], actual[i]);
+            }
+            else
+            {
+                CPPUNIT_ASSERT(Math::Abs(expected[i] - actual[i]) <=
+                               1e-4f * std::max(1.0f, Math::Abs(expected[i])));
+            }
+        }
+    }
+
+    /// The split must give the exact same results as the whole buffer at once
+    void checkEqual(const vector<float>::type& expected, const vector<float>::type& actual)
+    {
+        CPPUNIT_ASSERT_EQUAL(expected.size(), actual.size());
+        if (!expected.empty())
+        {
+            CPPUNIT_ASSERT(memcmp(&expected[0], &actual[0],
+                                  expected.size() * sizeof(float)) == 0);
+        }
+    }
+
+    /// Runs the task the same way numThreads worker threads would, in reverse order
+    void executeSplit(SoftwareVertexAnimationTask& task, size_t numThreads)
+    {
+        for (size_t i = numThreads; i--; )
+            task.execute(i, numThreads);
+    }
+
+    /// Random bone matrices with uniform scale, like the ones Entity blends with
+    struct BlendMatrices
+    {
+        OGRE_SIMD_ALIGNED_DECL(Matrix4, matrices[NumMatrices]);
+        const Matrix4* pointers[NumMatrices];
+
+        BlendMatrices()
+        {
+            for (size_t i = 0; i < NumMatrices; ++i)
+            {
+                Quaternion orientation(Math::UnitRandom(), Math::SymmetricRandom(),
+                                       Math::SymmetricRandom(), Math::SymmetricRandom());
+                orientation.normalise();
+                matrices[i].makeTransform(Vector3(Math::RangeRandom(-10.0f, 10.0f),
+                                                  Math::RangeRandom(-10.0f, 10.0f),
+                                                  Math::RangeRandom(-10.0f, 10.0f)),
+                                          Vector3(Math::RangeRandom(0.5f, 2.0f)), orientation);
+                pointers[i] = &matrices[i];
+            }
+        }
+    };
+}
+
+//--------------------------------------------------------------------------
+void OptimisedUtilTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+    srand(0);
+}
+//--------------------------------------------------------------------------
+void OptimisedUtilTests::tearDown()
+{
+}
+//--------------------------------------------------------------------------
+void OptimisedUtilTests::testSkinningOddVertexCounts()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const BlendMatrices blendMatrices;
+    const size_t vertexCounts[] = { 1, 2, 3, 5, 7, 8, 9, 15, 17, 31 };
+
+    for (size_t layout = 0; layout < NumSkinningLayouts; ++layout)
+    {
+        for (size_t i = 0; i < sizeof(vertexCounts) / sizeof(vertexCounts[0]); ++i)
+        {
+            for (size_t numWeights = 1; numWeights <= 4; ++numWeights)
+            {
+                for (size_t misalign = 0; misalign < 2; ++misalign)
+                {
+                    SkinningBuffers buffers(static_cast<SkinningLayout>(layout), vertexCounts[i],
+                                            numWeights, misalign);
+                    buffers.skinWithReference(blendMatrices.pointers);
+                    const vector<float>::type expected = buffers.dst;
+                    const vector<float>::type expectedNormals = buffers.dstNormals;
+
+                    buffers.resetDestination();
+                    buffers.skin(OptimisedUtil::getImplementation(), blendMatrices.pointers);
+                    checkClose(expected, buffers.dst);
+                    checkClose(expectedNormals, buffers.dstNormals);
+                }
+            }
+        }
+    }
+}
+//--------------------------------------------------------------------------
+void OptimisedUtilTests::testMorphOddVertexCounts()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const size_t vertexCounts[] = { 1, 2, 3, 5, 7, 8, 9, 15, 17, 31 };
+
+    for (size_t i = 0; i < sizeof(vertexCounts) / sizeof(vertexCounts[0]); ++i)
+    {
+        for (size_t morphNormals = 0; morphNormals < 2; ++morphNormals)
+        {
+            for (size_t misalign = 0; misalign < 2; ++misalign)
+            {
+                MorphBuffers buffers(vertexCounts[i], morphNormals != 0, misalign);
+                buffers.morphWithReference();
+                const vector<float>::type expected = buffers.dst;
+
+                buffers.resetDestination();
+                buffers.morph(OptimisedUtil::getImplementation());
+                checkClose(expected, buffers.dst);
+            }
+        }
+    }
+}
+//--------------------------------------------------------------------------
+void OptimisedUtilTests::testSkinningSplitBoundaries()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const BlendMatrices blendMatrices;
+    // Around the 8 vertex granularity of the ranges
+    const size_t vertexCounts[] = { 15, 16, 17, 23, 25, 63, 65, 101 };
+    const size_t threadCounts[] = { 2, 3, 4, 7 };
+
+    for (size_t layout = 0; layout < NumSkinningLayouts; ++layout)
+    {
+        for (size_t i = 0; i < sizeof(vertexCounts) / sizeof(vertexCounts[0]); ++i)
+        {
+            for (size_t misalign = 0; misalign < 2; ++misalign)
+            {
+                SkinningBuffers buffers(static_cast<SkinningLayout>(layout), vertexCounts[i],
+                                        1 + rand() % 4, misalign);
+                buffers.skin(OptimisedUtil::getImplementation(), blendMatrices.pointers);
+                const vector<float>::type expected = buffers.dst;
+                const vector<float>::type expectedNormals = buffers.dstNormals;
+
+                buffers.resetDestination();
+                buffers.skinWithReference(blendMatrices.pointers);
+                checkClose(buffers.dst, expected);
+                checkClose(buffers.dstNormals, expectedNormals);
+
+                for (size_t j = 0; j < sizeof(threadCounts) / sizeof(threadCounts[0]); ++j)
+                {
+                    SoftwareVertexAnimationTask task;
+                    buffers.skin(task, blendMatrices.pointers);
+                    executeSplit(task, threadCounts[j]);
+                    checkEqual(expected, buffers.dst);
+                    checkEqual(expectedNormals, buffers.dstNormals);
+                }
+            }
+        }
+    }
+}
+//--------------------------------------------------------------------------
+void OptimisedUtilTests::testMorphSplitBoundaries()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // Around the 8 vertex granularity of the ranges
+    const size_t vertexCounts[] = { 15, 16, 17, 23, 25, 63, 65, 101 };
+    const size_t threadCounts[] = { 2, 3, 4, 7 };
+
+    for (size_t i = 0; i < sizeof(vertexCounts) / sizeof(vertexCounts[0]); ++i)
+    {
+        for (size_t morphNormals = 0; morphNormals < 2; ++morphNormals)
+        {
+            for (size_t misalign = 0; misalign < 2; ++misalign)
+            {
+                MorphBuffers buffers(vertexCounts[i], morphNormals != 0, misalign);
+                buffers.morph(OptimisedUtil::getImplementation());
+                const vector<float>::type expected = buffers.dst;
+
+                buffers.resetDestination();
+                buffers.morphWithReference();
+                checkClose(buffers.dst, expected);
+
+                for (size_t j = 0; j < sizeof(threadCounts) / sizeof(threadCounts[0]); ++j)
+                {
+                    SoftwareVertexAnimationTask task;
+                    buffers.morph(task);
+                    executeSplit(task, threadCounts[j]);
+                    checkEqual(expected, buffers.dst);
+                }
+            }
+        }
+    }
+}
+//--------------------------------------------------------------------------
@@ -27,7 +27,10 @@ THE SOFTWARE.
 */
 #include "RadixSortTests.h"
 #include "OgreRadixSort.h"
+#include "OgreParallelRadixSort.h"
 #include "OgreMath.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
 
 #include "UnitTestSuite.h"
 
@@ -219,5 +222,86 @@ void RadixSortTests::testIntVector()
     }
 }
 //--------------------------------------------------------------------------
+void RadixSortTests::testParallelUint64Vector()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    ParallelRadixSort::EntryVec container;
+    ParallelRadixSort sorter;
+
+    // Few distinct keys in the upper bits, so that stability gets tested too
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        uint64 key = (static_cast<uint64>(Math::RangeRandom(0, 16)) << 40ul) |
+                     static_cast<uint64>(Math::RangeRandom(0, 4));
+        container.push_back(ParallelRadixSort::Entry(key, i));
+    }
+
+    sorter.sort(container, 0);
+
+    ParallelRadixSort::EntryVec::iterator v = container.begin();
+    ParallelRadixSort::Entry lastValue = *v++;
+    for (;v != container.end(); ++v)
+    {
+        CPPUNIT_ASSERT(v->key >= lastValue.key);
+        if (v->key == lastValue.key)
+            CPPUNIT_ASSERT(v->value > lastValue.value);
+        lastValue = *v;
+    }
+}
+//--------------------------------------------------------------------------
+namespace
+{
+    bool entryKeyLess(const ParallelRadixSort::Entry& a, const ParallelRadixSort::Entry& b)
+    {
+        return a.key < b.key;
+    }
+}
+//--------------------------------------------------------------------------
+void RadixSortTests::testParallelUint64VectorThreaded()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // The histogram & scatter phases only run in the worker threads above
+    // PARALLEL_THRESHOLD entries, and when the SceneManager has several of them
+    Root* root = OGRE_NEW Root(BLANKSTRING);
+    SceneManager* sceneManager = root->createSceneManager(ST_GENERIC, 4, INSTANCING_CULLING_SINGLETHREAD);
+
+    // Duplicate keys spread over 3 non-consecutive digits. Every thread gets
+    // entries of most buckets, which is what the per-thread offsets must handle.
+    ParallelRadixSort::EntryVec container;
+    const size_t numEntries = ParallelRadixSort::PARALLEL_THRESHOLD * 6 + 7;
+    for (size_t i = 0; i < numEntries; ++i)
+    {
+        const uint64 key = (static_cast<uint64>(rand() % 3) << 60ul) |
+                           (static_cast<uint64>(rand() % 200) << 24ul) |
+                            static_cast<uint64>(rand() % 5);
+        container.push_back(ParallelRadixSort::Entry(key, i));
+    }
+
+    ParallelRadixSort::EntryVec expected(container);
+    std::stable_sort(expected.begin(), expected.end(), entryKeyLess);
+
+    ParallelRadixSort sorter;
+    CPPUNIT_ASSERT(sceneManager->getNumWorkerThreads() > 1);
+    sorter.sort(container, sceneManager);
+
+    CPPUNIT_ASSERT_EQUAL(expected.size(), container.size());
+    for (size_t i = 0; i < numEntries; ++i)
+    {
+        CPPUNIT_ASSERT(container[i].key == expected[i].key);
+        CPPUNIT_ASSERT_EQUAL(expected[i].value, container[i].value);
+    }
 
+    // Sorting again must reuse the buffers and still be stable
+    std::reverse(container.begin(), container.end());
+    expected = container;
+    std::stable_sort(expected.begin(), expected.end(), entryKeyLess);
+    sorter.sort(container, sceneManager);
+    for (size_t i = 0; i < numEntries; ++i)
+        CPPUNIT_ASSERT_EQUAL(expected[i].value, container[i].value);
 
+    root->destroySceneManager(sceneManager);
+    OGRE_DELETE root;
+}
+//--------------------------------------------------------------------------
@@ -0,0 +1,387 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "RenderCommandBufferTests.h"
+#include "UnitTestSuite.h"
+
+#include "OgreRenderCommandBuffer.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgrePass.h"
+#include "OgreRenderable.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(RenderCommandBufferTests);
+
+namespace
+{
+    const size_t NUM_PASSES = 4;
+
+    class NullRenderable : public Renderable
+    {
+        LightList mLights;
+    public:
+        virtual const MaterialPtr& getMaterial(void) const
+        {
+            static MaterialPtr material;
+            return material;
+        }
+        virtual void getRenderOperation(RenderOperation&) {}
+        virtual void getWorldTransforms(Matrix4*) const {}
+        virtual Real getSquaredViewDepth(const Camera*) const { return 0; }
+        virtual const LightList& getLights(void) const { return mLights; }
+    };
+
+    /// Passes & renderables shared by the collections of a test. Passes have no parent.
+    struct TestObjects
+    {
+        Pass* passes[NUM_PASSES];
+        vector<NullRenderable>::type renderables;
+
+        TestObjects(size_t numRenderables) : renderables(numRenderables)
+        {
+            for (size_t i = 0; i < NUM_PASSES; ++i)
+                passes[i] = OGRE_NEW Pass(0, static_cast<unsigned short>(i));
+        }
+        ~TestObjects()
+        {
+            for (size_t i = 0; i < NUM_PASSES; ++i)
+                OGRE_DELETE passes[i];
+        }
+    };
+
+    /** Consumes the commands without rendering anything, like a null RenderSystem would.
+        Counts them and logs each draw with the pass it was issued with.
+    */
+    class CountingVisitor : public QueuedRenderableVisitor
+    {
+        bool mSkipDraws;
+    public:
+        typedef vector< std::pair<const Pass*, const Renderable*> >::type DrawVec;
+
+        size_t numPasses;
+        const Pass* lastPass;
+        /// visit(const Pass*) returns false for this pass
+        const Pass* skipPass;
+        DrawVec draws;
+
+        CountingVisitor(const Pass* _skipPass) :
+            mSkipDraws(false), numPasses(0), lastPass(0), skipPass(_skipPass) {}
+
+        /// Only called by QueuedRenderableCollection::acceptVisitor. Repeated passes
+        /// are filtered like SceneManager's visitor does.
+        virtual void visit(RenderablePass* rp)
+        {
+            if (rp->pass != lastPass)
+                mSkipDraws = !visit(static_cast<const Pass*>(rp->pass));
+            if (!mSkipDraws)
+                visit(rp->renderable);
+        }
+        virtual bool visit(const Pass* p)
+        {
+            ++numPasses;
+            lastPass = p;
+            return p != skipPass;
+        }
+        virtual void visit(Renderable* r)
+        {
+            draws.push_back(std::make_pair(lastPass, r));
+        }
+    };
+
+    /// Records & replays the collection, checking the result against visiting it directly.
+    void checkReplay(RenderCommandBuffer& buffer, const QueuedRenderableCollection& objs,
+                     QueuedRenderableCollection::OrganisationMode om,
+                     SceneManager* sceneManager, const Pass* skipPass)
+    {
+        CountingVisitor expected(skipPass);
+        objs.acceptVisitor(&expected, om);
+
+        buffer.record(objs, om, sceneManager);
+        CountingVisitor actual(skipPass);
+        buffer.replay(&actual);
+
+        CPPUNIT_ASSERT_EQUAL(expected.numPasses, actual.numPasses);
+        CPPUNIT_ASSERT(expected.draws == actual.draws);
+        CPPUNIT_ASSERT_EQUAL(actual.numPasses, buffer.getNumStateCommands());
+
+        size_t numRecordedStateCommands = 0;
+        size_t numRecordedRenderablePasses = 0;
+        const RenderCommandBuffer::CommandVecVec& threadCommands = buffer.getThreadCommands();
+        for (size_t i = 0; i < threadCommands.size(); ++i)
+        {
+            for (size_t j = 0; j < threadCommands[i].size(); ++j)
+            {
+                if (threadCommands[i][j].type == RenderCommandBuffer::COMMAND_SET_PASS)
+                    ++numRecordedStateCommands;
+                else if (threadCommands[i][j].type == RenderCommandBuffer::COMMAND_DRAW_RENDERABLE_PASS)
+                    ++numRecordedRenderablePasses;
+            }
+        }
+
+        if (om == QueuedRenderableCollection::OM_PASS_GROUP)
+        {
+            // Every set pass command in the thread lists was either issued or skipped
+            CPPUNIT_ASSERT_EQUAL(numRecordedStateCommands,
+                                 buffer.getNumStateCommands() + buffer.getNumRedundantStateCommands());
+            CPPUNIT_ASSERT_EQUAL(actual.draws.size(), buffer.getNumDrawCommands());
+            CPPUNIT_ASSERT_EQUAL((size_t)0, numRecordedRenderablePasses);
+        }
+        else
+        {
+            // Sorted collections leave the pass changes & the skipping to the visitor
+            CPPUNIT_ASSERT_EQUAL(numRecordedRenderablePasses, buffer.getNumDrawCommands());
+            CPPUNIT_ASSERT_EQUAL((size_t)0, numRecordedStateCommands);
+        }
+    }
+
+    /// Logs which of the visitor's methods was called, and with what.
+    class CallLogVisitor : public QueuedRenderableVisitor
+    {
+    public:
+        enum CallType
+        {
+            CALL_RENDERABLE_PASS,
+            CALL_PASS,
+            CALL_RENDERABLE
+        };
+        struct Call
+        {
+            CallType            type;
+            const Pass*         pass;
+            const Renderable*   renderable;
+
+            Call(CallType _type, const Pass* _pass, const Renderable* _renderable) :
+                type(_type), pass(_pass), renderable(_renderable) {}
+            bool operator == (const Call& other) const
+            {
+                return type == other.type && pass == other.pass && renderable == other.renderable;
+            }
+        };
+        typedef vector<Call>::type CallVec;
+
+        CallVec calls;
+
+        virtual void visit(RenderablePass* rp)
+        {
+            calls.push_back(Call(CALL_RENDERABLE_PASS, rp->pass, rp->renderable));
+        }
+        virtual bool visit(const Pass* p)
+        {
+            calls.push_back(Call(CALL_PASS, p, 0));
+            return true;
+        }
+        virtual void visit(Renderable* r)
+        {
+            calls.push_back(Call(CALL_RENDERABLE, 0, r));
+        }
+    };
+}
+
+//--------------------------------------------------------------------------
+void RenderCommandBufferTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+    srand(0);
+}
+//--------------------------------------------------------------------------
+void RenderCommandBufferTests::tearDown()
+{
+}
+//--------------------------------------------------------------------------
+void RenderCommandBufferTests::testGrouped()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    TestObjects objects(30);
+    QueuedRenderableCollection objs;
+    objs.addOrganisationMode(QueuedRenderableCollection::OM_PASS_GROUP);
+    for (size_t i = 0; i < objects.renderables.size(); ++i)
+        objs.addRenderable(objects.passes[i % 3], &objects.renderables[i]);
+
+    RenderCommandBuffer buffer;
+    checkReplay(buffer, objs, QueuedRenderableCollection::OM_PASS_GROUP, 0, 0);
+
+    // One set pass per group
+    CPPUNIT_ASSERT_EQUAL((size_t)3, buffer.getNumStateCommands());
+    CPPUNIT_ASSERT_EQUAL((size_t)30, buffer.getNumDrawCommands());
+    CPPUNIT_ASSERT_EQUAL((size_t)0, buffer.getNumRedundantStateCommands());
+    CPPUNIT_ASSERT_EQUAL((size_t)1, buffer.getThreadCommands().size());
+    CPPUNIT_ASSERT_EQUAL((size_t)33, buffer.getThreadCommands()[0].size());
+
+    // Replaying again gives the same counts
+    CountingVisitor visitor(0);
+    buffer.replay(&visitor);
+    CPPUNIT_ASSERT_EQUAL((size_t)3, buffer.getNumStateCommands());
+    CPPUNIT_ASSERT_EQUAL((size_t)30, buffer.getNumDrawCommands());
+
+    buffer.clear();
+    buffer.replay(&visitor);
+    CPPUNIT_ASSERT_EQUAL((size_t)0, buffer.getNumStateCommands());
+    CPPUNIT_ASSERT_EQUAL((size_t)0, buffer.getNumDrawCommands());
+}
+//--------------------------------------------------------------------------
+void RenderCommandBufferTests::testSortedRedundantPasses()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // Consecutive renderables with the same pass only set it once
+    const size_t passIndices[] = { 0, 0, 1, 1, 0, 2, 2, 2 };
+    const size_t numRenderables = sizeof(passIndices) / sizeof(passIndices[0]);
+
+    TestObjects objects(numRenderables);
+    QueuedRenderableCollection objs;
+    objs.addOrganisationMode(QueuedRenderableCollection::OM_SORT_DESCENDING);
+    for (size_t i = 0; i < numRenderables; ++i)
+        objs.addRenderable(objects.passes[passIndices[i]], &objects.renderables[i]);
+
+    RenderCommandBuffer buffer;
+    checkReplay(buffer, objs, QueuedRenderableCollection::OM_SORT_DESCENDING, 0, 0);
+    CPPUNIT_ASSERT_EQUAL((size_t)4, buffer.getNumStateCommands());
+    CPPUNIT_ASSERT_EQUAL(numRenderables, buffer.getNumDrawCommands());
+    CPPUNIT_ASSERT_EQUAL((size_t)0, buffer.getNumRedundantStateCommands());
+
+    // Iterated backwards: 2 2 2 0 1 1 0 0
+    checkReplay(buffer, objs, QueuedRenderableCollection::OM_SORT_ASCENDING, 0, 0);
+    CPPUNIT_ASSERT_EQUAL((size_t)4, buffer.getNumStateCommands());
+    CPPUNIT_ASSERT_EQUAL(numRenderables, buffer.getNumDrawCommands());
+    CPPUNIT_ASSERT(buffer.getThreadCommands()[0][0].pass == objects.passes[2]);
+}
+//--------------------------------------------------------------------------
+void RenderCommandBufferTests::testSortedVisitorCalls()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const size_t passIndices[] = { 0, 0, 1, 3, 3, 0, 2, 2, 1 };
+    const size_t numRenderables = sizeof(passIndices) / sizeof(passIndices[0]);
+
+    TestObjects objects(numRenderables);
+    QueuedRenderableCollection objs;
+    objs.addOrganisationMode(QueuedRenderableCollection::OM_PASS_GROUP);
+    objs.addOrganisationMode(QueuedRenderableCollection::OM_SORT_DESCENDING);
+    for (size_t i = 0; i < numRenderables; ++i)
+        objs.addRenderable(objects.passes[passIndices[i]], &objects.renderables[i]);
+
+    // The replay makes exactly the same calls visiting the collection does. In particular
+    // sorted collections go through visit(RenderablePass*), where SceneManager's visitor
+    // filters the transparent shadow casters.
+    const QueuedRenderableCollection::OrganisationMode modes[] =
+    {
+        QueuedRenderableCollection::OM_PASS_GROUP,
+        QueuedRenderableCollection::OM_SORT_DESCENDING,
+        QueuedRenderableCollection::OM_SORT_ASCENDING
+    };
+
+    RenderCommandBuffer buffer;
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); ++i)
+    {
+        CallLogVisitor expected;
+        objs.acceptVisitor(&expected, modes[i]);
+
+        buffer.record(objs, modes[i], 0);
+        CallLogVisitor actual;
+        buffer.replay(&actual);
+
+        CPPUNIT_ASSERT(expected.calls == actual.calls);
+
+        if (modes[i] != QueuedRenderableCollection::OM_PASS_GROUP)
+        {
+            CPPUNIT_ASSERT_EQUAL(numRenderables, actual.calls.size());
+            for (size_t j = 0; j < actual.calls.size(); ++j)
+                CPPUNIT_ASSERT(actual.calls[j].type == CallLogVisitor::CALL_RENDERABLE_PASS);
+        }
+    }
+}
+//--------------------------------------------------------------------------
+void RenderCommandBufferTests::testSkippedPass()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    TestObjects objects(20);
+    QueuedRenderableCollection objs;
+    objs.addOrganisationMode(QueuedRenderableCollection::OM_PASS_GROUP);
+    objs.addOrganisationMode(QueuedRenderableCollection::OM_SORT_DESCENDING);
+    for (size_t i = 0; i < objects.renderables.size(); ++i)
+        objs.addRenderable(objects.passes[(i / 3) % NUM_PASSES], &objects.renderables[i]);
+
+    // The draws following a pass the visitor rejects aren't issued
+    RenderCommandBuffer buffer;
+    checkReplay(buffer, objs, QueuedRenderableCollection::OM_PASS_GROUP, 0, objects.passes[1]);
+    CPPUNIT_ASSERT_EQUAL((size_t)NUM_PASSES, buffer.getNumStateCommands());
+    CPPUNIT_ASSERT_EQUAL((size_t)14, buffer.getNumDrawCommands());
+
+    // Sorted draws are all handed to the visitor, which skips them itself
+    checkReplay(buffer, objs, QueuedRenderableCollection::OM_SORT_DESCENDING, 0, objects.passes[1]);
+    CPPUNIT_ASSERT_EQUAL((size_t)7, buffer.getNumStateCommands());
+    CPPUNIT_ASSERT_EQUAL((size_t)20, buffer.getNumDrawCommands());
+}
+//--------------------------------------------------------------------------
+void RenderCommandBufferTests::testThreadBoundaries()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // Commands are only recorded by the worker threads above PARALLEL_THRESHOLD
+    // renderables, and when the SceneManager has several of them
+    Root* root = OGRE_NEW Root(BLANKSTRING);
+    SceneManager* sceneManager = root->createSceneManager(ST_GENERIC, 4, INSTANCING_CULLING_SINGLETHREAD);
+    CPPUNIT_ASSERT(sceneManager->getNumWorkerThreads() > 1);
+
+    {
+        TestObjects objects(RenderCommandBuffer::PARALLEL_THRESHOLD * 2 + 5);
+        QueuedRenderableCollection objs;
+        objs.addOrganisationMode(QueuedRenderableCollection::OM_PASS_GROUP);
+        objs.addOrganisationMode(QueuedRenderableCollection::OM_SORT_DESCENDING);
+        for (size_t i = 0; i < objects.renderables.size(); ++i)
+        {
+            // Long runs of the same pass, and a few random ones
+            const size_t passIdx = (rand() % 50) ? (i / 1000) % 3 : 3;
+            objs.addRenderable(objects.passes[passIdx], &objects.renderables[i]);
+        }
+
+        RenderCommandBuffer buffer;
+
+        // Each of the 3 big groups is split between several threads. The threads
+        // after the first one start by setting the pass again, which is skipped.
+        checkReplay(buffer, objs, QueuedRenderableCollection::OM_PASS_GROUP, sceneManager, 0);
+        CPPUNIT_ASSERT_EQUAL(sceneManager->getNumWorkerThreads(), buffer.getThreadCommands().size());
+        CPPUNIT_ASSERT_EQUAL((size_t)NUM_PASSES, buffer.getNumStateCommands());
+        CPPUNIT_ASSERT_EQUAL(objects.renderables.size(), buffer.getNumDrawCommands());
+        CPPUNIT_ASSERT(buffer.getNumRedundantStateCommands() > 0);
+
+        checkReplay(buffer, objs, QueuedRenderableCollection::OM_SORT_DESCENDING, sceneManager, 0);
+        CPPUNIT_ASSERT_EQUAL(objects.renderables.size(), buffer.getNumDrawCommands());
+        checkReplay(buffer, objs, QueuedRenderableCollection::OM_SORT_ASCENDING, sceneManager, 0);
+        CPPUNIT_ASSERT_EQUAL(objects.renderables.size(), buffer.getNumDrawCommands());
+        checkReplay(buffer, objs, QueuedRenderableCollection::OM_SORT_ASCENDING, sceneManager,
+                    objects.passes[0]);
+    }
+
+    root->destroySceneManager(sceneManager);
+    OGRE_DELETE root;
+}
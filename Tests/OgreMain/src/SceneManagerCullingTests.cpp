@@ -0,0 +1,705 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "SceneManagerCullingTests.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreSceneNode.h"
+#include "OgreCamera.h"
+#include "OgreMovableObject.h"
+#include "OgreId.h"
+#include "OgreInstanceManager.h"
+#include "OgreInstanceBatchHWUnified.h"
+#include "OgreInstancedEntity.h"
+#include "OgreMeshManager.h"
+#include "OgreMesh.h"
+#include "OgreSubMesh.h"
+#include "OgreMaterialManager.h"
+#include "OgreHardwareBufferManager.h"
+
+#ifdef OGRE_STATIC_LIB
+#   include "OgreNullPlugin.h"
+#endif
+
+#include "UnitTestSuite.h"
+
+#include <set>
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(SceneManagerCullingTests);
+
+namespace
+{
+    /// Bare object with a bounding box, which is all the culling looks at.
+    class CullTestObject : public MovableObject
+    {
+    public:
+        CullTestObject(ObjectMemoryManager* objectMemoryManager, uint8 renderQueueId) :
+            MovableObject(Id::generateNewId<MovableObject>(), objectMemoryManager, renderQueueId)
+        {
+            setLocalAabb(Aabb(Vector3::ZERO, Vector3(2.0f)));
+        }
+
+        virtual const String& getMovableType(void) const
+        {
+            static const String movableType = "CullTestObject";
+            return movableType;
+        }
+
+        virtual void _updateRenderQueue(RenderQueue* queue, Camera* camera, const Camera* lodCamera)
+        {
+        }
+
+        virtual void visitRenderables(Renderable::Visitor* visitor, bool debugRenderables = false)
+        {
+        }
+    };
+
+    typedef std::set<MovableObject*> VisibleSet;
+
+    /// What a scene pass culls with
+    struct CullParams
+    {
+        Camera* camera;
+        Vector3 position;
+        Degree  yaw;
+        Degree  pitch;
+        uint32  viewportMask;
+        uint32  sceneMask;
+        uint8   firstRq;
+        uint8   lastRq;
+
+        CullParams(Camera* _camera) :
+            camera(_camera), position(Vector3::ZERO), yaw(0), pitch(0), viewportMask(0xFFFFFFFF),
+            sceneMask(0xFFFFFFFF), firstRq(0), lastRq(255)
+        {
+        }
+    };
+
+    /// Single triangle, enough to build instance batches from.
+    MeshPtr createTriangleMesh(const String& name)
+    {
+        MeshPtr mesh = MeshManager::getSingleton().createManual(
+                    name, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+        SubMesh* subMesh = mesh->createSubMesh();
+        subMesh->useSharedVertices = false;
+
+        subMesh->vertexData = OGRE_NEW VertexData();
+        subMesh->vertexData->vertexCount = 3;
+        subMesh->vertexData->vertexDeclaration->addElement(0, 0, VET_FLOAT3, VES_POSITION);
+
+        const float vertices[9] = { 0, 0, 0,   1, 0, 0,   0, 1, 0 };
+        HardwareVertexBufferSharedPtr vertexBuffer =
+                HardwareBufferManager::getSingleton().createVertexBuffer(
+                    3 * sizeof(float), 3, HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+        vertexBuffer->writeData(0, sizeof(vertices), vertices);
+        subMesh->vertexData->vertexBufferBinding->setBinding(0, vertexBuffer);
+
+        const uint16 indices[3] = { 0, 1, 2 };
+        subMesh->indexData->indexCount = 3;
+        subMesh->indexData->indexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
+                    HardwareIndexBuffer::IT_16BIT, 3, HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+        subMesh->indexData->indexBuffer->writeData(0, sizeof(indices), indices);
+
+        mesh->_setBounds(AxisAlignedBox(Vector3::ZERO, Vector3::UNIT_SCALE));
+        mesh->_setBoundingSphereRadius(1.0f);
+        mesh->load();
+
+        return mesh;
+    }
+
+    /// Checks the stream holds, back to back and in the given order, the transforms of the
+    /// instances each batch culled. Returns the number of instances in the stream.
+    size_t checkInstanceStream(const UnifiedInstanceStream* stream,
+                               const UnifiedInstanceStream::InstanceBatchHWUnifiedArray& expectedBatches,
+                               const vector<InstancedEntity*>::type& instances)
+    {
+        const UnifiedInstanceStream::InstanceBatchHWUnifiedArray& batches = stream->_getBatches();
+        const FastArray<size_t>& offsets = stream->_getBatchOffsets();
+
+        CPPUNIT_ASSERT_EQUAL(expectedBatches.size(), batches.size());
+        CPPUNIT_ASSERT_EQUAL(batches.size(), offsets.size());
+        for (size_t i = 0; i < batches.size(); ++i)
+            CPPUNIT_ASSERT(batches[i] == expectedBatches[i]);
+
+        if (batches.empty())
+        {
+            CPPUNIT_ASSERT_EQUAL((size_t)0, stream->getNumInstances());
+            return 0;
+        }
+
+        HardwareVertexBufferSharedPtr buffer = stream->getRenderOperation().vertexData->
+                vertexBufferBinding->getBuffer(batches[0]->_getInstanceDataSource());
+        const size_t floatsPerInstance = buffer->getVertexSize() / sizeof(float);
+        const float* data = static_cast<const float*>(buffer->lock(HardwareBuffer::HBL_READ_ONLY));
+
+        std::set<InstancedEntity*> written;
+        size_t expectedOffset = 0;
+        for (size_t i = 0; i < batches.size(); ++i)
+        {
+            CPPUNIT_ASSERT_EQUAL(expectedOffset, offsets[i]);
+
+            const size_t numCulled = batches[i]->_getNumCulledInstances();
+            CPPUNIT_ASSERT(numCulled > 0);
+
+            for (size_t j = 0; j < numCulled; ++j)
+            {
+                const float* xform = data + (offsets[i] + j) * floatsPerInstance;
+                const Vector3 position(xform[3], xform[7], xform[11]);
+
+                InstancedEntity* instance = 0;
+                vector<InstancedEntity*>::type::const_iterator itor = instances.begin();
+                vector<InstancedEntity*>::type::const_iterator end  = instances.end();
+                while (itor != end && !instance)
+                {
+                    if ((*itor)->getParentNode()->_getDerivedPosition().positionEquals(position))
+                        instance = *itor;
+                    ++itor;
+                }
+
+                // Every instance is written once, inside the range of its own batch
+                CPPUNIT_ASSERT(instance);
+                CPPUNIT_ASSERT(instance->_getOwner() == batches[i]);
+                CPPUNIT_ASSERT(written.insert(instance).second);
+            }
+
+            expectedOffset += numCulled;
+        }
+
+        buffer->unlock();
+
+        CPPUNIT_ASSERT_EQUAL(expectedOffset, stream->getNumInstances());
+        return expectedOffset;
+    }
+}
+
+/// Exposes the culling steps CompositorPassScene goes through.
+class CullTestSceneManager : public SceneManager
+{
+public:
+    CullTestSceneManager(size_t numWorkerThreads) :
+        SceneManager("CullTestSceneManager", numWorkerThreads, INSTANCING_CULLING_SINGLETHREAD)
+    {
+    }
+
+    virtual const String& getTypeName(void) const
+    {
+        static const String typeName = "CullTestSceneManager";
+        return typeName;
+    }
+
+    /// Moves the camera & sets the scene mask like a listener would
+    void apply(const CullParams& params)
+    {
+        params.camera->setPosition(params.position);
+        params.camera->setOrientation(Quaternion(params.yaw, Vector3::UNIT_Y) *
+                                      Quaternion(params.pitch, Vector3::UNIT_X));
+        setVisibilityMask(params.sceneMask);
+    }
+
+    /// What the pass does in _renderPhase02 for unified instancing, after cull()
+    void cullInstances(const CullParams& params)
+    {
+        fireCullFrustumInstanceBatchThreads(InstanceBatchCullRequest(
+                params.camera, params.camera, params.viewportMask & params.sceneMask));
+        updateInstanceStreams();
+    }
+
+    /// The batches of the stream culled by each thread, in the order _update must merge them
+    UnifiedInstanceStream::InstanceBatchHWUnifiedArray getCulledBatches(
+            const UnifiedInstanceStream* stream) const
+    {
+        UnifiedInstanceStream::InstanceBatchHWUnifiedArray retVal;
+
+        VisibleObjectsPerThreadArray::const_iterator itor = mVisibleObjects.begin();
+        VisibleObjectsPerThreadArray::const_iterator end  = mVisibleObjects.end();
+        while (itor != end)
+        {
+            MovableObject::MovableObjectArray::const_iterator it = itor->begin();
+            MovableObject::MovableObjectArray::const_iterator en = itor->end();
+            while (it != en)
+            {
+                InstanceBatchHWUnified* batch = dynamic_cast<InstanceBatchHWUnified*>(*it);
+                if (batch && batch->_getInstanceStream() == stream &&
+                    batch->_getNumCulledInstances())
+                {
+                    retVal.push_back(batch);
+                }
+                ++it;
+            }
+
+            ++itor;
+        }
+
+        return retVal;
+    }
+
+    /// Whether cull() will traverse the static BVH instead of every static object
+    bool isStaticBvhUsed(void)
+    {
+        return mStaticBvhCulling && mStaticBvh.isUpToDate(mEntityMemoryManager[SCENE_STATIC]);
+    }
+
+    /// What the previous pass does after building its render queue
+    void prefetch(const CullParams& params)
+    {
+        _scheduleCullPrefetch(params.camera, params.camera, params.viewportMask,
+                              params.firstRq, params.lastRq);
+        startCullPrefetch();
+    }
+
+    /// What the pass does in _cullPhase01, returning the objects that made it
+    VisibleSet cull(const CullParams& params)
+    {
+        cullVisibleObjects(params.camera, params.camera, params.viewportMask,
+                           params.firstRq, params.lastRq);
+
+        VisibleSet retVal;
+        VisibleObjectsPerThreadArray::const_iterator itor = mVisibleObjects.begin();
+        VisibleObjectsPerThreadArray::const_iterator end  = mVisibleObjects.end();
+        while (itor != end)
+        {
+            retVal.insert(itor->begin(), itor->end());
+            ++itor;
+        }
+        return retVal;
+    }
+
+    /// Culls the pass with the results of the previous one prefetching the given
+    /// parameters, which are changed to the pass' ones while it runs. Returns the
+    /// objects culled without prefetching in outExpected and the stale ones in outStale.
+    VisibleSet cullAfterPrefetch(const CullParams& prefetchParams, const CullParams& passParams,
+                                 VisibleSet& outExpected, VisibleSet& outStale)
+    {
+        setCullPrefetch(false);
+        apply(passParams);
+        outExpected = cull(passParams);
+        apply(prefetchParams);
+        outStale = cull(prefetchParams);
+
+        setCullPrefetch(true);
+        prefetch(prefetchParams);
+        apply(passParams);
+        VisibleSet retVal = cull(passParams);
+        setCullPrefetch(false);
+
+        return retVal;
+    }
+};
+
+//--------------------------------------------------------------------------
+void SceneManagerCullingTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+    srand(0);
+
+    // Cameras need a RenderSystem, and the hardware buffers it creates with the first window
+    mRoot = OGRE_NEW Root(BLANKSTRING);
+#ifdef OGRE_STATIC_LIB
+    mNullPlugin = OGRE_NEW NullPlugin();
+    mRoot->installPlugin(mNullPlugin);
+#else
+    mRoot->loadPlugin("RenderSystem_Null" + String(OGRE_BUILD_SUFFIX));
+#endif
+    mRoot->setRenderSystem(mRoot->getAvailableRenderers().front());
+    mRoot->initialise(false);
+    mRoot->createRenderWindow("SceneManagerCullingTests", 64, 64, false);
+    mSceneMgr = OGRE_NEW CullTestSceneManager(4);
+
+    for (size_t i = 0; i < 2; ++i)
+    {
+        mCameras[i] = mSceneMgr->createCamera("CullTestCamera" + StringConverter::toString(i));
+        mCameras[i]->setNearClipDistance(1.0f);
+        mCameras[i]->setFarClipDistance(300.0f);
+        mCameras[i]->setAspectRatio(1.0f);
+    }
+}
+//--------------------------------------------------------------------------
+void SceneManagerCullingTests::tearDown()
+{
+    destroyScene();
+    OGRE_DELETE mSceneMgr;
+    OGRE_DELETE mRoot;
+#ifdef OGRE_STATIC_LIB
+    OGRE_DELETE mNullPlugin;
+#endif
+}
+//--------------------------------------------------------------------------
+void SceneManagerCullingTests::createScene(size_t numObjects, SceneMemoryMgrTypes sceneType)
+{
+    SceneNode* rootNode = mSceneMgr->getRootSceneNode(sceneType);
+    ObjectMemoryManager* objectMemoryManager = &mSceneMgr->_getEntityMemoryManager(sceneType);
+
+    for (size_t i = 0; i < numObjects; ++i)
+    {
+        const Vector3 position(Math::RangeRandom(-200.0f, 200.0f),
+                               Math::RangeRandom(-200.0f, 200.0f),
+                               Math::RangeRandom(-200.0f, 200.0f));
+
+        MovableObject* object = OGRE_NEW CullTestObject(objectMemoryManager, rand() % 4);
+        object->setVisibilityFlags(1u << (rand() % 4));
+        rootNode->createChildSceneNode(sceneType, position)->attachObject(object);
+        mObjects.push_back(object);
+    }
+
+    mSceneMgr->updateSceneGraph();
+}
+//--------------------------------------------------------------------------
+void SceneManagerCullingTests::destroyScene()
+{
+    vector<MovableObject*>::type::const_iterator itor = mObjects.begin();
+    vector<MovableObject*>::type::const_iterator end  = mObjects.end();
+    while (itor != end)
+    {
+        SceneNode* sceneNode = (*itor)->getParentSceneNode();
+        (*itor)->detachFromParent();
+        mSceneMgr->destroySceneNode(sceneNode);
+        OGRE_DELETE *itor;
+        ++itor;
+    }
+    mObjects.clear();
+}
+//--------------------------------------------------------------------------
+InstanceManager* SceneManagerCullingTests::createInstancedScene(size_t numInstances)
+{
+    createTriangleMesh("CullTestTriangle");
+    MaterialManager::getSingleton().create("CullTestMaterial",
+                                           ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+
+    InstanceManager* instanceManager = mSceneMgr->createInstanceManager(
+                "CullTestInstanceManager", "CullTestTriangle",
+                ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+                InstanceManager::HWInstancingUnified, 16);
+
+    SceneNode* rootNode = mSceneMgr->getRootSceneNode(SCENE_DYNAMIC);
+    for (size_t i = 0; i < numInstances; ++i)
+    {
+        const Vector3 position(Math::RangeRandom(-200.0f, 200.0f),
+                               Math::RangeRandom(-200.0f, 200.0f),
+                               Math::RangeRandom(-200.0f, 200.0f));
+
+        InstancedEntity* instance = instanceManager->createInstancedEntity("CullTestMaterial");
+        rootNode->createChildSceneNode(SCENE_DYNAMIC, position)->attachObject(instance);
+        mInstances.push_back(instance);
+    }
+
+    mSceneMgr->updateSceneGraph();
+
+    return instanceManager;
+}
+//--------------------------------------------------------------------------
+void SceneManagerCullingTests::destroyInstancedScene(InstanceManager* instanceManager)
+{
+    vector<InstancedEntity*>::type::const_iterator itor = mInstances.begin();
+    vector<InstancedEntity*>::type::const_iterator end  = mInstances.end();
+    while (itor != end)
+    {
+        SceneNode* sceneNode = (*itor)->getParentSceneNode();
+        (*itor)->detachFromParent();
+        mSceneMgr->destroySceneNode(sceneNode);
+        mSceneMgr->destroyInstancedEntity(*itor);
+        ++itor;
+    }
+    mInstances.clear();
+
+    mSceneMgr->destroyInstanceManager(instanceManager);
+}
+//--------------------------------------------------------------------------
+void SceneManagerCullingTests::testCullPrefetchUnchanged()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene(500);
+
+    CullParams params(mCameras[0]);
+    VisibleSet expected, stale;
+    VisibleSet visible = mSceneMgr->cullAfterPrefetch(params, params, expected, stale);
+    CPPUNIT_ASSERT(!expected.empty());
+    CPPUNIT_ASSERT(visible == expected);
+
+    // Same pass twice in a row, with different settings each time
+    params.yaw = Degree(90.0f);
+    params.viewportMask = 0x5;
+    params.firstRq = 1;
+    visible = mSceneMgr->cullAfterPrefetch(params, params, expected, stale);
+    CPPUNIT_ASSERT(!expected.empty());
+    CPPUNIT_ASSERT(visible == expected);
+}
+//--------------------------------------------------------------------------
+void SceneManagerCullingTests::testCullPrefetchCameraChanged()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene(500);
+
+    const CullParams prefetchParams(mCameras[0]);
+    VisibleSet expected, stale;
+
+    // Camera moved by a listener
+    CullParams passParams(prefetchParams);
+    passParams.position = Vector3(0, 0, 150.0f);
+    VisibleSet visible = mSceneMgr->cullAfterPrefetch(prefetchParams, passParams, expected, stale);
+    CPPUNIT_ASSERT(stale != expected);
+    CPPUNIT_ASSERT(visible == expected);
+
+    // Camera rotated
+    passParams = prefetchParams;
+    passParams.yaw = Degree(180.0f);
+    visible = mSceneMgr->cullAfterPrefetch(prefetchParams, passParams, expected, stale);
+    CPPUNIT_ASSERT(stale != expected);
+    CPPUNIT_ASSERT(visible == expected);
+
+    // A different camera, looking elsewhere
+    passParams = prefetchParams;
+    passParams.camera = mCameras[1];
+    passParams.yaw = Degree(-90.0f);
+    visible = mSceneMgr->cullAfterPrefetch(prefetchParams, passParams, expected, stale);
+    CPPUNIT_ASSERT(stale != expected);
+    CPPUNIT_ASSERT(visible == expected);
+}
+//--------------------------------------------------------------------------
+void SceneManagerCullingTests::testCullPrefetchMaskChanged()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene(500);
+
+    const CullParams prefetchParams(mCameras[0]);
+    VisibleSet expected, stale;
+
+    // Viewport visibility mask
+    CullParams passParams(prefetchParams);
+    passParams.viewportMask = 0x3;
+    VisibleSet visible = mSceneMgr->cullAfterPrefetch(prefetchParams, passParams, expected, stale);
+    CPPUNIT_ASSERT(stale != expected);
+    CPPUNIT_ASSERT(visible == expected);
+
+    // SceneManager visibility mask
+    passParams = prefetchParams;
+    passParams.sceneMask = 0xC;
+    visible = mSceneMgr->cullAfterPrefetch(prefetchParams, passParams, expected, stale);
+    CPPUNIT_ASSERT(stale != expected);
+    CPPUNIT_ASSERT(visible == expected);
+
+    // Render queue range
+    passParams = prefetchParams;
+    passParams.firstRq = 2;
+    passParams.lastRq = 3;
+    visible = mSceneMgr->cullAfterPrefetch(prefetchParams, passParams, expected, stale);
+    CPPUNIT_ASSERT(stale != expected);
+    CPPUNIT_ASSERT(visible == expected);
+}
+//--------------------------------------------------------------------------
+void SceneManagerCullingTests::testUnifiedInstanceStreamOffsets()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    InstanceManager* instanceManager = createInstancedScene(400);
+
+    const CullParams params(mCameras[0]);
+    mSceneMgr->apply(params);
+    mSceneMgr->cull(params);
+    mSceneMgr->cullInstances(params);
+
+    // 25 batches of the same material & render queue share one stream
+    const UnifiedInstanceStream* stream =
+            static_cast<InstanceBatchHWUnified*>(mInstances.front()->_getOwner())->_getInstanceStream();
+    for (size_t i = 0; i < mInstances.size(); ++i)
+    {
+        CPPUNIT_ASSERT(static_cast<InstanceBatchHWUnified*>(mInstances[i]->_getOwner())->
+                       _getInstanceStream() == stream);
+    }
+
+    const UnifiedInstanceStream::InstanceBatchHWUnifiedArray culledBatches =
+            mSceneMgr->getCulledBatches(stream);
+    CPPUNIT_ASSERT(culledBatches.size() > 1);
+
+    const size_t numInstances = checkInstanceStream(stream, culledBatches, mInstances);
+    CPPUNIT_ASSERT(numInstances > 0);
+    CPPUNIT_ASSERT(numInstances < mInstances.size());
+
+    // Which thread culls which batch depends on scheduling, so spread them by hand
+    // (in reverse) & check they're merged in thread order
+    UnifiedInstanceStream* instanceStream = const_cast<UnifiedInstanceStream*>(stream);
+    const size_t numThreads = mSceneMgr->getNumWorkerThreads();
+    vector<UnifiedInstanceStream::InstanceBatchHWUnifiedArray>::type threadBatches(numThreads);
+    for (size_t i = culledBatches.size(); i--; )
+    {
+        threadBatches[i % numThreads].push_back(culledBatches[i]);
+        instanceStream->_notifyCulled(culledBatches[i], i % numThreads);
+    }
+
+    UnifiedInstanceStream::InstanceBatchHWUnifiedArray mergedBatches;
+    for (size_t i = 0; i < numThreads; ++i)
+        mergedBatches.appendPOD(threadBatches[i].begin(), threadBatches[i].end());
+
+    instanceStream->_update();
+    CPPUNIT_ASSERT_EQUAL(numInstances, checkInstanceStream(stream, mergedBatches, mInstances));
+
+    destroyInstancedScene(instanceManager);
+}
+//--------------------------------------------------------------------------
+void SceneManagerCullingTests::testUnifiedInstanceStreamRenderQueue()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    InstanceManager* instanceManager = createInstancedScene(400);
+
+    const CullParams params(mCameras[0]);
+    mSceneMgr->apply(params);
+    mSceneMgr->cull(params);
+    mSceneMgr->cullInstances(params);
+
+    InstanceBatchHWUnified* firstBatch =
+            static_cast<InstanceBatchHWUnified*>(mInstances.front()->_getOwner());
+    const UnifiedInstanceStream* sharedStream = firstBatch->_getInstanceStream();
+    const size_t numInstances = sharedStream->getNumInstances();
+
+    // Moving a visible batch to another render queue moves it to another stream
+    InstanceBatchHWUnified* movedBatch = 0;
+    for (size_t i = 0; i < mInstances.size() && !movedBatch; ++i)
+    {
+        InstanceBatchHWUnified* batch = static_cast<InstanceBatchHWUnified*>(mInstances[i]->_getOwner());
+        if (batch != firstBatch && batch->_getNumCulledInstances())
+            movedBatch = batch;
+    }
+
+    CPPUNIT_ASSERT(movedBatch);
+    movedBatch->setRenderQueueGroup(firstBatch->getRenderQueueGroup() + 1);
+    const UnifiedInstanceStream* movedStream = movedBatch->_getInstanceStream();
+    CPPUNIT_ASSERT(movedStream != sharedStream);
+
+    mSceneMgr->updateSceneGraph();
+    mSceneMgr->cull(params);
+    mSceneMgr->cullInstances(params);
+
+    const size_t numShared = checkInstanceStream(
+                sharedStream, mSceneMgr->getCulledBatches(sharedStream), mInstances);
+    const size_t numMoved = checkInstanceStream(
+                movedStream, mSceneMgr->getCulledBatches(movedStream), mInstances);
+    CPPUNIT_ASSERT(numMoved > 0);
+    CPPUNIT_ASSERT_EQUAL(numInstances, numShared + numMoved);
+
+    // Batches in the same render queue share the stream again
+    movedBatch->setRenderQueueGroup(firstBatch->getRenderQueueGroup());
+    CPPUNIT_ASSERT(movedBatch->_getInstanceStream() == firstBatch->_getInstanceStream());
+
+    destroyInstancedScene(instanceManager);
+}
+//--------------------------------------------------------------------------
+void SceneManagerCullingTests::testStaticBvhCulling()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // Static objects for the tree, dynamic ones it must leave alone
+    createScene(1000, SCENE_STATIC);
+    createScene(200, SCENE_DYNAMIC);
+
+    // A few objects that are always visible, in the middle of finite ones
+    VisibleSet infiniteObjects;
+    for (size_t i = 1; i < 1000; i += 97)
+    {
+        mObjects[i]->setLocalAabb(Aabb::BOX_INFINITE);
+        mSceneMgr->notifyStaticAabbDirty(mObjects[i]);
+        infiniteObjects.insert(mObjects[i]);
+    }
+
+    // Leave whole packs empty in every render queue, and a few holes elsewhere
+    vector<MovableObject*>::type::iterator itor = mObjects.begin();
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        if ((i >= 300 && i < 300 + ARRAY_PACKED_REALS * 4 * 3) || i % 13 == 0)
+        {
+            infiniteObjects.erase(*itor);
+            SceneNode* sceneNode = (*itor)->getParentSceneNode();
+            (*itor)->detachFromParent();
+            mSceneMgr->destroySceneNode(sceneNode);
+            OGRE_DELETE *itor;
+            itor = mObjects.erase(itor);
+        }
+        else
+        {
+            ++itor;
+        }
+    }
+
+    mSceneMgr->updateSceneGraph();
+
+    for (size_t i = 0; i < 20; ++i)
+    {
+        CullParams params(mCameras[i % 2]);
+        params.position = Vector3(Math::RangeRandom(-150.0f, 150.0f),
+                                  Math::RangeRandom(-150.0f, 150.0f),
+                                  Math::RangeRandom(-150.0f, 150.0f));
+        params.yaw = Degree(Math::RangeRandom(0.0f, 360.0f));
+        params.pitch = Degree(Math::RangeRandom(-80.0f, 80.0f));
+        if (i % 4 == 1)
+            params.viewportMask = 0x5;
+        if (i % 4 == 2)
+        {
+            params.firstRq = 1;
+            params.lastRq = 3;
+        }
+        if (i % 4 == 3)
+        {
+            // Past the last render queue with static objects
+            params.firstRq = 3;
+            params.lastRq = 10;
+        }
+
+        mSceneMgr->apply(params);
+
+        mSceneMgr->setStaticBvhCulling(false);
+        const VisibleSet expected = mSceneMgr->cull(params);
+
+        mSceneMgr->setStaticBvhCulling(true);
+        CPPUNIT_ASSERT(!mSceneMgr->isStaticBvhUsed());
+        mSceneMgr->updateSceneGraph();
+        CPPUNIT_ASSERT(mSceneMgr->isStaticBvhUsed());
+        const VisibleSet visible = mSceneMgr->cull(params);
+
+        CPPUNIT_ASSERT(!expected.empty());
+        CPPUNIT_ASSERT(visible == expected);
+
+        // The always visible objects must make it through the tree
+        VisibleSet::const_iterator it = infiniteObjects.begin();
+        VisibleSet::const_iterator en = infiniteObjects.end();
+        while (it != en)
+        {
+            MovableObject* object = *it++;
+            if (object->getRenderQueueGroup() >= params.firstRq &&
+                object->getRenderQueueGroup() < params.lastRq &&
+                (object->getVisibilityFlags() & params.viewportMask))
+            {
+                CPPUNIT_ASSERT(visible.count(object));
+            }
+        }
+    }
+}
+//--------------------------------------------------------------------------
@@ -0,0 +1,462 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "SkeletonAnimationTests.h"
+#include "Animation/OgreSkeletonTrack.h"
+#include "Animation/OgreSkeletonAnimationLayer.h"
+#include "Math/Array/OgreKfTransform.h"
+#include "Math/Array/OgreKfTransformArrayMemoryManager.h"
+
+#include "UnitTestSuite.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(SkeletonAnimationTests);
+
+//--------------------------------------------------------------------------
+void SkeletonAnimationTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+    srand(0);
+}
+//--------------------------------------------------------------------------
+void SkeletonAnimationTests::tearDown()
+{
+}
+//--------------------------------------------------------------------------
+namespace
+{
+    const size_t NumKeyFrames = 121;
+
+    struct SlotTransform
+    {
+        Vector3 position;
+        Quaternion orientation;
+        Vector3 scale;
+    };
+
+    /// Transform of every slot of every keyframe, at keyFrame * ARRAY_PACKED_REALS + slot
+    typedef vector<SlotTransform>::type SlotTransformVec;
+
+    /// Moves back and forth in straight lines (turning every 20 keyframes) while
+    /// rotating at a constant speed and growing linearly.
+    SlotTransform smoothTransform(size_t keyFrame, size_t slot)
+    {
+        const Real zigzag = Math::Abs(Real((keyFrame + slot * 7) % 40) - 20.0f);
+
+        SlotTransform retVal;
+        retVal.position = Vector3(zigzag, Real(slot), keyFrame * 0.1f);
+        retVal.orientation = Quaternion(Degree(keyFrame * 0.5f * (slot + 1)),
+                                        Vector3(1.0f, Real(slot), 1.0f).normalisedCopy());
+        retVal.scale = Vector3(1.0f + keyFrame * 0.01f);
+        return retVal;
+    }
+
+    SlotTransform randomTransform(size_t keyFrame, size_t slot)
+    {
+        SlotTransform retVal;
+        retVal.position = Vector3(Math::RangeRandom(-10.0f, 10.0f),
+                                  Math::RangeRandom(-10.0f, 10.0f),
+                                  Math::RangeRandom(-10.0f, 10.0f));
+        retVal.orientation = Quaternion(Degree(Math::RangeRandom(-180.0f, 180.0f)),
+                                        Vector3(Math::RangeRandom(-1.0f, 1.0f),
+                                                Math::RangeRandom(-1.0f, 1.0f),
+                                                1.0f).normalisedCopy());
+        retVal.scale = Vector3(Math::RangeRandom(0.5f, 2.0f));
+        return retVal;
+    }
+
+    /// Fills the track one keyframe per frame, like SkeletonAnimationDef does
+    void buildTrack(SkeletonTrack& track, SlotTransformVec& outTransforms,
+                    SlotTransform (*transformFunc)(size_t, size_t))
+    {
+        track.setNumKeyFrame(NumKeyFrames);
+        outTransforms.resize(NumKeyFrames * ARRAY_PACKED_REALS);
+
+        for (size_t k = 0; k < NumKeyFrames; ++k)
+        {
+            track.addKeyFrame(Real(k), 1.0f);
+            KfTransform* kfTransform = track._getKeyFrames().back().mBoneTransform;
+
+            for (size_t slot = 0; slot < ARRAY_PACKED_REALS; ++slot)
+            {
+                const SlotTransform transform = transformFunc(k, slot);
+                kfTransform->mPosition.setFromVector3(transform.position, slot);
+                kfTransform->mOrientation.setFromQuaternion(transform.orientation, slot);
+                kfTransform->mScale.setFromVector3(transform.scale, slot);
+                track._setMaxUsedSlot(uint32(slot));
+                outTransforms[k * ARRAY_PACKED_REALS + slot] = transform;
+            }
+        }
+    }
+
+    /** Samples the track at every original keyframe, interpolating the kept keyframes
+        like applyKeyFrameRigAt does, and checks it's within the given tolerances.
+    */
+    void checkTrack(const SkeletonTrack& track, const SlotTransformVec& original,
+                    Real positionTolerance, Radian orientationTolerance, Real scaleTolerance)
+    {
+        const KeyFrameRigVec& keyFrames = track.getKeyFrames();
+        CPPUNIT_ASSERT_EQUAL(Real(0), keyFrames.front().mFrame);
+        CPPUNIT_ASSERT_EQUAL(Real(NumKeyFrames - 1), keyFrames.back().mFrame);
+
+        size_t prevIdx = 0;
+        for (size_t k = 0; k < NumKeyFrames; ++k)
+        {
+            const Real frame = Real(k);
+            while (prevIdx + 2 < keyFrames.size() && keyFrames[prevIdx + 1].mFrame <= frame)
+                ++prevIdx;
+            const size_t nextIdx = std::min(prevIdx + 1, keyFrames.size() - 1);
+
+            KfTransform prevTransform, nextTransform;
+            track.getKeyFrameTransform(prevIdx, prevTransform);
+            track.getKeyFrameTransform(nextIdx, nextTransform);
+            const Real t = std::min((frame - keyFrames[prevIdx].mFrame) *
+                                    keyFrames[prevIdx].mInvNextFrameDistance, Real(1));
+
+            for (size_t slot = 0; slot < ARRAY_PACKED_REALS; ++slot)
+            {
+                const SlotTransform& expected = original[k * ARRAY_PACKED_REALS + slot];
+
+                const Vector3 prevPosition = prevTransform.mPosition.getAsVector3(slot);
+                const Vector3 nextPosition = nextTransform.mPosition.getAsVector3(slot);
+                const Vector3 position = prevPosition + (nextPosition - prevPosition) * t;
+                CPPUNIT_ASSERT(position.distance(expected.position) <= positionTolerance);
+
+                const Quaternion orientation =
+                        Quaternion::nlerp(t, prevTransform.mOrientation.getAsQuaternion(slot),
+                                          nextTransform.mOrientation.getAsQuaternion(slot));
+                // Measured through the axis of the difference, acos is too imprecise near 0
+                const Quaternion diff = expected.orientation.UnitInverse() * orientation;
+                const Real sinHalfAngle = Vector3(diff.x, diff.y, diff.z).length();
+                const Radian angle = 2.0f * Math::ASin(std::min(sinHalfAngle, Real(1)));
+                CPPUNIT_ASSERT(angle <= orientationTolerance);
+
+                const Vector3 prevScale = prevTransform.mScale.getAsVector3(slot);
+                const Vector3 nextScale = nextTransform.mScale.getAsVector3(slot);
+                const Vector3 scaleDiff = prevScale + (nextScale - prevScale) * t - expected.scale;
+                CPPUNIT_ASSERT(Math::Abs(scaleDiff.x) <= scaleTolerance);
+                CPPUNIT_ASSERT(Math::Abs(scaleDiff.y) <= scaleTolerance);
+                CPPUNIT_ASSERT(Math::Abs(scaleDiff.z) <= scaleTolerance);
+            }
+        }
+    }
+}
+//--------------------------------------------------------------------------
+void SkeletonAnimationTests::testCompressTrack()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    KfTransformArrayMemoryManager memoryManager(0, NumKeyFrames * ARRAY_PACKED_REALS,
+                                                -1, NumKeyFrames * ARRAY_PACKED_REALS);
+    memoryManager.initialize();
+
+    SkeletonTrack track(0, &memoryManager);
+    SlotTransformVec original;
+    buildTrack(track, original, smoothTransform);
+
+    // Nothing is lost before compressing
+    checkTrack(track, original, 1e-5f, Degree(0.01f), 1e-5f);
+    const size_t uncompressedMemory = track.getKeyFrameMemoryUsage();
+
+    const Real positionTolerance = 0.01f;
+    const Radian orientationTolerance = Degree(0.5f);
+    const Real scaleTolerance = 0.001f;
+    track._compress(positionTolerance, orientationTolerance, scaleTolerance);
+    memoryManager.destroy();
+
+    CPPUNIT_ASSERT(track.isCompressed());
+    // Only the turns & enough keyframes to follow the rotations should be left
+    CPPUNIT_ASSERT(track.getKeyFrames().size() < NumKeyFrames / 4);
+    CPPUNIT_ASSERT(track.getKeyFrameMemoryUsage() < uncompressedMemory / 8);
+
+    // Quantizing to 16 bits adds a little on top of the tolerances
+    checkTrack(track, original, positionTolerance + 1e-3f,
+               orientationTolerance + Degree(0.05f), scaleTolerance + 1e-4f);
+}
+//--------------------------------------------------------------------------
+void SkeletonAnimationTests::testCompressIrreducibleTrack()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    KfTransformArrayMemoryManager memoryManager(0, NumKeyFrames * ARRAY_PACKED_REALS,
+                                                -1, NumKeyFrames * ARRAY_PACKED_REALS);
+    memoryManager.initialize();
+
+    SkeletonTrack track(0, &memoryManager);
+    SlotTransformVec original;
+    buildTrack(track, original, randomTransform);
+
+    track._compress(0.01f, Degree(0.5f), 0.001f);
+    memoryManager.destroy();
+
+    // No keyframe can be removed, but they're still quantized
+    CPPUNIT_ASSERT(track.isCompressed());
+    CPPUNIT_ASSERT_EQUAL(NumKeyFrames, track.getKeyFrames().size());
+    checkTrack(track, original, 1e-3f, Degree(0.05f), 1e-4f);
+}
+//--------------------------------------------------------------------------
+namespace
+{
+    /// Leaf of the blend tree that records the time it was given. Its own address is
+    /// used as the animation it contributes, so the weights can be told apart.
+    class TestBlendLeaf : public SkeletonBlendNode
+    {
+    public:
+        Real time;
+
+        TestBlendLeaf() : time(0) {}
+
+        SkeletonAnimation* getTag() const
+        {
+            return reinterpret_cast<SkeletonAnimation*>(const_cast<TestBlendLeaf*>(this));
+        }
+
+        virtual void addTime(Real _time)
+        {
+            time += _time;
+        }
+
+        virtual void _collectAnimations(Real weight, WeightedAnimationVec& outAnimations) const
+        {
+            if (weight > 0)
+                outAnimations.push_back(WeightedAnimation(getTag(), weight));
+        }
+
+        virtual size_t getMaxAnimations(void) const
+        {
+            return 1;
+        }
+    };
+
+    /// Weight the leaf ended up with
+    Real leafWeight(const WeightedAnimationVec& animations, const TestBlendLeaf& leaf)
+    {
+        Real retVal = 0;
+        for (size_t i = 0; i < animations.size(); ++i)
+        {
+            if (animations[i].animation == leaf.getTag())
+                retVal += animations[i].weight;
+        }
+        return retVal;
+    }
+
+    Real totalWeight(const WeightedAnimationVec& animations)
+    {
+        Real retVal = 0;
+        for (size_t i = 0; i < animations.size(); ++i)
+            retVal += animations[i].weight;
+        return retVal;
+    }
+
+    WeightedAnimationVec collect(const SkeletonBlendNode& node, Real weight = 1.0f)
+    {
+        WeightedAnimationVec retVal;
+        node._collectAnimations(weight, retVal);
+        return retVal;
+    }
+
+    const Real WeightEpsilon = 1e-5f;
+}
+//--------------------------------------------------------------------------
+void SkeletonAnimationTests::testBlendSpace1DWeights()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    TestBlendLeaf idle, walk, run;
+    SkeletonBlendSpace1D blendSpace;
+    blendSpace.addSample(&run, 3.0f);
+    blendSpace.addSample(&idle, 0.0f);
+    blendSpace.addSample(&walk, 1.0f);
+    CPPUNIT_ASSERT_EQUAL((size_t)2, blendSpace.getMaxAnimations());
+
+    // Before the first and after the last sample, that sample alone
+    blendSpace.setParameter(-1.0f);
+    WeightedAnimationVec animations = collect(blendSpace);
+    CPPUNIT_ASSERT_EQUAL((size_t)1, animations.size());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0f, leafWeight(animations, idle), WeightEpsilon);
+
+    blendSpace.setParameter(5.0f);
+    animations = collect(blendSpace);
+    CPPUNIT_ASSERT_EQUAL((size_t)1, animations.size());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0f, leafWeight(animations, run), WeightEpsilon);
+
+    // In between, the two surrounding samples linearly
+    blendSpace.setParameter(0.25f);
+    animations = collect(blendSpace);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.75f, leafWeight(animations, idle), WeightEpsilon);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25f, leafWeight(animations, walk), WeightEpsilon);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0f, leafWeight(animations, run), WeightEpsilon);
+
+    blendSpace.setParameter(2.5f);
+    animations = collect(blendSpace);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25f, leafWeight(animations, walk), WeightEpsilon);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.75f, leafWeight(animations, run), WeightEpsilon);
+
+    // Exactly on a sample
+    blendSpace.setParameter(1.0f);
+    animations = collect(blendSpace);
+    CPPUNIT_ASSERT_EQUAL((size_t)1, animations.size());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0f, leafWeight(animations, walk), WeightEpsilon);
+
+    // The weights add up to the node's weight
+    blendSpace.setParameter(1.7f);
+    animations = collect(blendSpace, 0.4f);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.4f, totalWeight(animations), WeightEpsilon);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.4f * 0.65f, leafWeight(animations, walk), WeightEpsilon);
+}
+//--------------------------------------------------------------------------
+void SkeletonAnimationTests::testBlendSpace2DWeights()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    TestBlendLeaf idle, forward, strafe;
+    SkeletonBlendSpace2D blendSpace;
+    blendSpace.addSample(&idle, Vector2::ZERO);
+    blendSpace.addSample(&forward, Vector2::UNIT_Y);
+    blendSpace.addSample(&strafe, Vector2::UNIT_X);
+    CPPUNIT_ASSERT_EQUAL((size_t)3, blendSpace.getMaxAnimations());
+
+    // Exactly on a sample, that sample alone
+    blendSpace.setParameter(Vector2::UNIT_X);
+    WeightedAnimationVec animations = collect(blendSpace);
+    CPPUNIT_ASSERT_EQUAL((size_t)1, animations.size());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0f, leafWeight(animations, strafe), WeightEpsilon);
+
+    // Inverse squared distance: 1 / 0.25, 1 / 1.25 and 1 / 0.25
+    blendSpace.setParameter(Vector2(0.5f, 0.0f));
+    animations = collect(blendSpace);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(4.0f / 8.8f, leafWeight(animations, idle), WeightEpsilon);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.8f / 8.8f, leafWeight(animations, forward), WeightEpsilon);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(4.0f / 8.8f, leafWeight(animations, strafe), WeightEpsilon);
+
+    // The weights add up to the node's weight, wherever the parameter is
+    for (size_t i = 0; i < 20; ++i)
+    {
+        blendSpace.setParameter(Vector2(Math::RangeRandom(-2.0f, 2.0f),
+                                        Math::RangeRandom(-2.0f, 2.0f)));
+        animations = collect(blendSpace, 0.6f);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.6f, totalWeight(animations), WeightEpsilon);
+    }
+}
+//--------------------------------------------------------------------------
+void SkeletonAnimationTests::testCrossfadeWeights()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    TestBlendLeaf idle, walk;
+    SkeletonBlendStateMachine stateMachine;
+    stateMachine.addState("Idle", &idle);
+    stateMachine.addState("Walk", &walk);
+
+    CPPUNIT_ASSERT(stateMachine.getCurrentState() == IdString("Idle"));
+    CPPUNIT_ASSERT(!stateMachine.isCrossfading());
+    WeightedAnimationVec animations = collect(stateMachine);
+    CPPUNIT_ASSERT_EQUAL((size_t)1, animations.size());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0f, leafWeight(animations, idle), WeightEpsilon);
+
+    stateMachine.crossfadeTo("Walk", 2.0f);
+    CPPUNIT_ASSERT(stateMachine.getCurrentState() == IdString("Walk"));
+    CPPUNIT_ASSERT(stateMachine.isCrossfading());
+    CPPUNIT_ASSERT_EQUAL((size_t)2, stateMachine.getMaxAnimations());
+
+    stateMachine.addTime(0.5f);
+    animations = collect(stateMachine);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.75f, leafWeight(animations, idle), WeightEpsilon);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25f, leafWeight(animations, walk), WeightEpsilon);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25f, stateMachine.getStateWeight("Walk"), WeightEpsilon);
+
+    // Both states keep playing while they're blended
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5f, idle.time, WeightEpsilon);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5f, walk.time, WeightEpsilon);
+
+    stateMachine.addTime(1.5f);
+    CPPUNIT_ASSERT(!stateMachine.isCrossfading());
+    animations = collect(stateMachine);
+    CPPUNIT_ASSERT_EQUAL((size_t)1, animations.size());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0f, leafWeight(animations, walk), WeightEpsilon);
+
+    // Once faded out, the previous state stops playing
+    stateMachine.addTime(1.0f);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0f, idle.time, WeightEpsilon);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0f, walk.time, WeightEpsilon);
+
+    // No duration means no crossfade
+    stateMachine.crossfadeTo("Idle", 0.0f);
+    CPPUNIT_ASSERT(!stateMachine.isCrossfading());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0f, stateMachine.getStateWeight("Idle"), WeightEpsilon);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0f, stateMachine.getStateWeight("Walk"), WeightEpsilon);
+}
+//--------------------------------------------------------------------------
+void SkeletonAnimationTests::testInterruptedCrossfade()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    TestBlendLeaf idle, walk, run;
+    SkeletonBlendStateMachine stateMachine;
+    stateMachine.addState("Idle", &idle);
+    stateMachine.addState("Walk", &walk);
+    stateMachine.addState("Run", &run);
+
+    stateMachine.crossfadeTo("Walk", 1.0f);
+    stateMachine.addTime(0.25f);
+
+    // Interrupting the crossfade must not change the pose
+    const WeightedAnimationVec before = collect(stateMachine);
+    stateMachine.crossfadeTo("Run", 1.0f);
+    WeightedAnimationVec animations = collect(stateMachine);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(leafWeight(before, idle), leafWeight(animations, idle), WeightEpsilon);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(leafWeight(before, walk), leafWeight(animations, walk), WeightEpsilon);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0f, leafWeight(animations, run), WeightEpsilon);
+    CPPUNIT_ASSERT_EQUAL((size_t)3, stateMachine.getMaxAnimations());
+
+    // Everything else fades out at the same pace the new state fades in
+    stateMachine.addTime(0.5f);
+    animations = collect(stateMachine);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.375f, leafWeight(animations, idle), WeightEpsilon);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.125f, leafWeight(animations, walk), WeightEpsilon);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5f, leafWeight(animations, run), WeightEpsilon);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0f, totalWeight(animations), WeightEpsilon);
+
+    // Going back to a state that is fading out starts from its current weight
+    stateMachine.crossfadeTo("Idle", 1.0f);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.375f, stateMachine.getStateWeight("Idle"), WeightEpsilon);
+    stateMachine.addTime(0.5f);
+    animations = collect(stateMachine);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.6875f, leafWeight(animations, idle), WeightEpsilon);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0625f, leafWeight(animations, walk), WeightEpsilon);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25f, leafWeight(animations, run), WeightEpsilon);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0f, totalWeight(animations), WeightEpsilon);
+
+    stateMachine.addTime(0.5f);
+    CPPUNIT_ASSERT(!stateMachine.isCrossfading());
+    animations = collect(stateMachine);
+    CPPUNIT_ASSERT_EQUAL((size_t)1, animations.size());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0f, leafWeight(animations, idle), WeightEpsilon);
+}
+//--------------------------------------------------------------------------
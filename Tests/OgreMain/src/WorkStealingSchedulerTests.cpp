@@ -0,0 +1,345 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "WorkStealingSchedulerTests.h"
+#include "Threading/OgreWorkStealingScheduler.h"
+#include "Threading/OgreBarrier.h"
+#include "Threading/OgreThreads.h"
+#include "Threading/OgreUniformScalableTask.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+
+#include "UnitTestSuite.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(WorkStealingSchedulerTests);
+
+//--------------------------------------------------------------------------
+void WorkStealingSchedulerTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+    srand(0);
+}
+//--------------------------------------------------------------------------
+void WorkStealingSchedulerTests::tearDown()
+{
+}
+//--------------------------------------------------------------------------
+namespace
+{
+    struct TestGraph;
+
+    /// Counts how often each chunk runs and checks the tasks it depends on were done by then.
+    class GraphTask : public ChunkedTask
+    {
+    public:
+        TestGraph* graph;
+        size_t numChunks;
+        vector<size_t>::type dependencies;
+        vector<size_t>::type chunkRuns;
+        size_t chunksDone;
+
+        GraphTask() : graph(0), numChunks(0), chunksDone(0) {}
+
+        virtual void execute(size_t chunkIdx, size_t threadIdx);
+    };
+
+    struct TestGraph
+    {
+        LightweightMutex mutex;
+        vector<GraphTask>::type tasks;
+        size_t numThreads;
+        size_t errors;
+
+        TestGraph(size_t _numThreads) : numThreads(_numThreads), errors(0) {}
+
+        /// Empty tasks have nothing to run, they're done once what they depend on is.
+        bool isFinished(size_t taskIdx) const
+        {
+            const GraphTask& task = tasks[taskIdx];
+            if (task.numChunks != 0)
+                return task.chunksDone == task.numChunks;
+
+            for (size_t i = 0; i < task.dependencies.size(); ++i)
+            {
+                if (!isFinished(task.dependencies[i]))
+                    return false;
+            }
+            return true;
+        }
+    };
+
+    void GraphTask::execute(size_t chunkIdx, size_t threadIdx)
+    {
+        // Uneven work, so that threads run out of it at different times and steal
+        volatile size_t sum = 0;
+        for (size_t i = 0; i < (chunkIdx * 7919) % 2000; ++i)
+            sum += i;
+
+        graph->mutex.lock();
+        if (threadIdx >= graph->numThreads || chunkIdx >= numChunks)
+        {
+            ++graph->errors;
+        }
+        else
+        {
+            for (size_t i = 0; i < dependencies.size(); ++i)
+            {
+                if (!graph->isFinished(dependencies[i]))
+                    ++graph->errors;
+            }
+            ++chunkRuns[chunkIdx];
+            ++chunksDone;
+        }
+        graph->mutex.unlock();
+    }
+
+    /// Drives the scheduler the way SceneManager does: workers wait on a
+    /// barrier, run _execute, then sync again.
+    struct WorkerPool
+    {
+        WorkStealingScheduler scheduler;
+        Barrier barrier;
+        volatile bool exitThreads;
+        ThreadHandleVec threads;
+
+        WorkerPool(size_t numThreads);
+        ~WorkerPool();
+
+        /// Runs the graph added to the scheduler and clears it
+        void run(void)
+        {
+            scheduler._prepare();
+            barrier.sync(); // Fire threads
+            barrier.sync(); // Wait for them
+            scheduler.clear();
+        }
+    };
+
+    unsigned long workerPoolThread(ThreadHandle* threadHandle)
+    {
+        WorkerPool* pool = reinterpret_cast<WorkerPool*>(threadHandle->getUserParam());
+        while (true)
+        {
+            pool->barrier.sync();
+            if (pool->exitThreads)
+                break;
+            pool->scheduler._execute(threadHandle->getThreadIdx());
+            pool->barrier.sync();
+        }
+        return 0;
+    }
+    THREAD_DECLARE(workerPoolThread);
+
+    WorkerPool::WorkerPool(size_t numThreads) :
+        scheduler(numThreads),
+        barrier(numThreads + 1),
+        exitThreads(false)
+    {
+        for (size_t i = 0; i < numThreads; ++i)
+            threads.push_back(Threads::CreateThread(THREAD_GET(workerPoolThread), i, this));
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        exitThreads = true;
+        barrier.sync();
+        Threads::WaitForThreads(threads);
+    }
+
+    /** Adds numTasks tasks, each depending on up to 3 random tasks before it.
+        1 out of emptyOdds tasks has no chunks.
+    */
+    void buildRandomGraph(TestGraph& graph, WorkStealingScheduler& scheduler,
+                          size_t numTasks, int emptyOdds)
+    {
+        // The scheduler keeps pointers to the tasks
+        graph.tasks.resize(numTasks);
+        for (size_t i = 0; i < numTasks; ++i)
+        {
+            GraphTask& task = graph.tasks[i];
+            task.graph = &graph;
+            if (rand() % emptyOdds != 0)
+                task.numChunks = (rand() % 8 == 0) ? 1000 + rand() % 1000 : 1 + rand() % 64;
+            task.chunkRuns.resize(task.numChunks, 0);
+            CPPUNIT_ASSERT_EQUAL(i, scheduler.addTask(&task, task.numChunks));
+
+            const int numDependencies = i ? rand() % 4 : 0;
+            for (int d = 0; d < numDependencies; ++d)
+            {
+                const size_t dependsOn = rand() % i;
+                if (std::find(task.dependencies.begin(), task.dependencies.end(), dependsOn) ==
+                    task.dependencies.end())
+                {
+                    task.dependencies.push_back(dependsOn);
+                    scheduler.addDependency(i, dependsOn);
+                }
+            }
+        }
+    }
+
+    void assertGraphDone(const TestGraph& graph)
+    {
+        CPPUNIT_ASSERT_EQUAL((size_t)0, graph.errors);
+        for (size_t i = 0; i < graph.tasks.size(); ++i)
+        {
+            const GraphTask& task = graph.tasks[i];
+            CPPUNIT_ASSERT_EQUAL(task.numChunks, task.chunksDone);
+            for (size_t n = 0; n < task.numChunks; ++n)
+                CPPUNIT_ASSERT_EQUAL((size_t)1, task.chunkRuns[n]);
+        }
+    }
+}
+//--------------------------------------------------------------------------
+void WorkStealingSchedulerTests::testRandomGraphs()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const size_t threadCounts[] = { 1, 2, 4, 7 };
+    for (size_t t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); ++t)
+    {
+        // The same pool runs many graphs, like SceneManager does every frame
+        WorkerPool pool(threadCounts[t]);
+        for (int i = 0; i < 100; ++i)
+        {
+            TestGraph graph(threadCounts[t]);
+            buildRandomGraph(graph, pool.scheduler, 1 + rand() % 40, 6);
+            pool.run();
+            assertGraphDone(graph);
+        }
+    }
+}
+//--------------------------------------------------------------------------
+void WorkStealingSchedulerTests::testEmptyTasks()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    WorkerPool pool(4);
+
+    // No tasks at all
+    pool.run();
+
+    {
+        // Only empty tasks, which _prepare finishes before the workers start
+        TestGraph graph(4);
+        buildRandomGraph(graph, pool.scheduler, 20, 1);
+        pool.run();
+        assertGraphDone(graph);
+    }
+
+    {
+        // A chain of empty tasks between two real ones must still keep them in order,
+        // and an empty task released at runtime must release what depends on it.
+        TestGraph graph(4);
+        graph.tasks.resize(5);
+        const size_t numChunks[5] = { 500, 0, 0, 300, 0 };
+        for (size_t i = 0; i < 5; ++i)
+        {
+            GraphTask& task = graph.tasks[i];
+            task.graph = &graph;
+            task.numChunks = numChunks[i];
+            task.chunkRuns.resize(task.numChunks, 0);
+            pool.scheduler.addTask(&task, task.numChunks);
+            if (i > 0)
+            {
+                task.dependencies.push_back(i - 1);
+                pool.scheduler.addDependency(i, i - 1);
+            }
+        }
+        pool.run();
+        assertGraphDone(graph);
+    }
+
+    for (int i = 0; i < 100; ++i)
+    {
+        // Mostly empty tasks
+        TestGraph graph(4);
+        buildRandomGraph(graph, pool.scheduler, 1 + rand() % 40, 2);
+        pool.run();
+        assertGraphDone(graph);
+    }
+}
+//--------------------------------------------------------------------------
+namespace
+{
+    /// Counts the calls per thread id
+    class CountingScalableTask : public UniformScalableTask
+    {
+    public:
+        LightweightMutex mutex;
+        vector<size_t>::type calls;
+        size_t errors;
+
+        CountingScalableTask(size_t numThreads) : calls(numThreads, 0), errors(0) {}
+
+        virtual void execute(size_t threadId, size_t numThreads)
+        {
+            mutex.lock();
+            if (threadId >= calls.size() || numThreads != calls.size())
+                ++errors;
+            else
+                ++calls[threadId];
+            mutex.unlock();
+        }
+    };
+}
+//--------------------------------------------------------------------------
+void WorkStealingSchedulerTests::testUserScalableTask()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    Root* root = OGRE_NEW Root(BLANKSTRING);
+    SceneManager* sceneManager = root->createSceneManager(ST_GENERIC, 4, INSTANCING_CULLING_SINGLETHREAD);
+    const size_t numThreads = sceneManager->getNumWorkerThreads();
+    CPPUNIT_ASSERT(numThreads > 1);
+
+    // Every thread id must be called exactly once per execution, blocking or not
+    CountingScalableTask task(numThreads);
+    const size_t numRuns = 200;
+    for (size_t i = 0; i < numRuns; ++i)
+    {
+        if (i % 2)
+        {
+            sceneManager->executeUserScalableTask(&task, true);
+        }
+        else
+        {
+            sceneManager->executeUserScalableTask(&task, false);
+            sceneManager->waitForPendingUserScalableTask();
+        }
+    }
+
+    CPPUNIT_ASSERT_EQUAL((size_t)0, task.errors);
+    for (size_t i = 0; i < numThreads; ++i)
+        CPPUNIT_ASSERT_EQUAL(numRuns, task.calls[i]);
+
+    root->destroySceneManager(sceneManager);
+    OGRE_DELETE root;
+}
+//--------------------------------------------------------------------------
@@ -38,6 +38,8 @@ class HlmsCmd
     {
         Ogre::String language;
         Ogre::String generator;
+        /// Shader cache to load before generating the scene's shaders, and to save afterwards
+        Ogre::String shaderCache;
     };
 
     Ogre::Root          *mRoot;
@@ -47,6 +47,7 @@ THE SOFTWARE.
 #include "OgreHlms.h"
 #include "OgreArchiveManager.h"
 #include "OgreEntity.h"
+#include "OgreDataStream.h"
 
 #include <iostream>
 
@@ -99,6 +100,7 @@ HlmsCmd::HlmsCmd( int numargs, char** args )
 
     binOptList["-l"] = "";
     binOptList["-g"] = "";
+    binOptList["-c"] = "";
 
     int startIdx = findCommandLineOpts( numargs, args, unOptList, binOptList );
     parseOpts( unOptList, binOptList );
@@ -115,6 +117,11 @@ void HlmsCmd::help(void)
     /*cout << endl << "OgreHlms: Preprocesses Hlms files." << endl;
     cout << "Provided for OGRE by Matias Goldberg 2014" << endl << endl;
     cout << "Usage: OgreHlms [opts] sourcefile [destfile] " << endl;*/
+    cout << "Options:" << endl;
+    cout << "-l language = Shading language of the templates (default: glsl)" << endl;
+    cout << "-g generator = Hlms implementation (default: pbs)" << endl;
+    cout << "-c cachefile = Shader cache to rebuild with the current templates." << endl;
+    cout << "               The shaders used by the scene are added to it." << endl;
 
     cout << endl;
 }
@@ -131,6 +138,10 @@ void HlmsCmd::parseOpts( UnaryOptionList& unOpts, BinaryOptionList& binOpts )
     bi = binOpts.find("-g");
     if( !bi->second.empty() )
         mOpts.generator = bi->second;
+
+    bi = binOpts.find("-c");
+    if( !bi->second.empty() )
+        mOpts.shaderCache = bi->second;
 }
 //-------------------------------------------------------------------------------------
 bool HlmsCmd::configure(void)
@@ -205,6 +216,23 @@ void HlmsCmd::createScene(void)
                    std::pair<IdString, String>( "envprobe_map", "example.dds" ) );
     entity->getSubEntity(0)->setHlms( &hlms, params );
 
+    if( !mOpts.shaderCache.empty() )
+    {
+        //Bring the cache up to date with the current templates
+        std::ifstream *inFile = OGRE_NEW_T( std::ifstream, MEMCATEGORY_GENERAL )(
+                    mOpts.shaderCache.c_str(), std::ios::in | std::ios::binary );
+        if( inFile->is_open() )
+        {
+            DataStreamPtr stream( OGRE_NEW FileStreamDataStream( mOpts.shaderCache, inFile, true ) );
+            const size_t numEntries = hlms.loadShaderCache( stream, true );
+            cout << "Loaded " << numEntries << " entries from " << mOpts.shaderCache << endl;
+        }
+        else
+        {
+            OGRE_DELETE_T( inFile, basic_ifstream, MEMCATEGORY_GENERAL );
+        }
+    }
+
     mSceneMgr->updateSceneGraph();
 
     CompositorShadowNode *shadowNode = mWorkspace->findShadowNode( "HlmsCmd ShadowNode" );
@@ -244,6 +272,14 @@ void HlmsCmd::createScene(void)
         std::ofstream outFile( "Output_ps.glsl", std::ios::out | std::ios::binary );
         outFile.write( &source[0], source.size() );
     }
+
+    if( !mOpts.shaderCache.empty() )
+    {
+        std::fstream *outFile = OGRE_NEW_T( std::fstream, MEMCATEGORY_GENERAL )(
+                    mOpts.shaderCache.c_str(), std::ios::out | std::ios::binary );
+        DataStreamPtr stream( OGRE_NEW FileStreamDataStream( mOpts.shaderCache, outFile, true ) );
+        hlms.saveShaderCache( stream );
+    }
 }
 //-------------------------------------------------------------------------------------
 void HlmsCmd::destroyScene(void)
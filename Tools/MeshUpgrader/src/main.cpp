@@ -37,6 +37,7 @@ THE SOFTWARE.
 #include "OgreHardwareVertexBuffer.h"
 #include "OgrePixelCountLodStrategy.h"
 #include "OgreLodConfig.h"
+#include "OgreMeshOptimiser.h"
 
 #include <iostream>
 #include <sys/stat.h>
@@ -70,8 +71,12 @@ void help(void)
     cout << "-srcgl     = Interpret ambiguous colours as GL style" << endl;
     cout << "-E endian  = Set endian mode 'big' 'little' or 'native' (default)" << endl;
     cout << "-b         = Recalculate bounding box (static meshes only)" << endl;
-    cout << "-V version = Specify OGRE version format to write instead of latest" << endl;
-    cout << "             Options are: 1.10, 1.8, 1.7, 1.4, 1.0" << endl;
+    cout << "-vc        = Optimise triangle & vertex order for the GPU vertex cache" << endl;
+    cout << "-od        = Same as -vc, but also reorder triangles to reduce overdraw" << endl;
+    cout << "-c         = Compress geometry (quantized vertex data, coded indices)" << endl;
+    cout << "             Lossy. Needs format 2.0, which it selects unless -V is given" << endl;
+    cout << "-V version = Specify OGRE version format to write instead of the default (1.10)" << endl;
+    cout << "             Options are: 2.0, 1.10, 1.8, 1.7, 1.4, 1.0" << endl;
     cout << "sourcefile = name of file to convert" << endl;
     cout << "destfile   = optional name of file to write to. If you don't" << endl;
     cout << "             specify this OGRE overwrites the existing file." << endl;
@@ -100,6 +105,9 @@ struct UpgradeOptions {
     bool usePercent;
     Serializer::Endian endian;
     bool recalcBounds;
+    bool optimiseVertexCache;
+    bool reduceOverdraw;
+    bool compressGeometry;
     MeshVersion targetVersion;
 
 };
@@ -141,6 +149,9 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
     opts.numLods = 0;
     opts.usePercent = true;
     opts.recalcBounds = false;
+    opts.optimiseVertexCache = false;
+    opts.reduceOverdraw = false;
+    opts.compressGeometry = false;
     opts.targetVersion = MESH_VERSION_LATEST;
 
 
@@ -184,6 +195,15 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
     if (ui->second) {
         opts.recalcBounds = true;
     }
+    ui = unOpts.find("-vc");
+    opts.optimiseVertexCache = ui->second;
+    ui = unOpts.find("-od");
+    if (ui->second) {
+        opts.optimiseVertexCache = true;
+        opts.reduceOverdraw = true;
+    }
+    ui = unOpts.find("-c");
+    opts.compressGeometry = ui->second;
 
 
     BinaryOptionList::iterator bi = binOpts.find("-l");
@@ -236,7 +256,9 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
     
     bi = binOpts.find("-V");
     if (!bi->second.empty()) {
-        if (bi->second == "1.10") {
+        if (bi->second == "2.0") {
+            opts.targetVersion = MESH_VERSION_2_0;
+        } else if (bi->second == "1.10") {
             opts.targetVersion = MESH_VERSION_1_10;
         } else if (bi->second == "1.8") {
             opts.targetVersion = MESH_VERSION_1_8;
@@ -596,6 +618,28 @@ void recalcBounds(Mesh* mesh)
     mesh->_setBoundingSphereRadius(radius);
 }
 
+Real calcAcmr(Mesh* mesh)
+{
+    // Average of all submeshes, weighted by their triangle count
+    Real misses = 0;
+    size_t triangles = 0;
+    for (unsigned short i = 0; i < mesh->getNumSubMeshes(); ++i) {
+        SubMesh* sm = mesh->getSubMesh(i);
+        if (sm->operationType == RenderOperation::OT_TRIANGLE_LIST) {
+            misses += MeshOptimiser::calculateAcmr(sm->indexData) * (sm->indexData->indexCount / 3);
+            triangles += sm->indexData->indexCount / 3;
+        }
+    }
+    return triangles ? misses / triangles : 0;
+}
+
+void optimiseVertexCache(Mesh* mesh)
+{
+    cout << "\nOptimising vertex cache (ACMR " << calcAcmr(mesh) << ")...";
+    mesh->optimiseVertexCache(true, opts.reduceOverdraw);
+    cout << "success (ACMR " << calcAcmr(mesh) << ")\n";
+}
+
 void printLodConfig(const LodConfig& lodConfig)
 {
     cout << "\n\nLOD config summary:";
@@ -1020,6 +1064,9 @@ int main(int numargs, char** args)
         unOptList["-srcd3d"] = false;
         unOptList["-autogen"] = false;
         unOptList["-b"] = false;
+        unOptList["-vc"] = false;
+        unOptList["-od"] = false;
+        unOptList["-c"] = false;
         binOptList["-l"] = "";
         binOptList["-d"] = "";
         binOptList["-p"] = "";
@@ -1156,11 +1203,22 @@ int main(int numargs, char** args)
         }
 
 
+        // Last, so that vertices added by the tangent generation are reordered too
+        if (opts.optimiseVertexCache) {
+            optimiseVertexCache(mesh);
+        }
+
         if (opts.recalcBounds) {
             recalcBounds(mesh);
         }
 
-        meshSerializer->exportMesh(mesh, dest, opts.targetVersion, opts.endian);
+        // Compressed geometry only exists in v2.0, which isn't the default
+        MeshVersion targetVersion = opts.targetVersion;
+        if (opts.compressGeometry && targetVersion == MESH_VERSION_LATEST)
+            targetVersion = MESH_VERSION_2_0;
+
+        meshSerializer->setGeometryCompression(opts.compressGeometry);
+        meshSerializer->exportMesh(mesh, dest, targetVersion, opts.endian);
     
     }
     catch (Exception& e)
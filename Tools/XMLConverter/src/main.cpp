@@ -74,6 +74,7 @@ struct XmlOptions
     bool quietMode;
     bool d3d;
     bool gl;
+    bool compressGeometry;
     Serializer::Endian endian;
 };
 
@@ -102,6 +103,7 @@ void help(void)
     cout << "-gl            = Prefer GL packed colour formats (default on non-Windows)" << endl;
     cout << "-E endian      = Set endian mode 'big' 'little' or 'native' (default)" << endl;
     cout << "-x num         = Generate no more than num eXtremes for every submesh (default 0)" << endl;
+    cout << "-c             = Compress geometry when writing .mesh files (lossy, v2.0 format)" << endl;
     cout << "-q             = Quiet mode, less output" << endl;
     cout << "-log filename  = name of the log file (default: 'OgreXMLConverter.log')" << endl;
     cout << "sourcefile     = name of file to convert" << endl;
@@ -137,6 +139,7 @@ XmlOptions parseArgs(int numArgs, char **args)
     //opts.reorganiseBuffers = true;
     opts.optimiseAnimations = true;
     opts.quietMode = false;
+    opts.compressGeometry = false;
     opts.endian = Serializer::ENDIAN_NATIVE;
 
     // ignore program name
@@ -155,6 +158,7 @@ XmlOptions parseArgs(int numArgs, char **args)
     unOpt["-tr"] = false;
     unOpt["-o"] = false;
     unOpt["-q"] = false;
+    unOpt["-c"] = false;
     unOpt["-d3d"] = false;
     unOpt["-gl"] = false;
     unOpt["-h"] = false;
@@ -200,6 +204,12 @@ XmlOptions parseArgs(int numArgs, char **args)
             opts.optimiseAnimations = false;
         }
 
+        ui = unOpt.find("-c");
+        if (ui->second)
+        {
+            opts.compressGeometry = true;
+        }
+
         bi = binOpt.find("-merge");
         if (!bi->second.empty())
         {
@@ -324,6 +334,8 @@ XmlOptions parseArgs(int numArgs, char **args)
             cout << "log file         = " << opts.logFile << endl;
         if (opts.nuextremityPoints)
             cout << "Generate extremes per submesh = " << opts.nuextremityPoints << endl;
+        if (opts.compressGeometry)
+            cout << "Compress geometry" << endl;
         cout << " semantic = " << (opts.tangentSemantic == VES_TANGENT? "TANGENT" : "TEXCOORD") << endl;
         cout << " parity = " << opts.tangentUseParity << endl;
         cout << " split mirror = " << opts.tangentSplitMirrored << endl;
@@ -469,7 +481,12 @@ void XMLToBinary(XmlOptions opts)
             }
         }
 
-        meshSerializer->exportMesh(newMesh.getPointer(), opts.dest, opts.endian);
+        meshSerializer->setGeometryCompression(opts.compressGeometry);
+        // Compressed geometry only exists in v2.0, which isn't the default
+        if (opts.compressGeometry)
+            meshSerializer->exportMesh(newMesh.getPointer(), opts.dest, MESH_VERSION_2_0, opts.endian);
+        else
+            meshSerializer->exportMesh(newMesh.getPointer(), opts.dest, opts.endian);
 
         // Clean up the conversion mesh
         MeshManager::getSingleton().remove("conversion");